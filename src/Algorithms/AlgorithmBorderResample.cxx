@@ -23,6 +23,8 @@
 
 #include "Border.h"
 #include "BorderFile.h"
+#include "CaretAssert.h"
+#include "CaretOMP.h"
 #include "GiftiLabelTable.h"
 #include "GiftiMetaData.h"
 #include "SurfaceFile.h"
@@ -89,26 +91,50 @@ AlgorithmBorderResample::AlgorithmBorderResample(ProgressObject* myProgObj, cons
         borderOut->addBorderMetadataKey(borderIn->getBorderMetadataKey(m));//rely on the keys being in order added
     }
     int numBorders = borderIn->getNumberOfBorders();
-    CaretPointer<SignedDistanceHelper> myHelp = newAdjust.getSignedDistanceHelper();
+    vector<float> pointCoords;//unproject all points first, then find where they land on the new sphere in parallel
     for (int i = 0; i < numBorders; ++i)
     {
         const Border* inputBorder = borderIn->getBorder(i);
         if (inputBorder->getStructure() != curSphere->getStructure()) continue;
-        CaretPointer<Border> outputBorder(new Border());//in case something throws
-        outputBorder->setName(inputBorder->getName());
-        outputBorder->setClassName(inputBorder->getClassName());
-        outputBorder->setClosed(inputBorder->isClosed());
         int numPoints = inputBorder->getNumberOfPoints();
         for (int j = 0; j < numPoints; ++j)
         {
-            CaretPointer<SurfaceProjectedItem> outPoint(new SurfaceProjectedItem());//ditto
             float coord[3];
             const SurfaceProjectedItem* myItem = inputBorder->getPoint(j);
             if (!myItem->getBarycentricProjection()->isValid()) throw AlgorithmException("input file has a border point without barycentric projection");//because we never want to use van essen projection or straight coords
             bool valid = myItem->getBarycentricProjection()->unprojectToSurface(curAdjust, coord, 0.0f, true);//should really be "from" surface - "true" makes it not use the signed distance above surface, if present
             if (!valid) throw AlgorithmException("input file has a border point that is invalid for the current sphere");
-            BarycentricInfo myBaryInfo;
-            myHelp->barycentricWeights(coord, myBaryInfo);
+            pointCoords.insert(pointCoords.end(), coord, coord + 3);
+        }
+    }
+    int64_t numCoords = (int64_t)pointCoords.size() / 3;
+    vector<BarycentricInfo> pointBaryInfo(numCoords);
+    newAdjust.getSignedDistanceHelper();//build the search structure before the threads need it
+#pragma omp CARET_PAR
+    {
+        CaretPointer<SignedDistanceHelper> myHelp = newAdjust.getSignedDistanceHelper();
+#pragma omp CARET_FOR schedule(dynamic)
+        for (int64_t p = 0; p < numCoords; ++p)
+        {
+            myHelp->barycentricWeights(pointCoords.data() + p * 3, pointBaryInfo[p]);
+        }
+    }
+    int64_t curCoord = 0;
+    for (int i = 0; i < numBorders; ++i)
+    {
+        const Border* inputBorder = borderIn->getBorder(i);
+        if (inputBorder->getStructure() != curSphere->getStructure()) continue;
+        CaretPointer<Border> outputBorder(new Border());//in case something throws
+        outputBorder->setName(inputBorder->getName());
+        outputBorder->setClassName(inputBorder->getClassName());
+        outputBorder->setClosed(inputBorder->isClosed());
+        int numPoints = inputBorder->getNumberOfPoints();
+        for (int j = 0; j < numPoints; ++j)
+        {
+            CaretPointer<SurfaceProjectedItem> outPoint(new SurfaceProjectedItem());//ditto
+            CaretAssertVectorIndex(pointBaryInfo, curCoord);
+            const BarycentricInfo& myBaryInfo = pointBaryInfo[curCoord];
+            ++curCoord;
             outPoint->setStructure(inputBorder->getStructure());
             outPoint->getBarycentricProjection()->setTriangleNodes(myBaryInfo.nodes);
             outPoint->getBarycentricProjection()->setTriangleAreas(myBaryInfo.baryWeights);
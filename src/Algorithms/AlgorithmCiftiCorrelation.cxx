@@ -31,6 +31,7 @@
 #include "FileInformation.h"
 #include "CaretPointer.h"
 #include "dot_wrapper.h"
+#include <cmath>
 #include <fstream>
 #include <utility>
 #include <algorithm>
@@ -200,6 +201,11 @@ AlgorithmCiftiCorrelation::AlgorithmCiftiCorrelation(ProgressObject* myProgObj,
     CiftiXMLOld newXML = myCifti->getCiftiXMLOld();
     newXML.applyColumnMapToRows();
     myCiftiOut->setCiftiXML(newXML);
+    if (!m_covariance)
+    {//output range is known, so quantized output doesn't need a pass over the data to find it
+        const double maxOut = (fisherZ ? 0.5 * log((1 + 0.999999) / (1 - 0.999999)) : 1.0);//same clamping as correlate()
+        myCiftiOut->setDataRangeHint(-maxOut, maxOut);
+    }
     int numCacheRows;
     bool cacheFullInput = true;
     if (memLimitGB >= 0.0f)
@@ -385,6 +391,11 @@ AlgorithmCiftiCorrelation::AlgorithmCiftiCorrelation(ProgressObject* myProgObj,
         }
     }
     myCiftiOut->setCiftiXML(newXML);
+    if (!m_covariance)
+    {//output range is known, so quantized output doesn't need a pass over the data to find it
+        const double maxOut = (fisherZ ? 0.5 * log((1 + 0.999999) / (1 - 0.999999)) : 1.0);//same clamping as correlate()
+        myCiftiOut->setDataRangeHint(-maxOut, maxOut);
+    }
     int numSelected = (int)ciftiIndexList.size(), numRows = myCifti->getNumberOfRows();
     int numCacheRows;
     bool cacheFullInput = true;
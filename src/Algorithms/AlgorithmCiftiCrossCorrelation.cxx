@@ -123,6 +123,10 @@ AlgorithmCiftiCrossCorrelation::AlgorithmCiftiCrossCorrelation(ProgressObject* m
     CiftiXMLOld outXML = myCiftiA->getCiftiXMLOld();
     outXML.copyMapping(CiftiXMLOld::ALONG_ROW, myCiftiB->getCiftiXMLOld(), CiftiXMLOld::ALONG_COLUMN);//(try to) copy B's along column mapping to output's along row mapping
     myCiftiOut->setCiftiXML(outXML);
+    {//output range is known, so quantized output doesn't need a pass over the data to find it
+        const double maxOut = (fisherZ ? 0.5 * log((1 + 0.999999) / (1 - 0.999999)) : 1.0);//same clamping as correlate()
+        myCiftiOut->setDataRangeHint(-maxOut, maxOut);
+    }
     int64_t chunkSize = m_numRowsA;
     if (memLimitGB >= 0.0f)
     {
@@ -23,6 +23,7 @@
 
 #include "AlgorithmCiftiReplaceStructure.h"
 #include "AlgorithmCiftiSeparate.h"
+#include "CaretAssert.h"
 #include "CiftiFile.h"
 #include "LabelFile.h"
 #include "MetricFile.h"
@@ -31,6 +32,21 @@
 using namespace caret;
 using namespace std;
 
+namespace
+{
+    template<typename T>
+    bool rowsAreContiguous(const vector<T>& inMap, const vector<T>& outMap)
+    {//when both maps are runs of adjacent rows, the whole model can be copied as a block
+        CaretAssert(inMap.size() == outMap.size());
+        if (inMap.empty()) return false;
+        for (int64_t k = 1; k < (int64_t)inMap.size(); ++k)
+        {
+            if (inMap[k].m_ciftiIndex != inMap[0].m_ciftiIndex + k || outMap[k].m_ciftiIndex != outMap[0].m_ciftiIndex + k) return false;
+        }
+        return true;
+    }
+}
+
 AString AlgorithmCiftiMergeDense::getCommandSwitch()
 {
     return "-cifti-merge-dense";
@@ -202,11 +218,16 @@ AlgorithmCiftiMergeDense::AlgorithmCiftiMergeDense(ProgressObject* myProgObj, co
                             myCiftiOut->setRow(rowscratch.data(), j);
                         }
                     } else {
-                        for (int k = 0; k < (int)inMap.size(); ++k)
+                        if (rowsAreContiguous(inMap, outMap))
                         {
-                            CaretAssert(inMap[k].m_surfaceNode == outMap[k].m_surfaceNode);
-                            ciftiList[sourceCifti[i]]->getRow(otherscratch.data(), inMap[k].m_ciftiIndex);
-                            myCiftiOut->setRow(otherscratch.data(), outMap[k].m_ciftiIndex);
+                            myCiftiOut->copyRowsFrom(*(ciftiList[sourceCifti[i]]), inMap[0].m_ciftiIndex, outMap[0].m_ciftiIndex, (int64_t)inMap.size());
+                        } else {
+                            for (int k = 0; k < (int)inMap.size(); ++k)
+                            {
+                                CaretAssert(inMap[k].m_surfaceNode == outMap[k].m_surfaceNode);
+                                ciftiList[sourceCifti[i]]->getRow(otherscratch.data(), inMap[k].m_ciftiIndex);
+                                myCiftiOut->setRow(otherscratch.data(), outMap[k].m_ciftiIndex);
+                            }
                         }
                     }
                 }
@@ -243,13 +264,18 @@ AlgorithmCiftiMergeDense::AlgorithmCiftiMergeDense(ProgressObject* myProgObj, co
                             myCiftiOut->setRow(rowscratch.data(), j);
                         }
                     } else {
-                        for (int k = 0; k < (int)inMap.size(); ++k)
+                        if (rowsAreContiguous(inMap, outMap))
                         {
-                            CaretAssert(inMap[k].m_ijk[0] == outMap[k].m_ijk[0]);
-                            CaretAssert(inMap[k].m_ijk[1] == outMap[k].m_ijk[1]);
-                            CaretAssert(inMap[k].m_ijk[2] == outMap[k].m_ijk[2]);
-                            ciftiList[sourceCifti[i]]->getRow(otherscratch.data(), inMap[k].m_ciftiIndex);
-                            myCiftiOut->setRow(otherscratch.data(), outMap[k].m_ciftiIndex);
+                            myCiftiOut->copyRowsFrom(*(ciftiList[sourceCifti[i]]), inMap[0].m_ciftiIndex, outMap[0].m_ciftiIndex, (int64_t)inMap.size());
+                        } else {
+                            for (int k = 0; k < (int)inMap.size(); ++k)
+                            {
+                                CaretAssert(inMap[k].m_ijk[0] == outMap[k].m_ijk[0]);
+                                CaretAssert(inMap[k].m_ijk[1] == outMap[k].m_ijk[1]);
+                                CaretAssert(inMap[k].m_ijk[2] == outMap[k].m_ijk[2]);
+                                ciftiList[sourceCifti[i]]->getRow(otherscratch.data(), inMap[k].m_ciftiIndex);
+                                myCiftiOut->setRow(otherscratch.data(), outMap[k].m_ciftiIndex);
+                            }
                         }
                     }
                 }
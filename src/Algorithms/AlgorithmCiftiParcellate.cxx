@@ -21,6 +21,8 @@
 #include "AlgorithmCiftiParcellate.h"
 #include "AlgorithmException.h"
 #include "CaretLogger.h"
+#include "CaretMutex.h"
+#include "CaretOMP.h"
 #include "CiftiFile.h"
 #include "GiftiLabel.h"
 #include "GiftiLabelTable.h"
@@ -29,6 +31,7 @@
 #include "ReductionOperation.h"
 #include "SurfaceFile.h"
 
+#include <algorithm>
 #include <cmath>
 #include <map>
 
@@ -205,226 +208,59 @@ void AlgorithmCiftiParcellate::useParameters(OperationParameters* myParams, Prog
     AlgorithmCiftiParcellate(myProgObj, myCiftiIn, myCiftiLabel, direction, myCiftiOut, method, excludeLow, excludeHigh, onlyNumeric);
 }
 
-AlgorithmCiftiParcellate::AlgorithmCiftiParcellate(ProgressObject* myProgObj, const CiftiFile* myCiftiIn, const CiftiFile* myCiftiLabel, const int& direction, CiftiFile* myCiftiOut,
-                                                   const ReductionEnum::Enum& method, const float& excludeLow, const float& excludeHigh, const bool& onlyNumeric) : AbstractAlgorithm(myProgObj)
+namespace
 {
-    LevelProgress myProgress(myProgObj);
-    CaretAssert(direction >= 0);
-    const CiftiXML& myInputXML = myCiftiIn->getCiftiXML();
-    const CiftiXML& myLabelXML = myCiftiLabel->getCiftiXML();
-    vector<int64_t> dims = myInputXML.getDimensions();
-    if (direction >= (int)dims.size()) throw AlgorithmException("specified direction doesn't exist in input file");
-    if (myInputXML.getMappingType(direction) != CiftiMappingType::BRAIN_MODELS)
-    {
-        throw AlgorithmException("input cifti file does not have brain models mapping type in specified direction");
-    }
-    if (myLabelXML.getNumberOfDimensions() != 2 ||
-        myLabelXML.getMappingType(CiftiXML::ALONG_ROW) != CiftiMappingType::LABELS ||
-        myLabelXML.getMappingType(CiftiXML::ALONG_COLUMN) != CiftiMappingType::BRAIN_MODELS)
-    {
-        throw AlgorithmException("input cifti label file has the wrong mapping types");
-    }
-    const CiftiBrainModelsMap& inputDense = myInputXML.getBrainModelsMap(direction);
-    const CiftiBrainModelsMap& labelDense = myLabelXML.getBrainModelsMap(CiftiXML::ALONG_COLUMN);
-    if (inputDense.hasVolumeData())
-    {//don't check volume space if direction doesn't have volume data
-        if (labelDense.hasVolumeData() && !inputDense.getVolumeSpace().matches(labelDense.getVolumeSpace()))
-        {
-            throw AlgorithmException("input cifti files must have the same volume space");
-        }
-    }
-    vector<int> indexToParcel;
-    CiftiXML myOutXML = myInputXML;
-    CiftiParcelsMap outParcelMap = parcellateMapping(myCiftiLabel, inputDense, indexToParcel);
-    int numParcels = outParcelMap.getLength();
-    if (numParcels < 1)
-    {
-        throw AlgorithmException("no parcels found, output file would be empty, aborting");
-    }
-    myOutXML.setMap(direction, outParcelMap);
-    myCiftiOut->setCiftiXML(myOutXML);
-    int64_t numCols = myInputXML.getDimensionLength(CiftiXML::ALONG_ROW);
-    vector<float> scratchRow(numCols);
-    vector<int64_t> parcelCounts(numParcels, 0);
-    for (int64_t j = 0; j < (int64_t)indexToParcel.size(); ++j)
-    {
-        int parcel = indexToParcel[j];
-        CaretAssert(parcel > -2 && parcel < numParcels);
-        if (parcel != -1)
-        {
-            ++parcelCounts[parcel];
-        }
-    }
-    bool isLabel = false;
-    int labelDir = -1;
-    for (int i = 0; i < (int)dims.size(); ++i)
-    {
-        if (myInputXML.getMappingType(i) == CiftiMappingType::LABELS)
-        {
-            isLabel = true;
-            labelDir = i;
-            break;//there should never be more than one dimension with LABEL type, and if there is, just use the first one, i guess...
-        }
-    }
-    if (isLabel && method != ReductionEnum::MODE)
-    {
-        CaretLogWarning(ReductionEnum::toName(method) + " reduction requested while parcellating label data");
-    }
-    if (direction == CiftiXML::ALONG_ROW)
+    const int64_t PARCELLATE_BLOCK_BYTES = ((int64_t)1) << 26;//input rows read per file access
+    const int64_t PARCELLATE_COLUMN_CHUNK = 256;//columns per parallel work item when accumulating along columns
+    
+    //one parcel's values to one output value, parcelWeights empty means unweighted
+    float reduceParcel(const float* data, const int64_t& count, const int& parcel, const vector<vector<float> >& parcelWeights,
+                       const ReductionEnum::Enum& method, const float& excludeLow, const float& excludeHigh, const bool& onlyNumeric)
     {
-        vector<float> scratchOutRow(numParcels);
-        vector<vector<float> > parcelData(numParcels);//float so we can use ReductionOperation
-        for (int j = 0; j < numParcels; ++j)
-        {
-            parcelData[j].reserve(parcelCounts[j]);
-        }
-        for (MultiDimIterator<int64_t> iter(vector<int64_t>(dims.begin() + 1, dims.end())); !iter.atEnd(); ++iter)
+        if (parcelWeights.empty())
         {
-            for (int j = 0; j < numParcels; ++j)
+            if (excludeLow > 0.0f && excludeHigh > 0.0f)
             {
-                parcelData[j].clear();//doesn't change allocation
+                return ReductionOperation::reduceExcludeDev(data, count, method, excludeLow, excludeHigh);
             }
-            myCiftiIn->getRow(scratchRow.data(), *iter);
-            for (int64_t j = 0; j < numCols; ++j)
+            if (onlyNumeric)
             {
-                int parcel = indexToParcel[j];
-                if (parcel != -1)
-                {
-                    if (isLabel)
-                    {
-                        parcelData[parcel].push_back(floor(scratchRow[j] + 0.5f));//round to nearest integer to be safe
-                    } else {
-                        parcelData[parcel].push_back(scratchRow[j]);
-                    }
-                }
+                return ReductionOperation::reduceOnlyNumeric(data, count, method);
             }
-            for (int j = 0; j < numParcels; ++j)
-            {
-                CaretAssert(parcelCounts[j] == (int64_t)parcelData[j].size());
-                if (parcelCounts[j] > 0 && (method != ReductionEnum::SAMPSTDEV || parcelCounts[j] > 1))
-                {
-                    if (excludeLow > 0.0f && excludeHigh > 0.0f)
-                    {
-                        scratchOutRow[j] = ReductionOperation::reduceExcludeDev(parcelData[j].data(), parcelData[j].size(), method, excludeLow, excludeHigh);
-                    } else {
-                        if (onlyNumeric)
-                        {
-                            scratchOutRow[j] = ReductionOperation::reduceOnlyNumeric(parcelData[j].data(), parcelData[j].size(), method);
-                        } else {
-                            scratchOutRow[j] = ReductionOperation::reduce(parcelData[j].data(), parcelData[j].size(), method);
-                        }
-                    }
-                } else {//labelDir can't be 0 (row) because we are parcellating along row, so row must be dense
-                    if (isLabel)
-                    {
-                        scratchOutRow[j] = myOutXML.getLabelsMap(labelDir).getMapLabelTable((*iter)[labelDir - 1])->getUnassignedLabelKey();
-                    } else {
-                        scratchOutRow[j] = 0.0f;
-                    }
-                }
-            }
-            myCiftiOut->setRow(scratchOutRow.data(), *iter);
+            return ReductionOperation::reduce(data, count, method);
         }
-    } else {
-        vector<float> scratchOutRow(numCols);
-        vector<int64_t> otherDims = dims;
-        otherDims.erase(otherDims.begin() + direction);//direction being parcellated
-        otherDims.erase(otherDims.begin());//row
-        vector<vector<vector<float> > > parcelData(numParcels, vector<vector<float> >(numCols));//float so we can use ReductionOperation
-        for (int i = 0; i < numParcels; ++i)
+        CaretAssert((int64_t)parcelWeights[parcel].size() == count);
+        if (excludeLow > 0.0f && excludeHigh > 0.0f)
         {
-            for (int j = 0; j < numCols; ++j)
-            {
-                parcelData[i][j].reserve(parcelCounts[i]);
-            }
+            return ReductionOperation::reduceWeightedExcludeDev(data, parcelWeights[parcel].data(), count, method, excludeLow, excludeHigh);
         }
-        for (MultiDimIterator<int64_t> iter(otherDims); !iter.atEnd(); ++iter)
+        if (onlyNumeric)
         {
-            vector<int64_t> indices(dims.size() - 1);//we need to add the parcellated direction index back into the index list to use it in getRow/setRow
-            for (int i = 0; i < (int)otherDims.size(); ++i)
-            {
-                if (i < direction - 1)
-                {
-                    indices[i] = (*iter)[i];
-                } else {
-                    indices[i + 1] = (*iter)[i];
-                }
-            }//indices[direction - 1] is uninitialized, as it is the dimension to be parcellated
-            for (int i = 0; i < numParcels; ++i)
-            {
-                for (int j = 0; j < numCols; ++j)
-                {
-                    parcelData[i][j].clear();//doesn't change allocation
-                }
-            }
-            for (int64_t i = 0; i < dims[direction]; ++i)
-            {
-                int parcel = indexToParcel[i];
-                if (parcel != -1)
-                {
-                    indices[direction - 1] = i;
-                    myCiftiIn->getRow(scratchRow.data(), indices);
-                    vector<vector<float> >& parcelRef = parcelData[parcel];
-                    for (int j = 0; j < numCols; ++j)
-                    {
-                        if (isLabel)
-                        {
-                            parcelRef[j].push_back(floor(scratchRow[j] + 0.5f));
-                        } else {
-                            parcelRef[j].push_back(scratchRow[j]);
-                        }
-                    }
-                }
-            }
-            for (int i = 0; i < numParcels; ++i)
-            {
-                indices[direction - 1] = i;
-                int64_t count = parcelCounts[i];
-                vector<vector<float> >& parcelRef = parcelData[i];
-                if (count > 0 && (method != ReductionEnum::SAMPSTDEV || count > 1))
-                {
-                    for (int j = 0; j < numCols; ++j)
-                    {
-                        CaretAssert((int64_t)parcelRef[j].size() == count);
-                        if (excludeLow > 0.0f && excludeHigh > 0.0f)
-                        {
-                            scratchOutRow[j] = ReductionOperation::reduceExcludeDev(parcelRef[j].data(), parcelRef[j].size(), method, excludeLow, excludeHigh);
-                        } else {
-                            if (onlyNumeric)
-                            {
-                                scratchOutRow[j] = ReductionOperation::reduceOnlyNumeric(parcelRef[j].data(), parcelRef[j].size(), method);
-                            } else {
-                                scratchOutRow[j] = ReductionOperation::reduce(parcelRef[j].data(), parcelRef[j].size(), method);
-                            }
-                        }
-                    }
-                } else {
-                    for (int j = 0; j < numCols; ++j)
-                    {
-                        CaretAssert((int64_t)parcelRef[j].size() == count);
-                        if (isLabel)
-                        {
-                            if (labelDir == CiftiXML::ALONG_ROW)
-                            {
-                                scratchOutRow[j] = myOutXML.getLabelsMap(CiftiXML::ALONG_ROW).getMapLabelTable(j)->getUnassignedLabelKey();
-                            } else {
-                                scratchOutRow[j] = myOutXML.getLabelsMap(labelDir).getMapLabelTable(indices[labelDir - 1])->getUnassignedLabelKey();
-                            }
-                        } else {
-                            scratchOutRow[j] = 0.0f;
-                        }
-                    }
-                }
-                myCiftiOut->setRow(scratchOutRow.data(), indices);
-            }
+            return ReductionOperation::reduceWeightedOnlyNumeric(data, parcelWeights[parcel].data(), count, method);
         }
+        return ReductionOperation::reduceWeighted(data, parcelWeights[parcel].data(), count, method);
     }
-}
-
-namespace
-{
-    void doWeightedParcellation(const CiftiFile* myCiftiIn, const int& direction, CiftiFile* myCiftiOut, const vector<int>& indexToParcel,
-                                const vector<vector<float> >& parcelWeights, const ReductionEnum::Enum& method, const float& excludeLow, const float& excludeHigh, const bool& onlyNumeric)
+    
+    //reductions that can be accumulated row by row without keeping the values, in the same order and precision as ReductionOperation, so results are identical
+    bool canStreamReduction(const ReductionEnum::Enum& method, const bool& weighted, const float& excludeLow, const float& excludeHigh, const bool& onlyNumeric)
+    {
+        if ((excludeLow > 0.0f && excludeHigh > 0.0f) || onlyNumeric) return false;
+        switch (method)
+        {
+            case ReductionEnum::SUM:
+            case ReductionEnum::MEAN:
+                return true;
+            case ReductionEnum::MIN:
+            case ReductionEnum::MAX:
+                return !weighted;//weighted min/max throws, let ReductionOperation do it
+            default:
+                return false;
+        }
+    }
+    
+    //single pass over the input rows for either direction, parcelWeights empty means unweighted
+    void doParcellation(const CiftiFile* myCiftiIn, const int& direction, CiftiFile* myCiftiOut, const vector<int>& indexToParcel,
+                        const vector<vector<float> >& parcelWeights, const ReductionEnum::Enum& method, const float& excludeLow, const float& excludeHigh, const bool& onlyNumeric)
     {
         const CiftiXML& myInputXML = myCiftiIn->getCiftiXML();
         const CiftiXML& myOutXML = myCiftiOut->getCiftiXML();
@@ -445,77 +281,131 @@ namespace
         {
             CaretLogWarning(ReductionEnum::toName(method) + " reduction requested while parcellating label data");
         }
-        int numParcels = myCiftiOut->getCiftiXML().getDimensionLength(direction);
+        const bool weighted = !parcelWeights.empty();
+        int numParcels = myOutXML.getDimensionLength(direction);
         int64_t numCols = myInputXML.getDimensionLength(CiftiXML::ALONG_ROW);
-        vector<float> scratchRow(numCols);
-        if (direction == CiftiXML::ALONG_ROW)
+        vector<int64_t> parcelCounts(numParcels, 0), memberIndex(indexToParcel.size(), -1), lastMember(numParcels, -1);
+        for (int64_t j = 0; j < (int64_t)indexToParcel.size(); ++j)
         {
-            vector<float> scratchOutRow(numParcels);
-            vector<vector<float> > parcelData(numParcels);//float so we can use ReductionOperation
-            for (int j = 0; j < numParcels; ++j)
+            int parcel = indexToParcel[j];
+            CaretAssert(parcel > -2 && parcel < numParcels);
+            if (parcel != -1)
             {
-                parcelData[j].reserve(parcelWeights[j].size());
+                memberIndex[j] = parcelCounts[parcel];//position within the parcel, in dense index order like the weights
+                ++parcelCounts[parcel];
+                lastMember[parcel] = j;
             }
-            for (MultiDimIterator<int64_t> iter(vector<int64_t>(dims.begin() + 1, dims.end())); !iter.atEnd(); ++iter)
+        }
+        AString errorMessage;
+        CaretMutex errorMutex;
+        if (direction == CiftiXML::ALONG_ROW)
+        {//rows are independent, so do blocks of rows in parallel
+            const int64_t blockRows = max(int64_t(1), PARCELLATE_BLOCK_BYTES / ((numCols + numParcels) * (int64_t)sizeof(float)));
+            vector<float> inBlock, outBlock;
+            vector<vector<int64_t> > blockIndices;
+            MultiDimIterator<int64_t> iter(vector<int64_t>(dims.begin() + 1, dims.end()));
+            while (!iter.atEnd())
             {
-                for (int j = 0; j < numParcels; ++j)
+                blockIndices.clear();
+                for (; !iter.atEnd() && (int64_t)blockIndices.size() < blockRows; ++iter)
                 {
-                    parcelData[j].clear();//doesn't change allocation
+                    blockIndices.push_back(*iter);
                 }
-                myCiftiIn->getRow(scratchRow.data(), *iter);
-                for (int64_t j = 0; j < numCols; ++j)
+                const int64_t numBlock = (int64_t)blockIndices.size();
+                inBlock.resize(numBlock * numCols);
+                outBlock.resize(numBlock * numParcels);
+                if (dims.size() == 2)
                 {
-                    int parcel = indexToParcel[j];
-                    if (parcel != -1)
+                    myCiftiIn->getRows(inBlock.data(), blockIndices[0][0], numBlock);
+                } else {
+                    for (int64_t b = 0; b < numBlock; ++b)
                     {
-                        if (isLabel)
-                        {
-                            parcelData[parcel].push_back(floor(scratchRow[j] + 0.5f));//round to nearest integer to be safe
-                        } else {
-                            parcelData[parcel].push_back(scratchRow[j]);
-                        }
+                        myCiftiIn->getRow(inBlock.data() + b * numCols, blockIndices[b]);
                     }
                 }
-                for (int j = 0; j < numParcels; ++j)
+#pragma omp CARET_PAR
                 {
-                    CaretAssert(parcelWeights[j].size() == parcelData[j].size());
-                    if (parcelData[j].size() > 0 && (method != ReductionEnum::SAMPSTDEV || parcelData[j].size() > 1))
+                    vector<vector<float> > parcelData(numParcels);//float so we can use ReductionOperation
+                    for (int j = 0; j < numParcels; ++j)
+                    {
+                        parcelData[j].reserve(parcelCounts[j]);
+                    }
+#pragma omp CARET_FOR schedule(dynamic)
+                    for (int64_t b = 0; b < numBlock; ++b)
                     {
-                        if (excludeLow > 0.0f && excludeHigh > 0.0f)
+                        try
                         {
-                            scratchOutRow[j] = ReductionOperation::reduceWeightedExcludeDev(parcelData[j].data(), parcelWeights[j].data(), parcelData[j].size(), method, excludeLow, excludeHigh);
-                        } else {
-                            if (onlyNumeric)
+                            const float* scratchRow = inBlock.data() + b * numCols;
+                            float* scratchOutRow = outBlock.data() + b * numParcels;
+                            for (int j = 0; j < numParcels; ++j)
                             {
-                                scratchOutRow[j] = ReductionOperation::reduceWeightedOnlyNumeric(parcelData[j].data(), parcelWeights[j].data(), parcelData[j].size(), method);
-                            } else {
-                                scratchOutRow[j] = ReductionOperation::reduceWeighted(parcelData[j].data(), parcelWeights[j].data(), parcelData[j].size(), method);
+                                parcelData[j].clear();//doesn't change allocation
                             }
-                        }
-                    } else {//labelDir can't be 0 (row) because we are parcellating along row, so row must be dense
-                        if (isLabel)
-                        {
-                            scratchOutRow[j] = myOutXML.getLabelsMap(labelDir).getMapLabelTable((*iter)[labelDir - 1])->getUnassignedLabelKey();
-                        } else {
-                            scratchOutRow[j] = 0.0f;
+                            for (int64_t j = 0; j < numCols; ++j)
+                            {
+                                int parcel = indexToParcel[j];
+                                if (parcel != -1)
+                                {
+                                    if (isLabel)
+                                    {
+                                        parcelData[parcel].push_back(floor(scratchRow[j] + 0.5f));//round to nearest integer to be safe
+                                    } else {
+                                        parcelData[parcel].push_back(scratchRow[j]);
+                                    }
+                                }
+                            }
+                            for (int j = 0; j < numParcels; ++j)
+                            {
+                                CaretAssert(parcelCounts[j] == (int64_t)parcelData[j].size());
+                                if (parcelCounts[j] > 0 && (method != ReductionEnum::SAMPSTDEV || parcelCounts[j] > 1))
+                                {
+                                    scratchOutRow[j] = reduceParcel(parcelData[j].data(), parcelCounts[j], j, parcelWeights, method, excludeLow, excludeHigh, onlyNumeric);
+                                } else {//labelDir can't be 0 (row) because we are parcellating along row, so row must be dense
+                                    if (isLabel)
+                                    {
+                                        scratchOutRow[j] = myOutXML.getLabelsMap(labelDir).getMapLabelTable(blockIndices[b][labelDir - 1])->getUnassignedLabelKey();
+                                    } else {
+                                        scratchOutRow[j] = 0.0f;
+                                    }
+                                }
+                            }
+                        } catch (CaretException& e) {//don't let exceptions escape the parallel region
+                            CaretMutexLocker locked(&errorMutex);
+                            errorMessage = e.whatString();
                         }
                     }
                 }
-                myCiftiOut->setRow(scratchOutRow.data(), *iter);
+                if (!errorMessage.isEmpty()) throw AlgorithmException(errorMessage);
+                if (dims.size() == 2)
+                {
+                    myCiftiOut->setRows(outBlock.data(), blockIndices[0][0], numBlock);
+                } else {
+                    for (int64_t b = 0; b < numBlock; ++b)
+                    {
+                        myCiftiOut->setRow(outBlock.data() + b * numParcels, blockIndices[b]);
+                    }
+                }
             }
-        } else {
-            vector<float> scratchOutRow(numCols);
-            vector<int64_t> otherDims = dims;
-            otherDims.erase(otherDims.begin() + direction);//direction being parcellated
-            otherDims.erase(otherDims.begin());//row
-            vector<vector<vector<float> > > parcelData(numParcels, vector<vector<float> >(numCols));//float so we can use ReductionOperation
-            for (int i = 0; i < numParcels; ++i)
+        } else {//each input row is read once, parcels are accumulated or buffered and written as soon as their last member row has been read
+            const bool streaming = canStreamReduction(method, weighted, excludeLow, excludeHigh, onlyNumeric);
+            const int64_t numDense = dims[direction];
+            const int64_t blockRows = max(int64_t(1), PARCELLATE_BLOCK_BYTES / (numCols * (int64_t)sizeof(float)));
+            vector<double> weightSums(numParcels, 0.0);
+            if (weighted)
             {
-                for (int j = 0; j < numCols; ++j)
+                for (int i = 0; i < numParcels; ++i)
                 {
-                    parcelData[i][j].reserve(parcelWeights[i].size());
+                    CaretAssert((int64_t)parcelWeights[i].size() == parcelCounts[i]);
+                    for (int64_t m = 0; m < parcelCounts[i]; ++m)
+                    {
+                        weightSums[i] += parcelWeights[i][m];//same order as ReductionOperation
+                    }
                 }
             }
+            vector<float> inBlock, scratchOutRow(numCols);
+            vector<int64_t> otherDims = dims;
+            otherDims.erase(otherDims.begin() + direction);//direction being parcellated
+            otherDims.erase(otherDims.begin());//row
             for (MultiDimIterator<int64_t> iter(otherDims); !iter.atEnd(); ++iter)
             {
                 vector<int64_t> indices(dims.size() - 1);//we need to add the parcellated direction index back into the index list to use it in getRow/setRow
@@ -528,69 +418,158 @@ namespace
                         indices[i + 1] = (*iter)[i];
                     }
                 }//indices[direction - 1] is uninitialized, as it is the dimension to be parcellated
-                for (int i = 0; i < numParcels; ++i)
+                vector<vector<float> > parcelData(numParcels);//buffered reductions, [column][member], allocated at a parcel's first row and freed after its last
+                vector<double> sums;//streaming SUM/MEAN, [parcel][column]
+                vector<float> extremes;//streaming MIN/MAX
+                if (streaming)
                 {
-                    for (int j = 0; j < numCols; ++j)
+                    if (method == ReductionEnum::SUM || method == ReductionEnum::MEAN)
                     {
-                        parcelData[i][j].clear();//doesn't change allocation
+                        sums.resize(numParcels * numCols, 0.0);
+                    } else {
+                        extremes.resize(numParcels * numCols, 0.0f);
                     }
                 }
-                for (int64_t i = 0; i < dims[direction]; ++i)
+                int64_t first = 0;
+                while (true)
                 {
-                    int parcel = indexToParcel[i];
-                    if (parcel != -1)
+                    while (first < numDense && indexToParcel[first] == -1) ++first;//skip unused rows between blocks
+                    if (first >= numDense) break;
+                    const int64_t numBlock = min(blockRows, numDense - first);
+                    inBlock.resize(numBlock * numCols);
+                    if (dims.size() == 2)
+                    {
+                        myCiftiIn->getRows(inBlock.data(), first, numBlock);
+                    } else {
+                        for (int64_t b = 0; b < numBlock; ++b)
+                        {
+                            if (indexToParcel[first + b] == -1) continue;
+                            indices[direction - 1] = first + b;
+                            myCiftiIn->getRow(inBlock.data() + b * numCols, indices);
+                        }
+                    }
+                    if (!streaming)
                     {
-                        indices[direction - 1] = i;
-                        myCiftiIn->getRow(scratchRow.data(), indices);
-                        vector<vector<float> >& parcelRef = parcelData[parcel];
-                        for (int j = 0; j < numCols; ++j)
+                        for (int64_t b = 0; b < numBlock; ++b)
                         {
-                            if (isLabel)
+                            int parcel = indexToParcel[first + b];
+                            if (parcel != -1 && memberIndex[first + b] == 0)
                             {
-                                parcelRef[j].push_back(floor(scratchRow[j] + 0.5f));
-                            } else {
-                                parcelRef[j].push_back(scratchRow[j]);
+                                parcelData[parcel].resize(parcelCounts[parcel] * numCols);
                             }
                         }
-                    }
-                }
-                for (int i = 0; i < numParcels; ++i)
-                {
-                    indices[direction - 1] = i;
-                    int64_t count = (int64_t)parcelWeights[i].size();
-                    vector<vector<float> >& parcelRef = parcelData[i];
-                    if (count > 0 && (method != ReductionEnum::SAMPSTDEV || count > 1))
+                    }//threads own ranges of columns and go through the rows in order, so every value is accumulated in the same order as a serial loop
+#pragma omp CARET_PARFOR schedule(static)
+                    for (int64_t colStart = 0; colStart < numCols; colStart += PARCELLATE_COLUMN_CHUNK)
                     {
-                        for (int j = 0; j < numCols; ++j)
+                        const int64_t colEnd = min(colStart + PARCELLATE_COLUMN_CHUNK, numCols);
+                        for (int64_t b = 0; b < numBlock; ++b)
                         {
-                            CaretAssert((int64_t)parcelRef[j].size() == count);
-                            if (excludeLow > 0.0f && excludeHigh > 0.0f)
+                            int parcel = indexToParcel[first + b];
+                            if (parcel == -1) continue;
+                            const int64_t member = memberIndex[first + b];
+                            const float* scratchRow = inBlock.data() + b * numCols;
+                            for (int64_t j = colStart; j < colEnd; ++j)
                             {
-                                scratchOutRow[j] = ReductionOperation::reduceWeightedExcludeDev(parcelRef[j].data(), parcelWeights[i].data(), parcelRef[j].size(), method, excludeLow, excludeHigh);
-                            } else {
-                                if (onlyNumeric)
+                                float value = scratchRow[j];
+                                if (isLabel) value = floor(value + 0.5f);
+                                if (!streaming)
+                                {
+                                    parcelData[parcel][j * parcelCounts[parcel] + member] = value;
+                                    continue;
+                                }
+                                const int64_t accumIndex = parcel * numCols + j;
+                                switch (method)
                                 {
-                                    scratchOutRow[j] = ReductionOperation::reduceWeightedOnlyNumeric(parcelRef[j].data(), parcelWeights[i].data(), parcelRef[j].size(), method);
-                                } else {
-                                    scratchOutRow[j] = ReductionOperation::reduceWeighted(parcelRef[j].data(), parcelWeights[i].data(), parcelRef[j].size(), method);
+                                    case ReductionEnum::SUM:
+                                    case ReductionEnum::MEAN:
+                                        if (weighted)
+                                        {
+                                            sums[accumIndex] += value * parcelWeights[parcel][member];
+                                        } else {
+                                            sums[accumIndex] += value;
+                                        }
+                                        break;
+                                    case ReductionEnum::MAX:
+                                        if (member == 0 || value > extremes[accumIndex]) extremes[accumIndex] = value;
+                                        break;
+                                    case ReductionEnum::MIN:
+                                        if (member == 0 || value < extremes[accumIndex]) extremes[accumIndex] = value;
+                                        break;
+                                    default:
+                                        CaretAssert(false);
                                 }
                             }
                         }
-                    } else {
-                        for (int j = 0; j < numCols; ++j)
+                    }
+                    for (int64_t b = 0; b < numBlock; ++b)
+                    {
+                        int parcel = indexToParcel[first + b];
+                        if (parcel == -1 || lastMember[parcel] != first + b) continue;
+                        const int64_t count = parcelCounts[parcel];
+                        if (method != ReductionEnum::SAMPSTDEV || count > 1)
                         {
-                            CaretAssert((int64_t)parcelRef[j].size() == count);
-                            if (isLabel)
+                            if (streaming)
                             {
-                                if (labelDir == CiftiXML::ALONG_ROW)
+                                for (int64_t j = 0; j < numCols; ++j)
+                                {
+                                    const int64_t accumIndex = parcel * numCols + j;
+                                    switch (method)
+                                    {
+                                        case ReductionEnum::SUM:
+                                            scratchOutRow[j] = sums[accumIndex];
+                                            break;
+                                        case ReductionEnum::MEAN:
+                                            if (weighted)
+                                            {
+                                                scratchOutRow[j] = sums[accumIndex] / weightSums[parcel];
+                                            } else {
+                                                scratchOutRow[j] = sums[accumIndex] / count;
+                                            }
+                                            break;
+                                        default:
+                                            scratchOutRow[j] = extremes[accumIndex];
+                                    }
+                                }
+                            } else {
+#pragma omp CARET_PARFOR schedule(dynamic)
+                                for (int64_t j = 0; j < numCols; ++j)
                                 {
-                                    scratchOutRow[j] = myOutXML.getLabelsMap(CiftiXML::ALONG_ROW).getMapLabelTable(j)->getUnassignedLabelKey();
-                                } else {
-                                    scratchOutRow[j] = myOutXML.getLabelsMap(labelDir).getMapLabelTable(indices[labelDir - 1])->getUnassignedLabelKey();
+                                    try
+                                    {
+                                        scratchOutRow[j] = reduceParcel(parcelData[parcel].data() + j * count, count, parcel, parcelWeights, method, excludeLow, excludeHigh, onlyNumeric);
+                                    } catch (CaretException& e) {//don't let exceptions escape the parallel region
+                                        CaretMutexLocker locked(&errorMutex);
+                                        errorMessage = e.whatString();
+                                    }
                                 }
+                                if (!errorMessage.isEmpty()) throw AlgorithmException(errorMessage);
+                                vector<float>().swap(parcelData[parcel]);//free it
+                            }
+                            indices[direction - 1] = parcel;
+                            myCiftiOut->setRow(scratchOutRow.data(), indices);
+                        } else {//written with the empty parcels
+                            vector<float>().swap(parcelData[parcel]);
+                        }
+                    }
+                    first += numBlock;
+                }
+                for (int i = 0; i < numParcels; ++i)
+                {
+                    if (parcelCounts[i] > 0 && (method != ReductionEnum::SAMPSTDEV || parcelCounts[i] > 1)) continue;
+                    indices[direction - 1] = i;
+                    for (int j = 0; j < numCols; ++j)
+                    {
+                        if (isLabel)
+                        {
+                            if (labelDir == CiftiXML::ALONG_ROW)
+                            {
+                                scratchOutRow[j] = myOutXML.getLabelsMap(CiftiXML::ALONG_ROW).getMapLabelTable(j)->getUnassignedLabelKey();
                             } else {
-                                scratchOutRow[j] = 0.0f;
+                                scratchOutRow[j] = myOutXML.getLabelsMap(labelDir).getMapLabelTable(indices[labelDir - 1])->getUnassignedLabelKey();
                             }
+                        } else {
+                            scratchOutRow[j] = 0.0f;
                         }
                     }
                     myCiftiOut->setRow(scratchOutRow.data(), indices);
@@ -600,6 +579,47 @@ namespace
     }
 }
 
+AlgorithmCiftiParcellate::AlgorithmCiftiParcellate(ProgressObject* myProgObj, const CiftiFile* myCiftiIn, const CiftiFile* myCiftiLabel, const int& direction, CiftiFile* myCiftiOut,
+                                                   const ReductionEnum::Enum& method, const float& excludeLow, const float& excludeHigh, const bool& onlyNumeric) : AbstractAlgorithm(myProgObj)
+{
+    LevelProgress myProgress(myProgObj);
+    CaretAssert(direction >= 0);
+    const CiftiXML& myInputXML = myCiftiIn->getCiftiXML();
+    const CiftiXML& myLabelXML = myCiftiLabel->getCiftiXML();
+    vector<int64_t> dims = myInputXML.getDimensions();
+    if (direction >= (int)dims.size()) throw AlgorithmException("specified direction doesn't exist in input file");
+    if (myInputXML.getMappingType(direction) != CiftiMappingType::BRAIN_MODELS)
+    {
+        throw AlgorithmException("input cifti file does not have brain models mapping type in specified direction");
+    }
+    if (myLabelXML.getNumberOfDimensions() != 2 ||
+        myLabelXML.getMappingType(CiftiXML::ALONG_ROW) != CiftiMappingType::LABELS ||
+        myLabelXML.getMappingType(CiftiXML::ALONG_COLUMN) != CiftiMappingType::BRAIN_MODELS)
+    {
+        throw AlgorithmException("input cifti label file has the wrong mapping types");
+    }
+    const CiftiBrainModelsMap& inputDense = myInputXML.getBrainModelsMap(direction);
+    const CiftiBrainModelsMap& labelDense = myLabelXML.getBrainModelsMap(CiftiXML::ALONG_COLUMN);
+    if (inputDense.hasVolumeData())
+    {//don't check volume space if direction doesn't have volume data
+        if (labelDense.hasVolumeData() && !inputDense.getVolumeSpace().matches(labelDense.getVolumeSpace()))
+        {
+            throw AlgorithmException("input cifti files must have the same volume space");
+        }
+    }
+    vector<int> indexToParcel;
+    CiftiXML myOutXML = myInputXML;
+    CiftiParcelsMap outParcelMap = parcellateMapping(myCiftiLabel, inputDense, indexToParcel);
+    int numParcels = outParcelMap.getLength();
+    if (numParcels < 1)
+    {
+        throw AlgorithmException("no parcels found, output file would be empty, aborting");
+    }
+    myOutXML.setMap(direction, outParcelMap);
+    myCiftiOut->setCiftiXML(myOutXML);
+    doParcellation(myCiftiIn, direction, myCiftiOut, indexToParcel, vector<vector<float> >(), method, excludeLow, excludeHigh, onlyNumeric);
+}
+
 AlgorithmCiftiParcellate::AlgorithmCiftiParcellate(ProgressObject* myProgObj, const CiftiFile* myCiftiIn, const CiftiFile* myCiftiLabel, const int& direction, CiftiFile* myCiftiOut,
                                                    const MetricFile* leftWeights, const MetricFile* rightWeights, const MetricFile* cerebWeights, const ReductionEnum::Enum& method,
                                                    const float& excludeLow, const float& excludeHigh, const bool& onlyNumeric): AbstractAlgorithm(myProgObj)
@@ -698,7 +718,7 @@ AlgorithmCiftiParcellate::AlgorithmCiftiParcellate(ProgressObject* myProgObj, co
             }
         }
     }
-    doWeightedParcellation(myCiftiIn, direction, myCiftiOut, indexToParcel, parcelWeights, method, excludeLow, excludeHigh, onlyNumeric);
+    doParcellation(myCiftiIn, direction, myCiftiOut, indexToParcel, parcelWeights, method, excludeLow, excludeHigh, onlyNumeric);
 }
 
 AlgorithmCiftiParcellate::AlgorithmCiftiParcellate(ProgressObject* myProgObj, const CiftiFile* myCiftiIn, const CiftiFile* myCiftiLabel, const int& direction, CiftiFile* myCiftiOut,
@@ -759,7 +779,7 @@ AlgorithmCiftiParcellate::AlgorithmCiftiParcellate(ProgressObject* myProgObj, co
             parcelWeights[parcel].push_back(weightCol[j]);//we already tested that the dense mappings matched
         }
     }
-    doWeightedParcellation(myCiftiIn, direction, myCiftiOut, indexToParcel, parcelWeights, method, excludeLow, excludeHigh, onlyNumeric);
+    doParcellation(myCiftiIn, direction, myCiftiOut, indexToParcel, parcelWeights, method, excludeLow, excludeHigh, onlyNumeric);
 }
 
 CiftiParcelsMap AlgorithmCiftiParcellate::parcellateMapping(const CiftiFile* myCiftiLabel, const CiftiBrainModelsMap& toParcellate, vector<int>& indexToParcelOut)
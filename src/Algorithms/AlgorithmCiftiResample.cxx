@@ -757,10 +757,12 @@ AlgorithmCiftiResample::AlgorithmCiftiResample(ProgressObject* myProgObj, const
                     throw AlgorithmException("unsupported surface structure: " + StructureEnum::toGuiName(surfList[i]));
                     break;
             }
+            myProgress.setTask("resampling " + StructureEnum::toName(surfList[i]));
             processSurfaceComponent(myCiftiIn, direction, surfList[i], mySurfMethod, myCiftiOut, surfLargest, surfdilatemm, curSphere, newSphere, curAreas, newAreas, surfDilateMethod, surfDilateExponent);
         }
         for (int i = 0; i < (int)volList.size(); ++i)
         {
+            myProgress.setTask("resampling " + StructureEnum::toName(volList[i]));
             processVolumeWarpfield(myCiftiIn, direction, volList[i], myVolMethod, myCiftiOut, voldilatemm, warpfield, volDilateMethod, volDilateExponent);
         }
     } else {//avoid cifti separate/replace with ALONG_ROW
@@ -776,6 +778,7 @@ AlgorithmCiftiResample::AlgorithmCiftiResample(ProgressObject* myProgObj, const
                 unassignedLabelKey[i] = myLabelMap.getMapLabelTable(i)->getUnassignedLabelKey();
             }
         }
+        myProgress.setTask("setting up row resampling");
         map<StructureEnum::Enum, ResampleCache> surfCache, volCache;//could make them different types, but whatever - two variables in case of structure overlap in surface and volume, as some members may get used by both
         setupRowResampling(surfCache, volCache, myCiftiIn, myCiftiOut, mySurfMethod, voldilatemm,
                            curLeftSphere, newLeftSphere, curLeftAreas, newLeftAreas,
@@ -783,6 +786,7 @@ AlgorithmCiftiResample::AlgorithmCiftiResample(ProgressObject* myProgObj, const
                            curCerebSphere, newCerebSphere, curCerebAreas, newCerebAreas);
         int64_t numRows = myInputXML.getDimensionLength(CiftiXML::ALONG_COLUMN);
         vector<float> inRow(myInputXML.getDimensionLength(CiftiXML::ALONG_ROW)), outRow(myOutXML.getDimensionLength(CiftiXML::ALONG_ROW));
+        myProgress.setTask("resampling rows");
         for (int64_t row = 0; row < numRows; ++row)
         {
             myCiftiIn->getRow(inRow.data(), row);
@@ -880,10 +884,12 @@ AlgorithmCiftiResample::AlgorithmCiftiResample(ProgressObject* myProgObj, const
                     throw AlgorithmException("unsupported surface structure: " + StructureEnum::toGuiName(surfList[i]));
                     break;
             }
+            myProgress.setTask("resampling " + StructureEnum::toName(surfList[i]));
             processSurfaceComponent(myCiftiIn, direction, surfList[i], mySurfMethod, myCiftiOut, surfLargest, surfdilatemm, curSphere, newSphere, curAreas, newAreas, surfDilateMethod, surfDilateExponent);
         }
         for (int i = 0; i < (int)volList.size(); ++i)
         {
+            myProgress.setTask("resampling " + StructureEnum::toName(volList[i]));
             processVolumeAffine(myCiftiIn, direction, volList[i], myVolMethod, myCiftiOut, voldilatemm, affine, volDilateMethod, volDilateExponent);
         }
     } else {//avoid cifti separate/replace with ALONG_ROW
@@ -899,6 +905,7 @@ AlgorithmCiftiResample::AlgorithmCiftiResample(ProgressObject* myProgObj, const
                 unassignedLabelKey[i] = myLabelMap.getMapLabelTable(i)->getUnassignedLabelKey();
             }
         }
+        myProgress.setTask("setting up row resampling");
         map<StructureEnum::Enum, ResampleCache> surfCache, volCache;//could make them different types, but whatever - two variables in case of structure overlap in surface and volume, as some members may get used by both
         setupRowResampling(surfCache, volCache, myCiftiIn, myCiftiOut, mySurfMethod, voldilatemm,
                            curLeftSphere, newLeftSphere, curLeftAreas, newLeftAreas,
@@ -906,6 +913,7 @@ AlgorithmCiftiResample::AlgorithmCiftiResample(ProgressObject* myProgObj, const
                            curCerebSphere, newCerebSphere, curCerebAreas, newCerebAreas);
         int64_t numRows = myInputXML.getDimensionLength(CiftiXML::ALONG_COLUMN);
         vector<float> inRow(myInputXML.getDimensionLength(CiftiXML::ALONG_ROW)), outRow(myOutXML.getDimensionLength(CiftiXML::ALONG_ROW));
+        myProgress.setTask("resampling rows");
         for (int64_t row = 0; row < numRows; ++row)
         {
             myCiftiIn->getRow(inRow.data(), row);
@@ -20,6 +20,7 @@
 
 #include "AlgorithmCiftiSeparate.h"
 #include "AlgorithmException.h"
+#include "CaretAssert.h"
 #include "CaretLogger.h"
 #include "CaretPointer.h"
 #include "CiftiFile.h"
@@ -29,12 +30,48 @@
 #include "Vector3D.h"
 #include "VolumeFile.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <map>
 
 using namespace caret;
 using namespace std;
 
+namespace
+{
+    //brain models rows of a structure are adjacent, so reading them a block at a time replaces many small reads with few large ones
+    class CiftiRowBlockReader
+    {
+        const CiftiFile* m_file;
+        int64_t m_rowLength, m_numRows, m_blockRows, m_firstRow, m_haveRows;
+        vector<float> m_block;
+    public:
+        CiftiRowBlockReader(const CiftiFile* file)
+        {
+            const int64_t BLOCK_BYTES = ((int64_t)1) << 26;
+            m_file = file;
+            m_rowLength = file->getNumberOfColumns();
+            m_numRows = file->getNumberOfRows();
+            m_blockRows = max(int64_t(1), BLOCK_BYTES / max(int64_t(1), m_rowLength * (int64_t)sizeof(float)));
+            m_firstRow = 0;
+            m_haveRows = 0;
+        }
+        
+        const float* getRow(const int64_t& index)
+        {
+            CaretAssert(index >= 0 && index < m_numRows);
+            if (index < m_firstRow || index >= m_firstRow + m_haveRows)
+            {
+                m_firstRow = index;
+                m_haveRows = min(m_blockRows, m_numRows - index);
+                m_block.resize(m_haveRows * m_rowLength);
+                m_file->getRows(m_block.data(), m_firstRow, m_haveRows);
+            }
+            return m_block.data() + (index - m_firstRow) * m_rowLength;
+        }
+    };
+}
+
 AString AlgorithmCiftiSeparate::getCommandSwitch()
 {
     return "-cifti-separate";
@@ -226,11 +263,11 @@ AlgorithmCiftiSeparate::AlgorithmCiftiSeparate(ProgressObject* myProgObj, const
             roiOut->setStructure(myStruct);
         }
         int mapSize = (int)myMap.size();
-        CaretArray<float> rowScratch(rowSize);
+        CiftiRowBlockReader rowReader(ciftiIn);
         CaretArray<float> nodeUsed(numNodes, 0.0f);
         for (int i = 0; i < mapSize; ++i)
         {
-            ciftiIn->getRow(rowScratch, myMap[i].m_ciftiIndex);
+            const float* rowScratch = rowReader.getRow(myMap[i].m_ciftiIndex);
             nodeUsed[myMap[i].m_surfaceNode] = 1.0f;
             for (int j = 0; j < rowSize; ++j)
             {
@@ -266,7 +303,8 @@ AlgorithmCiftiSeparate::AlgorithmCiftiSeparate(ProgressObject* myProgObj, const
             roiOut->setStructure(myStruct);
         }
         int mapSize = (int)myMap.size();
-        CaretArray<float> rowScratch(rowSize), metricScratch(numNodes, 0.0f);
+        CiftiRowBlockReader rowReader(ciftiIn);
+        CaretArray<float> metricScratch(numNodes, 0.0f);
         if (roiOut != NULL)
         {
             CaretArray<float> nodeUsed(numNodes, 0.0f);
@@ -278,7 +316,7 @@ AlgorithmCiftiSeparate::AlgorithmCiftiSeparate(ProgressObject* myProgObj, const
         }
         for (int i = 0; i < colSize; ++i)
         {
-            ciftiIn->getRow(rowScratch, i);
+            const float* rowScratch = rowReader.getRow(i);
             for (int j = 0; j < mapSize; ++j)
             {
                 metricScratch[myMap[j].m_surfaceNode] = rowScratch[myMap[j].m_ciftiIndex];
@@ -318,7 +356,7 @@ AlgorithmCiftiSeparate::AlgorithmCiftiSeparate(ProgressObject* myProgObj, const
             roiOut->setStructure(myStruct);
         }
         int64_t mapSize = (int64_t)myMap.size();
-        CaretArray<float> rowScratch(rowSize);
+        CiftiRowBlockReader rowReader(ciftiIn);
         CaretArray<float> nodeUsed(numNodes, 0.0f);
         GiftiLabelTable myTable;
         map<int32_t, int32_t> cumulativeRemap;
@@ -329,7 +367,7 @@ AlgorithmCiftiSeparate::AlgorithmCiftiSeparate(ProgressObject* myProgObj, const
         }
         for (int64_t i = 0; i < mapSize; ++i)
         {
-            ciftiIn->getRow(rowScratch, myMap[i].m_ciftiIndex);
+            const float* rowScratch = rowReader.getRow(myMap[i].m_ciftiIndex);
             nodeUsed[myMap[i].m_surfaceNode] = 1.0f;
             for (int j = 0; j < rowSize; ++j)
             {
@@ -383,7 +421,7 @@ AlgorithmCiftiSeparate::AlgorithmCiftiSeparate(ProgressObject* myProgObj, const
             }
             roiOut->setValuesForColumn(0, nodeUsed);
         }
-        CaretArray<float> rowScratch(rowSize);
+        CiftiRowBlockReader rowReader(ciftiIn);
         CaretArray<int> nodeUsed(numNodes, 0);
         for (int64_t j = 0; j < mapSize; ++j)
         {
@@ -400,7 +438,7 @@ AlgorithmCiftiSeparate::AlgorithmCiftiSeparate(ProgressObject* myProgObj, const
         int32_t unusedLabel = myTable.getUnassignedLabelKey();
         for (int64_t i = 0; i < colSize; ++i)
         {
-            ciftiIn->getRow(rowScratch, i);
+            const float* rowScratch = rowReader.getRow(i);
             for (int64_t j = 0; j < mapSize; ++j)
             {
                 int32_t inVal = (int32_t)floor(rowScratch[j] + 0.5f);
@@ -457,7 +495,7 @@ AlgorithmCiftiSeparate::AlgorithmCiftiSeparate(ProgressObject* myProgObj, const
         roiOut->reinitialize(newdims, mySform);
         roiOut->setValueAllVoxels(0.0f);
     }
-    CaretArray<float> rowScratch(rowSize);
+    CiftiRowBlockReader rowReader(ciftiIn);
     if (myDir == CiftiXML::ALONG_COLUMN)
     {
         if (rowSize > 1) newdims.push_back(rowSize);
@@ -484,7 +522,7 @@ AlgorithmCiftiSeparate::AlgorithmCiftiSeparate(ProgressObject* myProgObj, const
             {
                 roiOut->setValue(1.0f, thisvoxel);
             }
-            ciftiIn->getRow(rowScratch, myMap[i].m_ciftiIndex);
+            const float* rowScratch = rowReader.getRow(myMap[i].m_ciftiIndex);
             for (int j = 0; j < rowSize; ++j)
             {
                 volOut->setValue(rowScratch[j], thisvoxel, j);
@@ -510,7 +548,7 @@ AlgorithmCiftiSeparate::AlgorithmCiftiSeparate(ProgressObject* myProgObj, const
         }
         for (int64_t i = 0; i < colSize; ++i)
         {
-            ciftiIn->getRow(rowScratch, i);
+            const float* rowScratch = rowReader.getRow(i);
             for (int64_t j = 0; j < numVoxels; ++j)
             {
                 int64_t thisvoxel[3] = { myMap[j].m_ijk[0] - offsetOut[0], myMap[j].m_ijk[1] - offsetOut[1], myMap[j].m_ijk[2] - offsetOut[2] };
@@ -575,7 +613,7 @@ AlgorithmCiftiSeparate::AlgorithmCiftiSeparate(ProgressObject* myProgObj, const
     }
     vector<CiftiBrainModelsMap::VolumeMap> myMap = myBrainMap.getFullVolumeMap();
     int64_t numVoxels = (int64_t)myMap.size();
-    CaretArray<float> rowScratch(rowSize);
+    CiftiRowBlockReader rowReader(ciftiIn);
     if (myDir == CiftiXML::ALONG_COLUMN)
     {
         if (rowSize > 1) newdims.push_back(rowSize);
@@ -602,7 +640,7 @@ AlgorithmCiftiSeparate::AlgorithmCiftiSeparate(ProgressObject* myProgObj, const
             {
                 roiOut->setValue(1.0f, thisvoxel);
             }
-            ciftiIn->getRow(rowScratch, myMap[i].m_ciftiIndex);
+            const float* rowScratch = rowReader.getRow(myMap[i].m_ciftiIndex);
             for (int j = 0; j < rowSize; ++j)
             {
                 volOut->setValue(rowScratch[j], thisvoxel, j);
@@ -628,7 +666,7 @@ AlgorithmCiftiSeparate::AlgorithmCiftiSeparate(ProgressObject* myProgObj, const
         }
         for (int64_t i = 0; i < colSize; ++i)
         {
-            ciftiIn->getRow(rowScratch, i);
+            const float* rowScratch = rowReader.getRow(i);
             for (int64_t j = 0; j < numVoxels; ++j)
             {
                 int64_t thisvoxel[3] = { myMap[j].m_ijk[0] - offsetOut[0], myMap[j].m_ijk[1] - offsetOut[1], myMap[j].m_ijk[2] - offsetOut[2] };
@@ -28,11 +28,139 @@
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
 #include <set>
 
 using namespace caret;
 using namespace std;
 
+namespace
+{
+    ///godunov upwind solution of |grad u| = 1 given the smaller neighbor value along each axis, infinity means no usable neighbor
+    float eikonalUpdate(const float neighVals[3], const float spacing[3])
+    {
+        int order[3] = { 0, 1, 2 };
+        if (neighVals[order[1]] < neighVals[order[0]]) swap(order[0], order[1]);//stupid sort
+        if (neighVals[order[2]] < neighVals[order[1]]) swap(order[1], order[2]);
+        if (neighVals[order[1]] < neighVals[order[0]]) swap(order[0], order[1]);
+        float ret = numeric_limits<float>::infinity();
+        double sumWeight = 0.0, sumWeightVal = 0.0, sumWeightValSqr = 0.0;
+        for (int n = 0; n < 3; ++n)
+        {
+            float value = neighVals[order[n]];
+            if (!(value < ret)) break;//upwind neighbors only, the solution from fewer axes is already smaller than this one
+            double weight = 1.0 / (spacing[order[n]] * spacing[order[n]]);
+            sumWeight += weight;
+            sumWeightVal += weight * value;
+            sumWeightValSqr += weight * value * value;
+            double discriminant = sumWeightVal * sumWeightVal - sumWeight * (sumWeightValSqr - 1.0);
+            if (discriminant < 0.0) break;
+            ret = (float)((sumWeightVal + sqrt(discriminant)) / sumWeight);
+        }
+        return ret;
+    }
+    
+    ///gauss-seidel sweeps in all 8 diagonal orderings until nothing changes, computes unsigned distance and carries the sign of the upwind neighbor
+    ///frozen voxels (4 in volMarked) are the boundary condition, marks the voxels it assigns as frozen
+    void fastSweepFill(VolumeFile* myVol, CaretArray<int>& volMarked, const float spacing[3], const float& approxLim)
+    {
+        const int64_t* myDims = myVol->getDimensionsPtr();
+        const int64_t frameSize = myDims[0] * myDims[1] * myDims[2];
+        const int64_t steps[3] = { 1, myDims[0], myDims[0] * myDims[1] };
+        const float infinity = numeric_limits<float>::infinity();
+        vector<float> absDist(frameSize, infinity);
+        vector<signed char> distSign(frameSize, 1);
+        int64_t ijk[3];
+        for (ijk[2] = 0; ijk[2] < myDims[2]; ++ijk[2])
+        {
+            for (ijk[1] = 0; ijk[1] < myDims[1]; ++ijk[1])
+            {
+                for (ijk[0] = 0; ijk[0] < myDims[0]; ++ijk[0])
+                {
+                    int64_t index = myVol->getIndex(ijk);
+                    if ((volMarked[index] & 4) != 0)
+                    {
+                        float value = myVol->getValue(ijk);
+                        absDist[index] = abs(value);
+                        if (value < 0.0f) distSign[index] = -1;
+                    }
+                }
+            }
+        }
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            for (int sweep = 0; sweep < 8; ++sweep)
+            {
+                int64_t start[3], end[3], incr[3];
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    if ((sweep & (1 << axis)) == 0)
+                    {
+                        start[axis] = 0; end[axis] = myDims[axis]; incr[axis] = 1;
+                    } else {
+                        start[axis] = myDims[axis] - 1; end[axis] = -1; incr[axis] = -1;
+                    }
+                }
+                for (ijk[2] = start[2]; ijk[2] != end[2]; ijk[2] += incr[2])
+                {
+                    for (ijk[1] = start[1]; ijk[1] != end[1]; ijk[1] += incr[1])
+                    {
+                        for (ijk[0] = start[0]; ijk[0] != end[0]; ijk[0] += incr[0])
+                        {
+                            int64_t index = myVol->getIndex(ijk);
+                            if ((volMarked[index] & 4) != 0) continue;
+                            float neighVals[3];
+                            float bestNeigh = infinity;
+                            signed char bestSign = 1;
+                            for (int axis = 0; axis < 3; ++axis)
+                            {
+                                neighVals[axis] = infinity;
+                                if (ijk[axis] > 0) neighVals[axis] = absDist[index - steps[axis]];
+                                if (ijk[axis] + 1 < myDims[axis] && absDist[index + steps[axis]] < neighVals[axis])
+                                {
+                                    neighVals[axis] = absDist[index + steps[axis]];
+                                    if (neighVals[axis] < bestNeigh)
+                                    {
+                                        bestNeigh = neighVals[axis];
+                                        bestSign = distSign[index + steps[axis]];
+                                    }
+                                } else if (neighVals[axis] < bestNeigh) {
+                                    bestNeigh = neighVals[axis];
+                                    bestSign = distSign[index - steps[axis]];
+                                }
+                            }
+                            float newDist = eikonalUpdate(neighVals, spacing);
+                            if (newDist <= approxLim && newDist < absDist[index])//distance only grows along characteristics, so anything past the limit can't help
+                            {
+                                absDist[index] = newDist;
+                                distSign[index] = bestSign;
+                                changed = true;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        for (ijk[2] = 0; ijk[2] < myDims[2]; ++ijk[2])
+        {
+            for (ijk[1] = 0; ijk[1] < myDims[1]; ++ijk[1])
+            {
+                for (ijk[0] = 0; ijk[0] < myDims[0]; ++ijk[0])
+                {
+                    int64_t index = myVol->getIndex(ijk);
+                    if ((volMarked[index] & 4) == 0 && absDist[index] <= approxLim)
+                    {
+                        myVol->setValue(distSign[index] * absDist[index], ijk);
+                        volMarked[index] |= (distSign[index] < 0 ? 20 : 6);//value (positive or negative) and frozen, same as dijkstra
+                    }
+                }
+            }
+        }
+    }
+}
+
 AString AlgorithmCreateSignedDistanceVolume::getCommandSwitch()
 {
     return "-create-signed-distance-volume";
@@ -70,13 +198,17 @@ OperationParameters* AlgorithmCreateSignedDistanceVolume::getParameters()
     OptionalParameter* windingMethodOpt = ret->createOptionalParameter(8, "-winding", "winding method for point inside surface test");
     windingMethodOpt->addStringParameter(1, "method", "name of the method (default EVEN_ODD)");
     
+    ret->createOptionalParameter(10, "-fast-sweep", "approximate the extended region by fast sweeping instead of dijkstra's method");
+    
     ret->setHelpText(
         AString("Computes the signed distance function of the surface.  Exact distance is calculated by finding the closest point on any surface triangle ") +
         "to the center of the voxel.  Approximate distance is calculated starting with these distances, using dijkstra's method with a neighborhood of voxels.  " +
         "Specifying too small of an exact distance may produce unexpected results.  Valid specifiers for winding methods are as follows:\n\n" +
         "EVEN_ODD (default)\nNEGATIVE\nNONZERO\nNORMALS\n\nThe NORMALS method uses the normals of triangles and edges, or the closest triangle hit by a ray from the point.  " +
         "This method may be slightly faster, but is only reliable for a closed surface that does not cross through itself.  All other methods count entry (positive) and " +
-        "exit (negative) crossings of a vertical ray from the point, then counts as inside if the total is odd, negative, or nonzero, respectively."
+        "exit (negative) crossings of a vertical ray from the point, then counts as inside if the total is odd, negative, or nonzero, respectively.\n\n" +
+        "The -fast-sweep option solves the eikonal equation on the voxel grid, starting from the exact distances, instead of using dijkstra's method.  " +
+        "It does not use a neighborhood (so -approx-neighborhood is ignored), is usually faster when the approximate limit is large, and assumes the voxel axes are orthogonal."
     );
     return ret;
 }
@@ -144,11 +276,13 @@ void AlgorithmCreateSignedDistanceVolume::useParameters(OperationParameters* myP
     {
         myRoiOut = roiOutOpt->getOutputVolume(1);
     }
-    AlgorithmCreateSignedDistanceVolume(myProgObj, mySurf, myVolOut, myRoiOut, fillValue, exactLim, approxLim, approxNeighborhood, myWinding);
+    bool fastSweep = myParams->getOptionalParameter(10)->m_present;
+    AlgorithmCreateSignedDistanceVolume(myProgObj, mySurf, myVolOut, myRoiOut, fillValue, exactLim, approxLim, approxNeighborhood, myWinding, fastSweep);
 }
 
 AlgorithmCreateSignedDistanceVolume::AlgorithmCreateSignedDistanceVolume(ProgressObject* myProgObj, const SurfaceFile* mySurf, VolumeFile* myVolOut, VolumeFile* myRoiOut, const float& fillValue,
-                                                                         const float& exactLim, const float& approxLim, const int& approxNeighborhood, const SignedDistanceHelper::WindingLogic& myWinding) : AbstractAlgorithm(myProgObj)
+                                                                         const float& exactLim, const float& approxLim, const int& approxNeighborhood, const SignedDistanceHelper::WindingLogic& myWinding,
+                                                                         const bool& fastSweep) : AbstractAlgorithm(myProgObj)
 {
     if (exactLim <= 0.0f)
     {
@@ -285,7 +419,13 @@ AlgorithmCreateSignedDistanceVolume::AlgorithmCreateSignedDistanceVolume(Progres
         }
     }
     myProgress.reportProgress(markweight + exactweight);
-    if (approxLim > exactLim)
+    if (approxLim > exactLim && fastSweep)
+    {
+        myProgress.setTask("approximating distances in extended region");
+        float spacing[3] = { ivec.length(), jvec.length(), kvec.length() };
+        fastSweepFill(myVolOut, volMarked, spacing, approxLim);
+    }
+    if (approxLim > exactLim && !fastSweep)
     {
         myProgress.setTask("approximating distances in extended region");
         int faceNeigh[] = { 1, 0, 0, 
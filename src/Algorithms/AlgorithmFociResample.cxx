@@ -121,7 +121,10 @@ AlgorithmFociResample::AlgorithmFociResample(ProgressObject* myProgObj, const Fo
     *(fociOut->getClassColorTable()) = *(fociIn->getClassColorTable());
     *(fociOut->getNameColorTable()) = *(fociIn->getNameColorTable());
     *(fociOut->getFileMetaData()) = *(fociIn->getFileMetaData());
-    for (int i = 0; i < fociIn->getNumberOfFoci(); ++i)
+    int numFoci = fociIn->getNumberOfFoci();
+    vector<CaretPointer<Focus> > newFoci(numFoci);
+    vector<Focus*> leftFoci(numFoci, NULL), rightFoci(numFoci, NULL), cerebFoci(numFoci, NULL);//NULL for foci of other structures, so indices in messages match the file
+    for (int i = 0; i < numFoci; ++i)
     {
         const Focus* thisFocus = fociIn->getFocus(i);
         if (thisFocus->getNumberOfProjections() < 1)
@@ -130,36 +133,46 @@ AlgorithmFociResample::AlgorithmFociResample(ProgressObject* myProgObj, const Fo
         }
         SurfaceProjector* myProj = NULL;
         const SurfaceFile* unprojFrom = NULL;
+        vector<Focus*>* projList = NULL;
         switch (thisFocus->getProjection(0)->getStructure())
         {
             case StructureEnum::CORTEX_LEFT:
                 myProj = leftProj;
                 unprojFrom = leftCurSurf;
+                projList = &leftFoci;
                 break;
             case StructureEnum::CORTEX_RIGHT:
                 myProj = rightProj;
                 unprojFrom = rightCurSurf;
+                projList = &rightFoci;
                 break;
             case StructureEnum::CEREBELLUM:
                 myProj = cerebProj;
                 unprojFrom = cerebCurSurf;
+                projList = &cerebFoci;
                 break;
             default:
                 throw AlgorithmException("focus '" + thisFocus->getName() + "' has unsupported structure " + StructureEnum::toName(thisFocus->getProjection(0)->getStructure()));
         }
         if (unprojFrom == NULL || myProj == NULL) throw AlgorithmException("focus '" + thisFocus->getName() + "' has structure " +
             StructureEnum::toName(thisFocus->getProjection(0)->getStructure()) + ", but surfaces for that structure were not specified");
-        CaretPointer<Focus> newFocus(new Focus(*thisFocus));//start with a copy
+        newFoci[i].grabNew(new Focus(*thisFocus));//start with a copy
         float xyz[3];
         bool result = thisFocus->getProjection(0)->getProjectedPosition(*unprojFrom, xyz, discardNormDist);
         if (!result) throw AlgorithmException("failed to unproject focus '" + thisFocus->getName() + "'");
-        newFocus->getProjection(0)->setStereotaxicXYZ(xyz);
-        myProj->projectFocus(i, newFocus);
+        newFoci[i]->getProjection(0)->setStereotaxicXYZ(xyz);
+        (*projList)[i] = newFoci[i];
+    }
+    if (leftNewSurf != NULL) leftProj->projectFoci(leftFoci);//each projects its foci in parallel
+    if (rightNewSurf != NULL) rightProj->projectFoci(rightFoci);
+    if (cerebNewSurf != NULL) cerebProj->projectFoci(cerebFoci);
+    for (int i = 0; i < numFoci; ++i)
+    {
         if (restoryXyz)
         {
-            newFocus->getProjection(0)->setStereotaxicXYZ(thisFocus->getProjection(0)->getStereotaxicXYZ());
+            newFoci[i]->getProjection(0)->setStereotaxicXYZ(fociIn->getFocus(i)->getProjection(0)->getStereotaxicXYZ());
         }
-        fociOut->addFocus(newFocus.releasePointer());
+        fociOut->addFocus(newFoci[i].releasePointer());
     }
 }
 
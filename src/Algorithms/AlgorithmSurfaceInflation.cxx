@@ -27,7 +27,9 @@
 #include "BoundingBox.h"
 #include "CaretAssert.h"
 #include "CaretLogger.h"
+#include "CaretOMP.h"
 #include "SurfaceFile.h"
+#include "SurfaceSmoothingHelper.h"
 
 using namespace caret;
 
@@ -138,6 +140,16 @@ AlgorithmSurfaceInflation::AlgorithmSurfaceInflation(ProgressObject* myProgObj,
                                                      const float inflationFactorIn)
    : AbstractAlgorithm(myProgObj)
 {
+    if ((strength < 0.0)
+        || (strength > 1.0)) {
+        throw AlgorithmException("Invalid smoothing strength outside [0.0, 1.0]: "
+                                 + QString::number(strength, 'f', 5));
+    }
+    if (iterations <= 0) {
+        throw AlgorithmException("Invalid iterations value [1, infinity]: "
+                                 + QString::number(iterations));
+    }
+    
     std::vector<ProgressObject*> subAlgProgress;
     if (myProgObj != NULL) {
         subAlgProgress.resize(cycles);
@@ -165,6 +177,12 @@ AlgorithmSurfaceInflation::AlgorithmSurfaceInflation(ProgressObject* myProgObj,
     
     const int32_t numberOfNodes = outputSurfaceFile->getNumberOfNodes();
     
+    /*
+     * Neighbor lists are only built once for all cycles, and
+     * the coordinates stay in the smoothing helper until done
+     */
+    SurfaceSmoothingHelper mySmoother(outputSurfaceFile);
+    
     for (int iCycle = 0; iCycle < cycles; iCycle++) {
         /*
          * Smooth
@@ -174,19 +192,18 @@ AlgorithmSurfaceInflation::AlgorithmSurfaceInflation(ProgressObject* myProgObj,
         {
             subProgress = subAlgProgress[iCycle];
         }
-        AlgorithmSurfaceSmoothing(subProgress,
-                                  outputSurfaceFile,
-                                  outputSurfaceFile,
-                                  strength,
-                                  iterations);
+        {
+            LevelProgress smoothProgress(subProgress);
+            mySmoother.smooth(strength, iterations, &smoothProgress);
+        }
+        float* coords = mySmoother.getCoordinates();//the current buffer changes with the number of iterations
         
         /*
          * Inflate
          */
-        float xyz[3];
+#pragma omp CARET_PARFOR schedule(static)
         for (int32_t iNode = 0; iNode < numberOfNodes; iNode++) {
-            outputSurfaceFile->getCoordinate(iNode,
-                                             xyz);
+            float* xyz = coords + iNode * 3;
             
             const float x = xyz[0] / anatomicalRangeX;
             const float y = xyz[1] / anatomicalRangeY;
@@ -198,15 +215,13 @@ AlgorithmSurfaceInflation::AlgorithmSurfaceInflation(ProgressObject* myProgObj,
             xyz[0] *= scale;
             xyz[1] *= scale;
             xyz[2] *= scale;
-            
-            outputSurfaceFile->setCoordinate(iNode,
-                                             xyz);
         }
         
         myProgress.reportProgress(static_cast<float>(iCycle +1)
                                   / static_cast<float>(cycles));
     }
     
+    outputSurfaceFile->setCoordinates(mySmoother.getCoordinates());
     outputSurfaceFile->computeNormals();
 }
 
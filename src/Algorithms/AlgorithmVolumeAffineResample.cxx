@@ -25,6 +25,7 @@
 #include "CaretOMP.h"
 #include "NiftiIO.h"
 #include "Vector3D.h"
+#include "VolumeResamplePlan.h"
 
 using namespace caret;
 using namespace std;
@@ -135,35 +136,22 @@ AlgorithmVolumeAffineResample::AlgorithmVolumeAffineResample(ProgressObject* myP
             *(outVol->getMapLabelTable(i)) = *(inVol->getMapLabelTable(i));
         }
     }
-    for (int64_t c = 0; c < numComponents; ++c)
+    VolumeResamplePlan myPlan(inVol->getVolumeSpace(), refDims, myMethod);//the coordinate transforms are the same for every frame
+#pragma omp CARET_PARFOR schedule(dynamic)
+    for (int64_t k = 0; k < outDims[2]; ++k)
     {
-        for (int64_t b = 0; b < numMaps; ++b)
+        for (int64_t j = 0; j < outDims[1]; ++j)
         {
-            if (myMethod == VolumeFile::CUBIC)
-            {
-                inVol->validateSpline(b, c);//because deconvolve is parallel, but won't execute parallel if we are already in a parallel section
-            }
-#pragma omp CARET_PARFOR schedule(dynamic)
-            for (int64_t k = 0; k < outDims[2]; ++k)
-            {
-                for (int64_t j = 0; j < outDims[1]; ++j)
-                {
-                    for (int64_t i = 0; i < outDims[0]; ++i)
-                    {
-                        Vector3D outCoord, inCoord;
-                        outVol->indexToSpace(i, j, k, outCoord);
-                        inCoord = xvec * outCoord[0] + yvec * outCoord[1] + zvec * outCoord[2] + offset;
-                        float interpVal = inVol->interpolateValue(inCoord, myMethod, NULL, b, c);
-                        outVol->setValue(interpVal, i, j, k, b, c);
-                    }
-                }
-            }
-            if (myMethod == VolumeFile::CUBIC)
+            for (int64_t i = 0; i < outDims[0]; ++i)
             {
-                inVol->freeSpline(b, c);//release memory we no longer need, if we allocated it
+                Vector3D outCoord, inCoord;
+                outVol->indexToSpace(i, j, k, outCoord);
+                inCoord = xvec * outCoord[0] + yvec * outCoord[1] + zvec * outCoord[2] + offset;
+                myPlan.setSourceCoordinate(i, j, k, inCoord);
             }
         }
     }
+    myPlan.resample(inVol, outVol);
 }
 
 float AlgorithmVolumeAffineResample::getAlgorithmInternalWeight()
@@ -21,10 +21,12 @@
 #include "AlgorithmVolumeWarpfieldResample.h"
 #include "AlgorithmException.h"
 
+#include "AffineFile.h"
 #include "CaretLogger.h"
 #include "CaretOMP.h"
 #include "NiftiIO.h"
 #include "Vector3D.h"
+#include "VolumeResamplePlan.h"
 #include "WarpfieldFile.h"
 
 using namespace caret;
@@ -56,9 +58,17 @@ OperationParameters* AlgorithmVolumeWarpfieldResample::getParameters()
     OptionalParameter* fnirtOpt = ret->createOptionalParameter(6, "-fnirt", "MUST be used if using a fnirt warpfield");
     fnirtOpt->addStringParameter(1, "source-volume", "the source volume used when generating the warpfield");
     
+    OptionalParameter* affineOpt = ret->createOptionalParameter(7, "-affine", "apply an affine to the input before the warpfield, in the same resampling");
+    affineOpt->addStringParameter(1, "affine", "the affine file to apply first");
+    OptionalParameter* flirtOpt = affineOpt->createOptionalParameter(2, "-flirt", "MUST be used if affine is a flirt affine");
+    flirtOpt->addStringParameter(1, "source-volume", "the source volume used when generating the affine");
+    flirtOpt->addStringParameter(2, "target-volume", "the target volume used when generating the affine");
+    
     ret->setHelpText(
         AString("Resample a volume file with a warpfield.  ") +
-        "The recommended methods are CUBIC (cubic spline) for most data, and ENCLOSING_VOXEL for label data.  "
+        "The recommended methods are CUBIC (cubic spline) for most data, and ENCLOSING_VOXEL for label data.  " +
+        "The -affine option gives the same result as using -volume-affine-resample into the source space of the warpfield and then using this command, " +
+        "but interpolates the data only once.  "
         "The parameter <method> must be one of:\n\n" +
         "CUBIC\nENCLOSING_VOXEL\nTRILINEAR"
     );
@@ -73,6 +83,7 @@ void AlgorithmVolumeWarpfieldResample::useParameters(OperationParameters* myPara
     AString method = myParams->getString(4);
     VolumeFile* outVol = myParams->getOutputVolume(5);
     OptionalParameter* fnirtOpt = myParams->getOptionalParameter(6);
+    OptionalParameter* affineOpt = myParams->getOptionalParameter(7);
     WarpfieldFile myWarpfield;
     if (fnirtOpt->m_present)
     {
@@ -91,13 +102,28 @@ void AlgorithmVolumeWarpfieldResample::useParameters(OperationParameters* myPara
     } else {
         throw AlgorithmException("unrecognized interpolation method");
     }
+    FloatMatrix affMat;
+    if (affineOpt->m_present)
+    {
+        AffineFile myAffine;
+        OptionalParameter* flirtOpt = affineOpt->getOptionalParameter(2);
+        if (flirtOpt->m_present)
+        {
+            myAffine.readFlirt(affineOpt->getString(1), flirtOpt->getString(1), flirtOpt->getString(2));
+        } else {
+            myAffine.readWorld(affineOpt->getString(1));
+        }
+        affMat = FloatMatrix(myAffine.getMatrix());
+    }
     NiftiIO refSpaceIO;
     refSpaceIO.openRead(refSpaceName);
-    AlgorithmVolumeWarpfieldResample(myProgObj, inVol, myWarpfield.getWarpfield(), refSpaceIO.getDimensions().data(), refSpaceIO.getHeader().getSForm(), myMethod, outVol);
+    AlgorithmVolumeWarpfieldResample(myProgObj, inVol, myWarpfield.getWarpfield(), refSpaceIO.getDimensions().data(), refSpaceIO.getHeader().getSForm(), myMethod, outVol,
+                                     (affineOpt->m_present ? &affMat : NULL));
 }
 
 AlgorithmVolumeWarpfieldResample::AlgorithmVolumeWarpfieldResample(ProgressObject* myProgObj, const VolumeFile* inVol, const VolumeFile* warpfield,
-                                                                   const int64_t refDims[3], const vector<vector<float> >& refSform, const VolumeFile::InterpType& myMethod, VolumeFile* outVol) : AbstractAlgorithm(myProgObj)
+                                                                   const int64_t refDims[3], const vector<vector<float> >& refSform, const VolumeFile::InterpType& myMethod, VolumeFile* outVol,
+                                                                   const FloatMatrix* sourceAffine) : AbstractAlgorithm(myProgObj)
 {
     LevelProgress myProgress(myProgObj);
     vector<int64_t> warpDims;
@@ -121,44 +147,55 @@ AlgorithmVolumeWarpfieldResample::AlgorithmVolumeWarpfieldResample(ProgressObjec
             *(outVol->getMapLabelTable(i)) = *(inVol->getMapLabelTable(i));
         }
     }
-    for (int64_t c = 0; c < numComponents; ++c)
+    Vector3D xvec(1.0f, 0.0f, 0.0f), yvec(0.0f, 1.0f, 0.0f), zvec(0.0f, 0.0f, 1.0f), offset(0.0f, 0.0f, 0.0f);//identity unless there is an affine
+    if (sourceAffine != NULL)
+    {//same as AlgorithmVolumeAffineResample, to go from the space of the warpfield's source to the input volume
+        int64_t affRows, affColumns;
+        sourceAffine->getDimensions(affRows, affColumns);
+        if (affRows < 3 || affRows > 4 || affColumns != 4) throw AlgorithmException("input matrix is not an affine matrix");
+        FloatMatrix targetToSource = *sourceAffine;
+        targetToSource.resize(4, 4);
+        targetToSource[3][0] = 0.0f;
+        targetToSource[3][1] = 0.0f;
+        targetToSource[3][2] = 0.0f;
+        targetToSource[3][3] = 1.0f;
+        targetToSource = targetToSource.inverse();
+        xvec[0] = targetToSource[0][0]; xvec[1] = targetToSource[1][0]; xvec[2] = targetToSource[2][0];
+        yvec[0] = targetToSource[0][1]; yvec[1] = targetToSource[1][1]; yvec[2] = targetToSource[2][1];
+        zvec[0] = targetToSource[0][2]; zvec[1] = targetToSource[1][2]; zvec[2] = targetToSource[2][2];
+        offset[0] = targetToSource[0][3]; offset[1] = targetToSource[1][3]; offset[2] = targetToSource[2][3];
+    }
+    VolumeResamplePlan myPlan(inVol->getVolumeSpace(), refDims, myMethod);//warpfield interpolation is the same for every frame, so only do it once
+#pragma omp CARET_PARFOR schedule(dynamic)
+    for (int64_t k = 0; k < outDims[2]; ++k)
     {
-        for (int64_t b = 0; b < numMaps; ++b)
+        for (int64_t j = 0; j < outDims[1]; ++j)
         {
-            if (myMethod == VolumeFile::CUBIC)
-            {
-                inVol->validateSpline(b, c);//because deconvolve is parallel, but won't execute parallel if we are already in a parallel section
-            }
-#pragma omp CARET_PARFOR schedule(dynamic)
-            for (int64_t k = 0; k < outDims[2]; ++k)
+            for (int64_t i = 0; i < outDims[0]; ++i)
             {
-                for (int64_t j = 0; j < outDims[1]; ++j)
+                Vector3D outCoord, warpedCoord, inCoord, displacement;
+                outVol->indexToSpace(i, j, k, outCoord);
+                bool validDisplacement = false;
+                displacement[0] = warpfield->interpolateValue(outCoord, VolumeFile::TRILINEAR, &validDisplacement, 0);
+                if (validDisplacement)
                 {
-                    for (int64_t i = 0; i < outDims[0]; ++i)
+                    displacement[1] = warpfield->interpolateValue(outCoord, VolumeFile::TRILINEAR, NULL, 1);
+                    displacement[2] = warpfield->interpolateValue(outCoord, VolumeFile::TRILINEAR, NULL, 2);
+                    warpedCoord = outCoord + displacement;
+                    if (sourceAffine != NULL)
                     {
-                        Vector3D outCoord, inCoord, displacement;
-                        outVol->indexToSpace(i, j, k, outCoord);
-                        bool validDisplacement = false;
-                        displacement[0] = warpfield->interpolateValue(outCoord, VolumeFile::TRILINEAR, &validDisplacement, 0);
-                        if (validDisplacement)
-                        {
-                            displacement[1] = warpfield->interpolateValue(outCoord, VolumeFile::TRILINEAR, NULL, 1);
-                            displacement[2] = warpfield->interpolateValue(outCoord, VolumeFile::TRILINEAR, NULL, 2);
-                            inCoord = outCoord + displacement;
-                            float interpVal = inVol->interpolateValue(inCoord, myMethod, NULL, b, c);
-                            outVol->setValue(interpVal, i, j, k, b, c);
-                        } else {
-                            outVol->setValue(VolumeFile::INVALID_INTERP_VALUE, i, j, k, b, c);
-                        }
+                        inCoord = xvec * warpedCoord[0] + yvec * warpedCoord[1] + zvec * warpedCoord[2] + offset;
+                    } else {
+                        inCoord = warpedCoord;
                     }
+                    myPlan.setSourceCoordinate(i, j, k, inCoord);
+                } else {
+                    myPlan.setInvalid(i, j, k);
                 }
             }
-            if (myMethod == VolumeFile::CUBIC)
-            {
-                inVol->freeSpline(b, c);//release memory we no longer need, if we allocated it
-            }
         }
     }
+    myPlan.resample(inVol, outVol);
 }
 
 float AlgorithmVolumeWarpfieldResample::getAlgorithmInternalWeight()
@@ -22,6 +22,7 @@
 /*LICENSE_END*/
 
 #include "AbstractAlgorithm.h"
+#include "FloatMatrix.h"
 #include "VolumeFile.h"
 
 namespace caret {
@@ -34,7 +35,8 @@ namespace caret {
         static float getAlgorithmInternalWeight();
     public:
         AlgorithmVolumeWarpfieldResample(ProgressObject* myProgObj, const VolumeFile* inVol, const VolumeFile* warpfield,
-                                         const int64_t refDims[3], const std::vector<std::vector<float> >& refSform, const VolumeFile::InterpType& myMethod, VolumeFile* outVol);
+                                         const int64_t refDims[3], const std::vector<std::vector<float> >& refSform, const VolumeFile::InterpType& myMethod, VolumeFile* outVol,
+                                         const FloatMatrix* sourceAffine = NULL);
         static OperationParameters* getParameters();
         static void useParameters(OperationParameters* myParams, ProgressObject* myProgObj);
         static AString getCommandSwitch();
@@ -0,0 +1,275 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2016  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "BenchmarkInputs.h"
+
+#include "AffineFile.h"
+#include "AlgorithmSurfaceCreateSphere.h"
+#include "CaretException.h"
+#include "CaretLogger.h"
+#include "CiftiFile.h"
+#include "FloatMatrix.h"
+#include "MetricFile.h"
+#include "SurfaceFile.h"
+#include "VolumeFile.h"
+
+#include <QDir>
+#include <QFile>
+
+#include <cmath>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+namespace
+{
+    ///deterministic noise, so that every run and every build sees identical input data
+    class BenchmarkNoise
+    {
+        uint32_t m_state;
+    public:
+        BenchmarkNoise(const uint32_t& seed) { m_state = seed; }
+        float next()
+        {
+            m_state = m_state * 1664525u + 1013904223u;//numerical recipes LCG
+            return (m_state >> 8) / 16777216.0f - 0.5f;
+        }
+    };
+
+    ///smooth spatial patterns with a few frequencies over time, plus noise, so correlation and smoothing see realistic structure
+    void syntheticRow(const float* coord, const int32_t& length, BenchmarkNoise& noise, float* rowOut)
+    {
+        for (int32_t t = 0; t < length; ++t)
+        {
+            float value = 0.0f;
+            for (int k = 0; k < 3; ++k)
+            {
+                value += coord[k] / 100.0f * sin(0.05f * (k + 1) * t + k);//coordinates are on a radius 100 sphere
+            }
+            rowOut[t] = value + 0.5f * noise.next();
+        }
+    }
+}
+
+BenchmarkSizes::BenchmarkSizes()
+{
+    m_surfaceVertices = 32492;
+    m_resampleVertices = 40962;
+    m_metricColumns = 8;
+    m_timePoints = 1200;
+    m_dconnVertices = 5000;
+    m_volumeDimension = 96;
+    m_volumeFrames = 20;
+}
+
+BenchmarkInputs::BenchmarkInputs(const AString& directory, const BenchmarkSizes& sizes, const bool& removeOnDestruction)
+{
+    m_directory = directory;
+    m_sizes = sizes;
+    m_removeOnDestruction = removeOnDestruction;
+}
+
+BenchmarkInputs::~BenchmarkInputs()
+{
+    if (m_removeOnDestruction)
+    {
+        removeFiles();
+    }
+}
+
+AString BenchmarkInputs::getFileName(const AString& name) const
+{
+    const AString ret = m_directory + "/" + name;
+    m_fileNames.insert(ret);
+    return ret;
+}
+
+void BenchmarkInputs::generate()
+{
+    if (!QDir().mkpath(m_directory))
+    {
+        throw CaretException("unable to create benchmark directory '" + m_directory + "'");
+    }
+    if (m_sizes.m_surfaceVertices < 12 || m_sizes.m_resampleVertices < 12 || m_sizes.m_dconnVertices < 12)
+    {
+        throw CaretException("surfaces must have at least 12 vertices");
+    }
+    if (m_sizes.m_metricColumns < 1 || m_sizes.m_timePoints < 2 || m_sizes.m_volumeDimension < 2 || m_sizes.m_volumeFrames < 1)
+    {
+        throw CaretException("benchmark input sizes are too small");
+    }
+    SurfaceFile sphere, resampleSphere, dconnSphere;
+    CaretLogInfo("generating benchmark inputs in '" + m_directory + "'");
+    generateSurface(m_sizes.m_surfaceVertices, getSphereFileName(), sphere);
+    generateSurface(m_sizes.m_resampleVertices, getResampleSphereFileName(), resampleSphere);
+    generateSurface(m_sizes.m_dconnVertices, getDconnSphereFileName(), dconnSphere);
+    generateMetric(sphere);
+    generateDataSeries(sphere, m_sizes.m_timePoints, getDataSeriesFileName());
+    generateDataSeries(dconnSphere, m_sizes.m_timePoints, getDconnDataSeriesFileName());
+    generateDenseConnectivity(dconnSphere);
+    generateVolume();
+    generateAffine();
+    m_sizes.m_surfaceVertices = sphere.getNumberOfNodes();//report the sizes that were actually generated
+    m_sizes.m_resampleVertices = resampleSphere.getNumberOfNodes();
+    m_sizes.m_dconnVertices = dconnSphere.getNumberOfNodes();
+}
+
+void BenchmarkInputs::generateSurface(const int32_t& numVertices, const AString& fileName, SurfaceFile& surfaceOut)
+{
+    AlgorithmSurfaceCreateSphere(NULL, numVertices, &surfaceOut);//closest divided icosahedron, 32492 and 163842 are exact
+    surfaceOut.setStructure(StructureEnum::CORTEX_LEFT);
+    surfaceOut.writeFile(fileName);
+}
+
+void BenchmarkInputs::generateMetric(const SurfaceFile& sphere)
+{
+    const int32_t numNodes = sphere.getNumberOfNodes();
+    MetricFile myMetric;
+    myMetric.setNumberOfNodesAndColumns(numNodes, m_sizes.m_metricColumns);
+    myMetric.setStructure(StructureEnum::CORTEX_LEFT);
+    BenchmarkNoise noise(1);
+    vector<float> rowScratch(m_sizes.m_metricColumns);
+    vector<vector<float> > columns(m_sizes.m_metricColumns, vector<float>(numNodes));
+    for (int32_t node = 0; node < numNodes; ++node)
+    {
+        syntheticRow(sphere.getCoordinate(node), m_sizes.m_metricColumns, noise, rowScratch.data());
+        for (int32_t col = 0; col < m_sizes.m_metricColumns; ++col)
+        {
+            columns[col][node] = rowScratch[col];
+        }
+    }
+    for (int32_t col = 0; col < m_sizes.m_metricColumns; ++col)
+    {
+        myMetric.setValuesForColumn(col, columns[col].data());
+    }
+    myMetric.writeFile(getMetricFileName());
+}
+
+void BenchmarkInputs::generateDataSeries(const SurfaceFile& sphere, const int32_t& timePoints, const AString& fileName)
+{
+    const int32_t numNodes = sphere.getNumberOfNodes();
+    CiftiXML myXML;
+    myXML.setNumberOfDimensions(2);
+    CiftiBrainModelsMap denseMap;
+    denseMap.addSurfaceModel(numNodes, StructureEnum::CORTEX_LEFT);
+    myXML.setMap(CiftiXML::ALONG_COLUMN, denseMap);
+    CiftiSeriesMap seriesMap;
+    seriesMap.setUnit(CiftiSeriesMap::SECOND);
+    seriesMap.setStart(0.0f);
+    seriesMap.setStep(0.72f);
+    seriesMap.setLength(timePoints);
+    myXML.setMap(CiftiXML::ALONG_ROW, seriesMap);
+    CiftiFile myCifti;
+    myCifti.setWritingFile(fileName);//write rows directly to disk, so large inputs don't need to fit in memory
+    myCifti.setCiftiXML(myXML, false);
+    BenchmarkNoise noise(2);
+    vector<float> scratchRow(timePoints);
+    for (int32_t node = 0; node < numNodes; ++node)
+    {
+        syntheticRow(sphere.getCoordinate(node), timePoints, noise, scratchRow.data());
+        myCifti.setRow(scratchRow.data(), node);
+    }
+    myCifti.writeFile(fileName);
+}
+
+void BenchmarkInputs::generateDenseConnectivity(const SurfaceFile& sphere)
+{
+    const int32_t numNodes = sphere.getNumberOfNodes();
+    CiftiXML myXML;
+    myXML.setNumberOfDimensions(2);
+    CiftiBrainModelsMap denseMap;
+    denseMap.addSurfaceModel(numNodes, StructureEnum::CORTEX_LEFT);
+    myXML.setMap(CiftiXML::ALONG_COLUMN, denseMap);
+    myXML.setMap(CiftiXML::ALONG_ROW, denseMap);
+    CiftiFile myCifti;
+    myCifti.setWritingFile(getDconnFileName());
+    myCifti.setCiftiXML(myXML, false);
+    vector<float> scratchRow(numNodes);
+    for (int32_t row = 0; row < numNodes; ++row)
+    {
+        const float* rowCoord = sphere.getCoordinate(row);
+        for (int32_t col = 0; col < numNodes; ++col)
+        {//cosine of angle between vertices, a smooth, symmetric stand-in for connectivity
+            const float* colCoord = sphere.getCoordinate(col);
+            scratchRow[col] = (rowCoord[0] * colCoord[0] + rowCoord[1] * colCoord[1] + rowCoord[2] * colCoord[2]) / 10000.0f;
+        }
+        myCifti.setRow(scratchRow.data(), row);
+    }
+    myCifti.writeFile(getDconnFileName());
+}
+
+void BenchmarkInputs::generateVolume()
+{
+    const int64_t dim = m_sizes.m_volumeDimension;
+    vector<int64_t> dims(3, dim);
+    dims.push_back(m_sizes.m_volumeFrames);
+    vector<vector<float> > sform(3, vector<float>(4, 0.0f));
+    for (int i = 0; i < 3; ++i)
+    {
+        sform[i][i] = 2.0f;//2mm voxels, centered on the origin
+        sform[i][3] = -dim;
+    }
+    VolumeFile myVol(dims, sform);
+    BenchmarkNoise noise(3);
+    vector<float> frame(dim * dim * dim);
+    for (int32_t f = 0; f < m_sizes.m_volumeFrames; ++f)
+    {
+        int64_t index = 0;
+        for (int64_t k = 0; k < dim; ++k)
+        {
+            for (int64_t j = 0; j < dim; ++j)
+            {
+                for (int64_t i = 0; i < dim; ++i)
+                {//blobs that drift between frames
+                    frame[index] = sin(0.2f * i + 0.1f * f) * cos(0.15f * j) * sin(0.1f * k + 0.05f * f) + 0.25f * noise.next();
+                    ++index;
+                }
+            }
+        }
+        myVol.setFrame(frame.data(), f);
+    }
+    myVol.writeFile(getVolumeFileName());
+}
+
+void BenchmarkInputs::generateAffine()
+{
+    FloatMatrix myMatrix = FloatMatrix::identity(4);
+    const float angle = 0.1f;//small rotation about z plus a translation, so resampling does real interpolation
+    myMatrix[0][0] = cos(angle);
+    myMatrix[0][1] = -sin(angle);
+    myMatrix[1][0] = sin(angle);
+    myMatrix[1][1] = cos(angle);
+    myMatrix[0][3] = 1.3f;
+    myMatrix[1][3] = -0.7f;
+    myMatrix[2][3] = 0.4f;
+    AffineFile myAffine;
+    myAffine.setMatrix(myMatrix);
+    myAffine.writeWorld(getAffineFileName());
+}
+
+void BenchmarkInputs::removeFiles()
+{
+    for (set<AString>::const_iterator iter = m_fileNames.begin(); iter != m_fileNames.end(); ++iter)
+    {
+        if (QFile::exists(*iter)) QFile::remove(*iter);
+    }
+    QDir().rmdir(m_directory);//only succeeds if it is now empty, so a user-specified directory with other files is left alone
+}
@@ -0,0 +1,82 @@
+#ifndef __BENCHMARK_INPUTS_H__
+#define __BENCHMARK_INPUTS_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2016  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "AString.h"
+
+#include <set>
+#include <stdint.h>
+
+namespace caret {
+
+    class SurfaceFile;
+
+    ///sizes of the synthetic inputs, defaults are typical of HCP data at 32k resolution
+    struct BenchmarkSizes
+    {
+        int32_t m_surfaceVertices;//number of vertices in sphere, metric and dtseries
+        int32_t m_resampleVertices;//number of vertices in the sphere that is resampled to
+        int32_t m_metricColumns;
+        int32_t m_timePoints;//number of columns in the dtseries
+        int32_t m_dconnVertices;//dconn is square, so it uses a separate, smaller sphere
+        int32_t m_volumeDimension;//volume is a cube
+        int32_t m_volumeFrames;
+        BenchmarkSizes();
+    };
+
+    ///generates deterministic synthetic input files in a directory, so that all builds benchmark on identical data
+    class BenchmarkInputs
+    {
+        AString m_directory;
+        BenchmarkSizes m_sizes;
+        bool m_removeOnDestruction;
+        mutable std::set<AString> m_fileNames;//every file name given out, so that only these files are removed
+        void generateSurface(const int32_t& numVertices, const AString& fileName, SurfaceFile& surfaceOut);
+        void generateMetric(const SurfaceFile& sphere);
+        void generateDataSeries(const SurfaceFile& sphere, const int32_t& timePoints, const AString& fileName);
+        void generateDenseConnectivity(const SurfaceFile& sphere);
+        void generateVolume();
+        void generateAffine();
+        BenchmarkInputs(const BenchmarkInputs&);
+        BenchmarkInputs& operator=(const BenchmarkInputs&);
+    public:
+        BenchmarkInputs(const AString& directory, const BenchmarkSizes& sizes, const bool& removeOnDestruction);
+        ~BenchmarkInputs();
+        void generate();
+        void removeFiles();
+        const BenchmarkSizes& getSizes() const { return m_sizes; }
+        const AString& getDirectory() const { return m_directory; }
+        AString getFileName(const AString& name) const;//any file in the directory, for outputs
+        AString getSphereFileName() const { return getFileName("sphere.L.surf.gii"); }
+        AString getResampleSphereFileName() const { return getFileName("resample_sphere.L.surf.gii"); }
+        AString getMetricFileName() const { return getFileName("data.L.func.gii"); }
+        AString getDataSeriesFileName() const { return getFileName("data.dtseries.nii"); }
+        AString getDconnSphereFileName() const { return getFileName("dconn_sphere.L.surf.gii"); }
+        AString getDconnDataSeriesFileName() const { return getFileName("dconn_source.dtseries.nii"); }
+        AString getDconnFileName() const { return getFileName("data.dconn.nii"); }
+        AString getVolumeFileName() const { return getFileName("data.nii"); }
+        AString getAffineFileName() const { return getFileName("affine.txt"); }
+    };
+
+}
+
+#endif //__BENCHMARK_INPUTS_H__
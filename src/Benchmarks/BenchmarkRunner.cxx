@@ -0,0 +1,289 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2016  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "BenchmarkRunner.h"
+
+#include "ApplicationInformation.h"
+#include "BenchmarkInputs.h"
+#include "CaretException.h"
+#include "CaretOMP.h"
+#include "CommandOperationManager.h"
+#include "ElapsedTimer.h"
+#include "ProgramParameters.h"
+#include "SystemUtilities.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <new>
+
+using namespace caret;
+using namespace std;
+
+BenchmarkRunner::BenchmarkRunner(const BenchmarkInputs* inputs)
+{
+    m_inputs = inputs;
+    m_peakResidentPerRun = true;
+    buildCatalogue();
+}
+
+void BenchmarkRunner::buildCatalogue()
+{
+    m_cases.clear();
+    const BenchmarkSizes& sizes = m_inputs->getSizes();
+    const int64_t surfaceSeries = (int64_t)sizes.m_surfaceVertices * sizes.m_timePoints;
+    const int64_t surfaceMetric = (int64_t)sizes.m_surfaceVertices * sizes.m_metricColumns;
+    const int64_t dconnElements = (int64_t)sizes.m_dconnVertices * sizes.m_dconnVertices;
+    const int64_t volumeVoxels = (int64_t)sizes.m_volumeDimension * sizes.m_volumeDimension * sizes.m_volumeDimension * sizes.m_volumeFrames;
+    const AString mathExpression = "sin(x) * 2 + x * x - 1";
+    //the catalogue: hot paths that users run on large data, outputs are written to the same directory as the inputs
+    addCase("cifti-correlation", QStringList() << "-cifti-correlation" << m_inputs->getDconnDataSeriesFileName() << m_inputs->getFileName("out.dconn.nii"),
+            dconnElements, "elements");
+    addCase("cifti-reduce", QStringList() << "-cifti-reduce" << m_inputs->getDconnFileName() << "MEAN" << m_inputs->getFileName("out.dscalar.nii"),
+            dconnElements, "elements");
+    addCase("cifti-transpose", QStringList() << "-cifti-transpose" << m_inputs->getDataSeriesFileName() << m_inputs->getFileName("out_transpose.nii"),
+            surfaceSeries, "elements");
+    addCase("cifti-math", QStringList() << "-cifti-math" << mathExpression << m_inputs->getFileName("out_math.dtseries.nii")
+                                        << "-var" << "x" << m_inputs->getDataSeriesFileName(),
+            surfaceSeries, "elements");
+    addCase("cifti-smoothing", QStringList() << "-cifti-smoothing" << m_inputs->getDataSeriesFileName() << "4" << "4" << "COLUMN"
+                                             << m_inputs->getFileName("out_smooth.dtseries.nii") << "-left-surface" << m_inputs->getSphereFileName(),
+            surfaceSeries, "elements");
+    addCase("metric-smoothing", QStringList() << "-metric-smoothing" << m_inputs->getSphereFileName() << m_inputs->getMetricFileName() << "4"
+                                              << m_inputs->getFileName("out_smooth.func.gii"),
+            surfaceMetric, "elements");
+    addCase("metric-resample", QStringList() << "-metric-resample" << m_inputs->getMetricFileName() << m_inputs->getSphereFileName()
+                                             << m_inputs->getResampleSphereFileName() << "BARYCENTRIC" << m_inputs->getFileName("out_resample.func.gii"),
+            (int64_t)sizes.m_resampleVertices * sizes.m_metricColumns, "elements");
+    addCase("metric-tfce", QStringList() << "-metric-tfce" << m_inputs->getSphereFileName() << m_inputs->getMetricFileName()
+                                         << m_inputs->getFileName("out_tfce.func.gii"),
+            surfaceMetric, "elements");
+    addCase("volume-math", QStringList() << "-volume-math" << mathExpression << m_inputs->getFileName("out_math.nii") << "-var" << "x" << m_inputs->getVolumeFileName(),
+            volumeVoxels, "voxels");
+    //time to get one frame, the last one so that a compressed input must be read through
+    addCase("volume-single-frame", QStringList() << "-volume-math" << mathExpression << m_inputs->getFileName("out_frame.nii") << "-var" << "x" << m_inputs->getVolumeFileName()
+                                                 << "-subvolume" << AString::number(sizes.m_volumeFrames),
+            volumeVoxels / sizes.m_volumeFrames, "voxels");
+    addCase("volume-smoothing", QStringList() << "-volume-smoothing" << m_inputs->getVolumeFileName() << "4" << m_inputs->getFileName("out_smooth.nii"),
+            volumeVoxels, "voxels");
+    addCase("volume-affine-resample", QStringList() << "-volume-affine-resample" << m_inputs->getVolumeFileName() << m_inputs->getAffineFileName()
+                                                    << m_inputs->getVolumeFileName() << "CUBIC" << m_inputs->getFileName("out_resample.nii"),
+            volumeVoxels, "voxels");
+}
+
+void BenchmarkRunner::addCase(const AString& name, const QStringList& arguments, const int64_t& workCount, const AString& workUnit)
+{
+    BenchmarkCase myCase;
+    myCase.m_name = name;
+    for (int i = 0; i < arguments.size(); ++i)
+    {
+        myCase.m_arguments.push_back(arguments[i]);
+    }
+    myCase.m_workCount = workCount;
+    myCase.m_workUnit = workUnit;
+    m_cases.push_back(myCase);
+}
+
+vector<int32_t> BenchmarkRunner::getDefaultThreadCounts()
+{//1, 2, 4, ... up to and including the number of processors
+    vector<int32_t> ret;
+    const int32_t numProcessors = SystemUtilities::getNumberOfProcessors();
+    for (int32_t threads = 1; threads < numProcessors; threads *= 2)
+    {
+        ret.push_back(threads);
+    }
+    ret.push_back(numProcessors);
+    return ret;
+}
+
+void BenchmarkRunner::setNumberOfThreads(const int32_t& threads)
+{
+#ifdef CARET_OMP
+    omp_set_num_threads(threads);
+#else
+    (void)threads;
+#endif
+}
+
+void BenchmarkRunner::runCommand(const BenchmarkCase& myCase)
+{
+    ProgramParameters parameters;
+    parameters.addParameter("-disable-provenance");//don't benchmark the provenance metadata
+    for (int i = 0; i < (int)myCase.m_arguments.size(); ++i)
+    {
+        parameters.addParameter(myCase.m_arguments[i]);
+    }
+    CommandOperationManager::getCommandOperationManager()->runCommand(parameters);
+}
+
+void BenchmarkRunner::run(const vector<AString>& caseNames, const vector<int32_t>& threadCounts, const int32_t& repeats)
+{
+    buildCatalogue();//work counts should use the sizes that were actually generated
+    m_results.clear();
+    for (int whichCase = 0; whichCase < (int)m_cases.size(); ++whichCase)
+    {
+        const BenchmarkCase& myCase = m_cases[whichCase];
+        if (!caseNames.empty() && find(caseNames.begin(), caseNames.end(), myCase.m_name) == caseNames.end()) continue;
+        for (int whichThreads = 0; whichThreads < (int)threadCounts.size(); ++whichThreads)
+        {
+            BenchmarkResult myResult;
+            myResult.m_caseIndex = whichCase;
+            myResult.m_threads = threadCounts[whichThreads];
+            setNumberOfThreads(myResult.m_threads);
+            if (!SystemUtilities::resetPeakResidentMemory())
+            {
+                m_peakResidentPerRun = false;
+            }
+            cerr << "running " << myCase.m_name.toLocal8Bit().constData() << " with " << myResult.m_threads << " thread(s)" << endl;
+            try
+            {
+                for (int32_t repeat = 0; repeat < repeats; ++repeat)
+                {
+                    ElapsedTimer myTimer;
+                    myTimer.start();
+                    runCommand(myCase);
+                    myResult.m_seconds.push_back(myTimer.getElapsedTimeSeconds());
+                }
+            } catch (CaretException& e) {
+                myResult.m_error = e.whatString();
+            } catch (bad_alloc&) {
+                myResult.m_error = "out of memory";
+            }
+            if (!myResult.m_error.isEmpty())
+            {
+                cerr << "   failed: " << myResult.m_error.toLocal8Bit().constData() << endl;
+            }
+            myResult.m_peakResidentBytes = SystemUtilities::getPeakResidentMemoryInBytes();
+            m_results.push_back(myResult);
+        }
+    }
+    setNumberOfThreads(SystemUtilities::getNumberOfProcessors());
+    CommandOperationManager::deleteCommandOperationManager();
+}
+
+int32_t BenchmarkRunner::getNumberOfFailures() const
+{
+    int32_t ret = 0;
+    for (int i = 0; i < (int)m_results.size(); ++i)
+    {
+        if (!m_results[i].m_error.isEmpty()) ++ret;
+    }
+    return ret;
+}
+
+AString BenchmarkRunner::jsonString(const AString& input)
+{
+    AString ret = "\"";
+    for (int i = 0; i < input.size(); ++i)
+    {
+        const QChar c = input[i];
+        if (c == '"' || c == '\\')
+        {
+            ret += '\\';
+            ret += c;
+        } else if (c == '\n') {
+            ret += "\\n";
+        } else if (c.unicode() < 0x20) {
+            ret += "\\u" + AString::number(c.unicode(), 16).rightJustified(4, '0');
+        } else {
+            ret += c;
+        }
+    }
+    return ret + "\"";
+}
+
+AString BenchmarkRunner::jsonNumber(const double& input)
+{
+    if (input != input || fabs(input) > 1e300) return "null";//NaN and inf are not valid JSON
+    return AString::number(input, 'g', 9);
+}
+
+AString BenchmarkRunner::toJson() const
+{
+    const BenchmarkSizes& sizes = m_inputs->getSizes();
+    ApplicationInformation appInfo;
+    AString ret = "{\n";
+    ret += "  \"version\": " + jsonString(appInfo.getVersion()) + ",\n";
+    ret += "  \"date\": " + jsonString(SystemUtilities::getDateAndTime()) + ",\n";
+    ret += "  \"processors\": " + AString::number(SystemUtilities::getNumberOfProcessors()) + ",\n";
+    ret += "  \"peak_rss_per_run\": " + AString(m_peakResidentPerRun ? "true" : "false") + ",\n";
+    ret += "  \"inputs\": {\n";
+    ret += "    \"surface_vertices\": " + AString::number(sizes.m_surfaceVertices) + ",\n";
+    ret += "    \"resample_vertices\": " + AString::number(sizes.m_resampleVertices) + ",\n";
+    ret += "    \"metric_columns\": " + AString::number(sizes.m_metricColumns) + ",\n";
+    ret += "    \"time_points\": " + AString::number(sizes.m_timePoints) + ",\n";
+    ret += "    \"dconn_vertices\": " + AString::number(sizes.m_dconnVertices) + ",\n";
+    ret += "    \"volume_dimension\": " + AString::number(sizes.m_volumeDimension) + ",\n";
+    ret += "    \"volume_frames\": " + AString::number(sizes.m_volumeFrames) + "\n";
+    ret += "  },\n";
+    ret += "  \"results\": [";
+    for (int i = 0; i < (int)m_results.size(); ++i)
+    {
+        const BenchmarkResult& myResult = m_results[i];
+        const BenchmarkCase& myCase = m_cases[myResult.m_caseIndex];
+        vector<double> sorted = myResult.m_seconds;
+        sort(sorted.begin(), sorted.end());
+        if (i != 0) ret += ",";
+        ret += "\n    {\n";
+        ret += "      \"name\": " + jsonString(myCase.m_name) + ",\n";
+        AString command = "wb_command";
+        for (int j = 0; j < (int)myCase.m_arguments.size(); ++j)
+        {
+            command += " " + myCase.m_arguments[j];
+        }
+        ret += "      \"command\": " + jsonString(command) + ",\n";
+        ret += "      \"threads\": " + AString::number(myResult.m_threads) + ",\n";
+        ret += "      \"work_count\": " + AString::number(myCase.m_workCount) + ",\n";
+        ret += "      \"work_unit\": " + jsonString(myCase.m_workUnit) + ",\n";
+        if (!myResult.m_error.isEmpty())
+        {
+            ret += "      \"error\": " + jsonString(myResult.m_error) + ",\n";
+        }
+        ret += "      \"wall_seconds\": [";
+        for (int j = 0; j < (int)myResult.m_seconds.size(); ++j)
+        {
+            if (j != 0) ret += ", ";
+            ret += jsonNumber(myResult.m_seconds[j]);
+        }
+        ret += "],\n";
+        if (!sorted.empty())
+        {
+            const double best = sorted[0];
+            const double median = sorted[sorted.size() / 2];
+            ret += "      \"wall_seconds_min\": " + jsonNumber(best) + ",\n";
+            ret += "      \"wall_seconds_median\": " + jsonNumber(median) + ",\n";
+            ret += "      \"throughput_per_second\": " + jsonNumber(best > 0.0 ? myCase.m_workCount / best : -1.0) + ",\n";
+            for (int j = 0; j < (int)m_results.size(); ++j)
+            {//thread scaling relative to the single thread run of the same case
+                const BenchmarkResult& other = m_results[j];
+                if (other.m_caseIndex == myResult.m_caseIndex && other.m_threads == 1 && other.m_error.isEmpty() && !other.m_seconds.empty() && best > 0.0)
+                {
+                    const double otherBest = *min_element(other.m_seconds.begin(), other.m_seconds.end());
+                    ret += "      \"speedup_vs_1_thread\": " + jsonNumber(otherBest / best) + ",\n";
+                    break;
+                }
+            }
+        }
+        ret += "      \"peak_rss_bytes\": " + AString::number(myResult.m_peakResidentBytes) + "\n";
+        ret += "    }";
+    }
+    ret += "\n  ]\n}\n";
+    return ret;
+}
@@ -0,0 +1,81 @@
+#ifndef __BENCHMARK_RUNNER_H__
+#define __BENCHMARK_RUNNER_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2016  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "AString.h"
+
+#include <QStringList>
+
+#include <stdint.h>
+#include <vector>
+
+namespace caret {
+
+    class BenchmarkInputs;
+
+    ///one wb_command invocation in the catalogue
+    struct BenchmarkCase
+    {
+        AString m_name;
+        std::vector<AString> m_arguments;//command switch and its arguments, as they would be given to wb_command
+        int64_t m_workCount;//number of elements processed, for throughput
+        AString m_workUnit;
+    };
+
+    ///timings of one case at one thread count
+    struct BenchmarkResult
+    {
+        int32_t m_caseIndex;
+        int32_t m_threads;
+        std::vector<double> m_seconds;//wall time of each repeat
+        int64_t m_peakResidentBytes;//negative if not available
+        AString m_error;//empty on success
+        BenchmarkResult() { m_caseIndex = -1; m_threads = 1; m_peakResidentBytes = -1; }
+    };
+
+    ///runs the benchmark catalogue through the wb_command command manager, in this process
+    class BenchmarkRunner
+    {
+        const BenchmarkInputs* m_inputs;
+        std::vector<BenchmarkCase> m_cases;
+        std::vector<BenchmarkResult> m_results;
+        bool m_peakResidentPerRun;//false when the peak resident memory can't be reset, and is therefore the peak of the whole process so far
+        void buildCatalogue();
+        void addCase(const AString& name, const QStringList& arguments, const int64_t& workCount, const AString& workUnit);
+        void runCommand(const BenchmarkCase& myCase);
+        static void setNumberOfThreads(const int32_t& threads);
+        static AString jsonString(const AString& input);
+        static AString jsonNumber(const double& input);
+        BenchmarkRunner(const BenchmarkRunner&);
+        BenchmarkRunner& operator=(const BenchmarkRunner&);
+    public:
+        BenchmarkRunner(const BenchmarkInputs* inputs);
+        const std::vector<BenchmarkCase>& getCases() const { return m_cases; }
+        void run(const std::vector<AString>& caseNames, const std::vector<int32_t>& threadCounts, const int32_t& repeats);
+        int32_t getNumberOfFailures() const;
+        AString toJson() const;
+        static std::vector<int32_t> getDefaultThreadCounts();
+    };
+
+}
+
+#endif //__BENCHMARK_RUNNER_H__
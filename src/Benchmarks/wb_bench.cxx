@@ -0,0 +1,202 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2016  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+//program for benchmarking wb_command operations on synthetic data
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "AString.h"
+#include "BenchmarkInputs.h"
+#include "BenchmarkRunner.h"
+#include "CaretCommandLine.h"
+#include "CaretException.h"
+#include "CaretHttpManager.h"
+#include "SessionManager.h"
+#include "SystemUtilities.h"
+#include "VolumeFile.h"
+
+using namespace std;
+using namespace caret;
+
+namespace
+{
+    void printUsage(const vector<BenchmarkCase>& cases)
+    {
+        BenchmarkSizes defaults;
+        cout << "usage: wb_bench [options]" << endl << endl
+             << "Generates synthetic inputs in a temporary directory, runs a catalogue of wb_command operations on them," << endl
+             << "and reports wall time, throughput, peak resident memory and thread scaling as JSON." << endl << endl
+             << "options:" << endl
+             << "   -surface-vertices <n>    vertices in the sphere, metric and dtseries (default " << defaults.m_surfaceVertices
+             << ", use 163842 for 164k)" << endl
+             << "   -resample-vertices <n>   vertices in the sphere that metrics are resampled to (default " << defaults.m_resampleVertices << ")" << endl
+             << "   -metric-columns <n>      columns in the metric (default " << defaults.m_metricColumns << ")" << endl
+             << "   -time-points <n>         columns in the dtseries files (default " << defaults.m_timePoints << ")" << endl
+             << "   -dconn-vertices <n>      vertices in the dconn and its source dtseries (default " << defaults.m_dconnVertices << ")" << endl
+             << "   -volume-dim <n>          size of the cubic volume (default " << defaults.m_volumeDimension << ")" << endl
+             << "   -volume-frames <n>       frames in the volume (default " << defaults.m_volumeFrames << ")" << endl
+             << "   -threads <n>             thread count to run with, repeatable (default 1, 2, 4, ... up to the number of processors)" << endl
+             << "   -repeat <n>              times to run each operation at each thread count (default 3)" << endl
+             << "   -only <name>             run only the named operation, repeatable" << endl
+             << "   -dir <directory>         where to generate inputs and outputs (default: a new directory in the system temp directory)" << endl
+             << "   -keep                    do not remove the generated files" << endl
+             << "   -eager-volumes           read all frames of volume inputs when they are opened, rather than when they are used" << endl
+             << "   -output <file>           write the JSON to a file instead of standard output" << endl << endl
+             << "operations:" << endl;
+        for (int i = 0; i < (int)cases.size(); ++i)
+        {
+            cout << "   " << cases[i].m_name.toLocal8Bit().constData() << endl;
+        }
+    }
+
+    int32_t nextInteger(const int& argc, char** argv, int& index)
+    {
+        if (index + 1 >= argc) throw CaretException(AString("missing value for ") + argv[index]);
+        ++index;
+        bool ok = false;
+        const int32_t ret = AString(argv[index]).toInt(&ok);
+        if (!ok || ret < 1) throw CaretException(AString("invalid value for ") + argv[index - 1] + ": " + argv[index]);
+        return ret;
+    }
+
+    AString nextString(const int& argc, char** argv, int& index)
+    {
+        if (index + 1 >= argc) throw CaretException(AString("missing value for ") + argv[index]);
+        ++index;
+        return AString::fromLocal8Bit(argv[index]);
+    }
+
+    int runBenchmarks(int argc, char** argv)
+    {
+        BenchmarkSizes sizes;
+        vector<int32_t> threadCounts;
+        vector<AString> caseNames;
+        int32_t repeats = 3;
+        AString directory, outputName;
+        bool keep = false, help = false;
+        for (int i = 1; i < argc; ++i)
+        {
+            const AString option = argv[i];
+            if (option == "-surface-vertices")
+            {
+                sizes.m_surfaceVertices = nextInteger(argc, argv, i);
+            } else if (option == "-resample-vertices") {
+                sizes.m_resampleVertices = nextInteger(argc, argv, i);
+            } else if (option == "-metric-columns") {
+                sizes.m_metricColumns = nextInteger(argc, argv, i);
+            } else if (option == "-time-points") {
+                sizes.m_timePoints = nextInteger(argc, argv, i);
+            } else if (option == "-dconn-vertices") {
+                sizes.m_dconnVertices = nextInteger(argc, argv, i);
+            } else if (option == "-volume-dim") {
+                sizes.m_volumeDimension = nextInteger(argc, argv, i);
+            } else if (option == "-volume-frames") {
+                sizes.m_volumeFrames = nextInteger(argc, argv, i);
+            } else if (option == "-threads") {
+                threadCounts.push_back(nextInteger(argc, argv, i));
+            } else if (option == "-repeat") {
+                repeats = nextInteger(argc, argv, i);
+            } else if (option == "-only") {
+                caseNames.push_back(nextString(argc, argv, i));
+            } else if (option == "-dir") {
+                directory = nextString(argc, argv, i);
+            } else if (option == "-output") {
+                outputName = nextString(argc, argv, i);
+            } else if (option == "-keep") {
+                keep = true;
+            } else if (option == "-eager-volumes") {
+                VolumeFile::setLoadFramesOnDemand(false);
+            } else if (option == "-help" || option == "--help") {
+                help = true;
+            } else {
+                throw CaretException("unrecognized option: " + option);
+            }
+        }
+        if (directory.isEmpty())
+        {
+            directory = QDir::tempPath() + "/wb_bench_" + SystemUtilities::createUniqueID();
+            directory.remove('{').remove('}');
+        }
+        BenchmarkInputs myInputs(directory, sizes, !keep);
+        BenchmarkRunner myRunner(&myInputs);
+        if (help)
+        {
+            printUsage(myRunner.getCases());
+            return 0;
+        }
+        for (int i = 0; i < (int)caseNames.size(); ++i)
+        {
+            bool found = false;
+            for (int j = 0; j < (int)myRunner.getCases().size(); ++j)
+            {
+                if (myRunner.getCases()[j].m_name == caseNames[i]) found = true;
+            }
+            if (!found) throw CaretException("unknown operation: " + caseNames[i]);
+        }
+        if (threadCounts.empty())
+        {
+            threadCounts = BenchmarkRunner::getDefaultThreadCounts();
+        }
+        myInputs.generate();
+        myRunner.run(caseNames, threadCounts, repeats);
+        const AString json = myRunner.toJson();
+        if (outputName.isEmpty())
+        {
+            cout << json.toLocal8Bit().constData();
+        } else {
+            QFile outFile(outputName);
+            if (!outFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            {
+                throw CaretException("unable to open '" + outputName + "' for writing");
+            }
+            outFile.write(json.toUtf8());
+        }
+        return (myRunner.getNumberOfFailures() == 0) ? 0 : 1;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int result = 0;
+    {
+        SessionManager::createSessionManager(ApplicationTypeEnum::APPLICATION_TYPE_COMMAND_LINE);
+        VolumeFile::setVoxelColoringEnabled(false);//as in wb_command
+        VolumeFile::setLoadFramesOnDemand(true);
+        QCoreApplication myApp(argc, argv);
+        caret_global_commandLine_init(argc, argv);
+        try
+        {
+            result = runBenchmarks(argc, argv);
+        } catch (CaretException& e) {
+            cerr << "ERROR: " << e.whatString().toLocal8Bit().constData() << endl;
+            result = 1;
+        }
+        SessionManager::deleteSessionManager();
+        CaretHttpManager::deleteHttpManager();
+        myApp.processEvents();
+    }
+    return result;
+}
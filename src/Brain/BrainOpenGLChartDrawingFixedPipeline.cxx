@@ -37,12 +37,12 @@
 #include "ChartDataCartesian.h"
 #include "CaretLogger.h"
 #include "ChartMatrixDisplayProperties.h"
+#include "ChartMatrixImagePyramid.h"
 #include "ChartModelDataSeries.h"
 #include "ChartModelFrequencySeries.h"
 #include "ChartModelTimeSeries.h"
 #include "ChartableMatrixInterface.h"
 #include "CaretPreferences.h"
-#include "ChartPoint.h"
 #include "CiftiMappableConnectivityMatrixDataFile.h"
 #include "CiftiParcelLabelFile.h"
 #include "CiftiParcelScalarFile.h"
@@ -245,7 +245,8 @@ BrainOpenGLChartDrawingFixedPipeline::drawCartesianChart(Brain* brain,
                chartGraphicsDrawingViewport[2],
                chartGraphicsDrawingViewport[3]);
 
-    drawChartGraphicsLineSeries(textRenderer,
+    drawChartGraphicsLineSeries(chartGraphicsDrawingViewport,
+                                textRenderer,
                                 cartesianChart);
 
     /*
@@ -801,13 +802,16 @@ BrainOpenGLChartDrawingFixedPipeline::drawChartGraphicsBoxAndSetViewport(const f
 /**
  * Draw graphics for the given line series chart.
  *
+ * @param viewport
+ *     The viewport.
  * @param textRenderer
  *     Text rendering.
  * @param chart
  *     Chart that is drawn.
  */
 void
-BrainOpenGLChartDrawingFixedPipeline::drawChartGraphicsLineSeries(BrainOpenGLTextRenderInterface* /*textRenderer*/,
+BrainOpenGLChartDrawingFixedPipeline::drawChartGraphicsLineSeries(const int32_t viewport[4],
+                                                                  BrainOpenGLTextRenderInterface* /*textRenderer*/,
                                                                   ChartModelCartesian* chart)
 {
     CaretAssert(chart);
@@ -855,7 +859,10 @@ BrainOpenGLChartDrawingFixedPipeline::drawChartGraphicsLineSeries(BrainOpenGLTex
             drawChartDataCartesian(chartDataIndex,
                                    chartDataCart,
                                    lineWidth,
-                                   CaretColorEnum::toRGB(color));
+                                   CaretColorEnum::toRGB(color),
+                                   xMin,
+                                   xMax,
+                                   viewport[2]);
         }
     }
     
@@ -867,7 +874,10 @@ BrainOpenGLChartDrawingFixedPipeline::drawChartGraphicsLineSeries(BrainOpenGLTex
             drawChartDataCartesian(-1,
                                    chartDataCart,
                                    lineWidth,
-                                   m_fixedPipelineDrawing->m_foregroundColorFloat);
+                                   m_fixedPipelineDrawing->m_foregroundColorFloat,
+                                   xMin,
+                                   xMax,
+                                   viewport[2]);
         }
     }
     
@@ -885,12 +895,21 @@ BrainOpenGLChartDrawingFixedPipeline::drawChartGraphicsLineSeries(BrainOpenGLTex
  *   Width of lines.
  * @param color
  *   Color for the data.
+ * @param xMinimum
+ *   X-coordinate at left side of viewport.
+ * @param xMaximum
+ *   X-coordinate at right side of viewport.
+ * @param viewportWidth
+ *   Width of viewport in pixels.
  */
 void
 BrainOpenGLChartDrawingFixedPipeline::drawChartDataCartesian(const int32_t chartDataIndex,
                                                              const ChartDataCartesian* chartDataCartesian,
                                                              const float lineWidth,
-                                                             const float rgb[3])
+                                                             const float rgb[3],
+                                                             const float xMinimum,
+                                                             const float xMaximum,
+                                                             const int32_t viewportWidth)
 {
     if (lineWidth <= 0.0) {
         return;
@@ -900,20 +919,45 @@ BrainOpenGLChartDrawingFixedPipeline::drawChartDataCartesian(const int32_t chart
     
     glLineWidth(lineWidth);
     if (m_identificationModeFlag) {
+        /*
+         * Every point is needed for identification
+         */
         glLineWidth(5.0);
-    }
-    glBegin(GL_LINE_STRIP);
-    const int32_t numPoints = chartDataCartesian->getNumberOfPoints();
-    for (int32_t i = 0; i < numPoints; i++) {
-        const ChartPoint* point = chartDataCartesian->getPointAtIndex(i);
-        if (m_identificationModeFlag) {
+        glBegin(GL_LINE_STRIP);
+        const int32_t numPoints = chartDataCartesian->getNumberOfPoints();
+        for (int32_t i = 0; i < numPoints; i++) {
             uint8_t rgbaForID[4];
             addToChartLineIdentification(chartDataIndex, i, rgbaForID);
             glColor4ubv(rgbaForID);
+            glVertex2f(chartDataCartesian->getPointX(i),
+                       chartDataCartesian->getPointY(i));
         }
-        glVertex2fv(point->getXY());
+        glEnd();
+        return;
     }
-    glEnd();
+    
+    /*
+     * When there are many more points than pixels, only the points
+     * with the minimum and maximum values in each pixel are drawn.
+     */
+    std::vector<float> pointsXY;
+    chartDataCartesian->getDecimatedPointsXY(xMinimum,
+                                             xMaximum,
+                                             viewportWidth,
+                                             pointsXY);
+    if (pointsXY.empty()) {
+        return;
+    }
+    
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2,
+                    GL_FLOAT,
+                    0,
+                    &pointsXY[0]);
+    glDrawArrays(GL_LINE_STRIP,
+                 0,
+                 static_cast<GLsizei>(pointsXY.size() / 2));
+    glDisableClientState(GL_VERTEX_ARRAY);
 }
 
 /**
@@ -945,12 +989,18 @@ BrainOpenGLChartDrawingFixedPipeline::drawChartGraphicsMatrix(const int32_t view
         highlightRGBByte[2] / 255.0
     };
     
-    int32_t numberOfRows = 0;
-    int32_t numberOfColumns = 0;
-    std::vector<float> matrixRGBA;
-    if (chartMatrixInterface->getMatrixDataRGBA(numberOfRows,
-                                       numberOfColumns,
-                                       matrixRGBA)) {
+    /*
+     * The image of the matrix is kept by the file until its
+     * data or coloring changes.
+     */
+    CiftiMappableDataFile* matrixMapFile = chartMatrixInterface->getMatrixChartCiftiMappableDataFile();
+    ChartMatrixImagePyramid* matrixImagePyramid = ((matrixMapFile != NULL)
+                                                   ? matrixMapFile->getMatrixChartImagePyramid()
+                                                   : NULL);
+    if (matrixImagePyramid != NULL) {
+        const int32_t numberOfRows    = matrixImagePyramid->getLevelNumberOfRows(0);
+        const int32_t numberOfColumns = matrixImagePyramid->getLevelNumberOfColumns(0);
+        
         std::set<int32_t> selectedColumnIndices;
         std::set<int32_t> selectedRowIndices;
         
@@ -1085,114 +1135,50 @@ BrainOpenGLChartDrawingFixedPipeline::drawChartGraphicsMatrix(const int32_t view
                          0.0);
         }
         
-        int32_t rgbaOffset = 0;
-        std::vector<float> quadVerticesXYZ;
-        quadVerticesXYZ.reserve(numberOfRows * numberOfColumns * 3);
-        std::vector<float> quadVerticesFloatRGBA;
-        quadVerticesFloatRGBA.reserve(numberOfRows * numberOfColumns * 4);
-        std::vector<uint8_t> quadVerticesByteRGBA;
-        quadVerticesByteRGBA.reserve(numberOfRows * numberOfColumns * 4);
-        
-        float cellY = (numberOfRows - 1) * cellHeight;
-        for (int32_t rowIndex = 0; rowIndex < numberOfRows; rowIndex++) {
-            float cellX = 0;
-            for (int32_t columnIndex = 0; columnIndex < numberOfColumns; columnIndex++) {
-                CaretAssertVectorIndex(matrixRGBA, rgbaOffset+3);
-                const float* rgba = &matrixRGBA[rgbaOffset];
-                rgbaOffset += 4;
-                
-                uint8_t idRGBA[4];
-                if (m_identificationModeFlag) {
-                    addToChartMatrixIdentification(rowIndex,
-                                                   columnIndex,
-                                                   idRGBA);
-                }
-                
-                if (m_identificationModeFlag) {
-                    quadVerticesByteRGBA.push_back(idRGBA[0]);
-                    quadVerticesByteRGBA.push_back(idRGBA[1]);
-                    quadVerticesByteRGBA.push_back(idRGBA[2]);
-                    quadVerticesByteRGBA.push_back(idRGBA[3]);
-                }
-                else {
-                    quadVerticesFloatRGBA.push_back(rgba[0]);
-                    quadVerticesFloatRGBA.push_back(rgba[1]);
-                    quadVerticesFloatRGBA.push_back(rgba[2]);
-                    quadVerticesFloatRGBA.push_back(rgba[3]);
-                }
-                quadVerticesXYZ.push_back(cellX);
-                quadVerticesXYZ.push_back(cellY);
-                quadVerticesXYZ.push_back(0.0);
-                
-                if (m_identificationModeFlag) {
-                    quadVerticesByteRGBA.push_back(idRGBA[0]);
-                    quadVerticesByteRGBA.push_back(idRGBA[1]);
-                    quadVerticesByteRGBA.push_back(idRGBA[2]);
-                    quadVerticesByteRGBA.push_back(idRGBA[3]);
-                }
-                else {
-                    quadVerticesFloatRGBA.push_back(rgba[0]);
-                    quadVerticesFloatRGBA.push_back(rgba[1]);
-                    quadVerticesFloatRGBA.push_back(rgba[2]);
-                    quadVerticesFloatRGBA.push_back(rgba[3]);
-                }
-                quadVerticesXYZ.push_back(cellX + cellWidth);
-                quadVerticesXYZ.push_back(cellY);
-                quadVerticesXYZ.push_back(0.0);
-                
-                if (m_identificationModeFlag) {
-                    quadVerticesByteRGBA.push_back(idRGBA[0]);
-                    quadVerticesByteRGBA.push_back(idRGBA[1]);
-                    quadVerticesByteRGBA.push_back(idRGBA[2]);
-                    quadVerticesByteRGBA.push_back(idRGBA[3]);
-                }
-                else {
-                    quadVerticesFloatRGBA.push_back(rgba[0]);
-                    quadVerticesFloatRGBA.push_back(rgba[1]);
-                    quadVerticesFloatRGBA.push_back(rgba[2]);
-                    quadVerticesFloatRGBA.push_back(rgba[3]);
-                }
-                quadVerticesXYZ.push_back(cellX + cellWidth);
-                quadVerticesXYZ.push_back(cellY + cellHeight);
-                quadVerticesXYZ.push_back(0.0);
-                
-                if (m_identificationModeFlag) {
-                    quadVerticesByteRGBA.push_back(idRGBA[0]);
-                    quadVerticesByteRGBA.push_back(idRGBA[1]);
-                    quadVerticesByteRGBA.push_back(idRGBA[2]);
-                    quadVerticesByteRGBA.push_back(idRGBA[3]);
-                }
-                else {
-                    quadVerticesFloatRGBA.push_back(rgba[0]);
-                    quadVerticesFloatRGBA.push_back(rgba[1]);
-                    quadVerticesFloatRGBA.push_back(rgba[2]);
-                    quadVerticesFloatRGBA.push_back(rgba[3]);
-                }
-                quadVerticesXYZ.push_back(cellX);
-                quadVerticesXYZ.push_back(cellY + cellHeight);
-                quadVerticesXYZ.push_back(0.0);
-                
-                
-                cellX += cellWidth;
+        if (m_identificationModeFlag) {
+            /*
+             * Only the cell under the mouse can be identified so find
+             * its row and column from the mouse position and draw the
+             * whole matrix as one quad with that cell's identification
+             * color.  Mouse is converted to matrix coordinates by
+             * reversing the projection and the panning and zooming.
+             */
+            float mouseMatrixX = xMin + (((m_fixedPipelineDrawing->mouseX - viewport[0]) + 0.5)
+                                         / viewport[2]) * (xMax - xMin);
+            float mouseMatrixY = yMin + (((m_fixedPipelineDrawing->mouseY - viewport[1]) + 0.5)
+                                         / viewport[3]) * (yMax - yMin);
+            if (applyTransformationsFlag
+                && (zooming > 0.0)) {
+                const float halfWidth   = (cellWidth  * numberOfColumns) / 2.0;
+                const float halfHeight  = (cellHeight * numberOfRows) / 2.0;
+                mouseMatrixX = ((mouseMatrixX - panningXY[0] - halfWidth) / zooming) + halfWidth;
+                mouseMatrixY = ((mouseMatrixY - panningXY[1] - halfHeight) / zooming) + halfHeight;
             }
             
-            cellY -= cellHeight;
-        }
-        
-        /*
-         * Draw the matrix elements.
-         */
-        if (m_identificationModeFlag) {
-            CaretAssert((quadVerticesXYZ.size() / 3) == (quadVerticesByteRGBA.size() / 4));
-            const int32_t numberQuadVertices = static_cast<int32_t>(quadVerticesXYZ.size() / 3);
-            glBegin(GL_QUADS);
-            for (int32_t i = 0; i < numberQuadVertices; i++) {
-                CaretAssertVectorIndex(quadVerticesByteRGBA, i*4 + 3);
-                glColor4ubv(&quadVerticesByteRGBA[i*4]);
-                CaretAssertVectorIndex(quadVerticesXYZ, i*3 + 2);
-                glVertex3fv(&quadVerticesXYZ[i*3]);
+            if ((cellWidth > 0.0)
+                && (cellHeight > 0.0)) {
+                const int64_t columnIndex = static_cast<int64_t>(std::floor(mouseMatrixX / cellWidth));
+                const int64_t rowIndex = (numberOfRows - 1) - static_cast<int64_t>(std::floor(mouseMatrixY / cellHeight));
+                if ((columnIndex >= 0)
+                    && (columnIndex < numberOfColumns)
+                    && (rowIndex >= 0)
+                    && (rowIndex < numberOfRows)) {
+                    uint8_t idRGBA[4];
+                    addToChartMatrixIdentification(static_cast<int32_t>(rowIndex),
+                                                   static_cast<int32_t>(columnIndex),
+                                                   idRGBA);
+                    
+                    const float matrixWidth  = numberOfColumns * cellWidth;
+                    const float matrixHeight = numberOfRows * cellHeight;
+                    glColor4ubv(idRGBA);
+                    glBegin(GL_QUADS);
+                    glVertex3f(0.0,         0.0,          0.0);
+                    glVertex3f(matrixWidth, 0.0,          0.0);
+                    glVertex3f(matrixWidth, matrixHeight, 0.0);
+                    glVertex3f(0.0,         matrixHeight, 0.0);
+                    glEnd();
+                }
             }
-            glEnd();
         }
         else {
             /*
@@ -1202,16 +1188,27 @@ BrainOpenGLChartDrawingFixedPipeline::drawChartGraphicsMatrix(const int32_t view
             glEnable(GL_BLEND);
             glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
             
-            CaretAssert((quadVerticesXYZ.size() / 3) == (quadVerticesFloatRGBA.size() / 4));
-            const int32_t numberQuadVertices = static_cast<int32_t>(quadVerticesXYZ.size() / 3);
-            glBegin(GL_QUADS);
-            for (int32_t i = 0; i < numberQuadVertices; i++) {
-                CaretAssertVectorIndex(quadVerticesFloatRGBA, i*4 + 3);
-                glColor4fv(&quadVerticesFloatRGBA[i*4]);
-                CaretAssertVectorIndex(quadVerticesXYZ, i*3 + 2);
-                glVertex3fv(&quadVerticesXYZ[i*3]);
+            /*
+             * Region of the matrix (in untransformed coordinates)
+             * that is within the viewport.
+             */
+            float visibleRegion[4] = { xMin, xMax, yMin, yMax };
+            if (applyTransformationsFlag
+                && (zooming > 0.0)) {
+                const float halfWidth   = (cellWidth  * numberOfColumns) / 2.0;
+                const float halfHeight  = (cellHeight * numberOfRows) / 2.0;
+                visibleRegion[0] = ((xMin - panningXY[0] - halfWidth) / zooming) + halfWidth;
+                visibleRegion[1] = ((xMax - panningXY[0] - halfWidth) / zooming) + halfWidth;
+                visibleRegion[2] = ((yMin - panningXY[1] - halfHeight) / zooming) + halfHeight;
+                visibleRegion[3] = ((yMax - panningXY[1] - halfHeight) / zooming) + halfHeight;
             }
-            glEnd();
+            
+            drawMatrixImagePyramid(*matrixImagePyramid,
+                                   cellWidth,
+                                   cellHeight,
+                                   cellWidth * zooming,
+                                   cellHeight * zooming,
+                                   visibleRegion);
             
             glDisable(GL_BLEND);
 
@@ -1222,27 +1219,21 @@ BrainOpenGLChartDrawingFixedPipeline::drawChartGraphicsMatrix(const int32_t view
             if (displayGridLinesFlag) {
                 uint8_t gridLineColorBytes[3];
                 prefs->getBackgroundAndForegroundColors()->getColorChartMatrixGridLines(gridLineColorBytes);
-                float gridLineColorFloats[4];
-                CaretPreferences::byteRgbToFloatRgb(gridLineColorBytes,
-                                                    gridLineColorFloats);
-                gridLineColorFloats[3] = 1.0;
-                std::vector<float> outlineRGBA;
-                outlineRGBA.reserve(numberQuadVertices * 4);
-                for (int32_t i = 0; i < numberQuadVertices; i++) {
-                    outlineRGBA.push_back(gridLineColorFloats[0]);
-                    outlineRGBA.push_back(gridLineColorFloats[1]);
-                    outlineRGBA.push_back(gridLineColorFloats[2]);
-                    outlineRGBA.push_back(gridLineColorFloats[3]);
-                }
                 
-                glPolygonMode(GL_FRONT, GL_LINE);
+                const float matrixWidth  = numberOfColumns * cellWidth;
+                const float matrixHeight = numberOfRows * cellHeight;
                 glLineWidth(1.0);
-                glBegin(GL_QUADS);
-                for (int32_t i = 0; i < numberQuadVertices; i++) {
-                    CaretAssertVectorIndex(outlineRGBA, i*4 + 3);
-                    glColor4fv(&outlineRGBA[i*4]);
-                    CaretAssertVectorIndex(quadVerticesXYZ, i*3 + 2);
-                    glVertex3fv(&quadVerticesXYZ[i*3]);
+                glColor3ubv(gridLineColorBytes);
+                glBegin(GL_LINES);
+                for (int32_t columnIndex = 0; columnIndex <= numberOfColumns; columnIndex++) {
+                    const float x = columnIndex * cellWidth;
+                    glVertex3f(x, 0.0, 0.0);
+                    glVertex3f(x, matrixHeight, 0.0);
+                }
+                for (int32_t rowIndex = 0; rowIndex <= numberOfRows; rowIndex++) {
+                    const float y = rowIndex * cellHeight;
+                    glVertex3f(0.0, y, 0.0);
+                    glVertex3f(matrixWidth, y, 0.0);
                 }
                 glEnd();
             }
@@ -1399,6 +1390,174 @@ BrainOpenGLChartDrawingFixedPipeline::drawChartGraphicsMatrix(const int32_t view
     }
 }
 
+/**
+ * Draw the matrix cells using textures containing the level of the
+ * image pyramid in which cells are about the size of a pixel.  Only
+ * the part of the level that is visible is loaded into textures.
+ *
+ * @param matrixImagePyramid
+ *     Image pyramid of the matrix, levels are built as needed.
+ * @param cellWidth
+ *     Width of a matrix cell.
+ * @param cellHeight
+ *     Height of a matrix cell.
+ * @param cellWidthPixels
+ *     Width of a matrix cell in pixels (includes zooming).
+ * @param cellHeightPixels
+ *     Height of a matrix cell in pixels (includes zooming).
+ * @param visibleRegion
+ *     Region, in the same coordinates as the cells, that is within
+ *     the viewport (minimum X, maximum X, minimum Y, maximum Y).
+ */
+void
+BrainOpenGLChartDrawingFixedPipeline::drawMatrixImagePyramid(ChartMatrixImagePyramid& matrixImagePyramid,
+                                                             const float cellWidth,
+                                                             const float cellHeight,
+                                                             const float cellWidthPixels,
+                                                             const float cellHeightPixels,
+                                                             const float visibleRegion[4])
+{
+    const int32_t numberOfRows    = matrixImagePyramid.getLevelNumberOfRows(0);
+    const int32_t numberOfColumns = matrixImagePyramid.getLevelNumberOfColumns(0);
+    if ((numberOfRows <= 0)
+        || (numberOfColumns <= 0)
+        || (cellWidth <= 0.0)
+        || (cellHeight <= 0.0)) {
+        return;
+    }
+    
+    /*
+     * Is matrix outside of the viewport?
+     */
+    if ((visibleRegion[1] < 0.0)
+        || (visibleRegion[0] > (numberOfColumns * cellWidth))
+        || (visibleRegion[3] < 0.0)
+        || (visibleRegion[2] > (numberOfRows * cellHeight))) {
+        return;
+    }
+    
+    int32_t level = ChartMatrixImagePyramid::getLevelForCellSize(cellWidthPixels,
+                                                                 cellHeightPixels);
+    matrixImagePyramid.buildLevels(level);
+    level = std::min(level,
+                     matrixImagePyramid.getNumberOfLevels() - 1);
+    const int64_t cellsPerTexel = static_cast<int64_t>(1) << level;
+    
+    /*
+     * Visible cells.  First row of matrix is at the top.
+     */
+    const int32_t firstColumn = static_cast<int32_t>(std::max(std::floor(visibleRegion[0] / cellWidth), 0.0f));
+    const int32_t lastColumn  = static_cast<int32_t>(std::min(std::floor(visibleRegion[1] / cellWidth),
+                                                              static_cast<float>(numberOfColumns - 1)));
+    const int32_t firstRow = numberOfRows - 1 - static_cast<int32_t>(std::min(std::floor(visibleRegion[3] / cellHeight),
+                                                                              static_cast<float>(numberOfRows - 1)));
+    const int32_t lastRow  = numberOfRows - 1 - static_cast<int32_t>(std::max(std::floor(visibleRegion[2] / cellHeight), 0.0f));
+    
+    /*
+     * Visible texels in the level
+     */
+    const int32_t firstTexelColumn = static_cast<int32_t>(firstColumn / cellsPerTexel);
+    const int32_t lastTexelColumn  = static_cast<int32_t>(lastColumn  / cellsPerTexel);
+    const int32_t firstTexelRow    = static_cast<int32_t>(firstRow / cellsPerTexel);
+    const int32_t lastTexelRow     = static_cast<int32_t>(lastRow  / cellsPerTexel);
+    
+    GLint maximumTextureSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE,
+                  &maximumTextureSize);
+    const int32_t tileSize = std::max(64,
+                                      std::min(1024,
+                                               static_cast<int32_t>(maximumTextureSize)));
+    
+    /*
+     * Saves glPixelStore parameters
+     */
+    glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    
+    GLuint textureName = 0;
+    glGenTextures(1, &textureName);
+    glBindTexture(GL_TEXTURE_2D, textureName);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D,     // MUST BE GL_TEXTURE_2D
+                 0,                 // level of detail 0=base, n is nth mipmap reduction
+                 GL_RGBA,           // number of components
+                 tileSize,          // width of texture
+                 tileSize,          // height of texture
+                 0,                 // border
+                 GL_RGBA,           // format of the pixel data
+                 GL_UNSIGNED_BYTE,  // data type of pixel data
+                 NULL);             // tiles are loaded with glTexSubImage2D
+    
+    glEnable(GL_TEXTURE_2D);
+    glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+    
+    std::vector<uint8_t> tileRGBA;
+    for (int32_t tileRow = firstTexelRow; tileRow <= lastTexelRow; tileRow += tileSize) {
+        const int32_t tileNumberOfRows = std::min(tileSize,
+                                                  lastTexelRow - tileRow + 1);
+        for (int32_t tileColumn = firstTexelColumn; tileColumn <= lastTexelColumn; tileColumn += tileSize) {
+            const int32_t tileNumberOfColumns = std::min(tileSize,
+                                                         lastTexelColumn - tileColumn + 1);
+            matrixImagePyramid.getLevelRegionRGBA(level,
+                                                  tileRow,
+                                                  tileColumn,
+                                                  tileNumberOfRows,
+                                                  tileNumberOfColumns,
+                                                  tileRGBA);
+            glTexSubImage2D(GL_TEXTURE_2D,
+                            0,
+                            0,
+                            0,
+                            tileNumberOfColumns,
+                            tileNumberOfRows,
+                            GL_RGBA,
+                            GL_UNSIGNED_BYTE,
+                            &tileRGBA[0]);
+            
+            /*
+             * Matrix cells covered by the tile.  Texels in the last
+             * row or column of a level may cover fewer cells.
+             */
+            const int64_t cellColumnLeft  = tileColumn * cellsPerTexel;
+            const int64_t cellColumnRight = std::min((tileColumn + tileNumberOfColumns) * cellsPerTexel,
+                                                     static_cast<int64_t>(numberOfColumns));
+            const int64_t cellRowTop      = tileRow * cellsPerTexel;
+            const int64_t cellRowBottom   = std::min((tileRow + tileNumberOfRows) * cellsPerTexel,
+                                                     static_cast<int64_t>(numberOfRows));
+            const float xLeft   = cellColumnLeft * cellWidth;
+            const float xRight  = cellColumnRight * cellWidth;
+            const float yTop    = (numberOfRows - cellRowTop) * cellHeight;
+            const float yBottom = (numberOfRows - cellRowBottom) * cellHeight;
+            const float sMax = static_cast<float>(tileNumberOfColumns) / tileSize;
+            const float tMax = static_cast<float>(tileNumberOfRows) / tileSize;
+            
+            /*
+             * First row of the tile is at the top
+             */
+            glBegin(GL_QUADS);
+            glTexCoord2f(0.0, tMax);
+            glVertex3f(xLeft, yBottom, 0.0);
+            glTexCoord2f(sMax, tMax);
+            glVertex3f(xRight, yBottom, 0.0);
+            glTexCoord2f(sMax, 0.0);
+            glVertex3f(xRight, yTop, 0.0);
+            glTexCoord2f(0.0, 0.0);
+            glVertex3f(xLeft, yTop, 0.0);
+            glEnd();
+        }
+    }
+    
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glDeleteTextures(1, &textureName);
+    
+    glDisable(GL_TEXTURE_2D);
+    
+    glPopClientAttrib();
+}
+
 /**
  * Save the state of OpenGL.
  * Copied from Qt's qgl.cpp, qt_save_gl_state().
@@ -1544,10 +1703,9 @@ BrainOpenGLChartDrawingFixedPipeline::processIdentification()
                                             chartDataCartesian,
                                             chartLineIndex);
                 
-                const ChartPoint* chartPoint = chartDataCartesian->getPointAtIndex(chartLineIndex);
                 const float lineXYZ[3] = {
-                    chartPoint->getX(),
-                    chartPoint->getY(),
+                    chartDataCartesian->getPointX(chartLineIndex),
+                    chartDataCartesian->getPointY(chartLineIndex),
                     0.0
                 };
                 
@@ -1576,10 +1734,9 @@ BrainOpenGLChartDrawingFixedPipeline::processIdentification()
                                                  chartDataCartesian,
                                                  chartLineIndex);
                 
-                const ChartPoint* chartPoint = chartDataCartesian->getPointAtIndex(chartLineIndex);
                 const float lineXYZ[3] = {
-                    chartPoint->getX(),
-                    chartPoint->getY(),
+                    chartDataCartesian->getPointX(chartLineIndex),
+                    chartDataCartesian->getPointY(chartLineIndex),
                     0.0
                 };
                 
@@ -1608,10 +1765,9 @@ BrainOpenGLChartDrawingFixedPipeline::processIdentification()
                                             chartDataCartesian,
                                             chartLineIndex);
                 
-                const ChartPoint* chartPoint = chartDataCartesian->getPointAtIndex(chartLineIndex);
                 const float lineXYZ[3] = {
-                    chartPoint->getX(),
-                    chartPoint->getY(),
+                    chartDataCartesian->getPointX(chartLineIndex),
+                    chartDataCartesian->getPointY(chartLineIndex),
                     0.0
                 };
                 
@@ -37,6 +37,7 @@ namespace caret {
     class ChartModelFrequencySeries;
     class ChartModelTimeSeries;
     class ChartableMatrixInterface;
+    class ChartMatrixImagePyramid;
     
     class BrainOpenGLChartDrawingFixedPipeline : public BrainOpenGLChartDrawingInterface {
         
@@ -82,7 +83,8 @@ namespace caret {
 
         BrainOpenGLChartDrawingFixedPipeline& operator=(const BrainOpenGLChartDrawingFixedPipeline&);
         
-        void drawChartGraphicsLineSeries(BrainOpenGLTextRenderInterface* textRenderer,
+        void drawChartGraphicsLineSeries(const int32_t viewport[4],
+                                         BrainOpenGLTextRenderInterface* textRenderer,
                                          ChartModelCartesian* chart);
         
         void drawChartGraphicsMatrix(const int32_t viewport[4],
@@ -90,6 +92,13 @@ namespace caret {
                                      ChartableMatrixInterface* chartMatrixInterface,
                                      const int32_t scalarDataSeriesMapIndex);
 
+        void drawMatrixImagePyramid(ChartMatrixImagePyramid& matrixImagePyramid,
+                                    const float cellWidth,
+                                    const float cellHeight,
+                                    const float cellWidthPixels,
+                                    const float cellHeightPixels,
+                                    const float visibleRegion[4]);
+        
         void drawChartGraphicsBoxAndSetViewport(const float vpX,
                                const float vpY,
                                const float vpWidth,
@@ -116,7 +125,10 @@ namespace caret {
         void drawChartDataCartesian(const int32_t chartDataIndex,
                                     const ChartDataCartesian* chartDataCartesian,
                                     const float lineWidth,
-                                    const float rgb[3]);
+                                    const float rgb[3],
+                                    const float xMinimum,
+                                    const float xMaximum,
+                                    const int32_t viewportWidth);
         
         void estimateCartesianChartAxisLegendsWidthHeight(BrainOpenGLTextRenderInterface* textRenderer,
                                                           const float viewportHeight,
@@ -25,6 +25,7 @@
 
 #include "Brain.h"
 #include "CaretAssert.h"
+#include "CaretPreferences.h"
 #include "CiftiConnectivityMatrixParcelFile.h"
 #include "CiftiMappableConnectivityMatrixDataFile.h"
 #include "EventBrowserTabGetAllViewed.h"
@@ -35,6 +36,7 @@
 #include "SceneClass.h"
 #include "SceneClassArray.h"
 #include "ScenePrimitiveArray.h"
+#include "SessionManager.h"
 #include "Surface.h"
 #include "SurfaceFile.h"
 
@@ -264,6 +266,7 @@ CiftiConnectivityMatrixDataFileManager::loadDataForSurfaceNode(Brain* brain,
     std::vector<CiftiMappableConnectivityMatrixDataFile*> ciftiMatrixFiles;
     getDisplayedConnectivityMatrixFiles(brain,
                                         ciftiMatrixFiles);
+    updateRowCacheSizes(ciftiMatrixFiles);
     
     
     PaletteFile* paletteFile = brain->getPaletteFile();
@@ -336,6 +339,7 @@ CiftiConnectivityMatrixDataFileManager::loadAverageDataForSurfaceNodes(Brain* br
     std::vector<CiftiMappableConnectivityMatrixDataFile*> ciftiMatrixFiles;
     getDisplayedConnectivityMatrixFiles(brain,
                                         ciftiMatrixFiles);
+    updateRowCacheSizes(ciftiMatrixFiles);
     
     PaletteFile* paletteFile = brain->getPaletteFile();
     
@@ -384,6 +388,7 @@ CiftiConnectivityMatrixDataFileManager::loadDataForVoxelAtCoordinate(Brain* brai
     std::vector<CiftiMappableConnectivityMatrixDataFile*> ciftiMatrixFiles;
     getDisplayedConnectivityMatrixFiles(brain,
                                         ciftiMatrixFiles);
+    updateRowCacheSizes(ciftiMatrixFiles);
     
     bool haveData = false;
     for (std::vector<CiftiMappableConnectivityMatrixDataFile*>::iterator iter = ciftiMatrixFiles.begin();
@@ -456,6 +461,7 @@ CiftiConnectivityMatrixDataFileManager::loadAverageDataForVoxelIndices(Brain* br
     std::vector<CiftiMappableConnectivityMatrixDataFile*> ciftiMatrixFiles;
     getDisplayedConnectivityMatrixFiles(brain,
                                         ciftiMatrixFiles);
+    updateRowCacheSizes(ciftiMatrixFiles);
     
     bool haveData = false;
     for (std::vector<CiftiMappableConnectivityMatrixDataFile*>::iterator iter = ciftiMatrixFiles.begin();
@@ -482,6 +488,161 @@ CiftiConnectivityMatrixDataFileManager::loadAverageDataForVoxelIndices(Brain* br
     return haveData;
 }
 
+/**
+ * Set the size of the cache of recently loaded rows in each of the given
+ * files using the user's preferences.
+ *
+ * @param ciftiMatrixFiles
+ *    The connectivity files.
+ */
+void
+CiftiConnectivityMatrixDataFileManager::updateRowCacheSizes(std::vector<CiftiMappableConnectivityMatrixDataFile*>& ciftiMatrixFiles) const
+{
+    const CaretPreferences* prefs = SessionManager::get()->getCaretPreferences();
+    const int64_t cacheSizeInBytes = (static_cast<int64_t>(prefs->getConnectivityRowCacheSizeMegabytes())
+                                      * 1024 * 1024);
+    
+    for (std::vector<CiftiMappableConnectivityMatrixDataFile*>::iterator iter = ciftiMatrixFiles.begin();
+         iter != ciftiMatrixFiles.end();
+         iter++) {
+        (*iter)->setRowCacheSizeInBytes(cacheSizeInBytes);
+    }
+}
+
+/**
+ * Request that data for the given surface node be loaded asynchronously
+ * so that the user interface remains responsive while rows are read
+ * from large files.  Use finishAsynchronousLoading() to make
+ * the loaded data available for display.
+ *
+ * @param brain
+ *    Brain for which data is loaded.
+ * @param surfaceFile
+ *    Surface File that contains the node (uses its structure).
+ * @param nodeIndex
+ *    Index of the surface node.
+ * @return
+ *    true if any loads were requested, else false.
+ */
+bool
+CiftiConnectivityMatrixDataFileManager::requestDataForSurfaceNodeAsynchronously(Brain* brain,
+                                                                                const SurfaceFile* surfaceFile,
+                                                                                const int32_t nodeIndex)
+{
+    std::vector<CiftiMappableConnectivityMatrixDataFile*> ciftiMatrixFiles;
+    getDisplayedConnectivityMatrixFiles(brain,
+                                        ciftiMatrixFiles);
+    updateRowCacheSizes(ciftiMatrixFiles);
+    
+    bool requestedFlag = false;
+    for (std::vector<CiftiMappableConnectivityMatrixDataFile*>::iterator iter = ciftiMatrixFiles.begin();
+         iter != ciftiMatrixFiles.end();
+         iter++) {
+        CiftiMappableConnectivityMatrixDataFile* cmf = *iter;
+        if (cmf->isEmpty() == false) {
+            if (cmf->requestMapDataForSurfaceNodeAsynchronously(surfaceFile->getNumberOfNodes(),
+                                                                surfaceFile->getStructure(),
+                                                                nodeIndex)) {
+                requestedFlag = true;
+            }
+        }
+    }
+    
+    return requestedFlag;
+}
+
+/**
+ * Request that data for the given surface nodes be loaded and averaged
+ * asynchronously.  Use finishAsynchronousLoading() to make the
+ * loaded data available for display.
+ *
+ * @param brain
+ *    Brain for which data is loaded.
+ * @param surfaceFile
+ *    Surface File that contains the node (uses its structure).
+ * @param nodeIndices
+ *    Indices of the surface nodes.
+ * @return
+ *    true if any loads were requested, else false.
+ */
+bool
+CiftiConnectivityMatrixDataFileManager::requestAverageDataForSurfaceNodesAsynchronously(Brain* brain,
+                                                                                        const SurfaceFile* surfaceFile,
+                                                                                        const std::vector<int32_t>& nodeIndices)
+{
+    std::vector<CiftiMappableConnectivityMatrixDataFile*> ciftiMatrixFiles;
+    getDisplayedConnectivityMatrixFiles(brain,
+                                        ciftiMatrixFiles);
+    updateRowCacheSizes(ciftiMatrixFiles);
+    
+    bool requestedFlag = false;
+    for (std::vector<CiftiMappableConnectivityMatrixDataFile*>::iterator iter = ciftiMatrixFiles.begin();
+         iter != ciftiMatrixFiles.end();
+         iter++) {
+        CiftiMappableConnectivityMatrixDataFile* cmf = *iter;
+        if (cmf->isEmpty() == false) {
+            if (cmf->requestMapAverageDataForSurfaceNodesAsynchronously(surfaceFile->getNumberOfNodes(),
+                                                                        surfaceFile->getStructure(),
+                                                                        nodeIndices)) {
+                requestedFlag = true;
+            }
+        }
+    }
+    
+    return requestedFlag;
+}
+
+/**
+ * Make data that was loaded asynchronously available for display and
+ * invalidate surface coloring so that it is redrawn.
+ *
+ * @param brain
+ *    Brain for which data is loaded.
+ * @param errorMessageOut
+ *    Contains the errors of any loads that failed, empty if none failed.
+ * @return
+ *    true if the data in any file changed, else false.
+ */
+bool
+CiftiConnectivityMatrixDataFileManager::finishAsynchronousLoading(Brain* brain,
+                                                                  AString& errorMessageOut)
+{
+    errorMessageOut.clear();
+
+    std::vector<CiftiMappableConnectivityMatrixDataFile*> ciftiMatrixFiles;
+    getDisplayedConnectivityMatrixFiles(brain,
+                                        ciftiMatrixFiles);
+    
+    PaletteFile* paletteFile = brain->getPaletteFile();
+    
+    bool haveData = false;
+    for (std::vector<CiftiMappableConnectivityMatrixDataFile*>::iterator iter = ciftiMatrixFiles.begin();
+         iter != ciftiMatrixFiles.end();
+         iter++) {
+        CiftiMappableConnectivityMatrixDataFile* cmf = *iter;
+        AString fileErrorMessage;
+        const bool changedFlag = cmf->finishAsynchronousLoad(fileErrorMessage);
+        if ( ! fileErrorMessage.isEmpty()) {
+            if ( ! errorMessageOut.isEmpty()) {
+                errorMessageOut.append("\n");
+            }
+            errorMessageOut.append(fileErrorMessage);
+        }
+        if (changedFlag) {
+            const int32_t mapIndex = 0;
+            cmf->updateScalarColoringForMap(mapIndex,
+                                            paletteFile);
+            haveData = true;
+        }
+    }
+    
+    if (haveData) {
+        EventManager::get()->sendEvent(EventSurfaceColoringInvalidate().getPointer());
+    }
+    
+    return haveData;
+}
+
 /**
  * @param brain
  *    Brain for containing network files.
@@ -72,6 +72,17 @@ namespace caret {
         
         bool hasNetworkFiles(Brain* brain) const;
         
+        bool requestDataForSurfaceNodeAsynchronously(Brain* brain,
+                                                     const SurfaceFile* surfaceFile,
+                                                     const int32_t nodeIndex);
+        
+        bool requestAverageDataForSurfaceNodesAsynchronously(Brain* brain,
+                                                             const SurfaceFile* surfaceFile,
+                                                             const std::vector<int32_t>& nodeIndices);
+        
+        bool finishAsynchronousLoading(Brain* brain,
+                                       AString& errorMessageOut);
+        
     private:
         CiftiConnectivityMatrixDataFileManager(const CiftiConnectivityMatrixDataFileManager&);
 
@@ -84,6 +95,8 @@ namespace caret {
     private:
         void getDisplayedConnectivityMatrixFiles(Brain* brain,
                                                  std::vector<CiftiMappableConnectivityMatrixDataFile*>& ciftiMatrixFilesOut) const;
+        
+        void updateRowCacheSizes(std::vector<CiftiMappableConnectivityMatrixDataFile*>& ciftiMatrixFiles) const;
 
         // ADD_NEW_MEMBERS_HERE
     };
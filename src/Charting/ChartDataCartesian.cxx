@@ -23,12 +23,12 @@
 #include "ChartDataCartesian.h"
 #undef __CHART_DATA_CARTESIAN_DECLARE__
 
-#include <limits>
+#include <algorithm>
+#include <cmath>
 
 #include <QTextStream>
 
 #include "CaretAssert.h"
-#include "ChartPoint.h"
 #include "SceneClass.h"
 #include "SceneClassAssistant.h"
 
@@ -79,6 +79,10 @@ void
 ChartDataCartesian::initializeMembersChartDataCartesian()
 {
     m_boundsValid       = false;
+    m_xNonDecreasing    = true;
+    for (int32_t i = 0; i < 6; i++) {
+        m_bounds[i] = 0.0;
+    }
     m_color             = CaretColorEnum::RED;
     m_timeStartInSecondsAxisX = 0.0;
     m_timeStepInSecondsAxisX  = 1.0;
@@ -126,14 +130,14 @@ ChartDataCartesian::initializeMembersChartDataCartesian()
 void
 ChartDataCartesian::removeAllPoints()
 {
-    for (std::vector<ChartPoint*>::const_iterator iter = m_points.begin();
-         iter != m_points.end();
-         iter++) {
-        delete *iter;
-    }
-    m_points.clear();
+    m_pointsX.clear();
+    m_pointsY.clear();
     
-    m_boundsValid = false;
+    m_boundsValid    = false;
+    m_xNonDecreasing = true;
+    for (int32_t i = 0; i < 6; i++) {
+        m_bounds[i] = 0.0;
+    }
 }
 
 /**
@@ -197,21 +201,20 @@ ChartDataCartesian::copyHelperChartDataCartesian(const ChartDataCartesian& obj)
     
     removeAllPoints();
 
-    for (std::vector<ChartPoint*>::const_iterator iter = obj.m_points.begin();
-         iter != obj.m_points.end();
-         iter++) {
-        const ChartPoint* cp = *iter;
-        m_points.push_back(new ChartPoint(*cp));
+    m_pointsX = obj.m_pointsX;
+    m_pointsY = obj.m_pointsY;
+    for (int32_t i = 0; i < 6; i++) {
+        m_bounds[i] = obj.m_bounds[i];
     }
-
-    m_boundsValid       = false;
+    m_boundsValid       = obj.m_boundsValid;
+    m_xNonDecreasing    = obj.m_xNonDecreasing;
     m_color             = obj.m_color;
     m_timeStartInSecondsAxisX = obj.m_timeStartInSecondsAxisX;
     m_timeStepInSecondsAxisX  = obj.m_timeStepInSecondsAxisX;
 }
 
 /**
- * Add a point.
+ * Add a point.  Bounds are updated with the point.
  *
  * @param x
  *    X-coordinate.
@@ -222,8 +225,39 @@ void
 ChartDataCartesian::addPoint(const float x,
                                   const float y)
 {
-    m_points.push_back(new ChartPoint(x, y));
-    m_boundsValid = false;
+    if (m_boundsValid) {
+        if (x < m_bounds[0]) m_bounds[0] = x;
+        if (x > m_bounds[1]) m_bounds[1] = x;
+        if (y < m_bounds[2]) m_bounds[2] = y;
+        if (y > m_bounds[3]) m_bounds[3] = y;
+        
+        if (x < m_pointsX.back()) {
+            m_xNonDecreasing = false;
+        }
+    }
+    else {
+        m_bounds[0] = x;
+        m_bounds[1] = x;
+        m_bounds[2] = y;
+        m_bounds[3] = y;
+        m_boundsValid = true;
+    }
+    
+    m_pointsX.push_back(x);
+    m_pointsY.push_back(y);
+}
+
+/**
+ * Reserve memory for points that will be added.
+ *
+ * @param numberOfPoints
+ *    Total number of points expected.
+ */
+void
+ChartDataCartesian::reservePoints(const int32_t numberOfPoints)
+{
+    m_pointsX.reserve(numberOfPoints);
+    m_pointsY.reserve(numberOfPoints);
 }
 
 /**
@@ -232,22 +266,133 @@ ChartDataCartesian::addPoint(const float x,
 int32_t
 ChartDataCartesian::getNumberOfPoints() const
 {
-    return m_points.size();
+    return m_pointsX.size();
+}
+
+/**
+ * Get the X-coordinate of the point at the given index.
+ *
+ * @param pointIndex
+ *    Index of point.
+ * @return
+ *    X-coordinate of point at the given index.
+ */
+float
+ChartDataCartesian::getPointX(const int32_t pointIndex) const
+{
+    CaretAssertVectorIndex(m_pointsX, pointIndex);
+    return m_pointsX[pointIndex];
 }
 
 /**
- * Get the point at the given index.
+ * Get the Y-coordinate of the point at the given index.
  *
  * @param pointIndex
  *    Index of point.
  * @return
- *    Point at the given index.
+ *    Y-coordinate of point at the given index.
+ */
+float
+ChartDataCartesian::getPointY(const int32_t pointIndex) const
+{
+    CaretAssertVectorIndex(m_pointsY, pointIndex);
+    return m_pointsY[pointIndex];
+}
+
+/**
+ * @return The X-coordinates of all points (contiguous, 
+ * getNumberOfPoints() elements).
+ */
+const float*
+ChartDataCartesian::getPointsX() const
+{
+    if (m_pointsX.empty()) {
+        return NULL;
+    }
+    return &m_pointsX[0];
+}
+
+/**
+ * @return The Y-coordinates of all points (contiguous,
+ * getNumberOfPoints() elements).
+ */
+const float*
+ChartDataCartesian::getPointsY() const
+{
+    if (m_pointsY.empty()) {
+        return NULL;
+    }
+    return &m_pointsY[0];
+}
+
+/**
+ * Get the points for drawing a line through the points with about
+ * two points per pixel.  The X-axis range is divided into one bin for
+ * each pixel and consecutive points in the same bin are replaced by
+ * the points with the minimum and maximum Y-values (in their original
+ * order), so the drawn line covers the same pixels as a line through
+ * all of the points.  If the X-coordinates are not in order, or there
+ * are few points, all of the points are output.
+ *
+ * @param xMinimum
+ *    X-coordinate at the left side of the drawing region.
+ * @param xMaximum
+ *    X-coordinate at the right side of the drawing region.
+ * @param numberOfPixels
+ *    Width of the drawing region in pixels.
+ * @param pointsXYOut
+ *    Output containing X and Y for each point that is drawn.
  */
-const ChartPoint*
-ChartDataCartesian::getPointAtIndex(const int32_t pointIndex) const
+void
+ChartDataCartesian::getDecimatedPointsXY(const float xMinimum,
+                                         const float xMaximum,
+                                         const int32_t numberOfPixels,
+                                         std::vector<float>& pointsXYOut) const
 {
-    CaretAssertVectorIndex(m_points, pointIndex);
-    return m_points[pointIndex];
+    pointsXYOut.clear();
+    
+    const int32_t numPoints = getNumberOfPoints();
+    const float xRange = xMaximum - xMinimum;
+    if (( ! m_xNonDecreasing)
+        || (numberOfPixels <= 0)
+        || (xRange <= 0.0)
+        || (numPoints <= (numberOfPixels * 4))) {
+        pointsXYOut.reserve(numPoints * 2);
+        for (int32_t i = 0; i < numPoints; i++) {
+            pointsXYOut.push_back(m_pointsX[i]);
+            pointsXYOut.push_back(m_pointsY[i]);
+        }
+        return;
+    }
+    
+    pointsXYOut.reserve(numberOfPixels * 4 + 8);
+    const double binsPerUnit = numberOfPixels / static_cast<double>(xRange);
+    
+    int32_t binStart = 0;
+    while (binStart < numPoints) {
+        const int64_t bin = static_cast<int64_t>(std::floor((m_pointsX[binStart] - xMinimum) * binsPerUnit));
+        int32_t minIndex = binStart;
+        int32_t maxIndex = binStart;
+        int32_t binEnd = binStart + 1;
+        for (; binEnd < numPoints; binEnd++) {
+            if (static_cast<int64_t>(std::floor((m_pointsX[binEnd] - xMinimum) * binsPerUnit)) != bin) {
+                break;
+            }
+            if (m_pointsY[binEnd] < m_pointsY[minIndex]) minIndex = binEnd;
+            if (m_pointsY[binEnd] > m_pointsY[maxIndex]) maxIndex = binEnd;
+        }
+        
+        const int32_t firstIndex  = std::min(minIndex, maxIndex);
+        const int32_t secondIndex = std::max(minIndex, maxIndex);
+        pointsXYOut.push_back(m_pointsX[firstIndex]);
+        pointsXYOut.push_back(m_pointsY[firstIndex]);
+        if (secondIndex != firstIndex) {
+            pointsXYOut.push_back(m_pointsX[secondIndex]);
+            pointsXYOut.push_back(m_pointsY[secondIndex]);
+        }
+        
+        binStart = binEnd;
+    }
 }
 
 /**
@@ -268,40 +413,6 @@ ChartDataCartesian::getBounds(float& xMinimumOut,
                                    float& yMinimumOut,
                                    float& yMaximumOut) const
 {
-    if (! m_boundsValid) {
-        float xMin = 0.0;
-        float xMax = 0.0;
-        float yMin = 0.0;
-        float yMax = 0.0;
-        float zMin = 0.0;
-        float zMax = 0.0;
-        const int32_t numPoints = getNumberOfPoints();
-        if (numPoints > 0) {
-            xMin = std::numeric_limits<float>::max();
-            xMax = -std::numeric_limits<float>::max();
-            yMin = std::numeric_limits<float>::max();
-            yMax = -std::numeric_limits<float>::max();
-            for (int32_t i = 0; i < numPoints; i++) {
-                const float* xy = getPointAtIndex(i)->getXY();
-                const float x = xy[0];
-                const float y = xy[1];
-                if (x < xMin) xMin = x;
-                if (x > xMax) xMax = x;
-                if (y < yMin) yMin = y;
-                if (y > yMax) yMax = y;
-            }
-            
-            m_boundsValid = true;
-        }
-        
-        m_bounds[0] = xMin;
-        m_bounds[1] = xMax;
-        m_bounds[2] = yMin;
-        m_bounds[3] = yMax;
-        m_bounds[4] = zMin;
-        m_bounds[5] = zMax;
-    }
-    
     xMinimumOut = m_bounds[0];
     xMaximumOut = m_bounds[1];
     yMinimumOut = m_bounds[2];
@@ -427,8 +538,7 @@ ChartDataCartesian::saveSubClassDataToScene(const SceneAttributes* sceneAttribut
                                QIODevice::WriteOnly);
         
         for (int32_t i = 0; i < numPoints2D; i++) {
-            const float* xy = m_points[i]->getXY();
-            textStream << xy[0] << " " << xy[1] << " ";
+            textStream << m_pointsX[i] << " " << m_pointsY[i] << " ";
         }
         
         chartDataCartesian->addString("points2D",
@@ -473,6 +583,7 @@ ChartDataCartesian::restoreSubClassDataFromScene(const SceneAttributes* sceneAtt
             float x, y;
             QTextStream textStream(&pointString,
                                    QIODevice::ReadOnly);
+            reservePoints(numPoints2D);
             for (int32_t i = 0; i < numPoints2D; i++) {
                 if (textStream.atEnd()) {
                     sceneAttributes->addToErrorMessage("Tried to read "
@@ -484,7 +595,7 @@ ChartDataCartesian::restoreSubClassDataFromScene(const SceneAttributes* sceneAtt
                 
                 textStream >> x;
                 textStream >> y;
-                m_points.push_back(new ChartPoint(x, y));
+                addPoint(x, y);
             }
         }
     }
@@ -29,8 +29,6 @@
 
 namespace caret {
 
-    class ChartPoint;
-    
     class ChartDataCartesian : public ChartData {
         
     public:
@@ -45,9 +43,22 @@ namespace caret {
         void addPoint(const float x,
                       const float y);
         
+        void reservePoints(const int32_t numberOfPoints);
+        
         int32_t getNumberOfPoints() const;
         
-        const ChartPoint* getPointAtIndex(const int32_t pointIndex) const;
+        float getPointX(const int32_t pointIndex) const;
+        
+        float getPointY(const int32_t pointIndex) const;
+        
+        const float* getPointsX() const;
+        
+        const float* getPointsY() const;
+        
+        void getDecimatedPointsXY(const float xMinimum,
+                                  const float xMaximum,
+                                  const int32_t numberOfPixels,
+                                  std::vector<float>& pointsXYOut) const;
         
         void getBounds(float& xMinimumOut,
                        float& xMaximumOut,
@@ -91,11 +102,20 @@ namespace caret {
         
         void removeAllPoints();
         
-        std::vector<ChartPoint*> m_points;
+        /** X-coordinates of the points */
+        std::vector<float> m_pointsX;
+        
+        /** Y-coordinates of the points */
+        std::vector<float> m_pointsY;
+        
+        /** Bounds of the points, updated as points are added */
+        float m_bounds[6];
         
-        mutable float m_bounds[6];
+        /** True if there are points and bounds are set */
+        bool m_boundsValid;
         
-        mutable bool m_boundsValid;
+        /** True if X-coordinates never decrease (all series), allows decimation */
+        bool m_xNonDecreasing;
         
         ChartAxisUnitsEnum::Enum m_dataAxisUnitsX;
         
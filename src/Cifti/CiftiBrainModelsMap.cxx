@@ -21,6 +21,7 @@
 #include "CiftiBrainModelsMap.h"
 
 #include "CaretException.h"
+#include "CiftiIndexText.h"
 
 #include <QStringList>
 
@@ -852,22 +853,7 @@ vector<int64_t> CiftiBrainModelsMap::ParseHelperModel::readIndexArray(QXmlStream
     vector<int64_t> ret;
     QString text = xml.readElementText();//raises error if it encounters a start element
     if (xml.hasError()) return ret;
-    QStringList separated = text.split(QRegExp("\\s+"), QString::SkipEmptyParts);
-    int64_t numElems = separated.size();
-    ret.reserve(numElems);
-    for (int64_t i = 0; i < numElems; ++i)
-    {
-        bool ok = false;
-        ret.push_back(separated[i].toLongLong(&ok));
-        if (!ok)
-        {
-            throw CaretException("found noninteger in index array: " + separated[i]);
-        }
-        if (ret.back() < 0)
-        {
-            throw CaretException("found negative integer in index array: " + separated[i]);
-        }
-    }
+    CiftiIndexText::parseIntegers(text, ret, false);
     return ret;
 }
 
@@ -888,26 +874,33 @@ void CiftiBrainModelsMap::writeXML1(QXmlStreamWriter& xml) const
             xml.writeAttribute("ModelType", "CIFTI_MODEL_TYPE_SURFACE");
             xml.writeAttribute("SurfaceNumberOfNodes", QString::number(myModel.m_surfaceNumberOfNodes));
             xml.writeStartElement("NodeIndices");
-            QString text = "";
+            CiftiIndexText text;
             int64_t numNodes = (int64_t)myModel.m_nodeIndices.size();
+            text.reserve(numNodes * 7);
             for (int64_t j = 0; j < numNodes; ++j)
             {
-                if (j != 0) text += " ";
-                text += QString::number(myModel.m_nodeIndices[j]);
+                if (j != 0) text.appendSeparator(' ');
+                text.appendNumber(myModel.m_nodeIndices[j]);
             }
-            xml.writeCharacters(text);
+            xml.writeCharacters(text.toString());
             xml.writeEndElement();
         } else {
             xml.writeAttribute("ModelType", "CIFTI_MODEL_TYPE_VOXELS");
             xml.writeStartElement("VoxelIndicesIJK");
-            QString text = "";
+            CiftiIndexText text;
             int64_t listSize = (int64_t)myModel.m_voxelIndicesIJK.size();
             CaretAssert(listSize % 3 == 0);
+            text.reserve(listSize * 3);
             for (int64_t j = 0; j < listSize; j += 3)
             {
-                text += QString::number(myModel.m_voxelIndicesIJK[j]) + " " + QString::number(myModel.m_voxelIndicesIJK[j + 1]) + " " + QString::number(myModel.m_voxelIndicesIJK[j + 2]) + "\n";
+                text.appendNumber(myModel.m_voxelIndicesIJK[j]);
+                text.appendSeparator(' ');
+                text.appendNumber(myModel.m_voxelIndicesIJK[j + 1]);
+                text.appendSeparator(' ');
+                text.appendNumber(myModel.m_voxelIndicesIJK[j + 2]);
+                text.appendSeparator('\n');
             }
-            xml.writeCharacters(text);
+            xml.writeCharacters(text.toString());
             xml.writeEndElement();
         }
         xml.writeEndElement();
@@ -935,26 +928,33 @@ void CiftiBrainModelsMap::writeXML2(QXmlStreamWriter& xml) const
             xml.writeAttribute("ModelType", "CIFTI_MODEL_TYPE_SURFACE");
             xml.writeAttribute("SurfaceNumberOfVertices", QString::number(myModel.m_surfaceNumberOfNodes));
             xml.writeStartElement("VertexIndices");
-            QString text = "";
+            CiftiIndexText text;
             int64_t numNodes = (int64_t)myModel.m_nodeIndices.size();
+            text.reserve(numNodes * 7);
             for (int64_t j = 0; j < numNodes; ++j)
             {
-                if (j != 0) text += " ";
-                text += QString::number(myModel.m_nodeIndices[j]);
+                if (j != 0) text.appendSeparator(' ');
+                text.appendNumber(myModel.m_nodeIndices[j]);
             }
-            xml.writeCharacters(text);
+            xml.writeCharacters(text.toString());
             xml.writeEndElement();
         } else {
             xml.writeAttribute("ModelType", "CIFTI_MODEL_TYPE_VOXELS");
             xml.writeStartElement("VoxelIndicesIJK");
-            QString text = "";
+            CiftiIndexText text;
             int64_t listSize = (int64_t)myModel.m_voxelIndicesIJK.size();
             CaretAssert(listSize % 3 == 0);
+            text.reserve(listSize * 3);
             for (int64_t j = 0; j < listSize; j += 3)
             {
-                text += QString::number(myModel.m_voxelIndicesIJK[j]) + " " + QString::number(myModel.m_voxelIndicesIJK[j + 1]) + " " + QString::number(myModel.m_voxelIndicesIJK[j + 2]) + "\n";
+                text.appendNumber(myModel.m_voxelIndicesIJK[j]);
+                text.appendSeparator(' ');
+                text.appendNumber(myModel.m_voxelIndicesIJK[j + 1]);
+                text.appendSeparator(' ');
+                text.appendNumber(myModel.m_voxelIndicesIJK[j + 2]);
+                text.appendSeparator('\n');
             }
-            xml.writeCharacters(text);
+            xml.writeCharacters(text.toString());
             xml.writeEndElement();
         }
         xml.writeEndElement();
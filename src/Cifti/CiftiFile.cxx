@@ -26,10 +26,15 @@
 #include "CaretLogger.h"
 #include "DataFileException.h"
 #include "FileInformation.h"
+#include "MathFunctions.h"
 #include "MultiDimArray.h"
 #include "MultiDimIterator.h"
 #include "NiftiIO.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 using namespace std;
 using namespace caret;
 
@@ -42,14 +47,20 @@ namespace
         CiftiXML m_xml;//because we need to parse it to set up the dimensions anyway
     public:
         CiftiOnDiskImpl(const QString& filename);//read-only
-        CiftiOnDiskImpl(const QString& filename, const CiftiXML& xml, const CiftiVersion& version, const bool& swapEndian);//make new empty file with read/write
+        CiftiOnDiskImpl(const QString& filename, const CiftiXML& xml, const CiftiVersion& version, const bool& swapEndian,
+                        const int16_t& dataType, const bool& doScale, const double& minScale, const double& maxScale);//make new empty file with read/write
         void getRow(float* dataOut, const std::vector<int64_t>& indexSelect, const bool& tolerateShortRead) const;
         void getColumn(float* dataOut, const int64_t& index) const;
+        void getRows(float* dataOut, const int64_t& firstIndex, const int64_t& numRows, const int64_t& rowLength) const;
+        void getRawRows(char* dataOut, const int64_t& firstIndex, const int64_t& numRows) const;
         const CiftiXML& getCiftiXML() const { return m_xml; }
         QString getFilename() const { return m_nifti.getFilename(); }
         bool isSwapped() const { return m_nifti.getHeader().isSwapped(); }
+        bool hasStorage(const int16_t& dataType, const bool& doScale, const double& minScale, const double& maxScale) const;
         void setRow(const float* dataIn, const std::vector<int64_t>& indexSelect);
         void setColumn(const float* dataIn, const int64_t& index);
+        void setRows(const float* dataIn, const int64_t& firstIndex, const int64_t& numRows, const int64_t& rowLength);
+        void setRawRows(const char* dataIn, const int64_t& firstIndex, const int64_t& numRows);
     };
     
     class CiftiMemoryImpl : public CiftiFile::WriteImplInterface
@@ -90,24 +101,110 @@ namespace
         return false;//default for all other enum values is to write native endian
     }
     
+    const int64_t COPY_BLOCK_BYTES = ((int64_t)1) << 26;//for copyRowsFrom, large enough that file access is mostly sequential
+    const int64_t AUTO_SCALE_MEMORY_BYTES = ((int64_t)1) << 31;//auto scaling holds on-disk outputs in memory until writeFile(), refuse to do that for anything larger
+    
     bool dontRewrite(const CiftiFile::ENDIAN& endian)
     {
         return (endian == CiftiFile::ANY);
     }
     
+    bool getIntegerTypeRange(const int16_t& type, double& minOut, double& maxOut)
+    {
+        switch (type)
+        {
+            case NIFTI_TYPE_UINT8:
+                minOut = numeric_limits<uint8_t>::min();
+                maxOut = numeric_limits<uint8_t>::max();
+                return true;
+            case NIFTI_TYPE_INT8:
+                minOut = numeric_limits<int8_t>::min();
+                maxOut = numeric_limits<int8_t>::max();
+                return true;
+            case NIFTI_TYPE_UINT16:
+                minOut = numeric_limits<uint16_t>::min();
+                maxOut = numeric_limits<uint16_t>::max();
+                return true;
+            case NIFTI_TYPE_INT16:
+                minOut = numeric_limits<int16_t>::min();
+                maxOut = numeric_limits<int16_t>::max();
+                return true;
+            case NIFTI_TYPE_UINT32:
+                minOut = numeric_limits<uint32_t>::min();
+                maxOut = numeric_limits<uint32_t>::max();
+                return true;
+            case NIFTI_TYPE_INT32:
+                minOut = numeric_limits<int32_t>::min();
+                maxOut = numeric_limits<int32_t>::max();
+                return true;
+            default:
+                return false;
+        }
+    }
+    
+    bool getScaling(const int16_t& dataType, const bool& doScale, const double& minScale, const double& maxScale, double& mult, double& offset)
+    {//map [minScale, maxScale] to the full range of an integer type, returns false for no scaling
+        double typeMin, typeMax;
+        mult = 1.0;
+        offset = 0.0;
+        if (!doScale || !getIntegerTypeRange(dataType, typeMin, typeMax)) return false;
+        mult = (maxScale - minScale) / (typeMax - typeMin);
+        if (!(mult > 0.0)) mult = 1.0;//constant data, any slope will do
+        offset = minScale - typeMin * mult;
+        return true;
+    }
+    
+    void checkWritingDataType(const int16_t& type)
+    {
+        double junk1, junk2;
+        if (getIntegerTypeRange(type, junk1, junk2) || type == NIFTI_TYPE_FLOAT32 || type == NIFTI_TYPE_FLOAT64) return;
+        throw DataFileException("cifti files can't be written with nifti datatype " + QString::number(type));
+    }
+    
 }
 
 CiftiFile::ReadImplInterface::~ReadImplInterface()
 {
 }
 
+void CiftiFile::ReadImplInterface::getRows(float* dataOut, const int64_t& firstIndex, const int64_t& numRows, const int64_t& rowLength) const
+{
+    vector<int64_t> indexSelect(1);
+    for (int64_t i = 0; i < numRows; ++i)
+    {
+        indexSelect[0] = firstIndex + i;
+        getRow(dataOut + i * rowLength, indexSelect, false);
+    }
+}
+
+void CiftiFile::ReadImplInterface::getRawRows(char*, const int64_t&, const int64_t&) const
+{
+    throw DataFileException("internal error, raw row access on cifti data that isn't on disk");
+}
+
 CiftiFile::WriteImplInterface::~WriteImplInterface()
 {
 }
 
+void CiftiFile::WriteImplInterface::setRows(const float* dataIn, const int64_t& firstIndex, const int64_t& numRows, const int64_t& rowLength)
+{
+    vector<int64_t> indexSelect(1);
+    for (int64_t i = 0; i < numRows; ++i)
+    {
+        indexSelect[0] = firstIndex + i;
+        setRow(dataIn + i * rowLength, indexSelect);
+    }
+}
+
+void CiftiFile::WriteImplInterface::setRawRows(const char*, const int64_t&, const int64_t&)
+{
+    throw DataFileException("internal error, raw row access on cifti data that isn't on disk");
+}
+
 CiftiFile::CiftiFile(const QString& fileName)
 {
     m_endianPref = NATIVE;
+    setWritingDataTypeNoScaling();
     openFile(fileName);
 }
 
@@ -157,6 +254,45 @@ void CiftiFile::setWritingFile(const QString& fileName, const CiftiVersion& writ
     m_endianPref = endian;
 }
 
+void CiftiFile::setWritingDataTypeNoScaling(const int16_t& type)
+{
+    checkWritingDataType(type);
+    m_writingDataType = type;
+    m_doScale = false;
+    m_autoScale = false;
+    m_minScale = 0.0;
+    m_maxScale = 0.0;
+}
+
+void CiftiFile::setWritingDataTypeAndScaling(const int16_t& type, const double& minval, const double& maxval)
+{
+    checkWritingDataType(type);
+    if (!(minval <= maxval)) throw DataFileException("cifti scaling range minimum must not be greater than the maximum");
+    double junk1, junk2;
+    m_writingDataType = type;
+    m_doScale = getIntegerTypeRange(type, junk1, junk2);//float types don't need scaling
+    m_autoScale = false;
+    m_minScale = minval;
+    m_maxScale = maxval;
+}
+
+void CiftiFile::setWritingDataTypeAutoScaling(const int16_t& type)
+{
+    checkWritingDataType(type);
+    double junk1, junk2;
+    m_writingDataType = type;
+    m_doScale = getIntegerTypeRange(type, junk1, junk2);
+    m_autoScale = m_doScale;
+}
+
+void CiftiFile::setDataRangeHint(const double& minval, const double& maxval)
+{
+    if (!m_autoScale || !(minval <= maxval)) return;//explicit scaling wins
+    m_minScale = minval;
+    m_maxScale = maxval;
+    m_autoScale = false;
+}
+
 void CiftiFile::writeFile(const QString& fileName, const CiftiVersion& writingVersion, const ENDIAN& endian)
 {
     if (m_readingImpl == NULL || m_dims.empty()) throw DataFileException("writeFile called on uninitialized CiftiFile");
@@ -165,16 +301,26 @@ void CiftiFile::writeFile(const QString& fileName, const CiftiVersion& writingVe
     QString canonicalFilename = myInfo.getCanonicalFilePath();//NOTE: returns EMPTY STRING for nonexistant file
     const CiftiOnDiskImpl* testImpl = dynamic_cast<CiftiOnDiskImpl*>(m_readingImpl.getPointer());
     bool collision = false, hadWriter = (m_writingImpl != NULL);
+    int16_t writingType;
+    bool doScale, autoScale;
+    getWritingStorage(writingType, doScale, autoScale);
     if (testImpl != NULL && canonicalFilename != "" && FileInformation(testImpl->getFilename()).getCanonicalFilePath() == canonicalFilename)
     {//empty string test is so that we don't say collision if both are nonexistant - could happen if file is removed/unlinked while reading on some filesystems
-        if (m_onDiskVersion == writingVersion && !m_xml.mutablesModified() && (dontRewrite(endian) || writeSwapped == testImpl->isSwapped())) return;//don't need to copy to itself
+        if (m_onDiskVersion == writingVersion && !m_xml.mutablesModified() && (dontRewrite(endian) || writeSwapped == testImpl->isSwapped()) &&
+            testImpl->hasStorage(writingType, doScale && !autoScale, m_minScale, m_maxScale)) return;//don't need to copy to itself
         collision = true;//we need to copy to memory temporarily
         CaretPointer<WriteImplInterface> tempMemory(new CiftiMemoryImpl(m_xml));
         copyImplData(m_readingImpl, tempMemory, m_dims);
         m_readingImpl = tempMemory;//we are about to make the old reading impl very unhappy, replace it so that if we get an error while writing, we hang onto the memory version
         m_writingImpl.grabNew(NULL);//and make it re-magic the writing implementation again if data is set
     }
-    CaretPointer<WriteImplInterface> tempWrite(new CiftiOnDiskImpl(myInfo.getAbsoluteFilePath(), m_xml, writingVersion, writeSwapped));
+    double minScale = m_minScale, maxScale = m_maxScale;
+    if (autoScale)
+    {
+        findDataRange(m_readingImpl, m_dims, minScale, maxScale);//pass over the rows first, because the scaling goes in the header
+    }
+    CaretPointer<WriteImplInterface> tempWrite(new CiftiOnDiskImpl(myInfo.getAbsoluteFilePath(), m_xml, writingVersion, writeSwapped,
+                                                                   writingType, doScale, minScale, maxScale));
     copyImplData(m_readingImpl, tempWrite, m_dims);
     if (collision)//if we rewrote the file, we need the handle to the new file, and to dump the temporary in-memory version
     {
@@ -302,6 +448,95 @@ void CiftiFile::getRow(float* dataOut, const int64_t& index) const
     getRow(dataOut, index, false);//once CiftiInterface is gone, we can collapse this into a default value
 }
 
+void CiftiFile::getRows(float* dataOut, const int64_t& firstIndex, const int64_t& numRows) const
+{
+    if (m_dims.empty()) throw DataFileException("getRows called on uninitialized CiftiFile");
+    if (m_dims.size() != 2) throw DataFileException("getRows called on non-2D CiftiFile");
+    if (firstIndex < 0 || numRows < 0 || firstIndex + numRows > m_dims[1]) throw DataFileException("getRows called with invalid row range");
+    if (m_readingImpl == NULL || numRows == 0) return;//NOT an error because we are pretending to have a matrix already, while we are waiting for setRow to actually start writing the file
+    m_readingImpl->getRows(dataOut, firstIndex, numRows, m_dims[0]);
+}
+
+void CiftiFile::setRows(const float* dataIn, const int64_t& firstIndex, const int64_t& numRows)
+{
+    verifyWriteImpl();
+    if (m_dims.size() != 2) throw DataFileException("setRows called on non-2D CiftiFile");
+    if (firstIndex < 0 || numRows < 0 || firstIndex + numRows > m_dims[1]) throw DataFileException("setRows called with invalid row range");
+    if (numRows == 0) return;
+    m_writingImpl->setRows(dataIn, firstIndex, numRows, m_dims[0]);
+}
+
+bool CiftiFile::canCopyRawRowsFrom(const CiftiFile& source) const
+{
+    if (m_dims.size() != 2 || source.m_dims.size() != 2) return false;
+    int16_t writingType;
+    bool doScale, autoScale;
+    getWritingStorage(writingType, doScale, autoScale);
+    if (m_writingFile == "" || autoScale) return false;//writing would be in memory
+    if (m_writingImpl != NULL && dynamic_cast<const CiftiOnDiskImpl*>(m_writingImpl.getPointer()) == NULL) return false;
+    const CiftiOnDiskImpl* sourceImpl = dynamic_cast<const CiftiOnDiskImpl*>(source.m_readingImpl.getPointer());
+    if (sourceImpl == NULL) return false;
+    if (!sourceImpl->hasStorage(writingType, doScale, m_minScale, m_maxScale)) return false;
+    if (sourceImpl->isSwapped() != shouldSwap(m_endianPref)) return false;
+    QString canonicalSource = FileInformation(sourceImpl->getFilename()).getCanonicalFilePath();
+    if (canonicalSource == "" || canonicalSource == FileInformation(m_writingFile).getCanonicalFilePath()) return false;//verifyWriteImpl() would convert the source to in-memory
+    return true;
+}
+
+int CiftiFile::getRawBytesPerElement() const
+{
+    int16_t writingType;
+    bool doScale, autoScale;
+    getWritingStorage(writingType, doScale, autoScale);
+    return NiftiHeader::typeToNumBits(writingType) / 8;
+}
+
+void CiftiFile::getRawRows(char* dataOut, const int64_t& firstIndex, const int64_t& numRows) const
+{
+    if (m_dims.size() != 2) throw DataFileException("getRawRows called on non-2D CiftiFile");
+    if (firstIndex < 0 || numRows < 0 || firstIndex + numRows > m_dims[1]) throw DataFileException("getRawRows called with invalid row range");
+    if (m_readingImpl == NULL) throw DataFileException("getRawRows called on CiftiFile without data");
+    if (numRows == 0) return;
+    m_readingImpl->getRawRows(dataOut, firstIndex, numRows);
+}
+
+void CiftiFile::setRawRows(const char* dataIn, const int64_t& firstIndex, const int64_t& numRows)
+{
+    verifyWriteImpl();
+    if (m_dims.size() != 2) throw DataFileException("setRawRows called on non-2D CiftiFile");
+    if (firstIndex < 0 || numRows < 0 || firstIndex + numRows > m_dims[1]) throw DataFileException("setRawRows called with invalid row range");
+    if (numRows == 0) return;
+    m_writingImpl->setRawRows(dataIn, firstIndex, numRows);
+}
+
+void CiftiFile::copyRowsFrom(const CiftiFile& source, const int64_t& sourceFirstIndex, const int64_t& firstIndex, const int64_t& numRows)
+{
+    if (m_dims.size() != 2 || source.m_dims.size() != 2) throw DataFileException("copyRowsFrom called on non-2D CiftiFile");
+    if (m_dims[0] != source.m_dims[0]) throw DataFileException("copyRowsFrom called with different row lengths");
+    const int64_t rowLength = m_dims[0];
+    if (canCopyRawRowsFrom(source))
+    {
+        const int64_t rowBytes = rowLength * getRawBytesPerElement();
+        const int64_t blockRows = max(int64_t(1), min(numRows, COPY_BLOCK_BYTES / rowBytes));
+        vector<char> scratch(blockRows * rowBytes);
+        for (int64_t done = 0; done < numRows; done += blockRows)
+        {
+            const int64_t thisRows = min(blockRows, numRows - done);
+            source.getRawRows(scratch.data(), sourceFirstIndex + done, thisRows);
+            setRawRows(scratch.data(), firstIndex + done, thisRows);
+        }
+    } else {
+        const int64_t blockRows = max(int64_t(1), min(numRows, COPY_BLOCK_BYTES / (rowLength * (int64_t)sizeof(float))));
+        vector<float> scratch(blockRows * rowLength);
+        for (int64_t done = 0; done < numRows; done += blockRows)
+        {
+            const int64_t thisRows = min(blockRows, numRows - done);
+            source.getRows(scratch.data(), sourceFirstIndex + done, thisRows);
+            setRows(scratch.data(), firstIndex + done, thisRows);
+        }
+    }
+}
+
 int64_t CiftiFile::getNumberOfRows() const
 {
     if (m_dims.empty()) throw DataFileException("getNumberOfRows called on uninitialized CiftiFile");
@@ -330,6 +565,9 @@ void CiftiFile::verifyWriteImpl()
     if (m_writingImpl != NULL) return;
     CaretAssert(!m_dims.empty());//if the xml hasn't been set, then we can't do anything meaningful
     if (m_dims.empty()) throw DataFileException("setRow or setColumn attempted on uninitialized CiftiFile");
+    int16_t writingType;
+    bool doScale, autoScale;
+    getWritingStorage(writingType, doScale, autoScale);
     if (m_writingFile == "")
     {
         if (m_readingImpl != NULL)
@@ -338,6 +576,22 @@ void CiftiFile::verifyWriteImpl()
         } else {
             m_writingImpl.grabNew(new CiftiMemoryImpl(m_xml));
         }
+    } else if (autoScale) {//the scaling isn't known until all data is set, so keep it in memory until writeFile()
+        int64_t totalBytes = sizeof(float);
+        for (int i = 0; i < (int)m_dims.size(); ++i)
+        {
+            totalBytes *= m_dims[i];
+        }
+        if (totalBytes > AUTO_SCALE_MEMORY_BYTES)
+        {
+            throw DataFileException("output file '" + m_writingFile + "' is too large to find its data range in memory, specify the scaling range for the output datatype (-cifti-output-range)");
+        }
+        CaretPointer<WriteImplInterface> tempWrite(new CiftiMemoryImpl(m_xml));
+        if (m_readingImpl != NULL)
+        {
+            copyImplData(m_readingImpl, tempWrite, m_dims);
+        }
+        m_writingImpl = tempWrite;
     } else {//NOTE: m_onDiskVersion gets set in setWritingFile
         if (m_readingImpl != NULL)
         {
@@ -351,7 +605,8 @@ void CiftiFile::verifyWriteImpl()
                 }
             }
         }
-        m_writingImpl.grabNew(new CiftiOnDiskImpl(m_writingFile, m_xml, m_onDiskVersion, shouldSwap(m_endianPref)));//this constructor makes new file for writing
+        m_writingImpl.grabNew(new CiftiOnDiskImpl(m_writingFile, m_xml, m_onDiskVersion, shouldSwap(m_endianPref),
+                                                  writingType, doScale, m_minScale, m_maxScale));//this constructor makes new file for writing
         if (m_readingImpl != NULL)
         {
             copyImplData(m_readingImpl, m_writingImpl, m_dims);
@@ -360,6 +615,23 @@ void CiftiFile::verifyWriteImpl()
     m_readingImpl = m_writingImpl;//read-only implementations are set up in specialized functions
 }
 
+void CiftiFile::getWritingStorage(int16_t& typeOut, bool& doScaleOut, bool& autoScaleOut) const
+{
+    typeOut = m_writingDataType;
+    doScaleOut = m_doScale;
+    autoScaleOut = m_autoScale;
+    for (int i = 0; i < m_xml.getNumberOfDimensions(); ++i)
+    {
+        if (m_xml.getMappingType(i) == CiftiMappingType::LABELS)
+        {//label keys must come back exactly, so no scaling, and no integer type that can't hold every key
+            doScaleOut = false;
+            autoScaleOut = false;
+            if (typeOut != NIFTI_TYPE_INT32 && typeOut != NIFTI_TYPE_FLOAT64) typeOut = NIFTI_TYPE_FLOAT32;
+            return;
+        }
+    }
+}
+
 void CiftiFile::copyImplData(const ReadImplInterface* from, WriteImplInterface* to, const vector<int64_t>& dims)
 {
     vector<int64_t> iterateDims(dims.begin() + 1, dims.end());
@@ -371,6 +643,33 @@ void CiftiFile::copyImplData(const ReadImplInterface* from, WriteImplInterface*
     }
 }
 
+void CiftiFile::findDataRange(const ReadImplInterface* from, const vector<int64_t>& dims, double& minOut, double& maxOut)
+{
+    vector<int64_t> iterateDims(dims.begin() + 1, dims.end());
+    vector<float> scratchRow(dims[0]);
+    bool first = true;
+    minOut = 0.0;//in case there are no numeric values
+    maxOut = 0.0;
+    for (MultiDimIterator<int64_t> iter(iterateDims); !iter.atEnd(); ++iter)
+    {
+        from->getRow(scratchRow.data(), *iter, false);
+        for (int64_t i = 0; i < dims[0]; ++i)
+        {
+            const float value = scratchRow[i];
+            if (!MathFunctions::isNumeric(value)) continue;//these get saturated or zeroed when written as integers
+            if (first)
+            {
+                minOut = value;
+                maxOut = value;
+                first = false;
+            } else {
+                if (value < minOut) minOut = value;
+                if (value > maxOut) maxOut = value;
+            }
+        }
+    }
+}
+
 CiftiMemoryImpl::CiftiMemoryImpl(const CiftiXML& xml)
 {
     CaretAssert(xml.getNumberOfDimensions() != 0);
@@ -569,11 +868,17 @@ namespace
     }
 }
 
-CiftiOnDiskImpl::CiftiOnDiskImpl(const QString& filename, const CiftiXML& xml, const CiftiVersion& version, const bool& swapEndian)
+CiftiOnDiskImpl::CiftiOnDiskImpl(const QString& filename, const CiftiXML& xml, const CiftiVersion& version, const bool& swapEndian,
+                                 const int16_t& dataType, const bool& doScale, const double& minScale, const double& maxScale)
 {//starts writing new file
     warnForBadExtension(filename, xml);
     NiftiHeader outHeader;
-    outHeader.setDataType(NIFTI_TYPE_FLOAT32);//actually redundant currently, default is float32
+    outHeader.setDataType(dataType);
+    double mult, offset;
+    if (getScaling(dataType, doScale, minScale, maxScale, mult, offset))
+    {//NiftiIO does the conversion both ways
+        outHeader.setDataScaling(mult, offset);
+    }
     char intentName[16];
     int32_t intentCode = xml.getIntentInfo(version, intentName);
     outHeader.setIntent(intentCode, intentName);
@@ -607,11 +912,32 @@ CiftiOnDiskImpl::CiftiOnDiskImpl(const QString& filename, const CiftiXML& xml, c
     m_xml = xml;
 }
 
+bool CiftiOnDiskImpl::hasStorage(const int16_t& dataType, const bool& doScale, const double& minScale, const double& maxScale) const
+{
+    if (m_nifti.getHeader().getDataType() != dataType) return false;
+    double mult, offset, fileMult, fileOffset;
+    bool scaled = getScaling(dataType, doScale, minScale, maxScale, mult, offset);
+    if (m_nifti.getHeader().getDataScaling(fileMult, fileOffset) != scaled) return false;
+    return (!scaled || (mult == fileMult && offset == fileOffset));
+}
+
 void CiftiOnDiskImpl::getRow(float* dataOut, const vector<int64_t>& indexSelect, const bool& tolerateShortRead) const
 {
     m_nifti.readData(dataOut, 5, indexSelect, tolerateShortRead);//5 means 4 reserved (space and time) plus the first cifti dimension
 }
 
+void CiftiOnDiskImpl::getRows(float* dataOut, const int64_t& firstIndex, const int64_t& numRows, const int64_t&) const
+{
+    vector<int64_t> indexSelect(1, firstIndex);
+    m_nifti.readConsecutiveData(dataOut, 5, indexSelect, numRows);//rows are adjacent on disk, so this is one seek and one read
+}
+
+void CiftiOnDiskImpl::getRawRows(char* dataOut, const int64_t& firstIndex, const int64_t& numRows) const
+{
+    vector<int64_t> indexSelect(1, firstIndex);
+    m_nifti.readConsecutiveRaw(dataOut, 5, indexSelect, numRows);
+}
+
 void CiftiOnDiskImpl::getColumn(float* dataOut, const int64_t& index) const
 {
     CaretAssert(m_xml.getNumberOfDimensions() == 2);//otherwise this shouldn't be called
@@ -632,6 +958,18 @@ void CiftiOnDiskImpl::setRow(const float* dataIn, const vector<int64_t>& indexSe
     m_nifti.writeData(dataIn, 5, indexSelect);
 }
 
+void CiftiOnDiskImpl::setRows(const float* dataIn, const int64_t& firstIndex, const int64_t& numRows, const int64_t&)
+{
+    vector<int64_t> indexSelect(1, firstIndex);
+    m_nifti.writeConsecutiveData(dataIn, 5, indexSelect, numRows);
+}
+
+void CiftiOnDiskImpl::setRawRows(const char* dataIn, const int64_t& firstIndex, const int64_t& numRows)
+{
+    vector<int64_t> indexSelect(1, firstIndex);
+    m_nifti.writeConsecutiveRaw(dataIn, 5, indexSelect, numRows);
+}
+
 void CiftiOnDiskImpl::setColumn(const float* dataIn, const int64_t& index)
 {
     CaretAssert(m_xml.getNumberOfDimensions() == 2);//otherwise this shouldn't be called
@@ -26,6 +26,7 @@
 #include "CiftiXML.h"
 #include "CiftiXMLOld.h"
 #include "MultiDimIterator.h"
+#include "nifti1.h"
 
 #include <QString>
 
@@ -45,7 +46,7 @@ namespace caret
             BIG
         };
 
-        CiftiFile() { m_endianPref = NATIVE; }
+        CiftiFile() { m_endianPref = NATIVE; setWritingDataTypeNoScaling(); }
         explicit CiftiFile(const QString &fileName);//calls openFile
         void openFile(const QString& fileName);//starts on-disk reading
         void openURL(const QString& url, const QString& user, const QString& pass);//open from XNAT
@@ -53,6 +54,13 @@ namespace caret
         void setWritingFile(const QString& fileName, const CiftiVersion& writingVersion = CiftiVersion(), const ENDIAN& endian = NATIVE);//starts on-disk writing
         void writeFile(const QString& fileName, const CiftiVersion& writingVersion = CiftiVersion(), const ENDIAN& endian = ANY);//leaves current state as-is, rewrites if already writing to that filename and version mismatch
         void convertToInMemory();
+        
+        //storage of files written after these are called, reading converts back to float transparently
+        void setWritingDataTypeNoScaling(const int16_t& type = NIFTI_TYPE_FLOAT32);//integer types round to nearest and saturate
+        void setWritingDataTypeAndScaling(const int16_t& type, const double& minval, const double& maxval);//[minval, maxval] uses the full range of an integer type
+        void setWritingDataTypeAutoScaling(const int16_t& type);//scaling from the min and max of the data, kept in memory until writeFile() if the range isn't known first, too-large on-disk outputs throw
+        //files with a label mapping are never scaled, and use float32 unless int32 or float64 was requested, so that label keys stay exact
+        void setDataRangeHint(const double& minval, const double& maxval);//for algorithms that know their output range, replaces the min/max pass of auto scaling
         QString getFileName() const { return m_fileName; }
         
         bool isInMemory() const;
@@ -71,17 +79,28 @@ namespace caret
         
         void getRow(float* dataOut, const int64_t& index, const bool& tolerateShortRead) const;//backwards compatibility for old CiftiFile/CiftiInterface
         void getRow(float* dataOut, const int64_t& index) const;
+        void getRows(float* dataOut, const int64_t& firstIndex, const int64_t& numRows) const;//for 2D only, reads adjacent rows with a single file access when on disk
         int64_t getNumberOfRows() const;
         int64_t getNumberOfColumns() const;
         
         void setRow(const float* dataIn, const int64_t& index);//backwards compatibility for old CiftiFile
+        void setRows(const float* dataIn, const int64_t& firstIndex, const int64_t& numRows);//for 2D only, writes adjacent rows with a single file access when on disk
+        
+        //copying rows without conversion, for 2D files where this is writing on disk and the source is on disk with the same data type, scaling and byte order
+        bool canCopyRawRowsFrom(const CiftiFile& source) const;
+        int getRawBytesPerElement() const;//of the writing data type
+        void getRawRows(char* dataOut, const int64_t& firstIndex, const int64_t& numRows) const;//only when canCopyRawRowsFrom() was true for this as the source
+        void setRawRows(const char* dataIn, const int64_t& firstIndex, const int64_t& numRows);//only when canCopyRawRowsFrom() was true
+        void copyRowsFrom(const CiftiFile& source, const int64_t& sourceFirstIndex, const int64_t& firstIndex, const int64_t& numRows);//rows must be the same length, copies large blocks, as bytes when possible
         
         class ReadImplInterface
         {
         public:
             virtual void getRow(float* dataOut, const std::vector<int64_t>& indexSelect, const bool& tolerateShortRead) const = 0;
             virtual void getColumn(float* dataOut, const int64_t& index) const = 0;
+            virtual void getRows(float* dataOut, const int64_t& firstIndex, const int64_t& numRows, const int64_t& rowLength) const;//default calls getRow for each row
             virtual bool isInMemory() const { return false; }
+            virtual void getRawRows(char* dataOut, const int64_t& firstIndex, const int64_t& numRows) const;//default throws, only on-disk can do this
             virtual ~ReadImplInterface();
         };
         //assume if you can write to it, you can also read from it
@@ -90,6 +109,8 @@ namespace caret
         public:
             virtual void setRow(const float* dataIn, const std::vector<int64_t>& indexSelect) = 0;
             virtual void setColumn(const float* dataIn, const int64_t& index) = 0;
+            virtual void setRows(const float* dataIn, const int64_t& firstIndex, const int64_t& numRows, const int64_t& rowLength);//default calls setRow for each row
+            virtual void setRawRows(const char* dataIn, const int64_t& firstIndex, const int64_t& numRows);//default throws
             virtual ~WriteImplInterface();
         };
     private:
@@ -100,9 +121,14 @@ namespace caret
         //CiftiXML m_xml;//uncomment when we drop CiftiInterface
         CiftiVersion m_onDiskVersion;
         ENDIAN m_endianPref;
+        int16_t m_writingDataType;
+        bool m_doScale, m_autoScale;//m_autoScale means m_minScale and m_maxScale aren't known yet
+        double m_minScale, m_maxScale;
         
         void verifyWriteImpl();
+        void getWritingStorage(int16_t& typeOut, bool& doScaleOut, bool& autoScaleOut) const;//what the requested storage means for the current xml
         static void copyImplData(const ReadImplInterface* from, WriteImplInterface* to, const std::vector<int64_t>& dims);
+        static void findDataRange(const ReadImplInterface* from, const std::vector<int64_t>& dims, double& minOut, double& maxOut);
     };
     
 }
@@ -0,0 +1,147 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2016  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "CiftiIndexText.h"
+
+#include "CaretException.h"
+
+#include <limits>
+
+using namespace caret;
+using namespace std;
+
+namespace
+{
+    const uint64_t MAX_POSITIVE = (uint64_t)numeric_limits<int64_t>::max(), MAX_NEGATIVE = MAX_POSITIVE + 1;
+    
+    inline bool isSeparator(const QChar& c)
+    {
+        ushort code = c.unicode();
+        if (code == ' ' || code == '\n' || code == '\t' || code == '\r') return true;
+        if (code < 128) return (code == '\v' || code == '\f');
+        return c.isSpace();//same whitespace as QRegExp("\\s+")
+    }
+    
+    inline bool isDigit(const ushort& code)
+    {
+        return code >= '0' && code <= '9';
+    }
+    
+    //accumulate a digit, returns false if it doesn't fit under the limit
+    inline bool addDigit(uint64_t& accum, const ushort& code, const uint64_t& limit)
+    {
+        uint64_t digit = code - '0';
+        if (accum > (limit - digit) / 10) return false;
+        accum = accum * 10 + digit;
+        return true;
+    }
+}
+
+void CiftiIndexText::parseIntegers(const QString& text, vector<int64_t>& listOut, const bool& allowNegative)
+{
+    const QChar* data = text.constData();
+    const int length = text.size();
+    int pos = 0;
+    while (true)
+    {
+        while (pos < length && isSeparator(data[pos])) ++pos;
+        if (pos >= length) break;
+        const int tokenStart = pos;
+        while (pos < length && !isSeparator(data[pos])) ++pos;
+        int digitPos = tokenStart;
+        bool negative = false;
+        if (data[digitPos].unicode() == '-' || data[digitPos].unicode() == '+')
+        {
+            negative = (data[digitPos].unicode() == '-');
+            ++digitPos;
+        }
+        bool ok = (digitPos < pos);
+        uint64_t accum = 0;
+        const uint64_t limit = (negative ? MAX_NEGATIVE : MAX_POSITIVE);
+        for (int i = digitPos; ok && i < pos; ++i)
+        {
+            ushort code = data[i].unicode();
+            ok = isDigit(code) && addDigit(accum, code, limit);
+        }
+        if (!ok)
+        {
+            throw CaretException("found noninteger in index array: " + QString(data + tokenStart, pos - tokenStart));
+        }
+        if (negative && accum != 0)
+        {
+            if (!allowNegative)
+            {
+                throw CaretException("found negative integer in index array: " + QString(data + tokenStart, pos - tokenStart));
+            }
+            listOut.push_back((int64_t)(~accum + 1));//two's complement, also handles INT64_MIN
+        } else {
+            listOut.push_back((int64_t)accum);
+        }
+    }
+}
+
+bool CiftiIndexText::parseDigitRuns(const QString& text, vector<int64_t>& listOut, QString& badTokenOut)
+{
+    const QChar* data = text.constData();
+    const int length = text.size();
+    int pos = 0;
+    while (true)
+    {
+        while (pos < length && !isDigit(data[pos].unicode())) ++pos;
+        if (pos >= length) break;
+        const int tokenStart = pos;
+        uint64_t accum = 0;
+        bool ok = true;
+        for (; pos < length && isDigit(data[pos].unicode()); ++pos)
+        {
+            if (ok) ok = addDigit(accum, data[pos].unicode(), MAX_POSITIVE);
+        }
+        if (!ok)
+        {
+            badTokenOut = QString(data + tokenStart, pos - tokenStart);
+            return false;
+        }
+        listOut.push_back((int64_t)accum);
+    }
+    return true;
+}
+
+void CiftiIndexText::appendNumber(const int64_t& value)
+{
+    char digits[24];
+    int numDigits = 0;
+    uint64_t magnitude = (value < 0 ? ~(uint64_t)value + 1 : (uint64_t)value);
+    do
+    {
+        digits[numDigits++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0) m_buffer.push_back('-');
+    while (numDigits > 0)
+    {
+        m_buffer.push_back(digits[--numDigits]);
+    }
+}
+
+QString CiftiIndexText::toString() const
+{
+    if (m_buffer.empty()) return QString();
+    return QString::fromLatin1(m_buffer.data(), (int)m_buffer.size());
+}
@@ -0,0 +1,52 @@
+#ifndef __CIFTI_INDEX_TEXT_H__
+#define __CIFTI_INDEX_TEXT_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2016  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include <QString>
+
+#include "stdint.h"
+#include <vector>
+
+namespace caret
+{
+    ///conversion of the integer lists in cifti XML (vertex and voxel indices) without a QString per number
+    class CiftiIndexText
+    {
+        std::vector<char> m_buffer;
+    public:
+        ///parse whitespace-separated integers, throws CaretException naming the first token that isn't an integer (or is negative, when not allowed)
+        static void parseIntegers(const QString& text, std::vector<int64_t>& listOut, const bool& allowNegative);
+        
+        ///append every run of digits, ignoring anything else (the lenient parsing the cifti-1 reader has always done)
+        ///returns false and sets badTokenOut if a run doesn't fit in 64 bits
+        static bool parseDigitRuns(const QString& text, std::vector<int64_t>& listOut, QString& badTokenOut);
+        
+        ///for writing: append numbers and separators, then get the text to write with toString()
+        void appendNumber(const int64_t& value);
+        void appendSeparator(const char& separator) { m_buffer.push_back(separator); }
+        void reserve(const int64_t& numChars) { m_buffer.reserve(numChars); }
+        bool isEmpty() const { return m_buffer.empty(); }
+        QString toString() const;
+    };
+}
+
+#endif //__CIFTI_INDEX_TEXT_H__
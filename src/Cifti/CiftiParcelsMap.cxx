@@ -22,9 +22,9 @@
 
 #include "CaretException.h"
 #include "CaretLogger.h"
+#include "CiftiIndexText.h"
 
 #include <QStringList>
-#include <QRegExp>
 
 using namespace std;
 using namespace caret;
@@ -628,18 +628,7 @@ vector<int64_t> CiftiParcelsMap::readIndexArray(QXmlStreamReader& xml)
     vector<int64_t> ret;
     QString text = xml.readElementText();//raises error if it encounters a start element
     if (xml.hasError()) return ret;
-    QStringList separated = text.split(QRegExp("\\s+"), QString::SkipEmptyParts);
-    int64_t numElems = separated.size();
-    ret.reserve(numElems);
-    for (int64_t i = 0; i < numElems; ++i)
-    {
-        bool ok = false;
-        ret.push_back(separated[i].toLongLong(&ok));
-        if (!ok)
-        {
-            throw CaretException("found noninteger in index array: " + separated[i]);
-        }
-    }
+    CiftiIndexText::parseIntegers(text, ret, true);
     return ret;
 }
 
@@ -664,10 +653,18 @@ void CiftiParcelsMap::writeXML1(QXmlStreamWriter& xml) const
         if (numVoxels != 0)
         {
             xml.writeStartElement("VoxelIndicesIJK");
+            CiftiIndexText text;
+            text.reserve(numVoxels * 9);
             for (set<VoxelIJK>::const_iterator iter = m_parcels[i].m_voxelIndices.begin(); iter != m_parcels[i].m_voxelIndices.end(); ++iter)
             {
-                xml.writeCharacters(QString::number(iter->m_ijk[0]) + " " + QString::number(iter->m_ijk[1]) + " " + QString::number(iter->m_ijk[2]) + "\n");
+                text.appendNumber(iter->m_ijk[0]);
+                text.appendSeparator(' ');
+                text.appendNumber(iter->m_ijk[1]);
+                text.appendSeparator(' ');
+                text.appendNumber(iter->m_ijk[2]);
+                text.appendSeparator('\n');
             }
+            xml.writeCharacters(text.toString());
             xml.writeEndElement();
         }
         for (map<StructureEnum::Enum, set<int64_t> >::const_iterator iter = m_parcels[i].m_surfaceNodes.begin(); iter != m_parcels[i].m_surfaceNodes.end(); ++iter)
@@ -676,13 +673,17 @@ void CiftiParcelsMap::writeXML1(QXmlStreamWriter& xml) const
             {
                 xml.writeStartElement("Nodes");
                 xml.writeAttribute("BrainStructure", StructureEnum::toCiftiName(iter->first));
+                CiftiIndexText text;
+                text.reserve(iter->second.size() * 7);
                 set<int64_t>::const_iterator iter2 = iter->second.begin();//which also allows us to write the first one outside the loop, to not add whitespace on the front or back
-                xml.writeCharacters(QString::number(*iter2));
+                text.appendNumber(*iter2);
                 ++iter2;
                 for (; iter2 != iter->second.end(); ++iter2)
                 {
-                    xml.writeCharacters(" " + QString::number(*iter2));
+                    text.appendSeparator(' ');
+                    text.appendNumber(*iter2);
                 }
+                xml.writeCharacters(text.toString());
                 xml.writeEndElement();
             }
         }
@@ -714,10 +715,18 @@ void CiftiParcelsMap::writeXML2(QXmlStreamWriter& xml) const
         if (numVoxels != 0)
         {
             xml.writeStartElement("VoxelIndicesIJK");
+            CiftiIndexText text;
+            text.reserve(numVoxels * 9);
             for (set<VoxelIJK>::const_iterator iter = m_parcels[i].m_voxelIndices.begin(); iter != m_parcels[i].m_voxelIndices.end(); ++iter)
             {
-                xml.writeCharacters(QString::number(iter->m_ijk[0]) + " " + QString::number(iter->m_ijk[1]) + " " + QString::number(iter->m_ijk[2]) + "\n");
+                text.appendNumber(iter->m_ijk[0]);
+                text.appendSeparator(' ');
+                text.appendNumber(iter->m_ijk[1]);
+                text.appendSeparator(' ');
+                text.appendNumber(iter->m_ijk[2]);
+                text.appendSeparator('\n');
             }
+            xml.writeCharacters(text.toString());
             xml.writeEndElement();
         }
         for (map<StructureEnum::Enum, set<int64_t> >::const_iterator iter = m_parcels[i].m_surfaceNodes.begin(); iter != m_parcels[i].m_surfaceNodes.end(); ++iter)
@@ -726,13 +735,17 @@ void CiftiParcelsMap::writeXML2(QXmlStreamWriter& xml) const
             {
                 xml.writeStartElement("Vertices");
                 xml.writeAttribute("BrainStructure", StructureEnum::toCiftiName(iter->first));
+                CiftiIndexText text;
+                text.reserve(iter->second.size() * 7);
                 set<int64_t>::const_iterator iter2 = iter->second.begin();//which also allows us to write the first one outside the loop, to not add whitespace on the front or back
-                xml.writeCharacters(QString::number(*iter2));
+                text.appendNumber(*iter2);
                 ++iter2;
                 for (; iter2 != iter->second.end(); ++iter2)
                 {
-                    xml.writeCharacters(" " + QString::number(*iter2));
+                    text.appendSeparator(' ');
+                    text.appendNumber(*iter2);
                 }
+                xml.writeCharacters(text.toString());
                 xml.writeEndElement();
             }
         }
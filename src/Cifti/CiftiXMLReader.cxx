@@ -21,6 +21,7 @@
 #include <stdio.h>
 #include <QtCore>
 #include "CaretLogger.h"
+#include "CiftiIndexText.h"
 #include "CiftiXMLElements.h"
 #include "CiftiXMLReader.h"
 #include "DataFileException.h"
@@ -441,20 +442,13 @@ void CiftiXMLReader::parseBrainModel(QXmlStreamReader &xml, CiftiBrainModelEleme
                 if(xml.tokenType() != QXmlStreamReader::Characters) {
                     return;
                 }
-                QString nodeIndices = xml.text().toString();
-
-                QStringList list = nodeIndices.split(QRegExp("\\D+"),QString::SkipEmptyParts);
-                bool ok = true;
-                for(int i = 0;i<list.count();i++)
+                QString badToken;
+                bool ok = CiftiIndexText::parseDigitRuns(xml.text().toString(), brainModel.m_nodeIndices, badToken);
+                if (!ok)
                 {
-                    brainModel.m_nodeIndices.push_back(list[i].toULongLong(&ok));
-                    if (!ok)
-                    {
-                        xml.raiseError("count not parse '" + list[i] + "' as node index");
-                        break;
-                    }
+                    xml.raiseError("count not parse '" + badToken + "' as node index");
+                    break;
                 }
-                if (!ok) break;
                 //get end element
                 xml.readNext();
                 if(!xml.isEndElement())
@@ -469,21 +463,16 @@ void CiftiXMLReader::parseBrainModel(QXmlStreamReader &xml, CiftiBrainModelEleme
                 if(xml.tokenType() != QXmlStreamReader::Characters) {
                     return;
                 }
-                QString voxelIndicesIJK = xml.text().toString();
-
-                QStringList list = voxelIndicesIJK.split(QRegExp("\\D+"),QString::SkipEmptyParts);
-                if(list.count()%3) xml.raiseError("VoxelIndicesIJK has an incomplete triplet");
-                bool ok = true;
-                for(int i = 0;i<list.count();i++)
+                vector<int64_t> list;
+                QString badToken;
+                bool ok = CiftiIndexText::parseDigitRuns(xml.text().toString(), list, badToken);
+                if (!ok)
                 {
-                    brainModel.m_voxelIndicesIJK.push_back(list[i].toULongLong(&ok));
-                    if (!ok)
-                    {
-                        xml.raiseError("count not parse '" + list[i] + "' as voxel index");
-                        break;
-                    }
+                    xml.raiseError("count not parse '" + badToken + "' as voxel index");
+                    break;
                 }
-                if (!ok) break;
+                if(list.size()%3) xml.raiseError("VoxelIndicesIJK has an incomplete triplet");
+                brainModel.m_voxelIndicesIJK.insert(brainModel.m_voxelIndicesIJK.end(), list.begin(), list.end());
                 //get end element
                 xml.readNext();
                 if(!xml.isEndElement()|| (xml.name().toString() != "VoxelIndicesIJK"))
@@ -585,18 +574,14 @@ void CiftiXMLReader::parseParcel(QXmlStreamReader& xml, CiftiParcelElement& parc
                 xml.readNext();
                 if(xml.tokenType() == QXmlStreamReader::Characters)
                 {
-                    QString voxelIndicesIJK = xml.text().toString();
-                    QStringList list = voxelIndicesIJK.split(QRegExp("\\D+"),QString::SkipEmptyParts);
-                    if(list.count()%3) xml.raiseError("VoxelIndicesIJK has an incomplete triplet");
-                    bool ok = true;
-                    for(int i = 0;i<list.count();i++)
+                    vector<int64_t> list;
+                    QString badToken;
+                    if (CiftiIndexText::parseDigitRuns(xml.text().toString(), list, badToken))
                     {
-                        parcel.m_voxelIndicesIJK.push_back(list[i].toULongLong(&ok));
-                        if (!ok)
-                        {
-                            xml.raiseError("count not parse '" + list[i] + "' as voxel index");
-                            break;
-                        }
+                        if(list.size()%3) xml.raiseError("VoxelIndicesIJK has an incomplete triplet");
+                        parcel.m_voxelIndicesIJK.insert(parcel.m_voxelIndicesIJK.end(), list.begin(), list.end());
+                    } else {
+                        xml.raiseError("count not parse '" + badToken + "' as voxel index");
                     }
                     xml.readNext();
                     if (!xml.isEndElement() || xml.name() != "VoxelIndicesIJK")
@@ -633,17 +618,10 @@ void CiftiXMLReader::parseParcelNodes(QXmlStreamReader& xml, CiftiParcelNodesEle
     xml.readNext();
     if (xml.isCharacters())
     {
-        QString nodeIndices = xml.text().toString();
-        QStringList list = nodeIndices.split(QRegExp("\\D+"),QString::SkipEmptyParts);
-        bool ok = true;
-        for(int i = 0;i<list.count();i++)
+        QString badToken;
+        if (!CiftiIndexText::parseDigitRuns(xml.text().toString(), parcelNodes.m_nodes, badToken))
         {
-            parcelNodes.m_nodes.push_back(list[i].toULongLong(&ok));
-            if (!ok)
-            {
-                xml.raiseError("count not parse '" + list[i] + "' as node index");
-                break;
-            }
+            xml.raiseError("count not parse '" + badToken + "' as node index");
         }
         xml.readNext();
     } else {
@@ -19,6 +19,7 @@
 /*LICENSE_END*/
 
 #include "CiftiXMLWriter.h"
+#include "CiftiIndexText.h"
 #include "GiftiLabelTable.h"
 #include "PaletteColorMapping.h"
 
@@ -207,12 +208,15 @@ void CiftiXMLWriter::writeBrainModel(QXmlStreamWriter &xml, const CiftiBrainMode
     {
         xml.writeStartElement("NodeIndices");
         lastnodeIndex--;
-        for(unsigned int i = 0;i<lastnodeIndex;i++)
+        CiftiIndexText text;
+        text.reserve(brainModel.m_nodeIndices.size() * 7);
+        for(unsigned long long i = 0;i<lastnodeIndex;i++)
         {
-            xml.writeCharacters(QString::number(brainModel.m_nodeIndices[i]));
-            xml.writeCharacters(" ");
+            text.appendNumber(brainModel.m_nodeIndices[i]);
+            text.appendSeparator(' ');
         }
-        xml.writeCharacters(QString::number(brainModel.m_nodeIndices[lastnodeIndex]));
+        text.appendNumber(brainModel.m_nodeIndices[lastnodeIndex]);
+        xml.writeCharacters(text.toString());
         xml.writeEndElement();//NodeIndices
     }
 
@@ -223,7 +227,6 @@ void CiftiXMLWriter::writeBrainModel(QXmlStreamWriter &xml, const CiftiBrainMode
     if(lastVoxelIndex)
     {
         xml.writeStartElement("VoxelIndicesIJK");
-        QString line( "%1 %2 %3\n");
         if((lastVoxelIndex%3))
         {
             std::cout << "Error writing BrainModel, invalid number of voxel indices:" << lastVoxelIndex << std::endl;
@@ -232,10 +235,18 @@ void CiftiXMLWriter::writeBrainModel(QXmlStreamWriter &xml, const CiftiBrainMode
         //else
         //std::cout << "voxel indices ok:" << lastVoxelIndex<< std::endl;
 
-        for(unsigned int i = 0;i < lastVoxelIndex;i+=3)
+        CiftiIndexText text;
+        text.reserve(lastVoxelIndex * 3);
+        for(unsigned long long i = 0;i < lastVoxelIndex;i+=3)
         {
-            xml.writeCharacters(line.arg(QString::number(ind[i]),QString::number(ind[i+1]),QString::number(ind[i+2])));
+            text.appendNumber(ind[i]);
+            text.appendSeparator(' ');
+            text.appendNumber(ind[i+1]);
+            text.appendSeparator(' ');
+            text.appendNumber(ind[i+2]);
+            text.appendSeparator('\n');
         }
+        xml.writeCharacters(text.toString());
         xml.writeEndElement();//voxelIndicesIJK
     }
 
@@ -282,20 +293,23 @@ void CiftiXMLWriter::writeParcel(QXmlStreamWriter& xml, const CiftiParcelElement
     if (numVoxInds > 0)
     {
         xml.writeStartElement("VoxelIndicesIJK");
-        xml.writeCharacters(AString::number(parcel.m_voxelIndicesIJK[0]));
+        CiftiIndexText text;
+        text.reserve(numVoxInds * 3);
+        text.appendNumber(parcel.m_voxelIndicesIJK[0]);
         int state = 0;
         for (int i = 1; i < numVoxInds; ++i)
         {
             if (state >= 2)
             {
                 state = 0;
-                xml.writeCharacters("\n");
+                text.appendSeparator('\n');
             } else {
                 ++state;
-                xml.writeCharacters(" ");
+                text.appendSeparator(' ');
             }
-            xml.writeCharacters(AString::number(parcel.m_voxelIndicesIJK[i]));
+            text.appendNumber(parcel.m_voxelIndicesIJK[i]);
         }
+        xml.writeCharacters(text.toString());
         xml.writeEndElement();
     }
     xml.writeEndElement();
@@ -308,12 +322,15 @@ void CiftiXMLWriter::writeParcelNodes(QXmlStreamWriter& xml, const CiftiParcelNo
     {
         xml.writeStartElement("Nodes");
         xml.writeAttribute("BrainStructure", StructureEnum::toCiftiName(parcelNodes.m_structure));
-        xml.writeCharacters(AString::number(parcelNodes.m_nodes[0]));
+        CiftiIndexText text;
+        text.reserve(numNodes * 7);
+        text.appendNumber(parcelNodes.m_nodes[0]);
         for (int i = 1; i < numNodes; ++i)
         {
-            xml.writeCharacters(" ");
-            xml.writeCharacters(AString::number(parcelNodes.m_nodes[i]));
+            text.appendSeparator(' ');
+            text.appendNumber(parcelNodes.m_nodes[i]);
         }
+        xml.writeCharacters(text.toString());
         xml.writeEndElement();
     }
 }
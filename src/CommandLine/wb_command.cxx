@@ -29,6 +29,7 @@
 #include "CaretHttpManager.h"
 #include "CaretCommandLine.h"
 #include "CaretLogger.h"
+#include "CaretProfiler.h"
 #include "CommandOperationManager.h"
 #include "ProgramParameters.h"
 #include "SessionManager.h"
@@ -80,6 +81,7 @@ static int runCommand(int argc, char* argv[]) {
         }
         throw;//rethrow, the runtime might print the type
     }
+    CaretProfiler::writeProfile();//does nothing unless -profile or WB_PROFILE was given, writes partial profiles of failed commands too
     
     if (commandManager != NULL) {
         CommandOperationManager::deleteCommandOperationManager();
@@ -142,6 +144,12 @@ int main(int argc, char* argv[]) {
          */
         VolumeFile::setVoxelColoringEnabled(false);
         
+        /*
+         * Read frames of large 4D volumes only when an operation uses them,
+         * so that operations on a single subvolume don't read the whole file.
+         */
+        VolumeFile::setLoadFramesOnDemand(true);
+        
         QCoreApplication myApp(argc, argv);//so that it doesn't need to link against gui
         
         result = runCommand(argc, argv);
@@ -0,0 +1,246 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2016  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "CommandFileCache.h"
+
+#include "BorderFile.h"
+#include "CiftiFile.h"
+#include "CommandException.h"
+#include "FileInformation.h"
+#include "FociFile.h"
+#include "LabelFile.h"
+#include "MetricFile.h"
+#include "SurfaceFile.h"
+#include "VolumeFile.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+CommandFileCache* CommandFileCache::s_active = NULL;
+const AString CommandFileCache::MEMORY_PREFIX = "mem:";
+const int64_t CommandFileCache::DEFAULT_MAXIMUM_BYTES = ((int64_t)1) << 32;
+
+namespace
+{
+    template <typename T>
+    CaretPointer<T> findOrRead(map<AString, CaretPointer<T> >& files, const AString& fileName)
+    {
+        const AString key = CommandFileCache::getKey(fileName);
+        typename map<AString, CaretPointer<T> >::iterator iter = files.find(key);
+        if (iter != files.end()) return iter->second;
+        if (CommandFileCache::isMemoryName(fileName))
+        {
+            throw CommandException("in-memory file '" + fileName + "' is used before any step creates it");
+        }
+        CaretPointer<T> ret(new T());
+        ret->readFile(fileName);
+        files[key] = ret;
+        return ret;
+    }
+}
+
+CommandFileCache::CommandFileCache()
+{
+    m_useCount = 0;
+    m_maximumBytes = DEFAULT_MAXIMUM_BYTES;
+}
+
+CommandFileCache::~CommandFileCache()
+{
+    if (s_active == this) s_active = NULL;
+}
+
+bool CommandFileCache::isMemoryName(const AString& fileName)
+{
+    return fileName.startsWith(MEMORY_PREFIX);
+}
+
+AString CommandFileCache::getKey(const AString& fileName)
+{
+    if (isMemoryName(fileName)) return fileName;
+    FileInformation myInfo(fileName);
+    AString ret = myInfo.getCanonicalFilePath();//resolves symlinks, but is empty if the file doesn't exist yet
+    if (ret.isEmpty()) ret = myInfo.getAbsoluteFilePath();
+    return ret;
+}
+
+CaretPointer<BorderFile> CommandFileCache::getBorder(const AString& fileName)
+{
+    CaretPointer<BorderFile> ret = findOrRead(m_borderFiles, fileName);
+    markUsed(fileName);
+    return ret;
+}
+
+CaretPointer<CiftiFile> CommandFileCache::getCifti(const AString& fileName)
+{
+    const AString key = getKey(fileName);
+    map<AString, CaretPointer<CiftiFile> >::iterator iter = m_ciftiFiles.find(key);
+    if (iter != m_ciftiFiles.end())
+    {
+        markUsed(fileName);
+        return iter->second;
+    }
+    if (isMemoryName(fileName))
+    {
+        throw CommandException("in-memory file '" + fileName + "' is used before any step creates it");
+    }
+    CaretPointer<CiftiFile> ret(new CiftiFile());
+    ret->openFile(fileName);
+    m_ciftiFiles[key] = ret;
+    markUsed(fileName);
+    return ret;
+}
+
+CaretPointer<FociFile> CommandFileCache::getFoci(const AString& fileName)
+{
+    CaretPointer<FociFile> ret = findOrRead(m_fociFiles, fileName);
+    markUsed(fileName);
+    return ret;
+}
+
+CaretPointer<LabelFile> CommandFileCache::getLabel(const AString& fileName)
+{
+    CaretPointer<LabelFile> ret = findOrRead(m_labelFiles, fileName);
+    markUsed(fileName);
+    return ret;
+}
+
+CaretPointer<MetricFile> CommandFileCache::getMetric(const AString& fileName)
+{
+    CaretPointer<MetricFile> ret = findOrRead(m_metricFiles, fileName);
+    markUsed(fileName);
+    return ret;
+}
+
+CaretPointer<SurfaceFile> CommandFileCache::getSurface(const AString& fileName)
+{
+    CaretPointer<SurfaceFile> ret = findOrRead(m_surfaceFiles, fileName);
+    markUsed(fileName);
+    return ret;
+}
+
+CaretPointer<VolumeFile> CommandFileCache::getVolume(const AString& fileName)
+{
+    CaretPointer<VolumeFile> ret = findOrRead(m_volumeFiles, fileName);
+    markUsed(fileName);
+    return ret;
+}
+
+void CommandFileCache::store(const AString& fileName, const CaretPointer<BorderFile>& file)
+{
+    forget(fileName);//a name can only be one type of file
+    m_borderFiles[getKey(fileName)] = file;
+    markUsed(fileName);
+}
+
+void CommandFileCache::store(const AString& fileName, const CaretPointer<CiftiFile>& file)
+{
+    forget(fileName);
+    m_ciftiFiles[getKey(fileName)] = file;
+    markUsed(fileName);
+}
+
+void CommandFileCache::store(const AString& fileName, const CaretPointer<FociFile>& file)
+{
+    forget(fileName);
+    m_fociFiles[getKey(fileName)] = file;
+    markUsed(fileName);
+}
+
+void CommandFileCache::store(const AString& fileName, const CaretPointer<LabelFile>& file)
+{
+    forget(fileName);
+    m_labelFiles[getKey(fileName)] = file;
+    markUsed(fileName);
+}
+
+void CommandFileCache::store(const AString& fileName, const CaretPointer<MetricFile>& file)
+{
+    forget(fileName);
+    m_metricFiles[getKey(fileName)] = file;
+    markUsed(fileName);
+}
+
+void CommandFileCache::store(const AString& fileName, const CaretPointer<SurfaceFile>& file)
+{
+    forget(fileName);
+    m_surfaceFiles[getKey(fileName)] = file;
+    markUsed(fileName);
+}
+
+void CommandFileCache::store(const AString& fileName, const CaretPointer<VolumeFile>& file)
+{
+    forget(fileName);
+    m_volumeFiles[getKey(fileName)] = file;
+    markUsed(fileName);
+}
+
+void CommandFileCache::forget(const AString& fileName)
+{
+    const AString key = getKey(fileName);
+    m_borderFiles.erase(key);
+    m_ciftiFiles.erase(key);//closes the file, if nothing else is using it
+    m_fociFiles.erase(key);
+    m_labelFiles.erase(key);
+    m_metricFiles.erase(key);
+    m_surfaceFiles.erase(key);
+    m_volumeFiles.erase(key);
+    m_lastUse.erase(key);
+}
+
+void CommandFileCache::markUsed(const AString& fileName)
+{
+    m_lastUse[getKey(fileName)] = m_useCount;
+    ++m_useCount;
+}
+
+void CommandFileCache::trim()
+{
+    vector<pair<int64_t, AString> > diskFiles;//last use, key
+    int64_t totalBytes = 0;
+    for (map<AString, int64_t>::iterator iter = m_lastUse.begin(); iter != m_lastUse.end(); ++iter)
+    {
+        if (isMemoryName(iter->first)) continue;
+        diskFiles.push_back(make_pair(iter->second, iter->first));
+        totalBytes += FileInformation(iter->first).size();//size in memory can be larger, but this is a good enough measure for which files to drop
+    }
+    sort(diskFiles.begin(), diskFiles.end());//least recently used first
+    for (int64_t i = 0; i < (int64_t)diskFiles.size() && totalBytes > m_maximumBytes; ++i)
+    {
+        totalBytes -= FileInformation(diskFiles[i].second).size();
+        forget(diskFiles[i].second);//key is an absolute path, so it gives the same key again
+    }
+}
+
+void CommandFileCache::clear()
+{
+    m_borderFiles.clear();
+    m_ciftiFiles.clear();
+    m_fociFiles.clear();
+    m_labelFiles.clear();
+    m_metricFiles.clear();
+    m_surfaceFiles.clear();
+    m_volumeFiles.clear();
+    m_lastUse.clear();
+}
@@ -0,0 +1,107 @@
+#ifndef __COMMAND_FILE_CACHE_H__
+#define __COMMAND_FILE_CACHE_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2016  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "AString.h"
+#include "CaretPointer.h"
+
+#include <map>
+
+namespace caret {
+
+    class BorderFile;
+    class CiftiFile;
+    class FociFile;
+    class LabelFile;
+    class MetricFile;
+    class SurfaceFile;
+    class VolumeFile;
+
+    ///files shared between the steps of a batch script, so each input is parsed once, and intermediates can stay in memory
+    ///surfaces keep their topology, geodesic and signed distance helpers, because the helpers are cached inside SurfaceFile
+    class CommandFileCache
+    {
+        std::map<AString, CaretPointer<BorderFile> > m_borderFiles;
+        std::map<AString, CaretPointer<CiftiFile> > m_ciftiFiles;
+        std::map<AString, CaretPointer<FociFile> > m_fociFiles;
+        std::map<AString, CaretPointer<LabelFile> > m_labelFiles;
+        std::map<AString, CaretPointer<MetricFile> > m_metricFiles;
+        std::map<AString, CaretPointer<SurfaceFile> > m_surfaceFiles;
+        std::map<AString, CaretPointer<VolumeFile> > m_volumeFiles;
+        std::map<AString, int64_t> m_lastUse;//by key, for dropping the least recently used files
+        int64_t m_useCount;
+        int64_t m_maximumBytes;
+        static CommandFileCache* s_active;
+        void markUsed(const AString& fileName);
+        CommandFileCache(const CommandFileCache&);
+        CommandFileCache& operator=(const CommandFileCache&);
+    public:
+        ///file names starting with this are never read from or written to disk
+        static const AString MEMORY_PREFIX;
+        
+        ///default limit on the size on disk of the cached files that can be read again
+        static const int64_t DEFAULT_MAXIMUM_BYTES;
+
+        CommandFileCache();
+        ~CommandFileCache();
+
+        ///the cache CommandParser uses, NULL outside of batch mode
+        static CommandFileCache* getActive() { return s_active; }
+        static void setActive(CommandFileCache* cache) { s_active = cache; }
+
+        static bool isMemoryName(const AString& fileName);
+
+        ///key that is the same for every way of writing the same file name
+        static AString getKey(const AString& fileName);
+
+        ///return the cached file, reading it on the first use, throws if an in-memory name hasn't been created yet
+        CaretPointer<BorderFile> getBorder(const AString& fileName);
+        CaretPointer<CiftiFile> getCifti(const AString& fileName);//opened on-disk, like the normal parser
+        CaretPointer<FociFile> getFoci(const AString& fileName);
+        CaretPointer<LabelFile> getLabel(const AString& fileName);
+        CaretPointer<MetricFile> getMetric(const AString& fileName);
+        CaretPointer<SurfaceFile> getSurface(const AString& fileName);
+        CaretPointer<VolumeFile> getVolume(const AString& fileName);
+
+        ///use an output for later steps that name it as an input
+        void store(const AString& fileName, const CaretPointer<BorderFile>& file);
+        void store(const AString& fileName, const CaretPointer<CiftiFile>& file);
+        void store(const AString& fileName, const CaretPointer<FociFile>& file);
+        void store(const AString& fileName, const CaretPointer<LabelFile>& file);
+        void store(const AString& fileName, const CaretPointer<MetricFile>& file);
+        void store(const AString& fileName, const CaretPointer<SurfaceFile>& file);
+        void store(const AString& fileName, const CaretPointer<VolumeFile>& file);
+
+        ///drop any cached file with this name, of any type, call before overwriting it on disk
+        void forget(const AString& fileName);
+        
+        ///drop the least recently used files that can be read again from disk, until their total size on disk is within the limit
+        ///in-memory files are never dropped, as they only exist in the cache
+        void trim();
+        void setMaximumBytes(const int64_t& maximumBytes) { m_maximumBytes = maximumBytes; }
+
+        void clear();
+    };
+
+}
+
+#endif //__COMMAND_FILE_CACHE_H__
@@ -228,6 +228,7 @@
 #include "OperationException.h"
 
 #include "CommandClassAddMember.h"
+#include "CommandFileCache.h"
 #include "CommandClassCreate.h"
 #include "CommandClassCreateAlgorithm.h"
 #include "CommandClassCreateEnum.h"
@@ -236,15 +237,85 @@
 #include "CommandUnitTest.h"
 #include "ProgramParameters.h"
 
+#include "CaretBinaryFile.h"
+#include "CaretCommandLine.h"
 #include "CaretLogger.h"
+#include "CaretProfiler.h"
 #include "dot_wrapper.h"
+#include "nifti1.h"
 #include "StructureEnum.h"
 
+#include <QFile>
+#include <QTextStream>
+
 #include <iostream>
 
 using namespace caret;
 using namespace std;
 
+namespace
+{
+    ///puts back the command line of the whole batch however a script ends, each script line replaces it while it runs
+    class CommandLineRestorer
+    {
+        AString m_commandLine;
+    public:
+        CommandLineRestorer() : m_commandLine(caret_global_commandLine) { }
+        ~CommandLineRestorer() { caret_global_commandLine = m_commandLine; }
+    };
+    
+    const char* CIFTI_OUTPUT_DATATYPES[] = { "INT8", "UINT8", "INT16", "UINT16", "INT32", "UINT32", "FLOAT32", "FLOAT64" };
+    const int16_t CIFTI_OUTPUT_DATATYPE_CODES[] = { NIFTI_TYPE_INT8, NIFTI_TYPE_UINT8, NIFTI_TYPE_INT16, NIFTI_TYPE_UINT16,
+                                                    NIFTI_TYPE_INT32, NIFTI_TYPE_UINT32, NIFTI_TYPE_FLOAT32, NIFTI_TYPE_FLOAT64 };
+    const int NUM_CIFTI_OUTPUT_DATATYPES = sizeof(CIFTI_OUTPUT_DATATYPE_CODES) / sizeof(CIFTI_OUTPUT_DATATYPE_CODES[0]);
+    
+    ///split a batch script line like a shell would for simple cases: whitespace separates arguments, quotes group them, # starts a comment
+    vector<AString> splitBatchLine(const AString& line, const int64_t& lineNumber)
+    {
+        vector<AString> ret;
+        AString current;
+        bool inArgument = false;
+        QChar quote;//null when not inside quotes
+        for (int i = 0; i < line.size(); ++i)
+        {
+            const QChar c = line[i];
+            if (!quote.isNull())
+            {
+                if (c == quote)
+                {
+                    quote = QChar();
+                } else {
+                    current += c;
+                }
+                continue;
+            }
+            if (c == '"' || c == '\'')
+            {
+                quote = c;
+                inArgument = true;
+            } else if (c.isSpace()) {
+                if (inArgument)
+                {
+                    ret.push_back(current);
+                    current = "";
+                    inArgument = false;
+                }
+            } else if (c == '#' && !inArgument) {
+                break;
+            } else {
+                current += c;
+                inArgument = true;
+            }
+        }
+        if (!quote.isNull())
+        {
+            throw CommandException("unterminated quote on line " + AString::number(lineNumber) + " of batch script");
+        }
+        if (inArgument) ret.push_back(current);
+        return ret;
+    }
+}
+
 /**
  * Get the command operation manager.
  *
@@ -540,7 +611,52 @@ CommandOperationManager::runCommand(ProgramParameters& parameters)
             CaretLogWarning("SIMD type '" + DotSIMDEnum::toName(impl) + "' not supported (could be cpu, compiler, or build options), using '" + DotSIMDEnum::toName(retval) + "'");
         }
     }
+    if (getGlobalOption(parameters, "-gzip-index-files", 0, globalOptionArgs))
+    {
+        CaretBinaryFile::setCompressedIndexFilesEnabled(true);
+    }
+    if (getGlobalOption(parameters, "-profile", 1, globalOptionArgs))
+    {
+        CaretProfiler::enable(globalOptionArgs[0]);
+    } else {
+        const QByteArray profileEnv = qgetenv("WB_PROFILE");
+        if (!profileEnv.isEmpty()) CaretProfiler::enable(AString::fromLocal8Bit(profileEnv.constData()));
+    }
+    if (getGlobalOption(parameters, "-cifti-output-datatype", 1, globalOptionArgs))
+    {
+        int i = 0;
+        for (; i < NUM_CIFTI_OUTPUT_DATATYPES; ++i)
+        {
+            if (globalOptionArgs[0] == CIFTI_OUTPUT_DATATYPES[i]) break;
+        }
+        if (i == NUM_CIFTI_OUTPUT_DATATYPES) throw CommandException("unrecognized cifti output datatype: '" + globalOptionArgs[0] + "'");
+        CommandParser::setCiftiOutputDataType(CIFTI_OUTPUT_DATATYPE_CODES[i]);
+    }
+    if (getGlobalOption(parameters, "-cifti-output-range", 2, globalOptionArgs))
+    {
+        bool minValid = false, maxValid = false;
+        const double minval = globalOptionArgs[0].toDouble(&minValid), maxval = globalOptionArgs[1].toDouble(&maxValid);
+        if (!minValid || !maxValid) throw CommandException("cifti output range must be two numbers");
+        if (minval > maxval) throw CommandException("cifti output range minimum is greater than the maximum");
+        CommandParser::setCiftiOutputRange(minval, maxval);
+    }
+    runOperation(parameters, preventProvenance);
+}
 
+/**
+ * Run the command named by the next parameter, after global options
+ * have been removed.
+ *
+ * @param parameters
+ *    Reference to the command's parameters.
+ * @param preventProvenance
+ *    True if provenance should not be added to output files.
+ * @throws CommandException
+ *    If the command failed.
+ */
+void
+CommandOperationManager::runOperation(ProgramParameters& parameters, const bool& preventProvenance)
+{
     const uint64_t numberOfCommands = this->commandOperations.size();
     const uint64_t numberOfDeprecated = this->deprecatedOperations.size();
 
@@ -569,6 +685,8 @@ CommandOperationManager::runCommand(ProgramParameters& parameters)
         printDeprecatedCommands();
     } else if (commandSwitch == "-all-commands-help") {
         printAllCommandsHelpInfo("wb_command");
+    } else if (commandSwitch == "-batch") {
+        runBatch(parameters, preventProvenance);
     } else {
         
         CommandOperation* operation = NULL;
@@ -611,11 +729,84 @@ CommandOperationManager::runCommand(ProgramParameters& parameters)
     }
 }
 
+/**
+ * Run every command in a script in this process, sharing parsed input
+ * files between them, and keeping outputs whose names start with
+ * CommandFileCache::MEMORY_PREFIX in memory for later commands.
+ *
+ * @param parameters
+ *    Parameters after "-batch", the script file name.
+ * @param preventProvenance
+ *    True if provenance should not be added to output files.
+ * @throws CommandException
+ *    If the script can't be read, or any of its commands failed.
+ */
+void
+CommandOperationManager::runBatch(ProgramParameters& parameters, const bool& preventProvenance)
+{
+    if (CommandFileCache::getActive() != NULL)
+    {
+        throw CommandException("-batch can't be used inside a batch script");
+    }
+    const AString scriptName = parameters.nextString("batch script");
+    parameters.verifyAllParametersProcessed();
+    QFile scriptFile(scriptName);
+    if (!scriptFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        throw CommandException("unable to open batch script '" + scriptName + "'");
+    }
+    QTextStream scriptStream(&scriptFile);
+    const AString programName = parameters.getProgramName();
+    CommandLineRestorer myRestorer;
+    CommandFileCache myCache;
+    CommandFileCache::setActive(&myCache);//the destructor deactivates it, also when a command throws
+    AString command;
+    int64_t lineNumber = 0, commandLineNumber = 0;
+    while (!scriptStream.atEnd())
+    {
+        const AString line = scriptStream.readLine();
+        ++lineNumber;
+        if (command.isEmpty()) commandLineNumber = lineNumber;
+        if (line.endsWith('\\'))
+        {//continued on the next line
+            command += line.left(line.size() - 1) + " ";
+            continue;
+        }
+        command += line;
+        vector<AString> arguments = splitBatchLine(command, commandLineNumber);
+        command = "";
+        if (!arguments.empty() && (arguments[0] == "wb_command" || arguments[0].endsWith("/wb_command")))
+        {//allow pasting existing command lines
+            arguments.erase(arguments.begin());
+        }
+        if (arguments.empty()) continue;
+        ProgramParameters commandParameters;
+        for (int i = 0; i < (int)arguments.size(); ++i)
+        {
+            commandParameters.addParameter(arguments[i]);
+        }
+        caret_global_commandLine_init(programName, arguments);//for provenance, and for the error message if it fails
+        CaretLogInfo("running line " + AString::number(commandLineNumber) + " of batch script: " + caret_global_commandLine);
+        try
+        {
+            runOperation(commandParameters, preventProvenance);
+        } catch (CaretException& e) {
+            throw CommandException("line " + AString::number(commandLineNumber) + " of batch script '" + scriptName + "': " + e.whatString());
+        }
+        myCache.trim();
+    }
+    if (!command.isEmpty())
+    {
+        throw CommandException("batch script '" + scriptName + "' ends with a line continuation");
+    }
+}
+
 AString CommandOperationManager::doCompletion(ProgramParameters& parameters, const bool& useExtGlob)
 {
     AString ret;
     vector<AString> globalOptionArgs;
     /*OptionInfo provInfo = */parseGlobalOption(parameters, "-disable-provenance", 0, globalOptionArgs, true);//we need to at least strip out the global options for other parsing to work
+    /*OptionInfo gzipIndexInfo = */parseGlobalOption(parameters, "-gzip-index-files", 0, globalOptionArgs, true);
     OptionInfo loggingInfo = parseGlobalOption(parameters, "-logging", 1, globalOptionArgs, true);//the previous option doesn't take arguments, doesn't need completion testing
     if (loggingInfo.specified && !loggingInfo.complete)
     {//user is tab completing the logging option, and as it only takes one argument, we know what the completions are
@@ -641,12 +832,33 @@ AString CommandOperationManager::doCompletion(ProgramParameters& parameters, con
         }
         return ret;
     }
-    ret = "wordlist -disable-provenance\\ -logging\\ -simd";//we could prevent suggesting an already-provided global option, but that would be a bit surprising
+    OptionInfo profileInfo = parseGlobalOption(parameters, "-profile", 1, globalOptionArgs, true);
+    if (profileInfo.specified && !profileInfo.complete)
+    {//output file name, suggest anything
+        return "fileglob *";
+    }
+    OptionInfo datatypeInfo = parseGlobalOption(parameters, "-cifti-output-datatype", 1, globalOptionArgs, true);
+    if (datatypeInfo.specified && !datatypeInfo.complete)
+    {
+        ret = "wordlist ";
+        for (int i = 0; i < NUM_CIFTI_OUTPUT_DATATYPES; ++i)
+        {
+            if (i != 0) ret += "\\ ";
+            ret += CIFTI_OUTPUT_DATATYPES[i];
+        }
+        return ret;
+    }
+    OptionInfo rangeInfo = parseGlobalOption(parameters, "-cifti-output-range", 2, globalOptionArgs, true);
+    if (rangeInfo.specified && !rangeInfo.complete)
+    {//numbers, nothing to suggest
+        return "";
+    }
+    ret = "wordlist -cifti-output-datatype\\ -cifti-output-range\\ -disable-provenance\\ -gzip-index-files\\ -logging\\ -profile\\ -simd";//we could prevent suggesting an already-provided global option, but that would be a bit surprising
     const uint64_t numberOfCommands = this->commandOperations.size();
     const uint64_t numberOfDeprecated = this->deprecatedOperations.size();
     if (!parameters.hasNext())
     {//suggest all commands, including deprecated and informational (order doesn't matter, bash sorts them before displaying)
-        ret += "\\ -help\\ -arguments-help\\ -cifti-help\\ -gifti-help\\ -version\\ -list-commands\\ -list-deprecated-commands\\ -all-commands-help";
+        ret += "\\ -help\\ -arguments-help\\ -cifti-help\\ -gifti-help\\ -version\\ -list-commands\\ -list-deprecated-commands\\ -all-commands-help\\ -batch";
         for (uint64_t i = 0; i < numberOfCommands; i++)
         {
             ret += "\\ " + commandOperations[i]->getCommandLineSwitch();
@@ -660,6 +872,10 @@ AString CommandOperationManager::doCompletion(ProgramParameters& parameters, con
     //only processing commands take additional arguments, so we can now ignore -help and similar
     AString commandSwitch;
     commandSwitch = fixUnicode(parameters.nextString("Command Name"), true);
+    if (commandSwitch == "-batch")
+    {//script file name, suggest anything
+        return "fileglob *";
+    }
     for (uint64_t i = 0; i < numberOfCommands; i++)
     {
         if (commandOperations[i]->getCommandLineSwitch() == commandSwitch)
@@ -900,8 +1116,19 @@ void CommandOperationManager::printHelpInfo()
     cout << "   -list-deprecated-commands   list deprecated subcommands" << endl;
     cout << "   -all-commands-help          show all processing subcommands and their help" << endl;
     cout << "                                  info - VERY LONG" << endl;
+    cout << endl << "Batch mode:" << endl;
+    cout << "   -batch <script>             run each line of the script as a command, in" << endl;
+    cout << "                                  one process, reusing input files already" << endl;
+    cout << "                                  read by earlier lines, output names starting" << endl;
+    cout << "                                  with '" << CommandFileCache::MEMORY_PREFIX << "' are kept in memory for later" << endl;
+    cout << "                                  lines instead of being written, global" << endl;
+    cout << "                                  options apply to every line" << endl;
     cout << endl << "Global options (can be added to any command):" << endl;
     cout << "   -disable-provenance         don't generate provenance info in output files" << endl;
+    cout << "   -gzip-index-files           save the decompression index of .gz files that" << endl;
+    cout << "                                  weren't written by workbench as <name>.gzidx," << endl;
+    cout << "                                  and use such files, to speed up reading parts" << endl;
+    cout << "                                  of large .nii.gz files" << endl;
     cout << "   -logging <level>            set the logging level, valid values are:" << endl;
     vector<LogLevelEnum::Enum> logLevels;
     LogLevelEnum::getAllEnums(logLevels);
@@ -922,6 +1149,30 @@ void CommandOperationManager::printHelpInfo()
         cout << "         " << DotSIMDEnum::toName(*iter) << endl;
     }
     cout << endl;
+    cout << "   -profile <file>             write a timing, I/O and memory profile of the" << endl;
+    cout << "                                  command's stages to the file, as a JSON tree" << endl;
+    cout << "                                  if the name ends in .json, otherwise as folded" << endl;
+    cout << "                                  stacks for flame graph tools (can also be" << endl;
+    cout << "                                  enabled with the WB_PROFILE environment" << endl;
+    cout << "                                  variable)" << endl;
+    cout << endl;
+    cout << "   -cifti-output-datatype <type>  write cifti output files with this datatype" << endl;
+    cout << "                                  instead of FLOAT32, integer types use" << endl;
+    cout << "                                  scaling from the range of the data (or the" << endl;
+    cout << "                                  known range of correlation outputs), label" << endl;
+    cout << "                                  files are not scaled, outputs larger than" << endl;
+    cout << "                                  2GB as float also need -cifti-output-range," << endl;
+    cout << "                                  NaN is written as the value nearest zero," << endl;
+    cout << "                                  valid values are:" << endl;
+    for (int i = 0; i < NUM_CIFTI_OUTPUT_DATATYPES; ++i)
+    {
+        cout << "         " << CIFTI_OUTPUT_DATATYPES[i] << endl;
+    }
+    cout << endl;
+    cout << "   -cifti-output-range <min> <max>  for integer cifti output datatypes, map" << endl;
+    cout << "                                  this range of values to the full range of" << endl;
+    cout << "                                  the datatype, values outside it are clamped" << endl;
+    cout << endl;
     cout << "To get the help information of a processing subcommand, run it without any" << endl;
     cout << "   additional arguments." << endl;
     cout << endl;
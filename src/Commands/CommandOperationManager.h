@@ -55,6 +55,10 @@ namespace caret {
 
         CommandOperationManager& operator=(const CommandOperationManager&);
 
+        void runOperation(ProgramParameters& parameters, const bool& preventProvenance);
+        
+        void runBatch(ProgramParameters& parameters, const bool& preventProvenance);
+        
         void printAllCommands();
         
         void printDeprecatedCommands();
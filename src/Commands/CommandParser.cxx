@@ -27,7 +27,9 @@
 #include "CaretCommandLine.h"
 #include "CaretDataFileHelper.h"
 #include "CaretLogger.h"
+#include "CaretProfiler.h"
 #include "CiftiFile.h"
+#include "CommandFileCache.h"
 #include "DataFileException.h"
 #include "FileInformation.h"
 #include "FociFile.h"
@@ -35,6 +37,7 @@
 #include "LabelFile.h"
 #include "MetricFile.h"
 #include "OperationException.h"
+#include "ProgressObject.h"
 #include "SurfaceFile.h"
 #include "VolumeFile.h"
 
@@ -49,12 +52,29 @@ const AString CommandParser::PROVENANCE_NAME = "Provenance";
 const AString CommandParser::PARENT_PROVENANCE_NAME = "ParentProvenance";
 const AString CommandParser::PROGRAM_PROVENANCE_NAME = "ProgramProvenance";
 const AString CommandParser::CWD_PROVENANCE_NAME = "WorkingDirectory";
+int16_t CommandParser::s_ciftiOutputDataType = NIFTI_TYPE_FLOAT32;
+bool CommandParser::s_ciftiOutputRangeSet = false;
+double CommandParser::s_ciftiOutputMin = 0.0;
+double CommandParser::s_ciftiOutputMax = 0.0;
 
 CommandParser::CommandParser(AutoOperationInterface* myAutoOper) :
     CommandOperation(myAutoOper->getCommandSwitch(), myAutoOper->getShortDescription()),
     OperationParserInterface(myAutoOper)
 {
     m_doProvenance = true;
+    m_fileCache = NULL;
+}
+
+void CommandParser::setCiftiOutputDataType(const int16_t& type)
+{
+    s_ciftiOutputDataType = type;
+}
+
+void CommandParser::setCiftiOutputRange(const double& minval, const double& maxval)
+{
+    s_ciftiOutputRangeSet = true;
+    s_ciftiOutputMin = minval;
+    s_ciftiOutputMax = maxval;
 }
 
 void CommandParser::disableProvenance()
@@ -71,13 +91,25 @@ void CommandParser::executeOperation(ProgramParameters& parameters)
     //the parent provenance should never be generated manually
     m_parentProvenance = "";//in case someone tries to use the same instance more than once
     m_workingDir = QDir::currentPath();//get the current path, in case some stupid command changes the working directory
+    m_inputCiftiNames.clear();//ditto
+    m_fileCache = CommandFileCache::getActive();//non-NULL in batch mode, inputs and outputs then go through it
     //these get set on output files during writeOutput (and for on-disk in provenanceBeforeOperation)
+    const int32_t profileStage = CaretProfiler::startNode(-1, getCommandLineSwitch());//all profiling calls do nothing unless profiling was requested
+    int32_t profileSubStage = CaretProfiler::startNode(profileStage, "read inputs");
     parseComponent(myAlgParams.getPointer(), parameters, myOutAssoc);//parsing block
     parameters.verifyAllParametersProcessed();
     makeOnDiskOutputs(myOutAssoc);//check for input on-disk files used as output on-disk files
     //code to show what arguments map to what parameters should go here
     if (m_doProvenance) provenanceBeforeOperation(myOutAssoc);
-    m_autoOper->useParameters(myAlgParams.getPointer(), NULL);//TODO: progress status for caret_command? would probably get messed up by any command info output
+    CaretProfiler::stopNode(profileSubStage);
+    CaretPointer<ProgressObject> myProgress;
+    if (profileStage >= 0)
+    {//algorithms only build the tree of subalgorithm progress objects when given one, so only make one when profiling
+        myProgress.grabNew(new ProgressObject(1.0f));
+        myProgress->startProfiling("process", profileStage);
+    }
+    m_autoOper->useParameters(myAlgParams.getPointer(), myProgress.getPointer());//TODO: progress status for caret_command? would probably get messed up by any command info output
+    if (myProgress != NULL) myProgress->forceFinish();
     vector<AString> uncheckedWarnings = myAlgParams->findUncheckedParams("the command");
     for (size_t i = 0; i < uncheckedWarnings.size(); ++i)
     {
@@ -85,13 +117,18 @@ void CommandParser::executeOperation(ProgramParameters& parameters)
     }
     if (m_doProvenance) provenanceAfterOperation(myOutAssoc);
     //TODO: deallocate input files - give abstract parameter a virtual deallocate method? use CaretPointer and rely on reference counting?
+    profileSubStage = CaretProfiler::startNode(profileStage, "write outputs");
     writeOutput(myOutAssoc);
+    CaretProfiler::stopNode(profileSubStage);
+    CaretProfiler::stopNode(profileStage);
 }
 
 void CommandParser::showParsedOperation(ProgramParameters& parameters)
 {
     CaretPointer<OperationParameters> myAlgParams(m_autoOper->getParameters());//could be an autopointer, but this is safer
     vector<OutputAssoc> myOutAssoc;
+    m_inputCiftiNames.clear();
+    m_fileCache = CommandFileCache::getActive();
     
     parseComponent(myAlgParams.getPointer(), parameters, myOutAssoc, true);//parsing block
     parameters.verifyAllParametersProcessed();
@@ -147,8 +184,14 @@ void CommandParser::parseComponent(ParameterComponent* myComponent, ProgramParam
                 }
                 case OperationParametersEnum::BORDER:
                 {
-                    CaretPointer<BorderFile> myFile(new BorderFile());
-                    myFile->readFile(nextArg);
+                    CaretPointer<BorderFile> myFile;
+                    if (m_fileCache != NULL)
+                    {
+                        myFile = m_fileCache->getBorder(nextArg);
+                    } else {
+                        myFile.grabNew(new BorderFile());
+                        myFile->readFile(nextArg);
+                    }
                     if (m_doProvenance)
                     {
                         const GiftiMetaData* md = myFile->getFileMetaData();
@@ -172,9 +215,18 @@ void CommandParser::parseComponent(ParameterComponent* myComponent, ProgramParam
                 case OperationParametersEnum::CIFTI:
                 {
                     FileInformation myInfo(nextArg);
-                    CaretPointer<CiftiFile> myFile(new CiftiFile());
-                    myFile->openFile(nextArg);
-                    m_inputCiftiNames[myInfo.getCanonicalFilePath()] = myFile;//track input cifti, so we can check their size
+                    CaretPointer<CiftiFile> myFile;
+                    if (m_fileCache != NULL)
+                    {
+                        myFile = m_fileCache->getCifti(nextArg);
+                    } else {
+                        myFile.grabNew(new CiftiFile());
+                        myFile->openFile(nextArg);
+                    }
+                    if (!CommandFileCache::isMemoryName(nextArg))
+                    {
+                        m_inputCiftiNames[myInfo.getCanonicalFilePath()] = myFile;//track input cifti, so we can check their size
+                    }
                     if (m_doProvenance)//just an optimization, if we aren't going to write provenance, don't generate it, either
                     {
                         const GiftiMetaData* md = myFile->getCiftiXML().getFileMetaData();
@@ -211,8 +263,14 @@ void CommandParser::parseComponent(ParameterComponent* myComponent, ProgramParam
                 }
                 case OperationParametersEnum::FOCI:
                 {
-                    CaretPointer<FociFile> myFile(new FociFile());
-                    myFile->readFile(nextArg);
+                    CaretPointer<FociFile> myFile;
+                    if (m_fileCache != NULL)
+                    {
+                        myFile = m_fileCache->getFoci(nextArg);
+                    } else {
+                        myFile.grabNew(new FociFile());
+                        myFile->readFile(nextArg);
+                    }
                     if (m_doProvenance)
                     {
                         const GiftiMetaData* md = myFile->getFileMetaData();
@@ -246,8 +304,14 @@ void CommandParser::parseComponent(ParameterComponent* myComponent, ProgramParam
                 }
                 case OperationParametersEnum::LABEL:
                 {
-                    CaretPointer<LabelFile> myFile(new LabelFile());
-                    myFile->readFile(nextArg);
+                    CaretPointer<LabelFile> myFile;
+                    if (m_fileCache != NULL)
+                    {
+                        myFile = m_fileCache->getLabel(nextArg);
+                    } else {
+                        myFile.grabNew(new LabelFile());
+                        myFile->readFile(nextArg);
+                    }
                     if (m_doProvenance)
                     {
                         const GiftiMetaData* md = myFile->getFileMetaData();
@@ -270,8 +334,14 @@ void CommandParser::parseComponent(ParameterComponent* myComponent, ProgramParam
                 }
                 case OperationParametersEnum::METRIC:
                 {
-                    CaretPointer<MetricFile> myFile(new MetricFile());
-                    myFile->readFile(nextArg);
+                    CaretPointer<MetricFile> myFile;
+                    if (m_fileCache != NULL)
+                    {
+                        myFile = m_fileCache->getMetric(nextArg);
+                    } else {
+                        myFile.grabNew(new MetricFile());
+                        myFile->readFile(nextArg);
+                    }
                     if (m_doProvenance)
                     {
                         const GiftiMetaData* md = myFile->getFileMetaData();
@@ -295,6 +365,10 @@ void CommandParser::parseComponent(ParameterComponent* myComponent, ProgramParam
                 case OperationParametersEnum::STRING:
                 {
                     ((StringParameter*)myComponent->m_paramList[i])->m_parameter = nextArg;
+                    if (m_fileCache != NULL && !CommandFileCache::isMemoryName(nextArg))
+                    {//commands that take file names as strings do their own file access, and may modify the file, so don't trust a cached copy afterwards
+                        m_fileCache->forget(nextArg);
+                    }
                     if (debug)
                     {
                         cout << "Parameter <" << myComponent->m_paramList[i]->m_shortName << "> parsed as ";
@@ -304,8 +378,14 @@ void CommandParser::parseComponent(ParameterComponent* myComponent, ProgramParam
                 }
                 case OperationParametersEnum::SURFACE:
                 {
-                    CaretPointer<SurfaceFile> myFile(new SurfaceFile());
-                    myFile->readFile(nextArg);
+                    CaretPointer<SurfaceFile> myFile;
+                    if (m_fileCache != NULL)
+                    {
+                        myFile = m_fileCache->getSurface(nextArg);
+                    } else {
+                        myFile.grabNew(new SurfaceFile());
+                        myFile->readFile(nextArg);
+                    }
                     if (m_doProvenance)
                     {
                         const GiftiMetaData* md = myFile->getFileMetaData();
@@ -328,8 +408,14 @@ void CommandParser::parseComponent(ParameterComponent* myComponent, ProgramParam
                 }
                 case OperationParametersEnum::VOLUME:
                 {
-                    CaretPointer<VolumeFile> myFile(new VolumeFile());
-                    myFile->readFile(nextArg);
+                    CaretPointer<VolumeFile> myFile;
+                    if (m_fileCache != NULL)
+                    {
+                        myFile = m_fileCache->getVolume(nextArg);
+                    } else {
+                        myFile.grabNew(new VolumeFile());
+                        myFile->readFile(nextArg);
+                    }
                     if (m_doProvenance)
                     {
                         const GiftiMetaData* md = myFile->getFileMetaData();
@@ -927,6 +1013,15 @@ void CommandParser::makeOnDiskOutputs(const vector<OutputAssoc>& outAssociation)
             case OperationParametersEnum::CIFTI:
             {
                 CiftiParameter* myCiftiParam = (CiftiParameter*)myParam;
+                if (m_fileCache != NULL)
+                {
+                    if (CommandFileCache::isMemoryName(outAssociation[i].m_fileName))
+                    {
+                        myCiftiParam->m_parameter.grabNew(new CiftiFile());//stays in memory for later steps
+                        break;
+                    }
+                    m_fileCache->forget(outAssociation[i].m_fileName);//don't keep an earlier version of the file open while overwriting it
+                }
                 FileInformation myInfo(outAssociation[i].m_fileName);
                 map<AString, const CiftiFile*>::iterator iter = m_inputCiftiNames.find(myInfo.getCanonicalFilePath());
                 if (iter != m_inputCiftiNames.end())
@@ -946,6 +1041,13 @@ void CommandParser::makeOnDiskOutputs(const vector<OutputAssoc>& outAssociation)
                     myCiftiParam->m_parameter.grabNew(new CiftiFile());
                     myCiftiParam->m_parameter->setWritingFile(outAssociation[i].m_fileName);
                 }
+                //this is only a default: the algorithm runs after this and can set its own storage, and CiftiFile doesn't scale label files
+                if (s_ciftiOutputRangeSet)
+                {
+                    myCiftiParam->m_parameter->setWritingDataTypeAndScaling(s_ciftiOutputDataType, s_ciftiOutputMin, s_ciftiOutputMax);
+                } else {
+                    myCiftiParam->m_parameter->setWritingDataTypeAutoScaling(s_ciftiOutputDataType);//does nothing extra for float types
+                }
                 break;
             }
             default:
@@ -966,13 +1068,23 @@ void CommandParser::writeOutput(const vector<OutputAssoc>& outAssociation)
                 break;
             case OperationParametersEnum::BORDER:
             {
-                BorderFile* myFile = ((BorderParameter*)myParam)->m_parameter;
+                CaretPointer<BorderFile>& myFile = ((BorderParameter*)myParam)->m_parameter;
+                if (m_fileCache != NULL)
+                {
+                    m_fileCache->store(outAssociation[i].m_fileName, myFile);
+                    if (CommandFileCache::isMemoryName(outAssociation[i].m_fileName)) break;
+                }
                 myFile->writeFile(outAssociation[i].m_fileName);
                 break;
             }
             case OperationParametersEnum::CIFTI:
             {
-                CiftiFile* myFile = ((CiftiParameter*)myParam)->m_parameter;//we can't set metadata here because the XML is already on disk, see provenanceForOnDiskOutputs
+                CaretPointer<CiftiFile>& myFile = ((CiftiParameter*)myParam)->m_parameter;//we can't set metadata here because the XML is already on disk, see provenanceForOnDiskOutputs
+                if (m_fileCache != NULL && CommandFileCache::isMemoryName(outAssociation[i].m_fileName))
+                {
+                    m_fileCache->store(outAssociation[i].m_fileName, myFile);//on-disk outputs were dropped from the cache in makeOnDiskOutputs, and get reopened if used again
+                    break;
+                }
                 myFile->writeFile(outAssociation[i].m_fileName);//this is basically a noop unless outputs and inputs collide, we opened ON_DISK and set cache file to this name back in makeOnDiskOutputs
                 break;
             }
@@ -984,19 +1096,34 @@ void CommandParser::writeOutput(const vector<OutputAssoc>& outAssociation)
                 break;
             case OperationParametersEnum::FOCI:
             {
-                FociFile* myFile = ((FociParameter*)myParam)->m_parameter;
+                CaretPointer<FociFile>& myFile = ((FociParameter*)myParam)->m_parameter;
+                if (m_fileCache != NULL)
+                {
+                    m_fileCache->store(outAssociation[i].m_fileName, myFile);
+                    if (CommandFileCache::isMemoryName(outAssociation[i].m_fileName)) break;
+                }
                 myFile->writeFile(outAssociation[i].m_fileName);
                 break;
             }
             case OperationParametersEnum::LABEL:
             {
-                LabelFile* myFile = ((LabelParameter*)myParam)->m_parameter;
+                CaretPointer<LabelFile>& myFile = ((LabelParameter*)myParam)->m_parameter;
+                if (m_fileCache != NULL)
+                {
+                    m_fileCache->store(outAssociation[i].m_fileName, myFile);
+                    if (CommandFileCache::isMemoryName(outAssociation[i].m_fileName)) break;
+                }
                 myFile->writeFile(outAssociation[i].m_fileName);
                 break;
             }
             case OperationParametersEnum::METRIC:
             {
-                MetricFile* myFile = ((MetricParameter*)myParam)->m_parameter;
+                CaretPointer<MetricFile>& myFile = ((MetricParameter*)myParam)->m_parameter;
+                if (m_fileCache != NULL)
+                {
+                    m_fileCache->store(outAssociation[i].m_fileName, myFile);
+                    if (CommandFileCache::isMemoryName(outAssociation[i].m_fileName)) break;
+                }
                 myFile->writeFile(outAssociation[i].m_fileName);
                 break;
             }
@@ -1005,13 +1132,23 @@ void CommandParser::writeOutput(const vector<OutputAssoc>& outAssociation)
                 break;
             case OperationParametersEnum::SURFACE:
             {
-                SurfaceFile* myFile = ((SurfaceParameter*)myParam)->m_parameter;
+                CaretPointer<SurfaceFile>& myFile = ((SurfaceParameter*)myParam)->m_parameter;
+                if (m_fileCache != NULL)
+                {
+                    m_fileCache->store(outAssociation[i].m_fileName, myFile);
+                    if (CommandFileCache::isMemoryName(outAssociation[i].m_fileName)) break;
+                }
                 myFile->writeFile(outAssociation[i].m_fileName);
                 break;
             }
             case OperationParametersEnum::VOLUME:
             {
-                VolumeFile* myFile = ((VolumeParameter*)myParam)->m_parameter;
+                CaretPointer<VolumeFile>& myFile = ((VolumeParameter*)myParam)->m_parameter;
+                if (m_fileCache != NULL)
+                {
+                    m_fileCache->store(outAssociation[i].m_fileName, myFile);
+                    if (CommandFileCache::isMemoryName(outAssociation[i].m_fileName)) break;
+                }
                 myFile->writeFile(outAssociation[i].m_fileName);
                 break;
             }
@@ -32,6 +32,8 @@
 
 namespace caret {
 
+    class CommandFileCache;
+    
     class CommandParser : public CommandOperation, OperationParserInterface
     {
         int m_minIndent, m_maxIndent, m_indentIncrement, m_maxWidth;
@@ -39,6 +41,10 @@ namespace caret {
         bool m_doProvenance;
         const static AString PROVENANCE_NAME, PARENT_PROVENANCE_NAME, PROGRAM_PROVENANCE_NAME, CWD_PROVENANCE_NAME;//TODO: put this elsewhere?
         std::map<AString, const CiftiFile*> m_inputCiftiNames;
+        CommandFileCache* m_fileCache;//shared with other commands in batch mode, otherwise NULL
+        static int16_t s_ciftiOutputDataType;
+        static bool s_ciftiOutputRangeSet;
+        static double s_ciftiOutputMin, s_ciftiOutputMax;
         struct OutputAssoc
         {//how the output is stored is up to the parser, in the GUI it should load into memory without writing to disk
             AString m_fileName;
@@ -71,6 +77,8 @@ namespace caret {
     public:
         CommandParser(AutoOperationInterface* myAutoOper);
         void disableProvenance();
+        static void setCiftiOutputDataType(const int16_t& type);//for all cifti outputs, integer types scale from the data range unless a range is set
+        static void setCiftiOutputRange(const double& minval, const double& maxval);
         void executeOperation(ProgramParameters& parameters);
         void showParsedOperation(ProgramParameters& parameters);
         AString doCompletion(ProgramParameters& parameters, const bool& useExtGlob);
@@ -28,12 +28,18 @@
 #include "CaretAssert.h"
 #include "CaretBinaryFile.h"
 #include "CaretLogger.h"
+#include "CaretOMP.h"
+#include "CaretProfiler.h"
 #include "DataFileException.h"
 
+#include <QDataStream>
 #include <QFile>
+#include <QFileInfo>
 #include "zlib.h"
 
 #include <algorithm>
+#include <cstring>
+#include <vector>
 
 using namespace caret;
 using namespace std;
@@ -42,12 +48,72 @@ using namespace std;
 namespace caret
 {
 #ifdef ZLIB_VERSION
+    //a place decompression can start from: the start of a gzip member, or a deflate block boundary plus the window preceding it
+    struct ZAccessPoint
+    {
+        int64_t m_outPos;//uncompressed position
+        int64_t m_inPos;//compressed position of the member header if m_bits is -1, otherwise of the first byte that is entirely after the boundary
+        int32_t m_bits;//-1 for a member start, otherwise how many bits of the byte before m_inPos are after the boundary
+        vector<unsigned char> m_window;//up to 32KiB of output preceding a mid-member point
+        ZAccessPoint() { m_outPos = 0; m_inPos = 0; m_bits = -1; }
+    };
+    
+    //reads gzip files through an index of access points, so seeking doesn't need to decompress from the start,
+    //and large reads decompress the chunks between access points in parallel
+    //files we write are concatenated gzip members with their sizes in the header, so their index is found without decompressing
+    //the index of other files is built as their data is decompressed, and can be saved to a .gzidx file
     class ZFileImpl : public CaretBinaryFile::ImplInterface
     {
-        gzFile m_zfile;
+        gzFile m_zfile;//only for reading files that don't have a gzip header, which zlib reads as uncompressed data
+        QFile m_file;
+        bool m_writing;
+        int64_t m_pos;//uncompressed position
+        //reading
+        vector<ZAccessPoint> m_index;//sorted by position, each point starts a chunk that ends at the next point
+        bool m_indexInitialized, m_indexComplete, m_indexFromDecompression;
+        int64_t m_uncompressedSize;//only valid when m_indexComplete
+        z_stream m_stream;//the sequential reader, records new access points when it passes the end of the index
+        bool m_streamValid, m_streamRaw, m_streamAtEnd;
+        int64_t m_streamPos;//uncompressed position of m_stream
+        int64_t m_inFilePos;//file position of the end of the data in m_inBuffer
+        vector<unsigned char> m_inBuffer, m_skipBuffer;
+        //writing
+        vector<char> m_writeBuffer;
+        bool m_wroteMember;
+        
         const static int64_t CHUNK_SIZE;
+        const static int64_t INDEX_SPAN;
+        const static int64_t MEMBER_SIZE;
+        const static int64_t WRITE_BATCH_SIZE;
+        const static int64_t IN_BUFFER_SIZE;
+        const static int MEMBER_HEADER_SIZE;
+        const static int WINDOW_SIZE;
+        
+        void openRead(const QString& filename);
+        void openWrite(const QString& filename);
+        void initIndex();
+        void scanMembers();
+        int readMemberInfo(const int64_t& inPos, uint32_t& memberSize, uint32_t& dataSize);
+        bool loadIndexFile();
+        void saveIndexFile();
+        QString getIndexFileName() const { return m_fileName + ".gzidx"; }
+        int32_t findPoint(const int64_t& position) const;
+        int64_t getChunkEnd(const int32_t& chunk) const;
+        int64_t getChunkInStart(const int32_t& chunk) const;
+        int64_t getChunkInEnd(const int32_t& chunk, const int64_t& fileSize) const;
+        int64_t readChunks(const int32_t& firstChunk, const int32_t& endChunk, char* dataOut);
+        void startStream(const int32_t& pointIndex);
+        void endStream();
+        bool ensureInput(const uInt& needed);
+        void positionStream(const int64_t& position);
+        int64_t streamRead(char* dataOut, const int64_t& count);
+        void streamNextMember();
+        void streamAddPoint();
+        void writeMembers(const bool& final);
+        static bool inflateChunk(const unsigned char* dataIn, const int64_t& inSize, const ZAccessPoint& point, char* dataOut, const int64_t& outSize);
+        static bool compressMember(const char* dataIn, const int64_t& size, vector<unsigned char>& memberOut);
     public:
-        ZFileImpl() { m_zfile = NULL; }
+        ZFileImpl();
         void open(const QString& filename, const CaretBinaryFile::OpenMode& opmode);
         void close();
         void seek(const int64_t& position);
@@ -58,6 +124,12 @@ namespace caret
     };
     
     const int64_t ZFileImpl::CHUNK_SIZE = 1<<26;//64MiB, large enough for good performance, small enough for zlib, must convert to uint32
+    const int64_t ZFileImpl::INDEX_SPAN = 1<<22;//4MiB of output between access points, a 32KiB window each
+    const int64_t ZFileImpl::MEMBER_SIZE = 1<<20;//1MiB of data per written gzip member, compresses nearly as well as one stream
+    const int64_t ZFileImpl::WRITE_BATCH_SIZE = 1<<26;//64MiB, members compressed in parallel at once
+    const int64_t ZFileImpl::IN_BUFFER_SIZE = 1<<18;
+    const int ZFileImpl::MEMBER_HEADER_SIZE = 24;//10 byte gzip header, 2 byte extra length, 12 byte extra field
+    const int ZFileImpl::WINDOW_SIZE = 32768;
 #endif //ZLIB_VERSION
 
     class QFileImpl : public CaretBinaryFile::ImplInterface
@@ -76,6 +148,8 @@ namespace caret
     const int64_t QFileImpl::CHUNK_SIZE = 1<<30;//1GiB, QT4 apparently chokes at more than 2GiB via buffer.read using int32
 }
 
+bool CaretBinaryFile::s_compressedIndexFiles = false;
+
 CaretBinaryFile::ImplInterface::~ImplInterface()
 {
 }
@@ -132,6 +206,7 @@ void CaretBinaryFile::read(void* dataOut, const int64_t& count, int64_t* numRead
     CaretAssert(count >= 0);//not sure about allowing 0
     if (!getOpenForRead()) throw DataFileException("file is not open for reading");
     m_impl->read(dataOut, count, numRead);
+    if (CaretProfiler::isEnabled()) CaretProfiler::addBytesRead(numRead == NULL ? count : *numRead);
 }
 
 void CaretBinaryFile::seek(const int64_t& position)
@@ -152,63 +227,203 @@ void CaretBinaryFile::write(const void* dataIn, const int64_t& count)
     CaretAssert(count >= 0);//not sure about allowing 0
     if (!getOpenForWrite()) throw DataFileException("file is not open for writing");
     m_impl->write(dataIn, count);
+    if (CaretProfiler::isEnabled()) CaretProfiler::addBytesWritten(count);
 }
 
 #ifdef ZLIB_VERSION
+namespace
+{
+    uint32_t readLE16(const unsigned char* bytes)
+    {
+        return bytes[0] | (bytes[1] << 8);
+    }
+    
+    uint32_t readLE32(const unsigned char* bytes)
+    {
+        return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+    }
+    
+    void writeLE16(unsigned char* bytes, const uint32_t& value)
+    {
+        bytes[0] = value & 0xFF;
+        bytes[1] = (value >> 8) & 0xFF;
+    }
+    
+    void writeLE32(unsigned char* bytes, const uint32_t& value)
+    {
+        bytes[0] = value & 0xFF;
+        bytes[1] = (value >> 8) & 0xFF;
+        bytes[2] = (value >> 16) & 0xFF;
+        bytes[3] = (value >> 24) & 0xFF;
+    }
+    
+    const uint32_t INDEX_FILE_VERSION = 1;
+}
+
+ZFileImpl::ZFileImpl()
+{
+    m_zfile = NULL;
+    m_writing = false;
+    m_pos = 0;
+    m_indexInitialized = false;
+    m_indexComplete = false;
+    m_indexFromDecompression = false;
+    m_uncompressedSize = -1;
+    m_streamValid = false;
+    m_streamRaw = false;
+    m_streamAtEnd = false;
+    m_streamPos = 0;
+    m_inFilePos = 0;
+    m_wroteMember = false;
+}
+
 void ZFileImpl::open(const QString& filename, const CaretBinaryFile::OpenMode& opmode)
 {
     close();//don't need to, but just because
     m_fileName = filename;
-    const char* mode = NULL;
-    switch (opmode)//we only support a limited number of combinations, and the string modes are quirky
+    m_pos = 0;
+    switch (opmode)//we only support a limited number of combinations
     {
         case CaretBinaryFile::READ:
-            mode = "rb";
+            openRead(filename);
             break;
         case CaretBinaryFile::WRITE_TRUNCATE:
-            mode = "wb";//you have to do "r+b" in order to ask it to not truncate, which zlib doesn't support anyway
+            openWrite(filename);
             break;
         default:
             throw DataFileException("compressed file only supports READ and WRITE_TRUNCATE modes");
     }
+}
+
+void ZFileImpl::openRead(const QString& filename)
+{
+    m_file.setFileName(filename);
+    if (!m_file.open(QIODevice::ReadOnly | QIODevice::Unbuffered))//we do our own buffering, and scanning the members only needs their headers
+    {
+        if (!m_file.exists())
+        {
+            throw DataFileException("failed to open compressed file '" + filename + "', file does not exist, or folder permissions prevent seeing it");
+        }
+        throw DataFileException("failed to open compressed file '" + filename + "'");
+    }
+    unsigned char magic[2];
+    if (m_file.read((char*)magic, 2) != 2 || magic[0] != 0x1f || magic[1] != 0x8b)
+    {//not gzip, keep reading it the way zlib does
+        m_file.close();
 #if !defined(CARET_OS_MACOSX) && ZLIB_VERNUM > 0x1232
-    m_zfile = gzopen64(filename.toLocal8Bit().constData(), mode);
+        m_zfile = gzopen64(filename.toLocal8Bit().constData(), "rb");
 #else
-    m_zfile = gzopen(filename.toLocal8Bit().constData(), mode);
+        m_zfile = gzopen(filename.toLocal8Bit().constData(), "rb");
 #endif
-    if (m_zfile == NULL)
+        if (m_zfile == NULL) throw DataFileException("failed to open compressed file '" + filename + "'");
+        return;
+    }
+    m_index.clear();
+    m_index.push_back(ZAccessPoint());//the first member
+    m_indexInitialized = false;//don't look for the index until something is read
+    m_indexComplete = false;
+    m_indexFromDecompression = false;
+    m_uncompressedSize = -1;
+    m_inBuffer.resize(IN_BUFFER_SIZE);
+}
+
+void ZFileImpl::openWrite(const QString& filename)
+{
+    m_file.setFileName(filename);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
     {
-        if (!QFile::exists(filename))
-        {
-            if (!(opmode & CaretBinaryFile::TRUNCATE))
-            {
-                throw DataFileException("failed to open compressed file '" + filename + "', file does not exist, or folder permissions prevent seeing it");
-            } else {//use same logic as QFile impl for now
-                throw DataFileException("failed to open compressed file '" + filename + "', unable to create file");
-            }
-        }//TODO: check gzerror and errno for more informative error messages
-        throw DataFileException("failed to open compressed file '" + filename + "'");
+        throw DataFileException("failed to open compressed file '" + filename + "', unable to create file");
     }
+    m_writing = true;
+    m_wroteMember = false;
+    m_writeBuffer.clear();
 }
 
 void ZFileImpl::close()
 {
-    if (m_zfile == NULL) return;//happens when closed and then destroyed, error opening
-    if (gzclose(m_zfile) != 0) throw DataFileException("error closing compressed file '" + m_fileName + "'");
-    m_zfile = NULL;
+    if (m_zfile != NULL)
+    {
+        if (gzclose(m_zfile) != 0) throw DataFileException("error closing compressed file '" + m_fileName + "'");
+        m_zfile = NULL;
+    }
+    if (m_writing)
+    {
+        m_writing = false;//don't try again from the destructor if this throws
+        writeMembers(true);
+        m_writeBuffer.clear();
+        m_file.close();
+        if (m_file.error() != QFile::NoError) throw DataFileException("error closing compressed file '" + m_fileName + "'");
+    }
+    if (m_file.isOpen())//reading
+    {
+        endStream();
+        if (m_indexFromDecompression && CaretBinaryFile::getCompressedIndexFilesEnabled())//a partial index is still useful
+        {
+            saveIndexFile();
+        }
+        m_file.close();
+    }
+    m_index.clear();
+    vector<unsigned char>().swap(m_inBuffer);
+    vector<unsigned char>().swap(m_skipBuffer);
 }
 
 void ZFileImpl::read(void* dataOut, const int64_t& count, int64_t* numRead)
 {
-    if (m_zfile == NULL) throw DataFileException("read called on unopened ZFileImpl");//shouldn't happen
     int64_t totalRead = 0;
     int readret = 0;//to preserve the info of the read that broke early
-    while (totalRead < count)
+    if (m_zfile != NULL)
     {
-        int64_t iterSize = min(count - totalRead, CHUNK_SIZE);
-        readret = gzread(m_zfile, ((char*)dataOut) + totalRead, iterSize);
-        if (readret < 1) break;//0 or -1 indicate eof or error
-        totalRead += readret;
+        while (totalRead < count)
+        {
+            int64_t iterSize = min(count - totalRead, CHUNK_SIZE);
+            readret = gzread(m_zfile, ((char*)dataOut) + totalRead, iterSize);
+            if (readret < 1) break;//0 or -1 indicate eof or error
+            totalRead += readret;
+        }
+    } else {
+        if (m_writing) throw DataFileException("compressed file '" + m_fileName + "' is open for writing, can't read");
+        if (!m_file.isOpen()) throw DataFileException("read called on unopened ZFileImpl");//shouldn't happen
+        if (!m_indexInitialized) initIndex();
+        char* charOut = (char*)dataOut;
+        const int64_t end = m_pos + count;
+        int32_t firstChunk = findPoint(m_pos);
+        if (m_index[firstChunk].m_outPos < m_pos) ++firstChunk;
+        int32_t endChunk = firstChunk;
+        while (endChunk < (int32_t)m_index.size())
+        {
+            const int64_t chunkEnd = getChunkEnd(endChunk);
+            if (chunkEnd < 0 || chunkEnd > end) break;
+            ++endChunk;
+        }
+        bool fileEnded = false;
+        if (endChunk - firstChunk >= 2)//otherwise, there is no parallelism to be had
+        {
+            const int64_t headSize = m_index[firstChunk].m_outPos - m_pos;
+            if (headSize > 0)
+            {
+                positionStream(m_pos);
+                totalRead = streamRead(charOut, headSize);
+                m_pos += totalRead;
+                fileEnded = (totalRead != headSize);
+            }
+            if (!fileEnded)
+            {
+                const int64_t chunksRead = readChunks(firstChunk, endChunk, charOut + totalRead);
+                totalRead += chunksRead;
+                m_pos += chunksRead;
+            }
+        }
+        if (totalRead < count && !fileEnded)
+        {
+            positionStream(m_pos);
+            if (m_streamPos == m_pos)//otherwise, the file ended before m_pos
+            {
+                const int64_t streamed = streamRead(charOut + totalRead, count - totalRead);
+                totalRead += streamed;
+                m_pos += streamed;
+            }
+        }
     }
     if (numRead == NULL)
     {
@@ -224,38 +439,537 @@ void ZFileImpl::read(void* dataOut, const int64_t& count, int64_t* numRead)
 
 void ZFileImpl::seek(const int64_t& position)
 {
-    if (m_zfile == NULL) throw DataFileException("seek called on unopened ZFileImpl");//shouldn't happen
-    if (pos() == position) return;//slight hack, since gzseek is slow or nonfunctional for some cases, so don't try it unless necessary
+    if (m_zfile != NULL)
+    {
+        if (pos() == position) return;//slight hack, since gzseek is slow or nonfunctional for some cases, so don't try it unless necessary
 #if !defined(CARET_OS_MACOSX) && ZLIB_VERNUM > 0x1232
-    int64_t ret = gzseek64(m_zfile, position, SEEK_SET);
+        int64_t ret = gzseek64(m_zfile, position, SEEK_SET);
 #else
-    int64_t ret = gzseek(m_zfile, position, SEEK_SET);
+        int64_t ret = gzseek(m_zfile, position, SEEK_SET);
 #endif
-    if (ret != position) throw DataFileException("seek failed in compressed file '" + m_fileName + "'");
+        if (ret != position) throw DataFileException("seek failed in compressed file '" + m_fileName + "'");
+        return;
+    }
+    if (!m_file.isOpen()) throw DataFileException("seek called on unopened ZFileImpl");//shouldn't happen
+    if (m_writing)
+    {//like gzseek, only forward seeks are possible while writing, and they write zeros
+        if (position < m_pos) throw DataFileException("seek failed in compressed file '" + m_fileName + "'");
+        if (position > m_pos)
+        {
+            const vector<char> zeros(min(position - m_pos, CHUNK_SIZE), 0);
+            while (m_pos < position)
+            {
+                write(zeros.data(), min(position - m_pos, (int64_t)zeros.size()));
+            }
+        }
+        return;
+    }
+    m_pos = position;//reading decompresses to the new position when needed
 }
 
 int64_t ZFileImpl::pos()
 {
-    if (m_zfile == NULL) throw DataFileException("pos called on unopened ZFileImpl");//shouldn't happen
+    if (m_zfile != NULL)
+    {
 #if !defined(CARET_OS_MACOSX) && ZLIB_VERNUM > 0x1232
-    return gztell64(m_zfile);
+        return gztell64(m_zfile);
 #else
-    return gztell(m_zfile);
+        return gztell(m_zfile);
 #endif
+    }
+    if (!m_file.isOpen()) throw DataFileException("pos called on unopened ZFileImpl");//shouldn't happen
+    return m_pos;
 }
 
 void ZFileImpl::write(const void* dataIn, const int64_t& count)
 {
-    if (m_zfile == NULL) throw DataFileException("read called on unopened ZFileImpl");//shouldn't happen
+    if (!m_writing) throw DataFileException("write called on ZFileImpl that isn't open for writing");//shouldn't happen
+    const char* charIn = (const char*)dataIn;
     int64_t totalWritten = 0;
     while (totalWritten < count)
     {
-        int64_t iterSize = min(count - totalWritten, CHUNK_SIZE);
-        int writeret = gzwrite(m_zfile, ((const char*)dataIn) + totalWritten, iterSize);
-        if (writeret < 1) break;//0 or -1 indicate eof or error
-        totalWritten += writeret;
+        int64_t iterSize = min(count - totalWritten, WRITE_BATCH_SIZE - (int64_t)m_writeBuffer.size());
+        m_writeBuffer.insert(m_writeBuffer.end(), charIn + totalWritten, charIn + totalWritten + iterSize);
+        totalWritten += iterSize;
+        m_pos += iterSize;
+        if ((int64_t)m_writeBuffer.size() >= WRITE_BATCH_SIZE) writeMembers(false);
+    }
+}
+
+void ZFileImpl::writeMembers(const bool& final)
+{
+    const int64_t bufferSize = (int64_t)m_writeBuffer.size();
+    int numMembers = (int)(bufferSize / MEMBER_SIZE);
+    if (final && (bufferSize % MEMBER_SIZE != 0 || !m_wroteMember)) ++numMembers;//an empty file still needs a member to be valid gzip
+    if (numMembers == 0) return;
+    vector<vector<unsigned char> > members(numMembers);
+    vector<char> succeeded(numMembers, 0);
+#pragma omp CARET_PARFOR schedule(dynamic)
+    for (int i = 0; i < numMembers; ++i)
+    {
+        const int64_t start = i * MEMBER_SIZE;
+        succeeded[i] = compressMember(m_writeBuffer.data() + start, min(MEMBER_SIZE, bufferSize - start), members[i]);
+    }
+    for (int i = 0; i < numMembers; ++i)
+    {
+        if (!succeeded[i]) throw DataFileException("failed to compress data for file '" + m_fileName + "'");
+        if (m_file.write((const char*)members[i].data(), members[i].size()) != (int64_t)members[i].size())
+        {
+            throw DataFileException("failed to write to compressed file '" + m_fileName + "'");
+        }
+    }
+    m_wroteMember = true;
+    m_writeBuffer.erase(m_writeBuffer.begin(), m_writeBuffer.begin() + min(bufferSize, numMembers * MEMBER_SIZE));
+}
+
+bool ZFileImpl::compressMember(const char* dataIn, const int64_t& size, vector<unsigned char>& memberOut)
+{//gzip member with a "WB" extra field giving the size of the member and of its data, like BGZF
+    z_stream myStream;
+    memset(&myStream, 0, sizeof(myStream));
+    if (deflateInit2(&myStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) return false;
+    const uLong bound = deflateBound(&myStream, size);
+    memberOut.resize(MEMBER_HEADER_SIZE + bound + 8);
+    myStream.next_in = (Bytef*)dataIn;
+    myStream.avail_in = size;
+    myStream.next_out = memberOut.data() + MEMBER_HEADER_SIZE;
+    myStream.avail_out = bound;
+    const int ret = deflate(&myStream, Z_FINISH);
+    const uLong deflatedSize = myStream.total_out;
+    deflateEnd(&myStream);
+    if (ret != Z_STREAM_END) return false;
+    const uint32_t memberSize = MEMBER_HEADER_SIZE + deflatedSize + 8;
+    memberOut.resize(memberSize);
+    unsigned char* header = memberOut.data();
+    header[0] = 0x1f;
+    header[1] = 0x8b;
+    header[2] = 8;//deflate
+    header[3] = 4;//FEXTRA
+    writeLE32(header + 4, 0);//no modification time
+    header[8] = 0;
+    header[9] = 255;//unknown OS
+    writeLE16(header + 10, 12);
+    header[12] = 'W';
+    header[13] = 'B';
+    writeLE16(header + 14, 8);
+    writeLE32(header + 16, memberSize);
+    writeLE32(header + 20, size);
+    unsigned char* trailer = memberOut.data() + memberSize - 8;
+    writeLE32(trailer, crc32(crc32(0, NULL, 0), (const Bytef*)dataIn, size));
+    writeLE32(trailer + 4, size);
+    return true;
+}
+
+void ZFileImpl::initIndex()
+{
+    m_indexInitialized = true;
+    if (CaretBinaryFile::getCompressedIndexFilesEnabled() && loadIndexFile()) return;
+    scanMembers();
+}
+
+int ZFileImpl::readMemberInfo(const int64_t& inPos, uint32_t& memberSize, uint32_t& dataSize)
+{//1 for one of our members, 0 for another gzip member, -1 for not gzip
+    unsigned char header[MEMBER_HEADER_SIZE];
+    if (!m_file.seek(inPos)) return -1;
+    const int64_t numRead = m_file.read((char*)header, MEMBER_HEADER_SIZE);
+    if (numRead < 2 || header[0] != 0x1f || header[1] != 0x8b) return -1;
+    if (numRead < MEMBER_HEADER_SIZE || header[2] != 8 || (header[3] & 4) == 0 || readLE16(header + 10) != 12 ||
+        header[12] != 'W' || header[13] != 'B' || readLE16(header + 14) != 8)
+    {
+        return 0;
+    }
+    memberSize = readLE32(header + 16);
+    dataSize = readLE32(header + 20);
+    if (memberSize < (uint32_t)MEMBER_HEADER_SIZE + 8) return 0;
+    return 1;
+}
+
+void ZFileImpl::scanMembers()
+{//finds the members written by writeMembers() without decompressing, stops at the first member that isn't one of ours
+    const int64_t fileSize = m_file.size();
+    int64_t inPos = 0, outPos = 0;
+    uint32_t memberSize = 0, dataSize = 0;
+    while (true)
+    {
+        const int info = readMemberInfo(inPos, memberSize, dataSize);
+        if (info < 0 && inPos > 0)
+        {//end of file, or trailing garbage, which zlib also ignores
+            m_indexComplete = true;
+            m_uncompressedSize = outPos;
+            break;
+        }
+        if (info != 1 || inPos + memberSize > fileSize) break;
+        if (outPos > m_index.back().m_outPos)
+        {
+            ZAccessPoint newPoint;
+            newPoint.m_outPos = outPos;
+            newPoint.m_inPos = inPos;
+            m_index.push_back(newPoint);
+        }
+        inPos += memberSize;
+        outPos += dataSize;
+    }
+}
+
+bool ZFileImpl::loadIndexFile()
+{
+    QFile indexFile(getIndexFileName());
+    if (!indexFile.open(QIODevice::ReadOnly)) return false;
+    QDataStream myStream(&indexFile);
+    QByteArray magic(7, '\0');
+    quint32 version = 0;
+    qint64 compressedSize = -1, modified = -1, uncompressedSize = -1;
+    qint32 numPoints = 0;
+    if (myStream.readRawData(magic.data(), 7) != 7 || magic != "WBGZIDX") return false;
+    myStream >> version >> compressedSize >> modified >> uncompressedSize >> numPoints;
+    const QFileInfo myInfo(m_fileName);
+    if (myStream.status() != QDataStream::Ok || version != INDEX_FILE_VERSION || compressedSize != myInfo.size() ||
+        modified != myInfo.lastModified().toMSecsSinceEpoch() || numPoints < 1)
+    {//stale or from something else
+        return false;
+    }
+    vector<ZAccessPoint> newIndex(numPoints);
+    for (int i = 0; i < numPoints; ++i)
+    {
+        qint64 outPos, inPos;
+        qint32 bits;
+        QByteArray window;
+        myStream >> outPos >> inPos >> bits >> window;
+        if (myStream.status() != QDataStream::Ok || bits < -1 || bits > 7 || window.size() > WINDOW_SIZE ||
+            (i == 0 && (outPos != 0 || inPos != 0 || bits != -1)) || (i > 0 && outPos <= newIndex[i - 1].m_outPos))
+        {
+            CaretLogFine("ignoring invalid compressed index file '" + getIndexFileName() + "'");
+            return false;
+        }
+        newIndex[i].m_outPos = outPos;
+        newIndex[i].m_inPos = inPos;
+        newIndex[i].m_bits = bits;
+        newIndex[i].m_window.assign(window.constData(), window.constData() + window.size());
+    }
+    m_index.swap(newIndex);
+    m_indexComplete = (uncompressedSize >= 0);
+    m_uncompressedSize = uncompressedSize;
+    return true;
+}
+
+void ZFileImpl::saveIndexFile()
+{//failing to write it isn't an error, the data file is fine
+    QFile indexFile(getIndexFileName());
+    if (!indexFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        CaretLogFine("unable to write compressed index file '" + getIndexFileName() + "'");
+        return;
+    }
+    const QFileInfo myInfo(m_fileName);
+    QDataStream myStream(&indexFile);
+    myStream.writeRawData("WBGZIDX", 7);
+    myStream << (quint32)INDEX_FILE_VERSION << (qint64)myInfo.size() << (qint64)myInfo.lastModified().toMSecsSinceEpoch()
+             << (qint64)(m_indexComplete ? m_uncompressedSize : -1) << (qint32)m_index.size();
+    for (int i = 0; i < (int)m_index.size(); ++i)
+    {
+        myStream << (qint64)m_index[i].m_outPos << (qint64)m_index[i].m_inPos << (qint32)m_index[i].m_bits
+                 << QByteArray((const char*)m_index[i].m_window.data(), m_index[i].m_window.size());
+    }
+}
+
+int32_t ZFileImpl::findPoint(const int64_t& position) const
+{//last access point at or before position
+    CaretAssert(!m_index.empty() && m_index[0].m_outPos == 0);
+    int32_t low = 0, high = (int32_t)m_index.size();
+    while (high - low > 1)
+    {
+        const int32_t guess = (low + high) / 2;
+        if (m_index[guess].m_outPos <= position)
+        {
+            low = guess;
+        } else {
+            high = guess;
+        }
+    }
+    return low;
+}
+
+int64_t ZFileImpl::getChunkEnd(const int32_t& chunk) const
+{//-1 if unknown
+    if (chunk + 1 < (int32_t)m_index.size()) return m_index[chunk + 1].m_outPos;
+    if (m_indexComplete) return m_uncompressedSize;
+    return -1;
+}
+
+int64_t ZFileImpl::getChunkInStart(const int32_t& chunk) const
+{
+    return m_index[chunk].m_inPos - (m_index[chunk].m_bits > 0 ? 1 : 0);
+}
+
+int64_t ZFileImpl::getChunkInEnd(const int32_t& chunk, const int64_t& fileSize) const
+{
+    if (chunk + 1 < (int32_t)m_index.size()) return m_index[chunk + 1].m_inPos;
+    return fileSize;
+}
+
+int64_t ZFileImpl::readChunks(const int32_t& firstChunk, const int32_t& endChunk, char* dataOut)
+{//decompress whole chunks in parallel, in batches to limit the compressed data held in memory
+    endStream();//we move the file position
+    const int64_t fileSize = m_file.size();
+    const int64_t outStart = m_index[firstChunk].m_outPos;
+    vector<unsigned char> compressed;
+    int32_t batchStart = firstChunk;
+    while (batchStart < endChunk)
+    {
+        const int64_t inStart = getChunkInStart(batchStart);
+        int32_t batchEnd = batchStart + 1;
+        while (batchEnd < endChunk && getChunkInEnd(batchEnd, fileSize) - inStart <= CHUNK_SIZE) ++batchEnd;
+        const int64_t inSize = getChunkInEnd(batchEnd - 1, fileSize) - inStart;
+        compressed.resize(inSize);
+        if (!m_file.seek(inStart)) throw DataFileException("seek failed in compressed file '" + m_fileName + "'");
+        int64_t totalRead = 0;
+        while (totalRead < inSize)
+        {
+            const int64_t readret = m_file.read((char*)compressed.data() + totalRead, min(inSize - totalRead, CHUNK_SIZE));
+            if (readret < 1) throw DataFileException("premature end of file in compressed file '" + m_fileName + "'");
+            totalRead += readret;
+        }
+        vector<char> succeeded(batchEnd - batchStart, 0);
+#pragma omp CARET_PARFOR schedule(dynamic)
+        for (int32_t i = batchStart; i < batchEnd; ++i)
+        {
+            const int64_t chunkInStart = getChunkInStart(i);
+            succeeded[i - batchStart] = inflateChunk(compressed.data() + (chunkInStart - inStart), getChunkInEnd(i, fileSize) - chunkInStart, m_index[i],
+                                                     dataOut + (m_index[i].m_outPos - outStart), getChunkEnd(i) - m_index[i].m_outPos);
+        }
+        for (int32_t i = batchStart; i < batchEnd; ++i)
+        {
+            if (!succeeded[i - batchStart]) throw DataFileException("error while reading compressed file '" + m_fileName + "'");
+        }
+        batchStart = batchEnd;
+    }
+    return getChunkEnd(endChunk - 1) - outStart;
+}
+
+bool ZFileImpl::inflateChunk(const unsigned char* dataIn, const int64_t& inSize, const ZAccessPoint& point, char* dataOut, const int64_t& outSize)
+{
+    z_stream myStream;
+    memset(&myStream, 0, sizeof(myStream));
+    bool raw = (point.m_bits >= 0);
+    if (inflateInit2(&myStream, raw ? -15 : 47) != Z_OK) return false;//47 is gzip or zlib header with max window size
+    const unsigned char* nextIn = dataIn;
+    int64_t inLeft = inSize;
+    if (point.m_bits > 0)
+    {
+        if (inLeft < 1) return false;
+        inflatePrime(&myStream, point.m_bits, nextIn[0] >> (8 - point.m_bits));
+        ++nextIn;
+        --inLeft;
+    }
+    if (raw && !point.m_window.empty()) inflateSetDictionary(&myStream, point.m_window.data(), point.m_window.size());
+    bool ok = true;
+    int64_t outDone = 0;
+    while (outDone < outSize)
+    {
+        if (myStream.avail_in == 0)
+        {
+            if (inLeft == 0)
+            {
+                ok = false;
+                break;
+            }
+            const uInt iterSize = min(inLeft, CHUNK_SIZE);
+            myStream.next_in = (Bytef*)nextIn;
+            myStream.avail_in = iterSize;
+            nextIn += iterSize;
+            inLeft -= iterSize;
+        }
+        const uInt outIter = min(outSize - outDone, CHUNK_SIZE);
+        myStream.next_out = (Bytef*)dataOut + outDone;
+        myStream.avail_out = outIter;
+        const int ret = inflate(&myStream, Z_NO_FLUSH);
+        outDone += outIter - myStream.avail_out;
+        if (ret == Z_STREAM_END && outDone < outSize)
+        {//chunk contains an empty member, go to the next one
+            if (raw)
+            {
+                if (myStream.avail_in < 8)
+                {
+                    ok = false;
+                    break;
+                }
+                myStream.next_in += 8;//trailer, can't be checked when starting mid-member
+                myStream.avail_in -= 8;
+                inflateEnd(&myStream);
+                const Bytef* savedIn = myStream.next_in;
+                const uInt savedAvail = myStream.avail_in;
+                memset(&myStream, 0, sizeof(myStream));
+                if (inflateInit2(&myStream, 47) != Z_OK) return false;
+                myStream.next_in = (Bytef*)savedIn;
+                myStream.avail_in = savedAvail;
+                raw = false;
+            } else {
+                inflateReset(&myStream);
+            }
+        } else if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+            ok = false;
+            break;
+        }
+    }
+    inflateEnd(&myStream);
+    return ok;
+}
+
+void ZFileImpl::startStream(const int32_t& pointIndex)
+{
+    endStream();
+    const ZAccessPoint& myPoint = m_index[pointIndex];
+    memset(&m_stream, 0, sizeof(m_stream));
+    m_streamRaw = (myPoint.m_bits >= 0);
+    if (inflateInit2(&m_stream, m_streamRaw ? -15 : 47) != Z_OK) throw DataFileException("failed to initialize decompression for file '" + m_fileName + "'");
+    m_streamValid = true;
+    m_inFilePos = myPoint.m_inPos - (myPoint.m_bits > 0 ? 1 : 0);
+    if (!m_file.seek(m_inFilePos)) throw DataFileException("seek failed in compressed file '" + m_fileName + "'");
+    if (myPoint.m_bits > 0)
+    {
+        if (!ensureInput(1)) throw DataFileException("premature end of file in compressed file '" + m_fileName + "'");
+        inflatePrime(&m_stream, myPoint.m_bits, m_stream.next_in[0] >> (8 - myPoint.m_bits));
+        ++m_stream.next_in;
+        --m_stream.avail_in;
+    }
+    if (m_streamRaw && !myPoint.m_window.empty()) inflateSetDictionary(&m_stream, myPoint.m_window.data(), myPoint.m_window.size());
+    m_streamPos = myPoint.m_outPos;
+    m_streamAtEnd = false;
+}
+
+void ZFileImpl::endStream()
+{
+    if (!m_streamValid) return;
+    inflateEnd(&m_stream);
+    m_streamValid = false;
+}
+
+bool ZFileImpl::ensureInput(const uInt& needed)
+{//true if there are at least "needed" bytes of input available
+    if (m_stream.avail_in >= needed) return true;
+    if (m_stream.avail_in > 0) memmove(m_inBuffer.data(), m_stream.next_in, m_stream.avail_in);
+    const int64_t readret = m_file.read((char*)m_inBuffer.data() + m_stream.avail_in, m_inBuffer.size() - m_stream.avail_in);
+    m_stream.next_in = m_inBuffer.data();
+    if (readret > 0)
+    {
+        m_stream.avail_in += readret;
+        m_inFilePos += readret;
+    }
+    return m_stream.avail_in >= needed;
+}
+
+void ZFileImpl::positionStream(const int64_t& position)
+{
+    if (m_streamValid && m_streamPos == position) return;
+    const int32_t pointIndex = findPoint(position);
+    if (!m_streamValid || m_streamPos > position || m_streamPos < m_index[pointIndex].m_outPos)
+    {//restarting is faster than going forward through a whole chunk
+        startStream(pointIndex);
+    }
+    if (m_skipBuffer.empty()) m_skipBuffer.resize(IN_BUFFER_SIZE);
+    while (m_streamPos < position && !m_streamAtEnd)
+    {
+        streamRead((char*)m_skipBuffer.data(), min(position - m_streamPos, (int64_t)m_skipBuffer.size()));
+    }
+}
+
+int64_t ZFileImpl::streamRead(char* dataOut, const int64_t& count)
+{//sequential decompression, notes access points as it passes the end of the index
+    int64_t totalRead = 0;
+    while (totalRead < count && !m_streamAtEnd)
+    {
+        if (!ensureInput(1))
+        {//truncated file, return what we have
+            m_streamAtEnd = true;
+            break;
+        }
+        const uInt outIter = min(count - totalRead, CHUNK_SIZE);
+        m_stream.next_out = (Bytef*)dataOut + totalRead;
+        m_stream.avail_out = outIter;
+        const int ret = inflate(&m_stream, Z_BLOCK);//stop at block boundaries so we can make access points
+        const int64_t produced = outIter - m_stream.avail_out;
+        totalRead += produced;
+        m_streamPos += produced;
+        if (ret == Z_STREAM_END)
+        {
+            streamNextMember();
+        } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+            endStream();
+            throw DataFileException("error while reading compressed file '" + m_fileName + "'");
+        } else {
+            streamAddPoint();
+        }
+    }
+    return totalRead;
+}
+
+void ZFileImpl::streamNextMember()
+{
+    if (m_streamRaw && !ensureInput(8))
+    {
+        m_streamAtEnd = true;
+        return;
+    }
+    if (m_streamRaw)
+    {//a raw stream stops before the trailer
+        m_stream.next_in += 8;
+        m_stream.avail_in -= 8;
+    }
+    const int64_t memberStart = m_inFilePos - m_stream.avail_in;
+    if (!ensureInput(2) || m_stream.next_in[0] != 0x1f || m_stream.next_in[1] != 0x8b)
+    {//end of file, or trailing garbage, which zlib also ignores
+        m_streamAtEnd = true;
+        if (!m_indexComplete)
+        {
+            m_indexComplete = true;
+            m_uncompressedSize = m_streamPos;
+        }
+        return;
+    }
+    if (m_streamRaw)
+    {
+        const Bytef* savedIn = m_stream.next_in;
+        const uInt savedAvail = m_stream.avail_in;
+        inflateEnd(&m_stream);
+        memset(&m_stream, 0, sizeof(m_stream));
+        if (inflateInit2(&m_stream, 47) != Z_OK)
+        {
+            m_streamValid = false;
+            throw DataFileException("failed to initialize decompression for file '" + m_fileName + "'");
+        }
+        m_stream.next_in = (Bytef*)savedIn;
+        m_stream.avail_in = savedAvail;
+        m_streamRaw = false;
+    } else {
+        inflateReset(&m_stream);
+    }
+    if (m_streamPos > m_index.back().m_outPos)
+    {
+        ZAccessPoint newPoint;
+        newPoint.m_outPos = m_streamPos;
+        newPoint.m_inPos = memberStart;
+        m_index.push_back(newPoint);
+        m_indexFromDecompression = true;
+    }
+}
+
+void ZFileImpl::streamAddPoint()
+{
+#if ZLIB_VERNUM >= 0x1271
+    //128 means a block boundary (or the end of the header), 64 means the last block
+    if ((m_stream.data_type & 128) && !(m_stream.data_type & 64) && m_streamPos >= m_index.back().m_outPos + INDEX_SPAN)
+    {
+        ZAccessPoint newPoint;
+        newPoint.m_outPos = m_streamPos;
+        newPoint.m_inPos = m_inFilePos - m_stream.avail_in;
+        newPoint.m_bits = m_stream.data_type & 7;
+        newPoint.m_window.resize(WINDOW_SIZE);
+        uInt windowSize = WINDOW_SIZE;
+        inflateGetDictionary(&m_stream, newPoint.m_window.data(), &windowSize);
+        newPoint.m_window.resize(windowSize);
+        m_index.push_back(newPoint);
+        m_indexFromDecompression = true;
     }
-    if (totalWritten != count) throw DataFileException("failed to write to compressed file '" + m_fileName + "'");
+#endif //older zlib can't give us the window, so only member starts are access points
 }
 
 ZFileImpl::~ZFileImpl()
@@ -55,6 +55,10 @@ namespace caret {
         int64_t pos();
         void read(void* dataOut, const int64_t& count, int64_t* numRead = NULL);//throw if numRead is NULL and (error or end of file reached early)
         void write(const void* dataIn, const int64_t& count);//failure to complete write is always an exception
+        ///when enabled, the decompression index built while reading a .gz file not written by us is saved next to it as <name>.gzidx,
+        ///and such index files are used when opening .gz files, so that later seeks don't need to decompress from the start
+        static void setCompressedIndexFilesEnabled(const bool& enabled) { s_compressedIndexFiles = enabled; }
+        static bool getCompressedIndexFilesEnabled() { return s_compressedIndexFiles; }
         class ImplInterface
         {
         protected:
@@ -70,6 +74,7 @@ namespace caret {
             virtual ~ImplInterface();
         };
     private:
+        static bool s_compressedIndexFiles;
         CaretPointer<ImplInterface> m_impl;
         OpenMode m_curMode;//so implementation classes don't have to track it
     };
@@ -72,3 +72,13 @@ void caret::caret_global_commandLine_init(const int& argc, const char *const * a
     ProgramParameters params(argc, argv);
     caret_global_commandLine_init(params);
 }
+
+void caret::caret_global_commandLine_init(const AString& programName, const std::vector<AString>& arguments)
+{
+    caret_global_commandLine = "";
+    add_parameter(programName);
+    for (size_t i = 0; i < arguments.size(); ++i)
+    {
+        add_parameter(arguments[i]);
+    }
+}
@@ -23,6 +23,8 @@
 
 #include "AString.h"
 
+#include <vector>
+
 namespace caret {
     
     class ProgramParameters;
@@ -33,6 +35,8 @@ namespace caret {
     
     void caret_global_commandLine_init(const int& argc, const char *const * argv);
     
+    void caret_global_commandLine_init(const AString& programName, const std::vector<AString>& arguments);//for commands that don't come from argv, like batch script lines
+    
 }
 
 #endif //__CARET_COMMAND_LINE_H__
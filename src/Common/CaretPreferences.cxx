@@ -1158,6 +1158,32 @@ CaretPreferences::setVolumeMontageGap(const int32_t volumeMontageGap)
     this->qSettings->sync();
 }
 
+/**
+ * @return Size, in megabytes, of the cache of recently loaded
+ * connectivity rows (zero disables the cache).
+ */
+int32_t
+CaretPreferences::getConnectivityRowCacheSizeMegabytes() const
+{
+    return this->connectivityRowCacheSizeMegabytes;
+}
+
+/**
+ * Set the size, in megabytes, of the cache of recently loaded
+ * connectivity rows.
+ *
+ * @param connectivityRowCacheSizeMegabytes
+ *     New value for cache size (zero disables the cache).
+ */
+void
+CaretPreferences::setConnectivityRowCacheSizeMegabytes(const int32_t connectivityRowCacheSizeMegabytes)
+{
+    this->connectivityRowCacheSizeMegabytes = connectivityRowCacheSizeMegabytes;
+    this->setInteger(CaretPreferences::NAME_CONNECTIVITY_ROW_CACHE_SIZE_MEGABYTES,
+                     this->connectivityRowCacheSizeMegabytes);
+    this->qSettings->sync();
+}
+
 /**
  * @return The volume montage coordinate precision
  */
@@ -1464,6 +1490,9 @@ CaretPreferences::readPreferences()
     this->volumeMontageCoordinatePrecision = this->getInteger(CaretPreferences::NAME_VOLUME_MONTAGE_COORDINATE_PRECISION,
                                                               0);
     
+    this->connectivityRowCacheSizeMegabytes = this->getInteger(CaretPreferences::NAME_CONNECTIVITY_ROW_CACHE_SIZE_MEGABYTES,
+                                                               256);
+    
     this->animationStartTime = 0.0;//this->qSettings->value(CaretPreferences::NAME_ANIMATION_START_TIME).toDouble();
 
     
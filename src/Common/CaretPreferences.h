@@ -108,6 +108,10 @@ namespace caret {
         
         void setVolumeMontageCoordinatePrecision(const int32_t volumeMontageCoordinatePrecision);
         
+        int32_t getConnectivityRowCacheSizeMegabytes() const;
+        
+        void setConnectivityRowCacheSizeMegabytes(const int32_t connectivityRowCacheSizeMegabytes);
+        
         void setAnimationStartTime(const double &time);
         
         void getAnimationStartTime(double &time);
@@ -267,6 +271,8 @@ namespace caret {
         
         int32_t volumeMontageCoordinatePrecision;
         
+        int32_t connectivityRowCacheSizeMegabytes;
+        
         bool splashScreenEnabled;
         
         bool developMenuEnabled;
@@ -306,6 +312,7 @@ namespace caret {
         static const AString NAME_COLOR_BACKGROUND_VOLUME;
         static const AString NAME_COLOR_FOREGROUND_VOLUME;
         static const AString NAME_COLOR_CHART_MATRIX_GRID_LINES;
+        static const AString NAME_CONNECTIVITY_ROW_CACHE_SIZE_MEGABYTES;
         static const AString NAME_DEVELOP_MENU;
         static const AString NAME_DYNAMIC_CONNECTIVITY_ON;
         static const AString NAME_IMAGE_CAPTURE_METHOD;
@@ -346,6 +353,7 @@ namespace caret {
     const AString CaretPreferences::NAME_COLOR_BACKGROUND_VOLUME     = "colorBackgroundVolume";
     const AString CaretPreferences::NAME_COLOR_FOREGROUND_VOLUME     = "colorForegroundVolume";
     const AString CaretPreferences::NAME_COLOR_CHART_MATRIX_GRID_LINES = "colorChartMatrixGridLines";
+    const AString CaretPreferences::NAME_CONNECTIVITY_ROW_CACHE_SIZE_MEGABYTES = "connectivityRowCacheSizeMegabytes";
     const AString CaretPreferences::NAME_DEVELOP_MENU     = "developMenu";
     const AString CaretPreferences::NAME_DYNAMIC_CONNECTIVITY_ON = "dynamicConnectivityDefaultedOn";
     const AString CaretPreferences::NAME_IMAGE_CAPTURE_METHOD = "imageCaptureMethod";
@@ -0,0 +1,240 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2016  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "CaretProfiler.h"
+
+#include "CaretAssert.h"
+#include "CaretLogger.h"
+#include "CaretMutex.h"
+#include "CaretOMP.h"
+#include "SystemUtilities.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+
+using namespace caret;
+using namespace std;
+
+bool CaretProfiler::s_enabled = false;
+AString CaretProfiler::s_outputFileName;
+vector<CaretProfiler::Node> CaretProfiler::s_nodes;
+int64_t CaretProfiler::s_bytesRead = 0;
+int64_t CaretProfiler::s_bytesWritten = 0;
+
+namespace
+{
+    CaretMutex profilerMutex;//stages may start and stop in different threads, and files may be read in parallel
+    QElapsedTimer profilerTimer;
+
+    AString jsonEscape(const AString& input)
+    {
+        AString ret = input;
+        ret.replace("\\", "\\\\");
+        ret.replace("\"", "\\\"");
+        ret.replace("\n", "\\n");
+        return ret;
+    }
+}
+
+void CaretProfiler::enable(const AString& outputFileName)
+{
+    CaretMutexLocker locked(&profilerMutex);
+    s_outputFileName = outputFileName;
+    if (!s_enabled)
+    {
+        profilerTimer.start();
+        s_enabled = true;
+    }
+}
+
+int32_t CaretProfiler::startNode(const int32_t& parentIndex, const AString& name)
+{
+    if (!s_enabled) return -1;
+    Node newNode;
+    newNode.m_name = name;
+    newNode.m_running = true;
+#ifdef CARET_OMP
+    newNode.m_threads = omp_get_max_threads();
+#else
+    newNode.m_threads = 1;
+#endif
+    newNode.m_startCpu = SystemUtilities::getProcessCpuTimeSeconds();
+    newNode.m_cpuSeconds = 0.0;
+    newNode.m_startResident = SystemUtilities::getPeakResidentMemoryInBytes();
+    newNode.m_peakResident = newNode.m_startResident;
+    newNode.m_wallSeconds = 0.0;
+    newNode.m_bytesRead = 0;
+    newNode.m_bytesWritten = 0;
+    CaretMutexLocker locked(&profilerMutex);
+    newNode.m_startWall = profilerTimer.nsecsElapsed() / 1.0e9;
+    newNode.m_startRead = s_bytesRead;
+    newNode.m_startWritten = s_bytesWritten;
+    newNode.m_parent = -1;
+    const int32_t ret = (int32_t)s_nodes.size();
+    if (parentIndex >= 0 && parentIndex < ret)
+    {
+        newNode.m_parent = parentIndex;
+        s_nodes[parentIndex].m_children.push_back(ret);
+    }
+    s_nodes.push_back(newNode);
+    return ret;
+}
+
+void CaretProfiler::finishNode(Node& node)
+{//call with the mutex locked
+    if (!node.m_running) return;
+    node.m_running = false;
+    node.m_wallSeconds = profilerTimer.nsecsElapsed() / 1.0e9 - node.m_startWall;
+    node.m_cpuSeconds = SystemUtilities::getProcessCpuTimeSeconds() - node.m_startCpu;
+    node.m_bytesRead = s_bytesRead - node.m_startRead;
+    node.m_bytesWritten = s_bytesWritten - node.m_startWritten;
+    node.m_peakResident = SystemUtilities::getPeakResidentMemoryInBytes();
+}
+
+void CaretProfiler::stopNode(const int32_t& index)
+{
+    if (index < 0 || !s_enabled) return;
+    CaretMutexLocker locked(&profilerMutex);
+    CaretAssertVectorIndex(s_nodes, index);
+    finishNode(s_nodes[index]);
+}
+
+bool CaretProfiler::getStageTimes(const int32_t& index, double& startSecondsOut, double& wallSecondsOut)
+{
+    CaretMutexLocker locked(&profilerMutex);
+    if (index < 0 || index >= (int32_t)s_nodes.size()) return false;
+    const Node& myNode = s_nodes[index];
+    startSecondsOut = myNode.m_startWall;
+    wallSecondsOut = (myNode.m_running ? profilerTimer.nsecsElapsed() / 1.0e9 - myNode.m_startWall : myNode.m_wallSeconds);
+    return true;
+}
+
+void CaretProfiler::addBytesRead(const int64_t& bytes)
+{
+    if (!s_enabled) return;
+    CaretMutexLocker locked(&profilerMutex);
+    s_bytesRead += bytes;
+}
+
+void CaretProfiler::addBytesWritten(const int64_t& bytes)
+{
+    if (!s_enabled) return;
+    CaretMutexLocker locked(&profilerMutex);
+    s_bytesWritten += bytes;
+}
+
+void CaretProfiler::writeJsonNode(const int32_t& index, const int& depth, AString& output)
+{
+    const Node& myNode = s_nodes[index];
+    const AString indent(depth * 2, ' ');
+    output += indent + "{\n";
+    output += indent + "  \"name\": \"" + jsonEscape(myNode.m_name) + "\",\n";
+    output += indent + "  \"wall_seconds\": " + AString::number(myNode.m_wallSeconds, 'g', 9) + ",\n";
+    output += indent + "  \"cpu_seconds\": " + AString::number(myNode.m_cpuSeconds, 'g', 9) + ",\n";
+    output += indent + "  \"threads\": " + AString::number(myNode.m_threads) + ",\n";
+    output += indent + "  \"bytes_read\": " + AString::number(myNode.m_bytesRead) + ",\n";
+    output += indent + "  \"bytes_written\": " + AString::number(myNode.m_bytesWritten) + ",\n";
+    output += indent + "  \"peak_rss_bytes_start\": " + AString::number(myNode.m_startResident) + ",\n";
+    output += indent + "  \"peak_rss_bytes\": " + AString::number(myNode.m_peakResident) + ",\n";
+    output += indent + "  \"children\": [";
+    for (int i = 0; i < (int)myNode.m_children.size(); ++i)
+    {
+        output += (i == 0 ? "\n" : ",\n");
+        writeJsonNode(myNode.m_children[i], depth + 2, output);
+    }
+    if (!myNode.m_children.empty()) output += "\n" + indent + "  ";
+    output += "]\n" + indent + "}";
+}
+
+void CaretProfiler::writeFoldedNode(const int32_t& index, const AString& stack, AString& output)
+{//"root;child;grandchild <self time in microseconds>", the input format of flamegraph.pl and speedscope
+    const Node& myNode = s_nodes[index];
+    AString name = myNode.m_name;
+    name.replace(';', ',');//separator in the folded format
+    name.replace(' ', '_');
+    if (name.isEmpty()) name = "(unnamed)";
+    const AString myStack = (stack.isEmpty() ? name : stack + ";" + name);
+    double selfSeconds = myNode.m_wallSeconds;
+    for (int i = 0; i < (int)myNode.m_children.size(); ++i)
+    {
+        selfSeconds -= s_nodes[myNode.m_children[i]].m_wallSeconds;
+    }
+    const int64_t selfMicroseconds = (int64_t)(selfSeconds * 1.0e6 + 0.5);
+    if (selfMicroseconds > 0)
+    {
+        output += myStack + " " + AString::number(selfMicroseconds) + "\n";
+    }
+    for (int i = 0; i < (int)myNode.m_children.size(); ++i)
+    {
+        writeFoldedNode(myNode.m_children[i], myStack, output);
+    }
+}
+
+void CaretProfiler::logNode(const int32_t& index, const int& depth)
+{
+    const Node& myNode = s_nodes[index];
+    CaretLogInfo(AString(depth * 2, ' ') + myNode.m_name + ": " + AString::number(myNode.m_wallSeconds, 'f', 3) + "s wall, "
+                 + AString::number(myNode.m_cpuSeconds, 'f', 3) + "s cpu, " + AString::number(myNode.m_threads) + " threads, "
+                 + AString::number(myNode.m_bytesRead) + " bytes read, " + AString::number(myNode.m_bytesWritten) + " bytes written");
+    for (int i = 0; i < (int)myNode.m_children.size(); ++i)
+    {
+        logNode(myNode.m_children[i], depth + 1);
+    }
+}
+
+void CaretProfiler::writeProfile()
+{
+    if (!s_enabled) return;
+    CaretMutexLocker locked(&profilerMutex);
+    for (int i = 0; i < (int)s_nodes.size(); ++i)
+    {
+        finishNode(s_nodes[i]);//an exception may have skipped the end of some stages
+    }
+    AString output;
+    const bool json = s_outputFileName.endsWith(".json", Qt::CaseInsensitive);
+    if (json) output = "[";
+    bool first = true;
+    for (int i = 0; i < (int)s_nodes.size(); ++i)
+    {
+        if (s_nodes[i].m_parent != -1) continue;
+        CaretLogInfo("profile:");
+        logNode(i, 1);
+        if (json)
+        {
+            output += (first ? "\n" : ",\n");
+            writeJsonNode(i, 1, output);
+        } else {
+            writeFoldedNode(i, "", output);
+        }
+        first = false;
+    }
+    if (json) output += "\n]\n";
+    if (!s_outputFileName.isEmpty())
+    {
+        QFile outFile(s_outputFileName);
+        if (outFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            outFile.write(output.toUtf8());
+        } else {
+            CaretLogWarning("unable to open profile output file '" + s_outputFileName + "'");
+        }
+    }
+    s_nodes.clear();
+}
@@ -0,0 +1,82 @@
+#ifndef __CARET_PROFILER_H__
+#define __CARET_PROFILER_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2016  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "AString.h"
+
+#include "stdint.h"
+#include <vector>
+
+namespace caret {
+
+    ///opt-in, hierarchical profiling of processing stages, the tree mirrors the ProgressObject tree
+    ///all functions are no-ops (and node indices are -1) unless enable() has been called
+    class CaretProfiler
+    {
+        struct Node
+        {
+            AString m_name;
+            int32_t m_parent;
+            std::vector<int32_t> m_children;
+            bool m_running;
+            int32_t m_threads;//maximum openmp threads when the stage started
+            double m_startWall, m_wallSeconds;
+            double m_startCpu, m_cpuSeconds;//process cpu time, so includes all threads
+            int64_t m_startRead, m_bytesRead;//through CaretBinaryFile
+            int64_t m_startWritten, m_bytesWritten;
+            int64_t m_startResident, m_peakResident;//process high water mark at start and end of stage
+        };
+        static bool s_enabled;
+        static AString s_outputFileName;
+        static std::vector<Node> s_nodes;
+        static int64_t s_bytesRead, s_bytesWritten;
+        static void finishNode(Node& node);
+        static void writeJsonNode(const int32_t& index, const int& depth, AString& output);
+        static void writeFoldedNode(const int32_t& index, const AString& stack, AString& output);
+        static void logNode(const int32_t& index, const int& depth);
+        CaretProfiler();
+    public:
+        ///turn on profiling, output file extension .json gives a JSON tree, anything else gives folded stacks for flame graph tools
+        static void enable(const AString& outputFileName);
+
+        static bool isEnabled() { return s_enabled; }
+
+        ///start a stage, parentIndex of -1 makes a root stage, returns -1 when not enabled
+        static int32_t startNode(const int32_t& parentIndex, const AString& name);
+
+        ///end a stage, does nothing for a negative index
+        static void stopNode(const int32_t& index);
+
+        ///start (seconds since enable()) and duration of a stage, a running stage's duration is up to now, returns false for an invalid index
+        static bool getStageTimes(const int32_t& index, double& startSecondsOut, double& wallSecondsOut);
+
+        ///called by CaretBinaryFile
+        static void addBytesRead(const int64_t& bytes);
+        static void addBytesWritten(const int64_t& bytes);
+
+        ///write the profile to the output file and the log, stages still running are ended first
+        static void writeProfile();
+    };
+
+}
+
+#endif //__CARET_PROFILER_H__
@@ -53,6 +53,12 @@ namespace caret {
             return p0 * m_weights[0] + p1 * m_weights[1] + p2 * m_weights[2];
         }
         
+        ///weight of one of the four samples, edge samples that aren't used have weight zero
+        inline float getWeight(const int& which) const
+        {
+            return m_weights[which];
+        }
+        
         ///convenience function for edge evaluating without dummy arguments
         inline float evalBothEdge(const float p1, const float p2)
         {
@@ -31,6 +31,8 @@
      PURPOSE.  See the above copyright notice for more information.
 
 =========================================================================*/
+#include <algorithm>
+
 #include "DataCompressZLib.h"
 #include "MathFunctions.h"
 #include "zlib.h"
@@ -110,6 +112,62 @@ DataCompressZLib::uncompressData(const unsigned char* compressedData,
   return decSize;
 }
 
+//----------------------------------------------------------------------------
+uint64_t
+DataCompressZLib::getUncompressedSize(const unsigned char* compressedData,
+                                      uint64_t compressedSize)
+{
+  z_stream stream;
+  stream.zalloc = Z_NULL;
+  stream.zfree = Z_NULL;
+  stream.opaque = Z_NULL;
+  stream.next_in = Z_NULL;
+  stream.avail_in = 0;
+  if (inflateInit(&stream) != Z_OK)
+    {
+    return 0;
+    }
+  
+  // Decompress into a scratch buffer that is reused, only the size is kept.
+  // The input is given in pieces since avail_in may be only 32 bits.
+  const uInt scratchSize = 1 << 16;
+  Bytef scratch[scratchSize];
+  const uint64_t maxInputChunk = 1 << 30;
+  const Bytef* cd = reinterpret_cast<const Bytef*>(compressedData);
+  uint64_t inputRemaining = compressedSize;
+  uint64_t decSize = 0;
+  int status = Z_OK;
+  while (status == Z_OK)
+    {
+    if ((stream.avail_in == 0) && (inputRemaining > 0))
+      {
+      const uint64_t chunk = std::min(inputRemaining, maxInputChunk);
+      stream.next_in = const_cast<Bytef*>(cd);
+      stream.avail_in = static_cast<uInt>(chunk);
+      cd += chunk;
+      inputRemaining -= chunk;
+      }
+    stream.next_out = scratch;
+    stream.avail_out = scratchSize;
+    status = inflate(&stream, Z_NO_FLUSH);
+    decSize += scratchSize - stream.avail_out;
+    if ((status == Z_BUF_ERROR)
+        && (stream.avail_in == 0)
+        && (inputRemaining > 0))
+      {
+      status = Z_OK;//ran out of the current input chunk
+      }
+    }
+  inflateEnd(&stream);
+  
+  if (status != Z_STREAM_END)
+    {
+    return 0;
+    }
+  
+  return decSize;
+}
+
 //----------------------------------------------------------------------------
 unsigned long
 DataCompressZLib::getMaximumCompressionSpace(unsigned long size)
@@ -79,6 +79,10 @@ public:
                                  uint64_t compressedSize,
                                  unsigned char* uncompressedData,
                                  uint64_t uncompressedSiz);
+  // Size of the data after decompression, without keeping the
+  // decompressed data.  Zero if the compressed data is not valid.
+   uint64_t getUncompressedSize(const unsigned char* compressedData,
+                                uint64_t compressedSize);
 protected:    
     int compressionLevel;
     
@@ -73,6 +73,8 @@ EventManager::EventManager()
 {
     m_eventIssuedCounter = 0;
     m_eventBlockingCounter.resize(EventTypeEnum::EVENT_COUNT, 0);
+    resetEventStatistics();
+    m_eventTimer.start();
 }
 
 /**
@@ -175,6 +177,7 @@ EventManager::addEventListener(EventListenerInterface* eventListener,
 #else
     INTENTIONAL_COMPILER_ERROR_MISSING_CONTAINER_TYPE
 #endif
+    m_eventListenerSnapshots[listenForEventType].grabNew(NULL);
     
     //std::cout << "Adding listener from class "
     //<< typeid(*eventListener).name()
@@ -205,6 +208,7 @@ EventManager::addProcessedEventListener(EventListenerInterface* eventListener,
 #else
     INTENTIONAL_COMPILER_ERROR_MISSING_CONTAINER_TYPE
 #endif
+    m_eventProcessedListenerSnapshots[listenForEventType].grabNew(NULL);
     
     //std::cout << "Adding listener from class "
     //<< typeid(*eventListener).name()
@@ -235,6 +239,7 @@ EventManager::removeEventFromListener(EventListenerInterface* eventListener,
                                                             eventListener);
     if (eventIter != listeners.end()) {
         listeners.erase(eventIter);
+        m_eventListenerSnapshots[listenForEventType].grabNew(NULL);
     }
 
     /*
@@ -247,6 +252,7 @@ EventManager::removeEventFromListener(EventListenerInterface* eventListener,
                                                                      eventListener);
     if (processedEventIter != processedListeners.end()) {
         processedListeners.erase(processedEventIter);
+        m_eventProcessedListenerSnapshots[listenForEventType].grabNew(NULL);
     }
     
 //    EVENT_LISTENER_CONTAINER listeners = m_eventListeners[listenForEventType];
@@ -302,11 +308,19 @@ EventManager::removeEventFromListener(EventListenerInterface* eventListener,
 //        m_eventProcessedListeners[listenForEventType] = updatedProcessedListeners;
 //    }
 #elif CONTAINER_HASH_SET
-    m_eventListeners[listenForEventType].erase(eventListener);
-    m_eventProcessedListeners[listenForEventType].erase(eventListener);
+    if (m_eventListeners[listenForEventType].erase(eventListener) > 0) {
+        m_eventListenerSnapshots[listenForEventType].grabNew(NULL);
+    }
+    if (m_eventProcessedListeners[listenForEventType].erase(eventListener) > 0) {
+        m_eventProcessedListenerSnapshots[listenForEventType].grabNew(NULL);
+    }
 #elif CONTAINER_SET
-    m_eventListeners[listenForEventType].erase(eventListener);
-    m_eventProcessedListeners[listenForEventType].erase(eventListener);
+    if (m_eventListeners[listenForEventType].erase(eventListener) > 0) {
+        m_eventListenerSnapshots[listenForEventType].grabNew(NULL);
+    }
+    if (m_eventProcessedListeners[listenForEventType].erase(eventListener) > 0) {
+        m_eventProcessedListenerSnapshots[listenForEventType].grabNew(NULL);
+    }
 #else
     INTENTIONAL_COMPILER_ERROR_MISSING_CONTAINER_TYPE
 #endif
@@ -325,9 +339,55 @@ EventManager::removeAllEventsFromListener(EventListenerInterface* eventListener)
     }
 }
 
+/**
+ * Get the listeners that are sent an event, creating the
+ * copy of the listeners if they have changed.
+ *
+ * @param listeners
+ *    The listeners for an event type.
+ * @param snapshot
+ *    The copy of the listeners for the event type.
+ * @return
+ *    Reference to the copy of the listeners.
+ */
+CaretPointerNonsync<EventManager::LISTENER_SNAPSHOT>
+EventManager::getListenerSnapshot(const EVENT_LISTENER_CONTAINER& listeners,
+                                  CaretPointerNonsync<LISTENER_SNAPSHOT>& snapshot)
+{
+    if (snapshot == NULL) {
+        snapshot.grabNew(new LISTENER_SNAPSHOT(listeners.begin(),
+                                               listeners.end()));
+    }
+    return snapshot;
+}
+
+/**
+ * Get the prefix for log messages about an event.  Only
+ * called when a message is logged since it is slow.
+ *
+ * @param event
+ *    Event that is sent.
+ * @return
+ *    Text with event number, event, and thread.
+ */
+AString
+EventManager::getEventMessagePrefix(const Event* event) const
+{
+    return ("Event "
+            + AString::number(m_eventIssuedCounter)
+            + ": "
+            + event->toString()
+            + " from thread: "
+            + AString::number((uint64_t)QThread::currentThread())
+            + " ");
+}
+
 /**
  * Send an event.
  * 
+ * Nothing is allocated when sending an event unless the listeners
+ * for the event type have changed or a message is logged.
+ *
  * @param event
  *    Event that is sent.
  */
@@ -335,22 +395,15 @@ void
 EventManager::sendEvent(Event* event)
 {   
     EventTypeEnum::Enum eventType = event->getEventType();
-    const AString eventNumberString = AString::number(m_eventIssuedCounter);
-    const AString eventMessagePrefix = ("Event "
-                                        + eventNumberString
-                                        + ": "
-                                        + event->toString() 
-                                        + " from thread: " 
-                                        + AString::number((uint64_t)QThread::currentThread())
-                                        + " ");
     
     const int32_t eventTypeIndex = static_cast<int32_t>(eventType);
     CaretAssertVectorIndex(m_eventBlockingCounter, eventTypeIndex);
+    EventStatistics& statistics = m_eventStatistics[eventTypeIndex];
     if (m_eventBlockingCounter[eventTypeIndex] > 0) {
-        AString msg = (eventMessagePrefix
-                       + " is blocked.  Blocking counter="
-                       + AString::number(m_eventBlockingCounter[eventTypeIndex]));
-        CaretLogFiner(msg);
+        statistics.m_blockedCount++;
+        CaretLogFiner(getEventMessagePrefix(event)
+                      + " is blocked.  Blocking counter="
+                      + AString::number(m_eventBlockingCounter[eventTypeIndex]));
     }
     else {
         if (eventType == EventTypeEnum::EVENT_ALERT_USER) {
@@ -367,25 +420,27 @@ EventManager::sendEvent(Event* event)
             }
         }
         
+        const int64_t eventNumber = m_eventIssuedCounter;
+        const int64_t startNanoseconds = m_eventTimer.nsecsElapsed();
+        
         /*
-         * Get listeners for event.
+         * Get listeners for event.  A listener may add or remove
+         * listeners, which replaces the copy but not this reference.
          */
-        EVENT_LISTENER_CONTAINER listeners = m_eventListeners[eventType];
-        
-        const AString eventNumberString = AString::number(m_eventIssuedCounter);
+        const CaretPointerNonsync<LISTENER_SNAPSHOT> listeners = getListenerSnapshot(m_eventListeners[eventType],
+                                                                                     m_eventListenerSnapshots[eventType]);
         
         // Too many prints (JWH)
-        //AString msg = (eventMessagePrefix + " SENT.");
+        //AString msg = (getEventMessagePrefix(event) + " SENT.");
         //CaretLogFiner(msg);
         //std::cout << msg << std::endl;
         
         /*
          * Send event to each of the listeners.
          */
-        for (EVENT_LISTENER_CONTAINER_ITERATOR iter = listeners.begin();
-             iter != listeners.end();
-             iter++) {
-            EventListenerInterface* listener = *iter;
+        const int64_t numListeners = static_cast<int64_t>(listeners->size());
+        for (int64_t i = 0; i < numListeners; i++) {
+            EventListenerInterface* listener = (*listeners)[i];
             
             //std::cout << "Sending event from class "
             //<< typeid(*listener).name()
@@ -397,7 +452,7 @@ EventManager::sendEvent(Event* event)
             listener->receiveEvent(event);
             
             if (event->isError()) {
-                CaretLogWarning("Event " + eventNumberString + " had error: " + event->toString() + ": " + event->getErrorMessage());
+                CaretLogWarning("Event " + AString::number(eventNumber) + " had error: " + event->toString() + ": " + event->getErrorMessage());
                 break;
             }
         }
@@ -409,11 +464,11 @@ EventManager::sendEvent(Event* event)
             /*
              * Send event to each of the PROCESSED listeners.
              */
-            EVENT_LISTENER_CONTAINER processedListeners = m_eventProcessedListeners[eventType];
-            for (EVENT_LISTENER_CONTAINER_ITERATOR iter = processedListeners.begin();
-                 iter != processedListeners.end();
-                 iter++) {
-                EventListenerInterface* listener = *iter;
+            const CaretPointerNonsync<LISTENER_SNAPSHOT> processedListeners = getListenerSnapshot(m_eventProcessedListeners[eventType],
+                                                                                                  m_eventProcessedListenerSnapshots[eventType]);
+            const int64_t numProcessedListeners = static_cast<int64_t>(processedListeners->size());
+            for (int64_t i = 0; i < numProcessedListeners; i++) {
+                EventListenerInterface* listener = (*processedListeners)[i];
                 
                 //std::cout << "Sending event from class "
                 //<< typeid(*listener).name()
@@ -425,15 +480,22 @@ EventManager::sendEvent(Event* event)
                 listener->receiveEvent(event);
                 
                 if (event->isError()) {
-                    CaretLogWarning("Event " + eventNumberString + " had error: " + event->toString());
+                    CaretLogWarning("Event " + AString::number(eventNumber) + " had error: " + event->toString());
                     break;
                 }
             }
         }
         else {
-            // Too many prints (JWH) CaretLogFine("Event " + eventNumberString + " not processed: " + event->toString());
+            // Too many prints (JWH) CaretLogFine("Event " + AString::number(eventNumber) + " not processed: " + event->toString());
         }
 
+        const int64_t elapsedNanoseconds = m_eventTimer.nsecsElapsed() - startNanoseconds;
+        statistics.m_sentCount++;
+        statistics.m_totalNanoseconds += elapsedNanoseconds;
+        if (elapsedNanoseconds > statistics.m_maximumNanoseconds) {
+            statistics.m_maximumNanoseconds = elapsedNanoseconds;
+        }
+        
         m_eventIssuedCounter++;
     }
 }
@@ -599,4 +661,64 @@ EventManager::getEventIssuedCounter() const
     return m_eventIssuedCounter;
 }
 
+/**
+ * Get the number of times each event type was sent and the time
+ * spent in its listeners since the statistics were last reset.
+ * Times include any events sent by the listeners.
+ *
+ * @return
+ *    Text with one line for each event type that was sent or
+ *    blocked, sorted by total time.
+ */
+AString
+EventManager::getEventStatistics() const
+{
+    std::vector<std::pair<int64_t, int32_t> > sortedTypes;
+    for (int32_t i = 0; i < EventTypeEnum::EVENT_COUNT; i++) {
+        const EventStatistics& statistics = m_eventStatistics[i];
+        if ((statistics.m_sentCount > 0)
+            || (statistics.m_blockedCount > 0)) {
+            sortedTypes.push_back(std::make_pair(-statistics.m_totalNanoseconds,
+                                                 i));
+        }
+    }
+    std::sort(sortedTypes.begin(),
+              sortedTypes.end());
+    
+    AString text = ("Event statistics (times in milliseconds, including events sent by listeners)\n"
+                    "        Sent     Blocked        Total      Average      Maximum  Event\n");
+    for (std::vector<std::pair<int64_t, int32_t> >::iterator iter = sortedTypes.begin();
+         iter != sortedTypes.end();
+         iter++) {
+        const EventStatistics& statistics = m_eventStatistics[iter->second];
+        const double totalMilliseconds = statistics.m_totalNanoseconds / 1.0e6;
+        const double averageMilliseconds = ((statistics.m_sentCount > 0)
+                                            ? (totalMilliseconds / statistics.m_sentCount)
+                                            : 0.0);
+        text += (AString::number(statistics.m_sentCount).rightJustified(12)
+                 + AString::number(statistics.m_blockedCount).rightJustified(12)
+                 + AString::number(totalMilliseconds, 'f', 3).rightJustified(13)
+                 + AString::number(averageMilliseconds, 'f', 3).rightJustified(13)
+                 + AString::number(statistics.m_maximumNanoseconds / 1.0e6, 'f', 3).rightJustified(13)
+                 + "  "
+                 + EventTypeEnum::toName(static_cast<EventTypeEnum::Enum>(iter->second))
+                 + "\n");
+    }
+    
+    return text;
+}
 
+/**
+ * Reset the counts and times for all event types.
+ */
+void
+EventManager::resetEventStatistics()
+{
+    for (int32_t i = 0; i < EventTypeEnum::EVENT_COUNT; i++) {
+        EventStatistics& statistics = m_eventStatistics[i];
+        statistics.m_sentCount = 0;
+        statistics.m_blockedCount = 0;
+        statistics.m_totalNanoseconds = 0;
+        statistics.m_maximumNanoseconds = 0;
+    }
+}
@@ -22,8 +22,12 @@
 /*LICENSE_END*/
 
 #include <stdint.h>
+#include <vector>
+
+#include <QElapsedTimer>
 
 #include "CaretObject.h"
+#include "CaretPointer.h"
 
 #include "EventTypeEnum.h"
 
@@ -32,7 +36,6 @@
 #define CONTAINER_SET 1
 
 #ifdef CONTAINER_VECTOR
-#include <vector>
 #elif CONTAINER_HASH_SET
 #include <functional>
 #include "CaretHashSet.h"
@@ -94,7 +97,27 @@ namespace caret {
         
         int64_t getEventIssuedCounter() const;
         
+        AString getEventStatistics() const;
+        
+        void resetEventStatistics();
+        
     private:
+        /**
+         * Number of times an event type was sent and time spent by its listeners
+         */
+        struct EventStatistics {
+            int64_t m_sentCount;
+            
+            int64_t m_blockedCount;
+            
+            /** Includes the time of any events sent by the listeners */
+            int64_t m_totalNanoseconds;
+            
+            int64_t m_maximumNanoseconds;
+        };
+        
+        typedef std::vector<EventListenerInterface*> LISTENER_SNAPSHOT;
+        
         EventManager();
         
         virtual ~EventManager();
@@ -129,12 +152,33 @@ namespace caret {
          */
         EVENT_LISTENER_CONTAINER m_eventProcessedListeners[EventTypeEnum::EVENT_COUNT];
         
+        /**
+         * Copies of the listeners that are sent an event, rebuilt only after
+         * the listeners for the event type change.  Sending an event holds a
+         * reference so that listeners added or removed by a listener do not
+         * affect the event being sent.
+         */
+        CaretPointerNonsync<LISTENER_SNAPSHOT> m_eventListenerSnapshots[EventTypeEnum::EVENT_COUNT];
+        
+        CaretPointerNonsync<LISTENER_SNAPSHOT> m_eventProcessedListenerSnapshots[EventTypeEnum::EVENT_COUNT];
+        
+        /** Counts and times for each event type */
+        EventStatistics m_eventStatistics[EventTypeEnum::EVENT_COUNT];
+        
+        /** Times event listeners for the statistics */
+        QElapsedTimer m_eventTimer;
+        
         /** Counter that is incremented each time an event is issued */
         int64_t m_eventIssuedCounter;
         
         /** A counter for blocking events of each type */
         std::vector<int64_t> m_eventBlockingCounter;
         
+        static CaretPointerNonsync<LISTENER_SNAPSHOT> getListenerSnapshot(const EVENT_LISTENER_CONTAINER& listeners,
+                                                                         CaretPointerNonsync<LISTENER_SNAPSHOT>& snapshot);
+        
+        AString getEventMessagePrefix(const Event* event) const;
+        
         static EventManager* s_singletonEventManager;
         
     };
@@ -20,6 +20,7 @@
 
 #include "ProgressObject.h"
 #include "CaretAssert.h"
+#include "CaretProfiler.h"
 #include "EventProgressUpdate.h"
 #include "EventManager.h"
 
@@ -57,6 +58,7 @@ ProgressObject* ProgressObject::addAlgorithm(const float weight, const float chi
 
 void ProgressObject::algorithmStartSentinel()
 {
+    startChildProfiling();
     if (m_sentinelPassed)
     {
         m_disabled = true;//if it hits start twice (passed through an algorithm without interaction), disable it
@@ -70,6 +72,8 @@ void ProgressObject::finishLevel()
     if (m_finished) return;//don't finish twice
     m_currentProgress = m_totalWeight;
     m_finished = true;
+    CaretProfiler::stopNode(m_profileTaskNode);
+    if (m_profileNodeOwned) CaretProfiler::stopNode(m_profileNode);
     if (m_parent != NULL)
     {
         m_parent->m_children[m_parentIndex].completed = true;
@@ -113,6 +117,34 @@ ProgressObject::ProgressObject(const float weight, const float childResolution)
     m_sentinelPassed = false;
     m_totalWeight = weight;
     m_childResolution = childResolution;
+    m_profileNode = -1;
+    m_profileTaskNode = -1;
+    m_profileTaskClaimed = false;
+    m_profileNodeOwned = true;
+    m_profileChecked = false;
+}
+
+void ProgressObject::startProfiling(const AString& stageName, const int32_t parentStage)
+{
+    if (m_profileNode >= 0 || m_finished) return;
+    m_profileChecked = true;
+    m_profileNode = CaretProfiler::startNode(parentStage, stageName);
+}
+
+void ProgressObject::startChildProfiling()
+{//subalgorithms are often all added before the first one runs, so start the stage when it starts doing something
+    if (m_profileChecked || m_parent == NULL) return;
+    m_profileChecked = true;
+    if (m_parent->m_profileNode < 0 || m_parent->m_finished) return;
+    if (m_parent->m_profileTaskNode >= 0 && !m_parent->m_profileTaskClaimed)
+    {//the task is usually set to describe the subalgorithm that is about to be called, so they share a stage
+        m_parent->m_profileTaskClaimed = true;
+        m_profileNode = m_parent->m_profileTaskNode;
+        m_profileNodeOwned = false;
+        return;
+    }
+    const int32_t parentStage = (m_parent->m_profileTaskNode >= 0 ? m_parent->m_profileTaskNode : m_parent->m_profileNode);
+    m_profileNode = CaretProfiler::startNode(parentStage, "subalgorithm " + AString::number(m_parentIndex + 1));
 }
 
 LevelProgress::LevelProgress(ProgressObject* myProgObj, const float finishedProgress, const float internalWeight, const float internalResolution)
@@ -124,6 +156,7 @@ LevelProgress::LevelProgress(ProgressObject* myProgObj, const float finishedProg
     m_internalResolution = max(internalResolution, ProgressObject::MAX_INTERNAL_RESOLUTION);//the lower the value, the more often it updates
     if (m_progObjRef != NULL)
     {
+        m_progObjRef->startChildProfiling();
         m_progObjRef->setInternalWeight(internalWeight);
         EventProgressUpdate myUpdate(myProgObj);
         myUpdate.m_starting = true;
@@ -212,6 +245,7 @@ ProgressObject::~ProgressObject()
 void LevelProgress::reportProgress(const float currentTotal)
 {
     if (m_progObjRef == NULL || m_progObjRef->m_disabled) return;
+    m_progObjRef->startChildProfiling();
     float curProgress = currentTotal / m_maximum;
     if (curProgress > 1.0f)
     {
@@ -233,6 +267,13 @@ void LevelProgress::setTask(const AString& taskDescription)
 {//maybe this should be in a setter in m_progObjRef, here for coherence with progress reporting
     if (m_progObjRef == NULL) return;
     m_progObjRef->m_description = taskDescription;
+    m_progObjRef->startChildProfiling();
+    if (m_progObjRef->m_profileNode >= 0 && !m_progObjRef->m_finished)
+    {//each task is a stage, until the next task or the end of the level
+        CaretProfiler::stopNode(m_progObjRef->m_profileTaskNode);
+        m_progObjRef->m_profileTaskNode = CaretProfiler::startNode(m_progObjRef->m_profileNode, taskDescription);
+        m_progObjRef->m_profileTaskClaimed = false;
+    }
     EventProgressUpdate myUpdate(m_progObjRef);
     myUpdate.m_textUpdate = true;
     EventManager::get()->sendEvent(myUpdate.getPointer());
@@ -52,6 +52,12 @@ namespace caret {
       bool m_sentinelPassed;
       bool m_disabled;//disables itself if sentinel called twice
       bool m_finished;
+      int32_t m_profileNode;//stage in CaretProfiler, -1 when not profiled
+      int32_t m_profileTaskNode;//stage for the current task, ended by the next task or finishing, -1 when none
+      bool m_profileTaskClaimed;//a subalgorithm has used the current task's stage as its own
+      bool m_profileNodeOwned;//false when m_profileNode is the parent's task stage
+      bool m_profileChecked;//subalgorithm stages start at the first activity, not when added
+      void startChildProfiling();
       void updateProgress();//used by LevelProgress to report changes
       void finishLevel();//moves this progress object to 100%, then updates parent if not NULL
       void setInternalWeight(const float& myInternalWeight);//used by LevelProgress when you start a level
@@ -86,6 +92,12 @@ namespace caret {
       
       ///true if algorithmStartSentinel disabled the object
       bool isDisabled();
+      
+      ///when CaretProfiler is enabled, record this object and its subalgorithms as stages under parentStage (-1 for a root stage)
+      void startProfiling(const AString& stageName, const int32_t parentStage = -1);
+      
+      ///the CaretProfiler stage of this object, -1 when not profiled
+      int32_t getProfileStage() const { return m_profileNode; }
       //TODO: make something to return the statuses of all in-progress (nonzero curProgress) tasks for the entire tree, for detailed progress info
       //TODO: set up callbacks so progress changes don't have to be polled for
       friend class LevelProgress;//so that LevelProgress can report progress, but nothing else can
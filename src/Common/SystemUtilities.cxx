@@ -25,6 +25,7 @@
 
 #include <QDateTime>
 #include <QDir>
+#include <QFile>
 #include <QThread>
 #include <QUuid>
 
@@ -32,6 +33,7 @@
 
 #ifndef _WIN32
 #include "execinfo.h"
+#include <sys/resource.h>
 #else
 #include "Windows.h"
 #endif
@@ -282,6 +284,102 @@ SystemUtilities::getNumberOfProcessors()
     return 1;
 }
 
+/**
+ * Get the peak resident memory (high water mark) of this process.
+ * On Linux, the peak is since the last call to resetPeakResidentMemory()
+ * or since the process started.
+ *
+ * @return  The peak resident memory in bytes, negative if not available.
+ */
+int64_t
+SystemUtilities::getPeakResidentMemoryInBytes()
+{
+#ifdef CARET_OS_LINUX
+    QFile statusFile("/proc/self/status");
+    if (statusFile.open(QFile::ReadOnly)) {
+        const QList<QByteArray> lines = statusFile.readAll().split('\n');
+        for (int32_t i = 0; i < lines.size(); i++) {
+            if (lines[i].startsWith("VmHWM:")) {
+                /*
+                 * Value is in kilobytes, "VmHWM:    123456 kB"
+                 */
+                const QList<QByteArray> fields = lines[i].simplified().split(' ');
+                if (fields.size() >= 2) {
+                    bool valid = false;
+                    const int64_t kilobytes = fields[1].toLongLong(&valid);
+                    if (valid) {
+                        return kilobytes * 1024;
+                    }
+                }
+            }
+        }
+    }
+#endif // CARET_OS_LINUX
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef CARET_OS_MACOSX
+        return usage.ru_maxrss; // bytes on Mac
+#else
+        return static_cast<int64_t>(usage.ru_maxrss) * 1024; // kilobytes elsewhere
+#endif
+    }
+#endif // _WIN32
+    return -1;
+}
+
+/**
+ * Reset the peak resident memory of this process to the current
+ * resident memory.  Only supported on Linux.
+ *
+ * @return  True if the peak was reset, else false.
+ */
+bool
+SystemUtilities::resetPeakResidentMemory()
+{
+#ifdef CARET_OS_LINUX
+    QFile clearRefsFile("/proc/self/clear_refs");
+    if (clearRefsFile.open(QFile::WriteOnly)) {
+        /*
+         * "5" resets the peak resident set size (Linux 4.0 and later)
+         */
+        if (clearRefsFile.write("5") == 1) {
+            return true;
+        }
+    }
+#endif // CARET_OS_LINUX
+    return false;
+}
+
+/**
+ * Get the processor time used by this process, summed over all
+ * of its threads (user and system time).
+ *
+ * @return  Processor time in seconds, negative if not available.
+ */
+double
+SystemUtilities::getProcessCpuTimeSeconds()
+{
+#ifdef _WIN32
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime)) {
+        /*
+         * FILETIME is in units of 100 nanoseconds
+         */
+        const uint64_t kernel = (static_cast<uint64_t>(kernelTime.dwHighDateTime) << 32) | kernelTime.dwLowDateTime;
+        const uint64_t user   = (static_cast<uint64_t>(userTime.dwHighDateTime) << 32) | userTime.dwLowDateTime;
+        return (kernel + user) / 1.0e7;
+    }
+#else  // _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+                + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1.0e6);
+    }
+#endif // _WIN32
+    return -1.0;
+}
+
 /**
  * Unit testing of assertions.
  * 
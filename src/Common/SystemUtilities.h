@@ -76,6 +76,12 @@ public:
     static bool isMacOperatingSystem();
 
     static int32_t getNumberOfProcessors();
+    
+    static int64_t getPeakResidentMemoryInBytes();
+    
+    static bool resetPeakResidentMemory();
+    
+    static double getProcessCpuTimeSeconds();
 
     static AString createUniqueID();
     
@@ -49,6 +49,8 @@
 #include "SessionManager.h"
 #include "SplashScreen.h"
 #include "SystemUtilities.h"
+#include "VolumeFile.h"
+#include "WorkbenchApplication.h"
 #include "WuQMessageBox.h"
 #include "WuQtUtilities.h"
 
@@ -264,6 +266,13 @@ main(int argc, char* argv[])
         */
         SessionManager::createSessionManager(ApplicationTypeEnum::APPLICATION_TYPE_GRAPHICAL_USER_INTERFACE);
         caretLoggerIsValid = true;
+        
+        /*
+         * Read frames of large 4D volumes as they are viewed, keeping
+         * at most 1GiB of frames in memory for each volume.  Evicted
+         * frames are freed by WorkbenchApplication between events.
+         */
+        VolumeFile::setLoadFramesOnDemand(true, ((int64_t)1) << 30);
 
         /*
         * Parameters for the program.
@@ -287,7 +296,7 @@ main(int argc, char* argv[])
         QApplication::setGraphicsSystem("raster");
         MacApplication app(argc, argv);
 #else //CARET_OS_MACOSX        
-        QApplication app(argc, argv);
+        WorkbenchApplication app(argc, argv);
 #endif //CARET_OS_MACOSX
         
         ApplicationInformation applicationInformation;
@@ -870,6 +870,7 @@ CaretMappableDataFile::helpCreateCartesianChartData(const std::vector<float>& da
             chartData->setTimeStepInSecondsAxisX(timeStep);
         }
         
+        chartData->reservePoints(numData);
         for (int64_t i = 0; i < numData; i++) {
             float xValue = i;
             
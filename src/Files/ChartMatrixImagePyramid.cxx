@@ -0,0 +1,321 @@
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2016  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include <algorithm>
+#include <cmath>
+
+#define __CHART_MATRIX_IMAGE_PYRAMID_DECLARE__
+#include "ChartMatrixImagePyramid.h"
+#undef __CHART_MATRIX_IMAGE_PYRAMID_DECLARE__
+
+#include "CaretAssert.h"
+#include "CaretOMP.h"
+
+using namespace caret;
+
+
+    
+/**
+ * \class caret::ChartMatrixImagePyramid 
+ * \brief RGBA image of a matrix chart with reduced resolution levels.
+ * \ingroup Files
+ *
+ * Level zero contains one pixel per matrix cell.  Each following level
+ * has half the rows and columns of the previous level (rounded up) so
+ * that a matrix with many more rows and columns than there are pixels
+ * in the viewport can be drawn from a small image.  Levels are built
+ * on the CPU (in parallel) and do not require an OpenGL context.
+ *
+ * Rows are in matrix order (first row of the matrix is the first row
+ * of the image).
+ */
+
+/**
+ * Constructor.
+ *
+ * @param numberOfRows
+ *     Number of rows in the matrix.
+ * @param numberOfColumns
+ *     Number of columns in the matrix.
+ * @param matrixRGBA
+ *     RGBA for each matrix cell, row by row, components ranging [0, 1]
+ *     (as produced by ChartableMatrixInterface::getMatrixDataRGBA()).
+ * @param aggregationMode
+ *     How cells are combined when building reduced levels.
+ */
+ChartMatrixImagePyramid::ChartMatrixImagePyramid(const int32_t numberOfRows,
+                                                 const int32_t numberOfColumns,
+                                                 const std::vector<float>& matrixRGBA,
+                                                 const AggregationMode aggregationMode)
+: m_aggregationMode(aggregationMode)
+{
+    CaretAssert(numberOfRows >= 0);
+    CaretAssert(numberOfColumns >= 0);
+    const int64_t numberOfComponents = static_cast<int64_t>(numberOfRows) * numberOfColumns * 4;
+    CaretAssert(static_cast<int64_t>(matrixRGBA.size()) >= numberOfComponents);
+    
+    m_levels.push_back(Level());
+    Level& levelZero = m_levels.back();
+    levelZero.m_numberOfRows    = numberOfRows;
+    levelZero.m_numberOfColumns = numberOfColumns;
+    levelZero.m_rgba.resize(numberOfComponents);
+    
+    uint8_t* rgbaOut = levelZero.m_rgba.data();
+    const float* rgbaIn = matrixRGBA.data();
+#pragma omp CARET_PARFOR schedule(static)
+    for (int64_t i = 0; i < numberOfComponents; i++) {
+        const float value = rgbaIn[i] * 255.0f + 0.5f;
+        rgbaOut[i] = static_cast<uint8_t>(std::min(std::max(value, 0.0f), 255.0f));
+    }
+}
+
+/**
+ * Destructor.
+ */
+ChartMatrixImagePyramid::~ChartMatrixImagePyramid()
+{
+}
+
+/**
+ * Build reduced levels up to and including the given level.  Levels
+ * that already exist are not rebuilt and no level smaller than one
+ * row by one column is created.
+ *
+ * @param maximumLevel
+ *     Highest level that is needed.
+ */
+void
+ChartMatrixImagePyramid::buildLevels(const int32_t maximumLevel)
+{
+    while (static_cast<int32_t>(m_levels.size()) <= maximumLevel) {
+        const Level& lastLevel = m_levels.back();
+        if ((lastLevel.m_numberOfRows <= 1)
+            && (lastLevel.m_numberOfColumns <= 1)) {
+            break;
+        }
+        reduceLevel(static_cast<int32_t>(m_levels.size()) - 1);
+    }
+}
+
+/**
+ * Create the level following the given level by combining each
+ * 2x2 block of cells (fewer along odd sized edges).
+ *
+ * @param level
+ *     Index of the level that is reduced, must be the last level.
+ */
+void
+ChartMatrixImagePyramid::reduceLevel(const int32_t level)
+{
+    CaretAssert(level == static_cast<int32_t>(m_levels.size()) - 1);
+    
+    Level newLevel;
+    newLevel.m_numberOfRows    = (m_levels[level].m_numberOfRows + 1) / 2;
+    newLevel.m_numberOfColumns = (m_levels[level].m_numberOfColumns + 1) / 2;
+    newLevel.m_rgba.resize(static_cast<int64_t>(newLevel.m_numberOfRows) * newLevel.m_numberOfColumns * 4);
+    m_levels.push_back(newLevel);
+    
+    /*
+     * Reference after push_back() since it may reallocate
+     */
+    const Level& inLevel = m_levels[level];
+    Level& outLevel = m_levels.back();
+    const int32_t inRows = inLevel.m_numberOfRows;
+    const int32_t inColumns = inLevel.m_numberOfColumns;
+    const int32_t outRows = outLevel.m_numberOfRows;
+    const int32_t outColumns = outLevel.m_numberOfColumns;
+    const uint8_t* rgbaIn = inLevel.m_rgba.data();
+    uint8_t* rgbaOut = outLevel.m_rgba.data();
+    const AggregationMode aggregationMode = m_aggregationMode;
+    
+#pragma omp CARET_PARFOR schedule(dynamic)
+    for (int32_t outRow = 0; outRow < outRows; outRow++) {
+        const int32_t firstRow = outRow * 2;
+        const int32_t lastRow  = std::min(firstRow + 1, inRows - 1);
+        for (int32_t outColumn = 0; outColumn < outColumns; outColumn++) {
+            const int32_t firstColumn = outColumn * 2;
+            const int32_t lastColumn  = std::min(firstColumn + 1, inColumns - 1);
+            uint8_t* cellOut = rgbaOut + (static_cast<int64_t>(outRow) * outColumns + outColumn) * 4;
+            
+            switch (aggregationMode) {
+                case AGGREGATION_MEAN:
+                {
+                    int32_t sum[4] = { 0, 0, 0, 0 };
+                    int32_t count = 0;
+                    for (int32_t row = firstRow; row <= lastRow; row++) {
+                        for (int32_t column = firstColumn; column <= lastColumn; column++) {
+                            const uint8_t* cellIn = rgbaIn + (static_cast<int64_t>(row) * inColumns + column) * 4;
+                            for (int32_t k = 0; k < 4; k++) {
+                                sum[k] += cellIn[k];
+                            }
+                            count++;
+                        }
+                    }
+                    for (int32_t k = 0; k < 4; k++) {
+                        cellOut[k] = static_cast<uint8_t>((sum[k] + count / 2) / count);
+                    }
+                }
+                    break;
+                case AGGREGATION_MAXIMUM:
+                {
+                    /*
+                     * Keep the color of one of the cells, so that label colors are
+                     * never blended and isolated cells do not fade away.
+                     * Transparent cells are only used if all cells are transparent.
+                     */
+                    const uint8_t* bestCell = rgbaIn + (static_cast<int64_t>(firstRow) * inColumns + firstColumn) * 4;
+                    int32_t bestLuminance = -1;
+                    for (int32_t row = firstRow; row <= lastRow; row++) {
+                        for (int32_t column = firstColumn; column <= lastColumn; column++) {
+                            const uint8_t* cellIn = rgbaIn + (static_cast<int64_t>(row) * inColumns + column) * 4;
+                            if (cellIn[3] == 0) {
+                                continue;
+                            }
+                            const int32_t luminance = (299 * cellIn[0]) + (587 * cellIn[1]) + (114 * cellIn[2]);
+                            if (luminance > bestLuminance) {
+                                bestLuminance = luminance;
+                                bestCell = cellIn;
+                            }
+                        }
+                    }
+                    for (int32_t k = 0; k < 4; k++) {
+                        cellOut[k] = bestCell[k];
+                    }
+                }
+                    break;
+            }
+        }
+    }
+}
+
+/**
+ * @return Number of levels that have been built (at least one).
+ */
+int32_t
+ChartMatrixImagePyramid::getNumberOfLevels() const
+{
+    return static_cast<int32_t>(m_levels.size());
+}
+
+/**
+ * @return Number of rows in the given level.
+ *
+ * @param level
+ *     Index of the level.
+ */
+int32_t
+ChartMatrixImagePyramid::getLevelNumberOfRows(const int32_t level) const
+{
+    CaretAssertVectorIndex(m_levels, level);
+    return m_levels[level].m_numberOfRows;
+}
+
+/**
+ * @return Number of columns in the given level.
+ *
+ * @param level
+ *     Index of the level.
+ */
+int32_t
+ChartMatrixImagePyramid::getLevelNumberOfColumns(const int32_t level) const
+{
+    CaretAssertVectorIndex(m_levels, level);
+    return m_levels[level].m_numberOfColumns;
+}
+
+/**
+ * @return RGBA bytes of the given level, row by row.
+ *
+ * @param level
+ *     Index of the level.
+ */
+const uint8_t*
+ChartMatrixImagePyramid::getLevelRGBA(const int32_t level) const
+{
+    CaretAssertVectorIndex(m_levels, level);
+    return m_levels[level].m_rgba.data();
+}
+
+/**
+ * Copy a rectangular region of a level (as needed for a texture tile).
+ *
+ * @param level
+ *     Index of the level.
+ * @param firstRow
+ *     First row of the region.
+ * @param firstColumn
+ *     First column of the region.
+ * @param numberOfRows
+ *     Number of rows in the region.
+ * @param numberOfColumns
+ *     Number of columns in the region.
+ * @param rgbaOut
+ *     Output containing the RGBA bytes of the region, row by row.
+ */
+void
+ChartMatrixImagePyramid::getLevelRegionRGBA(const int32_t level,
+                                            const int32_t firstRow,
+                                            const int32_t firstColumn,
+                                            const int32_t numberOfRows,
+                                            const int32_t numberOfColumns,
+                                            std::vector<uint8_t>& rgbaOut) const
+{
+    CaretAssertVectorIndex(m_levels, level);
+    const Level& myLevel = m_levels[level];
+    CaretAssert((firstRow >= 0) && (firstRow + numberOfRows <= myLevel.m_numberOfRows));
+    CaretAssert((firstColumn >= 0) && (firstColumn + numberOfColumns <= myLevel.m_numberOfColumns));
+    
+    rgbaOut.resize(static_cast<int64_t>(numberOfRows) * numberOfColumns * 4);
+    const int64_t rowBytes = static_cast<int64_t>(numberOfColumns) * 4;
+    for (int32_t row = 0; row < numberOfRows; row++) {
+        const uint8_t* rowStart = myLevel.m_rgba.data() + (static_cast<int64_t>(firstRow + row) * myLevel.m_numberOfColumns + firstColumn) * 4;
+        std::copy(rowStart,
+                  rowStart + rowBytes,
+                  rgbaOut.begin() + row * rowBytes);
+    }
+}
+
+/**
+ * Get the level to draw so that each cell of the level is about
+ * one pixel (or larger) on the screen.
+ *
+ * @param cellWidthPixels
+ *     Width of a level zero cell in pixels.
+ * @param cellHeightPixels
+ *     Height of a level zero cell in pixels.
+ * @return
+ *     Level (may be greater than the number of levels, so use
+ *     buildLevels() and getNumberOfLevels() to limit it).
+ */
+int32_t
+ChartMatrixImagePyramid::getLevelForCellSize(const float cellWidthPixels,
+                                             const float cellHeightPixels)
+{
+    const float smallestSize = std::min(cellWidthPixels,
+                                        cellHeightPixels);
+    if ((smallestSize >= 1.0f)
+        || (smallestSize <= 0.0f)) {
+        return 0;
+    }
+    
+    const int32_t level = static_cast<int32_t>(std::floor(std::log(1.0f / smallestSize) / std::log(2.0f)));
+    return std::min(std::max(level, 0), 30);
+}
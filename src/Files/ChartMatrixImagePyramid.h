@@ -0,0 +1,98 @@
+#ifndef __CHART_MATRIX_IMAGE_PYRAMID_H__
+#define __CHART_MATRIX_IMAGE_PYRAMID_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2016  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+
+#include <stdint.h>
+#include <vector>
+
+namespace caret {
+
+    class ChartMatrixImagePyramid {
+        
+    public:
+        /**
+         * How the 2x2 cells of one level are combined into a cell of the next level.
+         */
+        enum AggregationMode {
+            /** Average of the cells' RGBA components */
+            AGGREGATION_MEAN,
+            /** Color of the brightest non-transparent cell */
+            AGGREGATION_MAXIMUM
+        };
+        
+        ChartMatrixImagePyramid(const int32_t numberOfRows,
+                                const int32_t numberOfColumns,
+                                const std::vector<float>& matrixRGBA,
+                                const AggregationMode aggregationMode);
+        
+        virtual ~ChartMatrixImagePyramid();
+        
+        void buildLevels(const int32_t maximumLevel);
+        
+        int32_t getNumberOfLevels() const;
+        
+        int32_t getLevelNumberOfRows(const int32_t level) const;
+        
+        int32_t getLevelNumberOfColumns(const int32_t level) const;
+        
+        const uint8_t* getLevelRGBA(const int32_t level) const;
+        
+        void getLevelRegionRGBA(const int32_t level,
+                                const int32_t firstRow,
+                                const int32_t firstColumn,
+                                const int32_t numberOfRows,
+                                const int32_t numberOfColumns,
+                                std::vector<uint8_t>& rgbaOut) const;
+        
+        static int32_t getLevelForCellSize(const float cellWidthPixels,
+                                           const float cellHeightPixels);
+        
+        // ADD_NEW_METHODS_HERE
+
+    private:
+        ChartMatrixImagePyramid(const ChartMatrixImagePyramid&);
+
+        ChartMatrixImagePyramid& operator=(const ChartMatrixImagePyramid&);
+        
+        void reduceLevel(const int32_t level);
+        
+        struct Level {
+            int32_t m_numberOfRows;
+            int32_t m_numberOfColumns;
+            std::vector<uint8_t> m_rgba;
+        };
+        
+        const AggregationMode m_aggregationMode;
+        
+        std::vector<Level> m_levels;
+        
+        // ADD_NEW_MEMBERS_HERE
+
+    };
+    
+#ifdef __CHART_MATRIX_IMAGE_PYRAMID_DECLARE__
+    // <PLACE DECLARATIONS OF STATIC MEMBERS HERE>
+#endif // __CHART_MATRIX_IMAGE_PYRAMID_DECLARE__
+
+} // namespace
+#endif  //__CHART_MATRIX_IMAGE_PYRAMID_H__
@@ -19,8 +19,9 @@
  */
 /*LICENSE_END*/
 
+#include <algorithm>
 #include <cmath>
-#include <iostream>
+#include <new>
 
 #define __CIFTI_CONNECTIVITY_MATRIX_DENSE_DYNAMIC_FILE_DECLARE__
 #include "CiftiConnectivityMatrixDenseDynamicFile.h"
@@ -46,6 +47,12 @@ using namespace caret;
  * Internally, the file format is the same as a data series file.  When
  * a row is requested, the row is correlated with all other rows
  * producing the connectivity from that row to all other rows.
+ *
+ * When memory permits, a normalized copy of all rows (zero mean and
+ * unit sum-squared) is kept in one contiguous, aligned block so that
+ * the correlation of a row (or an average of rows) with all other rows
+ * is a single matrix-vector product.  Otherwise, rows are read in blocks
+ * and normalized as they are used.
  */
 
 /**
@@ -62,7 +69,8 @@ m_numberOfBrainordinates(-1),
 m_numberOfTimePoints(-1),
 m_validDataFlag(false),
 m_enabledAsLayer(true),
-m_cacheDataFlag(false)
+m_normalizedData(NULL),
+m_normalizedRowStride(0)
 {
     CaretAssert(m_parentDataSeriesFile);
 
@@ -76,6 +84,10 @@ m_cacheDataFlag(false)
  */
 CiftiConnectivityMatrixDenseDynamicFile::~CiftiConnectivityMatrixDenseDynamicFile()
 {
+    /*
+     * Row loader's thread may be using this file's virtual methods
+     */
+    clearRowLoader();
 }
 
 /**
@@ -148,6 +160,8 @@ CiftiConnectivityMatrixDenseDynamicFile::updateAfterReading(const CiftiFile* cif
 {
     m_validDataFlag = false;
     
+    clearRowLoader();
+    
     m_parentDataSeriesCiftiFile = const_cast<CiftiFile*>(ciftiFile);
     
     AString path, nameNoExt, ext;
@@ -166,28 +180,12 @@ CiftiConnectivityMatrixDenseDynamicFile::updateAfterReading(const CiftiFile* cif
     m_numberOfTimePoints     = ciftiXML.getSeriesMap(CiftiXML::ALONG_ROW).getLength();
     
     m_rowData.clear();
+    clearNormalizedData();
     
     if ((m_numberOfBrainordinates > 0)
         && (m_numberOfTimePoints > 0)) {
         m_rowData.resize(m_numberOfBrainordinates);
         
-        if (m_cacheDataFlag) {
-            /*
-             * Read all of the data.  Time-series type files are not
-             * too large and by caching the data, it eliminates
-             * numerous calls to read the data when correlation
-             * is performed.
-             *
-             * READ DATA FROM PARENT FILE
-             */
-            for (int32_t i = 0; i < m_numberOfBrainordinates; i++) {
-                CaretAssertVectorIndex(m_rowData, i);
-                m_rowData[i].m_data.resize(m_numberOfTimePoints);
-                m_parentDataSeriesCiftiFile->getRow(&m_rowData[i].m_data[0],
-                                                    i);
-            }
-        }
-        
         preComputeRowMeanAndSumSquared();
         
         m_validDataFlag = true;
@@ -228,6 +226,26 @@ CiftiConnectivityMatrixDenseDynamicFile::getDataForRow(float* dataOut,
                                         index);
 }
 
+/**
+ * Load data for adjacent rows.
+ *
+ * @param dataOut
+ *     Output with data, the rows are consecutive.
+ * @param firstIndex
+ *     Index of the first row.
+ * @param numberOfRows
+ *     Number of rows.
+ */
+void
+CiftiConnectivityMatrixDenseDynamicFile::getDataForRows(float* dataOut,
+                                                        const int64_t& firstIndex,
+                                                        const int64_t& numberOfRows) const
+{
+    m_parentDataSeriesCiftiFile->getRows(dataOut,
+                                         firstIndex,
+                                         numberOfRows);
+}
+
 /**
  * Load PROCESSED data for the given column.
  *
@@ -268,25 +286,24 @@ CiftiConnectivityMatrixDenseDynamicFile::getProcessedDataForRow(float* dataOut,
         return;
     }
     
-    std::vector<float> rowData(m_numberOfTimePoints);
-    m_parentDataSeriesCiftiFile->getRow(&rowData[0], index);
-    const float mean = m_rowData[index].m_mean;
-    const float ssxx = m_rowData[index].m_sqrt_ssxx;
+    CaretAssertVectorIndex(m_rowData, index);
     
-    /*
-     * TSC: hyperthreading means some cores end up "faster" than others, so "static" scheduling is generally not as fast
-     * there is almost no overhead to dynamic scheduling
-     */
-#pragma omp CARET_PARFOR schedule(dynamic)
-    for (int32_t iRow = 0; iRow < m_numberOfBrainordinates; iRow++) {
-        float coefficient = 1.0;
-        
-        if (iRow != index) {
-            coefficient = correlation(rowData, mean, ssxx, iRow, m_numberOfTimePoints);
-        }
-        
-        dataOut[iRow] = coefficient;
+    if (m_normalizedData != NULL) {
+        computeCorrelations(m_normalizedData + (index * m_normalizedRowStride),
+                            dataOut);
     }
+    else {
+        std::vector<float> rowData(m_numberOfTimePoints);
+        m_parentDataSeriesCiftiFile->getRow(&rowData[0], index);
+        normalizeData(&rowData[0],
+                      m_numberOfTimePoints,
+                      m_rowData[index].m_mean,
+                      m_rowData[index].m_sqrt_ssxx);
+        computeCorrelations(&rowData[0],
+                            dataOut);
+    }
+    
+    dataOut[index] = 1.0;
 }
 
 /**
@@ -297,7 +314,7 @@ CiftiConnectivityMatrixDenseDynamicFile::getProcessedDataForRow(float* dataOut,
  *     The row average data.
  */
 void
-CiftiConnectivityMatrixDenseDynamicFile::processRowAverageData(std::vector<float>& rowAverageDataInOut)
+CiftiConnectivityMatrixDenseDynamicFile::processRowAverageData(std::vector<float>& rowAverageDataInOut) const
 {
     if ((m_numberOfBrainordinates <= 0)
         || (m_numberOfTimePoints <= 0)) {
@@ -323,30 +340,23 @@ CiftiConnectivityMatrixDenseDynamicFile::processRowAverageData(std::vector<float
                                  mean,
                                  sumSquared);
     
-    std::vector<float> processedRowAverageData(m_numberOfBrainordinates);
+    normalizeData(&rowAverageDataInOut[0],
+                  dataLength,
+                  mean,
+                  sumSquared);
     
-    /*
-     * TSC: hyperthreading means some cores end up "faster" than others, so "static" scheduling is generally not as fast
-     * there is almost no overhead to dynamic scheduling
-     */
-#pragma omp CARET_PARFOR schedule(dynamic)
-    for (int32_t iRow = 0; iRow < m_numberOfBrainordinates; iRow++) {
-        const float coefficient = correlation(rowAverageDataInOut,
-                                              mean,
-                                              sumSquared,
-                                              iRow,
-                                              dataLength);
-        CaretAssertVectorIndex(processedRowAverageData, iRow);
-        processedRowAverageData[iRow] = coefficient;
-    }
+    std::vector<float> processedRowAverageData(m_numberOfBrainordinates);
+    computeCorrelations(&rowAverageDataInOut[0],
+                        &processedRowAverageData[0]);
     
-    rowAverageDataInOut = processedRowAverageData;
+    rowAverageDataInOut.swap(processedRowAverageData);
 }
 
 
 /**
  * Compute the mean and sum-squared for each row so that they
- * are only calculated once.
+ * are only calculated once.  If the normalized data fits within
+ * the memory limit, the normalized copy of all rows is also created.
  */
 void
 CiftiConnectivityMatrixDenseDynamicFile::preComputeRowMeanAndSumSquared()
@@ -355,66 +365,69 @@ CiftiConnectivityMatrixDenseDynamicFile::preComputeRowMeanAndSumSquared()
     CaretAssert(m_numberOfTimePoints > 0);
 
     /*
-     * TSC: hyperthreading means some cores end up "faster" than others, so "static" scheduling is generally not as fast
-     * there is almost no overhead to dynamic scheduling
+     * Pad rows so that every row starts on an aligned address
      */
-#pragma omp CARET_PARFOR schedule(dynamic)
-    for (int32_t iRow = 0; iRow < m_numberOfBrainordinates; iRow++) {
-
-        CaretAssertVectorIndex(m_rowData, iRow);
+    const int64_t alignmentInFloats = s_alignmentInBytes / sizeof(float);
+    const int64_t rowStride = (((m_numberOfTimePoints + alignmentInFloats - 1) / alignmentInFloats)
+                               * alignmentInFloats);
+    const int64_t normalizedDataSizeInBytes = (static_cast<int64_t>(m_numberOfBrainordinates)
+                                               * rowStride * sizeof(float));
+    if (normalizedDataSizeInBytes <= s_maximumNormalizedDataSizeInBytes) {
+        try {
+            m_normalizedDataStorage.resize(m_numberOfBrainordinates * rowStride + alignmentInFloats,
+                                           0.0);
+            const uintptr_t address = reinterpret_cast<uintptr_t>(&m_normalizedDataStorage[0]);
+            const int64_t alignmentOffset = (((s_alignmentInBytes - (address % s_alignmentInBytes)) % s_alignmentInBytes)
+                                             / sizeof(float));
+            m_normalizedData = &m_normalizedDataStorage[alignmentOffset];
+            m_normalizedRowStride = rowStride;
+        }
+        catch (const std::bad_alloc&) {
+            clearNormalizedData();
+        }
+    }
+    if (m_normalizedData == NULL) {
+        CaretLogFine("Normalized data for "
+                     + getFileNameNoPath()
+                     + " exceeds memory limit, rows will be normalized when read.");
+    }
+    
+    const int64_t rowsPerBlock = getNumberOfRowsPerReadBlock();
+    std::vector<float> blockData(rowsPerBlock * m_numberOfTimePoints);
+    
+    for (int64_t firstRow = 0; firstRow < m_numberOfBrainordinates; firstRow += rowsPerBlock) {
+        const int64_t numberOfRows = std::min(rowsPerBlock,
+                                              m_numberOfBrainordinates - firstRow);
+        m_parentDataSeriesCiftiFile->getRows(&blockData[0],
+                                             firstRow,
+                                             numberOfRows);
         
-        if (m_cacheDataFlag) {
-            CaretAssertVectorIndex(m_rowData[iRow].m_data, (m_numberOfTimePoints - 1));
-            computeDataMeanAndSumSquared(&m_rowData[iRow].m_data[0],
+        /*
+         * TSC: hyperthreading means some cores end up "faster" than others, so "static" scheduling is generally not as fast
+         * there is almost no overhead to dynamic scheduling
+         */
+#pragma omp CARET_PARFOR schedule(dynamic)
+        for (int64_t i = 0; i < numberOfRows; i++) {
+            const int64_t iRow = firstRow + i;
+            CaretAssertVectorIndex(m_rowData, iRow);
+            RowData& rowData = m_rowData[iRow];
+            const float* data = &blockData[i * m_numberOfTimePoints];
+            computeDataMeanAndSumSquared(data,
                                          m_numberOfTimePoints,
-                                         m_rowData[iRow].m_mean,
-                                         m_rowData[iRow].m_sqrt_ssxx);
-        }
-        else {
-            std::vector<float> data(m_numberOfTimePoints);
-#pragma omp critical
-            {//TSC: this can do disk access, which is not currently thread-safe
-                m_parentDataSeriesCiftiFile->getRow(&data[0], iRow);
+                                         rowData.m_mean,
+                                         rowData.m_sqrt_ssxx);
+            
+            if (m_normalizedData != NULL) {
+                float* normalizedRow = m_normalizedData + (iRow * m_normalizedRowStride);
+                std::copy(data,
+                          data + m_numberOfTimePoints,
+                          normalizedRow);
+                normalizeData(normalizedRow,
+                              m_numberOfTimePoints,
+                              rowData.m_mean,
+                              rowData.m_sqrt_ssxx);
             }
-            computeDataMeanAndSumSquared(&data[0],
-                                         m_numberOfTimePoints,
-                                         m_rowData[iRow].m_mean,
-                                         m_rowData[iRow].m_sqrt_ssxx);
         }
-        
-//        double sum = 0.0;
-//        double sumSquared = 0.0;
-//        if (m_cacheDataFlag) {
-//            for (int32_t iPoint = 0; iPoint < m_numberOfTimePoints; iPoint++) {
-//                CaretAssertVectorIndex(m_rowData[iRow].m_data, iPoint);
-//                const float d = m_rowData[iRow].m_data[iPoint];
-//                sum        += d;
-//                sumSquared += (d * d);
-//            }
-//        }
-//        else {
-//            std::vector<float> data(m_numberOfTimePoints);
-//            m_parentDataSeriesCiftiFile->getRow(&data[0], iRow);
-//            for (int32_t iPoint = 0; iPoint < m_numberOfTimePoints; iPoint++) {
-//                CaretAssertVectorIndex(data, iPoint);
-//                const float d = data[iPoint];
-//                sum        += d;
-//                sumSquared += (d * d);
-//            }
-//        }
-//        
-//        const float mean       = (sum / numPointsFloat);
-//        const float ssxx = (sumSquared - (numPointsFloat * mean * mean));
-//        CaretAssert(ssxx >= 0.0);
-//        
-//        const float meanDiff = std::fabs(mean - m_rowData[iRow].m_mean);
-//        const float ssDiff   = std::fabs(std::sqrt(ssxx) - m_rowData[iRow].m_sqrt_ssxx);
-//        if ((meanDiff > 0.0001) || (ssDiff > 0.0001)) {
-//            std::cout << "Mean/SS diff" << std::endl;
-//        }
-//        
-//        m_rowData[iRow].m_mean = mean;
-//        m_rowData[iRow].m_sqrt_ssxx = std::sqrt(ssxx);
     }
 }
 
@@ -460,107 +473,133 @@ CiftiConnectivityMatrixDenseDynamicFile::computeDataMeanAndSumSquared(const floa
 
 
 /**
- * Correlation from https://en.wikipedia.org/wiki/Pearson_product-moment_correlation_coefficient
+ * Normalize data so that it has a mean of zero and a sum-squared
+ * of one.  The correlation of two normalized arrays is their
+ * dot product (https://en.wikipedia.org/wiki/Pearson_product-moment_correlation_coefficient).
+ * If the data has no variance, it is set to zeros so that its
+ * correlation with any other data is zero.
  *
- * @param data
- *     Data for correlation
+ * @param dataInOut
+ *     Data that is normalized.
+ * @param dataLength
+ *     Number of items in data.
  * @param mean
- *     Mean of data
+ *     Mean of data.
  * @param sumSquared
- *     Sum squared of data.
- * @param otherRowIndex
- *     Index of another row
- * @param numberOfPoints
- *     Number of points int the two arrays
- * @return
- *     The correlation coefficient computed on the two arrays.
+ *     Square root of sum-squared deviation of data.
  */
-float
-CiftiConnectivityMatrixDenseDynamicFile::correlation(const std::vector<float>& data,
-                                                     const float mean,
-                                                     const float sumSquared,
-                                                     const int32_t otherRowIndex,
-                                                     const int32_t numberOfPoints) const
+void
+CiftiConnectivityMatrixDenseDynamicFile::normalizeData(float* dataInOut,
+                                                       const int32_t dataLength,
+                                                       const float mean,
+                                                       const float sumSquared) const
 {
-    const double numFloat = numberOfPoints;
-    double xySum = 0.0;
-    
-    CaretAssertVectorIndex(m_rowData, otherRowIndex);
-    const RowData& otherData = m_rowData[otherRowIndex];
-    
-    if (m_cacheDataFlag) {
-        xySum = sddot(&data[0], &otherData.m_data[0], numberOfPoints);
+    if (sumSquared > 0.0) {
+        const float scale = 1.0 / sumSquared;
+        for (int32_t i = 0; i < dataLength; i++) {
+            dataInOut[i] = (dataInOut[i] - mean) * scale;
+        }
     }
     else {
-        std::vector<float> otherDataVector(m_numberOfTimePoints);
-        m_parentDataSeriesCiftiFile->getRow(&otherDataVector[0], otherRowIndex);
-        xySum = sddot(&data[0], &otherDataVector[0], numberOfPoints);
+        std::fill(dataInOut,
+                  dataInOut + dataLength,
+                  0.0f);
     }
-    
-    const double ssxy = xySum - (numFloat * mean * otherData.m_mean);
-    
-    float correlationCoefficient = 0.0;
-    if ((sumSquared > 0.0)
-        && (otherData.m_sqrt_ssxx > 0.0)) {
-        correlationCoefficient = (ssxy / (sumSquared * otherData.m_sqrt_ssxx));
-    }
-    return correlationCoefficient;
 }
 
 /**
- * Correlation from https://en.wikipedia.org/wiki/Pearson_product-moment_correlation_coefficient
+ * Correlate normalized data with all rows.  With the normalized
+ * copy of the rows, this is a matrix-vector product that is split
+ * into blocks of rows processed in parallel.  Otherwise, rows are
+ * read in blocks and normalized before the dot products.
  *
- * @param rowIndex
- *     Index of a row
- * @param otherRowIndex
- *     Index of another row
- * @param numberOfPoints
- *     Number of points int the two arrays
- * @return
- *     The correlation coefficient computed on the two arrays.
+ * @param normalizedData
+ *     Normalized data (see normalizeData()).
+ * @param dataOut
+ *     Output with correlation to each row, must contain number
+ *     of brainordinates elements.
  */
-float
-CiftiConnectivityMatrixDenseDynamicFile::correlation(const int32_t rowIndex,
-                                                     const int32_t otherRowIndex,
-                                                     const int32_t numberOfPoints) const
+void
+CiftiConnectivityMatrixDenseDynamicFile::computeCorrelations(const float* normalizedData,
+                                                             float* dataOut) const
 {
-    const double numFloat = numberOfPoints;
-    double xySum = 0.0;
-    
-    CaretAssertVectorIndex(m_rowData, rowIndex);
-    CaretAssertVectorIndex(m_rowData, otherRowIndex);
-    const RowData& data = m_rowData[rowIndex];
-    const RowData& otherData = m_rowData[otherRowIndex];
-    
-    if (m_cacheDataFlag) {
-        for (int i = 0; i < numberOfPoints; i++) {
-            CaretAssertVectorIndex(data.m_data, i);
-            CaretAssertVectorIndex(otherData.m_data, i);
-            xySum += data.m_data[i] * otherData.m_data[i];
+    if (m_normalizedData != NULL) {
+        const int64_t numberOfBlocks = ((m_numberOfBrainordinates + s_correlationRowBlockSize - 1)
+                                        / s_correlationRowBlockSize);
+        
+        /*
+         * TSC: hyperthreading means some cores end up "faster" than others, so "static" scheduling is generally not as fast
+         * there is almost no overhead to dynamic scheduling
+         */
+#pragma omp CARET_PARFOR schedule(dynamic)
+        for (int64_t iBlock = 0; iBlock < numberOfBlocks; iBlock++) {
+            const int64_t firstRow = iBlock * s_correlationRowBlockSize;
+            const int64_t lastRow  = std::min(firstRow + s_correlationRowBlockSize,
+                                              static_cast<int64_t>(m_numberOfBrainordinates));
+            const float* rowPointer = m_normalizedData + (firstRow * m_normalizedRowStride);
+            for (int64_t iRow = firstRow; iRow < lastRow; iRow++) {
+                dataOut[iRow] = sddot(normalizedData,
+                                      rowPointer,
+                                      m_numberOfTimePoints);
+                rowPointer += m_normalizedRowStride;
+            }
         }
     }
     else {
-        std::vector<float> dataVector(m_numberOfTimePoints);
-        std::vector<float> otherDataVector(m_numberOfTimePoints);
-        m_parentDataSeriesCiftiFile->getRow(&dataVector[0], rowIndex);
-        m_parentDataSeriesCiftiFile->getRow(&otherDataVector[0], otherRowIndex);
+        const int64_t rowsPerBlock = getNumberOfRowsPerReadBlock();
+        std::vector<float> blockData(rowsPerBlock * m_numberOfTimePoints);
         
-        for (int i = 0; i < numberOfPoints; i++) {
-            CaretAssertVectorIndex(dataVector, i);
-            CaretAssertVectorIndex(otherDataVector, i);
-            xySum += dataVector[i] * otherDataVector[i];
+        for (int64_t firstRow = 0; firstRow < m_numberOfBrainordinates; firstRow += rowsPerBlock) {
+            const int64_t numberOfRows = std::min(rowsPerBlock,
+                                                  m_numberOfBrainordinates - firstRow);
+            m_parentDataSeriesCiftiFile->getRows(&blockData[0],
+                                                 firstRow,
+                                                 numberOfRows);
+            
+#pragma omp CARET_PARFOR schedule(dynamic)
+            for (int64_t i = 0; i < numberOfRows; i++) {
+                const int64_t iRow = firstRow + i;
+                CaretAssertVectorIndex(m_rowData, iRow);
+                float* rowPointer = &blockData[i * m_numberOfTimePoints];
+                normalizeData(rowPointer,
+                              m_numberOfTimePoints,
+                              m_rowData[iRow].m_mean,
+                              m_rowData[iRow].m_sqrt_ssxx);
+                dataOut[iRow] = sddot(normalizedData,
+                                      rowPointer,
+                                      m_numberOfTimePoints);
+            }
         }
     }
+}
+
+/**
+ * @return Number of rows read at one time when the rows are
+ * read from the parent file.
+ */
+int64_t
+CiftiConnectivityMatrixDenseDynamicFile::getNumberOfRowsPerReadBlock() const
+{
+    CaretAssert(m_numberOfTimePoints > 0);
     
-    const double ssxy = xySum - (numFloat * data.m_mean * otherData.m_mean);
-    
-    float correlationCoefficient = 0.0;
-    if ((data.m_sqrt_ssxx > 0.0)
-        && (otherData.m_sqrt_ssxx > 0.0)) {
-        correlationCoefficient = (ssxy / (data.m_sqrt_ssxx * otherData.m_sqrt_ssxx));
-    }
-    return correlationCoefficient;
+    const int64_t rowSizeInBytes = m_numberOfTimePoints * sizeof(float);
+    const int64_t numberOfRows = std::max(static_cast<int64_t>(1),
+                                          s_readBlockSizeInBytes / rowSizeInBytes);
+    return std::min(numberOfRows,
+                    static_cast<int64_t>(m_numberOfBrainordinates));
 }
+
+/**
+ * Release the normalized data.
+ */
+void
+CiftiConnectivityMatrixDenseDynamicFile::clearNormalizedData()
+{
+    std::vector<float>().swap(m_normalizedDataStorage);
+    m_normalizedData = NULL;
+    m_normalizedRowStride = 0;
+}
+
 /**
  * Save subclass data to the scene.
  *
@@ -58,12 +58,14 @@ namespace caret {
         virtual void getDataForColumn(float* dataOut, const int64_t& index) const;
         
         virtual void getDataForRow(float* dataOut, const int64_t& index) const;
+        
+        virtual void getDataForRows(float* dataOut, const int64_t& firstIndex, const int64_t& numberOfRows) const;
                 
         virtual void getProcessedDataForColumn(float* dataOut, const int64_t& index) const;
         
         virtual void getProcessedDataForRow(float* dataOut, const int64_t& index) const;
         
-        virtual void processRowAverageData(std::vector<float>& rowAverageData);
+        virtual void processRowAverageData(std::vector<float>& rowAverageData) const;
         
         virtual void saveSubClassDataToScene(const SceneAttributes* sceneAttributes,
                                              SceneClass* sceneClass);
@@ -78,21 +80,10 @@ namespace caret {
             
             ~RowData() { }
             
-            std::vector<float> m_data;
             float m_mean;
             float m_sqrt_ssxx;
         };
         
-        float correlation(const int32_t rowIndex,
-                          const int32_t otherRowIndex,
-                          const int32_t numberOfPoints) const;
-        
-        float correlation(const std::vector<float>& data,
-                          const float mean,
-                          const float sumSquared,
-                          const int32_t otherRowIndex,
-                          const int32_t numberOfPoints) const;
-        
         void preComputeRowMeanAndSumSquared();
         
         void computeDataMeanAndSumSquared(const float* data,
@@ -100,6 +91,18 @@ namespace caret {
                                           float& meanOut,
                                           float& sumSquaredOut) const;
         
+        void normalizeData(float* dataInOut,
+                           const int32_t dataLength,
+                           const float mean,
+                           const float sumSquared) const;
+        
+        void computeCorrelations(const float* normalizedData,
+                                 float* dataOut) const;
+        
+        int64_t getNumberOfRowsPerReadBlock() const;
+        
+        void clearNormalizedData();
+        
         CiftiBrainordinateDataSeriesFile* m_parentDataSeriesFile;
         
         CiftiFile* m_parentDataSeriesCiftiFile;
@@ -114,7 +117,27 @@ namespace caret {
         
         bool m_enabledAsLayer;
         
-        const bool m_cacheDataFlag;
+        /** Storage for the normalized data, includes padding for alignment */
+        std::vector<float> m_normalizedDataStorage;
+        
+        /** 
+         * Aligned, normalized data for all rows (zero mean, unit sum-squared)
+         * so that correlation is a dot product.  NULL if the normalized data
+         * would exceed the memory limit and rows are normalized when read.
+         */
+        float* m_normalizedData;
+        
+        /** Number of elements between rows in the normalized data */
+        int64_t m_normalizedRowStride;
+        
+        static const int64_t s_maximumNormalizedDataSizeInBytes;
+        
+        static const int64_t s_readBlockSizeInBytes;
+        
+        static const int64_t s_correlationRowBlockSize;
+        
+        static const int64_t s_alignmentInBytes;
+        
         
         CaretPointer<SceneClassAssistant> m_sceneAssistant;
         
@@ -123,7 +146,10 @@ namespace caret {
     };
     
 #ifdef __CIFTI_CONNECTIVITY_MATRIX_DENSE_DYNAMIC_FILE_DECLARE__
-    // <PLACE DECLARATIONS OF STATIC MEMBERS HERE>
+    const int64_t CiftiConnectivityMatrixDenseDynamicFile::s_maximumNormalizedDataSizeInBytes = static_cast<int64_t>(2048) * 1024 * 1024;
+    const int64_t CiftiConnectivityMatrixDenseDynamicFile::s_readBlockSizeInBytes = 64 * 1024 * 1024;
+    const int64_t CiftiConnectivityMatrixDenseDynamicFile::s_correlationRowBlockSize = 256;
+    const int64_t CiftiConnectivityMatrixDenseDynamicFile::s_alignmentInBytes = 32;
 #endif // __CIFTI_CONNECTIVITY_MATRIX_DENSE_DYNAMIC_FILE_DECLARE__
 
 } // namespace
@@ -410,6 +410,7 @@ CiftiConnectivityMatrixParcelFile::restoreSubClassDataFromScene(const SceneAttri
 {
     m_sceneAssistant->restoreMembers(sceneAttributes,
                                      sceneClass);
+    invalidateMatrixChartImagePyramid();
     
     //    CiftiMappableConnectivityMatrixDataFile::restoreFileDataFromScene(sceneAttributes,
     //                                                                      sceneClass);
@@ -666,6 +667,7 @@ CiftiConnectivityMatrixParcelFile::setSelectedParcelLabelFileAndMapForReordering
     m_parcelReorderingModel->setSelectedParcelLabelFileAndMapForReordering(selectedParcelLabelFile,
                                                                            selectedParcelLabelFileMapIndex,
                                                                            enabledStatus);
+    invalidateMatrixChartImagePyramid();
 }
 
 /**
@@ -707,6 +709,7 @@ CiftiConnectivityMatrixParcelFile::createParcelReordering(const CiftiParcelLabel
                                                    const int32_t parcelLabelFileMapIndex,
                                                    AString& errorMessageOut)
 {
+    invalidateMatrixChartImagePyramid();
     return m_parcelReorderingModel->createParcelReordering(parcelLabelFile,
                                                            parcelLabelFileMapIndex,
                                                            errorMessageOut);
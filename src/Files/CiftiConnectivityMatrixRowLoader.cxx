@@ -0,0 +1,558 @@
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2016  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#define __CIFTI_CONNECTIVITY_MATRIX_ROW_LOADER_DECLARE__
+#include "CiftiConnectivityMatrixRowLoader.h"
+#undef __CIFTI_CONNECTIVITY_MATRIX_ROW_LOADER_DECLARE__
+
+#include <algorithm>
+
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <QThread>
+
+#include "CaretAssert.h"
+#include "CaretException.h"
+#include "CaretLogger.h"
+#include "CiftiMappableConnectivityMatrixDataFile.h"
+
+using namespace caret;
+
+namespace caret {
+    /**
+     * Thread that runs the loader's request loop.
+     */
+    class CiftiConnectivityMatrixRowLoaderThread : public QThread {
+    public:
+        CiftiConnectivityMatrixRowLoaderThread(CiftiConnectivityMatrixRowLoader* loader)
+        : QThread(),
+        m_loader(loader) { }
+
+        void run() {
+            m_loader->processRequests();
+        }
+
+    private:
+        CiftiConnectivityMatrixRowLoader* m_loader;
+    };
+}
+
+/**
+ * \class caret::CiftiConnectivityMatrixRowLoader
+ * \brief Loads rows or columns from a connectivity matrix file.
+ * \ingroup Files
+ *
+ * Reading a row from a large connectivity file that is not in
+ * memory is slow enough that reading on the GUI thread makes the
+ * user interface stall, particularly when the user moves quickly
+ * from one brainordinate to another.
+ *
+ * Asynchronous loads are performed by a worker thread.  Only the
+ * newest request matters, so a request that has not started when
+ * a newer request arrives is discarded and the result of a request
+ * that finishes after a newer request was made is never returned.
+ *
+ * When an asynchronous load completes, an event is posted to the
+ * receiver set with setCompletionEventReceiver() so that the thread
+ * that owns the file (GUI thread) can finish the load.
+ *
+ * Single rows and columns, from both synchronous and asynchronous
+ * loads, are kept in a least recently used cache whose size is
+ * set by the user's preferences.
+ */
+
+/**
+ * Constructor of an empty request.
+ */
+CiftiConnectivityMatrixRowLoader::Request::Request()
+: m_rowFlag(true),
+m_averageFlag(false),
+m_dataCount(0)
+{
+}
+
+/**
+ * Constructor.
+ *
+ * @param dataFile
+ *    File whose rows or columns are loaded.
+ */
+CiftiConnectivityMatrixRowLoader::CiftiConnectivityMatrixRowLoader(const CiftiMappableConnectivityMatrixDataFile* dataFile)
+: CaretObject(),
+m_dataFile(dataFile)
+{
+    CaretAssert(dataFile);
+
+    m_thread                      = NULL;
+    m_pendingRequestIdentifier    = -1;
+    m_inProgressRequestIdentifier = -1;
+    m_completedRequestIdentifier  = -1;
+    m_nextRequestIdentifier       = 1;
+    m_cacheSizeInBytes            = 0;
+    m_maximumCacheSizeInBytes     = 0;
+    m_stopFlag                    = false;
+}
+
+/**
+ * Destructor.  Waits for the worker thread to finish.
+ */
+CiftiConnectivityMatrixRowLoader::~CiftiConnectivityMatrixRowLoader()
+{
+    if (m_thread != NULL) {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_stopFlag = true;
+            m_pendingRequestIdentifier = -1;
+            m_workAvailableCondition.wakeAll();
+        }
+
+        m_thread->wait();
+        delete m_thread;
+        m_thread = NULL;
+    }
+
+    clearCache();
+}
+
+/**
+ * Set the size of the cache of recently loaded rows and columns.
+ *
+ * @param cacheSizeInBytes
+ *    Maximum size of the cache, zero disables caching.
+ */
+void
+CiftiConnectivityMatrixRowLoader::setCacheSizeInBytes(const int64_t cacheSizeInBytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maximumCacheSizeInBytes = std::max(cacheSizeInBytes,
+                                         static_cast<int64_t>(0));
+    trimCache();
+}
+
+/**
+ * Load data on the calling thread.  The cache is used if it contains
+ * the data.
+ *
+ * @param request
+ *    Identifies the data that is loaded.
+ * @param dataOut
+ *    Output containing the data.
+ * @throw DataFileException
+ *    If an error occurs.
+ */
+void
+CiftiConnectivityMatrixRowLoader::loadData(const Request& request,
+                                           std::vector<float>& dataOut)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (getCachedData(request,
+                          dataOut)) {
+            return;
+        }
+    }
+
+    m_dataFile->readRowColumnDataForLoader(request.m_rowFlag,
+                                           request.m_indices,
+                                           request.m_averageFlag,
+                                           request.m_dataCount,
+                                           dataOut);
+
+    QMutexLocker locker(&m_mutex);
+    addToCache(request,
+               dataOut);
+}
+
+/**
+ * Request that data be loaded by the worker thread.  Any earlier
+ * request that has not been completed becomes stale and its data is
+ * never returned.
+ *
+ * @param request
+ *    Identifies the data that is loaded.
+ * @return
+ *    Identifier for use with takeCompletedLoad().
+ */
+int64_t
+CiftiConnectivityMatrixRowLoader::requestLoad(const Request& request)
+{
+    QMutexLocker locker(&m_mutex);
+
+    const int64_t requestIdentifier = m_nextRequestIdentifier++;
+
+    /*
+     * Data in the cache is completed immediately.
+     */
+    if (getCachedData(request,
+                      m_completedData)) {
+        m_pendingRequestIdentifier   = -1;
+        m_completedRequestIdentifier = requestIdentifier;
+        m_completedErrorMessage.clear();
+        postCompletionEvent();
+        return requestIdentifier;
+    }
+
+    m_pendingRequest           = request;
+    m_pendingRequestIdentifier = requestIdentifier;
+
+    if (m_thread == NULL) {
+        m_thread = new CiftiConnectivityMatrixRowLoaderThread(this);
+        m_thread->start();
+    }
+    m_workAvailableCondition.wakeAll();
+
+    return requestIdentifier;
+}
+
+/**
+ * Get the data for a request if it has been loaded.
+ *
+ * @param requestIdentifier
+ *    Identifier returned by requestLoad().
+ * @param dataOut
+ *    Output containing the data.
+ * @param errorMessageOut
+ *    Output with an error message if loading failed.
+ * @return
+ *    True if the request was completed (successfully if the error
+ *    message is empty), else false.
+ */
+bool
+CiftiConnectivityMatrixRowLoader::takeCompletedLoad(const int64_t requestIdentifier,
+                                                    std::vector<float>& dataOut,
+                                                    AString& errorMessageOut)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if ((requestIdentifier < 0)
+        || (requestIdentifier != m_completedRequestIdentifier)) {
+        return false;
+    }
+
+    dataOut.swap(m_completedData);
+    errorMessageOut = m_completedErrorMessage;
+
+    m_completedData.clear();
+    m_completedErrorMessage.clear();
+    m_completedRequestIdentifier = -1;
+
+    return true;
+}
+
+/**
+ * @return True if the request is waiting to be loaded or is loading.
+ *
+ * @param requestIdentifier
+ *    Identifier returned by requestLoad().
+ */
+bool
+CiftiConnectivityMatrixRowLoader::isLoadPending(const int64_t requestIdentifier) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (requestIdentifier < 0) {
+        return false;
+    }
+    return ((requestIdentifier == m_pendingRequestIdentifier)
+            || (requestIdentifier == m_inProgressRequestIdentifier));
+}
+
+/**
+ * Discard any request waiting to be loaded and any completed data.
+ * A request that is being loaded finishes but its data is discarded.
+ */
+void
+CiftiConnectivityMatrixRowLoader::cancelLoads()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_pendingRequestIdentifier   = -1;
+    m_completedRequestIdentifier = -1;
+    m_completedData.clear();
+    m_completedErrorMessage.clear();
+
+    /*
+     * Identifiers issued before now can never complete.
+     */
+    m_nextRequestIdentifier++;
+}
+
+/**
+ * Remove all rows and columns from the cache.
+ */
+void
+CiftiConnectivityMatrixRowLoader::clearCache()
+{
+    QMutexLocker locker(&m_mutex);
+
+    for (std::list<CacheEntry*>::iterator iter = m_cache.begin();
+         iter != m_cache.end();
+         iter++) {
+        delete *iter;
+    }
+    m_cache.clear();
+    m_cacheLookup.clear();
+    m_cacheSizeInBytes = 0;
+}
+
+/**
+ * Set the object that receives an event of type getCompletionEventType()
+ * when an asynchronous load completes.  The event is queued and delivered
+ * by the receiver's thread.
+ *
+ * @param receiver
+ *    The receiver, NULL to stop posting events.
+ */
+void
+CiftiConnectivityMatrixRowLoader::setCompletionEventReceiver(QObject* receiver)
+{
+    QMutexLocker locker(&s_completionEventMutex);
+    if (s_completionEventType == 0) {
+        s_completionEventType = QEvent::registerEventType();
+    }
+    s_completionEventReceiver = receiver;
+}
+
+/**
+ * @return Type of the event posted when an asynchronous load completes.
+ */
+QEvent::Type
+CiftiConnectivityMatrixRowLoader::getCompletionEventType()
+{
+    QMutexLocker locker(&s_completionEventMutex);
+    if (s_completionEventType == 0) {
+        s_completionEventType = QEvent::registerEventType();
+    }
+    return static_cast<QEvent::Type>(s_completionEventType);
+}
+
+/**
+ * Post the completion event to the receiver, if there is one.
+ */
+void
+CiftiConnectivityMatrixRowLoader::postCompletionEvent()
+{
+    QMutexLocker locker(&s_completionEventMutex);
+    if (s_completionEventReceiver != NULL) {
+        QCoreApplication::postEvent(s_completionEventReceiver,
+                                    new QEvent(static_cast<QEvent::Type>(s_completionEventType)));
+    }
+}
+
+/**
+ * Loop run by the worker thread that loads the newest request.
+ */
+void
+CiftiConnectivityMatrixRowLoader::processRequests()
+{
+    QMutexLocker locker(&m_mutex);
+
+    while (true) {
+        while (( ! m_stopFlag)
+               && (m_pendingRequestIdentifier < 0)) {
+            m_workAvailableCondition.wait(&m_mutex);
+        }
+        if (m_stopFlag) {
+            break;
+        }
+
+        const Request request = m_pendingRequest;
+        const int64_t requestIdentifier = m_pendingRequestIdentifier;
+        m_pendingRequestIdentifier    = -1;
+        m_inProgressRequestIdentifier = requestIdentifier;
+
+        locker.unlock();
+
+        std::vector<float> data;
+        AString errorMessage;
+        const bool validFlag = readData(request,
+                                        data,
+                                        errorMessage);
+
+        locker.relock();
+
+        m_inProgressRequestIdentifier = -1;
+        if (validFlag) {
+            addToCache(request,
+                       data);
+        }
+
+        /*
+         * Only the newest request is of interest.
+         */
+        if (requestIdentifier == (m_nextRequestIdentifier - 1)) {
+            m_completedData.swap(data);
+            m_completedErrorMessage      = errorMessage;
+            m_completedRequestIdentifier = requestIdentifier;
+            postCompletionEvent();
+        }
+    }
+}
+
+/**
+ * Read data without using the cache, catching any exceptions.
+ *
+ * @param request
+ *    Identifies the data that is loaded.
+ * @param dataOut
+ *    Output containing the data.
+ * @param errorMessageOut
+ *    Output with an error message if loading failed.
+ * @return
+ *    True if the data was read.
+ */
+bool
+CiftiConnectivityMatrixRowLoader::readData(const Request& request,
+                                           std::vector<float>& dataOut,
+                                           AString& errorMessageOut)
+{
+    try {
+        m_dataFile->readRowColumnDataForLoader(request.m_rowFlag,
+                                               request.m_indices,
+                                               request.m_averageFlag,
+                                               request.m_dataCount,
+                                               dataOut);
+        return true;
+    }
+    catch (const CaretException& e) {
+        errorMessageOut = e.whatString();
+    }
+    catch (const std::exception& e) {
+        errorMessageOut = e.what();
+    }
+
+    CaretLogWarning("Loading connectivity data from "
+                    + m_dataFile->getFileNameNoPath()
+                    + " failed: "
+                    + errorMessageOut);
+    dataOut.clear();
+    return false;
+}
+
+/**
+ * Copy data from the cache and make it the most recently used.
+ * The mutex must be locked by the caller.
+ *
+ * @param request
+ *    Identifies the data.
+ * @param dataOut
+ *    Output containing the data.
+ * @return
+ *    True if the data was in the cache.
+ */
+bool
+CiftiConnectivityMatrixRowLoader::getCachedData(const Request& request,
+                                                std::vector<float>& dataOut)
+{
+    /*
+     * Only single rows and columns are cached.
+     */
+    if (request.m_averageFlag
+        || (request.m_indices.size() != 1)) {
+        return false;
+    }
+
+    const CacheKey key(request.m_rowFlag,
+                       request.m_indices[0]);
+    std::map<CacheKey, std::list<CacheEntry*>::iterator>::iterator lookupIter = m_cacheLookup.find(key);
+    if (lookupIter == m_cacheLookup.end()) {
+        return false;
+    }
+
+    m_cache.splice(m_cache.begin(),
+                   m_cache,
+                   lookupIter->second);
+    dataOut = m_cache.front()->m_data;
+
+    return true;
+}
+
+/**
+ * Add data to the front of the cache and remove the least recently
+ * used entries until the cache is within its size limit.  The mutex
+ * must be locked by the caller.
+ *
+ * @param request
+ *    Identifies the data.
+ * @param data
+ *    The data.
+ */
+void
+CiftiConnectivityMatrixRowLoader::addToCache(const Request& request,
+                                             const std::vector<float>& data)
+{
+    if (request.m_averageFlag
+        || (request.m_indices.size() != 1)
+        || data.empty()) {
+        return;
+    }
+
+    const int64_t entrySizeInBytes = static_cast<int64_t>(data.size() * sizeof(float));
+    if (entrySizeInBytes > m_maximumCacheSizeInBytes) {
+        return;
+    }
+
+    const CacheKey key(request.m_rowFlag,
+                       request.m_indices[0]);
+    if (m_cacheLookup.find(key) != m_cacheLookup.end()) {
+        return;
+    }
+
+    CacheEntry* entry = new CacheEntry();
+    entry->m_key  = key;
+    entry->m_data = data;
+    m_cache.push_front(entry);
+    m_cacheLookup[key] = m_cache.begin();
+    m_cacheSizeInBytes += entrySizeInBytes;
+
+    trimCache();
+}
+
+/**
+ * Remove least recently used entries until the cache is within its
+ * size limit.  The mutex must be locked by the caller.
+ */
+void
+CiftiConnectivityMatrixRowLoader::trimCache()
+{
+    while (( ! m_cache.empty())
+           && (m_cacheSizeInBytes > m_maximumCacheSizeInBytes)) {
+        CacheEntry* entry = m_cache.back();
+        m_cache.pop_back();
+        m_cacheLookup.erase(entry->m_key);
+        m_cacheSizeInBytes -= static_cast<int64_t>(entry->m_data.size() * sizeof(float));
+        delete entry;
+    }
+}
+
+/**
+ * Get a description of this object's content.
+ * @return String describing this object's content.
+ */
+AString
+CiftiConnectivityMatrixRowLoader::toString() const
+{
+    QMutexLocker locker(&m_mutex);
+    return ("CiftiConnectivityMatrixRowLoader cached="
+            + AString::number(m_cache.size())
+            + " bytes="
+            + AString::number(m_cacheSizeInBytes));
+}
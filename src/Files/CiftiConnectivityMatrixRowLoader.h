@@ -0,0 +1,194 @@
+#ifndef __CIFTI_CONNECTIVITY_MATRIX_ROW_LOADER_H__
+#define __CIFTI_CONNECTIVITY_MATRIX_ROW_LOADER_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2016  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include <list>
+#include <map>
+#include <vector>
+
+#include <QEvent>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include "CaretObject.h"
+
+namespace caret {
+
+    class CiftiConnectivityMatrixRowLoaderThread;
+    class CiftiMappableConnectivityMatrixDataFile;
+
+    class CiftiConnectivityMatrixRowLoader : public CaretObject {
+
+    public:
+        /**
+         * Identifies the data that is loaded.
+         */
+        class Request {
+        public:
+            Request();
+
+            /** True if rows are loaded, false if columns are loaded */
+            bool m_rowFlag;
+
+            /** Indices of rows or columns */
+            std::vector<int64_t> m_indices;
+
+            /** True if the rows or columns are averaged, otherwise there is one index */
+            bool m_averageFlag;
+
+            /** Number of elements in the loaded data */
+            int64_t m_dataCount;
+        };
+
+        CiftiConnectivityMatrixRowLoader(const CiftiMappableConnectivityMatrixDataFile* dataFile);
+
+        virtual ~CiftiConnectivityMatrixRowLoader();
+
+        void setCacheSizeInBytes(const int64_t cacheSizeInBytes);
+
+        void loadData(const Request& request,
+                      std::vector<float>& dataOut);
+
+        int64_t requestLoad(const Request& request);
+
+        bool takeCompletedLoad(const int64_t requestIdentifier,
+                               std::vector<float>& dataOut,
+                               AString& errorMessageOut);
+
+        bool isLoadPending(const int64_t requestIdentifier) const;
+
+        void cancelLoads();
+
+        void clearCache();
+
+        static void setCompletionEventReceiver(QObject* receiver);
+
+        static QEvent::Type getCompletionEventType();
+
+        // ADD_NEW_METHODS_HERE
+
+        virtual AString toString() const;
+
+    private:
+        /** Key for a single row or column in the cache */
+        typedef std::pair<bool, int64_t> CacheKey;
+
+        /**
+         * A row or column in the cache.
+         */
+        class CacheEntry {
+        public:
+            CacheKey m_key;
+
+            std::vector<float> m_data;
+        };
+
+        CiftiConnectivityMatrixRowLoader(const CiftiConnectivityMatrixRowLoader&);
+
+        CiftiConnectivityMatrixRowLoader& operator=(const CiftiConnectivityMatrixRowLoader&);
+
+        void processRequests();
+
+        bool readData(const Request& request,
+                      std::vector<float>& dataOut,
+                      AString& errorMessageOut);
+
+        bool getCachedData(const Request& request,
+                           std::vector<float>& dataOut);
+
+        void addToCache(const Request& request,
+                        const std::vector<float>& data);
+
+        void trimCache();
+
+        static void postCompletionEvent();
+
+        /** File whose rows or columns are loaded */
+        const CiftiMappableConnectivityMatrixDataFile* m_dataFile;
+
+        /** Thread that performs asynchronous loads, created when first needed */
+        CiftiConnectivityMatrixRowLoaderThread* m_thread;
+
+        /** Protects all members used by the worker thread */
+        mutable QMutex m_mutex;
+
+        /** Wakes the worker when there is a request or when stopping */
+        QWaitCondition m_workAvailableCondition;
+
+        /** Request waiting to be loaded */
+        Request m_pendingRequest;
+
+        /** Identifier of request waiting to be loaded, negative if none */
+        int64_t m_pendingRequestIdentifier;
+
+        /** Identifier of the request being loaded, negative if none */
+        int64_t m_inProgressRequestIdentifier;
+
+        /** Identifier of the most recently completed request, negative if none */
+        int64_t m_completedRequestIdentifier;
+
+        /** Data from the most recently completed request */
+        std::vector<float> m_completedData;
+
+        /** Error message from the most recently completed request */
+        AString m_completedErrorMessage;
+
+        /** Identifier given to the next request */
+        int64_t m_nextRequestIdentifier;
+
+        /** Recently loaded rows and columns, front is most recently used */
+        std::list<CacheEntry*> m_cache;
+
+        /** Locates entries in the cache */
+        std::map<CacheKey, std::list<CacheEntry*>::iterator> m_cacheLookup;
+
+        /** Bytes of data in the cache */
+        int64_t m_cacheSizeInBytes;
+
+        /** Maximum bytes of data in the cache */
+        int64_t m_maximumCacheSizeInBytes;
+
+        /** Tells the worker thread to exit */
+        bool m_stopFlag;
+
+        /** Receives an event when an asynchronous load completes, may be NULL */
+        static QObject* s_completionEventReceiver;
+
+        /** Type of the event posted when an asynchronous load completes */
+        static int s_completionEventType;
+
+        /** Protects the completion event receiver */
+        static QMutex s_completionEventMutex;
+
+        // ADD_NEW_MEMBERS_HERE
+
+        friend class CiftiConnectivityMatrixRowLoaderThread;
+    };
+
+#ifdef __CIFTI_CONNECTIVITY_MATRIX_ROW_LOADER_DECLARE__
+    QObject* CiftiConnectivityMatrixRowLoader::s_completionEventReceiver = NULL;
+    int CiftiConnectivityMatrixRowLoader::s_completionEventType = 0;
+    QMutex CiftiConnectivityMatrixRowLoader::s_completionEventMutex;
+#endif // __CIFTI_CONNECTIVITY_MATRIX_ROW_LOADER_DECLARE__
+
+} // namespace
+#endif  //__CIFTI_CONNECTIVITY_MATRIX_ROW_LOADER_H__
@@ -0,0 +1,535 @@
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2016  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#define __CIFTI_MAP_COLORING_PREFETCHER_DECLARE__
+#include "CiftiMapColoringPrefetcher.h"
+#undef __CIFTI_MAP_COLORING_PREFETCHER_DECLARE__
+
+#include <algorithm>
+
+#include <QMutexLocker>
+#include <QThread>
+
+#include "CaretAssert.h"
+#include "CaretException.h"
+#include "CaretLogger.h"
+#include "CiftiFile.h"
+#include "FastStatistics.h"
+#include "GiftiLabelTable.h"
+#include "NodeAndVoxelColoring.h"
+#include "Palette.h"
+#include "PaletteColorMapping.h"
+
+using namespace caret;
+
+namespace caret {
+    /**
+     * Thread that runs the prefetcher's request loop.
+     */
+    class CiftiMapColoringPrefetcherThread : public QThread {
+    public:
+        CiftiMapColoringPrefetcherThread(CiftiMapColoringPrefetcher* prefetcher)
+        : QThread(),
+        m_prefetcher(prefetcher) { }
+
+        void run() {
+            m_prefetcher->processRequests();
+        }
+
+    private:
+        CiftiMapColoringPrefetcher* m_prefetcher;
+    };
+}
+
+/**
+ * \class caret::CiftiMapColoringPrefetcher
+ * \brief Colors CIFTI maps ahead of time on a background thread.
+ * \ingroup Files
+ *
+ * When the user animates or scrubs through the maps of a file,
+ * the maps near the one being viewed are likely to be viewed next.
+ * Requests for those maps are queued and colored by a worker thread
+ * into a size limited, least recently used cache.  When the map is
+ * displayed, its coloring is taken from the cache instead of being
+ * computed on the GUI thread.
+ *
+ * Reading from a CiftiFile is only thread safe when its data is
+ * in memory so the prefetcher must not be used with on-disk files.
+ *
+ * Requests contain copies of the palette mapping and label table
+ * so that the worker never uses objects that the GUI may modify.
+ * A cached coloring is only used if the copies still match the
+ * map's palette mapping or label table.
+ */
+
+/**
+ * Constructor of an empty request.
+ */
+CiftiMapColoringPrefetcher::Request::Request()
+: m_mapIndex(-1),
+m_mapStatisticsNeeded(false)
+{
+}
+
+/**
+ * Constructor.
+ *
+ * @param ciftiFile
+ *    The CIFTI file whose maps are colored.  Its data must be in memory.
+ * @param mapsAreColumnsFlag
+ *    True if maps are columns in the CIFTI file, false if maps are rows.
+ */
+CiftiMapColoringPrefetcher::CiftiMapColoringPrefetcher(const CiftiFile* ciftiFile,
+                                                       const bool mapsAreColumnsFlag)
+: CaretObject(),
+m_ciftiFile(ciftiFile),
+m_mapsAreColumnsFlag(mapsAreColumnsFlag)
+{
+    CaretAssert(ciftiFile);
+    CaretAssert(ciftiFile->isInMemory());
+
+    m_cacheSizeInBytes   = 0;
+    m_generation         = 0;
+    m_mapIndexInProgress = -1;
+    m_stopFlag           = false;
+
+    m_thread = new CiftiMapColoringPrefetcherThread(this);
+    m_thread->start(QThread::LowPriority);
+}
+
+/**
+ * Destructor.  Waits for the worker thread to finish.
+ */
+CiftiMapColoringPrefetcher::~CiftiMapColoringPrefetcher()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopFlag = true;
+        m_requestQueue.clear();
+        m_workAvailableCondition.wakeAll();
+    }
+
+    m_thread->wait();
+    delete m_thread;
+
+    clearCache();
+}
+
+/**
+ * Request coloring of maps.  The new requests are colored before any
+ * older requests that have not yet been started.  Since older requests
+ * were predicted for a map that may no longer be viewed, the oldest
+ * requests are discarded when the queue becomes too long.
+ *
+ * @param requests
+ *    The requests in the order they should be colored.
+ */
+void
+CiftiMapColoringPrefetcher::requestColoring(const std::vector<Request>& requests)
+{
+    QMutexLocker locker(&m_mutex);
+
+    std::deque<Request> newRequests;
+    for (std::vector<Request>::const_iterator iter = requests.begin();
+         iter != requests.end();
+         iter++) {
+        const int32_t mapIndex = iter->m_mapIndex;
+        if (mapIndex == m_mapIndexInProgress) {
+            continue;
+        }
+
+        bool cachedFlag = false;
+        for (std::list<CacheEntry*>::iterator cacheIter = m_cache.begin();
+             cacheIter != m_cache.end();
+             cacheIter++) {
+            if ((*cacheIter)->m_mapIndex == mapIndex) {
+                /*
+                 * Predicted again so keep it from being evicted
+                 */
+                m_cache.splice(m_cache.begin(), m_cache, cacheIter);
+                cachedFlag = true;
+                break;
+            }
+        }
+        if (cachedFlag) {
+            continue;
+        }
+
+        /*
+         * Remove an older request for the same map
+         */
+        for (std::deque<Request>::iterator queueIter = m_requestQueue.begin();
+             queueIter != m_requestQueue.end();
+             queueIter++) {
+            if (queueIter->m_mapIndex == mapIndex) {
+                m_requestQueue.erase(queueIter);
+                break;
+            }
+        }
+
+        newRequests.push_back(*iter);
+    }
+
+    m_requestQueue.insert(m_requestQueue.begin(),
+                          newRequests.begin(),
+                          newRequests.end());
+    while (static_cast<int32_t>(m_requestQueue.size()) > s_maximumQueuedRequests) {
+        m_requestQueue.pop_back();
+    }
+
+    if ( ! m_requestQueue.empty()) {
+        m_workAvailableCondition.wakeAll();
+    }
+}
+
+/**
+ * @return True if the map is cached, queued, or being colored.
+ *
+ * @param mapIndex
+ *    Index of the map.
+ */
+bool
+CiftiMapColoringPrefetcher::isQueuedOrCached(const int32_t mapIndex) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (mapIndex == m_mapIndexInProgress) {
+        return true;
+    }
+    for (std::deque<Request>::const_iterator iter = m_requestQueue.begin();
+         iter != m_requestQueue.end();
+         iter++) {
+        if (iter->m_mapIndex == mapIndex) {
+            return true;
+        }
+    }
+    for (std::list<CacheEntry*>::const_iterator iter = m_cache.begin();
+         iter != m_cache.end();
+         iter++) {
+        if ((*iter)->m_mapIndex == mapIndex) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Take the coloring of a map from the cache.  The coloring is removed
+ * from the cache since the caller now owns it.
+ *
+ * @param mapIndex
+ *    Index of the map.
+ * @param paletteColorMapping
+ *    Current palette color mapping of the map (NULL for label data).
+ * @param labelTable
+ *    Current label table of the map (NULL for palette data).
+ * @param rgbaOut
+ *    Output containing the coloring.
+ * @param mapStatisticsOut
+ *    Output containing statistics of the map's data if they were
+ *    computed while coloring, otherwise NULL.
+ * @return
+ *    True if a valid coloring was found, else false and outputs
+ *    are not modified.
+ */
+bool
+CiftiMapColoringPrefetcher::takeColoring(const int32_t mapIndex,
+                                         const PaletteColorMapping* paletteColorMapping,
+                                         const GiftiLabelTable* labelTable,
+                                         std::vector<uint8_t>& rgbaOut,
+                                         CaretPointer<FastStatistics>& mapStatisticsOut)
+{
+    QMutexLocker locker(&m_mutex);
+
+    for (std::list<CacheEntry*>::iterator iter = m_cache.begin();
+         iter != m_cache.end();
+         iter++) {
+        CacheEntry* entry = *iter;
+        if (entry->m_mapIndex != mapIndex) {
+            continue;
+        }
+
+        m_cache.erase(iter);
+        m_cacheSizeInBytes -= static_cast<int64_t>(entry->m_rgba.size());
+
+        bool validFlag = true;
+        if (paletteColorMapping != NULL) {
+            if ((entry->m_request.m_paletteColorMapping == NULL)
+                || ( ! (*entry->m_request.m_paletteColorMapping == *paletteColorMapping))) {
+                validFlag = false;
+            }
+        }
+        if (labelTable != NULL) {
+            if ((entry->m_request.m_labelTable == NULL)
+                || ( ! (*entry->m_request.m_labelTable == *labelTable))) {
+                validFlag = false;
+            }
+        }
+
+        if (validFlag) {
+            rgbaOut.swap(entry->m_rgba);
+            mapStatisticsOut = entry->m_mapStatistics;
+        }
+
+        delete entry;
+
+        return validFlag;
+    }
+
+    return false;
+}
+
+/**
+ * Invalidate all queued, in progress, and cached coloring, usually
+ * because the data or coloring parameters have changed.  If the
+ * worker is coloring a map, this waits until it is done so that the
+ * caller may safely modify the file's data.
+ */
+void
+CiftiMapColoringPrefetcher::invalidate()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_generation++;
+    m_requestQueue.clear();
+
+    while (m_mapIndexInProgress >= 0) {
+        m_workFinishedCondition.wait(&m_mutex);
+    }
+
+    clearCache();
+}
+
+/**
+ * Color data with either a palette or a label table.
+ *
+ * @param data
+ *    The data values.
+ * @param paletteColorMapping
+ *    Palette color mapping (NULL for label data).
+ * @param palette
+ *    The palette (NULL for label data).
+ * @param labelTable
+ *    Label table (NULL for palette data).
+ * @param statistics
+ *    Statistics for palette coloring.  May be NULL if the palette
+ *    color mapping does not need statistics.
+ * @param rgbaOut
+ *    Output containing RGBA coloring.
+ * @return
+ *    True if the data was colored, else false.
+ */
+bool
+CiftiMapColoringPrefetcher::colorMapData(const std::vector<float>& data,
+                                         const PaletteColorMapping* paletteColorMapping,
+                                         const Palette* palette,
+                                         const GiftiLabelTable* labelTable,
+                                         const FastStatistics* statistics,
+                                         std::vector<uint8_t>& rgbaOut)
+{
+    if (data.empty()) {
+        return false;
+    }
+
+    const int64_t dataCount = static_cast<int64_t>(data.size());
+    rgbaOut.resize(dataCount * 4);
+
+    if (labelTable != NULL) {
+        NodeAndVoxelColoring::colorIndicesWithLabelTable(labelTable,
+                                                         &data[0],
+                                                         dataCount,
+                                                         &rgbaOut[0]);
+        return true;
+    }
+
+    if ((paletteColorMapping == NULL)
+        || (palette == NULL)) {
+        std::fill(rgbaOut.begin(),
+                  rgbaOut.end(),
+                  0);
+        return false;
+    }
+
+    /*
+     * Statistics are not used when the user scale mode is selected
+     * but the coloring code requires a valid instance.
+     */
+    FastStatistics emptyStatistics;
+    if (statistics == NULL) {
+        if (paletteColorMapping->isStatisticsNeededForScaleMode()) {
+            std::fill(rgbaOut.begin(),
+                      rgbaOut.end(),
+                      0);
+            return false;
+        }
+        statistics = &emptyStatistics;
+    }
+
+    NodeAndVoxelColoring::colorScalarsWithPalette(statistics,
+                                                  paletteColorMapping,
+                                                  palette,
+                                                  &data[0],
+                                                  &data[0],
+                                                  dataCount,
+                                                  &rgbaOut[0]);
+
+    return true;
+}
+
+/**
+ * Loop run by the worker thread that colors the queued maps.
+ */
+void
+CiftiMapColoringPrefetcher::processRequests()
+{
+    QMutexLocker locker(&m_mutex);
+
+    while (true) {
+        while (( ! m_stopFlag)
+               && m_requestQueue.empty()) {
+            m_workAvailableCondition.wait(&m_mutex);
+        }
+        if (m_stopFlag) {
+            break;
+        }
+
+        const Request request = m_requestQueue.front();
+        m_requestQueue.pop_front();
+        const int64_t generation = m_generation;
+        m_mapIndexInProgress = request.m_mapIndex;
+
+        locker.unlock();
+
+        CacheEntry* entry = new CacheEntry();
+        entry->m_mapIndex = request.m_mapIndex;
+        entry->m_request  = request;
+
+        bool validFlag = false;
+        try {
+            std::vector<float> data;
+            if (m_mapsAreColumnsFlag) {
+                data.resize(m_ciftiFile->getNumberOfRows());
+                m_ciftiFile->getColumn(&data[0],
+                                       request.m_mapIndex);
+            }
+            else {
+                data.resize(m_ciftiFile->getNumberOfColumns());
+                m_ciftiFile->getRow(&data[0],
+                                    request.m_mapIndex);
+            }
+
+            const FastStatistics* statistics = request.m_statistics;
+            if ((statistics == NULL)
+                && request.m_mapStatisticsNeeded
+                && ( ! data.empty())) {
+                entry->m_mapStatistics.grabNew(new FastStatistics(&data[0],
+                                                                  data.size()));
+                statistics = entry->m_mapStatistics;
+            }
+
+            validFlag = colorMapData(data,
+                                     request.m_paletteColorMapping,
+                                     request.m_palette,
+                                     request.m_labelTable,
+                                     statistics,
+                                     entry->m_rgba);
+        }
+        catch (const CaretException& e) {
+            CaretLogWarning("Prefetch coloring of map "
+                            + AString::number(request.m_mapIndex + 1)
+                            + " failed: "
+                            + e.whatString());
+            validFlag = false;
+        }
+
+        locker.relock();
+
+        m_mapIndexInProgress = -1;
+        if (validFlag
+            && (generation == m_generation)
+            && ( ! m_stopFlag)) {
+            addToCache(entry);
+        }
+        else {
+            delete entry;
+        }
+
+        m_workFinishedCondition.wakeAll();
+    }
+}
+
+/**
+ * Add an entry to the front of the cache and remove the least recently
+ * used entries until the cache is within its size limit.  The mutex
+ * must be locked by the caller.
+ *
+ * @param entry
+ *    Entry added, cache takes ownership.
+ */
+void
+CiftiMapColoringPrefetcher::addToCache(CacheEntry* entry)
+{
+    m_cache.push_front(entry);
+    m_cacheSizeInBytes += static_cast<int64_t>(entry->m_rgba.size());
+
+    while ((m_cacheSizeInBytes > s_maximumCacheSizeInBytes)
+           && (static_cast<int32_t>(m_cache.size()) > s_minimumCacheEntries)) {
+        CacheEntry* oldest = m_cache.back();
+        m_cache.pop_back();
+        m_cacheSizeInBytes -= static_cast<int64_t>(oldest->m_rgba.size());
+        delete oldest;
+    }
+}
+
+/**
+ * Remove all entries from the cache.  The mutex must be locked
+ * by the caller (or the worker thread must be stopped).
+ */
+void
+CiftiMapColoringPrefetcher::clearCache()
+{
+    for (std::list<CacheEntry*>::iterator iter = m_cache.begin();
+         iter != m_cache.end();
+         iter++) {
+        delete *iter;
+    }
+    m_cache.clear();
+    m_cacheSizeInBytes = 0;
+}
+
+/**
+ * Get a description of this object's content.
+ * @return String describing this object's content.
+ */
+AString
+CiftiMapColoringPrefetcher::toString() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return ("CiftiMapColoringPrefetcher: queued="
+            + AString::number(static_cast<int64_t>(m_requestQueue.size()))
+            + " cached="
+            + AString::number(static_cast<int64_t>(m_cache.size()))
+            + " bytes="
+            + AString::number(m_cacheSizeInBytes));
+}
+
@@ -0,0 +1,185 @@
+#ifndef __CIFTI_MAP_COLORING_PREFETCHER_H__
+#define __CIFTI_MAP_COLORING_PREFETCHER_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2016  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include <deque>
+#include <list>
+#include <vector>
+
+#include <QMutex>
+#include <QWaitCondition>
+
+#include "CaretObject.h"
+#include "CaretPointer.h"
+
+namespace caret {
+
+    class CiftiFile;
+    class FastStatistics;
+    class GiftiLabelTable;
+    class Palette;
+    class PaletteColorMapping;
+    class CiftiMapColoringPrefetcherThread;
+
+    class CiftiMapColoringPrefetcher : public CaretObject {
+
+    public:
+        /**
+         * Everything needed to color a map away from the GUI thread.
+         * All members are copies so that the worker thread never
+         * touches objects that may be modified by the GUI.
+         */
+        class Request {
+        public:
+            Request();
+
+            /** Index of the map */
+            int32_t m_mapIndex;
+
+            /** Copy of the map's palette color mapping (NULL for label data) */
+            CaretPointer<PaletteColorMapping> m_paletteColorMapping;
+
+            /** Copy of the palette (NULL for label data) */
+            CaretPointer<Palette> m_palette;
+
+            /** Copy of the map's label table (NULL for palette data) */
+            CaretPointer<GiftiLabelTable> m_labelTable;
+
+            /**
+             * Statistics used for palette coloring.  When NULL and
+             * m_mapStatisticsNeeded is true, statistics are computed
+             * on the map's data.
+             */
+            CaretPointer<FastStatistics> m_statistics;
+
+            /** Statistics on the map's data are needed for coloring */
+            bool m_mapStatisticsNeeded;
+        };
+
+        CiftiMapColoringPrefetcher(const CiftiFile* ciftiFile,
+                                   const bool mapsAreColumnsFlag);
+
+        virtual ~CiftiMapColoringPrefetcher();
+
+        void requestColoring(const std::vector<Request>& requests);
+
+        bool isQueuedOrCached(const int32_t mapIndex) const;
+
+        bool takeColoring(const int32_t mapIndex,
+                          const PaletteColorMapping* paletteColorMapping,
+                          const GiftiLabelTable* labelTable,
+                          std::vector<uint8_t>& rgbaOut,
+                          CaretPointer<FastStatistics>& mapStatisticsOut);
+
+        void invalidate();
+
+        static bool colorMapData(const std::vector<float>& data,
+                                 const PaletteColorMapping* paletteColorMapping,
+                                 const Palette* palette,
+                                 const GiftiLabelTable* labelTable,
+                                 const FastStatistics* statistics,
+                                 std::vector<uint8_t>& rgbaOut);
+
+        // ADD_NEW_METHODS_HERE
+
+        virtual AString toString() const;
+
+    private:
+        /**
+         * A map that has been colored by the worker thread.
+         */
+        class CacheEntry {
+        public:
+            int32_t m_mapIndex;
+
+            Request m_request;
+
+            std::vector<uint8_t> m_rgba;
+
+            CaretPointer<FastStatistics> m_mapStatistics;
+        };
+
+        CiftiMapColoringPrefetcher(const CiftiMapColoringPrefetcher&);
+
+        CiftiMapColoringPrefetcher& operator=(const CiftiMapColoringPrefetcher&);
+
+        void processRequests();
+
+        void addToCache(CacheEntry* entry);
+
+        void clearCache();
+
+        /** The CIFTI file, data must be in memory */
+        const CiftiFile* m_ciftiFile;
+
+        /** True if maps are columns in the CIFTI file, else rows */
+        const bool m_mapsAreColumnsFlag;
+
+        /** Thread that colors the maps */
+        CiftiMapColoringPrefetcherThread* m_thread;
+
+        /** Protects the queue, cache and flags */
+        mutable QMutex m_mutex;
+
+        /** Wakes the worker when there is work or when stopping */
+        QWaitCondition m_workAvailableCondition;
+
+        /** Wakes invalidate() when the worker finishes a map */
+        QWaitCondition m_workFinishedCondition;
+
+        /** Maps waiting to be colored, front is colored first */
+        std::deque<Request> m_requestQueue;
+
+        /** Colored maps, front is most recently used */
+        std::list<CacheEntry*> m_cache;
+
+        /** Bytes of RGBA in the cache */
+        int64_t m_cacheSizeInBytes;
+
+        /** Incremented when the queued and in progress requests become stale */
+        int64_t m_generation;
+
+        /** Index of map that the worker is coloring, negative if none */
+        int32_t m_mapIndexInProgress;
+
+        /** Tells the worker thread to exit */
+        bool m_stopFlag;
+
+        static const int64_t s_maximumCacheSizeInBytes;
+
+        static const int32_t s_minimumCacheEntries;
+
+        static const int32_t s_maximumQueuedRequests;
+
+        // ADD_NEW_MEMBERS_HERE
+
+        friend class CiftiMapColoringPrefetcherThread;
+    };
+
+#ifdef __CIFTI_MAP_COLORING_PREFETCHER_DECLARE__
+    const int64_t CiftiMapColoringPrefetcher::s_maximumCacheSizeInBytes = 256 * 1024 * 1024;
+    const int32_t CiftiMapColoringPrefetcher::s_minimumCacheEntries = 4;
+    const int32_t CiftiMapColoringPrefetcher::s_maximumQueuedRequests = 16;
+#endif // __CIFTI_MAP_COLORING_PREFETCHER_DECLARE__
+
+} // namespace
+#endif  //__CIFTI_MAP_COLORING_PREFETCHER_H__
@@ -23,7 +23,11 @@
 #include "CiftiMappableConnectivityMatrixDataFile.h"
 #undef __CIFTI_MAPPABLE_CONNECTIVITY_MATRIX_DATA_FILE_DECLARE__
 
+#include <algorithm>
+
 #include "CaretAssert.h"
+#include "CaretOMP.h"
+#include "CiftiConnectivityMatrixRowLoader.h"
 #include "CiftiFile.h"
 #include "CaretLogger.h"
 #include "ChartableMatrixParcelInterface.h"
@@ -52,6 +56,7 @@ CiftiMappableConnectivityMatrixDataFile::CiftiMappableConnectivityMatrixDataFile
 : CiftiMappableDataFile(dataFileType)
 {
     m_connectivityDataLoaded = new ConnectivityDataLoaded();
+    m_rowCacheSizeInBytes = 0;
     
     /*
      * This method initializes some members
@@ -83,6 +88,10 @@ CiftiMappableConnectivityMatrixDataFile::~CiftiMappableConnectivityMatrixDataFil
 void
 CiftiMappableConnectivityMatrixDataFile::clear()
 {
+    /*
+     * Row loader may be reading from the CIFTI file
+     */
+    clearRowLoader();
     CiftiMappableDataFile::clear();
     clearPrivate();
 }
@@ -94,6 +103,7 @@ CiftiMappableConnectivityMatrixDataFile::clear()
 void
 CiftiMappableConnectivityMatrixDataFile::clearPrivate()
 {
+    clearRowLoader();
     m_loadedRowData.clear();
     m_rowLoadedTextForMapName = "";
     m_rowLoadedText = "";
@@ -336,6 +346,11 @@ CiftiMappableConnectivityMatrixDataFile::getRowColumnIndicesForNodesWhenLoading(
 /**
  * Get the average for or column for the given row/column indices.
  *
+ * Rows are read in file order and adjacent rows are read with a
+ * single file access, which is much faster than reading the rows
+ * one at a time in the order of the indices when the file is not
+ * in memory.  The rows are summed in parallel.
+ *
  * @param rowIndices
  *     Indices of the row.
  * @param columnIndices
@@ -349,7 +364,7 @@ void
 CiftiMappableConnectivityMatrixDataFile::getRowColumnAverageForIndices(const std::vector<int64_t>& rowIndices,
                                                                        const std::vector<int64_t>& columnIndices,
                                                                        std::vector<float>& rowAverageOut,
-                                                                       std::vector<float>& columnAverageOut)
+                                                                       std::vector<float>& columnAverageOut) const
 {
     columnAverageOut.clear();
     rowAverageOut.clear();
@@ -369,28 +384,78 @@ CiftiMappableConnectivityMatrixDataFile::getRowColumnAverageForIndices(const std
     }
     
     const int64_t numIndices = static_cast<int64_t>(indices.size());
-    if (numIndices > 0) {
+    if ((numIndices > 0)
+        && (dataLength > 0)) {
         std::vector<double> sum(dataLength, 0.0);
-        std::vector<float>  data(dataLength);
         
+        /*
+         * An index may be present more than once and is
+         * weighted by the number of times it is present.
+         */
+        std::sort(indices.begin(),
+                  indices.end());
+        std::vector<int64_t> uniqueIndices;
+        std::vector<float> indexWeights;
         for (std::vector<int64_t>::const_iterator iter = indices.begin();
              iter != indices.end();
              iter++) {
+            if (( ! uniqueIndices.empty())
+                && (uniqueIndices.back() == *iter)) {
+                indexWeights.back() += 1.0;
+            }
+            else {
+                uniqueIndices.push_back(*iter);
+                indexWeights.push_back(1.0);
+            }
+        }
+        const int64_t numUniqueIndices = static_cast<int64_t>(uniqueIndices.size());
+        
+        int64_t maximumCountPerRead = 1;
+        if (doRowsFlag) {
+            maximumCountPerRead = std::max(static_cast<int64_t>(1),
+                                           static_cast<int64_t>(s_maximumAverageReadSizeInBytes
+                                                                / (dataLength * sizeof(float))));
+        }
+        
+        std::vector<float> data;
+        int64_t firstUniqueIndex = 0;
+        while (firstUniqueIndex < numUniqueIndices) {
+            /*
+             * Find the run of adjacent rows that starts at the first index
+             */
+            int64_t count = 1;
+            while ((firstUniqueIndex + count < numUniqueIndices)
+                   && (count < maximumCountPerRead)
+                   && (uniqueIndices[firstUniqueIndex + count] == (uniqueIndices[firstUniqueIndex] + count))) {
+                count++;
+            }
+            
+            data.resize(count * dataLength);
             if (doRowsFlag) {
-                getDataForRow(&data[0], *iter);
+                getDataForRows(&data[0],
+                               uniqueIndices[firstUniqueIndex],
+                               count);
             }
             else {
-                getDataForColumn(&data[0], *iter);
+                getDataForColumn(&data[0],
+                                 uniqueIndices[firstUniqueIndex]);
             }
             
+            const float* weights = &indexWeights[firstUniqueIndex];
+            const float* dataPointer = &data[0];
+            double* sumPointer = &sum[0];
+#pragma omp CARET_PARFOR schedule(static)
             for (int64_t i = 0; i < dataLength; i++) {
-                CaretAssertVectorIndex(sum, i);
-                CaretAssertVectorIndex(data, i);
-                sum[i] += data[i];
+                double value = 0.0;
+                for (int64_t j = 0; j < count; j++) {
+                    value += weights[j] * dataPointer[j * dataLength + i];
+                }
+                sumPointer[i] += value;
             }
+            
+            firstUniqueIndex += count;
         }
 
-        CaretAssert(dataLength > 0);
         std::vector<float> average(dataLength);
         const float floatNumIndices = numIndices; //dataLength;
         for (int64_t i = 0; i < dataLength; i++) {
@@ -539,6 +604,12 @@ CiftiMappableConnectivityMatrixDataFile::getRowColumnIndexForVoxelIndexWhenLoadi
 void
 CiftiMappableConnectivityMatrixDataFile::setLoadedRowDataToAllZeros()
 {
+    /*
+     * New data is about to be loaded so any data that is
+     * being loaded asynchronously is no longer wanted.
+     */
+    cancelAsynchronousLoad();
+    
     if ( ! m_loadedRowData.empty()){
         std::fill(m_loadedRowData.begin(),
                   m_loadedRowData.end(),
@@ -594,6 +665,24 @@ CiftiMappableConnectivityMatrixDataFile::getDataForRow(float* dataOut, const int
                         index);
 }
 
+/**
+ * Load data for adjacent rows.
+ *
+ * @param dataOut
+ *     Output with data, the rows are consecutive.
+ * @param firstIndex
+ *     Index of the first row.
+ * @param numberOfRows
+ *     Number of rows.
+ */
+void
+CiftiMappableConnectivityMatrixDataFile::getDataForRows(float* dataOut, const int64_t& firstIndex, const int64_t& numberOfRows) const
+{
+    m_ciftiFile->getRows(dataOut,
+                         firstIndex,
+                         numberOfRows);
+}
+
 /**
  * Load PROCESSED data for the given column.
  *
@@ -636,7 +725,7 @@ CiftiMappableConnectivityMatrixDataFile::getProcessedDataForRow(float* dataOut,
  *     The row average data.
  */
 void
-CiftiMappableConnectivityMatrixDataFile::processRowAverageData(std::vector<float>& /*rowAverageData*/)
+CiftiMappableConnectivityMatrixDataFile::processRowAverageData(std::vector<float>& /*rowAverageData*/) const
 {
     /* This method may be overridden by subclasses */
 }
@@ -669,10 +758,9 @@ CiftiMappableConnectivityMatrixDataFile::loadDataForRowIndex(const int64_t rowIn
             m_rowLoadedText = ("Row_"
                                + AString::number(rowIndex));
             CaretAssert((rowIndex >= 0) && (rowIndex < m_ciftiFile->getNumberOfRows()));
-            m_loadedRowData.resize(dataCount);
-            
-            getProcessedDataForRow(&m_loadedRowData[0],
-                                   rowIndex);
+            loadRowOrColumnData(true,
+                                rowIndex,
+                                dataCount);
             
             CaretLogFine("Read row " + AString::number(rowIndex));
             m_connectivityDataLoaded->setRowColumnLoading(rowIndex,
@@ -710,10 +798,9 @@ CiftiMappableConnectivityMatrixDataFile::loadDataForColumnIndex(const int64_t co
             m_rowLoadedText = ("Column_"
                                + AString::number(columnIndex));
             CaretAssert((columnIndex >= 0) && (columnIndex < m_ciftiFile->getNumberOfColumns()));
-            m_loadedRowData.resize(dataCount);
-            
-            getProcessedDataForColumn(&m_loadedRowData[0],
-                                      columnIndex);
+            loadRowOrColumnData(false,
+                                columnIndex,
+                                dataCount);
             
             CaretLogFine("Read column " + AString::number(columnIndex));
             m_connectivityDataLoaded->setRowColumnLoading(-1,
@@ -724,6 +811,446 @@ CiftiMappableConnectivityMatrixDataFile::loadDataForColumnIndex(const int64_t co
     updateForChangeInMapDataWithMapIndex(0);
 }
 
+/**
+ * Set the size of the cache of recently loaded rows and columns.
+ *
+ * @param cacheSizeInBytes
+ *    Maximum size of the cache, zero disables caching.
+ */
+void
+CiftiMappableConnectivityMatrixDataFile::setRowCacheSizeInBytes(const int64_t cacheSizeInBytes)
+{
+    m_rowCacheSizeInBytes = cacheSizeInBytes;
+    if (m_rowLoader != NULL) {
+        m_rowLoader->setCacheSizeInBytes(m_rowCacheSizeInBytes);
+    }
+}
+
+/**
+ * Remove the row loader and its cache.  Must be called when the data
+ * that is read for a row or column changes.
+ */
+void
+CiftiMappableConnectivityMatrixDataFile::clearRowLoader()
+{
+    m_asynchronousLoad.reset();
+    m_rowLoader.grabNew(NULL);
+}
+
+/**
+ * @return The row loader, creating it if needed.
+ */
+CiftiConnectivityMatrixRowLoader*
+CiftiMappableConnectivityMatrixDataFile::getRowLoader() const
+{
+    if (m_rowLoader == NULL) {
+        m_rowLoader.grabNew(new CiftiConnectivityMatrixRowLoader(this));
+        m_rowLoader->setCacheSizeInBytes(m_rowCacheSizeInBytes);
+    }
+    return m_rowLoader;
+}
+
+/**
+ * Get the number of elements in a loaded row or column.
+ *
+ * @param rowFlag
+ *    True if loading a row, false if loading a column.
+ * @return
+ *    Number of elements.
+ */
+int64_t
+CiftiMappableConnectivityMatrixDataFile::getDataCountForLoading(const bool rowFlag) const
+{
+    if (rowFlag) {
+        if (getDataFileType() == DataFileTypeEnum::CONNECTIVITY_DENSE_DYNAMIC) {
+            /*
+             * Dense dynamic is special case where number of rows equals number of brainordinates.
+             * Number of columns is number of time points
+             */
+            return m_ciftiFile->getNumberOfRows();
+        }
+        return m_ciftiFile->getNumberOfColumns();
+    }
+    
+    return m_ciftiFile->getNumberOfRows();
+}
+
+/**
+ * Load a row or column into the loaded row data using the
+ * cache of recently loaded rows and columns.
+ *
+ * @param rowFlag
+ *    True if loading a row, false if loading a column.
+ * @param index
+ *    Index of the row or column.
+ * @param dataCount
+ *    Number of elements in the row or column.
+ * @throw DataFileException
+ *    If an error occurs.
+ */
+void
+CiftiMappableConnectivityMatrixDataFile::loadRowOrColumnData(const bool rowFlag,
+                                                             const int64_t index,
+                                                             const int64_t dataCount)
+{
+    CiftiConnectivityMatrixRowLoader::Request request;
+    request.m_rowFlag   = rowFlag;
+    request.m_indices.push_back(index);
+    request.m_dataCount = dataCount;
+    
+    getRowLoader()->loadData(request,
+                             m_loadedRowData);
+    CaretAssert(static_cast<int64_t>(m_loadedRowData.size()) == dataCount);
+}
+
+/**
+ * Read the processed data for a row or column, or the average of
+ * rows or columns, without using the cache.  Called by the row loader,
+ * possibly from its worker thread, so only reading is permitted.
+ *
+ * @param rowFlag
+ *    True if loading rows, false if loading columns.
+ * @param indices
+ *    Indices of the rows or columns.
+ * @param averageFlag
+ *    If true, the rows or columns are averaged, otherwise there is one index.
+ * @param dataCount
+ *    Number of elements in a processed row or column.
+ * @param dataOut
+ *    Output with data.
+ * @throw DataFileException
+ *    If an error occurs.
+ */
+void
+CiftiMappableConnectivityMatrixDataFile::readRowColumnDataForLoader(const bool rowFlag,
+                                                                    const std::vector<int64_t>& indices,
+                                                                    const bool averageFlag,
+                                                                    const int64_t dataCount,
+                                                                    std::vector<float>& dataOut) const
+{
+    dataOut.clear();
+    if (indices.empty()) {
+        return;
+    }
+    
+    if ( ! averageFlag) {
+        CaretAssert(indices.size() == 1);
+        dataOut.resize(dataCount);
+        if (rowFlag) {
+            getProcessedDataForRow(&dataOut[0],
+                                   indices[0]);
+        }
+        else {
+            getProcessedDataForColumn(&dataOut[0],
+                                      indices[0]);
+        }
+        return;
+    }
+    
+    std::vector<float> rowAverage, columnAverage;
+    if (rowFlag) {
+        getRowColumnAverageForIndices(indices,
+                                      std::vector<int64_t>(),
+                                      rowAverage,
+                                      columnAverage);
+        processRowAverageData(rowAverage);
+        dataOut.swap(rowAverage);
+    }
+    else {
+        getRowColumnAverageForIndices(std::vector<int64_t>(),
+                                      indices,
+                                      rowAverage,
+                                      columnAverage);
+        dataOut.swap(columnAverage);
+    }
+}
+
+/**
+ * Set the loaded text for data loaded for a surface node.
+ *
+ * @param structure
+ *    Surface's structure.
+ * @param nodeIndex
+ *    Index of node number.
+ * @param rowIndex
+ *    Index of row that was loaded or negative if a column was loaded.
+ * @param columnIndex
+ *    Index of column that was loaded.
+ */
+void
+CiftiMappableConnectivityMatrixDataFile::setLoadedTextForSurfaceNode(const StructureEnum::Enum structure,
+                                                                     const int32_t nodeIndex,
+                                                                     const int64_t rowIndex,
+                                                                     const int64_t columnIndex)
+{
+    if (rowIndex >= 0) {
+        m_rowLoadedTextForMapName = ("Row: "
+                                     + AString::number(rowIndex)
+                                     + ", Node Index: "
+                                     + AString::number(nodeIndex)
+                                     + ", Structure: "
+                                     + StructureEnum::toName(structure));
+        
+        m_rowLoadedText = ("Row_"
+                           + AString::number(rowIndex)
+                           + "_Node_Index_"
+                           + AString::number(nodeIndex)
+                           + "_Structure_"
+                           + StructureEnum::toGuiName(structure));
+    }
+    else {
+        m_rowLoadedTextForMapName = ("Column: "
+                                     + AString::number(columnIndex)
+                                     + ", Node Index: "
+                                     + AString::number(nodeIndex)
+                                     + ", Structure: "
+                                     + StructureEnum::toName(structure));
+        
+        m_rowLoadedText = ("Column_"
+                           + AString::number(columnIndex)
+                           + "_Node_Index_"
+                           + AString::number(nodeIndex)
+                           + "_Structure_"
+                           + StructureEnum::toGuiName(structure));
+    }
+}
+
+/**
+ * Set the loaded text for data averaged from surface nodes.
+ *
+ * @param structure
+ *    Surface's structure.
+ * @param numberOfNodeIndices
+ *    Number of nodes that were averaged.
+ */
+void
+CiftiMappableConnectivityMatrixDataFile::setLoadedTextForSurfaceNodeAverage(const StructureEnum::Enum structure,
+                                                                            const int32_t numberOfNodeIndices)
+{
+    m_rowLoadedTextForMapName = ("Structure: "
+                                 + StructureEnum::toName(structure)
+                                 + ", Averaged Vertex Count: "
+                                 + AString::number(numberOfNodeIndices));
+    m_rowLoadedText =  ("Structure_"
+                        + StructureEnum::toGuiName(structure)
+                        + "_Averaged_Vertex_Count_"
+                        + AString::number(numberOfNodeIndices));
+}
+
+/**
+ * Request that connectivity data for the surface's node be loaded
+ * asynchronously.  The currently loaded data remains until the new
+ * data is loaded by finishAsynchronousLoad().  An earlier asynchronous
+ * load that has not finished is abandoned.
+ *
+ * @param surfaceNumberOfNodes
+ *    Number of nodes in surface.
+ * @param structure
+ *    Surface's structure.
+ * @param nodeIndex
+ *    Index of node number.
+ * @return
+ *    True if a load was requested, false if loading is disabled or
+ *    no row or column corresponds to the node.
+ */
+bool
+CiftiMappableConnectivityMatrixDataFile::requestMapDataForSurfaceNodeAsynchronously(const int32_t surfaceNumberOfNodes,
+                                                                                    const StructureEnum::Enum structure,
+                                                                                    const int32_t nodeIndex)
+{
+    if ( ! isEnabledAsLayer()) {
+        return false;
+    }
+    if ((m_ciftiFile == NULL)
+        || ( ! m_dataLoadingEnabled)) {
+        return false;
+    }
+    
+    int64_t rowIndex = -1;
+    int64_t columnIndex = -1;
+    getRowColumnIndexForNodeWhenLoading(structure,
+                                        surfaceNumberOfNodes,
+                                        nodeIndex,
+                                        rowIndex,
+                                        columnIndex);
+    
+    CiftiConnectivityMatrixRowLoader::Request request;
+    if (rowIndex >= 0) {
+        request.m_rowFlag = true;
+        request.m_indices.push_back(rowIndex);
+        columnIndex = -1;
+    }
+    else if (columnIndex >= 0) {
+        request.m_rowFlag = false;
+        request.m_indices.push_back(columnIndex);
+    }
+    else {
+        return false;
+    }
+    request.m_dataCount = getDataCountForLoading(request.m_rowFlag);
+    if (request.m_dataCount <= 0) {
+        return false;
+    }
+    
+    m_asynchronousLoad.reset();
+    m_asynchronousLoad.m_surfaceNumberOfNodes = surfaceNumberOfNodes;
+    m_asynchronousLoad.m_structure            = structure;
+    m_asynchronousLoad.m_nodeIndices.push_back(nodeIndex);
+    m_asynchronousLoad.m_rowIndex             = rowIndex;
+    m_asynchronousLoad.m_columnIndex          = columnIndex;
+    m_asynchronousLoad.m_requestIdentifier    = getRowLoader()->requestLoad(request);
+    
+    return true;
+}
+
+/**
+ * Request that connectivity data for the surface's nodes be loaded
+ * and averaged asynchronously.  The currently loaded data remains until
+ * the new data is loaded by finishAsynchronousLoad().  An earlier
+ * asynchronous load that has not finished is abandoned.
+ *
+ * @param surfaceNumberOfNodes
+ *    Number of nodes in surface.
+ * @param structure
+ *    Surface's structure.
+ * @param nodeIndices
+ *    Indices of nodes.
+ * @return
+ *    True if a load was requested, false if loading is disabled or
+ *    no rows or columns correspond to the nodes.
+ */
+bool
+CiftiMappableConnectivityMatrixDataFile::requestMapAverageDataForSurfaceNodesAsynchronously(const int32_t surfaceNumberOfNodes,
+                                                                                            const StructureEnum::Enum structure,
+                                                                                            const std::vector<int32_t>& nodeIndices)
+{
+    if ((m_ciftiFile == NULL)
+        || ( ! m_dataLoadingEnabled)
+        || nodeIndices.empty()) {
+        return false;
+    }
+    
+    std::vector<int64_t> rowIndices, columnIndices;
+    getRowColumnIndicesForNodesWhenLoading(structure,
+                                           surfaceNumberOfNodes,
+                                           nodeIndices,
+                                           rowIndices,
+                                           columnIndices);
+    
+    CiftiConnectivityMatrixRowLoader::Request request;
+    if ( ! rowIndices.empty()) {
+        request.m_rowFlag = true;
+        request.m_indices = rowIndices;
+    }
+    else if ( ! columnIndices.empty()) {
+        request.m_rowFlag = false;
+        request.m_indices = columnIndices;
+    }
+    else {
+        return false;
+    }
+    request.m_dataCount   = getDataCountForLoading(request.m_rowFlag);
+    request.m_averageFlag = true;
+    
+    m_asynchronousLoad.reset();
+    m_asynchronousLoad.m_surfaceNumberOfNodes = surfaceNumberOfNodes;
+    m_asynchronousLoad.m_structure            = structure;
+    m_asynchronousLoad.m_nodeIndices          = nodeIndices;
+    m_asynchronousLoad.m_requestIdentifier    = getRowLoader()->requestLoad(request);
+    
+    return true;
+}
+
+/**
+ * If asynchronously loaded data is available, make it the loaded data.
+ * Must be called from the thread that uses this file (GUI thread).
+ *
+ * NOTE: Afterwards, it will be necessary to update this file's color mapping
+ * with updateScalarColoringForMap().
+ *
+ * @param errorMessageOut
+ *    Set to a description of the error if the load failed (the loaded
+ *    data is then all zeros), otherwise empty.
+ * @return
+ *    True if the loaded data changed, else false.
+ */
+bool
+CiftiMappableConnectivityMatrixDataFile::finishAsynchronousLoad(AString& errorMessageOut)
+{
+    errorMessageOut.clear();
+
+    if (m_asynchronousLoad.m_requestIdentifier < 0) {
+        return false;
+    }
+    CaretAssert(m_rowLoader != NULL);
+    
+    std::vector<float> data;
+    AString errorMessage;
+    if ( ! m_rowLoader->takeCompletedLoad(m_asynchronousLoad.m_requestIdentifier,
+                                          data,
+                                          errorMessage)) {
+        if ( ! m_rowLoader->isLoadPending(m_asynchronousLoad.m_requestIdentifier)) {
+            m_asynchronousLoad.reset();
+        }
+        return false;
+    }
+    
+    const AsynchronousLoad load = m_asynchronousLoad;
+    m_asynchronousLoad.reset();
+    
+    if ( ! errorMessage.isEmpty()) {
+        errorMessageOut = ("Error loading connectivity data from "
+                           + getFileNameNoPath()
+                           + ": "
+                           + errorMessage);
+        setLoadedRowDataToAllZeros();
+        return true;
+    }
+    
+    m_loadedRowData.swap(data);
+    m_connectivityDataLoaded->reset();
+    
+    const int32_t numberOfNodeIndices = static_cast<int32_t>(load.m_nodeIndices.size());
+    const bool singleNodeFlag = ((load.m_rowIndex >= 0)
+                                 || (load.m_columnIndex >= 0));
+    if (singleNodeFlag) {
+        setLoadedTextForSurfaceNode(load.m_structure,
+                                    load.m_nodeIndices[0],
+                                    load.m_rowIndex,
+                                    load.m_columnIndex);
+        m_connectivityDataLoaded->setSurfaceNodeLoading(load.m_structure,
+                                                        load.m_surfaceNumberOfNodes,
+                                                        load.m_nodeIndices[0],
+                                                        load.m_rowIndex,
+                                                        load.m_columnIndex);
+    }
+    else {
+        setLoadedTextForSurfaceNodeAverage(load.m_structure,
+                                           numberOfNodeIndices);
+        m_connectivityDataLoaded->setSurfaceAverageNodeLoading(load.m_structure,
+                                                               load.m_surfaceNumberOfNodes,
+                                                               load.m_nodeIndices);
+    }
+    
+    updateForChangeInMapDataWithMapIndex(0);
+    
+    return true;
+}
+
+/**
+ * Abandon any asynchronous load.
+ */
+void
+CiftiMappableConnectivityMatrixDataFile::cancelAsynchronousLoad()
+{
+    if (m_asynchronousLoad.m_requestIdentifier >= 0) {
+        if (m_rowLoader != NULL) {
+            m_rowLoader->cancelLoads();
+        }
+        m_asynchronousLoad.reset();
+    }
+}
+
 /**
  * Load connectivity data for the surface's node.
  *
@@ -805,23 +1332,14 @@ CiftiMappableConnectivityMatrixDataFile::loadMapDataForSurfaceNode(const int32_t
             }
             
             if (dataCount > 0) {
-                m_rowLoadedTextForMapName = ("Row: "
-                                         + AString::number(rowIndex)
-                                         + ", Node Index: "
-                                         + AString::number(nodeIndex)
-                                         + ", Structure: "
-                                         + StructureEnum::toName(structure));
-
-                m_rowLoadedText = ("Row_"
-                                   + AString::number(rowIndex)
-                                   + "_Node_Index_"
-                                   + AString::number(nodeIndex)
-                                   + "_Structure_"
-                                   + StructureEnum::toGuiName(structure));
+                setLoadedTextForSurfaceNode(structure,
+                                            nodeIndex,
+                                            rowIndex,
+                                            -1);
                 CaretAssert((rowIndex >= 0) && (rowIndex < m_ciftiFile->getNumberOfRows()));
-                m_loadedRowData.resize(dataCount);
-                getProcessedDataForRow(&m_loadedRowData[0],
-                                    rowIndex);
+                loadRowOrColumnData(true,
+                                    rowIndex,
+                                    dataCount);
                 
                 CaretLogFine("Read row for node " + AString::number(nodeIndex));
                 
@@ -838,23 +1356,14 @@ CiftiMappableConnectivityMatrixDataFile::loadMapDataForSurfaceNode(const int32_t
         else if (columnIndex >= 0) {
             const int64_t dataCount = m_ciftiFile->getNumberOfRows();
             if (dataCount > 0) {
-                m_rowLoadedTextForMapName = ("Column: "
-                                             + AString::number(columnIndex)
-                                             + ", Node Index: "
-                                             + AString::number(nodeIndex)
-                                             + ", Structure: "
-                                             + StructureEnum::toName(structure));
-                
-                m_rowLoadedText = ("Column_"
-                                   + AString::number(columnIndex)
-                                   + "_Node_Index_"
-                                   + AString::number(nodeIndex)
-                                   + "_Structure_"
-                                   + StructureEnum::toGuiName(structure));
+                setLoadedTextForSurfaceNode(structure,
+                                            nodeIndex,
+                                            -1,
+                                            columnIndex);
                 CaretAssert((columnIndex >= 0) && (columnIndex < m_ciftiFile->getNumberOfColumns()));
-                m_loadedRowData.resize(dataCount);
-                getProcessedDataForColumn(&m_loadedRowData[0],
-                                          columnIndex);
+                loadRowOrColumnData(false,
+                                    columnIndex,
+                                    dataCount);
                 
                 CaretLogFine("Read column for node " + AString::number(nodeIndex));
                 
@@ -968,14 +1477,8 @@ CiftiMappableConnectivityMatrixDataFile::loadMapAverageDataForSurfaceNodes(const
     }
     
     if (dataWasLoaded) {
-        m_rowLoadedTextForMapName = ("Structure: "
-                                     + StructureEnum::toName(structure)
-                                     + ", Averaged Vertex Count: "
-                                     + AString::number(numberOfNodeIndices));
-        m_rowLoadedText =  ("Structure_"
-                            + StructureEnum::toGuiName(structure)
-                            + "_Averaged_Vertex_Count_"
-                            + AString::number(numberOfNodeIndices));
+        setLoadedTextForSurfaceNodeAverage(structure,
+                                           numberOfNodeIndices);
     }
     
     if (dataWasLoaded == false) {
@@ -1058,10 +1561,10 @@ CiftiMappableConnectivityMatrixDataFile::loadMapDataForVoxelAtCoordinate(const i
             dataCount = m_ciftiFile->getNumberOfRows();
         }
         if (dataCount > 0) {
-            m_loadedRowData.resize(dataCount);
             CaretAssert((rowIndex >= 0) && (rowIndex < m_ciftiFile->getNumberOfRows()));
-            getProcessedDataForRow(&m_loadedRowData[0],
-                                   rowIndex);
+            loadRowOrColumnData(true,
+                                rowIndex,
+                                dataCount);
             
             m_rowLoadedTextForMapName = ("Row: "
                                         + AString::number(rowIndex)
@@ -1083,10 +1586,10 @@ CiftiMappableConnectivityMatrixDataFile::loadMapDataForVoxelAtCoordinate(const i
     else if (columnIndex >= 0) {
         const int64_t dataCount = m_ciftiFile->getNumberOfRows();
         if (dataCount > 0) {
-            m_loadedRowData.resize(dataCount);
             CaretAssert((columnIndex >= 0) && (columnIndex < m_ciftiFile->getNumberOfColumns()));
-            getProcessedDataForColumn(&m_loadedRowData[0],
-                                      columnIndex);
+            loadRowOrColumnData(false,
+                                columnIndex,
+                                dataCount);
             
             m_rowLoadedTextForMapName = ("Column: "
                                          + AString::number(columnIndex)
@@ -30,6 +30,7 @@
 
 namespace caret {
 
+    class CiftiConnectivityMatrixRowLoader;
     class ConnectivityDataLoaded;
     class SceneClassAssistant;
     
@@ -71,6 +72,20 @@ namespace caret {
         void loadDataForRowIndex(const int64_t rowIndex);
         
         void loadDataForColumnIndex(const int64_t rowIndex);
+        
+        bool requestMapDataForSurfaceNodeAsynchronously(const int32_t surfaceNumberOfNodes,
+                                                        const StructureEnum::Enum structure,
+                                                        const int32_t nodeIndex);
+        
+        bool requestMapAverageDataForSurfaceNodesAsynchronously(const int32_t surfaceNumberOfNodes,
+                                                                const StructureEnum::Enum structure,
+                                                                const std::vector<int32_t>& nodeIndices);
+        
+        bool finishAsynchronousLoad(AString& errorMessageOut);
+        
+        void cancelAsynchronousLoad();
+        
+        void setRowCacheSizeInBytes(const int64_t cacheSizeInBytes);
                 
         virtual void clear();
         
@@ -130,9 +145,44 @@ namespace caret {
         
         virtual void getDataForRow(float* dataOut, const int64_t& index) const;
         
-        virtual void processRowAverageData(std::vector<float>& rowAverageData);
+        virtual void getDataForRows(float* dataOut, const int64_t& firstIndex, const int64_t& numberOfRows) const;
+        
+        virtual void processRowAverageData(std::vector<float>& rowAverageData) const;
+        
+        void clearRowLoader();
         
     private:
+        /**
+         * Describes the brainordinates for an asynchronous load so that
+         * the loaded data can be labeled when the load completes.
+         */
+        class AsynchronousLoad {
+        public:
+            AsynchronousLoad() { reset(); }
+            
+            void reset() {
+                m_requestIdentifier    = -1;
+                m_surfaceNumberOfNodes = 0;
+                m_structure            = StructureEnum::INVALID;
+                m_nodeIndices.clear();
+                m_rowIndex             = -1;
+                m_columnIndex          = -1;
+            }
+            
+            int64_t m_requestIdentifier;
+            
+            int32_t m_surfaceNumberOfNodes;
+            
+            StructureEnum::Enum m_structure;
+            
+            /** One node for single node loading, more for averaging */
+            std::vector<int32_t> m_nodeIndices;
+            
+            int64_t m_rowIndex;
+            
+            int64_t m_columnIndex;
+        };
+        
         void setLoadedRowDataToAllZeros();
         
         void clearPrivate();
@@ -152,7 +202,29 @@ namespace caret {
         void getRowColumnAverageForIndices(const std::vector<int64_t>& rowIndices,
                                            const std::vector<int64_t>& columnIndices,
                                            std::vector<float>& rowAverageOut,
-                                           std::vector<float>& columnAverageOut);
+                                           std::vector<float>& columnAverageOut) const;
+        
+        int64_t getDataCountForLoading(const bool rowFlag) const;
+        
+        CiftiConnectivityMatrixRowLoader* getRowLoader() const;
+        
+        void loadRowOrColumnData(const bool rowFlag,
+                                 const int64_t index,
+                                 const int64_t dataCount);
+        
+        void readRowColumnDataForLoader(const bool rowFlag,
+                                        const std::vector<int64_t>& indices,
+                                        const bool averageFlag,
+                                        const int64_t dataCount,
+                                        std::vector<float>& dataOut) const;
+        
+        void setLoadedTextForSurfaceNode(const StructureEnum::Enum structure,
+                                         const int32_t nodeIndex,
+                                         const int64_t rowIndex,
+                                         const int64_t columnIndex);
+        
+        void setLoadedTextForSurfaceNodeAverage(const StructureEnum::Enum structure,
+                                                const int32_t numberOfNodeIndices);
         
         void getRowColumnIndicesForVoxelsWhenLoading(const int64_t volumeDimensionIJK[3],
                                                      const std::vector<VoxelIJK>& voxelIndices,
@@ -191,12 +263,25 @@ namespace caret {
          */
         ChartMatrixLoadingDimensionEnum::Enum m_chartLoadingDimension;
         
+        /** Loads and caches rows, created when first needed */
+        mutable CaretPointer<CiftiConnectivityMatrixRowLoader> m_rowLoader;
+        
+        /** Size of the row loader's cache */
+        int64_t m_rowCacheSizeInBytes;
+        
+        /** Asynchronous load that has not been finished */
+        AsynchronousLoad m_asynchronousLoad;
+        
+        /** Maximum bytes of row data read with a single file access when averaging */
+        static const int64_t s_maximumAverageReadSizeInBytes;
+        
         friend class CiftiBrainordinateScalarFile;
+        friend class CiftiConnectivityMatrixRowLoader;
 
     };
     
 #ifdef __CIFTI_MAPPABLE_CONNECTIVITY_MATRIX_DATA_FILE_DECLARE__
-    // <PLACE DECLARATIONS OF STATIC MEMBERS HERE>
+    const int64_t CiftiMappableConnectivityMatrixDataFile::s_maximumAverageReadSizeInBytes = 64 * 1024 * 1024;
 #endif // __CIFTI_MAPPABLE_CONNECTIVITY_MATRIX_DATA_FILE_DECLARE__
 
 } // namespace
@@ -18,6 +18,7 @@
  */
 /*LICENSE_END*/
 
+#include <cstdlib>
 #include <set>
 
 #define __CIFTI_MAPPABLE_DATA_FILE_DECLARE__
@@ -28,10 +29,13 @@
 #include "CaretAssert.h"
 #include "CaretLogger.h"
 #include "ChartDataCartesian.h"
+#include "ChartMatrixImagePyramid.h"
+#include "ChartableMatrixInterface.h"
 #include "CiftiBrainordinateLabelFile.h"
 #include "CiftiBrainordinateScalarFile.h"
 #include "CiftiFiberTrajectoryFile.h"
 #include "CiftiFile.h"
+#include "CiftiMapColoringPrefetcher.h"
 #include "CiftiMappableConnectivityMatrixDataFile.h"
 #include "CiftiParcelLabelFile.h"
 #include "CaretTemporaryFile.h"
@@ -47,6 +51,7 @@
 #include "GroupAndNameHierarchyModel.h"
 #include "Histogram.h"
 #include "NodeAndVoxelColoring.h"
+#include "Palette.h"
 #include "PaletteColorMapping.h"
 #include "PaletteFile.h"
 #include "SparseVolumeIndexer.h"
@@ -94,6 +99,11 @@ CiftiMappableDataFile::CiftiMappableDataFile(const DataFileTypeEnum::Enum dataFi
     m_fileHistogram.grabNew(NULL);
     m_fileHistorgramLimitedValues.grabNew(NULL);
     
+    m_coloringPrefetcher.grabNew(NULL);
+    m_coloringPrefetchPreviousMapIndex = -1;
+    m_coloringPrefetchDirection = 1;
+    m_coloringPrefetchNormalizationMode = PaletteNormalizationModeEnum::NORMALIZATION_SELECTED_MAP_DATA;
+    
     /*
      * Note: The first palette normalization mode is assumed to
      * be the default mode.
@@ -425,6 +435,13 @@ CiftiMappableDataFile::clearPrivate()
      * m_fileMapDataType
      */
     
+    /*
+     * Prefetcher reads from the CIFTI file so it must be
+     * destroyed before the CIFTI file.
+     */
+    m_coloringPrefetcher.grabNew(NULL);
+    m_coloringPrefetchPreviousMapIndex = -1;
+    
     m_ciftiFile.grabNew(NULL);
     
     resetDataLoadingMembers();
@@ -444,6 +461,9 @@ CiftiMappableDataFile::clearPrivate()
 void
 CiftiMappableDataFile::resetDataLoadingMembers()
 {
+    invalidateColoringPrefetch();
+    invalidateMatrixChartImagePyramid();
+    
     const int64_t num = static_cast<int64_t>(m_mapContent.size());
     for (int64_t i = 0; i < num; i++) {
         delete m_mapContent[i];
@@ -1315,6 +1335,12 @@ CiftiMappableDataFile::setMapData(const int32_t mapIndex,
     CaretAssert(m_ciftiFile);
     CaretAssert(mapIndex >= 0);
     
+    /*
+     * Stops the prefetcher from reading while data is replaced
+     */
+    invalidateColoringPrefetch();
+    invalidateMatrixChartImagePyramid();
+    
     switch (m_dataReadingAccessMethod) {
         case DATA_ACCESS_METHOD_INVALID:
             CaretAssert(0);
@@ -1348,6 +1374,8 @@ void
 CiftiMappableDataFile::updateForChangeInMapDataWithMapIndex(const int32_t mapIndex)
 {
     CaretAssertVectorIndex(m_mapContent, mapIndex);
+    invalidateColoringPrefetch();
+    invalidateMatrixChartImagePyramid();
     m_mapContent[mapIndex]->updateForChangeInMapData();
 }
 
@@ -1358,6 +1386,9 @@ CiftiMappableDataFile::updateForChangeInMapDataWithMapIndex(const int32_t mapInd
 void
 CiftiMappableDataFile::invalidateColoringInAllMaps()
 {
+    invalidateColoringPrefetch();
+    invalidateMatrixChartImagePyramid();
+    
     const int64_t numMaps = static_cast<int64_t>(getNumberOfMaps());
     for (int64_t i = 0; i < numMaps; i++) {
         CaretAssertVectorIndex(m_mapContent, i);
@@ -1365,6 +1396,57 @@ CiftiMappableDataFile::invalidateColoringInAllMaps()
     }
 }
 
+/**
+ * Discard the matrix chart image so that it is recreated
+ * the next time the matrix chart is drawn.  Must be called
+ * when the data, its coloring, or the order of rows changes.
+ */
+void
+CiftiMappableDataFile::invalidateMatrixChartImagePyramid()
+{
+    m_matrixChartImagePyramid.grabNew(NULL);
+}
+
+/**
+ * Get the image of the matrix chart for drawing.  Coloring the
+ * matrix is slow for large files so the image is created only
+ * when it does not exist or has been invalidated.
+ *
+ * @return
+ *    Image of the matrix chart or NULL if this file is not a
+ *    matrix chart or its coloring is not valid.
+ */
+ChartMatrixImagePyramid*
+CiftiMappableDataFile::getMatrixChartImagePyramid()
+{
+    if (m_matrixChartImagePyramid.getPointer() == NULL) {
+        const ChartableMatrixInterface* matrixInterface = dynamic_cast<const ChartableMatrixInterface*>(this);
+        if (matrixInterface == NULL) {
+            return NULL;
+        }
+        
+        int32_t numberOfRows = 0;
+        int32_t numberOfColumns = 0;
+        std::vector<float> matrixRGBA;
+        if (matrixInterface->getMatrixDataRGBA(numberOfRows,
+                                               numberOfColumns,
+                                               matrixRGBA)) {
+            /*
+             * Label colors must not be blended when the matrix is reduced.
+             */
+            const ChartMatrixImagePyramid::AggregationMode aggregationMode = (isMappedWithLabelTable()
+                                                                              ? ChartMatrixImagePyramid::AGGREGATION_MAXIMUM
+                                                                              : ChartMatrixImagePyramid::AGGREGATION_MEAN);
+            m_matrixChartImagePyramid.grabNew(new ChartMatrixImagePyramid(numberOfRows,
+                                                                          numberOfColumns,
+                                                                          matrixRGBA,
+                                                                          aggregationMode));
+        }
+    }
+    
+    return m_matrixChartImagePyramid.getPointer();
+}
+
 /**
  * Get all data within the file.
  *
@@ -1975,6 +2057,10 @@ CiftiMappableDataFile::updateScalarColoringForAllMaps(const PaletteFile* /*palet
  * retrieve data for the map.  Use isMapColoringValid() to avoid 
  * unnecessary calls to isMapColoringValid.
  *
+ * If the map was colored ahead of time by the coloring prefetcher, that
+ * coloring is used.  Maps near this map are then queued for coloring
+ * by the prefetcher since they are likely to be viewed next.
+ *
  * @param mapIndex
  *    Index of map.
  * @param paletteFile
@@ -1986,36 +2072,250 @@ CiftiMappableDataFile::updateScalarColoringForMap(const int32_t mapIndex,
 {
     CaretAssertVectorIndex(m_mapContent,
                            mapIndex);
+    MapContent* mapContent = m_mapContent[mapIndex];
     
-    std::vector<float> data;
-    getMapData(mapIndex,
-               data);
+    mapContent->m_rgbaValid = false;
+    invalidateMatrixChartImagePyramid();
+    
+    if (m_coloringPrefetcher != NULL) {
+        if (m_coloringPrefetchNormalizationMode != getPaletteNormalizationMode()) {
+            invalidateColoringPrefetch();
+        }
+        
+        CaretPointer<FastStatistics> mapStatistics;
+        if (m_coloringPrefetcher->takeColoring(mapIndex,
+                                               (isMappedWithPalette() ? mapContent->m_paletteColorMapping : NULL),
+                                               (isMappedWithLabelTable() ? mapContent->m_labelTable : NULL),
+                                               mapContent->m_rgba,
+                                               mapStatistics)) {
+            if ((mapStatistics != NULL)
+                && ( ! mapContent->isFastStatisticsValid())) {
+                mapContent->m_fastStatistics = mapStatistics;
+            }
+            mapContent->m_dataCount = static_cast<int64_t>(mapContent->m_rgba.size() / 4);
+            mapContent->m_rgbaValid = true;
+        }
+    }
+    
+    if ( ! mapContent->m_rgbaValid) {
+        std::vector<float> data;
+        getMapData(mapIndex,
+                   data);
+        
+        if (isMappedWithPalette()) {
+            
+            FastStatistics* statistics = NULL;
+            switch (getPaletteNormalizationMode()) {
+                case PaletteNormalizationModeEnum::NORMALIZATION_ALL_MAP_DATA:
+                    statistics = const_cast<FastStatistics*>(getFileFastStatistics());
+                    break;
+                case PaletteNormalizationModeEnum::NORMALIZATION_SELECTED_MAP_DATA:
+                    /*
+                     * Per-map statistics are expensive and are not
+                     * needed when the user scale mode is selected.
+                     */
+                    if ((mapContent->m_paletteColorMapping == NULL)
+                        || mapContent->m_paletteColorMapping->isStatisticsNeededForScaleMode()) {
+                        statistics = const_cast<FastStatistics*>(getMapFastStatistics(mapIndex));
+                    }
+                    break;
+            }
+            
+            mapContent->updateColoring(data,
+                                       paletteFile,
+                                       statistics);
+        }
+        else if (isMappedWithLabelTable()) {
+            mapContent->updateColoring(data,
+                                       paletteFile,
+                                       NULL);
+        }
+        else {
+            CaretAssert(0);
+        }
+    }
+    
+    requestColoringPrefetchNearMap(mapIndex,
+                                   paletteFile);
+}
 
-    m_mapContent[mapIndex]->m_rgbaValid = false;
-    if (isMappedWithPalette()) {
+/**
+ * @return True if maps in this file may be colored ahead of time by
+ * the coloring prefetcher.  Data must be in memory since reading
+ * from the file is not thread safe and the file must contain more
+ * than one map.
+ */
+bool
+CiftiMappableDataFile::isColoringPrefetchSupported() const
+{
+    if (m_ciftiFile == NULL) {
+        return false;
+    }
+    if (m_fileMapDataType != FILE_MAP_DATA_TYPE_MULTI_MAP) {
+        return false;
+    }
+    if (getNumberOfMaps() < 2) {
+        return false;
+    }
+    if ( ! m_ciftiFile->isInMemory()) {
+        return false;
+    }
+    
+    switch (m_dataReadingAccessMethod) {
+        case DATA_ACCESS_METHOD_INVALID:
+        case DATA_ACCESS_NONE:
+            return false;
+            break;
+        case DATA_ACCESS_FILE_COLUMNS_OR_XML_ALONG_ROW:
+        case DATA_ACCESS_FILE_ROWS_OR_XML_ALONG_COLUMN:
+            break;
+    }
+    
+    return (isMappedWithPalette()
+            || isMappedWithLabelTable());
+}
+
+/**
+ * Queue the maps that are likely to be viewed after the given map
+ * for coloring on the prefetcher's thread.  When the user is stepping
+ * through the maps (animation or time scrubbing), the maps ahead in the
+ * direction of stepping are queued first followed by the previous map.
+ * Each tab (or yoked tab) that displays a map of this file makes its
+ * own requests so several viewing positions are supported.
+ *
+ * @param mapIndex
+ *    Index of map that was just colored.
+ * @param paletteFile
+ *    Palette file containing palettes.
+ */
+void
+CiftiMappableDataFile::requestColoringPrefetchNearMap(const int32_t mapIndex,
+                                                      const PaletteFile* paletteFile)
+{
+    if (mapIndex == m_coloringPrefetchPreviousMapIndex) {
+        return;
+    }
+    if ( ! isColoringPrefetchSupported()) {
+        return;
+    }
+    if (isMappedWithPalette()
+        && (paletteFile == NULL)) {
+        return;
+    }
+    
+    /*
+     * Small steps indicate animation or scrubbing so use them to
+     * update the direction.  A large jump is likely a different
+     * tab or the user selecting a map so keep the direction.
+     */
+    if (m_coloringPrefetchPreviousMapIndex >= 0) {
+        const int32_t step = mapIndex - m_coloringPrefetchPreviousMapIndex;
+        if ((step != 0)
+            && (std::abs(step) <= S_COLORING_PREFETCH_MAPS_AHEAD)) {
+            m_coloringPrefetchDirection = ((step > 0) ? 1 : -1);
+        }
+    }
+    m_coloringPrefetchPreviousMapIndex = mapIndex;
+    
+    if (m_coloringPrefetcher == NULL) {
+        const bool mapsAreColumnsFlag = (m_dataReadingAccessMethod == DATA_ACCESS_FILE_COLUMNS_OR_XML_ALONG_ROW);
+        m_coloringPrefetcher.grabNew(new CiftiMapColoringPrefetcher(m_ciftiFile,
+                                                                    mapsAreColumnsFlag));
+        m_coloringPrefetchNormalizationMode = getPaletteNormalizationMode();
+    }
+    
+    const int32_t numberOfMaps = getNumberOfMaps();
+    std::vector<int32_t> candidateMapIndices;
+    for (int32_t i = 1; i <= S_COLORING_PREFETCH_MAPS_AHEAD; i++) {
+        candidateMapIndices.push_back(mapIndex + (i * m_coloringPrefetchDirection));
+    }
+    candidateMapIndices.push_back(mapIndex - m_coloringPrefetchDirection);
+    
+    const PaletteNormalizationModeEnum::Enum normalizationMode = getPaletteNormalizationMode();
+    CaretPointer<FastStatistics> fileStatistics;
+    CaretPointer<Palette> paletteCopy;
+    
+    std::vector<CiftiMapColoringPrefetcher::Request> requests;
+    for (std::vector<int32_t>::iterator iter = candidateMapIndices.begin();
+         iter != candidateMapIndices.end();
+         iter++) {
+        const int32_t candidateIndex = *iter;
+        if ((candidateIndex < 0)
+            || (candidateIndex >= numberOfMaps)) {
+            continue;
+        }
         
-        FastStatistics* statistics = NULL;
-        switch (getPaletteNormalizationMode()) {
-            case PaletteNormalizationModeEnum::NORMALIZATION_ALL_MAP_DATA:
-                statistics = const_cast<FastStatistics*>(getFileFastStatistics());
-                break;
-            case PaletteNormalizationModeEnum::NORMALIZATION_SELECTED_MAP_DATA:
-                statistics = const_cast<FastStatistics*>(getMapFastStatistics(mapIndex));
-                break;
+        CaretAssertVectorIndex(m_mapContent, candidateIndex);
+        const MapContent* mc = m_mapContent[candidateIndex];
+        if (mc->m_rgbaValid) {
+            continue;
         }
+        if (m_coloringPrefetcher->isQueuedOrCached(candidateIndex)) {
+            continue;
+        }
+        
+        CiftiMapColoringPrefetcher::Request request;
+        request.m_mapIndex = candidateIndex;
         
-        m_mapContent[mapIndex]->updateColoring(data,
-                                               paletteFile,
-                                               statistics);
+        if (isMappedWithLabelTable()) {
+            CaretAssert(mc->m_labelTable);
+            request.m_labelTable.grabNew(new GiftiLabelTable(*mc->m_labelTable));
+        }
+        else {
+            CaretAssert(mc->m_paletteColorMapping);
+            const Palette* palette = paletteFile->getPaletteByName(mc->m_paletteColorMapping->getSelectedPaletteName());
+            if (palette == NULL) {
+                continue;
+            }
+            if ((paletteCopy == NULL)
+                || (paletteCopy->getName() != palette->getName())) {
+                paletteCopy.grabNew(new Palette(*palette));
+            }
+            request.m_palette = paletteCopy;
+            request.m_paletteColorMapping.grabNew(new PaletteColorMapping(*mc->m_paletteColorMapping));
+            
+            switch (normalizationMode) {
+                case PaletteNormalizationModeEnum::NORMALIZATION_ALL_MAP_DATA:
+                    if (fileStatistics == NULL) {
+                        const FastStatistics* fs = getFileFastStatistics();
+                        if (fs == NULL) {
+                            return;
+                        }
+                        fileStatistics.grabNew(new FastStatistics(*fs));
+                    }
+                    request.m_statistics = fileStatistics;
+                    break;
+                case PaletteNormalizationModeEnum::NORMALIZATION_SELECTED_MAP_DATA:
+                    if (mc->isFastStatisticsValid()) {
+                        request.m_statistics.grabNew(new FastStatistics(*mc->m_fastStatistics));
+                    }
+                    else {
+                        request.m_mapStatisticsNeeded = mc->m_paletteColorMapping->isStatisticsNeededForScaleMode();
+                    }
+                    break;
+            }
+        }
+        
+        requests.push_back(request);
     }
-    else if (isMappedWithLabelTable()) {
-        m_mapContent[mapIndex]->updateColoring(data,
-                                               paletteFile,
-                                               NULL);
+    
+    if ( ! requests.empty()) {
+        m_coloringPrefetcher->requestColoring(requests);
     }
-    else {
-        CaretAssert(0);
+}
+
+/**
+ * Invalidate any coloring that is queued or cached by the coloring
+ * prefetcher, usually because data or coloring parameters changed.
+ */
+void
+CiftiMappableDataFile::invalidateColoringPrefetch()
+{
+    if (m_coloringPrefetcher != NULL) {
+        m_coloringPrefetcher->invalidate();
     }
+    m_coloringPrefetchPreviousMapIndex = -1;
+    m_coloringPrefetchNormalizationMode = getPaletteNormalizationMode();
 }
 
 /**
@@ -6726,6 +7026,17 @@ CiftiMappableDataFile::MapContent::updateColoring(const std::vector<float>& data
         CaretAssert(m_paletteColorMapping);
         const AString paletteName = m_paletteColorMapping->getSelectedPaletteName();
         const Palette* palette = paletteFile->getPaletteByName(paletteName);
+        
+        /*
+         * Statistics are not used with the user scale mode
+         * but the coloring code requires a valid instance.
+         */
+        FastStatistics emptyStatistics;
+        if ((fastStatistics == NULL)
+            && ( ! m_paletteColorMapping->isStatisticsNeededForScaleMode())) {
+            fastStatistics = &emptyStatistics;
+        }
+        
         if ((palette != NULL)
             && (fastStatistics != NULL)) {
             NodeAndVoxelColoring::colorScalarsWithPalette(fastStatistics,
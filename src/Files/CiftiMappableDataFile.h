@@ -35,7 +35,9 @@ namespace caret {
     
     class ChartData;
     class ChartDataCartesian;
+    class ChartMatrixImagePyramid;
     class CiftiFile;
+    class CiftiMapColoringPrefetcher;
     class CiftiParcelsMap;
     class CiftiXML;
     class FastStatistics;
@@ -471,6 +473,8 @@ namespace caret {
         
         const CiftiFile* getCiftiFile() const { return m_ciftiFile; }
         
+        ChartMatrixImagePyramid* getMatrixChartImagePyramid();
+        
     protected:
         virtual bool getParcelLabelMapSurfaceNodeValue(const int32_t mapIndex,
                                             const StructureEnum::Enum structure,
@@ -627,6 +631,13 @@ namespace caret {
         
         void clearPrivate();
         
+        bool isColoringPrefetchSupported() const;
+        
+        void requestColoringPrefetchNearMap(const int32_t mapIndex,
+                                            const PaletteFile* paletteFile);
+        
+        void invalidateColoringPrefetch();
+        
     protected:
         void initializeAfterReading(const AString& filename);
         
@@ -634,6 +645,8 @@ namespace caret {
         
         void resetDataLoadingMembers();
         
+        void invalidateMatrixChartImagePyramid();
+        
         void validateKeysAndLabels() const;
         
         virtual void validateAfterFileReading();
@@ -736,6 +749,23 @@ namespace caret {
         
         /** force an update of the class and name hierarchy */
         mutable bool m_forceUpdateOfGroupAndNameHierarchy;
+        
+        /** Colors maps near the displayed map on a background thread */
+        CaretPointer<CiftiMapColoringPrefetcher> m_coloringPrefetcher;
+        
+        /** Index of map most recently colored, used to predict the next map */
+        int32_t m_coloringPrefetchPreviousMapIndex;
+        
+        /** Direction (1 or -1) that the user is stepping through maps */
+        int32_t m_coloringPrefetchDirection;
+        
+        /** Normalization mode used when the prefetch requests were made */
+        PaletteNormalizationModeEnum::Enum m_coloringPrefetchNormalizationMode;
+        
+        /** Image of the matrix chart, kept until the data, coloring, or row order changes */
+        CaretPointer<ChartMatrixImagePyramid> m_matrixChartImagePyramid;
+        
+        static const int32_t S_COLORING_PREFETCH_MAPS_AHEAD;
 
         
         static const int32_t S_CIFTI_XML_ALONG_INVALID;
@@ -748,6 +778,7 @@ namespace caret {
     
 #ifdef __CIFTI_MAPPABLE_DATA_FILE_DECLARE__
     const int32_t CiftiMappableDataFile::S_CIFTI_XML_ALONG_INVALID = -1;
+    const int32_t CiftiMappableDataFile::S_COLORING_PREFETCH_MAPS_AHEAD = 3;
 #endif // __CIFTI_MAPPABLE_DATA_FILE_DECLARE__
     
 } // namespace
@@ -392,6 +392,7 @@ CiftiParcelLabelFile::restoreFileDataFromScene(const SceneAttributes* sceneAttri
     
     m_sceneAssistant->restoreMembers(sceneAttributes,
                                      sceneClass);
+    invalidateMatrixChartImagePyramid();
     
     for (int32_t i = 0; i < BrainConstants::MAXIMUM_NUMBER_OF_BROWSER_TABS; i++) {
         m_chartingEnabledForTab[i] = false;
@@ -519,6 +520,7 @@ CiftiParcelLabelFile::setSelectedParcelLabelFileAndMapForReordering(CiftiParcelL
     m_parcelReorderingModel->setSelectedParcelLabelFileAndMapForReordering(selectedParcelLabelFile,
                                                                            selectedParcelLabelFileMapIndex,
                                                                            enabledStatus);
+    invalidateMatrixChartImagePyramid();
 }
 
 /**
@@ -558,6 +560,7 @@ CiftiParcelLabelFile::createParcelReordering(const CiftiParcelLabelFile* parcelL
                                                           const int32_t parcelLabelFileMapIndex,
                                                           AString& errorMessageOut)
 {
+    invalidateMatrixChartImagePyramid();
     return m_parcelReorderingModel->createParcelReordering(parcelLabelFile,
                                                            parcelLabelFileMapIndex,
                                                            errorMessageOut);
@@ -533,6 +533,7 @@ CiftiParcelScalarFile::restoreFileDataFromScene(const SceneAttributes* sceneAttr
 
     m_sceneAssistant->restoreMembers(sceneAttributes,
                                      sceneClass);
+    invalidateMatrixChartImagePyramid();
     
     /*
      * Originally, charting was "per file": m_chartingEnabled
@@ -632,6 +633,7 @@ CiftiParcelScalarFile::setSelectedParcelLabelFileAndMapForReordering(CiftiParcel
     m_parcelReorderingModel->setSelectedParcelLabelFileAndMapForReordering(selectedParcelLabelFile,
                                                                            selectedParcelLabelFileMapIndex,
                                                                            enabledStatus);
+    invalidateMatrixChartImagePyramid();
 }
 
 /**
@@ -673,6 +675,7 @@ CiftiParcelScalarFile::createParcelReordering(const CiftiParcelLabelFile* parcel
                                                           const int32_t parcelLabelFileMapIndex,
                                                           AString& errorMessageOut)
 {
+    invalidateMatrixChartImagePyramid();
     return m_parcelReorderingModel->createParcelReordering(parcelLabelFile,
                                                            parcelLabelFileMapIndex,
                                                            errorMessageOut);
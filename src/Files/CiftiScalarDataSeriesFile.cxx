@@ -470,6 +470,7 @@ CiftiScalarDataSeriesFile::loadLineSeriesChartDataForRow(const int32_t rowIndex)
                         chartData->setTimeStartInSecondsAxisX(timeStart);
                         chartData->setTimeStepInSecondsAxisX(timeStep);
                         
+                        chartData->reservePoints(numberOfElementsInRow);
                         for (int64_t i = 0; i < numberOfElementsInRow; i++) {
                             const float xValue = timeStart + (i * timeStep);
                             
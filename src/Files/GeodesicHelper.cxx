@@ -29,6 +29,7 @@
 
 #include <cmath>
 #include <iostream>
+#include <limits>
 #include <stdint.h>
 
 using namespace caret;
@@ -1181,7 +1182,7 @@ void GeodesicHelper::aStarLine(const int32_t& root, const int32_t& endpoint, con
     }
 }
 
-void GeodesicHelper::aStarData(const int32_t& root, const int32_t& endpoint, const float* data, const float& followStrength, const float* roiData, const bool& smooth)
+void GeodesicHelper::aStarData(const int32_t& root, const int32_t& endpoint, const float* data, const float& followStrength, const float* roiData, const bool& smooth, const float& maxCost)
 {//NOTE: for consistent behavior, data must not contain negatives (or anything non-numeric)
     int32_t whichnode, whichneigh, numNeigh, numChanged = 0;
     const int32_t* neighbors;
@@ -1209,6 +1210,7 @@ void GeodesicHelper::aStarData(const int32_t& root, const int32_t& endpoint, con
                 if (!(marked[whichneigh] & 4))
                 {
                     heurVal[whichneigh] = m_corrAreaSmallestFactor * (nodeCoords[whichneigh] - nodeCoords[endpoint]).length();
+                    if (tempf + heurVal[whichneigh] > maxCost) continue;//heuristic is admissible, so this can't be on a path as good as the bound
                     output[whichneigh] = tempf;
                     parent[whichneigh] = whichnode;
                     changed[numChanged++] = whichneigh;//having a valid value will be the first marking, so set changed
@@ -1236,6 +1238,7 @@ void GeodesicHelper::aStarData(const int32_t& root, const int32_t& endpoint, con
                     if (!(marked[whichneigh] & 4))
                     {
                         heurVal[whichneigh] = m_corrAreaSmallestFactor * (nodeCoords[whichneigh] - nodeCoords[endpoint]).length();
+                        if (tempf + heurVal[whichneigh] > maxCost) continue;
                         output[whichneigh] = tempf;
                         parent[whichneigh] = whichnode;
                         changed[numChanged++] = whichneigh;//having a valid value will be the first marking, so set changed
@@ -1256,6 +1259,48 @@ void GeodesicHelper::aStarData(const int32_t& root, const int32_t& endpoint, con
     }
 }
 
+float GeodesicHelper::pathCostFollowingData(const vector<int32_t>& path, const int32_t& root, const int32_t& endpoint, const float* data, const float& followStrength, const float* roiData, const bool& smooth)
+{//same steps and operation order as aStarData, so the cost matches what the search would compute for this path
+    const float INVALID = numeric_limits<float>::infinity();
+    if (path.size() < 2 || path[0] != root || path.back() != endpoint) return INVALID;
+    float cost = 0.0f;
+    for (int32_t i = 1; i < (int32_t)path.size(); ++i)
+    {
+        const int32_t whichnode = path[i - 1], whichneigh = path[i];
+        if (whichneigh < 0 || whichneigh >= numNodes) return INVALID;
+        if (roiData != NULL && !(roiData[whichneigh] > 0.0f)) return INVALID;
+        float step = INVALID;
+        const int32_t* neighbors = nodeNeighbors[whichnode].data();
+        int32_t numNeigh = (int32_t)nodeNeighbors[whichnode].size();
+        for (int32_t j = 0; j < numNeigh; ++j)
+        {
+            if (neighbors[j] == whichneigh)
+            {
+                step = distances[whichnode][j] * (1.0f + followStrength * (data[whichnode] + data[whichneigh]));
+                break;
+            }
+        }
+        if (step == INVALID && smooth)
+        {
+            neighbors = nodeNeighbors2[whichnode].data();
+            numNeigh = (int32_t)nodeNeighbors2[whichnode].size();
+            const GeodesicHelperBase::CrawlInfo* pathInfo = neighbors2PathInfo[whichnode].data();
+            for (int32_t j = 0; j < numNeigh; ++j)
+            {
+                if (neighbors[j] == whichneigh)
+                {
+                    step = distances2[whichnode][j] + followStrength * (data[whichnode] * pathInfo[j].pieceDists[0] + data[whichneigh] * pathInfo[j].pieceDists[1]
+                                + distances2[whichnode][j] * (data[pathInfo[j].edgeNodes[0]] * pathInfo[j].edgeWeight + data[pathInfo[j].edgeNodes[1]] * (1.0f - pathInfo[j].edgeWeight)));
+                    break;
+                }
+            }
+        }
+        if (step == INVALID) return INVALID;//not connected in this mesh
+        cost = cost + step;
+    }
+    return cost * 1.0001f + 1e-6f;//allow for rounding differences in the search
+}
+
 void GeodesicHelper::getGeoToTheseNodes(const int32_t root, const std::vector<int32_t>& ofInterest, std::vector<float>& distsOut, bool smoothflag)
 {
     CaretAssert(root >= 0 && root < numNodes);
@@ -1416,7 +1461,8 @@ void GeodesicHelper::getPathAlongLineSegment(const int32_t root, const int32_t e
 }
 
 void GeodesicHelper::getPathFollowingData(const int32_t root, const int32_t endpoint, const float* data, vector<int32_t>& pathNodesOut, vector<float>& pathDistsOut,
-                                          const float& followStrength, const float* roiData, const bool& followMaximum, const bool& smoothFlag)
+                                          const float& followStrength, const float* roiData, const bool& followMaximum, const bool& smoothFlag,
+                                          const vector<int32_t>* boundingPath)
 {
     CaretAssert(root >= 0 && root < numNodes && endpoint >= 0 && endpoint < numNodes);
     pathNodesOut.clear();
@@ -1466,7 +1512,12 @@ void GeodesicHelper::getPathFollowingData(const int32_t root, const int32_t endp
     }
     CaretMutexLocker locked(&inUse);//let sanity checks fail without locking
     parent[endpoint] = -2;//sentinel value that DOESN'T mean end of path
-    aStarData(root, endpoint, rescaledData.data(), followStrength, roiData, smoothFlag);
+    float maxCost = numeric_limits<float>::infinity();
+    if (boundingPath != NULL)
+    {
+        maxCost = pathCostFollowingData(*boundingPath, root, endpoint, rescaledData.data(), followStrength, roiData, smoothFlag);
+    }
+    aStarData(root, endpoint, rescaledData.data(), followStrength, roiData, smoothFlag, maxCost);
     if (parent[endpoint] == -2)//check for invalid value
     {
         return;
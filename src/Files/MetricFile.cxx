@@ -82,7 +82,7 @@ MetricFile::operator=(const MetricFile& sf)
  */
 MetricFile::~MetricFile()
 {
-    this->columnDataPointers.clear();
+    this->columnDataArrays.clear();
 }
 
 void MetricFile::writeFile(const AString& filename)
@@ -101,7 +101,7 @@ void
 MetricFile::clear()
 {
     GiftiTypeFile::clear();
-    this->columnDataPointers.clear();
+    this->columnDataArrays.clear();
 }
 
 /**
@@ -112,7 +112,7 @@ MetricFile::clear()
 void 
 MetricFile::validateDataArraysAfterReading()
 {
-    this->columnDataPointers.clear();
+    this->columnDataArrays.clear();
 
     this->initializeMembersMetricFile();
         
@@ -133,7 +133,7 @@ MetricFile::validateDataArraysAfterReading()
         std::vector<int64_t> dims = gda->getDimensions();
         if (numDims == 1 || (numDims == 2 && dims[1] == 1))
         {
-            this->columnDataPointers.push_back(gda->getDataPointerFloat());
+            this->columnDataArrays.push_back(gda);
         } else {
             if (numDims != 2)
             {
@@ -163,7 +163,7 @@ MetricFile::validateDataArraysAfterReading()
                 }
                 newFile->addDataArray(tempArray);
                 newFile->setDataArrayName(indices[1], "#" + AString::number(indices[1] + 1));
-                columnDataPointers.push_back(tempArray->getDataPointerFloat());
+                columnDataArrays.push_back(tempArray);
             }
             delete giftiFile;//delete old 2D file
             giftiFile = newFile;//drop new 1D file in
@@ -248,11 +248,12 @@ float
 MetricFile::getValue(const int32_t nodeIndex,
                      const int32_t columnIndex) const
 {
-    CaretAssertVectorIndex(this->columnDataPointers, columnIndex);
+    CaretAssertVectorIndex(this->columnDataArrays, columnIndex);
     CaretAssertMessage((nodeIndex >= 0) && (nodeIndex < this->getNumberOfNodes()), 
                        "Node Index out of range.");
     
-    return this->columnDataPointers[columnIndex][nodeIndex];
+    const GiftiDataArray* column = this->columnDataArrays[columnIndex];
+    return column->getDataPointerFloat()[nodeIndex];
 }
 
 /**
@@ -270,30 +271,31 @@ MetricFile::setValue(const int32_t nodeIndex,
                      const int32_t columnIndex,
                      const float value)
 {
-    CaretAssertVectorIndex(this->columnDataPointers, columnIndex);
+    CaretAssertVectorIndex(this->columnDataArrays, columnIndex);
     CaretAssertMessage((nodeIndex >= 0) && (nodeIndex < this->getNumberOfNodes()), "Node Index out of range.");
     
-    this->columnDataPointers[columnIndex][nodeIndex] = value;
+    this->columnDataArrays[columnIndex]->getDataPointerFloat()[nodeIndex] = value;
     setModified();
 }
 
 const float* 
 MetricFile::getValuePointerForColumn(const int32_t columnIndex) const
 {
-    CaretAssertVectorIndex(this->columnDataPointers, columnIndex);
-    return this->columnDataPointers[columnIndex];
+    CaretAssertVectorIndex(this->columnDataArrays, columnIndex);
+    const GiftiDataArray* column = this->columnDataArrays[columnIndex];
+    return column->getDataPointerFloat();
 }
 
 void MetricFile::setNumberOfNodesAndColumns(int32_t nodes, int32_t columns)
 {
     giftiFile->clearAndKeepMetadata();
-    columnDataPointers.clear();
+    columnDataArrays.clear();
     std::vector<int64_t> dimensions;
     dimensions.push_back(nodes);
     for (int32_t i = 0; i < columns; ++i)
     {
         giftiFile->addDataArray(new GiftiDataArray(NiftiIntentEnum::NIFTI_INTENT_NORMAL, NiftiDataTypeEnum::NIFTI_TYPE_FLOAT32, dimensions, GiftiEncodingEnum::GZIP_BASE64_BINARY));
-        columnDataPointers.push_back(giftiFile->getDataArray(i)->getDataPointerFloat());
+        columnDataArrays.push_back(giftiFile->getDataArray(i));
     }
     setModified();
 }
@@ -343,7 +345,7 @@ MetricFile::addMaps(const int32_t numberOfNodes,
                                                              dimensions, 
                                                              GiftiEncodingEnum::GZIP_BASE64_BINARY));
             const int32_t mapIndex = giftiFile->getNumberOfDataArrays() - 1;
-            this->columnDataPointers.push_back(giftiFile->getDataArray(mapIndex)->getDataPointerFloat());
+            this->columnDataArrays.push_back(giftiFile->getDataArray(mapIndex));
         }
     }
     else {
@@ -356,8 +358,8 @@ MetricFile::addMaps(const int32_t numberOfNodes,
 
 void MetricFile::setValuesForColumn(const int32_t columnIndex, const float* valuesIn)
 {
-    CaretAssertVectorIndex(this->columnDataPointers, columnIndex);
-    float* myColumn = columnDataPointers[columnIndex];
+    CaretAssertVectorIndex(this->columnDataArrays, columnIndex);
+    float* myColumn = columnDataArrays[columnIndex]->getDataPointerFloat();
     int numNodes = (int)getNumberOfNodes();
     for (int i = 0; i < numNodes; ++i)
     {
@@ -368,8 +370,8 @@ void MetricFile::setValuesForColumn(const int32_t columnIndex, const float* valu
 
 void MetricFile::initializeColumn(const int32_t columnIndex, const float& value)
 {
-    CaretAssertVectorIndex(this->columnDataPointers, columnIndex);
-    float* myColumn = columnDataPointers[columnIndex];
+    CaretAssertVectorIndex(this->columnDataArrays, columnIndex);
+    float* myColumn = columnDataArrays[columnIndex]->getDataPointerFloat();
     int numNodes = (int)getNumberOfNodes();
     for (int i = 0; i < numNodes; ++i)
     {
@@ -114,8 +114,8 @@ namespace caret {
                                               const SceneClass* sceneClass);
         
     private:
-        /** Points to actual data in each Gifti Data Array */
-        std::vector<float*> columnDataPointers;
+        /** The Gifti Data Array of each column, data may not be decoded until first used */
+        std::vector<GiftiDataArray*> columnDataArrays;
 
         bool m_chartingEnabledForTab[BrainConstants::MAXIMUM_NUMBER_OF_BROWSER_TABS];
     };
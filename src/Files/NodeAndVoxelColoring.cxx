@@ -19,7 +19,9 @@
  */
 /*LICENSE_END*/
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <limits>
 
 //#include <QRunnable>
@@ -660,6 +662,71 @@ NodeAndVoxelColoring::colorIndicesWithLabelTableForDisplayGroupTab(const GiftiLa
                                                             (void*)rgbv);
 }
 
+/**
+ * Copy label entry colors to indices (helper for
+ * colorIndicesWithLabelTableForDisplayGroupTabPrivate()).
+ *
+ * @param labelIndices
+ *     The label keys of the indices.
+ * @param numberOfIndices
+ *     Number of indices.
+ * @param labelKeys
+ *     Keys of the label table in ascending order.
+ * @param denseKeysFlag
+ *     If true, entries are indexed by (key - minimumKey), otherwise
+ *     entries are in the order of labelKeys.
+ * @param minimumKey
+ *     Smallest key in the label table.
+ * @param entryRGBA
+ *     RGBA for each entry, the last entry is for keys not in the table.
+ * @param rgbaOut
+ *     Output with assigned colors.  Number of elements is (numberOfIndices * 4).
+ */
+template <typename T>
+static void
+colorIndicesWithLabelEntries(const float* labelIndices,
+                             const int64_t numberOfIndices,
+                             const std::vector<int32_t>& labelKeys,
+                             const bool denseKeysFlag,
+                             const int64_t minimumKey,
+                             const T* entryRGBA,
+                             T* rgbaOut)
+{
+    const int64_t numberOfKeys = static_cast<int64_t>(labelKeys.size());
+    if (denseKeysFlag) {
+        const uint64_t keyRange = (numberOfKeys > 0) ? (labelKeys.back() - minimumKey + 1) : 0;
+#pragma omp CARET_PARFOR schedule(static, 4096)
+        for (int64_t i = 0; i < numberOfIndices; i++) {
+            const uint64_t offset = static_cast<int64_t>(labelIndices[i]) - minimumKey;
+            const int64_t e4 = ((offset < keyRange) ? offset : keyRange) * 4;
+            const int64_t i4 = i * 4;
+            rgbaOut[i4]   = entryRGBA[e4];
+            rgbaOut[i4+1] = entryRGBA[e4+1];
+            rgbaOut[i4+2] = entryRGBA[e4+2];
+            rgbaOut[i4+3] = entryRGBA[e4+3];
+        }
+    }
+    else {
+        const int32_t* firstKey = (numberOfKeys > 0) ? &labelKeys[0] : NULL;
+#pragma omp CARET_PARFOR schedule(static, 4096)
+        for (int64_t i = 0; i < numberOfIndices; i++) {
+            const int64_t labelKey = static_cast<int64_t>(labelIndices[i]);
+            const int32_t* keyPtr = std::lower_bound(firstKey, firstKey + numberOfKeys, labelKey);
+            int64_t entry = keyPtr - firstKey;
+            if ((entry >= numberOfKeys)
+                || (*keyPtr != labelKey)) {
+                entry = numberOfKeys;
+            }
+            const int64_t e4 = entry * 4;
+            const int64_t i4 = i * 4;
+            rgbaOut[i4]   = entryRGBA[e4];
+            rgbaOut[i4+1] = entryRGBA[e4+1];
+            rgbaOut[i4+2] = entryRGBA[e4+2];
+            rgbaOut[i4+3] = entryRGBA[e4+3];
+        }
+    }
+}
+
 /**
  * Assign colors to label indices using a GIFTI label table.
  *
@@ -706,73 +773,101 @@ NodeAndVoxelColoring::colorIndicesWithLabelTableForDisplayGroupTabPrivate(const
     
     
     /*
-     * Invalidate all coloring.
+     * Find the color of each label once so that coloring each index
+     * is an array lookup instead of a search of the label table and
+     * a test of the label's selection status.  A label that is not
+     * displayed has an alpha of zero, and the last entry is for
+     * indices that are not a key in the label table.  When keys are
+     * not too sparse, the entries are indexed by key.  Otherwise,
+     * they are in key order and found with a binary search.
      */
+    std::vector<int32_t> labelKeys;
+    labelTable->getKeys(labelKeys);
+    const int64_t numberOfKeys = static_cast<int64_t>(labelKeys.size());
+    int64_t minimumKey = 0;
+    int64_t keyRange = 0;
+    bool denseKeysFlag = false;
+    if (numberOfKeys > 0) {
+        minimumKey = labelKeys.front();
+        keyRange = static_cast<int64_t>(labelKeys.back()) - minimumKey + 1;
+        denseKeysFlag = (keyRange <= std::max(static_cast<int64_t>(65536),
+                                              numberOfKeys * 16));
+    }
+    const int64_t numberOfEntries = (denseKeysFlag ? keyRange : numberOfKeys) + 1;
+    std::vector<float> entryRGBAFloat;
+    std::vector<uint8_t> entryRGBAUnsignedByte;
     switch (colorDataType) {
         case COLOR_TYPE_FLOAT:
-            for (int64_t i = 0; i < numberOfIndices; i++) {
-                rgbaFloat[i*4+3] = 0.0;
-            }
+            entryRGBAFloat.resize(numberOfEntries * 4, 0.0);
             break;
         case COLOR_TYPE_UNSIGNED_BTYE:
-            for (int64_t i = 0; i < numberOfIndices; i++) {
-                rgbaUnsignedByte[i*4+3] = 0;
-            }
+            entryRGBAUnsignedByte.resize(numberOfEntries * 4, 0);
             break;
     }
     
-    /*
-     * Assign colors from labels to nodes
-     */
     float labelRGBA[4];
-	for (int64_t i = 0; i < numberOfIndices; i++) {
-        const int64_t labelKey = static_cast<int64_t>(labelIndices[i]);
-        const GiftiLabel* gl = labelTable->getLabel(labelKey);
-        if (gl != NULL) {
-            const GroupAndNameHierarchyItem* item = gl->getGroupNameSelectionItem();
-            bool colorDataFlag = false;
-            if (item != NULL) {
-                if (tabIndex == NodeAndVoxelColoring::INVALID_TAB_INDEX) {
-                    colorDataFlag = true;
-                }
-                else if (item->isSelected(displayGroup, tabIndex)) {
-                    colorDataFlag = true;
-                }
+    for (int64_t k = 0; k < numberOfKeys; k++) {
+        const GiftiLabel* gl = labelTable->getLabel(labelKeys[k]);
+        CaretAssert(gl != NULL);
+        const GroupAndNameHierarchyItem* item = gl->getGroupNameSelectionItem();
+        bool colorDataFlag = false;
+        if (item != NULL) {
+            if (tabIndex == NodeAndVoxelColoring::INVALID_TAB_INDEX) {
+                colorDataFlag = true;
             }
-            else {
+            else if (item->isSelected(displayGroup, tabIndex)) {
                 colorDataFlag = true;
             }
-            
-            if (colorDataFlag) {
-                gl->getColor(labelRGBA);
-                if (labelRGBA[3] > 0.0) {
-                    const int64_t i4 = i * 4;
-                    
-                    switch (colorDataType) {
-                        case COLOR_TYPE_FLOAT:
-                            CaretAssertArrayIndex(rgbaFloat, numberOfIndices * 4, i*4+3);
-                            rgbaFloat[i*4] = labelRGBA[0];
-                            rgbaFloat[i*4+1] = labelRGBA[1];
-                            rgbaFloat[i*4+2] = labelRGBA[2];
-                            rgbaFloat[i*4+3] = labelRGBA[3];
-                            break;
-                        case COLOR_TYPE_UNSIGNED_BTYE:
-                            CaretAssertArrayIndex(rgbaUnsignedByte, numberOfIndices * 4, i*4+3);
-                            rgbaUnsignedByte[i4]   = labelRGBA[0] * 255.0;
-                            rgbaUnsignedByte[i4+1] = labelRGBA[1] * 255.0;
-                            rgbaUnsignedByte[i4+2] = labelRGBA[2] * 255.0;
-                            if (labelRGBA[3] > 0.0) {
-                                rgbaUnsignedByte[i4+3] = labelRGBA[3] * 255.0;
-                            }
-                            else {
-                                rgbaUnsignedByte[i4+3] = 0;
-                            }
-                            break;
-                    }
+        }
+        else {
+            colorDataFlag = true;
+        }
+        
+        if (colorDataFlag) {
+            gl->getColor(labelRGBA);
+            if (labelRGBA[3] > 0.0) {
+                const int64_t e4 = (denseKeysFlag ? (labelKeys[k] - minimumKey) : k) * 4;
+                switch (colorDataType) {
+                    case COLOR_TYPE_FLOAT:
+                        entryRGBAFloat[e4]   = labelRGBA[0];
+                        entryRGBAFloat[e4+1] = labelRGBA[1];
+                        entryRGBAFloat[e4+2] = labelRGBA[2];
+                        entryRGBAFloat[e4+3] = labelRGBA[3];
+                        break;
+                    case COLOR_TYPE_UNSIGNED_BTYE:
+                        entryRGBAUnsignedByte[e4]   = labelRGBA[0] * 255.0;
+                        entryRGBAUnsignedByte[e4+1] = labelRGBA[1] * 255.0;
+                        entryRGBAUnsignedByte[e4+2] = labelRGBA[2] * 255.0;
+                        entryRGBAUnsignedByte[e4+3] = labelRGBA[3] * 255.0;
+                        break;
                 }
             }
         }
     }
+    
+    /*
+     * Assign colors from labels to nodes
+     */
+    switch (colorDataType) {
+        case COLOR_TYPE_FLOAT:
+            colorIndicesWithLabelEntries(labelIndices,
+                                         numberOfIndices,
+                                         labelKeys,
+                                         denseKeysFlag,
+                                         minimumKey,
+                                         &entryRGBAFloat[0],
+                                         rgbaFloat);
+            break;
+        case COLOR_TYPE_UNSIGNED_BTYE:
+            colorIndicesWithLabelEntries(labelIndices,
+                                         numberOfIndices,
+                                         labelKeys,
+                                         denseKeysFlag,
+                                         minimumKey,
+                                         &entryRGBAUnsignedByte[0],
+                                         rgbaUnsignedByte);
+            break;
+    }
 }
 
 /**
@@ -860,18 +955,16 @@ NodeAndVoxelColoring::convertSliceColoringToOutlineMode(uint8_t* rgbaInOut,
                                                         const int64_t ydim)
 {
     /*
-     * Copy the rgba colors
+     * Copy the rgba colors with each voxel's RGBA packed into
+     * one integer so that colors are compared in one operation
      */
-    const int64_t numRGBA = xdim * ydim * 4;
-    if (numRGBA <= 0) {
+    const int64_t numVoxels = xdim * ydim;
+    if (numVoxels <= 0) {
         return;
     }
-    std::vector<uint8_t> sliceCopyVector(numRGBA);
-    uint8_t* rgba = &sliceCopyVector[0];
-    
-    for (int64_t i = 0; i < numRGBA; i++) {
-        rgba[i] = rgbaInOut[i];
-    }
+    std::vector<uint32_t> slicePackedVector(numVoxels);
+    const uint32_t* packedRGBA = &slicePackedVector[0];
+    memcpy(&slicePackedVector[0], rgbaInOut, numVoxels * 4);
     
     uint8_t outlineRGBA[4];
     CaretColorEnum::toRGBByte(labelOutlineColor,
@@ -879,22 +972,22 @@ NodeAndVoxelColoring::convertSliceColoringToOutlineMode(uint8_t* rgbaInOut,
     outlineRGBA[3] = 255;
     
     /*
-     * Examine coloring for all voxels except those along the edge
+     * Examine coloring for all voxels except those along the edge.
+     * Each voxel only modifies its own coloring so rows are
+     * done in parallel.
      */
     const int64_t lastX = xdim - 1;
     const int64_t lastY = ydim - 1;
-    for (int64_t i = 1; i < lastX; i++) {
-        for (int64_t j = 1; j < lastY; j++) {
-            const int iStart = i - 1;
-            const int iEnd   = i + 1;
-            const int jStart = j - 1;
-            const int jEnd   = j + 1;
-            
+#pragma omp CARET_PARFOR schedule(static)
+    for (int64_t j = 1; j < lastY; j++) {
+        const uint32_t* rowBelow = packedRGBA + (xdim * (j - 1));
+        const uint32_t* rowMiddle = packedRGBA + (xdim * j);
+        const uint32_t* rowAbove = packedRGBA + (xdim * (j + 1));
+        for (int64_t i = 1; i < lastX; i++) {
             const int64_t myOffset = (i + (xdim * j)) * 4;
-            CaretAssert(myOffset < numRGBA);
+            CaretAssert(myOffset < (numVoxels * 4));
             
-            const uint8_t* myRGBA = &rgba[myOffset];
-            if (myRGBA[3] <= 0) {
+            if (rgbaInOut[myOffset + 3] <= 0) {
                 continue;
             }
             
@@ -902,28 +995,16 @@ NodeAndVoxelColoring::convertSliceColoringToOutlineMode(uint8_t* rgbaInOut,
              * Determine if voxel colors match voxel coloring
              * of ALL immediate neighbors (8-connected).
              */
-            bool isLabelBoundaryVoxel = false;
-            for (int64_t iNeigh = iStart; iNeigh <= iEnd; iNeigh++) {
-                for (int64_t jNeigh = jStart; jNeigh <= jEnd; jNeigh++) {
-                    const int64_t neighOffset = (iNeigh + (xdim * jNeigh)) * 4;
-                    CaretAssert(neighOffset < numRGBA);
-                    const uint8_t* neighRGBA = &rgba[neighOffset];
-                    
-                    for (int64_t k = 0; k < 4; k++) {
-                        if (myRGBA[k] != neighRGBA[k]) {
-                            isLabelBoundaryVoxel = true;
-                            break;
-                        }
-                    }
-                    
-                    if (isLabelBoundaryVoxel) {
-                        break;
-                    }
-                }
-                if (isLabelBoundaryVoxel) {
-                    break;
-                }
-            }
+            const uint32_t myRGBA = rowMiddle[i];
+            const uint32_t differenceBits = ((rowBelow[i - 1] ^ myRGBA)
+                                             | (rowBelow[i] ^ myRGBA)
+                                             | (rowBelow[i + 1] ^ myRGBA)
+                                             | (rowMiddle[i - 1] ^ myRGBA)
+                                             | (rowMiddle[i + 1] ^ myRGBA)
+                                             | (rowAbove[i - 1] ^ myRGBA)
+                                             | (rowAbove[i] ^ myRGBA)
+                                             | (rowAbove[i + 1] ^ myRGBA));
+            const bool isLabelBoundaryVoxel = (differenceBits != 0);
             
             /*
              * Override the coloring as needed.
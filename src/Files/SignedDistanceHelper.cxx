@@ -45,129 +45,108 @@ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FO
 DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
 
-#include "BoundingBox.h"
-#include "CaretHeap.h"
+#include "CaretAssert.h"
+#include "MathFunctions.h"
 #include "SignedDistanceHelper.h"
 #include "SurfaceFile.h"
 #include "TopologyHelper.h"
+#include <algorithm>
 #include <cmath>
 
 using namespace std;
 using namespace caret;
 
-float SignedDistanceHelper::dist(const float coord[3], WindingLogic myWinding)
+namespace
 {
-    CaretMutexLocker locked(&m_mutex);
-    CaretSimpleMinHeap<Oct<SignedDistanceHelperBase::TriVector>*, float> myHeap;
-    myHeap.push(m_base->m_indexRoot, m_base->m_indexRoot->distToPoint(coord));
-    ClosestPointInfo tempInfo, bestInfo;
-    float tempf = -1.0f, bestTriDist = -1.0f;
-    bool first = true;
-    int numChanged = 0;
-    while (!myHeap.isEmpty())
+    struct BVHStackEntry
+    {
+        int32_t m_node;
+        float m_distSquared;
+        BVHStackEntry(const int32_t node, const float distSquared) : m_node(node), m_distSquared(distSquared) { }
+    };
+    
+    float distSquaredToSegment(const float p[3], const float a[3], const float b[3])
     {
-        Oct<SignedDistanceHelperBase::TriVector>* curOct = myHeap.pop(&tempf);
-        if (first || tempf < bestTriDist)
+        float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+        float ap[3] = { p[0] - a[0], p[1] - a[1], p[2] - a[2] };
+        float lengthSquared = ab[0] * ab[0] + ab[1] * ab[1] + ab[2] * ab[2];
+        float t = 0.0f;
+        if (lengthSquared > 0.0f)
         {
-            if (curOct->m_leaf)
-            {
-                vector<int32_t>& myVecRef = *(curOct->m_data.m_triList);
-                int numTris = (int)myVecRef.size();
-                for (int i = 0; i < numTris; ++i)
-                {
-                    if (m_triMarked[myVecRef[i]] != 1)
-                    {
-                        m_triMarked[myVecRef[i]] = 1;
-                        m_triMarkChanged[numChanged++] = myVecRef[i];
-                        tempf = unsignedDistToTri(coord, myVecRef[i], tempInfo);
-                        if (first || tempf < bestTriDist)
-                        {
-                            bestInfo = tempInfo;
-                            bestTriDist = tempf;
-                            first = false;
-                        }
-                    }
-                }
-            } else {
-                for (int ci = 0; ci < 2; ++ci)
-                {
-                    for (int cj = 0; cj < 2; ++cj)
-                    {
-                        for (int ck = 0; ck < 2; ++ck)
-                        {
-                            tempf = curOct->m_children[ci][cj][ck]->distToPoint(coord);
-                            if (first || tempf < bestTriDist)
-                            {
-                                myHeap.push(curOct->m_children[ci][cj][ck], tempf);
-                            }
-                        }
-                    }
-                }
-            }
+            t = (ab[0] * ap[0] + ab[1] * ap[1] + ab[2] * ap[2]) / lengthSquared;
+            if (t < 0.0f) t = 0.0f;
+            if (t > 1.0f) t = 1.0f;
         }
+        float diff[3] = { ap[0] - t * ab[0], ap[1] - t * ab[1], ap[2] - t * ab[2] };
+        return diff[0] * diff[0] + diff[1] * diff[1] + diff[2] * diff[2];
     }
-    while (numChanged)
+    
+    ///squared distance only, finds the voronoi region of the triangle the point is in (Ericson, Real-Time Collision Detection, 5.1.5)
+    ///straight-line float code on contiguous vertex data, used only to choose the closest triangle, unsignedDistToTri still computes the closest point and its type
+    float distSquaredToTriangle(const float p[3], const float tri[9])
     {
-        m_triMarked[m_triMarkChanged[--numChanged]] = 0;//need to do this before computeSign
+        const float* a = tri;
+        const float* b = tri + 3;
+        const float* c = tri + 6;
+        float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+        float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+        float normal[3] = { ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0] };
+        if (normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2] == 0.0f)
+        {//degenerate, so it is just its edges
+            return min(min(distSquaredToSegment(p, a, b), distSquaredToSegment(p, b, c)), distSquaredToSegment(p, c, a));
+        }
+        float ap[3] = { p[0] - a[0], p[1] - a[1], p[2] - a[2] };
+        float bp[3] = { p[0] - b[0], p[1] - b[1], p[2] - b[2] };
+        float cp[3] = { p[0] - c[0], p[1] - c[1], p[2] - c[2] };
+        float d1 = ab[0] * ap[0] + ab[1] * ap[1] + ab[2] * ap[2];
+        float d2 = ac[0] * ap[0] + ac[1] * ap[1] + ac[2] * ap[2];
+        float d3 = ab[0] * bp[0] + ab[1] * bp[1] + ab[2] * bp[2];
+        float d4 = ac[0] * bp[0] + ac[1] * bp[1] + ac[2] * bp[2];
+        float d5 = ab[0] * cp[0] + ab[1] * cp[1] + ab[2] * cp[2];
+        float d6 = ac[0] * cp[0] + ac[1] * cp[1] + ac[2] * cp[2];
+        float closest[3];
+        float vc = d1 * d4 - d3 * d2, vb = d5 * d2 - d1 * d6, va = d3 * d6 - d5 * d4;
+        if (d1 <= 0.0f && d2 <= 0.0f)
+        {//vertex regions
+            return ap[0] * ap[0] + ap[1] * ap[1] + ap[2] * ap[2];
+        } else if (d3 >= 0.0f && d4 <= d3) {
+            return bp[0] * bp[0] + bp[1] * bp[1] + bp[2] * bp[2];
+        } else if (d6 >= 0.0f && d5 <= d6) {
+            return cp[0] * cp[0] + cp[1] * cp[1] + cp[2] * cp[2];
+        } else if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {//edge regions
+            float v = d1 / (d1 - d3);
+            for (int i = 0; i < 3; ++i) closest[i] = a[i] + v * ab[i];
+        } else if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+            float w = d2 / (d2 - d6);
+            for (int i = 0; i < 3; ++i) closest[i] = a[i] + w * ac[i];
+        } else if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f) {
+            float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+            for (int i = 0; i < 3; ++i) closest[i] = b[i] + w * (c[i] - b[i]);
+        } else {//face
+            float denom = 1.0f / (va + vb + vc);
+            float v = vb * denom, w = vc * denom;
+            for (int i = 0; i < 3; ++i) closest[i] = a[i] + v * ab[i] + w * ac[i];
+        }
+        float diff[3] = { p[0] - closest[0], p[1] - closest[1], p[2] - closest[2] };
+        return diff[0] * diff[0] + diff[1] * diff[1] + diff[2] * diff[2];
     }
+}
+
+float SignedDistanceHelper::dist(const float coord[3], WindingLogic myWinding)
+{
+    int32_t bestTri = m_base->closestTriangle(coord);
+    CaretAssert(bestTri != -1);
+    ClosestPointInfo bestInfo;
+    float bestTriDist = unsignedDistToTri(coord, bestTri, bestInfo);
     return bestTriDist * computeSign(coord, bestInfo, myWinding);
 }
 
 void SignedDistanceHelper::barycentricWeights(const float coord[3], BarycentricInfo& baryInfoOut)
 {
-    CaretMutexLocker locked(&m_mutex);
-    CaretSimpleMinHeap<Oct<SignedDistanceHelperBase::TriVector>*, float> myHeap;
-    myHeap.push(m_base->m_indexRoot, m_base->m_indexRoot->distToPoint(coord));
-    ClosestPointInfo tempInfo, bestInfo;
-    float tempf = -1.0f, bestTriDist = -1.0f;
-    bool first = true;
-    int numChanged = 0;
-    while (!myHeap.isEmpty())
-    {
-        Oct<SignedDistanceHelperBase::TriVector>* curOct = myHeap.pop(&tempf);
-        if (first || tempf < bestTriDist)
-        {
-            if (curOct->m_leaf)
-            {
-                vector<int32_t>& myVecRef = *(curOct->m_data.m_triList);
-                int numTris = (int)myVecRef.size();
-                for (int i = 0; i < numTris; ++i)
-                {
-                    if (m_triMarked[myVecRef[i]] != 1)
-                    {
-                        m_triMarked[myVecRef[i]] = 1;
-                        m_triMarkChanged[numChanged++] = myVecRef[i];
-                        tempf = unsignedDistToTri(coord, myVecRef[i], tempInfo);
-                        if (first || tempf < bestTriDist)
-                        {
-                            bestInfo = tempInfo;
-                            bestTriDist = tempf;
-                            first = false;
-                        }
-                    }
-                }
-            } else {
-                for (int ci = 0; ci < 2; ++ci)
-                {
-                    for (int cj = 0; cj < 2; ++cj)
-                    {
-                        for (int ck = 0; ck < 2; ++ck)
-                        {
-                            tempf = curOct->m_children[ci][cj][ck]->distToPoint(coord);
-                            if (first || tempf < bestTriDist)
-                            {
-                                myHeap.push(curOct->m_children[ci][cj][ck], tempf);
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
-    while (numChanged)
-    {
-        m_triMarked[m_triMarkChanged[--numChanged]] = 0;//clean up
-    }
+    int32_t bestTri = m_base->closestTriangle(coord);
+    CaretAssert(bestTri != -1);
+    ClosestPointInfo bestInfo;
+    float bestTriDist = unsignedDistToTri(coord, bestTri, bestInfo);
     baryInfoOut.triangle = bestInfo.triangle;
     baryInfoOut.point = bestInfo.tempPoint;
     baryInfoOut.absDistance = bestTriDist;
@@ -252,68 +231,47 @@ int SignedDistanceHelper::computeSign(const float coord[3], SignedDistanceHelper
         case NEGATIVE:
         case NONZERO:
             {
-                int numChanged = 0;
-                float positiveZ[3] = {0, 0, 1};
-                Vector3D point2 = point + positiveZ;
                 int crossCount = 0;
-                vector<Oct<SignedDistanceHelperBase::TriVector>*> myStack;
-                myStack.push_back(m_base->m_indexRoot);
+                const vector<SignedDistanceHelperBase::BVHNode>& myNodes = m_base->m_bvhNodes;
+                vector<int32_t> myStack;
+                if (!myNodes.empty()) myStack.push_back(0);
                 while (!myStack.empty())
                 {
-                    Oct<SignedDistanceHelperBase::TriVector>* curOct = myStack[myStack.size() - 1];
+                    int32_t curNode = myStack.back();
                     myStack.pop_back();
-                    if (curOct->m_leaf)
+                    const SignedDistanceHelperBase::BVHNode& myNode = myNodes[curNode];
+                    if (!myNode.upwardRayIntersects(coord)) continue;
+                    if (myNode.m_count == 0)
                     {
-                        vector<int32_t>& myVecRef = *(curOct->m_data.m_triList);
-                        int numTris = (int)myVecRef.size();
-                        for (int i = 0; i < numTris; ++i)
-                        {
-                            if (m_triMarked[myVecRef[i]] != 1)
-                            {
-                                m_triMarked[myVecRef[i]] = 1;
-                                m_triMarkChanged[numChanged++] = myVecRef[i];
-                                const int32_t* myTileNodes = m_base->getTriangle(myVecRef[i]);
-                                Vector3D verts[3];
-                                verts[0] = m_base->getCoordinate(myTileNodes[0]);
-                                verts[1] = m_base->getCoordinate(myTileNodes[1]);
-                                verts[2] = m_base->getCoordinate(myTileNodes[2]);
-                                Vector3D triNormal;
-                                MathFunctions::normalVector(verts[0], verts[1], verts[2], triNormal);
-                                float factor = triNormal[2];//equivalent to dot product with positiveZ
-                                if (factor != 0.0f)
-                                {
-                                    if (triNormal.dot(verts[0] - point) / factor > 0.0f && pointInTri(verts, point, 0, 1))
-                                    {
-                                        if (triNormal[2] < 0.0f)
-                                        {
-                                            ++crossCount;
-                                        } else {
-                                            --crossCount;
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                    } else {
-                        for (int ci = 0; ci < 2; ++ci)
+                        myStack.push_back(curNode + 1);
+                        myStack.push_back(myNode.m_start);
+                        continue;
+                    }
+                    int32_t end = myNode.m_start + myNode.m_count;
+                    for (int32_t slot = myNode.m_start; slot < end; ++slot)
+                    {//each triangle is in exactly one leaf, so no need to mark which triangles were already tested
+                        const int32_t* myTileNodes = m_base->getTriangle(m_base->m_bvhTriangles[slot]);
+                        Vector3D verts[3];
+                        verts[0] = m_base->getCoordinate(myTileNodes[0]);
+                        verts[1] = m_base->getCoordinate(myTileNodes[1]);
+                        verts[2] = m_base->getCoordinate(myTileNodes[2]);
+                        Vector3D triNormal;
+                        MathFunctions::normalVector(verts[0], verts[1], verts[2], triNormal);
+                        float factor = triNormal[2];//equivalent to dot product with positiveZ
+                        if (factor != 0.0f)
                         {
-                            for (int cj = 0; cj < 2; ++cj)
+                            if (triNormal.dot(verts[0] - point) / factor > 0.0f && pointInTri(verts, point, 0, 1))
                             {
-                                for (int ck = 0; ck < 2; ++ck)
+                                if (triNormal[2] < 0.0f)
                                 {
-                                    if (curOct->m_children[ci][cj][ck]->rayIntersects(coord, point2))
-                                    {
-                                        myStack.push_back(curOct->m_children[ci][cj][ck]);
-                                    }
+                                    ++crossCount;
+                                } else {
+                                    --crossCount;
                                 }
                             }
                         }
                     }
                 }
-                while (numChanged)
-                {
-                    m_triMarked[m_triMarkChanged[--numChanged]] = 0;
-                }
                 switch (myWinding)
                 {
                     case EVEN_ODD:
@@ -339,7 +297,6 @@ int SignedDistanceHelper::computeSign(const float coord[3], SignedDistanceHelper
                 case 0://node
                     {
                         int curSign = 0;
-                        int numChanged = 0;
                         const vector<int>& myTiles = m_base->m_topoHelp->getNodeTiles(myInfo.node1);
                         bool first = true;
                         float bestNorm = 0;
@@ -382,71 +339,53 @@ int SignedDistanceHelper::computeSign(const float coord[3], SignedDistanceHelper
                         {
                             midAxis = 2;
                         }
-                        vector<Oct<SignedDistanceHelperBase::TriVector>*> myStack;
-                        myStack.push_back(m_base->m_indexRoot);
+                        const vector<SignedDistanceHelperBase::BVHNode>& myNodes = m_base->m_bvhNodes;
+                        vector<int32_t> myStack;
+                        if (!myNodes.empty()) myStack.push_back(0);
                         while (!myStack.empty())
                         {
-                            Oct<SignedDistanceHelperBase::TriVector>* curOct = myStack[myStack.size() - 1];
+                            int32_t curNode = myStack.back();
                             myStack.pop_back();
-                            if (curOct->m_leaf)
+                            const SignedDistanceHelperBase::BVHNode& myNode = myNodes[curNode];
+                            if (!myNode.lineSegmentIntersects(coord, bestCent)) continue;
+                            if (myNode.m_count == 0)
                             {
-                                vector<int32_t>& myVecRef = *(curOct->m_data.m_triList);
-                                int numTris = (int)myVecRef.size();
-                                for (int i = 0; i < numTris; ++i)
+                                myStack.push_back(curNode + 1);
+                                myStack.push_back(myNode.m_start);
+                                continue;
+                            }
+                            int32_t end = myNode.m_start + myNode.m_count;
+                            for (int32_t slot = myNode.m_start; slot < end; ++slot)
+                            {
+                                const int32_t* myTileNodes = m_base->getTriangle(m_base->m_bvhTriangles[slot]);
+                                Vector3D verts[3];
+                                verts[0] = m_base->getCoordinate(myTileNodes[0]);
+                                verts[1] = m_base->getCoordinate(myTileNodes[1]);
+                                verts[2] = m_base->getCoordinate(myTileNodes[2]);
+                                Vector3D triNormal;
+                                MathFunctions::normalVector(verts[0], verts[1], verts[2], triNormal);
+                                float factor = triNormal.dot(segNormal);
+                                if (factor == 0.0f)
                                 {
-                                    if (m_triMarked[myVecRef[i]] != 1)
-                                    {
-                                        m_triMarked[myVecRef[i]] = 1;
-                                        m_triMarkChanged[numChanged++] = myVecRef[i];
-                                        const int32_t* myTileNodes = m_base->getTriangle(myVecRef[i]);
-                                        Vector3D verts[3];
-                                        verts[0] = m_base->getCoordinate(myTileNodes[0]);
-                                        verts[1] = m_base->getCoordinate(myTileNodes[1]);
-                                        verts[2] = m_base->getCoordinate(myTileNodes[2]);
-                                        Vector3D triNormal;
-                                        MathFunctions::normalVector(verts[0], verts[1], verts[2], triNormal);
-                                        float factor = triNormal.dot(segNormal);
-                                        if (factor == 0.0f)
-                                        {
-                                            continue;//skip triangles parallel to the line segment
-                                        }
-                                        float intersectDist = triNormal.dot(point - verts[0]) / factor;
-                                        if (intersectDist > 0.0f && intersectDist < bestDist)
-                                        {
-                                            Vector3D inPlane = point - intersectDist * segNormal;
-                                            if (pointInTri(verts, inPlane, majAxis, midAxis))
-                                            {
-                                                bestDist = intersectDist;
-                                                if (triNormal.dot(mySeg) > 0.0f)
-                                                {
-                                                    curSign = 1;
-                                                } else {
-                                                    curSign = -1;
-                                                }
-                                            }
-                                        }
-                                    }
+                                    continue;//skip triangles parallel to the line segment
                                 }
-                            } else {
-                                for (int ci = 0; ci < 2; ++ci)
+                                float intersectDist = triNormal.dot(point - verts[0]) / factor;
+                                if (intersectDist > 0.0f && intersectDist < bestDist)
                                 {
-                                    for (int cj = 0; cj < 2; ++cj)
+                                    Vector3D inPlane = point - intersectDist * segNormal;
+                                    if (pointInTri(verts, inPlane, majAxis, midAxis))
                                     {
-                                        for (int ck = 0; ck < 2; ++ck)
+                                        bestDist = intersectDist;
+                                        if (triNormal.dot(mySeg) > 0.0f)
                                         {
-                                            if (curOct->m_children[ci][cj][ck]->lineSegmentIntersects(coord, bestCent))
-                                            {
-                                                myStack.push_back(curOct->m_children[ci][cj][ck]);
-                                            }
+                                            curSign = 1;
+                                        } else {
+                                            curSign = -1;
                                         }
                                     }
                                 }
                             }
                         }
-                        while (numChanged)
-                        {
-                            m_triMarked[m_triMarkChanged[--numChanged]] = 0;
-                        }
                         return curSign;
                     }
                     break;
@@ -713,24 +652,11 @@ float SignedDistanceHelper::unsignedDistToTri(const float coord[3], int32_t tria
 SignedDistanceHelper::SignedDistanceHelper(CaretPointer<SignedDistanceHelperBase> myBase)
 {
     m_base = myBase;
-    int32_t numTris = m_base->m_numTris;
-    m_triMarked = CaretArray<int>(numTris);
-    m_triMarkChanged = CaretArray<int>(numTris);
-    for (int32_t i = 0; i < numTris; ++i)
-    {
-        m_triMarked[i] = 0;
-    }
 }
 
 SignedDistanceHelperBase::SignedDistanceHelperBase(const SurfaceFile* mySurf)
 {
     m_topoHelp = mySurf->getTopologyHelper();
-    const float* myBB = mySurf->getBoundingBox()->getBounds();
-    Vector3D minCoord, maxCoord;
-    minCoord[0] = myBB[0]; maxCoord[0] = myBB[1];
-    minCoord[1] = myBB[2]; maxCoord[1] = myBB[3];
-    minCoord[2] = myBB[4]; maxCoord[2] = myBB[5];
-    m_indexRoot.grabNew(new Oct<TriVector>(minCoord, maxCoord));
     const float* myCoordData = mySurf->getCoordinateData();
     m_numNodes = mySurf->getNumberOfNodes();
     int32_t numNodes3 = m_numNodes * 3;
@@ -741,6 +667,8 @@ SignedDistanceHelperBase::SignedDistanceHelperBase(const SurfaceFile* mySurf)
     }
     m_numTris = mySurf->getNumberOfTriangles();
     m_triangleList.resize(m_numTris * 3);
+    vector<float> triBounds(m_numTris * 6), triCentroids(m_numTris * 3);//min xyz, max xyz, and center of the bounding box
+    m_bvhTriangles.resize(m_numTris);
     for (int32_t i = 0; i < m_numTris; ++i)
     {
         int32_t i3 = i * 3;
@@ -748,106 +676,258 @@ SignedDistanceHelperBase::SignedDistanceHelperBase(const SurfaceFile* mySurf)
         m_triangleList[i3] = thisTri[0];
         m_triangleList[i3 + 1] = thisTri[1];
         m_triangleList[i3 + 2] = thisTri[2];
-        maxCoord = minCoord = myCoordData + thisTri[0] * 3;//set both to the coordinates of the first node in the triangle
-        for (int j = 1; j < 3; ++j)
+        float* minCoord = triBounds.data() + i * 6;
+        float* maxCoord = minCoord + 3;
+        for (int axis = 0; axis < 3; ++axis)
         {
-            int32_t thisNode3 = thisTri[j] * 3;
-            if (myCoordData[thisNode3] < minCoord[0]) minCoord[0] = myCoordData[thisNode3];
-            if (myCoordData[thisNode3 + 1] < minCoord[1]) minCoord[1] = myCoordData[thisNode3 + 1];
-            if (myCoordData[thisNode3 + 2] < minCoord[2]) minCoord[2] = myCoordData[thisNode3 + 2];
-            if (myCoordData[thisNode3] > maxCoord[0]) maxCoord[0] = myCoordData[thisNode3];
-            if (myCoordData[thisNode3 + 1] > maxCoord[1]) maxCoord[1] = myCoordData[thisNode3 + 1];
-            if (myCoordData[thisNode3 + 2] > maxCoord[2]) maxCoord[2] = myCoordData[thisNode3 + 2];
+            minCoord[axis] = maxCoord[axis] = myCoordData[thisTri[0] * 3 + axis];
+            for (int j = 1; j < 3; ++j)
+            {
+                float value = myCoordData[thisTri[j] * 3 + axis];
+                if (value < minCoord[axis]) minCoord[axis] = value;
+                if (value > maxCoord[axis]) maxCoord[axis] = value;
+            }
+            triCentroids[i3 + axis] = (minCoord[axis] + maxCoord[axis]) * 0.5f;
+        }
+        m_bvhTriangles[i] = i;
+    }
+    if (m_numTris > 0)
+    {
+        m_bvhNodes.reserve(2 * (m_numTris / 2 + 1));//rough estimate, leaves usually have a few triangles
+        buildBVH(0, m_numTris, triBounds, triCentroids);
+    }
+    m_bvhTriCoords.resize(m_numTris * 9);
+    for (int32_t slot = 0; slot < m_numTris; ++slot)
+    {
+        const int32_t* thisTri = getTriangle(m_bvhTriangles[slot]);
+        for (int j = 0; j < 3; ++j)
+        {
+            const float* thisCoord = getCoordinate(thisTri[j]);
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                m_bvhTriCoords[slot * 9 + j * 3 + axis] = thisCoord[axis];
+            }
         }
-        addTriangle(m_indexRoot, i, minCoord, maxCoord);//use bounding box for now as an easy test to capture any chance of the triangle intersecting the Oct
     }
 }
 
-void SignedDistanceHelperBase::addTriangle(Oct<TriVector>* thisOct, int32_t triangle, float minCoord[3], float maxCoord[3])
-{
-    if (thisOct->m_leaf)
+int32_t SignedDistanceHelperBase::buildBVH(const int32_t start, const int32_t end, const vector<float>& triBounds, const vector<float>& triCentroids)
+{//binned surface area heuristic, recursion depth is logarithmic unless the surface is very strange
+    CaretAssert(end > start);
+    int32_t ret = (int32_t)m_bvhNodes.size();
+    m_bvhNodes.push_back(BVHNode());//reserve our index, children get added after it
+    BVHNode thisNode;//and fill it in at the end, since the recursion may reallocate the vector
+    float centMin[3], centMax[3];
+    for (int axis = 0; axis < 3; ++axis)
     {
-        thisOct->m_data.m_triList->push_back(triangle);
-        int numTris = (int)thisOct->m_data.m_triList->size();
-        if (numTris >= NUM_TRIS_TO_TEST && numTris % NUM_TRIS_TEST_INCR == NUM_TRIS_TO_TEST % NUM_TRIS_TEST_INCR)//the second modulus should const out
+        thisNode.m_min[axis] = triBounds[m_bvhTriangles[start] * 6 + axis];
+        thisNode.m_max[axis] = triBounds[m_bvhTriangles[start] * 6 + 3 + axis];
+        centMin[axis] = centMax[axis] = triCentroids[m_bvhTriangles[start] * 3 + axis];
+    }
+    for (int32_t slot = start + 1; slot < end; ++slot)
+    {
+        const float* thisBounds = triBounds.data() + m_bvhTriangles[slot] * 6;
+        const float* thisCent = triCentroids.data() + m_bvhTriangles[slot] * 3;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            thisNode.m_min[axis] = min(thisNode.m_min[axis], thisBounds[axis]);
+            thisNode.m_max[axis] = max(thisNode.m_max[axis], thisBounds[axis + 3]);
+            centMin[axis] = min(centMin[axis], thisCent[axis]);
+            centMax[axis] = max(centMax[axis], thisCent[axis]);
+        }
+    }
+    int32_t count = end - start;
+    int bestAxis = -1, bestBin = -1;
+    float bestCost = 0.0f;
+    if (count > 1)
+    {
+        for (int axis = 0; axis < 3; ++axis)
         {
-            Vector3D tempMinCoord, tempMaxCoord;
-            const float* myCoordData = m_coordList.data();
-            int totalSize = 0;
-            int numSplit = 0;
-            for (int i = 0; i < numTris; ++i)//gather data on how it would end up splitting
+            float extent = centMax[axis] - centMin[axis];
+            if (!(extent > 0.0f)) continue;
+            int32_t binCount[BVH_NUM_BINS];
+            float binMin[BVH_NUM_BINS][3], binMax[BVH_NUM_BINS][3];
+            for (int bin = 0; bin < BVH_NUM_BINS; ++bin)
             {
-                const int32_t* tempTri = getTriangle((*(thisOct->m_data.m_triList))[i]);
-                tempMaxCoord = tempMinCoord = myCoordData + tempTri[0] * 3;//set both to the coordinates of the first node in the triangle
-                for (int j = 1; j < 3; ++j)
+                binCount[bin] = 0;
+            }
+            for (int32_t slot = start; slot < end; ++slot)
+            {
+                const float* thisBounds = triBounds.data() + m_bvhTriangles[slot] * 6;
+                int bin = (int)(BVH_NUM_BINS * (triCentroids[m_bvhTriangles[slot] * 3 + axis] - centMin[axis]) / extent);
+                if (bin >= BVH_NUM_BINS) bin = BVH_NUM_BINS - 1;
+                for (int i = 0; i < 3; ++i)
                 {
-                    int32_t thisNode3 = tempTri[j] * 3;
-                    if (myCoordData[thisNode3] < tempMinCoord[0]) tempMinCoord[0] = myCoordData[thisNode3];
-                    if (myCoordData[thisNode3 + 1] < tempMinCoord[1]) tempMinCoord[1] = myCoordData[thisNode3 + 1];
-                    if (myCoordData[thisNode3 + 2] < tempMinCoord[2]) tempMinCoord[2] = myCoordData[thisNode3 + 2];
-                    if (myCoordData[thisNode3] > tempMaxCoord[0]) tempMaxCoord[0] = myCoordData[thisNode3];
-                    if (myCoordData[thisNode3 + 1] > tempMaxCoord[1]) tempMaxCoord[1] = myCoordData[thisNode3 + 1];
-                    if (myCoordData[thisNode3 + 2] > tempMaxCoord[2]) tempMaxCoord[2] = myCoordData[thisNode3 + 2];
+                    if (binCount[bin] == 0 || thisBounds[i] < binMin[bin][i]) binMin[bin][i] = thisBounds[i];
+                    if (binCount[bin] == 0 || thisBounds[i + 3] > binMax[bin][i]) binMax[bin][i] = thisBounds[i + 3];
                 }
-                int minOct[3], maxOct[3];
-                thisOct->containingChild(tempMinCoord, minOct);
-                thisOct->containingChild(tempMaxCoord, maxOct);
-                int splitSize = 8;
-                if (minOct[0] == maxOct[0]) splitSize >>= 1;
-                if (minOct[1] == maxOct[1]) splitSize >>= 1;
-                if (minOct[2] == maxOct[2]) splitSize >>= 1;
-                totalSize += splitSize;
-                if (splitSize != 8) ++numSplit;
+                ++binCount[bin];
             }
-            if (numSplit > 0 && totalSize < 3.0f * numTris)//don't split if all triangles end up in all child octs, and try to balance speedup with memory usage
+            float rightArea[BVH_NUM_BINS];//area and count of everything from this bin to the end
+            int32_t rightCount[BVH_NUM_BINS];
+            float accumMin[3], accumMax[3];
+            int32_t accumCount = 0;
+            for (int bin = BVH_NUM_BINS - 1; bin > 0; --bin)
             {
-                thisOct->makeChildren();//do the split
-                for (int i = 0; i < numTris; ++i)//gather data on how it would end up splitting
+                for (int i = 0; i < 3 && binCount[bin] != 0; ++i)
                 {
-                    const int32_t* tempTri = getTriangle((*(thisOct->m_data.m_triList))[i]);
-                    tempMaxCoord = tempMinCoord = myCoordData + tempTri[0] * 3;//set both to the coordinates of the first node in the triangle
-                    for (int j = 1; j < 3; ++j)
-                    {
-                        int32_t thisNode3 = tempTri[j] * 3;
-                        if (myCoordData[thisNode3] < tempMinCoord[0]) tempMinCoord[0] = myCoordData[thisNode3];
-                        if (myCoordData[thisNode3 + 1] < tempMinCoord[1]) tempMinCoord[1] = myCoordData[thisNode3 + 1];
-                        if (myCoordData[thisNode3 + 2] < tempMinCoord[2]) tempMinCoord[2] = myCoordData[thisNode3 + 2];
-                        if (myCoordData[thisNode3] > tempMaxCoord[0]) tempMaxCoord[0] = myCoordData[thisNode3];
-                        if (myCoordData[thisNode3 + 1] > tempMaxCoord[1]) tempMaxCoord[1] = myCoordData[thisNode3 + 1];
-                        if (myCoordData[thisNode3 + 2] > tempMaxCoord[2]) tempMaxCoord[2] = myCoordData[thisNode3 + 2];
-                    }
-                    for (int ci = 0; ci < 2; ++ci)
-                    {
-                        for (int cj = 0; cj < 2; ++cj)
-                        {
-                            for (int ck = 0; ck < 2; ++ck)
-                            {
-                                if (thisOct->m_children[ci][cj][ck]->boundsOverlaps(tempMinCoord, tempMaxCoord))
-                                {
-                                    addTriangle(thisOct->m_children[ci][cj][ck], (*(thisOct->m_data.m_triList))[i], tempMinCoord, tempMaxCoord);
-                                }
-                            }
-                        }
-                    }
+                    if (accumCount == 0 || binMin[bin][i] < accumMin[i]) accumMin[i] = binMin[bin][i];
+                    if (accumCount == 0 || binMax[bin][i] > accumMax[i]) accumMax[i] = binMax[bin][i];
+                }
+                accumCount += binCount[bin];
+                rightCount[bin] = accumCount;
+                rightArea[bin] = (accumCount == 0 ? 0.0f : (accumMax[0] - accumMin[0]) * (accumMax[1] - accumMin[1]) +
+                                                           (accumMax[1] - accumMin[1]) * (accumMax[2] - accumMin[2]) +
+                                                           (accumMax[2] - accumMin[2]) * (accumMax[0] - accumMin[0]));
+            }
+            accumCount = 0;
+            for (int bin = 0; bin < BVH_NUM_BINS - 1; ++bin)
+            {//split between bin and bin + 1
+                for (int i = 0; i < 3 && binCount[bin] != 0; ++i)
+                {
+                    if (accumCount == 0 || binMin[bin][i] < accumMin[i]) accumMin[i] = binMin[bin][i];
+                    if (accumCount == 0 || binMax[bin][i] > accumMax[i]) accumMax[i] = binMax[bin][i];
+                }
+                accumCount += binCount[bin];
+                if (accumCount == 0 || rightCount[bin + 1] == 0) continue;
+                float leftArea = (accumMax[0] - accumMin[0]) * (accumMax[1] - accumMin[1]) +
+                                 (accumMax[1] - accumMin[1]) * (accumMax[2] - accumMin[2]) +
+                                 (accumMax[2] - accumMin[2]) * (accumMax[0] - accumMin[0]);
+                float cost = leftArea * accumCount + rightArea[bin + 1] * rightCount[bin + 1];
+                if (bestAxis == -1 || cost < bestCost)
+                {
+                    bestAxis = axis;
+                    bestBin = bin;
+                    bestCost = cost;
                 }
-                thisOct->m_data.freeData();//and free up some memory
             }
         }
+    }
+    float myArea = (thisNode.m_max[0] - thisNode.m_min[0]) * (thisNode.m_max[1] - thisNode.m_min[1]) +
+                   (thisNode.m_max[1] - thisNode.m_min[1]) * (thisNode.m_max[2] - thisNode.m_min[2]) +
+                   (thisNode.m_max[2] - thisNode.m_min[2]) * (thisNode.m_max[0] - thisNode.m_min[0]);
+    int32_t mid = -1;
+    if (bestAxis != -1 && (count > BVH_MAX_LEAF || myArea + bestCost < myArea * count))//one box test is about as expensive as one triangle test
+    {
+        float extent = centMax[bestAxis] - centMin[bestAxis];
+        int32_t low = start, high = end - 1;
+        while (low <= high)
+        {
+            int bin = (int)(BVH_NUM_BINS * (triCentroids[m_bvhTriangles[low] * 3 + bestAxis] - centMin[bestAxis]) / extent);
+            if (bin >= BVH_NUM_BINS) bin = BVH_NUM_BINS - 1;
+            if (bin <= bestBin)
+            {
+                ++low;
+            } else {
+                swap(m_bvhTriangles[low], m_bvhTriangles[high]);
+                --high;
+            }
+        }
+        mid = low;
+    } else if (bestAxis == -1 && count > BVH_MAX_LEAF) {//all centroids are identical, any split is as good as another
+        mid = start + count / 2;
+    }
+    if (mid > start && mid < end)
+    {
+        thisNode.m_count = 0;
+        buildBVH(start, mid, triBounds, triCentroids);//always lands at ret + 1
+        thisNode.m_start = buildBVH(mid, end, triBounds, triCentroids);
     } else {
-        for (int ci = 0; ci < 2; ++ci)
+        thisNode.m_start = start;
+        thisNode.m_count = count;
+    }
+    m_bvhNodes[ret] = thisNode;
+    return ret;
+}
+
+int32_t SignedDistanceHelperBase::closestTriangle(const float coord[3]) const
+{
+    if (m_bvhNodes.empty()) return -1;
+    int32_t bestSlot = -1;
+    float bestDistSquared = 0.0f;
+    vector<BVHStackEntry> myStack;
+    myStack.push_back(BVHStackEntry(0, m_bvhNodes[0].distSquaredToPoint(coord)));
+    while (!myStack.empty())
+    {
+        BVHStackEntry curEntry = myStack.back();
+        myStack.pop_back();
+        if (bestSlot != -1 && curEntry.m_distSquared >= bestDistSquared) continue;
+        const BVHNode& curNode = m_bvhNodes[curEntry.m_node];
+        if (curNode.m_count > 0)
         {
-            for (int cj = 0; cj < 2; ++cj)
+            int32_t end = curNode.m_start + curNode.m_count;
+            for (int32_t slot = curNode.m_start; slot < end; ++slot)
             {
-                for (int ck = 0; ck < 2; ++ck)
+                float tempf = distSquaredToTriangle(coord, m_bvhTriCoords.data() + slot * 9);
+                if (bestSlot == -1 || tempf < bestDistSquared)
                 {
-                    if (thisOct->m_children[ci][cj][ck]->boundsOverlaps(minCoord, maxCoord))
-                    {
-                        addTriangle(thisOct->m_children[ci][cj][ck], triangle, minCoord, maxCoord);
-                    }
+                    bestSlot = slot;
+                    bestDistSquared = tempf;
                 }
             }
+        } else {//push the farther child first, so the nearer one gets searched first and tightens the bound
+            int32_t nearChild = curEntry.m_node + 1, farChild = curNode.m_start;
+            float nearDist = m_bvhNodes[nearChild].distSquaredToPoint(coord), farDist = m_bvhNodes[farChild].distSquaredToPoint(coord);
+            if (farDist < nearDist)
+            {
+                swap(nearChild, farChild);
+                swap(nearDist, farDist);
+            }
+            if (bestSlot == -1 || farDist < bestDistSquared) myStack.push_back(BVHStackEntry(farChild, farDist));
+            if (bestSlot == -1 || nearDist < bestDistSquared) myStack.push_back(BVHStackEntry(nearChild, nearDist));
+        }
+    }
+    if (bestSlot == -1) return -1;
+    return m_bvhTriangles[bestSlot];
+}
+
+float SignedDistanceHelperBase::BVHNode::distSquaredToPoint(const float point[3]) const
+{
+    float ret = 0.0f;
+    for (int i = 0; i < 3; ++i)
+    {
+        float temp = 0.0f;
+        if (point[i] < m_min[i])
+        {
+            temp = m_min[i] - point[i];
+        } else if (point[i] > m_max[i]) {
+            temp = point[i] - m_max[i];
+        }
+        ret += temp * temp;
+    }
+    return ret;
+}
+
+bool SignedDistanceHelperBase::BVHNode::upwardRayIntersects(const float start[3]) const
+{//be permissive, equal to boundary counts as inside
+    return start[0] >= m_min[0] && start[0] <= m_max[0] && start[1] >= m_min[1] && start[1] <= m_max[1] && start[2] <= m_max[2];
+}
+
+bool SignedDistanceHelperBase::BVHNode::lineSegmentIntersects(const float start[3], const float end[3]) const
+{//same logic as Oct::lineSegmentIntersects
+    float curlow = 0.0f, curhigh = 1.0f;//parameterize the line segment to the range [0, 1] of t
+    for (int i = 0; i < 3; ++i)
+    {
+        float direction = end[i] - start[i];
+        if (direction != 0.0f)
+        {
+            float templow, temphigh;
+            if (direction > 0.0f)
+            {
+                templow = (m_min[i] - start[i]) / direction;//compute the range of t over which this line lies between the planes for this axis
+                temphigh = (m_max[i] - start[i]) / direction;
+            } else {
+                templow = (m_max[i] - start[i]) / direction;
+                temphigh = (m_min[i] - start[i]) / direction;
+            }
+            if (templow > curlow) curlow = templow;//intersect the ranges
+            if (temphigh < curhigh) curhigh = temphigh;
+            if (curhigh < curlow) return false;
+        } else {
+            if (start[i] < m_min[i] || start[i] > m_max[i]) return false;
         }
     }
+    return true;
 }
 
 const float* SignedDistanceHelperBase::getCoordinate(const int32_t nodeIndex) const
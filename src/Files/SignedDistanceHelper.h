@@ -22,9 +22,7 @@
 /*LICENSE_END*/
 
 #include "Vector3D.h"
-#include "CaretMutex.h"
 #include "CaretPointer.h"
-#include "OctTree.h"
 #include <vector>
 
 namespace caret {
@@ -34,29 +32,27 @@ namespace caret {
     
     class SignedDistanceHelperBase
     {
-        struct TriVector
-        {//specifically so we can cleanly deallocate the vector from non-leaf nodes when they split
-            std::vector<int32_t>* m_triList;
-            TriVector() { m_triList = new std::vector<int32_t>(); }
-            ~TriVector() { freeData(); }
-            void freeData()
-            {
-                if (m_triList != NULL)
-                {
-                    delete m_triList;
-                    m_triList = NULL;
-                }
-            }
+        struct BVHNode
+        {//flat bounding volume hierarchy, first child of an internal node is always the next node
+            float m_min[3], m_max[3];
+            int32_t m_start;//leaf: first slot in m_bvhTriangles, internal: index of the second child
+            int32_t m_count;//number of triangles in a leaf, 0 for internal nodes
+            float distSquaredToPoint(const float point[3]) const;
+            bool upwardRayIntersects(const float start[3]) const;//ray in the +z direction
+            bool lineSegmentIntersects(const float start[3], const float end[3]) const;
         };
-        static const int NUM_TRIS_TO_TEST = 50;//test for whether to split leaf at this number
-        static const int NUM_TRIS_TEST_INCR = 50;//and again at further multiples of this
-        CaretPointer<Oct<TriVector> > m_indexRoot;
+        static const int BVH_NUM_BINS = 16;//candidate split planes per axis for the surface area heuristic
+        static const int BVH_MAX_LEAF = 8;//always split larger leaves, even when the heuristic says not to
+        std::vector<BVHNode> m_bvhNodes;
+        std::vector<int32_t> m_bvhTriangles;//triangle indices, ordered so that each leaf is a contiguous range
+        std::vector<float> m_bvhTriCoords;//vertex coordinates in the same order, 9 floats per slot, so leaves don't chase node indices
         int32_t m_numTris, m_numNodes;
         std::vector<float> m_coordList;//make a copy of what we need from SurfaceFile so that if the SurfaceFile gets destroyed, we don't crash
         std::vector<int32_t> m_triangleList;
         CaretPointer<TopologyHelper> m_topoHelp;
         SignedDistanceHelperBase();
-        void addTriangle(Oct<TriVector>* thisOct, int32_t triangle, float minCoord[3], float maxCoord[3]);
+        int32_t buildBVH(const int32_t start, const int32_t end, const std::vector<float>& triBounds, const std::vector<float>& triCentroids);
+        int32_t closestTriangle(const float coord[3]) const;//triangles are only in one leaf each, so this doesn't need any scratch state
         const float* getCoordinate(const int32_t nodeIndex) const;//make these public? probably don't want them to be widely used, that is what SurfaceFile is for (but we don't want to store a SurfaceFile pointer)
         const int32_t* getTriangle(const int32_t tileIndex) const;
     public:
@@ -92,10 +88,7 @@ namespace caret {
             NORMALS
         };
     private:
-        CaretMutex m_mutex;
         CaretPointer<SignedDistanceHelperBase> m_base;
-        CaretArray<int> m_triMarked;
-        CaretArray<int> m_triMarkChanged;
         SignedDistanceHelper();
         struct ClosestPointInfo
         {
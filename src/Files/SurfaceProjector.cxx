@@ -27,6 +27,7 @@
 #undef __SURFACE_PROJECTOR_DEFINE__
 
 #include "CaretLogger.h"
+#include "CaretOMP.h"
 #include "FociFile.h"
 #include "Focus.h"
 #include "MathFunctions.h"
@@ -109,8 +110,30 @@ m_surfaceFileRight(rightSurfaceFile),
 m_surfaceFileCerebellum(cerebellumSurfaceFile),
 m_mode(MODE_LEFT_RIGHT_CEREBELLUM)
 {
+    initializeMembersSurfaceProjector();
 }
 
+/**
+ * Copy constructor.  Private, only used to give each thread of a batch
+ * projection its own projector, since the projection of a single item
+ * keeps its state in members.
+ *
+ * @param o
+ *    Projector that is copied.
+ */
+SurfaceProjector::SurfaceProjector(const SurfaceProjector& o)
+: CaretObject(o),
+m_surfaceFiles(o.m_surfaceFiles),
+m_surfaceFileLeft(o.m_surfaceFileLeft),
+m_surfaceFileRight(o.m_surfaceFileRight),
+m_surfaceFileCerebellum(o.m_surfaceFileCerebellum),
+m_mode(o.m_mode)
+{
+    initializeMembersSurfaceProjector();
+    m_surfaceOffset = o.m_surfaceOffset;
+    m_surfaceOffsetValid = o.m_surfaceOffsetValid;
+    m_validateFlag = o.m_validateFlag;
+}
 
 /**
  * Destructor
@@ -135,6 +158,44 @@ SurfaceProjector::initializeMembersSurfaceProjector()
      */
     m_validateFlag = CaretLogger::getLogger()->isFine();
     m_validateItemName = "";
+    
+    m_randomState = 1;
+}
+
+/**
+ * Build anything the surfaces create on first use (distance search
+ * structure, topology, bounding box) before projecting in parallel, so
+ * it is built once per surface instead of contended for by the threads.
+ */
+void
+SurfaceProjector::prepareSurfacesForParallelProjection()
+{
+    std::vector<const SurfaceFile*> surfaceFiles = m_surfaceFiles;
+    surfaceFiles.push_back(m_surfaceFileLeft);
+    surfaceFiles.push_back(m_surfaceFileRight);
+    surfaceFiles.push_back(m_surfaceFileCerebellum);
+    
+    const int32_t numberOfSurfaceFiles = static_cast<int32_t>(surfaceFiles.size());
+    for (int32_t i = 0; i < numberOfSurfaceFiles; i++) {
+        const SurfaceFile* sf = surfaceFiles[i];
+        if (sf != NULL) {
+            sf->getSignedDistanceHelper();
+            sf->getTopologyHelper();
+            sf->getBoundingBox();
+        }
+    }
+}
+
+/**
+ * @return Pseudo-random number in [0, 1] for perturbing an item.  Uses
+ * a member generator (not std::rand()) so that batch projections are
+ * thread safe and give the same results for any number of threads.
+ */
+float
+SurfaceProjector::nextRandomZeroToOne()
+{
+    m_randomState = m_randomState * 1664525u + 1013904223u;
+    return (static_cast<float>(m_randomState >> 8) / 16777215.0f);
 }
 
 
@@ -164,28 +225,78 @@ SurfaceProjector::projectFociFile(FociFile* fociFile)
     CaretAssert(fociFile);
     const int32_t numberOfFoci = fociFile->getNumberOfFoci();
     
-    AString errorMessage = "";
+    std::vector<Focus*> foci(numberOfFoci);
     for (int32_t i = 0; i < numberOfFoci; i++) {
-        Focus* focus = fociFile->getFocus(i);
-        try {
-            if (m_validateFlag) {
-                m_validateItemName = ("Focus "
-                                      + AString::number(i)
-                                      + ", "
-                                      + focus->getName());
+        foci[i] = fociFile->getFocus(i);
+    }
+    projectFoci(foci);
+}
+
+/**
+ * Project foci, in parallel.  The projections, the logged warnings,
+ * and the error message are the same as projecting the foci one at a
+ * time, in order, regardless of the number of threads.
+ *
+ * @param foci
+ *     The foci, the index of a focus in this vector is used in messages.
+ *     NULL entries are skipped, so that a subset of the foci in a file
+ *     can be projected while keeping their indices.
+ * @throws SurfaceProjectorException
+ *      If projecting any focus failed (after trying all of the foci).
+ */
+void
+SurfaceProjector::projectFoci(const std::vector<Focus*>& foci)
+{
+    const int32_t numberOfFoci = static_cast<int32_t>(foci.size());
+    std::vector<AString> warnings(numberOfFoci);
+    std::vector<AString> errors(numberOfFoci);
+    
+    prepareSurfacesForParallelProjection();
+    
+    /*
+     * Validation logs as it goes, so keep it serial
+     */
+#pragma omp CARET_PAR if (m_validateFlag == false)
+    {
+        SurfaceProjector threadProjector(*this);
+#pragma omp CARET_FOR schedule(dynamic)
+        for (int32_t i = 0; i < numberOfFoci; i++) {
+            Focus* focus = foci[i];
+            if (focus == NULL) {
+                continue;
             }
-            projectFocus(i,
-                         focus);
-        }
-        catch (const SurfaceProjectorException& spe) {
-            if (errorMessage.isEmpty() == false) {
-                errorMessage += "\n";
+            threadProjector.m_randomState = static_cast<uint32_t>(i) + 1;
+            try {
+                if (threadProjector.m_validateFlag) {
+                    threadProjector.m_validateItemName = ("Focus "
+                                                          + AString::number(i)
+                                                          + ", "
+                                                          + focus->getName());
+                }
+                threadProjector.projectFocusAux(i,
+                                                focus,
+                                                warnings[i]);
             }
-            errorMessage += (focus->getName()
+            catch (const SurfaceProjectorException& spe) {
+                errors[i] = (focus->getName()
                              + ", index="
                              + AString::number(i)
                              + ": "
                              + spe.whatString());
+            }
+        }
+    }
+    
+    AString errorMessage = "";
+    for (int32_t i = 0; i < numberOfFoci; i++) {
+        if (warnings[i].isEmpty() == false) {
+            CaretLogWarning(warnings[i]);
+        }
+        if (errors[i].isEmpty() == false) {
+            if (errorMessage.isEmpty() == false) {
+                errorMessage += "\n";
+            }
+            errorMessage += errors[i];
         }
     }
     
@@ -207,6 +318,32 @@ void
 SurfaceProjector::projectFocus(const int32_t focusIndex,
                                Focus* focus)
 {
+    AString warning;
+    projectFocusAux(focusIndex,
+                    focus,
+                    warning);
+    if (warning.isEmpty() == false) {
+        CaretLogWarning(warning);
+    }
+}
+
+/**
+ * Project a focus without logging.
+ * @param focusIndex
+ *    Index of the focus (negative indicates no index)
+ * @param focus
+ *    The focus.
+ * @param warningOut
+ *    Output containing warning about the projection, empty if none.
+ * @throws SurfaceProjectorException
+ *      If projecting an item failed.
+ */
+void
+SurfaceProjector::projectFocusAux(const int32_t focusIndex,
+                                  Focus* focus,
+                                  AString& warningOut)
+{
+    warningOut = "";
     const int32_t numberOfProjections = focus->getNumberOfProjections();
     CaretAssert(numberOfProjections > 0);
     if (numberOfProjections < 0) {
@@ -243,7 +380,7 @@ SurfaceProjector::projectFocus(const int32_t focusIndex,
         }
         msg += (": "
                 + m_projectionWarning);
-        CaretLogWarning(msg);;
+        warningOut = msg;
     }
 }
 
@@ -288,7 +425,6 @@ SurfaceProjector::projectItemToTriangleOrEdge(SurfaceProjectedItem* spi)
                 NULL);
 }
 
-
 /**
  * Project to the appropriate surface(s).
  *
@@ -501,7 +637,7 @@ SurfaceProjector::projectItemToSurfaceFile(const SurfaceFile* surfaceFile,
             const float originalDistanceError = distanceError;
             
             for (int32_t iTry = 0; iTry < 10; iTry++) {
-                const float randomZeroToOne = ((float)std::rand()) / ((float)RAND_MAX);
+                const float randomZeroToOne = nextRandomZeroToOne();
                 const float randomPlusMinusOneHalf = randomZeroToOne - 0.5;
                 const float moveLittleBit = randomPlusMinusOneHalf * 0.5;
                 xyz[0] = originalXYZ[0] + moveLittleBit;
@@ -28,6 +28,7 @@
 #include <stdint.h>
 
 #include <set>
+#include <vector>
 
 namespace caret {
     
@@ -62,6 +63,8 @@ namespace caret {
         
         void projectFociFile(FociFile* fociFile);
         
+        void projectFoci(const std::vector<Focus*>& foci);
+        
         void projectFocus(const int32_t focusIndex,
                           Focus* focus);
         
@@ -122,6 +125,14 @@ namespace caret {
 
         void initializeMembersSurfaceProjector();
         
+        void prepareSurfacesForParallelProjection();
+        
+        void projectFocusAux(const int32_t focusIndex,
+                             Focus* focus,
+                             AString& warningOut);
+        
+        float nextRandomZeroToOne();
+        
         void getProjectionLocation(const SurfaceFile* surfaceFile,
                                    const float xyz[3],
                                    ProjectionLocation& projectionLocation) const;
@@ -197,6 +208,9 @@ namespace caret {
         
         AString m_projectionWarning;
         
+        /** State of generator for perturbing items that project poorly, seeded per item in batches */
+        uint32_t m_randomState;
+        
         /** Point in triangle test tolerance that requires point inside triangle */
         static float s_normalTriangleAreaTolerance;
         
@@ -0,0 +1,130 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2016  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "SurfaceSmoothingHelper.h"
+
+#include "CaretAssert.h"
+#include "CaretOMP.h"
+#include "MathFunctions.h"
+#include "ProgressObject.h"
+#include "SurfaceFile.h"
+#include "TopologyHelper.h"
+
+using namespace caret;
+using namespace std;
+
+SurfaceSmoothingHelper::SurfaceSmoothingHelper(const SurfaceFile* surfaceIn)
+{
+    const int32_t numNodes = surfaceIn->getNumberOfNodes();
+    m_current = 0;
+    m_maxNeighbors = 0;
+    m_coords[0].resize(numNodes * 3);
+    m_coords[1].resize(numNodes * 3);
+    m_neighborStart.resize(numNodes + 1, 0);
+    if (numNodes <= 0) return;
+    const float* coordData = surfaceIn->getCoordinateData();
+    for (int64_t i = 0; i < numNodes * 3; ++i)
+    {
+        m_coords[0][i] = coordData[i];
+    }
+    CaretPointer<TopologyHelper> myTopoHelp = surfaceIn->getTopologyHelper(true);//sorted, so consecutive neighbors form the triangles
+    for (int32_t i = 0; i < numNodes; ++i)
+    {
+        int32_t numNeighbors = 0;
+        myTopoHelp->getNodeNeighbors(i, numNeighbors);
+        m_neighborStart[i + 1] = m_neighborStart[i] + numNeighbors;
+        if (numNeighbors > m_maxNeighbors) m_maxNeighbors = numNeighbors;
+    }
+    m_neighbors.resize(m_neighborStart[numNodes]);
+    for (int32_t i = 0; i < numNodes; ++i)
+    {
+        int32_t numNeighbors = 0;
+        const int32_t* neighbors = myTopoHelp->getNodeNeighbors(i, numNeighbors);
+        for (int32_t j = 0; j < numNeighbors; ++j)
+        {
+            m_neighbors[m_neighborStart[i] + j] = neighbors[j];
+        }
+    }
+}
+
+void SurfaceSmoothingHelper::smooth(const float& strength, const int32_t& iterations, LevelProgress* progress)
+{
+    for (int32_t iter = 1; iter <= iterations; ++iter)
+    {
+        iterate(m_coords[m_current].data(), m_coords[1 - m_current].data(), strength);
+        m_current = 1 - m_current;
+        if (progress != NULL)
+        {
+            progress->reportProgress(static_cast<float>(iter) / static_cast<float>(iterations));
+        }
+    }
+}
+
+void SurfaceSmoothingHelper::iterate(const float* coordsIn, float* coordsOut, const float& strength) const
+{
+    const int32_t numNodes = getNumberOfNodes();
+    const float inverseStrength = 1.0 - strength;
+#pragma omp CARET_PAR
+    {
+        vector<float> triangleAreas(m_maxNeighbors), triangleCenters(m_maxNeighbors * 3);
+#pragma omp CARET_FOR schedule(dynamic, 1024)
+        for (int32_t iNode = 0; iNode < numNodes; ++iNode)
+        {
+            const int32_t* neighbors = m_neighbors.data() + m_neighborStart[iNode];
+            const int32_t numNeighbors = m_neighborStart[iNode + 1] - m_neighborStart[iNode];
+            const float* c1 = coordsIn + iNode * 3;
+            float* out = coordsOut + iNode * 3;
+            if (numNeighbors < 2)
+            {
+                out[0] = c1[0];
+                out[1] = c1[1];
+                out[2] = c1[2];
+                continue;
+            }
+            double totalArea = 0.0;
+            for (int32_t jn = 0; jn < numNeighbors; ++jn)
+            {//triangles formed by the node and consecutive neighbors, same arithmetic as the original per-node loop, so results don't change
+                const float* c2 = coordsIn + neighbors[jn] * 3;
+                const float* c3 = coordsIn + neighbors[(jn + 1 < numNeighbors) ? jn + 1 : 0] * 3;
+                const float area = MathFunctions::triangleArea(c1, c2, c3);
+                triangleAreas[jn] = area;
+                totalArea += area;
+                for (int k = 0; k < 3; ++k)
+                {
+                    triangleCenters[jn * 3 + k] = (c1[k] + c2[k] + c3[k]) / 3.0;
+                }
+            }
+            float neighborAverageX = 0.0f, neighborAverageY = 0.0f, neighborAverageZ = 0.0f;
+            for (int32_t jn = 0; jn < numNeighbors; ++jn)
+            {
+                if (triangleAreas[jn] > 0.0)
+                {
+                    const float weight = triangleAreas[jn] / totalArea;
+                    neighborAverageX += (weight * triangleCenters[jn * 3]);
+                    neighborAverageY += (weight * triangleCenters[jn * 3 + 1]);
+                    neighborAverageZ += (weight * triangleCenters[jn * 3 + 2]);
+                }
+            }
+            out[0] = c1[0] * inverseStrength + neighborAverageX * strength;
+            out[1] = c1[1] * inverseStrength + neighborAverageY * strength;
+            out[2] = c1[2] * inverseStrength + neighborAverageZ * strength;
+        }
+    }
+}
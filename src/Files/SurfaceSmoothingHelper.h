@@ -0,0 +1,58 @@
+#ifndef __SURFACE_SMOOTHING_HELPER_H__
+#define __SURFACE_SMOOTHING_HELPER_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2016  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "stdint.h"
+#include <vector>
+
+namespace caret {
+
+    class LevelProgress;
+    class SurfaceFile;
+
+    ///iterations of area-weighted neighbor averaging of surface coordinates, shared by surface smoothing and inflation
+    ///neighbor lists are flattened once, and every iteration updates all vertices in parallel from the previous iteration's coordinates
+    class SurfaceSmoothingHelper
+    {
+        std::vector<int32_t> m_neighborStart;//neighbors of node i are m_neighbors[m_neighborStart[i]] up to m_neighborStart[i + 1], in ring order
+        std::vector<int32_t> m_neighbors;
+        int32_t m_maxNeighbors;
+        std::vector<float> m_coords[2];//double buffered, 3 per node
+        int m_current;
+        void iterate(const float* coordsIn, float* coordsOut, const float& strength) const;
+    public:
+        ///copies the coordinates, and the sorted neighbor lists from the topology helper
+        SurfaceSmoothingHelper(const SurfaceFile* surfaceIn);
+
+        ///each iteration moves every vertex toward the area-weighted average of the centers of its triangles
+        void smooth(const float& strength, const int32_t& iterations, LevelProgress* progress = NULL);
+
+        int32_t getNumberOfNodes() const { return (int32_t)(m_coords[m_current].size() / 3); }
+
+        ///current coordinates, can be modified between calls to smooth()
+        float* getCoordinates() { return m_coords[m_current].data(); }
+        const float* getCoordinates() const { return m_coords[m_current].data(); }
+    };
+
+}
+
+#endif //__SURFACE_SMOOTHING_HELPER_H__
@@ -22,6 +22,7 @@
 #include <sstream>
 #include <string>
 
+#include <QFileInfo>
 #include <QTemporaryFile>
 
 #include "CaretHttpManager.h"
@@ -46,12 +47,76 @@
 #include "VolumeSpline.h"
 
 #include <limits>
+#include <map>
 
 using namespace caret;
 using namespace std;
 
 const float VolumeFile::INVALID_INTERP_VALUE = 0.0f;//we may want NaN or something more obvious
 bool VolumeFile::s_voxelColoringEnabled = true;
+bool VolumeFile::s_loadFramesOnDemand = false;
+int64_t VolumeFile::s_frameCacheBytes = -1;
+
+namespace
+{
+    const int64_t MIN_ON_DEMAND_BYTES = ((int64_t)1) << 25;//smaller files are read entirely, 32MiB
+    const int64_t MIN_CACHED_FRAMES = 16;
+    const int MAX_ON_DEMAND_FILES = 128;//each one keeps its file open
+    
+    CaretMutex onDemandMutex;
+    map<VolumeFile*, AString> onDemandFiles;//absolute names of the files that volumes are still reading frames from
+    
+    class NiftiFrameLoader : public VolumeFrameLoader
+    {
+        NiftiIO m_io;
+        vector<int64_t> m_extraDims;
+    public:
+        NiftiFrameLoader(const AString& filename)
+        {
+            m_io.openRead(filename);
+            const vector<int64_t>& myDims = m_io.getDimensions();
+            CaretAssert(myDims.size() > 3);
+            m_extraDims = vector<int64_t>(myDims.begin() + 3, myDims.end());
+        }
+        void loadFrame(const int64_t& brickIndex, const int64_t& component, float* frameOut)
+        {
+            CaretAssert(component == 0);//only single component files are loaded on demand
+            vector<int64_t> indexes(m_extraDims.size());
+            int64_t remaining = brickIndex;
+            for (int i = 0; i < (int)m_extraDims.size(); ++i)
+            {//same ordering as getNonSpatialIndexesFromBrickIndex
+                indexes[i] = remaining % m_extraDims[i];
+                remaining /= m_extraDims[i];
+            }
+            m_io.readData(frameOut, 3, indexes);
+        }
+    };
+    
+    void unregisterOnDemand(VolumeFile* volume)
+    {
+        CaretMutexLocker locked(&onDemandMutex);
+        onDemandFiles.erase(volume);
+    }
+    
+    //before a file is overwritten, any volume still reading frames from it must get the rest of them
+    void loadFramesReadingFrom(const AString& filename)
+    {
+        const AString absName = QFileInfo(filename).absoluteFilePath();
+        CaretMutexLocker locked(&onDemandMutex);
+        map<VolumeFile*, AString>::iterator iter = onDemandFiles.begin();
+        while (iter != onDemandFiles.end())
+        {
+            if (iter->second == absName)
+            {
+                CaretLogFine("loading remaining frames of '" + filename + "' before overwriting it");
+                iter->first->loadAllFrames();
+                onDemandFiles.erase(iter++);
+            } else {
+                ++iter;
+            }
+        }
+    }
+}
 
 /**
  * Static method that sets the status of voxel coloring.  Coloring may take
@@ -74,6 +139,32 @@ VolumeFile::setVoxelColoringEnabled(const bool enabled)
 }
 
 
+/**
+ * Static method that sets whether the frames of large 4D volume files are
+ * read from the file when they are first used, rather than all being read
+ * by readFile().  The file stays open while frames are still unread.
+ *
+ * Only affects files read after it is called.
+ *
+ * @param enabled
+ *    New status for loading frames on demand.
+ * @param maximumCacheBytes
+ *    Memory for frames of each volume, after which the oldest unmodified
+ *    frame is released (it is read again if used again).  Negative means
+ *    frames are never released.  Pointers from getFrame() are only valid
+ *    until enough other frames are used to release that frame.
+ */
+void
+VolumeFile::setLoadFramesOnDemand(const bool enabled, const int64_t maximumCacheBytes)
+{
+    s_loadFramesOnDemand = enabled;
+    s_frameCacheBytes = maximumCacheBytes;
+    
+    CaretLogConfig(AString(s_loadFramesOnDemand
+                           ? "Volume frames are loaded on demand."
+                           : "Volume frames are loaded when the file is read."));
+}
+
 VolumeFile::VolumeFile()
 : VolumeBase(), CaretMappableDataFile(DataFileTypeEnum::VOLUME)
 {
@@ -190,11 +281,38 @@ VolumeFile::clear()
     m_frameSplines.clear();
     
     m_dataRangeValid = false;
+    unregisterOnDemand(this);
     VolumeBase::clear();
     
     m_volumeFileEditorDelegate->clear();
 }
 
+bool VolumeFile::setupOnDemandLoading(const AString& fileToRead, const vector<int64_t>& dimensions, const vector<vector<float> >& sform, const int& numComponents)
+{
+    if (!s_loadFramesOnDemand || numComponents != 1 || dimensions.size() < 4) return false;
+    const int64_t frameBytes = dimensions[0] * dimensions[1] * dimensions[2] * sizeof(float);
+    int64_t numFrames = 1;
+    for (int i = 3; i < (int)dimensions.size(); ++i)
+    {
+        numFrames *= dimensions[i];
+    }
+    if (numFrames < 2 || frameBytes * numFrames < MIN_ON_DEMAND_BYTES) return false;
+    {
+        CaretMutexLocker locked(&onDemandMutex);
+        if ((int)onDemandFiles.size() >= MAX_ON_DEMAND_FILES) return false;
+    }
+    int64_t maxFrames = -1;
+    if (s_frameCacheBytes >= 0)
+    {
+        maxFrames = max(MIN_CACHED_FRAMES, s_frameCacheBytes / frameBytes);
+        if (maxFrames >= numFrames) maxFrames = -1;
+    }
+    reinitializeOnDemand(dimensions, sform, new NiftiFrameLoader(fileToRead), maxFrames);
+    CaretMutexLocker locked(&onDemandMutex);
+    onDemandFiles[this] = QFileInfo(fileToRead).absoluteFilePath();
+    return true;
+}
+
 void VolumeFile::readFile(const AString& filename)
 {
     ElapsedTimer timer;
@@ -233,11 +351,17 @@ void VolumeFile::readFile(const AString& filename)
             extraDims = vector<int64_t>(myDims.begin() + 3, myDims.end());
         }
         while (myDims.size() < 3) myDims.push_back(1);//pretend we have 3 dimensions in header, always, things that use getOriginalDimensions assume this (because "VolumeFile")
-        reinitialize(myDims, inHeader.getSForm(), numComponents);
+        const bool onDemand = (fileToRead == filename) && setupOnDemandLoading(fileToRead, myDims, inHeader.getSForm(), numComponents);//temporary files for network files get deleted
+        if (!onDemand)
+        {
+            reinitialize(myDims, inHeader.getSForm(), numComponents);
+        }
         setFileName(filename);  // must be donw after reinitialize() since it calls clear() which clears the name of the file
         int64_t frameSize = myDims[0] * myDims[1] * myDims[2];
-        if (numComponents != 1)
+        if (onDemand)
         {
+            CaretLogFine("Frames of " + filename + " will be read when used");
+        } else if (numComponents != 1) {
             vector<float> tempFrame(frameSize), readBuffer(frameSize * numComponents);
             for (MultiDimIterator<int64_t> myiter(extraDims); !myiter.atEnd(); ++myiter)
             {
@@ -306,6 +430,7 @@ VolumeFile::writeFile(const AString& filename)
                                 "writing multi-component volumes is not currently supported");//its a hassle, and uncommon, and there is only one 3-component type, restricted to 0-255
     }
     updateCaretExtension();
+    loadFramesReadingFrom(filename);
     
     NiftiHeader outHeader;//begin nifti-specific code
     if (m_header != NULL && (m_header->getType() == AbstractHeader::NIFTI))
@@ -1687,14 +1812,18 @@ VolumeFile::getDataRangeFromAllMaps(float& dataRangeMinimumOut,
     m_dataRangeMinimum = std::numeric_limits<float>::max();
     
     const int64_t* dimensions = getDimensionsPtr();
-    int64_t m_dataSize = dimensions[0] * dimensions[1] * dimensions[2] * dimensions[3] * dimensions[4];
-    const float* data = getFrame();//HACK: use first frame knowing all data is contiguous after it
-    for (int64_t i = 0; i < m_dataSize; i++) {
-        if (data[i] > m_dataRangeMaximum) {
-            m_dataRangeMaximum = data[i];
-        }
-        if (data[i] < m_dataRangeMinimum) {
-            m_dataRangeMinimum = data[i];
+    const int64_t frameSize = dimensions[0] * dimensions[1] * dimensions[2];
+    for (int64_t c = 0; c < dimensions[4]; ++c) {
+        for (int64_t b = 0; b < dimensions[3]; ++b) {
+            const float* data = getFrame(b, c);//frames aren't contiguous when loaded on demand
+            for (int64_t i = 0; i < frameSize; i++) {
+                if (data[i] > m_dataRangeMaximum) {
+                    m_dataRangeMaximum = data[i];
+                }
+                if (data[i] < m_dataRangeMinimum) {
+                    m_dataRangeMinimum = data[i];
+                }
+            }
         }
     }
     
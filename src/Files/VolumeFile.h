@@ -56,6 +56,13 @@ namespace caret {
         
         void updateCaretExtension();//called before writing a file, erases all existing caret extensions from m_extensions, and rebuilds one from m_caretVolExt
         
+        static bool s_loadFramesOnDemand;
+        
+        static int64_t s_frameCacheBytes;
+        
+        //returns false if the file should be read entirely instead
+        bool setupOnDemandLoading(const AString& fileToRead, const std::vector<int64_t>& dimensions, const std::vector<std::vector<float> >& sform, const int& numComponents);
+        
         void checkStatisticsValid();
         
         struct BrickAttributes//for storing ONLY stuff that doesn't get saved to the caret extension
@@ -143,6 +150,8 @@ namespace caret {
         
         static void setVoxelColoringEnabled(const bool enabled);
         
+        static void setLoadFramesOnDemand(const bool enabled, const int64_t maximumCacheBytes = -1);
+        
         VolumeFile();
         VolumeFile(const std::vector<int64_t>& dimensionsIn, const std::vector<std::vector<float> >& indexToSpace, const int64_t numComponents = 1, SubvolumeAttributes::VolumeType whatType = SubvolumeAttributes::ANATOMY);
         ~VolumeFile();
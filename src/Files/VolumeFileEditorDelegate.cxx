@@ -352,6 +352,9 @@ VolumeFileEditorDelegate::clampVoxelIndices(int64_t& i, int64_t& j, int64_t& k)
 
 /**
  * Add to the modified undo stacks for the given map.
+ * The command's voxel blocks are compacted since the command
+ * stays in the undo stack and some editing operations modify
+ * the voxels directly without calling the command's redo().
  *
  * @param mapIndex
  *     Index of the map that was modified.
@@ -367,6 +370,8 @@ VolumeFileEditorDelegate::addToMapUndoStacks(const int32_t mapIndex,
         return;
     }
     
+    modifiedVoxels->compactBlocks();
+    
     CaretAssertVectorIndex(m_volumeMapUndoStacks, mapIndex);
     m_volumeMapUndoStacks[mapIndex]->push(modifiedVoxels);
 }
@@ -497,17 +502,19 @@ VolumeFileEditorDelegate::performTurnOnOrOffOrthogonal(const EditInfo& editInfo,
                 modifiedVoxels->addVoxelRedoUndo(ijk,
                                                  redoVoxelValue,
                                                  m_volumeFile->getValue(ijk, editInfo.m_mapIndex));
-                m_volumeFile->setValue(redoVoxelValue,
-                                       ijk,
-                                       editInfo.m_mapIndex);
             }
         }
     }
 
+    /*
+     * Calling 'redo' will apply the changes to the volume file.
+     */
+    const bool validFlag = modifiedVoxels->redo(errorMessageOut);
+    
     addToMapUndoStacks(editInfo.m_mapIndex,
                        modifiedVoxels.releasePointer());
     
-    return true;
+    return validFlag;
 }
 
 /**
@@ -609,13 +616,15 @@ VolumeFileEditorDelegate::performTurnOnOrOffOblique(const EditInfo& editInfo,
                 modifiedVoxels->addVoxelRedoUndo(ijk,
                                                  redoVoxelValue,
                                                  m_volumeFile->getValue(ijk, editInfo.m_mapIndex));
-                m_volumeFile->setValue(redoVoxelValue,
-                                       ijk,
-                                       editInfo.m_mapIndex);
             }
         }
     }
     
+    /*
+     * Calling 'redo' will apply the changes to the volume file.
+     */
+    const bool validFlag = modifiedVoxels->redo(errorMessageOut);
+    
 //    for (int64_t k = -planeVoxelsDZ; k <= planeVoxelsDZ; ++k) {
 //        
 //    }
@@ -639,7 +648,7 @@ VolumeFileEditorDelegate::performTurnOnOrOffOblique(const EditInfo& editInfo,
     addToMapUndoStacks(editInfo.m_mapIndex,
                        modifiedVoxels.releasePointer());
     
-    return true;
+    return validFlag;
 }
 
 /**
@@ -1041,18 +1050,20 @@ VolumeFileEditorDelegate::performRetainConnected3D(const EditInfo& editInfo,
                     modifiedVoxels->addVoxelRedoUndo(i, j, k,
                                                      editInfo.m_voxelValueOff,
                                                      m_volumeFile->getValue(i, j, k, editInfo.m_mapIndex));
-                    
-                    m_volumeFile->setValue(editInfo.m_voxelValueOff,
-                                           i, j, k, editInfo.m_mapIndex);
                 }
             }
         }
     }
 
+    /*
+     * Calling 'redo' will apply the changes to the volume file.
+     */
+    const bool validFlag = modifiedVoxels->redo(errorMessageOut);
+    
     addToMapUndoStacks(editInfo.m_mapIndex,
                        modifiedVoxels.releasePointer());
 
-    return true;
+    return validFlag;
 }
 
 /**
@@ -36,6 +36,60 @@ using namespace caret;
  * \ingroup Files
  */
 
+namespace {
+    /** Voxels along each axis of a VoxelBlock */
+    const int64_t BLOCK_SIZE = 8;
+    
+    const int32_t BLOCK_VOXELS = BLOCK_SIZE * BLOCK_SIZE * BLOCK_SIZE;
+    
+    const int32_t BLOCK_MASK_WORDS = BLOCK_VOXELS / 64;
+    
+    /**
+     * Keep only the values of voxels in the mask, in mask order,
+     * or a single value if they are all the same.
+     */
+    void compactBlockValues(const uint64_t mask[],
+                            std::vector<float>& values)
+    {
+        std::vector<float> packed;
+        bool uniformFlag = true;
+        for (int32_t position = 0; position < BLOCK_VOXELS; position++) {
+            if ((mask[position / 64] & (((uint64_t)1) << (position % 64))) != 0) {
+                if ( ! packed.empty()) {
+                    if (values[position] != packed[0]) {
+                        uniformFlag = false;
+                    }
+                }
+                packed.push_back(values[position]);
+            }
+        }
+        if (uniformFlag
+            && ( ! packed.empty())) {
+            packed.resize(1);
+        }
+        std::vector<float>(packed).swap(values);//also releases the unused capacity
+    }
+    
+    /**
+     * Inverse of compactBlockValues().
+     */
+    void expandBlockValues(const uint64_t mask[],
+                           std::vector<float>& values)
+    {
+        std::vector<float> full(BLOCK_VOXELS, 0.0f);
+        const bool uniformFlag = (values.size() == 1);
+        int32_t count = 0;
+        for (int32_t position = 0; position < BLOCK_VOXELS; position++) {
+            if ((mask[position / 64] & (((uint64_t)1) << (position % 64))) != 0) {
+                CaretAssertVectorIndex(values, (uniformFlag ? 0 : count));
+                full[position] = values[uniformFlag ? 0 : count];
+                count++;
+            }
+        }
+        values.swap(full);
+    }
+}
+
 /**
  * Constructor.
  */
@@ -47,6 +101,17 @@ m_mapIndex(mapIndex)
 {
     CaretAssert(volumeFile);
     CaretAssert((mapIndex >= 0) && (mapIndex < volumeFile->getNumberOfMaps()));
+    
+    const int64_t* dims = volumeFile->getDimensionsPtr();
+    for (int32_t i = 0; i < 3; i++) {
+        m_dimensions[i] = dims[i];
+        m_blockDimensions[i] = (dims[i] + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    }
+    
+    m_lastBlockIndex = -1;
+    m_lastBlockVectorIndex = -1;
+    m_voxelCount = 0;
+    m_compactedFlag = false;
 }
 
 /**
@@ -54,12 +119,12 @@ m_mapIndex(mapIndex)
  */
 VolumeMapUndoCommand::~VolumeMapUndoCommand()
 {
-    for (std::vector<VoxelMemento*>::iterator iter = m_voxelMementos.begin();
-         iter != m_voxelMementos.end();
+    for (std::vector<VoxelBlock*>::iterator iter = m_voxelBlocks.begin();
+         iter != m_voxelBlocks.end();
          iter++) {
         delete *iter;
     }
-    m_voxelMementos.clear();
+    m_voxelBlocks.clear();
 }
 
 /**
@@ -75,14 +140,7 @@ VolumeMapUndoCommand::redo(AString& errorMessageOut)
 {
     errorMessageOut.clear();
     
-    for (std::vector<VoxelMemento*>::iterator iter = m_voxelMementos.begin();
-         iter != m_voxelMementos.end();
-         iter++) {
-        const VoxelMemento* voxelMod = *iter;
-        m_volumeFile->setValue(voxelMod->m_redoValue,
-                               voxelMod->m_ijk,
-                               m_mapIndex);
-    }
+    applyValues(true);
     
     return true;
 }
@@ -95,14 +153,7 @@ VolumeMapUndoCommand::undo(AString& errorMessageOut)
 {
     errorMessageOut.clear();
     
-    for (std::vector<VoxelMemento*>::iterator iter = m_voxelMementos.begin();
-         iter != m_voxelMementos.end();
-         iter++) {
-        const VoxelMemento* voxelMod = *iter;
-        m_volumeFile->setValue(voxelMod->m_undoValue,
-                               voxelMod->m_ijk,
-                               m_mapIndex);
-    }
+    applyValues(false);
     
     return true;
 }
@@ -113,12 +164,15 @@ VolumeMapUndoCommand::undo(AString& errorMessageOut)
 int32_t
 VolumeMapUndoCommand::count() const
 {
-    return m_voxelMementos.size();
+    return static_cast<int32_t>(m_voxelCount);
 }
 
 
 /**
  * Add the redo and undo values for a voxel.
+ *
+ * If the voxel was already added, only its redo value is replaced
+ * so that undo restores the value from before the first change.
  * 
  * @param ijk
  *     The voxel's indices.
@@ -132,9 +186,54 @@ VolumeMapUndoCommand::addVoxelRedoUndo(const int64_t ijk[3],
                                        const float redoValue,
                                        const float undoValue)
 {
-    m_voxelMementos.push_back(new VoxelMemento(ijk,
-                                               redoValue,
-                                               undoValue));
+    CaretAssert(m_volumeFile->indexValid(ijk));
+    
+    if (m_compactedFlag) {
+        for (std::vector<VoxelBlock*>::iterator iter = m_voxelBlocks.begin();
+             iter != m_voxelBlocks.end();
+             iter++) {
+            (*iter)->expand();
+        }
+        m_compactedFlag = false;
+    }
+    
+    const int64_t blockIJK[3] = {
+        ijk[0] / BLOCK_SIZE,
+        ijk[1] / BLOCK_SIZE,
+        ijk[2] / BLOCK_SIZE
+    };
+    const int64_t blockIndex = (blockIJK[0]
+                                + m_blockDimensions[0] * (blockIJK[1]
+                                                          + m_blockDimensions[1] * blockIJK[2]));
+    if (blockIndex != m_lastBlockIndex) {
+        std::map<int64_t, int32_t>::iterator iter = m_blockLookup.find(blockIndex);
+        if (iter != m_blockLookup.end()) {
+            m_lastBlockVectorIndex = iter->second;
+        }
+        else {
+            m_lastBlockVectorIndex = static_cast<int32_t>(m_voxelBlocks.size());
+            m_voxelBlocks.push_back(new VoxelBlock(blockIJK));
+            m_blockLookup.insert(std::make_pair(blockIndex,
+                                                m_lastBlockVectorIndex));
+        }
+        m_lastBlockIndex = blockIndex;
+    }
+    
+    CaretAssertVectorIndex(m_voxelBlocks, m_lastBlockVectorIndex);
+    VoxelBlock* block = m_voxelBlocks[m_lastBlockVectorIndex];
+    const int32_t position = ((ijk[0] - block->m_firstIJK[0])
+                              + BLOCK_SIZE * ((ijk[1] - block->m_firstIJK[1])
+                                              + BLOCK_SIZE * (ijk[2] - block->m_firstIJK[2])));
+    CaretAssert((position >= 0) && (position < BLOCK_VOXELS));
+    const uint64_t bit = ((uint64_t)1) << (position % 64);
+    uint64_t& maskWord = block->m_mask[position / 64];
+    
+    block->m_redoValues[position] = redoValue;
+    if ((maskWord & bit) == 0) {
+        maskWord |= bit;
+        block->m_undoValues[position] = undoValue;
+        m_voxelCount++;
+    }
 }
 
 /**
@@ -161,33 +260,117 @@ VolumeMapUndoCommand::addVoxelRedoUndo(const int64_t i,
     const int64_t ijk[3] = { i, j, k };
     addVoxelRedoUndo(ijk, redoValue, undoValue);
 }
-/* ------------------------------------------------------------------ */
+
 /**
- * Constructor.
- *
- * @param ijk
- *     The voxel's indices.
- * @param redoValue
- *     Value for redo operation.
- * @param undoValue
- *     Value for undo operation.
+ * Reduce the blocks to only the values of the edited voxels.
+ * Done when the command is added to an undo stack, since it then
+ * stays there for a long time.  Adding voxels afterwards expands
+ * the blocks again.
  */
-VolumeMapUndoCommand::VoxelMemento::VoxelMemento(const int64_t ijk[3],
-                                                 const float redoValue,
-                                                 const float undoValue)
+void
+VolumeMapUndoCommand::compactBlocks()
 {
-    m_ijk[0] = ijk[0];
-    m_ijk[1] = ijk[1];
-    m_ijk[2] = ijk[2];
+    if (m_compactedFlag) {
+        return;
+    }
     
-    m_redoValue = redoValue;
-    m_undoValue = undoValue;
+    for (std::vector<VoxelBlock*>::iterator iter = m_voxelBlocks.begin();
+         iter != m_voxelBlocks.end();
+         iter++) {
+        (*iter)->compact();
+    }
+    m_compactedFlag = true;
 }
 
-VolumeMapUndoCommand::VoxelMemento::~VoxelMemento()
+/**
+ * Set the volume's voxels to the redo or undo values, one
+ * block at a time.
+ *
+ * @param redoFlag
+ *     If true, use the redo values, else the undo values.
+ */
+void
+VolumeMapUndoCommand::applyValues(const bool redoFlag)
 {
+    compactBlocks();
+    
+    int64_t frameOffsets[BLOCK_VOXELS];
+    float values[BLOCK_VOXELS];
     
+    for (std::vector<VoxelBlock*>::const_iterator iter = m_voxelBlocks.begin();
+         iter != m_voxelBlocks.end();
+         iter++) {
+        const VoxelBlock* block = *iter;
+        const std::vector<float>& blockValues = (redoFlag
+                                                 ? block->m_redoValues
+                                                 : block->m_undoValues);
+        const bool uniformFlag = (blockValues.size() == 1);
+        
+        int64_t count = 0;
+        for (int32_t word = 0; word < BLOCK_MASK_WORDS; word++) {
+            const uint64_t maskWord = block->m_mask[word];
+            if (maskWord == 0) {
+                continue;
+            }
+            for (int32_t bit = 0; bit < 64; bit++) {
+                if ((maskWord & (((uint64_t)1) << bit)) == 0) {
+                    continue;
+                }
+                const int32_t position = word * 64 + bit;
+                const int64_t i = block->m_firstIJK[0] + (position % BLOCK_SIZE);
+                const int64_t j = block->m_firstIJK[1] + ((position / BLOCK_SIZE) % BLOCK_SIZE);
+                const int64_t k = block->m_firstIJK[2] + (position / (BLOCK_SIZE * BLOCK_SIZE));
+                frameOffsets[count] = i + m_dimensions[0] * (j + m_dimensions[1] * k);
+                CaretAssertVectorIndex(blockValues, (uniformFlag ? 0 : count));
+                values[count] = blockValues[uniformFlag ? 0 : count];
+                count++;
+            }
+        }
+        
+        m_volumeFile->setFrameValues(frameOffsets,
+                                     values,
+                                     count,
+                                     m_mapIndex);
+    }
 }
 
+/* ------------------------------------------------------------------ */
+/**
+ * Constructor.
+ *
+ * @param blockIJK
+ *     Indices of the block, voxel indices divided by the block size.
+ */
+VolumeMapUndoCommand::VoxelBlock::VoxelBlock(const int64_t blockIJK[3])
+{
+    for (int32_t i = 0; i < 3; i++) {
+        m_firstIJK[i] = blockIJK[i] * BLOCK_SIZE;
+    }
+    for (int32_t i = 0; i < BLOCK_MASK_WORDS; i++) {
+        m_mask[i] = 0;
+    }
+    
+    m_redoValues.resize(BLOCK_VOXELS);
+    m_undoValues.resize(BLOCK_VOXELS);
+}
 
+/**
+ * Reduce the value arrays to only the edited voxels.
+ */
+void
+VolumeMapUndoCommand::VoxelBlock::compact()
+{
+    compactBlockValues(m_mask, m_redoValues);
+    compactBlockValues(m_mask, m_undoValues);
+}
 
+/**
+ * Restore the value arrays to an entry for every voxel in the block
+ * so that more voxels may be added.
+ */
+void
+VolumeMapUndoCommand::VoxelBlock::expand()
+{
+    expandBlockValues(m_mask, m_redoValues);
+    expandBlockValues(m_mask, m_undoValues);
+}
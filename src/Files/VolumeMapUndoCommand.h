@@ -22,6 +22,9 @@
 /*LICENSE_END*/
 
 
+#include <map>
+#include <vector>
+
 #include "CaretUndoCommand.h"
 
 
@@ -54,33 +57,61 @@ namespace caret {
                               const float redoValue,
                               const float undoValue);
         
+        void compactBlocks();
+        
         // ADD_NEW_METHODS_HERE
 
     private:
-        class VoxelMemento {
+        /**
+         * Edits within one 8x8x8 block of voxels.  While recording, the
+         * value arrays have an entry for every voxel of the block, after
+         * compacting they only have entries for the edited voxels, in
+         * mask order, or a single entry when all of them are the same.
+         */
+        class VoxelBlock {
         public:
-            VoxelMemento(const int64_t ijk[3],
-                         const float redoValue,
-                         const float undoValue);
+            VoxelBlock(const int64_t blockIJK[3]);
+            
+            void compact();
             
-            ~VoxelMemento();
+            void expand();
             
-            int64_t m_ijk[3];
+            int64_t m_firstIJK[3];
             
-            float m_redoValue;
+            uint64_t m_mask[8];
             
-            float m_undoValue;
+            std::vector<float> m_redoValues;
+            
+            std::vector<float> m_undoValues;
         };
         
         VolumeMapUndoCommand(const VolumeMapUndoCommand&);
 
         VolumeMapUndoCommand& operator=(const VolumeMapUndoCommand&);
         
+        void applyValues(const bool redoFlag);
+        
         VolumeFile* m_volumeFile;
         
         const int32_t m_mapIndex;
         
-        std::vector<VoxelMemento*> m_voxelMementos;
+        int64_t m_dimensions[3];
+        
+        int64_t m_blockDimensions[3];
+        
+        std::vector<VoxelBlock*> m_voxelBlocks;
+        
+        /** Index into m_voxelBlocks for each block index */
+        std::map<int64_t, int32_t> m_blockLookup;
+        
+        /** Index of block most recently added to, consecutive voxels are usually in the same block */
+        int64_t m_lastBlockIndex;
+        
+        int32_t m_lastBlockVectorIndex;
+        
+        int64_t m_voxelCount;
+        
+        bool m_compactedFlag;
         
         // ADD_NEW_MEMBERS_HERE
 
@@ -0,0 +1,258 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2016  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "VolumeResamplePlan.h"
+
+#include "CaretAssert.h"
+#include "CaretException.h"
+#include "CaretLogger.h"
+#include "CaretMutex.h"
+#include "CaretOMP.h"
+#include "VolumeSpline.h"
+
+#include <cmath>
+
+using namespace caret;
+using namespace std;
+
+namespace
+{
+    const int64_t SPLINE_MEMORY_BYTES = ((int64_t)1) << 28;//limit on deconvolved frames plus output frames of a batch in memory at once
+}
+
+VolumeResamplePlan::VolumeResamplePlan(const VolumeSpace& inSpace, const int64_t outDims[3], const VolumeFile::InterpType& method)
+{
+    m_inSpace = inSpace;
+    const int64_t* inDims = m_inSpace.getDims();
+    m_method = method;
+    if (inDims[0] == 1 || inDims[1] == 1 || inDims[2] == 1)
+    {
+        m_method = VolumeFile::ENCLOSING_VOXEL;//same as interpolateValue, the others need neighboring slices
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        m_outDims[i] = outDims[i];
+    }
+    const int64_t outFrameSize = m_outDims[0] * m_outDims[1] * m_outDims[2];
+    m_offsets.resize(outFrameSize, -1);
+    if (m_method != VolumeFile::ENCLOSING_VOXEL)
+    {
+        m_positions.resize(outFrameSize * 3, 0.0f);
+    }
+}
+
+void VolumeResamplePlan::setSourceCoordinate(const int64_t& i, const int64_t& j, const int64_t& k, const float coord[3])
+{
+    const int64_t outIndex = i + m_outDims[0] * (j + m_outDims[1] * k);
+    CaretAssertVectorIndex(m_offsets, outIndex);
+    const int64_t* inDims = m_inSpace.getDims();
+    if (m_method == VolumeFile::ENCLOSING_VOXEL)
+    {
+        int64_t index[3];
+        m_inSpace.enclosingVoxel(coord, index);
+        m_offsets[outIndex] = (m_inSpace.indexValid(index) ? m_inSpace.getIndex(index) : -1);
+        return;
+    }
+    float index[3];
+    m_inSpace.spaceToIndex(coord, index);
+    int64_t low[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        low[axis] = (int64_t)floor(index[axis]);
+    }
+    if (!m_inSpace.indexValid(low) || !m_inSpace.indexValid(low[0] + 1, low[1] + 1, low[2] + 1))
+    {
+        m_offsets[outIndex] = -1;
+        return;
+    }
+    m_offsets[outIndex] = low[0] + inDims[0] * (low[1] + inDims[1] * low[2]);
+    float* position = m_positions.data() + outIndex * 3;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        if (m_method == VolumeFile::TRILINEAR)
+        {
+            position[axis] = index[axis] - low[axis];
+        } else {
+            position[axis] = index[axis];
+        }
+    }
+}
+
+void VolumeResamplePlan::setInvalid(const int64_t& i, const int64_t& j, const int64_t& k)
+{
+    const int64_t outIndex = i + m_outDims[0] * (j + m_outDims[1] * k);
+    CaretAssertVectorIndex(m_offsets, outIndex);
+    m_offsets[outIndex] = -1;
+}
+
+void VolumeResamplePlan::sampleFrame(const float* inFrame, float* outFrame, const int64_t& start, const int64_t& end) const
+{
+    const int64_t* inDims = m_inSpace.getDims();
+    const int64_t jStep = inDims[0], kStep = inDims[0] * inDims[1];
+    switch (m_method)
+    {
+        case VolumeFile::ENCLOSING_VOXEL:
+            for (int64_t v = start; v < end; ++v)
+            {
+                const int64_t offset = m_offsets[v];
+                outFrame[v] = (offset < 0 ? VolumeFile::INVALID_INTERP_VALUE : inFrame[offset]);
+            }
+            break;
+        case VolumeFile::TRILINEAR:
+            for (int64_t v = start; v < end; ++v)
+            {
+                const int64_t offset = m_offsets[v];
+                if (offset < 0)
+                {
+                    outFrame[v] = VolumeFile::INVALID_INTERP_VALUE;
+                    continue;
+                }
+                const float* position = m_positions.data() + v * 3;
+                const float* corner = inFrame + offset;//same operation order as interpolateValue, so results are identical
+                float xhighWeight = position[0], xlowWeight = 1.0f - xhighWeight;
+                float xinterp00 = xlowWeight * corner[0] + xhighWeight * corner[1];
+                float xinterp10 = xlowWeight * corner[jStep] + xhighWeight * corner[jStep + 1];
+                float xinterp01 = xlowWeight * corner[kStep] + xhighWeight * corner[kStep + 1];
+                float xinterp11 = xlowWeight * corner[jStep + kStep] + xhighWeight * corner[jStep + kStep + 1];
+                float yhighWeight = position[1], ylowWeight = 1.0f - yhighWeight;
+                float yinterp0 = ylowWeight * xinterp00 + yhighWeight * xinterp10;
+                float yinterp1 = ylowWeight * xinterp01 + yhighWeight * xinterp11;
+                float zhighWeight = position[2], zlowWeight = 1.0f - zhighWeight;
+                outFrame[v] = zlowWeight * yinterp0 + zhighWeight * yinterp1;
+            }
+            break;
+        case VolumeFile::CUBIC:
+            CaretAssert(false);//done by resampleCubic
+            break;
+    }
+}
+
+void VolumeResamplePlan::resampleCubic(const VolumeFile* inVol, VolumeFile* outVol) const
+{
+    const int64_t* inDims = inVol->getDimensionsPtr();
+    const int64_t numFrames = inDims[3] * inDims[4], outFrameSize = m_outDims[0] * m_outDims[1] * m_outDims[2];
+    const int64_t batchFrames = min(numFrames, VolumeSplineBatch::getFramesPerBatch(inDims, SPLINE_MEMORY_BYTES, outFrameSize * sizeof(float)));//when upsampling, the output frames are the larger part
+    vector<vector<float> > outFrames(batchFrames, vector<float>(outFrameSize));
+    bool ignoredNonNumeric = false;
+    for (int64_t firstFrame = 0; firstFrame < numFrames; firstFrame += batchFrames)
+    {
+        const int64_t numBatch = min(batchFrames, numFrames - firstFrame);
+        vector<const float*> inFrames(numBatch);
+        for (int64_t f = 0; f < numBatch; ++f)
+        {
+            inFrames[f] = inVol->getFrame((firstFrame + f) % inDims[3], (firstFrame + f) / inDims[3]);
+        }
+        VolumeSplineBatch mySplines(inFrames, inDims);//deconvolution is parallel inside
+        if (mySplines.ignoredNonNumeric()) ignoredNonNumeric = true;
+        const int64_t blockSize = 1024;
+#pragma omp CARET_PAR
+        {
+            vector<float> values(numBatch);
+#pragma omp CARET_FOR schedule(dynamic)
+            for (int64_t start = 0; start < outFrameSize; start += blockSize)
+            {
+                const int64_t end = min(start + blockSize, outFrameSize);
+                for (int64_t v = start; v < end; ++v)
+                {
+                    if (m_offsets[v] < 0)
+                    {
+                        for (int64_t f = 0; f < numBatch; ++f)
+                        {
+                            outFrames[f][v] = VolumeFile::INVALID_INTERP_VALUE;
+                        }
+                    } else {
+                        mySplines.sample(m_positions.data() + v * 3, values.data());//all frames of the batch at once
+                        for (int64_t f = 0; f < numBatch; ++f)
+                        {
+                            outFrames[f][v] = values[f];
+                        }
+                    }
+                }
+            }
+        }
+        for (int64_t f = 0; f < numBatch; ++f)
+        {
+            outVol->setFrame(outFrames[f].data(), (firstFrame + f) % inDims[3], (firstFrame + f) / inDims[3]);
+        }
+    }
+    if (ignoredNonNumeric)
+    {
+        CaretLogWarning("ignored non-numeric input value when calculating cubic splines in volume '" + inVol->getFileName() + "'");
+    }
+}
+
+void VolumeResamplePlan::resample(const VolumeFile* inVol, VolumeFile* outVol) const
+{
+    const int64_t* inDims = inVol->getDimensionsPtr();
+    const int64_t* outDims = outVol->getDimensionsPtr();
+    CaretAssert(inVol->getVolumeSpace() == m_inSpace);
+    if (outDims[0] != m_outDims[0] || outDims[1] != m_outDims[1] || outDims[2] != m_outDims[2] ||
+        outDims[3] != inDims[3] || outDims[4] != inDims[4])
+    {
+        throw CaretException("output volume does not match the resampling plan");
+    }
+    if (m_method == VolumeFile::CUBIC)
+    {
+        resampleCubic(inVol, outVol);
+        return;
+    }
+    const int64_t numFrames = inDims[3] * inDims[4], outFrameSize = m_outDims[0] * m_outDims[1] * m_outDims[2];
+    int numThreads = 1;
+#ifdef CARET_OMP
+    numThreads = omp_get_max_threads();
+#endif
+    if (numFrames >= numThreads)
+    {//each thread does whole frames
+        AString errorMessage;
+        CaretMutex errorMutex;
+#pragma omp CARET_PAR
+        {
+            vector<float> outFrame(outFrameSize);
+#pragma omp CARET_FOR schedule(dynamic)
+            for (int64_t f = 0; f < numFrames; ++f)
+            {
+                try
+                {
+                    const int64_t b = f % inDims[3], c = f / inDims[3];
+                    sampleFrame(inVol->getFrame(b, c), outFrame.data(), 0, outFrameSize);
+                    outVol->setFrame(outFrame.data(), b, c);
+                } catch (CaretException& e) {//don't let exceptions escape the parallel region
+                    CaretMutexLocker locked(&errorMutex);
+                    errorMessage = e.whatString();
+                }
+            }
+        }
+        if (!errorMessage.isEmpty()) throw CaretException(errorMessage);
+    } else {
+        vector<float> outFrame(outFrameSize);
+        const int64_t blockSize = 4096;
+        for (int64_t f = 0; f < numFrames; ++f)
+        {
+            const int64_t b = f % inDims[3], c = f / inDims[3];
+            const float* inFrame = inVol->getFrame(b, c);
+#pragma omp CARET_PARFOR schedule(dynamic)
+            for (int64_t start = 0; start < outFrameSize; start += blockSize)
+            {
+                sampleFrame(inFrame, outFrame.data(), start, min(start + blockSize, outFrameSize));
+            }
+            outVol->setFrame(outFrame.data(), b, c);
+        }
+    }
+}
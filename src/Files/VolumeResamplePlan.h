@@ -0,0 +1,58 @@
+#ifndef __VOLUME_RESAMPLE_PLAN_H__
+#define __VOLUME_RESAMPLE_PLAN_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2016  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "VolumeFile.h"
+#include "VolumeSpace.h"
+
+#include "stdint.h"
+#include <vector>
+
+namespace caret {
+
+    ///where each output voxel samples the input, computed once and then applied to every frame
+    ///gives the same values as VolumeFile::interpolateValue at the same coordinates
+    class VolumeResamplePlan
+    {
+        VolumeSpace m_inSpace;
+        int64_t m_outDims[3];
+        VolumeFile::InterpType m_method;
+        std::vector<int64_t> m_offsets;//input frame offset of the enclosing voxel or the low corner, -1 for outside the input
+        std::vector<float> m_positions;//3 per output voxel, TRILINEAR: position within the low corner voxel, CUBIC: input index coordinates
+        void sampleFrame(const float* inFrame, float* outFrame, const int64_t& start, const int64_t& end) const;
+        void resampleCubic(const VolumeFile* inVol, VolumeFile* outVol) const;//splines of batches of frames, sampled together
+    public:
+        VolumeResamplePlan(const VolumeSpace& inSpace, const int64_t outDims[3], const VolumeFile::InterpType& method);
+
+        ///set the input coordinate an output voxel samples, can be called in parallel for different voxels
+        void setSourceCoordinate(const int64_t& i, const int64_t& j, const int64_t& k, const float coord[3]);
+
+        ///output voxel gets VolumeFile::INVALID_INTERP_VALUE
+        void setInvalid(const int64_t& i, const int64_t& j, const int64_t& k);
+
+        ///resample every frame of inVol into outVol, which must already have the output dimensions and the same number of frames
+        void resample(const VolumeFile* inVol, VolumeFile* outVol) const;
+    };
+
+}
+
+#endif //__VOLUME_RESAMPLE_PLAN_H__
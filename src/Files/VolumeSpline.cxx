@@ -258,3 +258,208 @@ void VolumeSpline::predeconvolve(float* backsubs, const int64_t& length)
         backsubs[i] = A / (B - A * backsubs[i - 1]);
     }
 }
+
+namespace
+{
+    const int FRAME_BLOCK = 16;//frames sampled together, accumulators for this many frames should fit in registers
+}
+
+VolumeSplineBatch::VolumeSplineBatch()
+{
+    m_ignoredNonNumeric = false;
+    m_dims[0] = 0;
+    m_dims[1] = 0;
+    m_dims[2] = 0;
+    m_numFrames = 0;
+}
+
+VolumeSplineBatch::VolumeSplineBatch(const vector<const float*>& frames, const int64_t framedims[3])
+{
+    m_ignoredNonNumeric = false;
+    m_dims[0] = framedims[0];
+    m_dims[1] = framedims[1];
+    m_dims[2] = framedims[2];
+    m_numFrames = (int64_t)frames.size();
+    const int64_t frameSize = m_dims[0] * m_dims[1] * m_dims[2];
+    m_deconv = CaretArray<float>(frameSize * m_numFrames);
+    float* data = m_deconv.getArray();
+    bool ignored = false;
+#pragma omp CARET_PARFOR schedule(static)
+    for (int64_t v = 0; v < frameSize; ++v)
+    {
+        float* voxelData = data + v * m_numFrames;
+        for (int64_t f = 0; f < m_numFrames; ++f)
+        {
+            float tempf = frames[f][v];
+            if (MathFunctions::isNumeric(tempf))
+            {
+                voxelData[f] = tempf;
+            } else {
+                voxelData[f] = 0.0f;
+                ignored = true;//only ever set to true, so the race doesn't matter
+            }
+        }
+    }
+    m_ignoredNonNumeric = ignored;
+    const int64_t CHUNK = 1024;//split long lines into pieces that stay in cache, and to have enough parallel tasks
+    CaretArray<float> backsubs(max(m_dims[0], max(m_dims[1], m_dims[2])));
+    //i lines: the elements of each line are the frames of one voxel
+    VolumeSpline::predeconvolve(backsubs, m_dims[0]);
+    const int64_t iLineWidth = m_numFrames, numILines = m_dims[1] * m_dims[2];
+#pragma omp CARET_PARFOR schedule(dynamic)
+    for (int64_t line = 0; line < numILines; ++line)
+    {
+        deconvolveLines(data + line * m_dims[0] * iLineWidth, backsubs, m_dims[0], iLineWidth, iLineWidth);
+    }
+    //j lines: the elements are entire i rows, so all memory access is contiguous
+    VolumeSpline::predeconvolve(backsubs, m_dims[1]);
+    const int64_t jLineWidth = m_dims[0] * m_numFrames, jChunks = (jLineWidth + CHUNK - 1) / CHUNK;
+#pragma omp CARET_PARFOR schedule(dynamic)
+    for (int64_t task = 0; task < m_dims[2] * jChunks; ++task)
+    {
+        const int64_t k = task / jChunks, start = (task % jChunks) * CHUNK;
+        deconvolveLines(data + k * m_dims[1] * jLineWidth + start, backsubs, m_dims[1], jLineWidth, min(CHUNK, jLineWidth - start));
+    }
+    //k lines: the elements are entire slices
+    VolumeSpline::predeconvolve(backsubs, m_dims[2]);
+    const int64_t kLineWidth = m_dims[0] * m_dims[1] * m_numFrames, kChunks = (kLineWidth + CHUNK - 1) / CHUNK;
+#pragma omp CARET_PARFOR schedule(dynamic)
+    for (int64_t task = 0; task < kChunks; ++task)
+    {
+        const int64_t start = task * CHUNK;
+        deconvolveLines(data + start, backsubs, m_dims[2], kLineWidth, min(CHUNK, kLineWidth - start));
+    }
+}
+
+int64_t VolumeSplineBatch::getFramesPerBatch(const int64_t framedims[3], const int64_t& memoryLimitBytes, const int64_t& extraBytesPerFrame)
+{
+    const int64_t frameBytes = framedims[0] * framedims[1] * framedims[2] * sizeof(float) + extraBytesPerFrame;
+    if (frameBytes < 1) return 1;
+    return max((int64_t)1, memoryLimitBytes / frameBytes);
+}
+
+void VolumeSplineBatch::deconvolveLines(float* data, const float* backsubs, const int64_t& length, const int64_t& stride, const int64_t& width)
+{//same arithmetic as VolumeSpline::deconvolve, on width independent lines whose elements are stride apart
+    if (length < 1) return;
+    const float A = 1.0f / 6.0f, B = 2.0f / 3.0f;
+    for (int64_t w = 0; w < width; ++w)
+    {
+        data[w] /= B + A;
+    }
+    if (length < 2) return;
+    for (int64_t i = 1; i < length - 1; ++i)
+    {
+        float* current = data + i * stride;
+        const float* previous = current - stride;
+        const float divisor = B - A * backsubs[i - 1];
+        for (int64_t w = 0; w < width; ++w)
+        {
+            current[w] = (current[w] - A * previous[w]) / divisor;
+        }
+    }
+    {
+        float* current = data + (length - 1) * stride;
+        const float* previous = current - stride;
+        const float divisor = B + A - A * backsubs[length - 2];
+        for (int64_t w = 0; w < width; ++w)
+        {
+            current[w] = (current[w] - A * previous[w]) / divisor;
+        }
+    }
+    for (int64_t i = length - 2; i >= 0; --i)
+    {
+        float* current = data + i * stride;
+        const float* next = current + stride;
+        const float backsub = backsubs[i];
+        for (int64_t w = 0; w < width; ++w)
+        {
+            current[w] -= backsub * next[w];
+        }
+    }
+}
+
+template <int BLOCK>
+void VolumeSplineBatch::sampleBlock(const float* data, const int64_t& lowi, const int64_t& lowj, const int64_t& lowk,
+                                    const int& istart, const int& iend, const int& jstart, const int& jend, const int& kstart, const int& kend,
+                                    const float iweights[4], const float jweights[4], const float kweights[4], float* valuesOut) const
+{
+    float ksum[BLOCK], jsum[BLOCK], isum[BLOCK];//summed in the same order as VolumeSpline::sample, so the results are identical
+    for (int f = 0; f < BLOCK; ++f) ksum[f] = 0.0f;
+    for (int k = kstart; k < kend; ++k)
+    {
+        for (int f = 0; f < BLOCK; ++f) jsum[f] = 0.0f;
+        for (int j = jstart; j < jend; ++j)
+        {
+            for (int f = 0; f < BLOCK; ++f) isum[f] = 0.0f;
+            const int64_t rowIndex = m_dims[0] * (lowj - 1 + j + m_dims[1] * (lowk - 1 + k)) + lowi - 1;
+            for (int i = istart; i < iend; ++i)
+            {
+                const float* voxelData = data + (rowIndex + i) * m_numFrames;
+                for (int f = 0; f < BLOCK; ++f)
+                {
+                    isum[f] += voxelData[f] * iweights[i];
+                }
+            }
+            for (int f = 0; f < BLOCK; ++f)
+            {
+                jsum[f] += isum[f] * jweights[j];
+            }
+        }
+        for (int f = 0; f < BLOCK; ++f)
+        {
+            ksum[f] += jsum[f] * kweights[k];
+        }
+    }
+    for (int f = 0; f < BLOCK; ++f)
+    {
+        valuesOut[f] = ksum[f];
+    }
+}
+
+void VolumeSplineBatch::sample(const float& ifloat, const float& jfloat, const float& kfloat, float* valuesOut) const
+{
+    if (m_dims[0] < 2 || ifloat < 0.0f || jfloat < 0.0f || kfloat < 0.0f || ifloat > m_dims[0] - 1 || jfloat > m_dims[1] - 1 || kfloat > m_dims[2] - 1)
+    {
+        for (int64_t f = 0; f < m_numFrames; ++f)
+        {
+            valuesOut[f] = 0.0f;
+        }
+        return;
+    }
+    float iparti, ipartj, ipartk;
+    float fparti = modf(ifloat, &iparti);
+    float fpartj = modf(jfloat, &ipartj);
+    float fpartk = modf(kfloat, &ipartk);
+    int64_t lowi = (int64_t)iparti;
+    int64_t lowj = (int64_t)ipartj;
+    int64_t lowk = (int64_t)ipartk;
+    bool lowedgei = (lowi < 1);
+    bool lowedgej = (lowj < 1);
+    bool lowedgek = (lowk < 1);
+    bool highedgei = (lowi >= m_dims[0] - 2);
+    bool highedgej = (lowj >= m_dims[1] - 2);
+    bool highedgek = (lowk >= m_dims[2] - 2);
+    CubicSpline ispline = CubicSpline::bspline(fparti, lowedgei, highedgei);
+    CubicSpline jspline = CubicSpline::bspline(fpartj, lowedgej, highedgej);
+    CubicSpline kspline = CubicSpline::bspline(fpartk, lowedgek, highedgek);
+    const int istart = lowedgei ? 1 : 0, iend = highedgei ? 3 : 4;
+    const int jstart = lowedgej ? 1 : 0, jend = highedgej ? 3 : 4;
+    const int kstart = lowedgek ? 1 : 0, kend = highedgek ? 3 : 4;
+    const float* data = m_deconv.getArray();
+    float iweights[4], jweights[4], kweights[4];
+    for (int t = 0; t < 4; ++t)
+    {
+        iweights[t] = ispline.getWeight(t);
+        jweights[t] = jspline.getWeight(t);
+        kweights[t] = kspline.getWeight(t);
+    }
+    int64_t firstFrame = 0;
+    for (; firstFrame + FRAME_BLOCK <= m_numFrames; firstFrame += FRAME_BLOCK)
+    {//constant trip count so the frame loops vectorize
+        sampleBlock<FRAME_BLOCK>(data + firstFrame, lowi, lowj, lowk, istart, iend, jstart, jend, kstart, kend, iweights, jweights, kweights, valuesOut + firstFrame);
+    }
+    for (; firstFrame < m_numFrames; ++firstFrame)
+    {
+        sampleBlock<1>(data + firstFrame, lowi, lowj, lowk, istart, iend, jstart, jend, kstart, kend, iweights, jweights, kweights, valuesOut + firstFrame);
+    }
+}
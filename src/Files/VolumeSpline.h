@@ -24,6 +24,8 @@
 #include "stdint.h"
 #include "CaretPointer.h"
 
+#include <vector>
+
 namespace caret {
     
     class VolumeSpline
@@ -32,7 +34,8 @@ namespace caret {
         int64_t m_dims[3];
         CaretArray<float> m_deconv;//don't do lazy deconvolution, it doesn't save much time, and takes more memory and slightly longer if you have to do the whole volume anyway
         void deconvolve(float* data, const float* backsubs, const int64_t& length);//use CaretArray so that it doesn't reallocate like a vector on copy, and the data is static once computed
-        void predeconvolve(float* backsubs, const int64_t& length);//since the back substitution on the same size array uses the same coefficients, precompute them
+        static void predeconvolve(float* backsubs, const int64_t& length);//since the back substitution on the same size array uses the same coefficients, precompute them
+        friend class VolumeSplineBatch;
     public:
         VolumeSpline();
         VolumeSpline(const float* frame, const int64_t framedims[3]);
@@ -41,6 +44,31 @@ namespace caret {
         bool ignoredNonNumeric() const { return m_ignoredNonNumeric; }
     };
     
+    ///splines of several frames, interleaved so that deconvolution and sampling work on all frames at once
+    ///gives the same values as a VolumeSpline of each frame
+    class VolumeSplineBatch
+    {
+        bool m_ignoredNonNumeric;
+        int64_t m_dims[3];
+        int64_t m_numFrames;
+        CaretArray<float> m_deconv;//frame varies fastest, then i, j, k
+        static void deconvolveLines(float* data, const float* backsubs, const int64_t& length, const int64_t& stride, const int64_t& width);
+        template <int BLOCK>
+        void sampleBlock(const float* data, const int64_t& lowi, const int64_t& lowj, const int64_t& lowk,
+                         const int& istart, const int& iend, const int& jstart, const int& jend, const int& kstart, const int& kend,
+                         const float iweights[4], const float jweights[4], const float kweights[4], float* valuesOut) const;
+    public:
+        VolumeSplineBatch();
+        VolumeSplineBatch(const std::vector<const float*>& frames, const int64_t framedims[3]);
+        ///how many frames of this size fit in the memory limit, at least 1, extraBytesPerFrame is for anything the caller keeps per frame of the batch
+        static int64_t getFramesPerBatch(const int64_t framedims[3], const int64_t& memoryLimitBytes, const int64_t& extraBytesPerFrame = 0);
+        ///valuesOut must have room for one value per frame
+        void sample(const float& i, const float& j, const float& k, float* valuesOut) const;
+        void sample(const float ijk[3], float* valuesOut) const { sample(ijk[0], ijk[1], ijk[2], valuesOut); }
+        int64_t getNumberOfFrames() const { return m_numFrames; }
+        bool ignoredNonNumeric() const { return m_ignoredNonNumeric; }
+    };
+    
 }
 
 #endif //__VOLUME_SPLINE_H__
@@ -33,11 +33,38 @@
 using namespace caret;
 using namespace std;
 
+namespace
+{
+    CaretMutex retiredFramesMutex;
+    vector<vector<float> > retiredFrames;//evicted on-demand frames, freed when nothing is using frames
+    int64_t frameUseDepth = 0;
+}
+
 AbstractHeader::~AbstractHeader()
 {
 }
 
+VolumeFrameLoader::~VolumeFrameLoader()
+{
+}
+
 void VolumeBase::reinitialize(const vector<int64_t>& dimensionsIn, const vector<vector<float> >& indexToSpace, const int64_t numComponents)
+{
+    int64_t storeDims[5];
+    setupDimensions(dimensionsIn, indexToSpace, numComponents, storeDims);
+    m_storage.reinitialize(storeDims);
+}
+
+void VolumeBase::reinitializeOnDemand(const vector<int64_t>& dimensionsIn, const vector<vector<float> >& indexToSpace,
+                                      VolumeFrameLoader* loader, const int64_t& maxCachedFrames)
+{
+    CaretPointer<VolumeFrameLoader> loaderPointer(loader);//don't leak it if setupDimensions throws
+    int64_t storeDims[5];
+    setupDimensions(dimensionsIn, indexToSpace, 1, storeDims);
+    m_storage.reinitializeOnDemand(storeDims, loaderPointer.releasePointer(), maxCachedFrames);
+}
+
+void VolumeBase::setupDimensions(const vector<int64_t>& dimensionsIn, const vector<vector<float> >& indexToSpace, const int64_t numComponents, int64_t storeDims[5])
 {
     CaretAssert(numComponents > 0);
     clear();
@@ -47,7 +74,6 @@ void VolumeBase::reinitialize(const vector<int64_t>& dimensionsIn, const vector<
         throw DataFileException("volume files must have 3 or more dimensions");
     }
     m_origDims = dimensionsIn;//save the original dimensions
-    int64_t storeDims[5];
     storeDims[3] = 1;
     for (int i = 0; i < numDims; ++i)
     {
@@ -64,7 +90,6 @@ void VolumeBase::reinitialize(const vector<int64_t>& dimensionsIn, const vector<
         throw DataFileException("this file doesn't appear to be a volume file");
     }
     storeDims[4] = numComponents;
-    m_storage.reinitialize(storeDims);
 }
 
 void VolumeBase::addSubvolumes(const int64_t& numToAdd)
@@ -354,10 +379,13 @@ VolumeBase::VolumeStorage::VolumeStorage()
         m_dimensions[i] = 0;
         m_mult[i] = 0;
     }
+    m_onDemand = false;
+    m_maxCachedFrames = -1;
 }
 
 void VolumeBase::VolumeStorage::reinitialize(int64_t dims[5])
 {
+    clearOnDemand();
     for (int i = 0; i < 5; ++i)
     {
         CaretAssert(dims[i] > 0);//stop the debugger in the right place
@@ -374,16 +402,136 @@ void VolumeBase::VolumeStorage::reinitialize(int64_t dims[5])
 
 VolumeBase::VolumeStorage::VolumeStorage(int64_t dims[5])
 {
+    m_onDemand = false;
+    m_maxCachedFrames = -1;
     reinitialize(dims);
 }
 
+void VolumeBase::VolumeStorage::reinitializeOnDemand(int64_t dims[5], VolumeFrameLoader* loader, const int64_t& maxCachedFrames)
+{
+    CaretAssert(loader != NULL);
+    clearOnDemand();
+    m_frameLoader.grabNew(loader);//take ownership before anything can throw
+    for (int i = 0; i < 5; ++i)
+    {
+        CaretAssert(dims[i] > 0);
+        if (dims[i] < 1) throw DataFileException("VolumeStorage dimensions must be positive");
+        m_dimensions[i] = dims[i];
+    }
+    m_mult[0] = m_dimensions[0];
+    for (int i = 1; i < 5; ++i)
+    {
+        m_mult[i] = m_mult[i - 1] * m_dimensions[i];
+    }
+    vector<float>().swap(m_data);//release the memory
+    const int64_t numFrames = m_dimensions[3] * m_dimensions[4];
+    m_frames.resize(numFrames);
+    m_framePointers.resize(numFrames, QAtomicPointer<float>(NULL));
+    m_framePinned.resize(numFrames, QAtomicInt(0));
+    m_maxCachedFrames = maxCachedFrames;
+    m_onDemand = true;
+}
+
+void VolumeBase::VolumeStorage::clearOnDemand()
+{
+    m_onDemand = false;
+    m_frameLoader.grabNew(NULL);
+    m_frames.clear();
+    m_framePointers.clear();
+    m_framePinned.clear();
+    m_frameLoadOrder.clear();
+    m_maxCachedFrames = -1;
+}
+
+float* VolumeBase::VolumeStorage::loadFrame(const int64_t& frameIndex, const bool& forWriting, const bool& needData) const
+{
+    CaretAssert(m_onDemand && frameIndex >= 0 && frameIndex < (int64_t)m_frames.size());
+    CaretMutexLocker locked(&m_frameMutex);//frames may be used from multiple threads
+    float* ret = m_framePointers[frameIndex];
+    if (ret == NULL)
+    {
+        if (m_maxCachedFrames > 0)
+        {
+            while ((int64_t)m_frameLoadOrder.size() >= m_maxCachedFrames)
+            {
+                const int64_t oldest = m_frameLoadOrder.front();
+                m_frameLoadOrder.pop_front();
+                if (m_framePinned[oldest] == 0)
+                {//other threads, or this one further up the stack, may still be using the frame, so only retire it
+                    m_framePointers[oldest].fetchAndStoreRelease(NULL);
+                    CaretMutexLocker retiredLocked(&retiredFramesMutex);
+                    if (frameUseDepth > 0)
+                    {
+                        retiredFrames.push_back(vector<float>());
+                        retiredFrames.back().swap(m_frames[oldest]);
+                    } else {//nothing declared frame use, so the caller doesn't hold frame pointers across loads
+                        vector<float>().swap(m_frames[oldest]);
+                    }
+                }
+            }
+        }
+        m_frames[frameIndex].resize(m_mult[2]);
+        if (needData)
+        {
+            if (m_frameLoader == NULL) throw DataFileException("volume frame was released after its file was closed");//loadAllFrames() pins everything, so this shouldn't happen
+            m_frameLoader->loadFrame(frameIndex % m_dimensions[3], frameIndex / m_dimensions[3], m_frames[frameIndex].data());
+        }
+        ret = m_frames[frameIndex].data();
+        m_framePointers[frameIndex].fetchAndStoreRelease(ret);//only after the data is there, other threads check this without the mutex
+        m_frameLoadOrder.push_back(frameIndex);
+    }
+    if (forWriting) m_framePinned[frameIndex].fetchAndStoreRelease(1);
+    return ret;
+}
+
+void VolumeBase::beginFrameUse()
+{
+    CaretMutexLocker locked(&retiredFramesMutex);
+    ++frameUseDepth;
+}
+
+void VolumeBase::endFrameUse()
+{
+    vector<vector<float> > toFree;
+    {
+        CaretMutexLocker locked(&retiredFramesMutex);
+        CaretAssert(frameUseDepth > 0);
+        --frameUseDepth;
+        if (frameUseDepth > 0) return;
+        toFree.swap(retiredFrames);
+    }
+}//frees them outside the lock
+
+void VolumeBase::VolumeStorage::loadAllFrames()
+{
+    if (!m_onDemand) return;
+    const int64_t numFrames = (int64_t)m_frames.size();
+    for (int64_t i = 0; i < numFrames; ++i)
+    {
+        loadFrame(i, true, true);//pin them all, since they can't be reloaded
+    }
+    CaretMutexLocker locked(&m_frameMutex);
+    m_frameLoader.grabNew(NULL);
+    m_frameLoadOrder.clear();
+}
+
 const float* VolumeBase::VolumeStorage::getFrame(const int64_t brickIndex, const int64_t component) const
 {
+    if (m_onDemand) return getLoadedFrame(brickIndex, component);
     return m_data.data() + brickIndex * m_mult[2] + component * m_mult[3];//NOTE: do not use [4]
 }
 
 void VolumeBase::VolumeStorage::setFrame(const float* frameIn, const int64_t brickIndex, const int64_t component)
 {
+    if (m_onDemand)
+    {
+        float* myFrame = getWritableFrame(brickIndex, component, false);//the old data doesn't matter
+        for (int64_t i = 0; i < m_mult[2]; ++i)
+        {
+            myFrame[i] = frameIn[i];
+        }
+        return;
+    }
     int64_t start = brickIndex * m_mult[2] + component * m_mult[3];
     for (int64_t i = 0; i < m_mult[2]; ++i)
     {
@@ -391,8 +539,40 @@ void VolumeBase::VolumeStorage::setFrame(const float* frameIn, const int64_t bri
     }
 }
 
+void VolumeBase::VolumeStorage::setFrameValues(const int64_t* frameOffsets, const float* values, const int64_t& count, const int64_t brickIndex, const int64_t component)
+{
+    CaretAssert(indexValid(0, 0, 0, brickIndex, component));
+    float* myFrame;
+    if (m_onDemand)
+    {
+        myFrame = getWritableFrame(brickIndex, component);
+    } else {
+        myFrame = m_data.data() + brickIndex * m_mult[2] + component * m_mult[3];
+    }
+    for (int64_t i = 0; i < count; ++i)
+    {
+        CaretAssert(frameOffsets[i] >= 0 && frameOffsets[i] < m_mult[2]);
+        myFrame[frameOffsets[i]] = values[i];
+    }
+}
+
 void VolumeBase::VolumeStorage::setValueAllVoxels(const float value)
 {
+    if (m_onDemand)
+    {
+        for (int64_t c = 0; c < m_dimensions[4]; ++c)
+        {
+            for (int64_t b = 0; b < m_dimensions[3]; ++b)
+            {
+                float* myFrame = getWritableFrame(b, c, false);
+                for (int64_t i = 0; i < m_mult[2]; ++i)
+                {
+                    myFrame[i] = value;
+                }
+            }
+        }
+        return;
+    }
     for (int64_t i = 0; i < m_mult[4]; ++i)
     {
         m_data[i] = value;
@@ -407,6 +587,15 @@ void VolumeBase::VolumeStorage::swap(VolumeStorage& rhs)
         std::swap(m_dimensions[i], rhs.m_dimensions[i]);
         std::swap(m_mult[i], rhs.m_mult[i]);
     }
+    std::swap(m_onDemand, rhs.m_onDemand);
+    CaretPointer<VolumeFrameLoader> tempLoader = m_frameLoader;
+    m_frameLoader = rhs.m_frameLoader;
+    rhs.m_frameLoader = tempLoader;
+    m_frames.swap(rhs.m_frames);
+    m_framePointers.swap(rhs.m_framePointers);
+    m_framePinned.swap(rhs.m_framePinned);
+    m_frameLoadOrder.swap(rhs.m_frameLoadOrder);
+    std::swap(m_maxCachedFrames, rhs.m_maxCachedFrames);
 }
 
 void VolumeBase::VolumeStorage::getDimensions(vector<int64_t>& dimOut) const
@@ -436,6 +625,7 @@ vector<int64_t> VolumeBase::VolumeStorage::getDimensions() const
 
 void VolumeBase::VolumeStorage::clear()
 {
+    clearOnDemand();
     m_data.clear();
     for (int i = 0; i < 5; ++i)
     {
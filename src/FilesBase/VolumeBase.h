@@ -23,12 +23,17 @@
 /*LICENSE_END*/
 
 #include "stdint.h"
+#include <deque>
 #include <vector>
 #include "CaretAssert.h"
+#include "CaretMutex.h"
 #include "CaretPointer.h"
 #include "VolumeMappableInterface.h"
 #include "VolumeSpace.h"
 
+#include <QAtomicInt>
+#include <QAtomicPointer>
+
 namespace caret {
 
     struct AbstractHeader
@@ -42,6 +47,14 @@ namespace caret {
         virtual ~AbstractHeader();
     };
     
+    ///reads frames for volumes that load each frame when it is first used
+    class VolumeFrameLoader
+    {
+    public:
+        virtual void loadFrame(const int64_t& brickIndex, const int64_t& component, float* frameOut) = 0;
+        virtual ~VolumeFrameLoader();
+    };
+    
     class VolumeBase : public VolumeMappableInterface
     {
         class VolumeStorage
@@ -49,14 +62,47 @@ namespace caret {
             std::vector<float> m_data;
             int64_t m_dimensions[5];//store internally as 4d+component
             int64_t m_mult[5];//precalculated multipliers for getIndex/getValue/setValue - NOTE: [0] is for index[1], [4] is the entire size of the data
+            
+            //loading frames on demand: each frame is allocated separately when first used, and m_data is empty
+            bool m_onDemand;
+            CaretPointer<VolumeFrameLoader> m_frameLoader;//NULL after loadAllFrames()
+            mutable std::vector<std::vector<float> > m_frames;
+            mutable std::vector<QAtomicPointer<float> > m_framePointers;//NULL until loaded, so that using a loaded frame doesn't need the mutex, stored with release
+            mutable std::vector<QAtomicInt> m_framePinned;//modified frames can't be reloaded, so are never evicted
+            mutable std::deque<int64_t> m_frameLoadOrder;//oldest loaded frame is evicted first
+            int64_t m_maxCachedFrames;//-1 for no limit
+            mutable CaretMutex m_frameMutex;
+            
+            float* loadFrame(const int64_t& frameIndex, const bool& forWriting, const bool& needData) const;
+            void clearOnDemand();
+            inline const float* getLoadedFrame(const int64_t& brickIndex, const int64_t& component) const
+            {//reading the frame through the loaded pointer is ordered after the release store that published it (data dependency)
+                const float* ret = m_framePointers[brickIndex + m_dimensions[3] * component];
+                if (ret != NULL) return ret;
+                return loadFrame(brickIndex + m_dimensions[3] * component, false, true);
+            }
+            inline float* getWritableFrame(const int64_t& brickIndex, const int64_t& component, const bool& needData = true)
+            {
+                const int64_t frameIndex = brickIndex + m_dimensions[3] * component;
+                float* ret = m_framePointers[frameIndex];
+                if (ret != NULL && m_framePinned[frameIndex] != 0) return ret;//pinned frames are never evicted
+                return loadFrame(frameIndex, true, needData);
+            }
             VolumeStorage(const VolumeStorage& rhs);//deny copy, assignment for now
             VolumeStorage& operator=(const VolumeStorage& rhs);
         public:
             VolumeStorage();
             VolumeStorage(int64_t dims[5]);
             void reinitialize(int64_t dims[5]);
+            ///takes ownership of the loader, maxCachedFrames of -1 means loaded frames are never evicted
+            void reinitializeOnDemand(int64_t dims[5], VolumeFrameLoader* loader, const int64_t& maxCachedFrames);
             void clear();
             
+            bool isLoadingOnDemand() const { return m_frameLoader != NULL; }
+            
+            ///loads any frames not yet loaded and releases the loader
+            void loadAllFrames();
+            
             void getDimensions(std::vector<int64_t>& dimOut) const;//NOTE: always returns a vector of 5 elements
             void getDimensions(int64_t& dimOut1, int64_t& dimOut2, int64_t& dimOut3, int64_t& dimTimeOut, int64_t& numComponents) const;
             std::vector<int64_t> getDimensions() const;
@@ -71,6 +117,7 @@ namespace caret {
             inline const float& getValue(const int64_t& indexIn1, const int64_t& indexIn2, const int64_t& indexIn3, const int64_t brickIndex, const int64_t component) const
             {
                 CaretAssert(indexValid(indexIn1, indexIn2, indexIn3, brickIndex, component));//assert so release version isn't slowed by checking
+                if (m_onDemand) return getLoadedFrame(brickIndex, component)[indexIn1 + m_mult[0] * indexIn2 + m_mult[1] * indexIn3];
                 return m_data[getIndex(indexIn1, indexIn2, indexIn3, brickIndex, component)];
             }
             inline const float& getValue(const int64_t indexIn[3], const int64_t brickIndex, const int64_t component) const
@@ -108,6 +155,11 @@ namespace caret {
             inline void setValue(const float& valueIn, const int64_t& indexIn1, const int64_t& indexIn2, const int64_t& indexIn3, const int64_t brickIndex, const int64_t component)
             {
                 CaretAssert(indexValid(indexIn1, indexIn2, indexIn3, brickIndex, component));//assert so release version isn't slowed by checking
+                if (m_onDemand)
+                {
+                    getWritableFrame(brickIndex, component)[indexIn1 + m_mult[0] * indexIn2 + m_mult[1] * indexIn3] = valueIn;
+                    return;
+                }
                 m_data[getIndex(indexIn1, indexIn2, indexIn3, brickIndex, component)] = valueIn;
             }
             inline void setValue(const float& valueIn, const int64_t indexIn[3], const int64_t brickIndex, const int64_t component)
@@ -123,6 +175,9 @@ namespace caret {
             
             ///set a frame
             void setFrame(const float* frameIn, const int64_t brickIndex = 0, const int64_t component = 0);
+            
+            ///set scattered voxels of one frame, offsets are within the frame
+            void setFrameValues(const int64_t* frameOffsets, const float* values, const int64_t& count, const int64_t brickIndex, const int64_t component);
         };
         
         VolumeStorage m_storage;
@@ -130,12 +185,18 @@ namespace caret {
         std::vector<int64_t> m_origDims;//keep track of the original dimensions
         bool m_ModifiedFlag;
         
+        void setupDimensions(const std::vector<int64_t>& dimensionsIn, const std::vector<std::vector<float> >& indexToSpace, const int64_t numComponents, int64_t storeDims[5]);
+        
     protected:
         VolumeBase();
         VolumeBase(const std::vector<int64_t>& dimensionsIn, const std::vector<std::vector<float> >& indexToSpace, const int64_t numComponents = 1);
         ///recreates the volume file storage with new size and spacing
         void reinitialize(const std::vector<int64_t>& dimensionsIn, const std::vector<std::vector<float> >& indexToSpace, const int64_t numComponents = 1);
         
+        ///like reinitialize, but frames are read by the loader (which this takes ownership of) when first used, keeping at most maxCachedFrames (-1 for all of them)
+        void reinitializeOnDemand(const std::vector<int64_t>& dimensionsIn, const std::vector<std::vector<float> >& indexToSpace,
+                                  VolumeFrameLoader* loader, const int64_t& maxCachedFrames);
+        
         void addSubvolumes(const int64_t& numToAdd);
         
     public:
@@ -161,6 +222,18 @@ namespace caret {
             return m_storage.getNumberOfComponents();
         }
         
+        ///true if some frames have not yet been read from the file
+        bool isLoadingFramesOnDemand() const { return m_storage.isLoadingOnDemand(); }
+        
+        ///read any frames that haven't been read yet, and stop reading from the file
+        void loadAllFrames() { m_storage.loadAllFrames(); }
+        
+        ///frames evicted from on-demand volumes are only freed when no code is between these calls, because pointers from getFrame or getValue may still be in use
+        ///nest them around anything that may use volume frames, wb_view does this around every event it dispatches
+        ///outside of them, evicted frames are freed immediately
+        static void beginFrameUse();
+        static void endFrameUse();
+        
         ///translates extraspatial indices into a (flat) brick index
         int64_t getBrickIndexFromNonSpatialIndexes(const std::vector<int64_t>& extraInds) const;
         
@@ -328,6 +401,13 @@ namespace caret {
         
         ///set a frame
         void setFrame(const float* frameIn, const int64_t brickIndex = 0, const int64_t component = 0) { m_storage.setFrame(frameIn, brickIndex, component); setModified(); }
+        
+        ///set scattered voxels of one frame at once, offsets as from getIndex with brickIndex and component of 0
+        void setFrameValues(const int64_t* frameOffsets, const float* values, const int64_t& count, const int64_t brickIndex = 0, const int64_t component = 0)
+        {
+            m_storage.setFrameValues(frameOffsets, values, count, brickIndex, component);
+            setModified();
+        }
 
         ///gets dimensions as a vector of 5 integers, 3 spatial, time, components
         void getDimensions(std::vector<int64_t>& dimOut) const { m_storage.getDimensions(dimOut); }
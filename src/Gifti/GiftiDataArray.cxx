@@ -43,8 +43,35 @@
 #include "SystemUtilities.h"
 #include "XmlWriter.h"
 
+#include <QFile>
+
 using namespace caret;
 
+namespace
+{
+    /*
+     * Number of bytes that base64 text decodes to, without decoding it,
+     * so that a deferred array can be checked while the file is read.
+     */
+    int64_t getBase64DecodedLength(const QByteArray& text)
+    {
+        int64_t numChars = 0;
+        const int64_t textLength = text.size();
+        const char* textChars = text.constData();
+        for (int64_t i = 0; i < textLength; i++) {
+            const char c = textChars[i];
+            if (((c >= 'A') && (c <= 'Z'))
+                || ((c >= 'a') && (c <= 'z'))
+                || ((c >= '0') && (c <= '9'))
+                || (c == '+')
+                || (c == '/')) {
+                numChars++;
+            }
+        }
+        return (numChars * 3) / 4;
+    }
+}
+
 /**
  * constructor.
  */
@@ -58,6 +85,8 @@ GiftiDataArray::GiftiDataArray(const NiftiIntentEnum::Enum intentIn,
    dataPointerFloat = NULL;
    dataPointerInt = NULL;
    dataPointerUByte = NULL;    
+   m_decodePending = 0;
+   m_mappedData = NULL;
    this->paletteColorMapping = NULL;
   this->descriptiveStatistics = NULL;
     this->descriptiveStatisticsLimitedValues = NULL;
@@ -86,6 +115,8 @@ GiftiDataArray::GiftiDataArray(const NiftiIntentEnum::Enum intentIn)
    dataPointerFloat = NULL;
    dataPointerInt = NULL;
    dataPointerUByte = NULL;
+   m_decodePending = 0;
+   m_mappedData = NULL;
    this->paletteColorMapping = NULL;
    this->descriptiveStatistics = NULL;
     this->descriptiveStatisticsLimitedValues = NULL;
@@ -125,6 +156,8 @@ GiftiDataArray::GiftiDataArray(const GiftiDataArray& nda)
    dataPointerFloat = NULL;
    dataPointerInt = NULL;
    dataPointerUByte = NULL;
+   m_decodePending = 0;
+   m_mappedData = NULL;
    this->paletteColorMapping = NULL;
    this->descriptiveStatistics = NULL;
     this->descriptiveStatisticsLimitedValues = NULL;
@@ -149,6 +182,8 @@ GiftiDataArray::operator=(const GiftiDataArray& nda)
 void 
 GiftiDataArray::copyHelperGiftiDataArray(const GiftiDataArray& nda)
 {
+    discardDeferredData();
+    nda.decodeDeferredData();
     this->paletteColorMapping = NULL;
     if (nda.paletteColorMapping != NULL) {
         this->paletteColorMapping = new PaletteColorMapping(*nda.paletteColorMapping);
@@ -171,6 +206,10 @@ GiftiDataArray::copyHelperGiftiDataArray(const GiftiDataArray& nda)
    dimensions = nda.dimensions;
    allocateData();
    data = nda.data;
+   if (nda.m_mappedData != NULL) {
+      data.assign(nda.m_mappedData, nda.m_mappedData + nda.getDataSizeInBytes());//only the original holds the mapping, so writing the file can release it
+   }
+   updateDataPointers();
    metaData = nda.metaData;
    nonWrittenMetaData = nda.nonWrittenMetaData;
    externalFileName = nda.externalFileName;
@@ -261,6 +300,7 @@ GiftiDataArray::deleteRows(const std::vector<int32_t>& rowsToDeleteIn)
    if (rowsToDeleteIn.empty()) {
       return;
    }
+   makeDataWritable();
    
    //
    // Sort rows in reverse order
@@ -317,6 +357,11 @@ GiftiDataArray::setDimensions(const std::vector<int64_t> dimensionsIn)
 void 
 GiftiDataArray::allocateData()
 {
+   //
+   // Keep the current values, as resizing does
+   //
+   makeDataWritable();
+   
    //
    // Determine the number of items to allocate
    //
@@ -328,21 +373,8 @@ GiftiDataArray::allocateData()
    //
    // Bytes required by each data type
    //
-   dataTypeSize = 0;
-   switch (dataType) {
-      case NiftiDataTypeEnum::NIFTI_TYPE_FLOAT32:
-         dataTypeSize = sizeof(float);
-         break;
-      case NiftiDataTypeEnum::NIFTI_TYPE_INT32:
-         dataTypeSize = sizeof(int32_t);
-         break;
-      case NiftiDataTypeEnum::NIFTI_TYPE_UINT8:
-         dataTypeSize = sizeof(uint8_t);
-         break;
-       default:
-           CaretAssertMessage(0, "Unsupported GIFTI data type.");
-           break;
-   }
+   dataTypeSize = getDataTypeSize(dataType);
+   CaretAssertMessage(dataTypeSize > 0, "Unsupported GIFTI data type.");
    
    dataSizeInBytes *= dataTypeSize;
    
@@ -367,6 +399,34 @@ GiftiDataArray::allocateData()
    setModified();
 }
 
+/**
+ * size of one element of a data type, zero if the type is not supported.
+ */
+uint32_t
+GiftiDataArray::getDataTypeSize(const NiftiDataTypeEnum::Enum dataTypeIn)
+{
+   switch (dataTypeIn) {
+      case NiftiDataTypeEnum::NIFTI_TYPE_FLOAT32:
+         return sizeof(float);
+      case NiftiDataTypeEnum::NIFTI_TYPE_INT32:
+         return sizeof(int32_t);
+      case NiftiDataTypeEnum::NIFTI_TYPE_UINT8:
+         return sizeof(uint8_t);
+      default:
+         break;
+   }
+   return 0;
+}
+
+/**
+ * current size of the data (in bytes), including data not yet decoded.
+ */
+int64_t
+GiftiDataArray::getDataSizeInBytes() const
+{
+   return getTotalNumberOfElements() * dataTypeSize;
+}
+
 /**
  * update the data pointers.
  */
@@ -376,16 +436,23 @@ GiftiDataArray::updateDataPointers()
    dataPointerFloat = NULL;
    dataPointerInt = NULL;
    dataPointerUByte = NULL;
-   if (data.empty() == false) {
+   uint8_t* dataStart = NULL;
+   if (m_mappedData != NULL) {
+      dataStart = m_mappedData;//read only, anything that modifies the data calls makeDataWritable() first
+   }
+   else if (data.empty() == false) {
+      dataStart = &data[0];
+   }
+   if (dataStart != NULL) {
       switch (dataType) {
          case NiftiDataTypeEnum::NIFTI_TYPE_FLOAT32:
-            dataPointerFloat = (float*)&data[0];
+            dataPointerFloat = (float*)dataStart;
             break;
          case NiftiDataTypeEnum::NIFTI_TYPE_INT32:
-            dataPointerInt   = (int32_t*)&data[0];
+            dataPointerInt   = (int32_t*)dataStart;
             break;
          case NiftiDataTypeEnum::NIFTI_TYPE_UINT8:
-            dataPointerUByte = (uint8_t*)&data[0];
+            dataPointerUByte = dataStart;
             break;
           default:
               CaretAssertMessage(0, "Unsupported GIFTI Data Type");
@@ -400,6 +467,7 @@ GiftiDataArray::updateDataPointers()
 void 
 GiftiDataArray::clear()
 {
+   discardDeferredData();
    arraySubscriptingOrder = GiftiArrayIndexingOrderEnum::ROW_MAJOR_ORDER;
    encoding = GiftiEncodingEnum::ASCII;
    dataType = NiftiDataTypeEnum::NIFTI_TYPE_FLOAT32;
@@ -559,6 +627,7 @@ GiftiDataArray::remapIntValues(const std::vector<int32_t>& remappingTable)
 void 
 GiftiDataArray::transferLabelIndices(const std::map<int32_t,int32_t>& indexConverter) {
     if (this->getDataType() == NiftiDataTypeEnum::NIFTI_TYPE_INT32) {
+        makeDataWritable();
         int64_t num = this->getTotalNumberOfElements();
         for (int i = 0; i < num; i++) {
             int oldIndex = this->dataPointerInt[i];
@@ -588,6 +657,265 @@ GiftiDataArray::readFromText(const AString text,
                              const AString& externalFileNameForReading,
                              const int64_t externalFileOffsetForReading,
                              const bool isReadOnlyMetaData)
+{
+   discardDeferredData();
+   decodeData(text.toLatin1(),
+              dataEndianForReading,
+              arraySubscriptingOrderForReading,
+              dataTypeForReading,
+              dimensionsForReading,
+              encodingForReading,
+              externalFileNameForReading,
+              externalFileOffsetForReading,
+              isReadOnlyMetaData);
+}
+
+/**
+ * read a GIFTI data array from text, but only check it and keep the
+ * text until the data is first accessed.  External binary data that
+ * needs no conversion is memory mapped instead.  The data type,
+ * dimensions, endian, and indexing order are set to what they will
+ * be after decoding.
+ */
+void 
+GiftiDataArray::readFromTextDeferred(const AString& text,
+                                     const GiftiEndianEnum::Enum dataEndianForReading,
+                                     const GiftiArrayIndexingOrderEnum::Enum arraySubscriptingOrderForReading,
+                                     const NiftiDataTypeEnum::Enum dataTypeForReading,
+                                     const std::vector<int64_t>& dimensionsForReading,
+                                     const GiftiEncodingEnum::Enum encodingForReading,
+                                     const AString& externalFileNameForReading,
+                                     const int64_t externalFileOffsetForReading)
+{
+   discardDeferredData();
+   if (dimensionsForReading.size() == 0) {
+      throw GiftiException("Data array has no dimensions.");
+   }
+   if (getDataTypeSize(dataTypeForReading) == 0) {
+      throw GiftiException("DataType " + NiftiDataTypeEnum::toName(dataTypeForReading) + " not supported in GIFTI");
+   }
+   
+   //
+   // Same results as decodeData()
+   //
+   const NiftiDataTypeEnum::Enum requiredDataType = dataType;
+   if (intent == NiftiIntentEnum::NIFTI_INTENT_POINTSET) {
+      dataType = dataTypeForReading;
+   }
+   encoding = encodingForReading;
+   endian = getSystemEndian();
+   if (encoding == GiftiEncodingEnum::ASCII) {
+      endian = dataEndianForReading;
+   }
+   arraySubscriptingOrder = GiftiArrayIndexingOrderEnum::ROW_MAJOR_ORDER;
+   dimensions = dimensionsForReading;
+   if (dimensions.size() == 1) {
+      dimensions.push_back(1);
+   }
+   dataTypeSize = getDataTypeSize(dataType);
+   std::vector<uint8_t>().swap(data);
+   
+   if (encoding == GiftiEncodingEnum::EXTERNAL_FILE_BINARY) {
+      if (externalFileNameForReading.length() <= 0) {
+         throw GiftiException("External file name is empty.");
+      }
+      CaretPointer<QFile> extBinFile;
+      extBinFile.grabNew(new QFile(externalFileNameForReading));
+      if (extBinFile->open(QIODevice::ReadOnly) == false) {
+         throw GiftiException("Error opening ""
+                              + externalFileNameForReading
+                              + """);
+      }
+      const int64_t numberOfBytesToRead = getTotalNumberOfElements() * getDataTypeSize(dataTypeForReading);
+      if (extBinFile->size() < externalFileOffsetForReading + numberOfBytesToRead) {
+         throw GiftiException("Tried to read "
+                              + AString::number(numberOfBytesToRead)
+                              + " from "
+                              + AString::number(externalFileOffsetForReading)
+                              + " but file ""
+                              + externalFileNameForReading
+                              + "" is too short");
+      }
+      
+      //
+      // Map the data when it can be used exactly as it is in the file
+      //
+      if ((dataTypeForReading == dataType)
+          && (dataEndianForReading == getSystemEndian())
+          && (arraySubscriptingOrderForReading == GiftiArrayIndexingOrderEnum::ROW_MAJOR_ORDER)
+          && ((externalFileOffsetForReading % dataTypeSize) == 0)
+          && (numberOfBytesToRead > 0)) {
+         uchar* mapped = extBinFile->map(externalFileOffsetForReading, numberOfBytesToRead);
+         if (mapped != NULL) {
+            m_mappedFile = extBinFile;
+            m_mappedData = mapped;
+            updateDataPointers();
+            setModified();
+            return;
+         }
+      }
+   }
+   
+   m_deferredRead.grabNew(new DeferredRead());
+   m_deferredRead->m_text = text.toLatin1();
+   m_deferredRead->m_endian = dataEndianForReading;
+   m_deferredRead->m_arraySubscriptingOrder = arraySubscriptingOrderForReading;
+   m_deferredRead->m_dataType = dataTypeForReading;
+   m_deferredRead->m_requiredDataType = requiredDataType;
+   m_deferredRead->m_dimensions = dimensionsForReading;
+   m_deferredRead->m_encoding = encodingForReading;
+   m_deferredRead->m_externalFileName = externalFileNameForReading;
+   m_deferredRead->m_externalFileOffset = externalFileOffsetForReading;
+   
+   //
+   // Check the data now, so that a truncated or corrupt array fails
+   // the read instead of failing when it is first used
+   //
+   const int64_t numberOfBytesExpected = getTotalNumberOfElements() * getDataTypeSize(dataTypeForReading);
+   if (encoding == GiftiEncodingEnum::BASE64_BINARY) {
+      const int64_t numberOfBytesInText = getBase64DecodedLength(m_deferredRead->m_text);
+      if (numberOfBytesInText < numberOfBytesExpected) {
+         m_deferredRead.grabNew(NULL);
+         throw GiftiException("Base64 Binary data is "
+                              + AString::number(numberOfBytesInText)
+                              + " bytes but should be "
+                              + AString::number(numberOfBytesExpected)
+                              + " bytes.");
+      }
+   }
+   else if (encoding == GiftiEncodingEnum::GZIP_BASE64_BINARY) {
+      if (numberOfBytesExpected > 0) {
+         //
+         // Decompress without keeping the result, only the compressed bytes are held until decoding
+         //
+         std::vector<unsigned char> compressedBytes(getBase64DecodedLength(m_deferredRead->m_text));
+         uint64_t numDecoded = 0;
+         if (compressedBytes.empty() == false) {
+            numDecoded = Base64::decode((const unsigned char*)m_deferredRead->m_text.constData(),
+                                        compressedBytes.size(),
+                                        &compressedBytes[0]);
+         }
+         if (numDecoded == 0) {
+            m_deferredRead.grabNew(NULL);
+            throw GiftiException("GZip Base64 Binary data is empty.");
+         }
+         DataCompressZLib compressor;
+         const uint64_t numberOfBytesUncompressed = compressor.getUncompressedSize(&compressedBytes[0],
+                                                                                  numDecoded);
+         if (numberOfBytesUncompressed != static_cast<uint64_t>(numberOfBytesExpected)) {
+            m_deferredRead.grabNew(NULL);
+            throw GiftiException("Decompression of GZip Base64 Binary data failed.\n"
+                                 "Uncompressed "
+                                 + AString::number(numberOfBytesUncompressed)
+                                 + " bytes but should be "
+                                 + AString::number(numberOfBytesExpected)
+                                 + " bytes.");
+         }
+      }
+   }
+   m_decodePending.fetchAndStoreRelease(1);
+   updateDataPointers();
+   setModified();
+}
+
+/**
+ * decode deferred data if it has not been used yet.  Decoding does
+ * not change the data's values, so it is allowed in const methods,
+ * and may be called from several threads at once.  Only the data and
+ * the data pointers are set here, everything else was set when the
+ * array was read.
+ *
+ * The data was checked when it was read, so decoding fails only if
+ * something changed since then (such as the external binary file).
+ * This is called from const accessors whose callers do not expect
+ * exceptions, so the error is logged and the data is set to zeros.
+ */
+void 
+GiftiDataArray::decodeDeferredData() const
+{
+   if (m_decodePending.fetchAndAddAcquire(0) == 0) {
+      return;
+   }
+   CaretMutexLocker locked(&m_decodeMutex);
+   if (m_decodePending.fetchAndAddAcquire(0) == 0) {
+      return;//another thread decoded it while we waited
+   }
+   GiftiDataArray* myself = const_cast<GiftiDataArray*>(this);
+   const DeferredRead* myRead = m_deferredRead;
+   CaretAssert(myRead != NULL);
+   
+   //
+   // Decode in a separate array so that nothing here calls back into decodeDeferredData()
+   //
+   GiftiDataArray decoded(intent);
+   decoded.dataType = myRead->m_requiredDataType;
+   try {
+      decoded.decodeData(myRead->m_text,
+                         myRead->m_endian,
+                         myRead->m_arraySubscriptingOrder,
+                         myRead->m_dataType,
+                         myRead->m_dimensions,
+                         myRead->m_encoding,
+                         myRead->m_externalFileName,
+                         myRead->m_externalFileOffset,
+                         false);
+      CaretAssert(decoded.dataType == dataType);
+      CaretAssert(decoded.dimensions == dimensions);
+      CaretAssert(decoded.getDataSizeInBytes() == getDataSizeInBytes());
+      myself->data.swap(decoded.data);
+   }
+   catch (const GiftiException& e) {
+      CaretLogSevere("Error decoding GIFTI data array, its data is replaced with zeros: "
+                     + e.whatString());
+      std::vector<uint8_t>(getDataSizeInBytes(), 0).swap(myself->data);
+   }
+   myself->updateDataPointers();
+   myself->m_deferredRead.grabNew(NULL);
+   m_decodePending.fetchAndStoreRelease(0);//last, the unlocked check must not see a partial decode
+}
+
+/**
+ * decode deferred data and copy mapped data into this array's own memory
+ * so that the data may be modified.
+ */
+void 
+GiftiDataArray::makeDataWritable()
+{
+   decodeDeferredData();
+   if (m_mappedData != NULL) {
+      data.assign(m_mappedData, m_mappedData + getDataSizeInBytes());
+      m_mappedData = NULL;
+      m_mappedFile.grabNew(NULL);//unmap, so the external file may be replaced
+      updateDataPointers();
+   }
+}
+
+/**
+ * forget deferred and mapped data without decoding or copying it.
+ */
+void 
+GiftiDataArray::discardDeferredData()
+{
+   m_deferredRead.grabNew(NULL);
+   m_decodePending.fetchAndStoreRelease(0);
+   m_mappedData = NULL;
+   m_mappedFile.grabNew(NULL);
+   updateDataPointers();
+}
+
+/**
+ * decode a GIFTI data array from text, the data is allocated here.
+ */
+void 
+GiftiDataArray::decodeData(const QByteArray& text,
+                           const GiftiEndianEnum::Enum dataEndianForReading,
+                           const GiftiArrayIndexingOrderEnum::Enum arraySubscriptingOrderForReading,
+                           const NiftiDataTypeEnum::Enum dataTypeForReading,
+                           const std::vector<int64_t>& dimensionsForReading,
+                           const GiftiEncodingEnum::Enum encodingForReading,
+                           const AString& externalFileNameForReading,
+                           const int64_t externalFileOffsetForReading,
+                           const bool isReadOnlyMetaData)
 {
    const NiftiDataTypeEnum::Enum requiredDataType = dataType;
    dataType = dataTypeForReading;
@@ -613,7 +941,7 @@ GiftiDataArray::readFromText(const AString text,
       switch (encoding) {
           case GiftiEncodingEnum::ASCII:
             {
-                std::istringstream stream(text.toStdString());
+                std::istringstream stream(std::string(text.constData(), text.size()));
                 
                switch (dataType) {
                   case NiftiDataTypeEnum::NIFTI_TYPE_FLOAT32:
@@ -656,7 +984,7 @@ GiftiDataArray::readFromText(const AString text,
                // Decode the Base64 data using VTK's algorithm
                //
                const uint64_t numDecoded =
-                     Base64::decode((const unsigned char*)(text.toStdString().c_str()),
+                     Base64::decode((const unsigned char*)text.constData(),
                                                 data.size(),
                                                 &data[0]);
                if (numDecoded != data.size()) {
@@ -683,7 +1011,7 @@ GiftiDataArray::readFromText(const AString text,
                unsigned char* dataBuffer = new unsigned char[data.size()];
                //const char* textChars = text.toAscii().constData();
                const uint64_t numDecoded =
-                     Base64::decode((unsigned char*)text.toStdString().c_str(),
+                     Base64::decode((const unsigned char*)text.constData(),
                                                 data.size(),
                                                 dataBuffer);
                if (numDecoded == 0) {
@@ -823,6 +1151,7 @@ GiftiDataArray::readFromText(const AString text,
 void
 GiftiDataArray::convertArrayIndexingOrder()
 {
+    makeDataWritable();
     const int32_t numDim = static_cast<int32_t>(dimensions.size());
 
     if (numDim > 2) {
@@ -1015,6 +1344,11 @@ GiftiDataArray::writeAsXML(std::ostream& stream,
                            GiftiEncodingEnum::Enum encodingForWriting) 
                                                
 {
+    //
+    // Writing may convert the data in place
+    //
+    makeDataWritable();
+    
     this->encoding = encodingForWriting;
     
     //
@@ -1265,6 +1599,7 @@ GiftiDataArray::writeAsXML(std::ostream& stream,
 void 
 GiftiDataArray::convertToDataType(const NiftiDataTypeEnum::Enum newDataType)
 {
+   makeDataWritable();
    if (newDataType != dataType) {      
       //
       // make a copy of myself
@@ -1357,6 +1692,7 @@ GiftiDataArray::convertToDataType(const NiftiDataTypeEnum::Enum newDataType)
 void 
 GiftiDataArray::byteSwapData(const GiftiEndianEnum::Enum newEndian)
 {
+   makeDataWritable();
    endian = newEndian;
    switch (dataType) {
       case NiftiDataTypeEnum::NIFTI_TYPE_FLOAT32:
@@ -1434,6 +1770,7 @@ void
 GiftiDataArray::getMinMaxValues(int& minValue, int& maxValue) const
 {
    if (minMaxIntValuesValid == false) {
+      decodeDeferredData();
       minValueInt = std::numeric_limits<int32_t>::max();
       minValueInt = std::numeric_limits<int32_t>::min();
       
@@ -1461,6 +1798,7 @@ GiftiDataArray::getMinMaxValuesFloat(float& minValue,
                           float& maxValue) const
 {
     if (minMaxFloatValuesValid == false) {
+        decodeDeferredData();
         minValueFloat =  std::numeric_limits<float>::max();
         maxValueFloat = -std::numeric_limits<float>::max();
         
@@ -1482,6 +1820,7 @@ GiftiDataArray::getMinMaxValuesFloat(float& minValue,
 void 
 GiftiDataArray::zeroize()
 {
+   makeDataWritable();
    if (data.empty() == false) {
       std::fill(data.begin(), data.end(), 0);
    }
@@ -1523,6 +1862,7 @@ GiftiDataArray::getDataOffset(const int32_t indices[]) const
 float 
 GiftiDataArray::getDataFloat32(const int32_t indices[]) const
 {
+   decodeDeferredData();
    const int64_t offset = getDataOffset(indices);
    return dataPointerFloat[offset];
 }
@@ -1533,6 +1873,7 @@ GiftiDataArray::getDataFloat32(const int32_t indices[]) const
 const float* 
 GiftiDataArray::getDataFloat32Pointer(const int32_t indices[]) const
 {
+   decodeDeferredData();
    const int64_t offset = getDataOffset(indices);
    return &dataPointerFloat[offset];
 }
@@ -1543,6 +1884,7 @@ GiftiDataArray::getDataFloat32Pointer(const int32_t indices[]) const
 int32_t 
 GiftiDataArray::getDataInt32(const int32_t indices[]) const
 {
+   decodeDeferredData();
    const int64_t offset = getDataOffset(indices);
    return dataPointerInt[offset];
 }
@@ -1553,6 +1895,7 @@ GiftiDataArray::getDataInt32(const int32_t indices[]) const
 const int32_t* 
 GiftiDataArray::getDataInt32Pointer(const int32_t indices[]) const
 {
+   decodeDeferredData();
    const int64_t offset = getDataOffset(indices);
    return &dataPointerInt[offset];
 }
@@ -1563,6 +1906,7 @@ GiftiDataArray::getDataInt32Pointer(const int32_t indices[]) const
 uint8_t 
 GiftiDataArray::getDataUInt8(const int32_t indices[]) const
 {
+   decodeDeferredData();
    const int64_t offset = getDataOffset(indices);
    return dataPointerUByte[offset];
 }
@@ -1573,6 +1917,7 @@ GiftiDataArray::getDataUInt8(const int32_t indices[]) const
 const uint8_t*
 GiftiDataArray::getDataUInt8Pointer(const int32_t indices[]) const
 {
+   decodeDeferredData();
    const int64_t offset = getDataOffset(indices);
    return &dataPointerUByte[offset];
 }
@@ -1583,6 +1928,7 @@ GiftiDataArray::getDataUInt8Pointer(const int32_t indices[]) const
 void 
 GiftiDataArray::setDataFloat32(const int32_t indices[], const float dataValue) const
 {
+   const_cast<GiftiDataArray*>(this)->makeDataWritable();
    const int64_t offset = getDataOffset(indices);
    dataPointerFloat[offset] = dataValue;
 }
@@ -1593,6 +1939,7 @@ GiftiDataArray::setDataFloat32(const int32_t indices[], const float dataValue) c
 void 
 GiftiDataArray::setDataInt32(const int32_t indices[], const int32_t dataValue) const
 {
+   const_cast<GiftiDataArray*>(this)->makeDataWritable();
    const int64_t offset = getDataOffset(indices);
    dataPointerInt[offset] = dataValue;
 }
@@ -1603,6 +1950,7 @@ GiftiDataArray::setDataInt32(const int32_t indices[], const int32_t dataValue) c
 void 
 GiftiDataArray::setDataUInt8(const int32_t indices[], const uint8_t dataValue) const
 {
+   const_cast<GiftiDataArray*>(this)->makeDataWritable();
    const int64_t offset = getDataOffset(indices);
    dataPointerUByte[offset] = dataValue;
 }      
@@ -1706,6 +2054,7 @@ GiftiDataArray::getDescriptiveStatistics() const
         if (this->descriptiveStatistics == NULL) {
             this->descriptiveStatistics = new DescriptiveStatistics();
         }
+        decodeDeferredData();
         this->descriptiveStatistics->update(this->dataPointerFloat,
                                             this->getTotalNumberOfElements());
     }
@@ -1718,6 +2067,7 @@ const FastStatistics* GiftiDataArray::getFastStatistics() const
         if (m_fastStatistics == NULL) {
             m_fastStatistics.grabNew(new FastStatistics());
         }
+        decodeDeferredData();
         m_fastStatistics->update(dataPointerFloat, getTotalNumberOfElements());
     }
     return m_fastStatistics;
@@ -1729,6 +2079,7 @@ const Histogram* GiftiDataArray::getHistogram() const
         if (m_histogram == NULL) {
             m_histogram.grabNew(new Histogram(100));
         }
+        decodeDeferredData();
         m_histogram->update(dataPointerFloat, getTotalNumberOfElements());
     }
     return m_histogram;
@@ -1761,6 +2112,7 @@ GiftiDataArray::getDescriptiveStatistics(const float mostPositiveValueInclusive,
         if (this->descriptiveStatisticsLimitedValues == NULL) {
             this->descriptiveStatisticsLimitedValues = new DescriptiveStatistics();
         }
+        decodeDeferredData();
         this->descriptiveStatisticsLimitedValues->update(this->dataPointerFloat,
                                                          this->getTotalNumberOfElements(),
                                                          mostPositiveValueInclusive,
@@ -1783,6 +2135,7 @@ const Histogram* GiftiDataArray::getHistogram(const float mostPositiveValueInclu
         {
             m_histogramLimitedValues.grabNew(new Histogram(100));
         }
+        decodeDeferredData();
         m_histogramLimitedValues->update(dataPointerFloat, getTotalNumberOfElements(),
                                          mostPositiveValueInclusive,
                                          leastPositiveValueInclusive,
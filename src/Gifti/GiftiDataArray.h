@@ -29,6 +29,9 @@
 
 #include <stdint.h>
 
+#include <QAtomicInt>
+
+#include "CaretMutex.h"
 #include "CaretObject.h"
 #include "CaretPointer.h"
 #include "DescriptiveStatistics.h"
@@ -44,6 +47,7 @@
 #include "TracksModificationInterface.h"
 
 
+class QFile;
 
 namespace caret {
     
@@ -94,8 +98,8 @@ namespace caret {
         /// get the dimensions
         std::vector<int64_t> getDimensions() const { return dimensions; }
         
-        /// current size of the data (in bytes)
-        int64_t getDataSizeInBytes() const { return data.size(); }
+        // current size of the data (in bytes)
+        int64_t getDataSizeInBytes() const;
         
         /// get a dimension
         int32_t getDimension(const int32_t dimIndex) const { return dimensions[dimIndex]; }
@@ -123,6 +127,22 @@ namespace caret {
                           const int64_t externalFileOffsetForReading,
                           const bool isReadOnlyMetaData);
         
+        // read a data array from text, but decode it when the data is first accessed
+        void readFromTextDeferred(const AString& text,
+                                  const GiftiEndianEnum::Enum dataEndianForReading,
+                                  const GiftiArrayIndexingOrderEnum::Enum arraySubscriptingOrderForReading,
+                                  const NiftiDataTypeEnum::Enum dataTypeForReading,
+                                  const std::vector<int64_t>& dimensionsForReading,
+                                  const GiftiEncodingEnum::Enum encodingForReading,
+                                  const AString& externalFileNameForReading,
+                                  const int64_t externalFileOffsetForReading);
+        
+        // is the data waiting to be decoded
+        bool isDataDecodePending() const { return (m_decodePending.fetchAndAddAcquire(0) != 0); }
+        
+        // is the data memory mapped from an external binary file
+        bool isDataMapped() const { return (m_mappedData != NULL); }
+        
         // write the data as XML
         void writeAsXML(std::ostream& stream, 
                         std::ostream* externalBinaryOutputStream,
@@ -208,22 +228,22 @@ namespace caret {
         void setArraySubscriptingOrder(const GiftiArrayIndexingOrderEnum::Enum aso) { arraySubscriptingOrder = aso; }
         
         /// get pointer for floating point data (valid only if data type is FLOAT)
-        float* getDataPointerFloat() { return dataPointerFloat; }
+        float* getDataPointerFloat() { makeDataWritable(); return dataPointerFloat; }
         
         /// get pointer for floating point data (const method) (valid only if data type is FLOAT)
-        const float* getDataPointerFloat() const { return dataPointerFloat; }
+        const float* getDataPointerFloat() const { decodeDeferredData(); return dataPointerFloat; }
         
         /// get pointer for integer data (valid only if data type is INT)
-        int32_t* getDataPointerInt() { return dataPointerInt; }
+        int32_t* getDataPointerInt() { makeDataWritable(); return dataPointerInt; }
         
         /// get pointer for integer data (const method) (valid only if data type is INT)
-        const int32_t* getDataPointerInt() const { return dataPointerInt; }
+        const int32_t* getDataPointerInt() const { decodeDeferredData(); return dataPointerInt; }
         
         /// get pointer for unsigned byte data (valid only if data type is UBYTE)
-        uint8_t* getDataPointerUByte() { return dataPointerUByte; }
+        uint8_t* getDataPointerUByte() { makeDataWritable(); return dataPointerUByte; }
         
         /// get pointer for unsigned byte data (const method) (valid only if data type is UBYTE)
-        const uint8_t* getDataPointerUByte() const { return dataPointerUByte; }
+        const uint8_t* getDataPointerUByte() const { decodeDeferredData(); return dataPointerUByte; }
         
         // set all elements of array to zero
         void zeroize();
@@ -305,9 +325,46 @@ namespace caret {
         
     protected:
         
+        /// how to decode data that was read but not yet used
+        struct DeferredRead
+        {
+            QByteArray m_text;
+            GiftiEndianEnum::Enum m_endian;
+            GiftiArrayIndexingOrderEnum::Enum m_arraySubscriptingOrder;
+            NiftiDataTypeEnum::Enum m_dataType;
+            NiftiDataTypeEnum::Enum m_requiredDataType;
+            std::vector<int64_t> m_dimensions;
+            GiftiEncodingEnum::Enum m_encoding;
+            AString m_externalFileName;
+            int64_t m_externalFileOffset;
+        };
+        
         //validate the array
         void validateArrayAfterReading();
         
+        // decode the data from the text, data array is allocated here
+        void decodeData(const QByteArray& text,
+                        const GiftiEndianEnum::Enum dataEndianForReading,
+                        const GiftiArrayIndexingOrderEnum::Enum arraySubscriptingOrderForReading,
+                        const NiftiDataTypeEnum::Enum dataTypeForReading,
+                        const std::vector<int64_t>& dimensionsForReading,
+                        const GiftiEncodingEnum::Enum encodingForReading,
+                        const AString& externalFileNameForReading,
+                        const int64_t externalFileOffsetForReading,
+                        const bool isReadOnlyMetaData);
+        
+        // decode deferred data if it hasn't been used yet
+        void decodeDeferredData() const;
+        
+        // decode deferred data and copy mapped data so that the data may be modified
+        void makeDataWritable();
+        
+        // forget deferred and mapped data without decoding or copying it
+        void discardDeferredData();
+        
+        // size of one element of a data type, zero if not supported
+        static uint32_t getDataTypeSize(const NiftiDataTypeEnum::Enum dataTypeIn);
+        
         // allocate data for this column
         virtual void allocateData();
         
@@ -326,6 +383,20 @@ namespace caret {
         /// the data
         std::vector<uint8_t> data;
         
+        /// data that has not been decoded yet
+        CaretPointer<DeferredRead> m_deferredRead;
+        
+        /// nonzero while data waits in m_deferredRead (acquire without the lock, then check again with it, release when decoded)
+        mutable QAtomicInt m_decodePending;
+        
+        mutable CaretMutex m_decodeMutex;
+        
+        /// external binary file the data is mapped from, released by makeDataWritable()
+        CaretPointer<QFile> m_mappedFile;
+        
+        /// read only, used instead of data when not NULL
+        uint8_t* m_mappedData;
+        
         /// size of one data type element
         uint32_t dataTypeSize;
         
@@ -901,7 +901,18 @@ GiftiFile::writeFile(const AString& filename)
             //                             "Overwriting of existing files is currently prohibited");
             //}
         }
-        
+
+        //
+        // Data may be mapped from (or not yet read from) an external
+        // binary file that the writer is about to remove or replace,
+        // whatever the encoding for writing, so read it all and
+        // release the mappings first
+        //
+        const int32_t numArrays = this->getNumberOfDataArrays();
+        for (int32_t i = 0; i < numArrays; i++) {
+            this->dataArrays[i]->makeDataWritable();
+        }
+
         //
         // Create a GIFTI Data Array File Writer
         //
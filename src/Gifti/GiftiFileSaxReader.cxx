@@ -20,6 +20,7 @@
 
 #include <sstream>
 
+#include "ApplicationInformation.h"
 #include "CaretLogger.h"
 #include "FileInformation.h"
 #include "GiftiEndianEnum.h"
@@ -516,15 +517,46 @@ GiftiFileSaxReader::processArrayData()
 
     CaretAssert(dataArray);
     try {
-        dataArray->readFromText(elementText,
-                                this->endianForReadingArrayData,
-                                arraySubscriptingOrderForReadingArrayData,
-                                dataTypeForReadingArrayData,
-                                dimensionsForReadingArrayData,
-                                encodingForReadingArrayData,
-                                externalFileNameForReadingData,
-                                externalFileOffsetForReadingData,
-                                this->giftiFile->getReadMetaDataOnlyFlag());
+        if (this->giftiFile->getReadMetaDataOnlyFlag()) {
+            dataArray->readFromText(elementText,
+                                    this->endianForReadingArrayData,
+                                    arraySubscriptingOrderForReadingArrayData,
+                                    dataTypeForReadingArrayData,
+                                    dimensionsForReadingArrayData,
+                                    encodingForReadingArrayData,
+                                    externalFileNameForReadingData,
+                                    externalFileOffsetForReadingData,
+                                    true);
+        }
+        else if (ApplicationInformation::getApplicationType() == ApplicationTypeEnum::APPLICATION_TYPE_COMMAND_LINE) {
+            /*
+             * Command line processing uses all of the data it reads,
+             * so decode now, and any error in the data fails the read
+             */
+            dataArray->readFromText(elementText,
+                                    this->endianForReadingArrayData,
+                                    arraySubscriptingOrderForReadingArrayData,
+                                    dataTypeForReadingArrayData,
+                                    dimensionsForReadingArrayData,
+                                    encodingForReadingArrayData,
+                                    externalFileNameForReadingData,
+                                    externalFileOffsetForReadingData,
+                                    false);
+        }
+        else {
+            /*
+             * Data is decoded (or mapped, for external binary)
+             * when it is first used, not while parsing
+             */
+            dataArray->readFromTextDeferred(elementText,
+                                            this->endianForReadingArrayData,
+                                            arraySubscriptingOrderForReadingArrayData,
+                                            dataTypeForReadingArrayData,
+                                            dimensionsForReadingArrayData,
+                                            encodingForReadingArrayData,
+                                            externalFileNameForReadingData,
+                                            externalFileOffsetForReadingData);
+        }
     }
     catch (const GiftiException& e) {
         throw XmlSaxParserException(e.whatString());
@@ -56,6 +56,8 @@
 #include "TopologyHelper.h"
 
 #include <cmath>
+#include <map>
+#include <utility>
 
 using namespace caret;
 using namespace std;
@@ -239,6 +241,131 @@ namespace
         return true;
     }
     
+    //the gradients of the previous run, so that changing only the path following settings doesn't recompute them
+    struct GradientCacheEntry
+    {
+        const CaretMappableDataFile* m_dataFile;
+        AString m_dataFileName;
+        int32_t m_mapIndex;
+        double m_dataChecksum;
+        const SurfaceFile* m_surface;
+        double m_surfaceChecksum;
+        const MetricFile* m_correctedAreas;
+        double m_areasChecksum;
+        vector<int32_t> m_roiNodes;
+        float m_smoothing, m_excludeDist;
+        bool m_skipGradient;
+        bool m_valid;//result of extractGradientData
+        vector<float> m_gradient;
+        
+        bool inputsMatch(const GradientCacheEntry& rhs) const
+        {
+            return m_dataFile == rhs.m_dataFile && m_dataFileName == rhs.m_dataFileName && m_mapIndex == rhs.m_mapIndex && m_dataChecksum == rhs.m_dataChecksum &&
+                   m_surface == rhs.m_surface && m_surfaceChecksum == rhs.m_surfaceChecksum &&
+                   m_correctedAreas == rhs.m_correctedAreas && m_areasChecksum == rhs.m_areasChecksum &&
+                   m_smoothing == rhs.m_smoothing && m_excludeDist == rhs.m_excludeDist && m_skipGradient == rhs.m_skipGradient &&
+                   m_roiNodes == rhs.m_roiNodes;
+        }
+    };
+    vector<GradientCacheEntry> gradientCache;
+    const int64_t GRADIENT_CACHE_MAX_VALUES = ((int64_t)1) << 25;
+    
+    //redrawn paths of the previous run by endpoints, the search for the same endpoints uses their cost as a bound
+    map<pair<int32_t, int32_t>, vector<int32_t> > previousPaths;
+    
+    double computeChecksum(const float* data, const int64_t& count)
+    {//not a hash, just enough to notice that values were changed
+        double ret = count;
+        for (int64_t i = 0; i < count; ++i)
+        {
+            const double weight = (i % 1021) + 1;
+            if (MathFunctions::isNumeric(data[i]))
+            {
+                ret += data[i] * weight;
+            } else {
+                ret += 0.5 * weight;
+            }
+        }
+        return ret;
+    }
+    
+    double computeDataChecksum(const CaretMappableDataFile* dataFile, const int32_t& mapIndex, const SurfaceFile* surface)
+    {
+        switch (dataFile->getDataFileType())
+        {
+            case DataFileTypeEnum::METRIC:
+            {
+                const MetricFile* metricFile = dynamic_cast<const MetricFile*>(dataFile);
+                CaretAssert(metricFile != NULL);
+                return computeChecksum(metricFile->getValuePointerForColumn(mapIndex), metricFile->getNumberOfNodes());
+            }
+            case DataFileTypeEnum::CONNECTIVITY_DENSE_SCALAR:
+            case DataFileTypeEnum::CONNECTIVITY_DENSE_TIME_SERIES:
+            {
+                const CiftiMappableDataFile* ciftiMappableFile = dynamic_cast<const CiftiMappableDataFile*>(dataFile);
+                CaretAssert(ciftiMappableFile != NULL);
+                vector<float> surfData;
+                if (!ciftiMappableFile->getMapDataForSurface(mapIndex, surface->getStructure(), surfData)) return 0.0;
+                return computeChecksum(surfData.data(), (int64_t)surfData.size());
+            }
+            default://dconn data isn't edited in memory
+                return 0.0;
+        }
+    }
+    
+    bool extractGradientDataCached(const CaretMappableDataFile* dataFile, const int32_t& mapIndex, SurfaceFile* surface, const MetricFile* gradRoi,
+                                   const float& smoothing, const MetricFile* correctedAreasMetric, MetricFile& gradientOut, const bool& skipGradient, const float& excludeDist,
+                                   const vector<int32_t>& roiNodes, vector<GradientCacheEntry>& newCache, int64_t& newCacheValues)
+    {
+        const int numNodes = surface->getNumberOfNodes();
+        GradientCacheEntry myEntry;
+        myEntry.m_dataFile = dataFile;
+        myEntry.m_dataFileName = dataFile->getFileName();
+        myEntry.m_mapIndex = mapIndex;
+        myEntry.m_dataChecksum = computeDataChecksum(dataFile, mapIndex, surface);
+        myEntry.m_surface = surface;
+        myEntry.m_surfaceChecksum = computeChecksum(surface->getCoordinateData(), numNodes * 3);
+        myEntry.m_correctedAreas = correctedAreasMetric;
+        myEntry.m_areasChecksum = (correctedAreasMetric == NULL ? 0.0 : computeChecksum(correctedAreasMetric->getValuePointerForColumn(0), correctedAreasMetric->getNumberOfNodes()));
+        myEntry.m_roiNodes = roiNodes;
+        myEntry.m_smoothing = smoothing;
+        myEntry.m_excludeDist = excludeDist;
+        myEntry.m_skipGradient = skipGradient;
+        bool found = false;
+        for (int i = 0; i < (int)gradientCache.size(); ++i)
+        {
+            if (gradientCache[i].inputsMatch(myEntry))
+            {
+                myEntry.m_valid = gradientCache[i].m_valid;
+                myEntry.m_gradient = gradientCache[i].m_gradient;
+                found = true;
+                break;
+            }
+        }
+        if (found)
+        {
+            if (myEntry.m_valid)
+            {
+                gradientOut.setNumberOfNodesAndColumns(numNodes, 1);
+                gradientOut.setStructure(surface->getStructure());
+                gradientOut.setValuesForColumn(0, myEntry.m_gradient.data());
+            }
+        } else {
+            myEntry.m_valid = extractGradientData(dataFile, mapIndex, surface, gradRoi, smoothing, correctedAreasMetric, gradientOut, skipGradient, excludeDist);
+            if (myEntry.m_valid)
+            {
+                const float* gradVals = gradientOut.getValuePointerForColumn(0);
+                myEntry.m_gradient.assign(gradVals, gradVals + numNodes);
+            }
+        }
+        if (newCacheValues + (int64_t)myEntry.m_gradient.size() <= GRADIENT_CACHE_MAX_VALUES)
+        {
+            newCacheValues += (int64_t)myEntry.m_gradient.size();
+            newCache.push_back(myEntry);
+        }
+        return myEntry.m_valid;
+    }
+    
     bool getStatisticsString(const CaretMappableDataFile* dataFile, const int32_t& mapIndex, const vector<int32_t> nodeLists[2],
                              const SurfaceFile& surface, const MetricFile* correctedAreasMetric, const float& excludeDist, AString& statsOut)
     {
@@ -617,6 +744,8 @@ BorderOptimizeExecutor::run(const InputData& inputData,
         inputRoi.setNumberOfNodesAndColumns(numNodes, 1);
         inputRoi.setValuesForColumn(0, inputRoiData.data());
         AlgorithmMetricDilate(NULL, &inputRoi, computeSurf, 0.0001f, &dilatedRoi);//dilate roi by 1 neighbor
+        vector<GradientCacheEntry> newGradientCache;
+        int64_t newGradientCacheValues = 0;
         for (int i = 0; i < numInputs; ++i)
         {
             EventProgressUpdate tempEvent(0, PROGRESS_MAX, SEGMENT_PROGRESS + (COMPUTE_PROGRESS * i) / numInputs,
@@ -632,24 +761,27 @@ BorderOptimizeExecutor::run(const InputData& inputData,
             {
                 for (int j = 0; j < inputData.m_dataFileInfo[i].m_mapFile->getNumberOfMaps(); ++j)
                 {
-                    if (extractGradientData(inputData.m_dataFileInfo[i].m_mapFile, j, computeSurf, &dilatedRoi,
-                                            inputData.m_dataFileInfo[i].m_smoothing, correctedAreasMetric, tempGradient,
-                                            inputData.m_dataFileInfo[i].m_skipGradient, inputData.m_dataFileInfo[i].m_corrGradExcludeDist))
+                    if (extractGradientDataCached(inputData.m_dataFileInfo[i].m_mapFile, j, computeSurf, &dilatedRoi,
+                                                  inputData.m_dataFileInfo[i].m_smoothing, correctedAreasMetric, tempGradient,
+                                                  inputData.m_dataFileInfo[i].m_skipGradient, inputData.m_dataFileInfo[i].m_corrGradExcludeDist,
+                                                  inputData.m_nodesInsideROI, newGradientCache, newGradientCacheValues))
                     {
                         doCombination(tempGradient, inputData.m_nodesInsideROI, inputData.m_dataFileInfo[i].m_invertGradientFlag,
                                     inputData.m_dataFileInfo[i].m_weight, combinedGradData);
                     }
                 }
             } else {
-                if (extractGradientData(inputData.m_dataFileInfo[i].m_mapFile, inputData.m_dataFileInfo[i].m_mapIndex, computeSurf,
-                                        &dilatedRoi, inputData.m_dataFileInfo[i].m_smoothing, correctedAreasMetric, tempGradient,
-                                        inputData.m_dataFileInfo[i].m_skipGradient, inputData.m_dataFileInfo[i].m_corrGradExcludeDist))
+                if (extractGradientDataCached(inputData.m_dataFileInfo[i].m_mapFile, inputData.m_dataFileInfo[i].m_mapIndex, computeSurf,
+                                              &dilatedRoi, inputData.m_dataFileInfo[i].m_smoothing, correctedAreasMetric, tempGradient,
+                                              inputData.m_dataFileInfo[i].m_skipGradient, inputData.m_dataFileInfo[i].m_corrGradExcludeDist,
+                                              inputData.m_nodesInsideROI, newGradientCache, newGradientCacheValues))
                 {
                     doCombination(tempGradient, inputData.m_nodesInsideROI, inputData.m_dataFileInfo[i].m_invertGradientFlag,
                                 inputData.m_dataFileInfo[i].m_weight, combinedGradData);
                 }
             }
         }
+        gradientCache.swap(newGradientCache);//only keep what this run used
         stageString = "border drawing";
         if (inputData.m_combinedGradientDataOut != NULL)
         {
@@ -716,14 +848,10 @@ BorderOptimizeExecutor::run(const InputData& inputData,
                 return false;
             }
         }
-        CaretPointer<GeodesicHelper> myGeoHelp;
         CaretPointer<GeodesicHelperBase> myGeoBase;
         if (correctedAreasMetric != NULL)
         {
             myGeoBase.grabNew(new GeodesicHelperBase(drawSurf, drawAreas));
-            myGeoHelp.grabNew(new GeodesicHelper(myGeoBase));
-        } else {
-            myGeoHelp = drawSurf->getGeodesicHelper();
         }
         CaretPointer<TopologyHelper> myTopoHelp = drawSurf->getTopologyHelper();
         vector<Border*> drawOrigBorders = inputData.m_borders;
@@ -742,6 +870,46 @@ BorderOptimizeExecutor::run(const InputData& inputData,
             }
         }
         vector<float> roiMinusTracesData = drawRoi;
+        {
+            EventProgressUpdate tempEvent(0, PROGRESS_MAX, SEGMENT_PROGRESS + COMPUTE_PROGRESS + HELPER_PROGRESS,
+                                        "searching for border segment paths");
+            EventManager::get()->sendEvent(&tempEvent);
+            if (tempEvent.isCancelled())
+            {
+                errorMessageOut = "cancelled by user";
+                return false;
+            }
+        }
+        vector<pair<int32_t, int32_t> > pathEnds(numBorders);
+        for (int i = 0; i < numBorders; ++i)
+        {
+            pathEnds[i] = make_pair(getBorderPointNode(drawOrigBorders[i], myRedrawInfo[i].startpoint), getBorderPointNode(drawOrigBorders[i], myRedrawInfo[i].endpoint));
+        }
+        vector<vector<int32_t> > pathNodes(numBorders);
+#pragma omp CARET_PAR
+        {//paths are independent, so search them in parallel, each thread needs its own helper
+            CaretPointer<GeodesicHelper> threadGeoHelp;
+            if (correctedAreasMetric != NULL)
+            {
+                threadGeoHelp.grabNew(new GeodesicHelper(myGeoBase));
+            } else {
+                threadGeoHelp = drawSurf->getGeodesicHelper();
+            }
+#pragma omp CARET_FOR schedule(dynamic)
+            for (int i = 0; i < numBorders; ++i)
+            {
+                vector<float> dists;
+                map<pair<int32_t, int32_t>, vector<int32_t> >::const_iterator previous = previousPaths.find(pathEnds[i]);
+                const vector<int32_t>* boundingPath = (previous == previousPaths.end() ? NULL : &(previous->second));//a small settings change usually leaves the old path close to optimal
+                threadGeoHelp->getPathFollowingData(pathEnds[i].first, pathEnds[i].second, drawGrad.data(), pathNodes[i], dists,
+                                                    inputData.m_gradientFollowingStrength, drawRoi.data(), true, true, boundingPath);
+            }
+        }
+        previousPaths.clear();
+        for (int i = 0; i < numBorders; ++i)
+        {
+            if (!pathNodes[i].empty()) previousPaths[pathEnds[i]] = pathNodes[i];
+        }
         BorderFile redrawnSegments;
         for (int i = 0; i < numBorders; ++i)
         {
@@ -753,10 +921,7 @@ BorderOptimizeExecutor::run(const InputData& inputData,
                 errorMessageOut = "cancelled by user";
                 return false;
             }
-            vector<int32_t> nodes;
-            vector<float> dists;
-            myGeoHelp->getPathFollowingData(getBorderPointNode(drawOrigBorders[i], myRedrawInfo[i].startpoint), getBorderPointNode(drawOrigBorders[i], myRedrawInfo[i].endpoint),
-                                            drawGrad.data(), nodes, dists, inputData.m_gradientFollowingStrength, drawRoi.data(), true, true);
+            const vector<int32_t>& nodes = pathNodes[i];
             if (nodes.size() < 3)//require at least 1 surviving point after removing endpoints
             {
                 errorMessageOut = "Unable to redraw border segment for border '" + inputData.m_borders[i]->getName() + "'";
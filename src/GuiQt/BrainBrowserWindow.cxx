@@ -1329,6 +1329,13 @@ BrainBrowserWindow::createActions()
                                 this,
                                 SLOT(processDevelopGraphicsTiming()));
     
+    m_developerEventStatisticsAction =
+    WuQtUtilities::createAction("Event Statistics",
+                                "Show the number of events sent and the time spent processing them since the last time shown",
+                                this,
+                                this,
+                                SLOT(processDevelopEventStatistics()));
+    
     m_developerExportVtkFileAction = 
     WuQtUtilities::createAction("Export to VTK File",
                                 "Export model(s) to VTK File",
@@ -1397,6 +1404,7 @@ BrainBrowserWindow::createMenuDevelop()
     m_developerExportVtkFileAction->setVisible(false);
     
     menu->addAction(m_developerGraphicsTimingAction);
+    menu->addAction(m_developerEventStatisticsAction);
     
     std::vector<DeveloperFlagsEnum::Enum> developerFlags;
     DeveloperFlagsEnum::getAllEnums(developerFlags);
@@ -2666,6 +2674,22 @@ BrainBrowserWindow::processDevelopGraphicsTiming()
     WuQMessageBox::informationOk(this, msg);
 }
 
+/**
+ * Show and log the event statistics and then reset them so that
+ * the next time shows only the events sent in between.
+ */
+void
+BrainBrowserWindow::processDevelopEventStatistics()
+{
+    EventManager* eventManager = EventManager::get();
+    const AString text = eventManager->getEventStatistics();
+    eventManager->resetEventStatistics();
+    
+    CaretLogInfo(text);
+    WuQMessageBox::informationOk(this,
+                                 "<pre>" + text + "</pre>");
+}
+
 
 /**
  * Export to VTK file.
@@ -217,6 +217,8 @@ namespace caret {
         
         void processDevelopGraphicsTiming();
         
+        void processDevelopEventStatistics();
+        
         void processDevelopExportVtkFile();
         void developerMenuAboutToShow();
         void developerMenuFlagTriggered(QAction*);
@@ -372,6 +374,7 @@ namespace caret {
         QAction* m_developMenuAction;
         QActionGroup* m_developerFlagsActionGroup;
         QAction* m_developerGraphicsTimingAction;
+        QAction* m_developerEventStatisticsAction;
         QAction* m_developerExportVtkFileAction;
         
         QAction* m_overlayToolBoxAction;
@@ -45,6 +45,7 @@
 #include "CaretMappableDataFile.h"
 #include "ChartingDataManager.h"
 #include "CiftiConnectivityMatrixDataFileManager.h"
+#include "CiftiConnectivityMatrixRowLoader.h"
 #include "CiftiFiberTrajectoryManager.h"
 #include "CiftiConnectivityMatrixParcelFile.h"
 #include "CiftiScalarDataSeriesFile.h"
@@ -174,6 +175,8 @@ GuiManager::initializeGuiManager()
     
     this->cursorManager = new CursorManager();
     
+    CiftiConnectivityMatrixRowLoader::setCompletionEventReceiver(this);
+    
     /*
      * Information window.
      */
@@ -296,6 +299,7 @@ GuiManager::initializeGuiManager()
 GuiManager::~GuiManager()
 {
     EventManager::get()->removeAllEventsFromListener(this);
+    CiftiConnectivityMatrixRowLoader::setCompletionEventReceiver(NULL);
     
     delete this->cursorManager;
     
@@ -2885,5 +2889,98 @@ GuiManager::processIdentification(const int32_t tabIndex,
     }
 } // tabIndex
 
+/**
+ * Load connectivity data for a surface node without waiting for the
+ * data to be read.  Used when the user moves the mouse across a surface
+ * so that reading rows from large connectivity files does not stall the
+ * user interface.  Older requests that have not finished are abandoned
+ * and the graphics are updated when the data for the newest request
+ * has been read.
+ *
+ * @param surface
+ *    Surface containing the node.
+ * @param nodeIndex
+ *    Index of the node.
+ */
+void
+GuiManager::processConnectivityLoadingForSurfaceNodeAsynchronously(const Surface* surface,
+                                                                   const int32_t nodeIndex)
+{
+    CaretAssert(surface);
+    
+    m_connectivityLoadErrorParent = NULL;
+    
+    CiftiConnectivityMatrixDataFileManager* ciftiConnectivityManager = SessionManager::get()->getCiftiConnectivityMatrixDataFileManager();
+    ciftiConnectivityManager->requestDataForSurfaceNodeAsynchronously(getBrain(),
+                                                                      surface,
+                                                                      nodeIndex);
+}
+
+/**
+ * Load the average of connectivity data for surface nodes (such as the
+ * nodes in a parcel or inside a border) without waiting for the data to
+ * be read.  The graphics are updated when the data has been read, and
+ * an error dialog is displayed if reading fails.
+ *
+ * @param surface
+ *    Surface containing the nodes.
+ * @param nodeIndices
+ *    Indices of the nodes.
+ * @param parentForErrors
+ *    Parent for the error dialog if loading fails.
+ * @return
+ *    True if any file will load data, false if no displayed
+ *    connectivity file has data for the nodes.
+ */
+bool
+GuiManager::processConnectivityAverageLoadingForSurfaceNodesAsynchronously(const Surface* surface,
+                                                                           const std::vector<int32_t>& nodeIndices,
+                                                                           QWidget* parentForErrors)
+{
+    CaretAssert(surface);
+    
+    m_connectivityLoadErrorParent = parentForErrors;
+    
+    CiftiConnectivityMatrixDataFileManager* ciftiConnectivityManager = SessionManager::get()->getCiftiConnectivityMatrixDataFileManager();
+    return ciftiConnectivityManager->requestAverageDataForSurfaceNodesAsynchronously(getBrain(),
+                                                                                     surface,
+                                                                                     nodeIndices);
+}
+
+/**
+ * Receives events queued by other threads.  A connectivity row loader
+ * posts an event when asynchronously loaded data is ready and the data
+ * is made available for display here, on the GUI thread.  Load errors
+ * are reported here too, since the loading thread cannot display them.
+ *
+ * @param event
+ *    The event.
+ */
+void
+GuiManager::customEvent(QEvent* event)
+{
+    if (event->type() == CiftiConnectivityMatrixRowLoader::getCompletionEventType()) {
+        CiftiConnectivityMatrixDataFileManager* ciftiConnectivityManager = SessionManager::get()->getCiftiConnectivityMatrixDataFileManager();
+        AString errorMessage;
+        if (ciftiConnectivityManager->finishAsynchronousLoading(getBrain(),
+                                                                errorMessage)) {
+            EventManager::get()->sendEvent(EventGraphicsUpdateAllWindows().getPointer());
+            EventManager::get()->sendEvent(EventUserInterfaceUpdate().addToolBar().addToolBox().getPointer());
+        }
+        if ( ! errorMessage.isEmpty()) {
+            if (m_connectivityLoadErrorParent.isNull()) {
+                CaretLogSevere(errorMessage);
+            }
+            else {
+                WuQMessageBox::errorOk(m_connectivityLoadErrorParent,
+                                       errorMessage);
+            }
+        }
+        return;
+    }
+    
+    QObject::customEvent(event);
+}
+
 
 
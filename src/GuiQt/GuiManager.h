@@ -28,6 +28,7 @@
 #include <stdint.h>
 
 #include <QObject>
+#include <QPointer>
 
 #include "DataFileTypeEnum.h"
 #include "EventListenerInterface.h"
@@ -63,6 +64,7 @@ namespace caret {
     class SceneFile;
     class SelectionManager;
     class SpecFile;
+    class Surface;
     class SurfacePropertiesEditorDialog;
     class TileTabsConfigurationDialog;
     
@@ -168,6 +170,13 @@ namespace caret {
                                    SelectionManager* selectionManager,
                                    QWidget* parentWidget);
         
+        void processConnectivityLoadingForSurfaceNodeAsynchronously(const Surface* surface,
+                                                                    const int32_t nodeIndex);
+        
+        bool processConnectivityAverageLoadingForSurfaceNodesAsynchronously(const Surface* surface,
+                                                                            const std::vector<int32_t>& nodeIndices,
+                                                                            QWidget* parentForErrors);
+        
         /*
          * Mode used when testing for modified files
          */
@@ -202,6 +211,9 @@ namespace caret {
         void sceneDialogWasClosed();
         void identifyBrainordinateDialogWasClosed();
         
+    protected:
+        virtual void customEvent(QEvent* event);
+        
     private:
         GuiManager(QObject* parent = 0);
         
@@ -329,6 +341,13 @@ namespace caret {
          * the data file is opened.
          */
         AString m_nameOfDataFileToOpenAfterStartup;
+        
+        /**
+         * Parent for the error dialog when the newest asynchronous
+         * connectivity load fails.  NULL when the load was not requested
+         * by the user (mouse movement), those errors are only logged.
+         */
+        QPointer<QWidget> m_connectivityLoadErrorParent;
     };
     
 #ifdef __GUI_MANAGER_DEFINE__
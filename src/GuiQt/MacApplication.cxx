@@ -50,7 +50,7 @@ using namespace caret;
  * Constructor.
  */
 MacApplication::MacApplication(int& argc, char** argv)
-: QApplication(argc, argv)
+: WorkbenchApplication(argc, argv)
 {
     
 }
@@ -89,7 +89,7 @@ MacApplication::event(QEvent *event)
         }
             break;
         default:
-            eventWasProcessed = QApplication::event(event);
+            eventWasProcessed = WorkbenchApplication::event(event);
             break;
     }
     
@@ -25,11 +25,11 @@
  * Based upon: http://www.qtcentre.org/wiki/index.php?title=Opening_documents_in_the_Mac_OS_X_Finder&printable=yes&useskin=vector
  */
 
-#include <QApplication>
+#include "WorkbenchApplication.h"
 
 namespace caret {
 
-    class MacApplication : public QApplication {
+    class MacApplication : public WorkbenchApplication {
         
         Q_OBJECT
 
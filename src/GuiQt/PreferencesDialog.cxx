@@ -331,6 +331,19 @@ PreferencesDialog::createMiscellaneousWidget()
                      this, SLOT(miscDynamicConnectivityComboBoxChanged(bool)));
     m_allWidgets->add(m_dynamicConnectivityComboBox);
     
+    /*
+     * Connectivity row cache size
+     */
+    m_miscConnectivityRowCacheSizeSpinBox = WuQFactory::newSpinBoxWithMinMaxStepSignalInt(0,
+                                                                                          65536,
+                                                                                          64,
+                                                                                          this,
+                                                                                          SLOT(miscConnectivityRowCacheSizeChanged(int)));
+    m_miscConnectivityRowCacheSizeSpinBox->setSuffix(" MB");
+    m_miscConnectivityRowCacheSizeSpinBox->setToolTip("Memory used to keep recently loaded connectivity rows.\n"
+                                                      "Zero disables keeping of rows.");
+    m_allWidgets->add(m_miscConnectivityRowCacheSizeSpinBox);
+    
     /*
      * Logging Level
      */
@@ -391,6 +404,9 @@ PreferencesDialog::createMiscellaneousWidget()
     addWidgetToLayout(gridLayout,
                       "Show Dynconn By Default: ",
                       m_dynamicConnectivityComboBox->getWidget());
+    addWidgetToLayout(gridLayout,
+                      "Connectivity Row Cache: ",
+                      m_miscConnectivityRowCacheSizeSpinBox);
     addWidgetToLayout(gridLayout,
                       "Logging Level: ",
                       m_miscLoggingLevelComboBox);
@@ -425,6 +441,8 @@ PreferencesDialog::updateMiscellaneousWidget(CaretPreferences* prefs)
 {
     m_dynamicConnectivityComboBox->setStatus(prefs->isDynamicConnectivityDefaultedOn());
     
+    m_miscConnectivityRowCacheSizeSpinBox->setValue(prefs->getConnectivityRowCacheSizeMegabytes());
+    
     const LogLevelEnum::Enum loggingLevel = prefs->getLoggingLevel();
     int indx = m_miscLoggingLevelComboBox->findData(LogLevelEnum::toIntegerCode(loggingLevel));
     if (indx >= 0) {
@@ -1040,4 +1058,15 @@ PreferencesDialog::miscSpecFileDialogViewFilesTypeEnumComboBoxItemActivated()
     prefs->setManageFilesViewFileType(viewFilesType);
 }
 
-
+/**
+ * Called when the connectivity row cache size is changed.
+ *
+ * @param value
+ *    New value, in megabytes.
+ */
+void
+PreferencesDialog::miscConnectivityRowCacheSizeChanged(int value)
+{
+    CaretPreferences* prefs = SessionManager::get()->getCaretPreferences();
+    prefs->setConnectivityRowCacheSizeMegabytes(value);
+}
@@ -62,6 +62,8 @@ namespace caret {
         
         void miscDynamicConnectivityComboBoxChanged(bool value);
         
+        void miscConnectivityRowCacheSizeChanged(int value);
+        
         void openGLDrawingMethodEnumComboBoxItemActivated();
         void openGLImageCaptureMethodEnumComboBoxItemActivated();
         
@@ -142,6 +144,8 @@ namespace caret {
 
         WuQTrueFalseComboBox* m_dynamicConnectivityComboBox;
         
+        QSpinBox* m_miscConnectivityRowCacheSizeSpinBox;
+        
         WuQTrueFalseComboBox* m_volumeAxesCrosshairsComboBox;
         WuQTrueFalseComboBox* m_volumeAxesLabelsComboBox;
         WuQTrueFalseComboBox* m_volumeAxesMontageCoordinatesComboBox;
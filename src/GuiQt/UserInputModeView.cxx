@@ -34,6 +34,9 @@
 #include "EventManager.h"
 #include "GuiManager.h"
 #include "MouseEvent.h"
+#include "SelectionItemSurfaceNode.h"
+#include "SelectionManager.h"
+#include "Surface.h"
 #include "UserInputModeViewContextMenu.h"
 
 using namespace caret;
@@ -242,6 +245,9 @@ UserInputModeView::mouseLeftDrag(const MouseEvent& mouseEvent)
 
 /**
  * Process a mouse left drag with only the alt key down event.
+ * Connectivity data is loaded for the surface node under the mouse
+ * without waiting for the data to be read so that the user can
+ * sweep the mouse across the surface.
  *
  * @param mouseEvent
  *     Mouse event information.
@@ -252,6 +258,19 @@ UserInputModeView::mouseLeftDragWithAlt(const MouseEvent& mouseEvent)
     if (mouseEvent.getViewportContent() == NULL) {
         return;
     }
+    
+    BrainOpenGLWidget* openGLWidget = mouseEvent.getOpenGLWidget();
+    SelectionManager* selectionManager = openGLWidget->performIdentification(mouseEvent.getX(),
+                                                                             mouseEvent.getY(),
+                                                                             false);
+    const SelectionItemSurfaceNode* idNode = selectionManager->getSurfaceNodeIdentification();
+    if (idNode->isValid()) {
+        const Surface* surface = idNode->getSurface();
+        if (surface != NULL) {
+            GuiManager::get()->processConnectivityLoadingForSurfaceNodeAsynchronously(surface,
+                                                                                      idNode->getNodeNumber());
+        }
+    }
 }
 
 /**
@@ -805,33 +805,45 @@ UserInputModeViewContextMenu::parcelCiftiConnectivityActionSelected(QAction* act
     }
     
     
-    CursorDisplayScoped cursor;
-    cursor.showWaitCursor();
-    
-    try {
-        ProgressReportingDialog progressDialog("Connectivity Within Parcel",
-                                               "",
-                                               this);
-        progressDialog.setValue(0);
-        
-        switch (pc->parcelType) {
-            case ParcelConnectivity::PARCEL_TYPE_INVALID:
-                break;
-            case ParcelConnectivity::PARCEL_TYPE_SURFACE_NODES:
-                pc->ciftiConnectivityManager->loadAverageDataForSurfaceNodes(pc->brain,
-                                                                             pc->surface,
-                                                                             nodeIndices);
-                break;
-            case ParcelConnectivity::PARCEL_TYPE_VOLUME_VOXELS:
+    switch (pc->parcelType) {
+        case ParcelConnectivity::PARCEL_TYPE_INVALID:
+            break;
+        case ParcelConnectivity::PARCEL_TYPE_SURFACE_NODES:
+            /*
+             * Rows are read and averaged by the row loader's thread,
+             * the graphics are updated and any error is displayed
+             * when averaging completes.
+             */
+            if ( ! GuiManager::get()->processConnectivityAverageLoadingForSurfaceNodesAsynchronously(pc->surface,
+                                                                                                      nodeIndices,
+                                                                                                      this->parentOpenGLWidget)) {
+                WuQMessageBox::informationOk(this->parentOpenGLWidget,
+                                             "No connectivity data was loaded.  No displayed connectivity "
+                                             "file has data loading enabled for the parcel's vertices.");
+                return;
+            }
+            break;
+        case ParcelConnectivity::PARCEL_TYPE_VOLUME_VOXELS:
+        {
+            CursorDisplayScoped cursor;
+            cursor.showWaitCursor();
+            
+            try {
+                ProgressReportingDialog progressDialog("Connectivity Within Parcel",
+                                                       "",
+                                                       this);
+                progressDialog.setValue(0);
+                
                 pc->ciftiConnectivityManager->loadAverageDataForVoxelIndices(pc->brain,
                                                                              pc->volumeDimensions,
                                                                              voxelIndices);
-                break;
+            }
+            catch (const DataFileException& e) {
+                cursor.restoreCursor();
+                WuQMessageBox::errorOk(this, e.whatString());
+            }
         }
-    }
-    catch (const DataFileException& e) {
-        cursor.restoreCursor();
-        WuQMessageBox::errorOk(this, e.whatString());
+            break;
     }
     
     
@@ -948,25 +960,20 @@ UserInputModeViewContextMenu::borderCiftiConnectivitySelected()
             }
         }
         
-        CursorDisplayScoped cursor;
-        cursor.showWaitCursor();
-        
-        try {
-            ProgressReportingDialog progressDialog("Connectivity Within Border",
-                                                   "",
-                                                   this);
-            progressDialog.setValue(0);
-            CiftiConnectivityMatrixDataFileManager* ciftiConnMann = SessionManager::get()->getCiftiConnectivityMatrixDataFileManager();
-            ciftiConnMann->loadAverageDataForSurfaceNodes(borderID->getBrain(),
-                                                          surface,
-                                                          nodeIndices);
-        }
-        catch (const DataFileException& e) {
-            cursor.restoreCursor();
-            WuQMessageBox::errorOk(this, e.whatString());
+        /*
+         * Rows are read and averaged by the row loader's thread,
+         * the graphics are updated and any error is displayed
+         * when averaging completes.
+         */
+        if ( ! GuiManager::get()->processConnectivityAverageLoadingForSurfaceNodesAsynchronously(surface,
+                                                                                                  nodeIndices,
+                                                                                                  this->parentOpenGLWidget)) {
+            WuQMessageBox::informationOk(this->parentOpenGLWidget,
+                                         "No connectivity data was loaded.  No displayed connectivity "
+                                         "file has data loading enabled for the border's vertices.");
+            return;
         }
         
-        
         EventManager::get()->sendEvent(EventUserInterfaceUpdate().getPointer());
         EventManager::get()->sendEvent(EventGraphicsUpdateAllWindows().getPointer());
     }
@@ -0,0 +1,96 @@
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2016  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#define __WORKBENCH_APPLICATION_DECLARE__
+#include "WorkbenchApplication.h"
+#undef __WORKBENCH_APPLICATION_DECLARE__
+
+#include <QThread>
+
+#include "VolumeBase.h"
+
+using namespace caret;
+
+
+    
+/**
+ * \class caret::WorkbenchApplication 
+ * \brief Subclass of QApplication used by wb_view
+ * \ingroup GuiQt
+ *
+ * Frames of volumes that are read on demand may be evicted while
+ * code is still using pointers to them, so evicted frames are freed
+ * only when no event is being processed by the GUI thread.  Code
+ * that uses volume frames always runs inside some event (including
+ * events processed by nested event loops), so when the outermost
+ * event returns, no frames are in use.
+ */
+
+/**
+ * Constructor.
+ */
+WorkbenchApplication::WorkbenchApplication(int& argc, char** argv)
+: QApplication(argc, argv)
+{
+    
+}
+
+/**
+ * Destructor.
+ */
+WorkbenchApplication::~WorkbenchApplication()
+{
+    
+}
+
+/**
+ * Deliver an event to a receiver.
+ *
+ * @param receiver
+ *    Receiver of the event.
+ * @param event
+ *    The event.
+ * @return Value returned by the receiver's event handler.
+ */
+bool
+WorkbenchApplication::notify(QObject* receiver,
+                             QEvent* event)
+{
+    if (QThread::currentThread() != thread()) {
+        return QApplication::notify(receiver, event);
+    }
+    
+    /*
+     * Volume frames are released by the outermost event
+     */
+    VolumeBase::beginFrameUse();
+    bool result = false;
+    try {
+        result = QApplication::notify(receiver, event);
+    }
+    catch (...) {
+        VolumeBase::endFrameUse();
+        throw;
+    }
+    VolumeBase::endFrameUse();
+    
+    return result;
+}
@@ -0,0 +1,52 @@
+#ifndef __WORKBENCH_APPLICATION_H__
+#define __WORKBENCH_APPLICATION_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2016  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include <QApplication>
+
+namespace caret {
+
+    class WorkbenchApplication : public QApplication {
+        
+    public:
+        WorkbenchApplication(int& argc, char** argv);
+        
+        virtual ~WorkbenchApplication();
+        
+        virtual bool notify(QObject* receiver,
+                            QEvent* event);
+        
+    private:
+        WorkbenchApplication(const WorkbenchApplication&);
+
+        WorkbenchApplication& operator=(const WorkbenchApplication&);
+        
+        // ADD_NEW_MEMBERS_HERE
+
+    };
+    
+#ifdef __WORKBENCH_APPLICATION_DECLARE__
+    // <PLACE DECLARATIONS OF STATIC MEMBERS HERE>
+#endif // __WORKBENCH_APPLICATION_DECLARE__
+
+} // namespace
+#endif  //__WORKBENCH_APPLICATION_H__
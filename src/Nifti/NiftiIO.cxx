@@ -90,6 +90,56 @@ int NiftiIO::getNumComponents() const
     }
 }
 
+void NiftiIO::getFrameRange(const int& fullDims, const vector<int64_t>& indexSelect, const int64_t& numConsecutive, int64_t& numSkipOut, int64_t& numElemsOut) const
+{
+    CaretAssert(fullDims >= 0 && fullDims <= (int)m_dims.size());
+    CaretAssert((size_t)fullDims + indexSelect.size() == m_dims.size());//could be >=, but should catch more stupid mistakes as ==
+    CaretAssert(numConsecutive >= 1);
+    numElemsOut = getNumComponents();//for now, calculate read size on the fly, as the read call will be the slowest part
+    int curDim;
+    for (curDim = 0; curDim < fullDims; ++curDim)
+    {
+        numElemsOut *= m_dims[curDim];
+    }
+    int64_t numDimSkip = numElemsOut;
+    numSkipOut = 0;
+    for (; curDim < (int)m_dims.size(); ++curDim)
+    {
+        CaretAssert(indexSelect[curDim - fullDims] >= 0 && indexSelect[curDim - fullDims] < m_dims[curDim]);
+        numSkipOut += indexSelect[curDim - fullDims] * numDimSkip;
+        numDimSkip *= m_dims[curDim];
+    }
+    if (numConsecutive > 1)
+    {
+        CaretAssert(fullDims < (int)m_dims.size() && indexSelect[0] + numConsecutive <= m_dims[fullDims]);//frames must not wrap into the next higher dimension
+        numElemsOut *= numConsecutive;
+    }
+}
+
+void NiftiIO::readConsecutiveRaw(char* dataOut, const int& fullDims, const vector<int64_t>& indexSelect, const int64_t& numConsecutive)
+{
+    int64_t numSkip, numElems;
+    getFrameRange(fullDims, indexSelect, numConsecutive, numSkip, numElems);
+    CaretMutexLocker locked(&m_mutex);//protect the file position
+    const int64_t numBytes = numElems * numBytesPerElem();
+    m_file.seek(numSkip * numBytesPerElem() + m_header.getDataOffset());
+    int64_t numRead = 0;
+    m_file.read(dataOut, numBytes, &numRead);
+    if (numRead != numBytes)
+    {
+        throw DataFileException("error while reading from nifti file '" + m_file.getFilename() + "'");
+    }
+}
+
+void NiftiIO::writeConsecutiveRaw(const char* dataIn, const int& fullDims, const vector<int64_t>& indexSelect, const int64_t& numConsecutive)
+{
+    int64_t numSkip, numElems;
+    getFrameRange(fullDims, indexSelect, numConsecutive, numSkip, numElems);
+    CaretMutexLocker locked(&m_mutex);
+    m_file.seek(numSkip * numBytesPerElem() + m_header.getDataOffset());
+    m_file.write(dataIn, numElems * numBytesPerElem());
+}
+
 int NiftiIO::numBytesPerElem()
 {
     switch (m_header.getDataType())
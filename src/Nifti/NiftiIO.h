@@ -49,6 +49,9 @@ namespace caret
         void convertRead(TO* out, FROM* in, const int64_t& count);//for reading from file
         template<typename TO, typename FROM>
         void convertWrite(TO* out, const FROM* in, const int64_t& count);//for writing to file
+        template<typename TO>
+        static TO roundAndClamp(const long double& value);//for integer output types, saturate instead of wrapping, NaN becomes 0 (scaled writing handles NaN itself)
+        void getFrameRange(const int& fullDims, const std::vector<int64_t>& indexSelect, const int64_t& numConsecutive, int64_t& numSkipOut, int64_t& numElemsOut) const;//in elements, including components
     public:
         void openRead(const QString& filename);
         void writeNew(const QString& filename, const NiftiHeader& header, const int& version = 1, const bool& withRead = false, const bool& swapEndian = false);
@@ -62,28 +65,30 @@ namespace caret
         //NOTE: you need to provide storage for all components within the range, if getNumComponents() == 3 and fullDims == 0, you need 3 elements allocated
         template<typename T>
         void readData(T* dataOut, const int& fullDims, const std::vector<int64_t>& indexSelect, const bool& tolerateShortRead = false);
+        //reads numConsecutive adjacent frames along the first non-full dimension in a single file access, starting at the frame given by indexSelect
+        template<typename T>
+        void readConsecutiveData(T* dataOut, const int& fullDims, const std::vector<int64_t>& indexSelect, const int64_t& numConsecutive, const bool& tolerateShortRead = false);
         template<typename T>
         void writeData(const T* dataIn, const int& fullDims, const std::vector<int64_t>& indexSelect);
+        //writes numConsecutive adjacent frames in a single file access, like readConsecutiveData
+        template<typename T>
+        void writeConsecutiveData(const T* dataIn, const int& fullDims, const std::vector<int64_t>& indexSelect, const int64_t& numConsecutive);
+        //the bytes as stored in the file, without byteswapping, scaling or type conversion - only for copying between files with identical data type, scaling and byte order
+        void readConsecutiveRaw(char* dataOut, const int& fullDims, const std::vector<int64_t>& indexSelect, const int64_t& numConsecutive);
+        void writeConsecutiveRaw(const char* dataIn, const int& fullDims, const std::vector<int64_t>& indexSelect, const int64_t& numConsecutive);
     };
     
     template<typename T>
     void NiftiIO::readData(T* dataOut, const int& fullDims, const std::vector<int64_t>& indexSelect, const bool& tolerateShortRead)
     {
-        CaretAssert(fullDims >= 0 && fullDims <= (int)m_dims.size());
-        CaretAssert((size_t)fullDims + indexSelect.size() == m_dims.size());//could be >=, but should catch more stupid mistakes as ==
-        int64_t numElems = getNumComponents();//for now, calculate read size on the fly, as the read call will be the slowest part
-        int curDim;
-        for (curDim = 0; curDim < fullDims; ++curDim)
-        {
-            numElems *= m_dims[curDim];
-        }
-        int64_t numDimSkip = numElems, numSkip = 0;
-        for (; curDim < (int)m_dims.size(); ++curDim)
-        {
-            CaretAssert(indexSelect[curDim - fullDims] >= 0 && indexSelect[curDim - fullDims] < m_dims[curDim]);
-            numSkip += indexSelect[curDim - fullDims] * numDimSkip;
-            numDimSkip *= m_dims[curDim];
-        }
+        readConsecutiveData(dataOut, fullDims, indexSelect, 1, tolerateShortRead);
+    }
+    
+    template<typename T>
+    void NiftiIO::readConsecutiveData(T* dataOut, const int& fullDims, const std::vector<int64_t>& indexSelect, const int64_t& numConsecutive, const bool& tolerateShortRead)
+    {
+        int64_t numSkip, numElems;
+        getFrameRange(fullDims, indexSelect, numConsecutive, numSkip, numElems);
         CaretMutexLocker locked(&m_mutex);//protect starting with resizing until we are done converting, because we use an internal variable for scratch space
         //we can't guarantee that the output memory is enough to use as scratch space, as we might be doing a narrowing conversion
         //we are doing FILE ACCESS, so cpu performance isn't really something to worry about
@@ -143,21 +148,14 @@ namespace caret
     template<typename T>
     void NiftiIO::writeData(const T* dataIn, const int& fullDims, const std::vector<int64_t>& indexSelect)
     {
-        CaretAssert(fullDims >= 0 && fullDims <= (int)m_dims.size());
-        CaretAssert((size_t)fullDims + indexSelect.size() == m_dims.size());//could be >=, but should catch more stupid mistakes as ==
-        int64_t numElems = getNumComponents();//for now, calculate read size on the fly, as the read call will be the slowest part
-        int curDim;
-        for (curDim = 0; curDim < fullDims; ++curDim)
-        {
-            numElems *= m_dims[curDim];
-        }
-        int64_t numDimSkip = numElems, numSkip = 0;
-        for (; curDim < (int)m_dims.size(); ++curDim)
-        {
-            CaretAssert(indexSelect[curDim - fullDims] >= 0 && indexSelect[curDim - fullDims] < m_dims[curDim]);
-            numSkip += indexSelect[curDim - fullDims] * numDimSkip;
-            numDimSkip *= m_dims[curDim];
-        }
+        writeConsecutiveData(dataIn, fullDims, indexSelect, 1);
+    }
+    
+    template<typename T>
+    void NiftiIO::writeConsecutiveData(const T* dataIn, const int& fullDims, const std::vector<int64_t>& indexSelect, const int64_t& numConsecutive)
+    {
+        int64_t numSkip, numElems;
+        getFrameRange(fullDims, indexSelect, numConsecutive, numSkip, numElems);
         CaretMutexLocker locked(&m_mutex);//protect starting with resizing until we are done writing, because we use an internal variable for scratch space
         //we are doing FILE ACCESS, so cpu performance isn't really something to worry about
         m_scratch.resize(numElems * numBytesPerElem());
@@ -256,14 +254,20 @@ namespace caret
         {
             if (doScale)
             {
+                const TO nanValue = roundAndClamp<TO>(-(long double)offset / mult);//NaN has no integer encoding, so write the value that reads back nearest to 0
                 for (int64_t i = 0; i < count; ++i)
                 {
-                    out[i] = (TO)floor(0.5 + ((long double)in[i] - offset) / mult);//we don't always need that much precision, but it will still be faster than hard drives
+                    if (in[i] != in[i])
+                    {
+                        out[i] = nanValue;
+                    } else {
+                        out[i] = roundAndClamp<TO>(((long double)in[i] - offset) / mult);//we don't always need that much precision, but it will still be faster than hard drives
+                    }
                 }
             } else {
                 for (int64_t i = 0; i < count; ++i)
                 {
-                    out[i] = (TO)floor(0.5 + in[i]);
+                    out[i] = roundAndClamp<TO>(in[i]);
                 }
             }
         } else {
@@ -283,6 +287,16 @@ namespace caret
         if (m_header.isSwapped()) ByteSwapping::swapArray(out, count);
     }
     
+    template<typename TO>
+    TO NiftiIO::roundAndClamp(const long double& value)
+    {
+        if (value != value) return 0;
+        long double rounded = floor(0.5 + value);
+        if (rounded <= (long double)std::numeric_limits<TO>::min()) return std::numeric_limits<TO>::min();
+        if (rounded >= (long double)std::numeric_limits<TO>::max()) return std::numeric_limits<TO>::max();
+        return (TO)rounded;
+    }
+    
 }
 
 #endif //__NIFTI_IO_H__
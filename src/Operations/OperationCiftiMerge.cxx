@@ -26,10 +26,23 @@
 #include "CiftiFile.h"
 
 #include <algorithm>
+#include <cstring>
 
 using namespace caret;
 using namespace std;
 
+namespace
+{
+    const int64_t MERGE_BLOCK_BYTES = ((int64_t)1) << 26;//rows of output per file access, so reads and writes stay mostly sequential
+    
+    struct ColumnRange
+    {
+        int m_input;
+        int64_t m_start, m_count;
+        bool m_reverse;
+    };
+}
+
 AString OperationCiftiMerge::getCommandSwitch()
 {
     return "-cifti-merge";
@@ -140,7 +153,7 @@ void OperationCiftiMerge::useParameters(OperationParameters* myParams, ProgressO
         default:
             CaretAssert(false);
     }
-    int64_t curCol = 0, scratchRowLength = 0;
+    int64_t curCol = 0;
     for (int i = 0; i < numInputs; ++i)
     {
         const CiftiFile* ciftiIn = myInputs[i]->getCifti(1);
@@ -150,7 +163,6 @@ void OperationCiftiMerge::useParameters(OperationParameters* myParams, ProgressO
         int numColumnOpts = (int)columnOpts.size();
         if (numColumnOpts > 0)
         {
-            scratchRowLength = max(scratchRowLength, thisXML.getDimensionLength(CiftiXML::ALONG_ROW));//if we use the entire row, we don't need a separate scratch row for it
             if (doLoop)
             {
                 for (int j = 0; j < numColumnOpts; ++j)
@@ -256,53 +268,101 @@ void OperationCiftiMerge::useParameters(OperationParameters* myParams, ProgressO
     }
     ciftiOut->setCiftiXML(outXML);
     int64_t numRows = baseColMapping.getLength();
-    vector<float> outRow(numOutColumns), scratchRow(scratchRowLength);
-    for (int64_t row = 0; row < numRows; ++row)
+    vector<ColumnRange> ranges;//where each part of the output row comes from, resolved once instead of per row
+    for (int i = 0; i < numInputs; ++i)
     {
-        curCol = 0;
-        for (int i = 0; i < numInputs; ++i)
+        const CiftiFile* ciftiIn = myInputs[i]->getCifti(1);
+        vector<int64_t> thisDims = ciftiIn->getDimensions();
+        const CiftiXML& thisXML = ciftiIn->getCiftiXML();
+        const vector<ParameterComponent*>& columnOpts = *(myInputs[i]->getRepeatableParameterInstances(2));
+        int numColumnOpts = (int)columnOpts.size();
+        if (numColumnOpts > 0)
         {
-            const CiftiFile* ciftiIn = myInputs[i]->getCifti(1);
-            vector<int64_t> thisDims = ciftiIn->getDimensions();
-            const CiftiXML& thisXML = ciftiIn->getCiftiXML();
-            const vector<ParameterComponent*>& columnOpts = *(myInputs[i]->getRepeatableParameterInstances(2));
-            int numColumnOpts = (int)columnOpts.size();
-            if (numColumnOpts > 0)
+            for (int j = 0; j < numColumnOpts; ++j)
             {
-                ciftiIn->getRow(scratchRow.data(), row);
-                for (int j = 0; j < numColumnOpts; ++j)
+                ColumnRange thisRange;
+                thisRange.m_input = i;
+                thisRange.m_start = thisXML.getMap(CiftiXML::ALONG_ROW)->getIndexFromNumberOrName(columnOpts[j]->getString(1));//this function has the 1-indexing convention built in
+                thisRange.m_count = 1;
+                thisRange.m_reverse = false;
+                OptionalParameter* upToOpt = columnOpts[j]->getOptionalParameter(2);//we already checked that these strings give a valid column
+                if (upToOpt->m_present)
                 {
-                    int64_t initialColumn = thisXML.getMap(CiftiXML::ALONG_ROW)->getIndexFromNumberOrName(columnOpts[j]->getString(1));//this function has the 1-indexing convention built in
-                    OptionalParameter* upToOpt = columnOpts[j]->getOptionalParameter(2);//we already checked that these strings give a valid column
-                    if (upToOpt->m_present)
+                    int64_t finalColumn = thisXML.getMap(CiftiXML::ALONG_ROW)->getIndexFromNumberOrName(upToOpt->getString(1));//ditto
+                    thisRange.m_count = finalColumn - thisRange.m_start + 1;
+                    thisRange.m_reverse = upToOpt->getOptionalParameter(2)->m_present;
+                }
+                ranges.push_back(thisRange);
+            }
+        } else {
+            ColumnRange thisRange;
+            thisRange.m_input = i;
+            thisRange.m_start = 0;
+            thisRange.m_count = thisDims[0];
+            thisRange.m_reverse = false;
+            ranges.push_back(thisRange);
+        }
+    }
+    bool rawCopy = true;//if every input has the output's on-disk format, splice bytes and skip the float conversion entirely
+    int64_t maxInColumns = 0;
+    for (int i = 0; i < numInputs; ++i)
+    {
+        const CiftiFile* ciftiIn = myInputs[i]->getCifti(1);
+        if (!ciftiOut->canCopyRawRowsFrom(*ciftiIn)) rawCopy = false;
+        maxInColumns = max(maxInColumns, ciftiIn->getDimensions()[0]);
+    }
+    const int64_t elemBytes = (rawCopy ? ciftiOut->getRawBytesPerElement() : (int64_t)sizeof(float));
+    const int64_t blockRows = max(int64_t(1), min(numRows, MERGE_BLOCK_BYTES / (max(numOutColumns, maxInColumns) * elemBytes)));
+    const int64_t outRowBytes = numOutColumns * elemBytes;
+    //float storage so the float path is aligned, the raw path only uses it as bytes
+    vector<float> outBlock((blockRows * outRowBytes + sizeof(float) - 1) / sizeof(float));
+    vector<float> scratchBlock((blockRows * maxInColumns * elemBytes + sizeof(float) - 1) / sizeof(float));
+    char* outBytes = (char*)outBlock.data();
+    char* scratchBytes = (char*)scratchBlock.data();
+    for (int64_t firstRow = 0; firstRow < numRows; firstRow += blockRows)
+    {
+        const int64_t numBlock = min(blockRows, numRows - firstRow);
+        int64_t curColByte = 0, inRowBytes = 0;
+        int curInput = -1;
+        for (int r = 0; r < (int)ranges.size(); ++r)
+        {
+            const ColumnRange& thisRange = ranges[r];
+            if (thisRange.m_input != curInput)
+            {//ranges are in input order, so each input is read once per block
+                curInput = thisRange.m_input;
+                const CiftiFile* ciftiIn = myInputs[curInput]->getCifti(1);
+                inRowBytes = ciftiIn->getDimensions()[0] * elemBytes;
+                if (rawCopy)
+                {
+                    ciftiIn->getRawRows(scratchBytes, firstRow, numBlock);
+                } else {
+                    ciftiIn->getRows(scratchBlock.data(), firstRow, numBlock);
+                }
+            }
+            const int64_t rangeBytes = thisRange.m_count * elemBytes;
+            for (int64_t b = 0; b < numBlock; ++b)
+            {
+                const char* inRow = scratchBytes + b * inRowBytes;
+                char* outPos = outBytes + b * outRowBytes + curColByte;
+                if (thisRange.m_reverse)
+                {
+                    for (int64_t c = 0; c < thisRange.m_count; ++c)
                     {
-                        int finalColumn = thisXML.getMap(CiftiXML::ALONG_ROW)->getIndexFromNumberOrName(upToOpt->getString(1));//ditto
-                        bool reverse = upToOpt->getOptionalParameter(2)->m_present;
-                        if (reverse)
-                        {
-                            for (int c = finalColumn; c >= initialColumn; --c)
-                            {
-                                outRow[curCol] = scratchRow[c];
-                                ++curCol;
-                            }
-                        } else {
-                            for (int c = initialColumn; c <= finalColumn; ++c)
-                            {
-                                outRow[curCol] = scratchRow[c];
-                                ++curCol;
-                            }
-                        }
-                    } else {
-                        outRow[curCol] = scratchRow[initialColumn];
-                        ++curCol;
+                        memcpy(outPos + c * elemBytes, inRow + (thisRange.m_start + thisRange.m_count - 1 - c) * elemBytes, elemBytes);
                     }
+                } else {
+                    memcpy(outPos, inRow + thisRange.m_start * elemBytes, rangeBytes);
                 }
-            } else {
-                ciftiIn->getRow(outRow.data() + curCol, row);
-                curCol += thisDims[0];
             }
+            curColByte += rangeBytes;
+        }
+        CaretAssert(curColByte == outRowBytes);
+        if (rawCopy)
+        {
+            ciftiOut->setRawRows(outBytes, firstRow, numBlock);
+        } else {
+            ciftiOut->setRows(outBlock.data(), firstRow, numBlock);
         }
-        CaretAssert(curCol == numOutColumns);
-        ciftiOut->setRow(outRow.data(), row);
+        myProgress.reportProgress(float(firstRow + numBlock) / numRows);
     }
 }
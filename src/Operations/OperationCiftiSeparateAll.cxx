@@ -18,16 +18,37 @@
  */
 /*LICENSE_END*/
 
-#include "AlgorithmCiftiSeparate.h"
-#include "CiftiFile.h"
-#include "MetricFile.h"
 #include "OperationCiftiSeparateAll.h"
 #include "OperationException.h"
+
+#include "CaretLogger.h"
+#include "CiftiFile.h"
+#include "MetricFile.h"
 #include "VolumeFile.h"
 
+#include <algorithm>
+#include <vector>
+
 using namespace caret;
 using namespace std;
 
+namespace
+{
+    struct SurfaceOutput
+    {
+        MetricFile* m_data;
+        vector<CiftiBrainModelsMap::SurfaceMap> m_map;
+        vector<float> m_scratch;
+    };
+    
+    struct RowTarget
+    {
+        int m_output;//index into the surface outputs, one past the end for the volume, -1 for unused rows
+        int64_t m_index;//surface node, or index into the volume map
+        RowTarget() { m_output = -1; m_index = -1; }
+    };
+}
+
 AString OperationCiftiSeparateAll::getCommandSwitch()
 {
     return "-cifti-separate-all";
@@ -94,64 +115,170 @@ void OperationCiftiSeparateAll::useParameters(OperationParameters* myParams, Pro
             }
         }
     }
-    OptionalParameter* leftOpt = myParams->getOptionalParameter(2);
-    if (leftOpt->m_present)
+    const CiftiXML& myXML = myCifti->getCiftiXML();
+    if (myXML.getNumberOfDimensions() != 2) throw OperationException("cifti separate only supported on 2D cifti");
+    if (myXML.getMappingType(myDir) != CiftiMappingType::BRAIN_MODELS) throw OperationException("specified direction does not contain brain models");
+    const CiftiBrainModelsMap& myBrainModelsMap = myXML.getBrainModelsMap(myDir);
+    const CiftiMappingType& myNamesMap = *(myXML.getMap(1 - myDir));
+    const int64_t rowSize = myCifti->getNumberOfColumns(), colSize = myCifti->getNumberOfRows();
+    const int64_t numMaps = (myDir == CiftiXML::ALONG_COLUMN ? rowSize : colSize);
+    //set up every output first, so that the input only needs to be read once
+    const int surfOptionNums[3] = { 2, 3, 4 };
+    const StructureEnum::Enum surfStructures[3] = { StructureEnum::CORTEX_LEFT, StructureEnum::CORTEX_RIGHT, StructureEnum::CEREBELLUM };
+    vector<SurfaceOutput> surfOutputs;
+    for (int s = 0; s < 3; ++s)
     {
-        MetricFile* outData = leftOpt->getOutputMetric(1);
-        MetricFile* outRoi = NULL;
-        OptionalParameter* roiOpt = leftOpt->getOptionalParameter(2);
-        if (roiOpt->m_present)
+        OptionalParameter* surfOpt = myParams->getOptionalParameter(surfOptionNums[s]);
+        if (!surfOpt->m_present) continue;
+        const StructureEnum::Enum myStruct = surfStructures[s];
+        if (!myBrainModelsMap.hasSurfaceData(myStruct)) throw OperationException("specified file and direction does not contain the requested surface structure '" + StructureEnum::toName(myStruct) + "'");
+        SurfaceOutput thisOutput;
+        thisOutput.m_data = surfOpt->getOutputMetric(1);
+        thisOutput.m_map = myBrainModelsMap.getSurfaceMap(myStruct);
+        const int64_t numNodes = myBrainModelsMap.getSurfaceNumberOfNodes(myStruct);
+        thisOutput.m_scratch.resize(numNodes, 0.0f);//nodes outside the structure's map stay 0
+        thisOutput.m_data->setNumberOfNodesAndColumns(numNodes, numMaps);
+        thisOutput.m_data->setStructure(myStruct);
+        for (int64_t j = 0; j < numMaps; ++j)
         {
-            outRoi = roiOpt->getOutputMetric(1);
+            thisOutput.m_data->setMapName(j, myNamesMap.getIndexName(j));
+            thisOutput.m_data->setValuesForColumn(j, thisOutput.m_scratch.data());
         }
-        processSurfaceComponent(myCifti, StructureEnum::CORTEX_LEFT, myDir, outData, outRoi);
-    }
-    OptionalParameter* rightOpt = myParams->getOptionalParameter(3);
-    if (rightOpt->m_present)
-    {
-        MetricFile* outData = rightOpt->getOutputMetric(1);
-        MetricFile* outRoi = NULL;
-        OptionalParameter* roiOpt = rightOpt->getOptionalParameter(2);
+        OptionalParameter* roiOpt = surfOpt->getOptionalParameter(2);
         if (roiOpt->m_present)
         {
-            outRoi = roiOpt->getOutputMetric(1);
-        }
-        processSurfaceComponent(myCifti, StructureEnum::CORTEX_RIGHT, myDir, outData, outRoi);
-    }
-    OptionalParameter* cerebOpt = myParams->getOptionalParameter(4);
-    if (cerebOpt->m_present)
-    {
-        MetricFile* outData = cerebOpt->getOutputMetric(1);
-        MetricFile* outRoi = NULL;
-        OptionalParameter* roiOpt = cerebOpt->getOptionalParameter(2);
-        if (roiOpt->m_present)
-        {
-            outRoi = roiOpt->getOutputMetric(1);
+            MetricFile* outRoi = roiOpt->getOutputMetric(1);
+            vector<float> nodeUsed(numNodes, 0.0f);
+            for (int64_t i = 0; i < (int64_t)thisOutput.m_map.size(); ++i)
+            {
+                nodeUsed[thisOutput.m_map[i].m_surfaceNode] = 1.0f;
+            }
+            outRoi->setNumberOfNodesAndColumns(numNodes, 1);
+            outRoi->setStructure(myStruct);
+            outRoi->setValuesForColumn(0, nodeUsed.data());
         }
-        processSurfaceComponent(myCifti, StructureEnum::CEREBELLUM, myDir, outData, outRoi);
+        surfOutputs.push_back(thisOutput);
     }
+    if (!surfOutputs.empty() && myXML.getMappingType(1 - myDir) == CiftiMappingType::LABELS) CaretLogWarning("creating a metric file from cifti label data");
+    VolumeFile* volOut = NULL;
+    vector<CiftiBrainModelsMap::VolumeMap> volMap;
     OptionalParameter* volOpt = myParams->getOptionalParameter(5);
     if (volOpt->m_present)
     {
-        VolumeFile* outData = volOpt->getOutputVolume(1);
-        VolumeFile* outRoi = NULL;
+        if (!myBrainModelsMap.hasVolumeData()) throw OperationException("specified file and direction does not contain any volume data");
+        volOut = volOpt->getOutputVolume(1);
+        volMap = myBrainModelsMap.getFullVolumeMap();
+        const VolumeSpace& mySpace = myBrainModelsMap.getVolumeSpace();
+        vector<int64_t> newdims(mySpace.getDims(), mySpace.getDims() + 3);
         OptionalParameter* roiOpt = volOpt->getOptionalParameter(2);
         if (roiOpt->m_present)
         {
-            outRoi = roiOpt->getOutputVolume(1);
+            VolumeFile* outRoi = roiOpt->getOutputVolume(1);
+            outRoi->reinitialize(newdims, mySpace.getSform());
+            outRoi->setValueAllVoxels(0.0f);
+            for (int64_t i = 0; i < (int64_t)volMap.size(); ++i)
+            {
+                outRoi->setValue(1.0f, volMap[i].m_ijk);
+            }
+        }
+        if (numMaps > 1) newdims.push_back(numMaps);
+        volOut->reinitialize(newdims, mySpace.getSform());
+        volOut->setValueAllVoxels(0.0f);
+        for (int64_t j = 0; j < numMaps; ++j)
+        {
+            volOut->setMapName(j, myNamesMap.getIndexName(j));
+        }
+        if (myXML.getMappingType(1 - myDir) == CiftiMappingType::LABELS)
+        {
+            const CiftiLabelsMap& myLabelsMap = myXML.getLabelsMap(1 - myDir);
+            volOut->setType(SubvolumeAttributes::LABEL);
+            for (int64_t j = 0; j < numMaps; ++j)
+            {
+                *(volOut->getMapLabelTable(j)) = *(myLabelsMap.getMapLabelTable(j));
+            }
+        }
+    }
+    if (surfOutputs.empty() && volOut == NULL) return;
+    //one pass over the input in large blocks, each row goes to every output that uses it
+    const int64_t BLOCK_BYTES = ((int64_t)1) << 26;
+    const int64_t blockRows = max(int64_t(1), BLOCK_BYTES / max(int64_t(1), rowSize * (int64_t)sizeof(float)));
+    vector<float> block;
+    if (myDir == CiftiXML::ALONG_COLUMN)
+    {//each row is one brainordinate, so each row has at most one destination
+        const int VOLUME_TARGET = (int)surfOutputs.size();
+        vector<RowTarget> rowTargets(colSize);
+        for (int s = 0; s < (int)surfOutputs.size(); ++s)
+        {
+            const vector<CiftiBrainModelsMap::SurfaceMap>& myMap = surfOutputs[s].m_map;
+            for (int64_t i = 0; i < (int64_t)myMap.size(); ++i)
+            {
+                rowTargets[myMap[i].m_ciftiIndex].m_output = s;
+                rowTargets[myMap[i].m_ciftiIndex].m_index = myMap[i].m_surfaceNode;
+            }
+        }
+        for (int64_t i = 0; i < (int64_t)volMap.size(); ++i)
+        {
+            rowTargets[volMap[i].m_ciftiIndex].m_output = VOLUME_TARGET;
+            rowTargets[volMap[i].m_ciftiIndex].m_index = i;
+        }
+        for (int64_t firstRow = 0; firstRow < colSize; firstRow += blockRows)
+        {
+            const int64_t numRows = min(blockRows, colSize - firstRow);
+            bool used = false;
+            for (int64_t r = 0; r < numRows; ++r)
+            {
+                if (rowTargets[firstRow + r].m_output != -1)
+                {
+                    used = true;
+                    break;
+                }
+            }
+            if (!used) continue;//don't read structures nobody asked for
+            block.resize(numRows * rowSize);
+            myCifti->getRows(block.data(), firstRow, numRows);
+            for (int64_t r = 0; r < numRows; ++r)
+            {
+                const RowTarget& myTarget = rowTargets[firstRow + r];
+                const float* rowData = block.data() + r * rowSize;
+                if (myTarget.m_output == -1) continue;
+                if (myTarget.m_output == VOLUME_TARGET)
+                {
+                    for (int64_t j = 0; j < rowSize; ++j)
+                    {
+                        volOut->setValue(rowData[j], volMap[myTarget.m_index].m_ijk, j);
+                    }
+                } else {
+                    MetricFile* metricOut = surfOutputs[myTarget.m_output].m_data;
+                    for (int64_t j = 0; j < rowSize; ++j)
+                    {
+                        metricOut->setValue(myTarget.m_index, j, rowData[j]);
+                    }
+                }
+            }
+        }
+    } else {//each row is one map, every output takes part of every row
+        for (int64_t firstRow = 0; firstRow < colSize; firstRow += blockRows)
+        {
+            const int64_t numRows = min(blockRows, colSize - firstRow);
+            block.resize(numRows * rowSize);
+            myCifti->getRows(block.data(), firstRow, numRows);
+            for (int64_t r = 0; r < numRows; ++r)
+            {
+                const float* rowData = block.data() + r * rowSize;
+                for (int s = 0; s < (int)surfOutputs.size(); ++s)
+                {
+                    SurfaceOutput& thisOutput = surfOutputs[s];
+                    for (int64_t i = 0; i < (int64_t)thisOutput.m_map.size(); ++i)
+                    {
+                        thisOutput.m_scratch[thisOutput.m_map[i].m_surfaceNode] = rowData[thisOutput.m_map[i].m_ciftiIndex];
+                    }
+                    thisOutput.m_data->setValuesForColumn(firstRow + r, thisOutput.m_scratch.data());
+                }
+                for (int64_t i = 0; i < (int64_t)volMap.size(); ++i)
+                {
+                    volOut->setValue(rowData[volMap[i].m_ciftiIndex], volMap[i].m_ijk, firstRow + r);
+                }
+            }
         }
-        processVolume(myCifti, myDir, outData, outRoi);
     }
-}
-
-void OperationCiftiSeparateAll::processSurfaceComponent(const CiftiFile* myCifti, const StructureEnum::Enum& myStruct,
-                                                        const int& myDir, MetricFile* outData, MetricFile* outROI)
-{
-    AlgorithmCiftiSeparate(NULL, myCifti, myDir, myStruct, outData, outROI);
-}
-
-void OperationCiftiSeparateAll::processVolume(const CiftiFile* myCifti, const int& myDir, VolumeFile* outData, VolumeFile* outROI)
-{
-    int64_t offset[3];
-    AlgorithmCiftiSeparate(NULL, myCifti, myDir, outData, offset, outROI, false);
 }
@@ -18,7 +18,11 @@
  */
 /*LICENSE_END*/
 
+#include "CaretAssert.h"
 #include "CaretLogger.h"
+#include "CaretMutex.h"
+#include "CaretOMP.h"
+#include "CaretPointer.h"
 #include "DataFile.h"
 #include "EventManager.h"
 #include "EventProgressUpdate.h"
@@ -36,13 +40,299 @@
 #include "quazipfile.h"
 
 #include <QDir>
+#include <QTemporaryFile>
 
+#include "zlib.h"
+
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <set>
 
 using namespace caret;
 using namespace std;
 
+namespace
+{
+    const int64_t ZIP_CHUNK_BYTES = ((int64_t)1) << 20;
+    const int64_t ZIP_MEMORY_BYTES = ((int64_t)1) << 26;//compressed data of an entry beyond this goes to a temporary file
+    
+    struct ZipEntry
+    {
+        AString m_dataFileName, m_entryName;
+        int64_t m_size;
+        bool m_store;//write without compression
+        uLong m_crc;
+        int64_t m_compressedSize;
+        int64_t m_progressBytes;//input bytes already reported while compressing
+        int64_t m_uncompressedSize;//bytes actually compressed, the file may have changed since m_size was found
+        vector<char> m_buffer;
+        CaretPointer<QTemporaryFile> m_spillFile;
+        ZipEntry() : m_size(0), m_store(false), m_crc(0), m_compressedSize(0), m_progressBytes(0), m_uncompressedSize(0) { }
+    };
+    
+    bool isAlreadyCompressed(const AString& fileName)
+    {//deflating these again wastes time for almost no gain
+        static const char* extensions[] = { ".gz", ".zip", ".bz2", ".xz", ".7z", ".png", ".jpg", ".jpeg", ".gif" };
+        for (int i = 0; i < (int)(sizeof(extensions) / sizeof(extensions[0])); ++i)
+        {
+            if (fileName.endsWith(extensions[i], Qt::CaseInsensitive)) return true;
+        }
+        return false;
+    }
+    
+    AString formatSize(const int64_t& bytes)
+    {
+        static const char *myUnits[9] = {" B    ", " KB", " MB", " GB", " TB", " PB", " EB", " ZB", " YB"};
+        float fileSize = (float)bytes;
+        int unit = 0;
+        while (unit < 8 && fileSize >= 1000.0f)//don't let there be 4 digits to the left of decimal point
+        {
+            ++unit;
+            fileSize /= 1000.0f;//use GB and friends, not GiB
+        }
+        if (unit > 0)
+        {
+            return AString::number(fileSize, 'f', 2) + myUnits[unit];
+        }
+        return AString::number(fileSize) + myUnits[unit];
+    }
+    
+    bool hasError(const AString& errorMessage, CaretMutex& errorMutex)
+    {
+        CaretMutexLocker locked(&errorMutex);
+        return !errorMessage.isEmpty();
+    }
+    
+    class ZipProgress
+    {//progress is in bytes of input files, only the calling thread reports it
+        int64_t m_totalBytes, m_bytesDone, m_reportedPerMille;
+        int64_t m_numFiles, m_currentIndex;
+        AString m_currentName;
+        OperationZipSceneFile::ProgressMode m_progressMode;
+        LevelProgress* m_levelProgress;
+        EventProgressUpdate m_progressEvent;
+        CaretMutex m_mutex;
+    public:
+        ZipProgress(const int64_t& totalBytes, const int64_t& numFiles, const OperationZipSceneFile::ProgressMode progressMode, LevelProgress* levelProgress)
+        : m_progressEvent(0, 1000, 0, "Creating ZIP File")
+        {
+            m_totalBytes = totalBytes;
+            m_bytesDone = 0;
+            m_reportedPerMille = 0;
+            m_numFiles = numFiles;
+            m_currentIndex = 0;
+            m_progressMode = progressMode;
+            m_levelProgress = levelProgress;
+            if (m_progressMode == OperationZipSceneFile::PROGRESS_GUI_EVENT)
+            {
+                EventManager::get()->sendEvent(m_progressEvent.getPointer());
+            }
+        }
+        
+        void addBytes(const int64_t& bytes)
+        {
+#ifdef CARET_OMP
+            const bool callingThread = (omp_get_thread_num() == 0);
+#else
+            const bool callingThread = true;
+#endif
+            int64_t perMille, bytesDone, currentIndex;
+            AString currentName;
+            {
+                CaretMutexLocker locked(&m_mutex);
+                m_bytesDone += bytes;
+                perMille = (m_totalBytes > 0 ? min((int64_t)1000, m_bytesDone * 1000 / m_totalBytes) : 1000);
+                if (!callingThread || perMille == m_reportedPerMille) return;
+                m_reportedPerMille = perMille;
+                bytesDone = m_bytesDone;
+                currentIndex = m_currentIndex;
+                currentName = m_currentName;
+            }
+            if (m_levelProgress != NULL) m_levelProgress->reportProgress(perMille / 1000.0f);
+            if (m_progressMode == OperationZipSceneFile::PROGRESS_GUI_EVENT)
+            {
+                m_progressEvent.setProgress((int)perMille,
+                                            "Adding " + AString::number(currentIndex + 1) + " of " + AString::number(m_numFiles)
+                                            + " (" + formatSize(bytesDone) + " of " + formatSize(m_totalBytes) + ") " + currentName);
+                EventManager::get()->sendEvent(m_progressEvent.getPointer());
+            }
+        }
+        
+        void startEntry(const int64_t& index, const ZipEntry& entry)
+        {//entries are written in order, so this is the file currently being added
+            {
+                CaretMutexLocker locked(&m_mutex);
+                m_currentIndex = index;
+                m_currentName = FileInformation(entry.m_entryName).getFileName();
+            }
+            if (m_progressMode == OperationZipSceneFile::PROGRESS_COMMAND_LINE)
+            {
+                cout << formatSize(entry.m_size) << "     \t" << entry.m_entryName;
+                cout.flush();//don't endl until it finishes
+            }
+        }
+        
+        void finishEntry()
+        {
+            if (m_progressMode == OperationZipSceneFile::PROGRESS_COMMAND_LINE)
+            {
+                cout << endl;
+            }
+        }
+        
+        void finish()
+        {
+            if (m_progressMode == OperationZipSceneFile::PROGRESS_GUI_EVENT)
+            {
+                m_progressEvent.setProgress(1000, "Zip created successfully");
+                EventManager::get()->sendEvent(m_progressEvent.getPointer());
+            }
+        }
+    };
+    
+    struct DeflateStream
+    {//raw deflate, as zip entries need, ended when it goes out of scope
+        z_stream m_stream;
+        DeflateStream()
+        {
+            memset(&m_stream, 0, sizeof(m_stream));
+            if (deflateInit2(&m_stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            {
+                throw OperationException("failed to initialize zlib compression");
+            }
+        }
+        ~DeflateStream() { deflateEnd(&m_stream); }
+    };
+    
+    void appendCompressed(ZipEntry& entry, const char* data, const int64_t& length)
+    {
+        if (length == 0) return;
+        if (entry.m_spillFile.getPointer() == NULL && (int64_t)entry.m_buffer.size() + length > ZIP_MEMORY_BYTES)
+        {
+            entry.m_spillFile.grabNew(new QTemporaryFile());
+            if (!entry.m_spillFile->open())
+            {
+                throw OperationException("Unable to open temporary file for compressing \"" + entry.m_dataFileName + "\"");
+            }
+            if (entry.m_spillFile->write(entry.m_buffer.data(), entry.m_buffer.size()) != (qint64)entry.m_buffer.size())
+            {
+                throw OperationException("Error writing to temporary file for compressing \"" + entry.m_dataFileName + "\"");
+            }
+            entry.m_buffer = vector<char>();
+        }
+        if (entry.m_spillFile.getPointer() != NULL)
+        {
+            if (entry.m_spillFile->write(data, length) != length)
+            {
+                throw OperationException("Error writing to temporary file for compressing \"" + entry.m_dataFileName + "\"");
+            }
+        } else {
+            entry.m_buffer.insert(entry.m_buffer.end(), data, data + length);
+        }
+        entry.m_compressedSize += length;
+    }
+    
+    void deflateEntry(ZipEntry& entry, ZipProgress& progress)
+    {//streams the file through its own deflate stream, so different entries can be compressed in parallel
+        QFile dataFileIn(entry.m_dataFileName);
+        if (!dataFileIn.open(QFile::ReadOnly))
+        {
+            throw OperationException("Unable to open \"" + entry.m_dataFileName + "\" for reading: " + dataFileIn.errorString());
+        }
+        DeflateStream myDeflate;
+        z_stream& myStream = myDeflate.m_stream;
+        vector<char> inBuffer(ZIP_CHUNK_BYTES), outBuffer(ZIP_CHUNK_BYTES);
+        entry.m_crc = crc32(0L, Z_NULL, 0);
+        entry.m_uncompressedSize = 0;
+        int flush = Z_NO_FLUSH;
+        while (flush != Z_FINISH)
+        {
+            const qint64 numRead = dataFileIn.read(inBuffer.data(), ZIP_CHUNK_BYTES);
+            if (numRead < 0) throw OperationException("Error reading from data file \"" + entry.m_dataFileName + "\"");
+            entry.m_crc = crc32(entry.m_crc, (const Bytef*)inBuffer.data(), (uInt)numRead);
+            flush = ((numRead == 0 || dataFileIn.atEnd()) ? Z_FINISH : Z_NO_FLUSH);
+            myStream.next_in = (Bytef*)inBuffer.data();
+            myStream.avail_in = (uInt)numRead;
+            do
+            {
+                myStream.next_out = (Bytef*)outBuffer.data();
+                myStream.avail_out = (uInt)ZIP_CHUNK_BYTES;
+                deflate(&myStream, flush);//can't fail with valid buffers
+                appendCompressed(entry, outBuffer.data(), ZIP_CHUNK_BYTES - myStream.avail_out);
+            } while (myStream.avail_out == 0);
+            entry.m_uncompressedSize += numRead;
+            entry.m_progressBytes += numRead;
+            progress.addBytes(numRead);
+            if (entry.m_compressedSize >= entry.m_size)
+            {//incompressible, store it instead
+                entry.m_store = true;
+                entry.m_buffer = vector<char>();
+                entry.m_spillFile.grabNew(NULL);
+                return;
+            }
+        }
+    }
+    
+    void writeEntry(QuaZip& zipFile, ZipEntry& entry, ZipProgress& progress)
+    {
+        QuaZipNewInfo zipNewInfo(entry.m_entryName,
+                                 entry.m_dataFileName);
+        zipNewInfo.externalAttr |= (6 << 22L) | (6 << 19L) | (4 << 16L);//make permissions 664
+        const int64_t ZIP32_LIMIT = 0xffffffffLL;
+        zipFile.setZip64Enabled(max(entry.m_size, entry.m_uncompressedSize) >= ZIP32_LIMIT);//only for entries that need it, so other entries stay readable by older tools
+        
+        QuaZipFile dataFileOut(&zipFile);
+        vector<char> buffer(ZIP_CHUNK_BYTES);
+        if (entry.m_store)
+        {
+            QFile dataFileIn(entry.m_dataFileName);
+            if (!dataFileIn.open(QFile::ReadOnly))
+            {
+                throw OperationException("Unable to open \"" + entry.m_dataFileName + "\" for reading: " + dataFileIn.errorString());
+            }
+            if (!dataFileOut.open(QIODevice::WriteOnly, zipNewInfo, NULL, 0, 0, 0))//method 0 is stored
+            {
+                throw OperationException("Unable to open zip output for \"" + entry.m_dataFileName + "\"");
+            }
+            int64_t position = 0;
+            while (!dataFileIn.atEnd())
+            {
+                const qint64 numRead = dataFileIn.read(buffer.data(), ZIP_CHUNK_BYTES);
+                if (numRead < 0) throw OperationException("Error reading from data file \"" + entry.m_dataFileName + "\"");
+                if (numRead == 0) break;
+                if (dataFileOut.write(buffer.data(), numRead) != numRead) throw OperationException("Error writing to zip file");
+                progress.addBytes(max((int64_t)0, position + numRead - max(position, entry.m_progressBytes)));//don't count what was read while trying to compress it
+                position += numRead;
+            }
+        } else {
+            zipNewInfo.uncompressedSize = entry.m_uncompressedSize;
+            if (!dataFileOut.open(QIODevice::WriteOnly, zipNewInfo, NULL, entry.m_crc, Z_DEFLATED, Z_DEFAULT_COMPRESSION, true))//raw, already compressed
+            {
+                throw OperationException("Unable to open zip output for \"" + entry.m_dataFileName + "\"");
+            }
+            if (entry.m_spillFile.getPointer() == NULL)
+            {
+                if (!entry.m_buffer.empty() && dataFileOut.write(entry.m_buffer.data(), entry.m_buffer.size()) != (qint64)entry.m_buffer.size())
+                {
+                    throw OperationException("Error writing to zip file");
+                }
+            } else {
+                if (!entry.m_spillFile->seek(0)) throw OperationException("Error reading temporary file for \"" + entry.m_dataFileName + "\"");
+                while (!entry.m_spillFile->atEnd())
+                {
+                    const qint64 numRead = entry.m_spillFile->read(buffer.data(), ZIP_CHUNK_BYTES);
+                    if (numRead < 0) throw OperationException("Error reading temporary file for \"" + entry.m_dataFileName + "\"");
+                    if (numRead == 0) break;
+                    if (dataFileOut.write(buffer.data(), numRead) != numRead) throw OperationException("Error writing to zip file");
+                }
+            }
+        }
+        dataFileOut.close();
+        if (dataFileOut.getZipError() != UNZ_OK) throw OperationException("Error writing to zip file");
+    }
+}
+
 AString OperationZipSceneFile::getCommandSwitch()
 {
     return "-zip-scene-file";
@@ -197,8 +487,35 @@ void OperationZipSceneFile::createZipFile(const AString& sceneFileName,
             }
         }
     }
-    EventProgressUpdate progressEvent(0, allFiles.size(), 0, "Creating ZIP File");
-    EventManager::get()->sendEvent(progressEvent.getPointer());
+    vector<AString> dataFileNames(allFiles.begin(), allFiles.end());
+    vector<AString> entryNames;
+    for (int i = 0; i < (int)dataFileNames.size(); ++i)
+    {
+        entryNames.push_back(outputSubDirectory + "/" + dataFileNames[i].mid(myBaseDir.size()));//we know the string matches to the length of myBaseDir, and is cleaned, so we can just chop the right number of characters off
+    }
+    writeZipFile(zipFileName, dataFileNames, entryNames, progressMode, &myProgress);
+}
+
+void OperationZipSceneFile::writeZipFile(const AString& zipFileName,
+                                         const vector<AString>& dataFileNames,
+                                         const vector<AString>& entryNames,
+                                         const ProgressMode progressMode,
+                                         LevelProgress* myProgress)
+{
+    CaretAssert(dataFileNames.size() == entryNames.size());
+    const int64_t numFiles = (int64_t)dataFileNames.size();
+    vector<ZipEntry> entries(numFiles);
+    int64_t totalBytes = 0;
+    for (int64_t i = 0; i < numFiles; ++i)
+    {
+        ZipEntry& entry = entries[i];
+        entry.m_dataFileName = dataFileNames[i];
+        entry.m_entryName = entryNames[i];
+        entry.m_size = FileInformation(dataFileNames[i]).size();
+        entry.m_store = isAlreadyCompressed(dataFileNames[i]);
+        totalBytes += entry.m_size;
+    }
+    ZipProgress myZipProgress(totalBytes, numFiles, progressMode, myProgress);
 
     QFile zipFileObject(zipFileName);
     QuaZip zipFile(&zipFileObject);
@@ -208,88 +525,51 @@ void OperationZipSceneFile::createZipFile(const AString& sceneFileName,
                                  + zipFileName
                                  + "\" for writing.");
     }
-    int32_t fileIndex = 1;
-    static const char *myUnits[9] = {" B    ", " KB", " MB", " GB", " TB", " PB", " EB", " ZB", " YB"};
-    for (set<AString>::iterator iter = allFiles.begin(); iter != allFiles.end(); ++iter, ++fileIndex)
-    {
-        AString dataFileName = *iter;
-        AString unzippedDataFileName = outputSubDirectory + "/" + dataFileName.mid(myBaseDir.size());//we know the string matches to the length of myBaseDir, and is cleaned, so we can just chop the right number of characters off
-        QFile dataFileIn(dataFileName);
-        if (!dataFileIn.open(QFile::ReadOnly)) {
-            throw OperationException("Unable to open \"" + dataFileName + "\" for reading: " + dataFileIn.errorString());
-        }
-        float fileSize = (float)dataFileIn.size();
-        int unit = 0;
-        while (unit < 8 && fileSize >= 1000.0f)//don't let there be 4 digits to the left of decimal point
+    AString errorMessage;
+    CaretMutex errorMutex;
+#pragma omp CARET_PARFOR schedule(dynamic, 1) ordered
+    for (int64_t i = 0; i < numFiles; ++i)
+    {//each file gets its own deflate stream, in parallel, entries are written to the zip in order
+        ZipEntry& entry = entries[i];
+        try
         {
-            ++unit;
-            fileSize /= 1000.0f;//use GB and friends, not GiB
+            if (!entry.m_store && !hasError(errorMessage, errorMutex))
+            {
+                deflateEntry(entry, myZipProgress);
+            }
+        } catch (CaretException& e) {//don't let exceptions escape the parallel region
+            CaretMutexLocker locked(&errorMutex);
+            if (errorMessage.isEmpty()) errorMessage = e.whatString();
         }
-        switch (progressMode) {
-            case PROGRESS_COMMAND_LINE:
-                if (unit > 0)
+#pragma omp ordered
+        {
+            try
+            {
+                if (!hasError(errorMessage, errorMutex))
                 {
-                    cout << AString::number(fileSize, 'f', 2);
-                } else {
-                    cout << AString::number(fileSize);
+                    myZipProgress.startEntry(i, entry);
+                    writeEntry(zipFile, entry, myZipProgress);
+                    myZipProgress.finishEntry();
                 }
-                cout << myUnits[unit] << "     \t" << unzippedDataFileName;
-                cout.flush();//don't endl until it finishes
-                break;
-            case PROGRESS_GUI_EVENT:
-                progressEvent.setProgress(fileIndex,
-                                          ("Adding "
-                                           + (QString::number(fileIndex) + " of " + QString::number(allFiles.size()) + " (")
-                                           + ((unit > 0) ? AString::number(fileSize, 'f', 2) : AString::number(fileSize))
-                                           + myUnits[unit]
-                                           + ") "
-                                           + FileInformation(unzippedDataFileName).getFileName()));
-                EventManager::get()->sendEvent(progressEvent.getPointer());
-                break;
-        }
-        
-        QuaZipNewInfo zipNewInfo(unzippedDataFileName,
-                                 dataFileName);
-        zipNewInfo.externalAttr |= (6 << 22L) | (6 << 19L) | (4 << 16L);//make permissions 664
-        
-        QuaZipFile dataFileOut(&zipFile);
-        if (!dataFileOut.open(QIODevice::WriteOnly, zipNewInfo)) {
-            throw OperationException("Unable to open zip output for \"" + dataFileName + "\"");
-        }
-        
-        const qint64 BUFFER_SIZE = 1024 * 1024;
-        vector<char> buffer(BUFFER_SIZE);
-        
-        while (dataFileIn.atEnd() == false) {
-            const qint64 numRead = dataFileIn.read(buffer.data(), BUFFER_SIZE);
-            if (numRead < 0) throw OperationException("Error reading from data file");
-            if (numRead > 0) {
-                qint64 result = dataFileOut.write(buffer.data(), numRead);
-                if (result != numRead) throw OperationException("Error writing to zip file");
+            } catch (CaretException& e) {
+                CaretMutexLocker locked(&errorMutex);
+                if (errorMessage.isEmpty()) errorMessage = e.whatString();
             }
-        }
-        
-        dataFileIn.close();
-        dataFileOut.close();
-        switch (progressMode) {
-            case PROGRESS_COMMAND_LINE:
-                cout << endl;
-                break;
-            case PROGRESS_GUI_EVENT:
-                break;
+            entry.m_buffer = vector<char>();//done with the compressed data
+            entry.m_spillFile.grabNew(NULL);
         }
     }
     zipFile.close();
-
-    switch (progressMode) {
-        case PROGRESS_COMMAND_LINE:
-            break;
-        case PROGRESS_GUI_EVENT:
-            progressEvent.setProgress(allFiles.size(),
-                                      "Zip created successfully");
-            EventManager::get()->sendEvent(progressEvent.getPointer());
-            break;
+    if (errorMessage.isEmpty() && zipFile.getZipError() != UNZ_OK)
+    {
+        errorMessage = "Error closing zip file";
+    }
+    if (!errorMessage.isEmpty())
+    {
+        QFile::remove(zipFileName);
+        throw OperationException(errorMessage);
     }
+    myZipProgress.finish();
 }
 
 //void OperationZipSceneFile::useParameters(OperationParameters* myParams, ProgressObject* myProgObj)
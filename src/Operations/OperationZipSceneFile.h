@@ -23,6 +23,8 @@
 
 #include "AbstractOperation.h"
 
+#include <vector>
+
 namespace caret {
     
     class OperationZipSceneFile : public AbstractOperation
@@ -43,6 +45,13 @@ namespace caret {
                                   const AString& baseDirectory,
                                   const ProgressMode progressMode,
                                   ProgressObject* myProgObj);
+        
+        ///zip the data files under the matching entry names, compressing separate files in parallel, also used by -zip-spec-file
+        static void writeZipFile(const AString& zipFileName,
+                                 const std::vector<AString>& dataFileNames,
+                                 const std::vector<AString>& entryNames,
+                                 const ProgressMode progressMode,
+                                 LevelProgress* myProgress);
     };
 
     typedef TemplateAutoOperation<OperationZipSceneFile> AutoOperationZipSceneFile;
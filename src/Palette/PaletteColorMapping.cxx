@@ -905,6 +905,31 @@ PaletteColorMapping::getScaleMode() const
     return scaleMode;
 }
 
+/**
+ * @return True if the current scale mode needs statistics (min/max or
+ * percentiles) computed from the data when mapping data to the palette.
+ * The user scale mode uses only the user's values so statistics are not
+ * needed to color the data.
+ */
+bool
+PaletteColorMapping::isStatisticsNeededForScaleMode() const
+{
+    bool neededFlag = true;
+    
+    switch (scaleMode) {
+        case PaletteScaleModeEnum::MODE_AUTO_SCALE:
+        case PaletteScaleModeEnum::MODE_AUTO_SCALE_ABSOLUTE_PERCENTAGE:
+        case PaletteScaleModeEnum::MODE_AUTO_SCALE_PERCENTAGE:
+            neededFlag = true;
+            break;
+        case PaletteScaleModeEnum::MODE_USER_SCALE:
+            neededFlag = false;
+            break;
+    }
+    
+    return neededFlag;
+}
+
 /**
  * Set how the data is scaled to the palette.
  * @param scaleMode - Enumerated type indicating how data is scaled
@@ -120,6 +120,8 @@ namespace caret {
         
         void setScaleMode(const PaletteScaleModeEnum::Enum scaleMode);
         
+        bool isStatisticsNeededForScaleMode() const;
+        
         AString getSelectedPaletteName() const;
         
         void setSelectedPaletteName(const AString& selectedPaletteName);
@@ -51,12 +51,13 @@ static void QuaZipNewInfo_setPermissions(QuaZipNewInfo *info,
 }
 
 QuaZipNewInfo::QuaZipNewInfo(const QString& name):
-  name(name), dateTime(QDateTime::currentDateTime()), internalAttr(0), externalAttr(0)
+  name(name), dateTime(QDateTime::currentDateTime()), internalAttr(0), externalAttr(0),
+  uncompressedSize(0)
 {
 }
 
 QuaZipNewInfo::QuaZipNewInfo(const QString& name, const QString& file):
-  name(name), internalAttr(0), externalAttr(0)
+  name(name), internalAttr(0), externalAttr(0), uncompressedSize(0)
 {
   QFileInfo info(file);
   QDateTime lm = info.lastModified();
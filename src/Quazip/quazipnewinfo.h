@@ -76,9 +76,10 @@ struct QUAZIP_EXPORT QuaZipNewInfo {
   QByteArray extraGlobal;
   /// Uncompressed file size.
   /** This is only needed if you are using raw file zipping mode, i. e.
-   * adding precompressed file in the zip archive.
+   * adding precompressed file in the zip archive. 64 bits, so that
+   * raw entries of 4GB or more work where ulong is 32 bits (Windows).
    **/
-  ulong uncompressedSize;
+  quint64 uncompressedSize;
   /// Constructs QuaZipNewInfo instance.
   /** Initializes name with \a name, dateTime with current date and
    * time. Attributes are initialized with zeros, comment and extra
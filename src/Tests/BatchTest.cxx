@@ -0,0 +1,125 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+#include "BatchTest.h"
+
+#include "CaretCommandLine.h"
+#include "CaretException.h"
+#include "CommandOperationManager.h"
+#include "MetricFile.h"
+#include "ProgramParameters.h"
+
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+
+#include <cmath>
+
+using namespace caret;
+using namespace std;
+
+BatchTest::BatchTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+void BatchTest::runBatch(const AString& scriptName)
+{
+    const QByteArray scriptNameBytes = scriptName.toLocal8Bit();
+    const char* argv[] = { "wb_command", "-batch", scriptNameBytes.constData() };
+    ProgramParameters myParams(3, argv);
+    try
+    {
+        CommandOperationManager::getCommandOperationManager()->runCommand(myParams);
+    } catch (...) {
+        CommandOperationManager::deleteCommandOperationManager();
+        throw;
+    }
+    CommandOperationManager::deleteCommandOperationManager();
+}
+
+void BatchTest::execute()
+{
+    const int NODES = 100;
+    const AString tempPath = QDir::tempPath();
+    const AString inName = tempPath + "/caret_batch_test_in.func.gii", outName = tempPath + "/caret_batch_test_out.func.gii";
+    const AString scriptName = tempPath + "/caret_batch_test.txt";
+    MetricFile inMetric;
+    inMetric.setNumberOfNodesAndColumns(NODES, 1);
+    for (int i = 0; i < NODES; ++i)
+    {
+        inMetric.setValue(i, 0, i * 0.5f);
+    }
+    inMetric.writeFile(inName);
+    QFile::remove(outName);
+    {//the first line's output only exists in memory, the second line uses it
+        QFile scriptFile(scriptName);
+        if (!scriptFile.open(QIODevice::WriteOnly | QIODevice::Text))
+        {
+            setFailed("unable to write batch script '" + scriptName + "'");
+            return;
+        }
+        QTextStream scriptStream(&scriptFile);
+        scriptStream << "-metric-math 'x * 2' mem:doubled.func.gii -var x '" << inName << "'\n";
+        scriptStream << "-metric-math 'x + 1' '" << outName << "' -var x mem:doubled.func.gii\n";
+    }
+    const AString commandLineBefore = caret_global_commandLine;
+    runBatch(scriptName);
+    if (caret_global_commandLine != commandLineBefore) setFailed("command line was not restored after the batch script");
+    if (QFile::exists(tempPath + "/mem:doubled.func.gii") || QFile::exists("mem:doubled.func.gii"))
+    {
+        setFailed("in-memory output was written to disk");
+    }
+    MetricFile outMetric;
+    outMetric.readFile(outName);
+    if (outMetric.getNumberOfNodes() != NODES || outMetric.getNumberOfColumns() != 1)
+    {
+        setFailed("batch output has the wrong dimensions");
+    } else {
+        for (int i = 0; i < NODES; ++i)
+        {
+            if (abs(outMetric.getValue(i, 0) - (i * 1.0f + 1.0f)) > 0.0001f)
+            {
+                setFailed("batch output has wrong value at node " + AString::number(i));
+                break;
+            }
+        }
+    }
+    {//a failing line must also restore the command line
+        QFile scriptFile(scriptName);
+        if (!scriptFile.open(QIODevice::WriteOnly | QIODevice::Text))
+        {
+            setFailed("unable to write batch script '" + scriptName + "'");
+            return;
+        }
+        QTextStream scriptStream(&scriptFile);
+        scriptStream << "-metric-math 'x + 1' '" << outName << "' -var x mem:never_created.func.gii\n";
+    }
+    bool threw = false;
+    try
+    {
+        runBatch(scriptName);
+    } catch (CaretException&) {
+        threw = true;
+    }
+    if (!threw) setFailed("batch script using an in-memory file that was never created did not fail");
+    if (caret_global_commandLine != commandLineBefore) setFailed("command line was not restored after a failing batch script");
+    QFile::remove(inName);
+    QFile::remove(outName);
+    QFile::remove(scriptName);
+}
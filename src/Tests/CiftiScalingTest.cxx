@@ -0,0 +1,182 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "CiftiScalingTest.h"
+
+#include "CiftiFile.h"
+#include "CiftiLabelsMap.h"
+#include "CiftiSeriesMap.h"
+
+#include <QDir>
+#include <QFile>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+namespace
+{
+    AString compareToFile(const AString& fileName, const vector<float>& expected, const int64_t& numRows, const int64_t& numCols, const float& tolerance)
+    {//returns an error message, empty if the file matches
+        CiftiFile inFile(fileName);
+        if (inFile.getNumberOfRows() != numRows || inFile.getNumberOfColumns() != numCols) return "file '" + fileName + "' has the wrong dimensions";
+        vector<float> row(numCols);
+        for (int64_t r = 0; r < numRows; ++r)
+        {
+            inFile.getRow(row.data(), r);
+            for (int64_t c = 0; c < numCols; ++c)
+            {
+                if (!(abs(row[c] - expected[r * numCols + c]) <= tolerance))
+                {
+                    return "file '" + fileName + "' has value " + AString::number(row[c]) + " at row " + AString::number(r) + ", column " + AString::number(c) +
+                           ", expected " + AString::number(expected[r * numCols + c]);
+                }
+            }
+        }
+        return "";
+    }
+}
+
+CiftiScalingTest::CiftiScalingTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+void CiftiScalingTest::execute()
+{
+    testScaledOnDisk();
+    if (failed()) return;
+    testAutoScaled();
+    if (failed()) return;
+    testLabelsUnscaled();
+}
+
+void CiftiScalingTest::testScaledOnDisk()
+{//explicit range: values inside it come back within a step, values outside it clamp, NaN comes back as the value nearest 0
+    const int64_t ROWS = 3, COLS = 100;
+    const float MINVAL = -10.0f, MAXVAL = 30.0f;
+    const AString fileName = QDir::tempPath() + "/caret_cifti_scaling_test.nii";
+    CiftiXML myXML;
+    myXML.setNumberOfDimensions(2);
+    myXML.setMap(CiftiXML::ALONG_ROW, CiftiSeriesMap(COLS));
+    myXML.setMap(CiftiXML::ALONG_COLUMN, CiftiSeriesMap(ROWS));
+    const float step = (MAXVAL - MINVAL) / 65535.0f;
+    vector<float> expected(ROWS * COLS);
+    {
+        CiftiFile outFile;
+        outFile.setWritingFile(fileName);
+        outFile.setWritingDataTypeAndScaling(NIFTI_TYPE_INT16, MINVAL, MAXVAL);
+        outFile.setCiftiXML(myXML);
+        vector<float> row(COLS);
+        for (int64_t r = 0; r < ROWS; ++r)
+        {
+            for (int64_t c = 0; c < COLS; ++c)
+            {
+                row[c] = -20.0f + (r * COLS + c) * 0.2f;//-20 to 40, so both ends clamp
+                expected[r * COLS + c] = min(max(row[c], MINVAL), MAXVAL);
+            }
+            if (r == 1)
+            {
+                row[0] = numeric_limits<float>::quiet_NaN();
+                expected[r * COLS] = 0.0f;
+            }
+            outFile.setRow(row.data(), r);
+        }
+        outFile.writeFile(fileName);
+    }
+    AString message = compareToFile(fileName, expected, ROWS, COLS, step);
+    if (message != "") setFailed("scaled int16: " + message);
+    QFile::remove(fileName);
+}
+
+void CiftiScalingTest::testAutoScaled()
+{//range from the data, on-disk output goes through memory until writeFile()
+    const int64_t ROWS = 4, COLS = 50;
+    const AString fileName = QDir::tempPath() + "/caret_cifti_autoscale_test.nii";
+    CiftiXML myXML;
+    myXML.setNumberOfDimensions(2);
+    myXML.setMap(CiftiXML::ALONG_ROW, CiftiSeriesMap(COLS));
+    myXML.setMap(CiftiXML::ALONG_COLUMN, CiftiSeriesMap(ROWS));
+    vector<float> expected(ROWS * COLS);
+    float minVal = 0.0f, maxVal = 0.0f;
+    {
+        CiftiFile outFile;
+        outFile.setWritingFile(fileName);
+        outFile.setWritingDataTypeAutoScaling(NIFTI_TYPE_UINT8);
+        outFile.setCiftiXML(myXML);
+        vector<float> row(COLS);
+        for (int64_t r = 0; r < ROWS; ++r)
+        {
+            for (int64_t c = 0; c < COLS; ++c)
+            {
+                row[c] = 5.0f + sin((float)(r * COLS + c)) * 3.0f;
+                expected[r * COLS + c] = row[c];
+                if (r == 0 && c == 0)
+                {
+                    minVal = row[c];
+                    maxVal = row[c];
+                } else {
+                    minVal = min(minVal, row[c]);
+                    maxVal = max(maxVal, row[c]);
+                }
+            }
+            outFile.setRow(row.data(), r);
+        }
+        outFile.writeFile(fileName);
+    }
+    AString message = compareToFile(fileName, expected, ROWS, COLS, (maxVal - minVal) / 255.0f);
+    if (message != "") setFailed("auto scaled uint8: " + message);
+    QFile::remove(fileName);
+}
+
+void CiftiScalingTest::testLabelsUnscaled()
+{//label keys must come back exactly, even when a scaled integer type is requested
+    const int64_t ROWS = 60, COLS = 2;
+    const AString fileName = QDir::tempPath() + "/caret_cifti_label_scaling_test.nii";
+    CiftiXML myXML;
+    myXML.setNumberOfDimensions(2);
+    CiftiLabelsMap labelMap;
+    labelMap.setLength(COLS);
+    myXML.setMap(CiftiXML::ALONG_ROW, labelMap);
+    myXML.setMap(CiftiXML::ALONG_COLUMN, CiftiSeriesMap(ROWS));
+    vector<float> expected(ROWS * COLS);
+    {
+        CiftiFile outFile;
+        outFile.setWritingFile(fileName);
+        outFile.setWritingDataTypeAndScaling(NIFTI_TYPE_INT16, 0.0, 1.0);
+        outFile.setCiftiXML(myXML);
+        vector<float> row(COLS);
+        for (int64_t r = 0; r < ROWS; ++r)
+        {
+            for (int64_t c = 0; c < COLS; ++c)
+            {
+                row[c] = 1000 + r * COLS + c;
+                expected[r * COLS + c] = row[c];
+            }
+            outFile.setRow(row.data(), r);
+        }
+        outFile.writeFile(fileName);
+    }
+    AString message = compareToFile(fileName, expected, ROWS, COLS, 0.0f);
+    if (message != "") setFailed("label keys: " + message);
+    QFile::remove(fileName);
+}
@@ -0,0 +1,119 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2016  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "CompressedFileTest.h"
+
+#include "CaretBinaryFile.h"
+
+#include "zlib.h"
+
+#include <QDir>
+#include <QFile>
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+CompressedFileTest::CompressedFileTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+void CompressedFileTest::checkReads(const AString& fileName, const vector<unsigned char>& original, const AString& description)
+{//read whole, with random seeks (forward and backward), and past the end
+    const int64_t dataSize = (int64_t)original.size();
+    vector<unsigned char> readBack(dataSize);
+    {
+        CaretBinaryFile reader(fileName);
+        reader.read(readBack.data(), dataSize);
+        if (readBack != original) setFailed(description + ": whole file read gave different data");
+    }
+    CaretBinaryFile reader(fileName);
+    for (int i = 0; i < 50; ++i)
+    {
+        const int64_t start = (int64_t)((double)rand() / RAND_MAX * (dataSize - 1));
+        const int64_t length = min((int64_t)(rand() % 3000000), dataSize - start);
+        reader.seek(start);
+        reader.read(readBack.data(), length);
+        if (reader.pos() != start + length) setFailed(description + ": wrong position after reading " + AString::number(length) + " bytes at " + AString::number(start));
+        for (int64_t j = 0; j < length; ++j)
+        {
+            if (readBack[j] != original[start + j])
+            {
+                setFailed(description + ": read of " + AString::number(length) + " bytes at " + AString::number(start) + " gave different data");
+                break;
+            }
+        }
+    }
+    int64_t numRead = -1;
+    reader.seek(dataSize - 10);
+    reader.read(readBack.data(), 100, &numRead);
+    if (numRead != 10) setFailed(description + ": read at end of file gave " + AString::number(numRead) + " bytes instead of 10");
+    reader.close();
+}
+
+void CompressedFileTest::writePlainGzip(const AString& fileName, const vector<unsigned char>& original, const int64_t& splitPoint)
+{//what other programs write: no index, one member, or two if splitPoint is inside the data (like concatenated .gz files)
+    const int64_t dataSize = (int64_t)original.size();
+    QFile::remove(fileName);
+    int64_t written = 0;
+    while (written < dataSize)
+    {
+        const int64_t end = (splitPoint > written && splitPoint < dataSize ? splitPoint : dataSize);
+        gzFile myFile = gzopen(fileName.toLocal8Bit().constData(), (written == 0 ? "wb" : "ab"));
+        if (myFile == NULL)
+        {
+            setFailed("failed to open '" + fileName + "' with zlib");
+            return;
+        }
+        for (int64_t pos = written; pos < end; pos += 1 << 20)
+        {
+            const int64_t toWrite = min((int64_t)(1 << 20), end - pos);
+            if (gzwrite(myFile, original.data() + pos, (unsigned int)toWrite) != toWrite) setFailed("zlib failed to write '" + fileName + "'");
+        }
+        gzclose(myFile);
+        written = end;
+    }
+}
+
+void CompressedFileTest::execute()
+{//written .gz files are several gzip members with an index, plain gzip files (most existing .nii.gz) use access points made while reading
+    const int64_t DATA_SIZE = 12 * 1024 * 1024 + 12345;//not a multiple of the member size, and several access point spans
+    vector<unsigned char> original(DATA_SIZE);
+    for (int64_t i = 0; i < DATA_SIZE; ++i)
+    {
+        original[i] = (unsigned char)((i / 1000) % 13 + rand() % 5);//compressible, but not trivially
+    }
+    const AString fileName = QDir::tempPath() + "/caret_compressed_file_test.bin.gz";
+    {
+        CaretBinaryFile writer(fileName, CaretBinaryFile::WRITE_TRUNCATE);
+        writer.write(original.data(), 1000);
+        writer.seek(1000);
+        writer.write(original.data() + 1000, DATA_SIZE - 1000);
+    }
+    checkReads(fileName, original, "indexed file");
+    writePlainGzip(fileName, original, -1);
+    checkReads(fileName, original, "single member gzip");
+    writePlainGzip(fileName, original, 5 * 1024 * 1024 + 777);//past the first access point span, not on a span boundary
+    checkReads(fileName, original, "two member gzip");
+    QFile::remove(fileName);
+}
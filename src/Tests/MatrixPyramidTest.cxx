@@ -0,0 +1,104 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+#include "MatrixPyramidTest.h"
+
+#include "ChartMatrixImagePyramid.h"
+
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+MatrixPyramidTest::MatrixPyramidTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+void MatrixPyramidTest::execute()
+{
+    const int ROWS = 5, COLS = 3;//odd sizes, so edge cells combine fewer cells
+    vector<float> rgba(ROWS * COLS * 4);
+    for (int row = 0; row < ROWS; ++row)
+    {
+        for (int col = 0; col < COLS; ++col)
+        {
+            float* cell = rgba.data() + (row * COLS + col) * 4;
+            cell[0] = (row * COLS + col) / 14.0f;
+            cell[1] = 0.0f;
+            cell[2] = 1.0f - cell[0];
+            cell[3] = ((row + col) % 4 == 3 ? 0.0f : 1.0f);
+        }
+    }
+    ChartMatrixImagePyramid meanPyramid(ROWS, COLS, rgba, ChartMatrixImagePyramid::AGGREGATION_MEAN);
+    meanPyramid.buildLevels(10);
+    if (meanPyramid.getNumberOfLevels() != 4) setFailed("expected 4 levels, got " + AString::number(meanPyramid.getNumberOfLevels()));
+    const int expectRows[4] = { 5, 3, 2, 1 }, expectCols[4] = { 3, 2, 1, 1 };
+    for (int level = 0; level < 4 && level < meanPyramid.getNumberOfLevels(); ++level)
+    {
+        if (meanPyramid.getLevelNumberOfRows(level) != expectRows[level] || meanPyramid.getLevelNumberOfColumns(level) != expectCols[level])
+        {
+            setFailed("level " + AString::number(level) + " has wrong dimensions");
+        }
+    }
+    if (meanPyramid.getNumberOfLevels() < 2) return;
+    const uint8_t* level0 = meanPyramid.getLevelRGBA(0);
+    const uint8_t* level1 = meanPyramid.getLevelRGBA(1);
+    //last row, last column of level 1 is the single cell at row 4, column 2
+    const uint8_t* corner = level1 + (2 * 2 + 1) * 4;
+    const uint8_t* source = level0 + (4 * COLS + 2) * 4;
+    for (int k = 0; k < 4; ++k)
+    {
+        if (corner[k] != source[k]) setFailed("edge cell of level 1 does not match its only source cell");
+    }
+    int sum = 0;
+    for (int row = 0; row < 2; ++row)
+    {
+        for (int col = 0; col < 2; ++col)
+        {
+            sum += level0[(row * COLS + col) * 4];
+        }
+    }
+    if (level1[0] != (sum + 2) / 4) setFailed("mean of first block is " + AString::number(level1[0]) + ", expected " + AString::number((sum + 2) / 4));
+    vector<uint8_t> region;
+    meanPyramid.getLevelRegionRGBA(0, 1, 1, 2, 2, region);
+    if (region.size() != 16 || region[0] != level0[(1 * COLS + 1) * 4] || region[12] != level0[(2 * COLS + 2) * 4])
+    {
+        setFailed("region copy does not match level");
+    }
+    ChartMatrixImagePyramid maxPyramid(ROWS, COLS, rgba, ChartMatrixImagePyramid::AGGREGATION_MAXIMUM);
+    maxPyramid.buildLevels(1);
+    if (maxPyramid.getNumberOfLevels() != 2) setFailed("buildLevels(1) should make exactly 2 levels");
+    //first block is cells 0, 1, 3, 4 (row-major), red is weighted more than blue, so the brightest is cell 4
+    const uint8_t* maxLevel1 = maxPyramid.getLevelRGBA(1);
+    for (int k = 0; k < 4; ++k)
+    {
+        if (maxLevel1[k] != level0[4 * 4 + k]) setFailed("maximum aggregation did not keep the color of the brightest cell");
+    }
+    //block at level 1 row 0, column 1 is cells (0, 2) and (1, 2), (1, 2) is brighter but transparent, so (0, 2) must be kept
+    const uint8_t* transparentBlock = maxLevel1 + 1 * 4;
+    for (int k = 0; k < 4; ++k)
+    {
+        if (transparentBlock[k] != level0[2 * 4 + k]) setFailed("maximum aggregation used a transparent cell");
+    }
+    if (ChartMatrixImagePyramid::getLevelForCellSize(2.0f, 3.0f) != 0 || ChartMatrixImagePyramid::getLevelForCellSize(0.25f, 1.0f) != 2 ||
+        ChartMatrixImagePyramid::getLevelForCellSize(0.3f, 0.3f) != 1)
+    {
+        setFailed("wrong level chosen for cell size");
+    }
+}
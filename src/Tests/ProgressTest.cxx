@@ -20,8 +20,10 @@
 
 #include <iostream>
 
+#include "CaretProfiler.h"
 #include "EventManager.h"
 #include "ProgressTest.h"
+#include "SystemUtilities.h"
 
 using namespace std;
 using namespace caret;
@@ -75,6 +77,12 @@ TestAlgorithm2::TestAlgorithm2(ProgressObject* myproginfo): AbstractAlgorithm(my
    //do nothing, simulate ignoring the object
 }
 
+TestProfiledAlgorithm::TestProfiledAlgorithm(ProgressObject* myproginfo): AbstractAlgorithm(myproginfo)
+{
+   LevelProgress myLevel(myproginfo);
+   SystemUtilities::sleepSeconds(0.02f);//so that a sibling started too early overlaps measurably
+}
+
 ProgressTest::ProgressTest(const AString& identifier): TestInterface(identifier)
 {
 }
@@ -105,4 +113,39 @@ void ProgressTest::execute()
    {
       setFailed("ignored progress object does not register as completed upon algorithm destruction");
    }
+   {//subalgorithms added up front must get sequential profile stages, with or without a task set before each
+      CaretProfiler::enable("");
+      const int numChildren = 3;
+      ProgressObject myprog4(TestProfiledAlgorithm::getAlgorithmWeight() * numChildren);
+      myprog4.startProfiling("progress test");
+      vector<ProgressObject*> children;
+      for (int i = 0; i < numChildren; ++i)
+      {
+         children.push_back(myprog4.addAlgorithm(TestProfiledAlgorithm::getAlgorithmWeight()));
+      }
+      {
+         LevelProgress myLevel(&myprog4);
+         for (int i = 0; i < numChildren; ++i)
+         {
+            if (i > 0) myLevel.setTask("child " + AString::number(i));
+            TestProfiledAlgorithm myalg4(children[i]);
+         }
+      }
+      double lastEnd = 0.0;
+      for (int i = 0; i < numChildren; ++i)
+      {
+         double start = 0.0, seconds = 0.0;
+         if (!CaretProfiler::getStageTimes(children[i]->getProfileStage(), start, seconds))
+         {
+            setFailed("subalgorithm " + AString::number(i + 1) + " has no profile stage");
+            break;
+         }
+         if (i > 0 && start < lastEnd - 1.0e-6)
+         {
+            setFailed("profile stage of subalgorithm " + AString::number(i + 1) + " starts " + AString::number(lastEnd - start) + " seconds before the previous one ends");
+         }
+         lastEnd = start + seconds;
+      }
+      CaretProfiler::writeProfile();
+   }
 }
@@ -40,6 +40,12 @@ namespace caret {
       TestAlgorithm2(ProgressObject* myproginfo);
    };
 
+   class TestProfiledAlgorithm : public AbstractAlgorithm
+   {
+   public:
+      TestProfiledAlgorithm(ProgressObject* myproginfo);
+   };
+
    class ProgressTest : public TestInterface
    {
    public: